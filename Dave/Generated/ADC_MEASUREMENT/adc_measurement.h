@@ -176,9 +176,9 @@ typedef struct ADC_MEASUREMENT_ISR
 typedef struct ADC_MEASUREMENT_CHANNEL
 {
 #if( XMC_VADC_GROUP_AVAILABLE == 1U)
-  XMC_VADC_CHANNEL_CONFIG_t *ch_handle; /**< This holds the VADC Channel LLD struct*/
+  const XMC_VADC_CHANNEL_CONFIG_t *ch_handle; /**< This holds the VADC Channel LLD struct*/
 
-  XMC_VADC_RESULT_CONFIG_t *res_handle; /**< This hold the VADC LLD Result handler*/
+  const XMC_VADC_RESULT_CONFIG_t *res_handle; /**< This hold the VADC LLD Result handler*/
 #endif
 
 #if( XMC_VADC_GROUP_AVAILABLE == 1U)
@@ -203,10 +203,18 @@ typedef struct ADC_MEASUREMENT_CHANNEL_ARRAY
   const ADC_MEASUREMENT_CHANNEL_t *const channel_array[ADC_MEASUREMENT_MAXCHANNELS]; /**< Array which consists
                                                                                         of APPs Channel Handles*/
 #if( XMC_VADC_GROUP_AVAILABLE == 0U)
-  XMC_VADC_RESULT_CONFIG_t *res_handle; /**< This hold the VADC LLD Result handler*/
+  const XMC_VADC_RESULT_CONFIG_t *res_handle; /**< This hold the VADC LLD Result handler*/
 #endif
 } ADC_MEASUREMENT_CHANNEL_ARRAY_t;
 
+/**
+ * @brief Runtime state of the ADC_MEASUREMENT APP (RAM, the handle itself is const and placed in flash)
+ */
+typedef struct ADC_MEASUREMENT_RUNTIME
+{
+  ADC_MEASUREMENT_STATUS_t init_state; 	  /**< Holds information regarding the APP initialization */
+} ADC_MEASUREMENT_RUNTIME_t;
+
 /**
  * Structure to configure ADC_MEASUREMENT APP.
  */
@@ -219,7 +227,7 @@ typedef struct ADC_MEASUREMENT
 
   const XMC_VADC_GLOBAL_CLASS_t *const iclass_config_handle;  /**< This holds the adc global ICLASS 0 configuration*/
 
-  GLOBAL_ADC_t *const global_handle; 						 /**< This hold the ADC Global APP handle*/
+  const GLOBAL_ADC_t *const global_handle; 						 /**< This hold the ADC Global APP handle*/
 
 #if (UC_SERIES != XMC11)
   const ADC_MEASUREMENT_ISR_t *const req_src_intr_handle; 	 /**< This has the NVIC configuration structure*/
@@ -229,7 +237,7 @@ typedef struct ADC_MEASUREMENT
 
   ADC_MEASUREMENT_MUX_CONFIG_t mux_config; /**< This hold the pointer to the function that does mux configuration.*/
 
-  ADC_MEASUREMENT_STATUS_t init_state; 	  /**< Holds information regarding the APP initialization */
+  ADC_MEASUREMENT_RUNTIME_t *const runtime_ptr; /**< Points to the runtime state of the APP */
 
   const XMC_VADC_SR_t srv_req_node; 	  /**< Service Request Line selected*/
 
@@ -312,7 +320,7 @@ DAVE_APP_VERSION_t ADC_MEASUREMENT_GetAppVersion(void);
  * }
  @endcode
  */ 
-ADC_MEASUREMENT_STATUS_t ADC_MEASUREMENT_Init(ADC_MEASUREMENT_t *const handle_ptr);
+ADC_MEASUREMENT_STATUS_t ADC_MEASUREMENT_Init(const ADC_MEASUREMENT_t *const handle_ptr);
 
 /**
  * @brief Starts the conversion of the required measurements. <BR>
@@ -349,7 +357,7 @@ ADC_MEASUREMENT_STATUS_t ADC_MEASUREMENT_Init(ADC_MEASUREMENT_t *const handle_pt
   }
  @endcode
  */
-void ADC_MEASUREMENT_StartConversion(ADC_MEASUREMENT_t *const handle_ptr);
+void ADC_MEASUREMENT_StartConversion(const ADC_MEASUREMENT_t *const handle_ptr);
 
 #if(XMC_VADC_GROUP_AVAILABLE == 1U)
 /**
@@ -369,7 +377,7 @@ void ADC_MEASUREMENT_StartConversion(ADC_MEASUREMENT_t *const handle_ptr);
  *
  * \par<b>Note: </b><br>
  * This API is not Applicable for XMC1100 microcontroller, because all the channels shares a common result register
- * called GLOBRES. Use @ref ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_t *const handle_ptr) for XMC1100 microcontrollers.
+ * called GLOBRES. Use @ref ADC_MEASUREMENT_GetResult(const ADC_MEASUREMENT_t *const handle_ptr) for XMC1100 microcontrollers.
  *
  * @code
   // Ensure that end of measurements interrupt has been enabled
@@ -392,7 +400,7 @@ void ADC_MEASUREMENT_StartConversion(ADC_MEASUREMENT_t *const handle_ptr);
   }
  @endcode
  */
-XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_CHANNEL_t *const handle_ptr);
+XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(const ADC_MEASUREMENT_CHANNEL_t *const handle_ptr);
 
 /**
  * @brief Returns a detailed conversion result. Not Applicable for XMC1100. <BR>
@@ -409,7 +417,7 @@ XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_CHANNEL_t *cons
  *
  * \par<b>Note: </b><br>
  * This API is not Applicable for XMC1100 microcontroller, because all the channels shares a common result register
- * called GLOBRES. Use @ref ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_t *const handle_ptr) for XMC1100
+ * called GLOBRES. Use @ref ADC_MEASUREMENT_GetDetailedResult(const ADC_MEASUREMENT_t *const handle_ptr) for XMC1100
  * microcontrollers.
  *
  * @code
@@ -451,7 +459,7 @@ XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_CHANNEL_t *cons
   }
  @endcode
  */
-uint32_t ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_CHANNEL_t *const handle_ptr);
+uint32_t ADC_MEASUREMENT_GetDetailedResult(const ADC_MEASUREMENT_CHANNEL_t *const handle_ptr);
 
 #else /* Applicable for XMC1100 devices*/
 /**
@@ -500,7 +508,7 @@ uint32_t ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_CHANNEL_t *const hand
   }
  @endcode
  */
-XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_t *const handle_ptr) ADC_MEASUREMENT_DEPRECATED;
+XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(const ADC_MEASUREMENT_t *const handle_ptr) ADC_MEASUREMENT_DEPRECATED;
 
 /**
  * @brief Returns a detailed conversion result. Only Applicable for XMC1100. <BR>
@@ -522,7 +530,7 @@ XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_t *const handle
  * \par<b>Note: </b><br>
  * <ul>
  * <li>This API is applicable only for XMC1100 microcontroller, because all the channels shares a common result register
- * called GLOBRES. Use @ref ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_CHANNEL_t *const handle_ptr) for other
+ * called GLOBRES. Use @ref ADC_MEASUREMENT_GetDetailedResult(const ADC_MEASUREMENT_CHANNEL_t *const handle_ptr) for other
  * microcontrollers.</li>
  * <li> For either 10Bit or 8Bit ADC resolution the result value needs to be right shifted by either 2 or
  * 4 bits respectively. The 10Bit or 8 bit results are left aligned in the result register, hence a shift
@@ -574,7 +582,7 @@ XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_t *const handle
   }
  @endcode
  */
-uint32_t ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_t *const handle_ptr) ADC_MEASUREMENT_DEPRECATED;
+uint32_t ADC_MEASUREMENT_GetDetailedResult(const ADC_MEASUREMENT_t *const handle_ptr) ADC_MEASUREMENT_DEPRECATED;
 
 /**
  * @brief Returns the converted value from the global result register. Only Applicable for XMC1100.<BR>
@@ -651,7 +659,7 @@ __STATIC_INLINE XMC_VADC_RESULT_SIZE_t  ADC_MEASUREMENT_GetGlobalResult(void)
  * \par<b>Note: </b><br>
  * <ul>
  * <li>This API is applicable only for XMC1100 microcontroller, because all the channels shares a common result register
- * called GLOBRES. Use @ref ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_CHANNEL_t *const handle_ptr) for other
+ * called GLOBRES. Use @ref ADC_MEASUREMENT_GetDetailedResult(const ADC_MEASUREMENT_CHANNEL_t *const handle_ptr) for other
  * microcontrollers.</li>
  * <li> For either 10Bit or 8Bit ADC resolution the result value needs to be right shifted by either 2 or
  * 4 bits respectively. The 10Bit or 8 bit results are left aligned in the result register, hence a shift
@@ -111,7 +111,7 @@ const  XMC_VADC_GLOBAL_CLASS_t global_iclass_config =
 
 
 /* Channel_A ADC channel Handle */
-ADC_MEASUREMENT_CHANNEL_t ADC_MEASUREMENT_Channel_A_handle =
+const ADC_MEASUREMENT_CHANNEL_t ADC_MEASUREMENT_Channel_A_handle =
 {
   .ch_num        = (uint8_t) 0,
   .group_index	 = (uint8_t) 0,
@@ -120,7 +120,7 @@ ADC_MEASUREMENT_CHANNEL_t ADC_MEASUREMENT_Channel_A_handle =
 
     
 /*Global Result Register configuration structure*/
-XMC_VADC_RESULT_CONFIG_t global_res_config =
+const XMC_VADC_RESULT_CONFIG_t global_res_config =
 {
   .data_reduction_control = (uint8_t) 0,  /* No Accumulation */
   .post_processing_mode   = (uint32_t) XMC_VADC_DMM_REDUCTION_MODE,
@@ -130,20 +130,20 @@ XMC_VADC_RESULT_CONFIG_t global_res_config =
 };
     
 /* ADC_MEASUREMENT channel handles */
-ADC_MEASUREMENT_CHANNEL_ARRAY_t ADC_MEASUREMENT_channel_array=
+const ADC_MEASUREMENT_CHANNEL_ARRAY_t ADC_MEASUREMENT_channel_array=
 {
   .channel_array =
     {
-      (ADC_MEASUREMENT_CHANNEL_t *)&ADC_MEASUREMENT_Channel_A_handle,
+      (const ADC_MEASUREMENT_CHANNEL_t *)&ADC_MEASUREMENT_Channel_A_handle,
     },
-  .res_handle    = (XMC_VADC_RESULT_CONFIG_t*) &global_res_config,
+  .res_handle    = (const XMC_VADC_RESULT_CONFIG_t*) &global_res_config,
 };
 
 /* Result event interrupt : End of Single measurement interrupt configuration structure*/
 const ADC_MEASUREMENT_ISR_t global_result_intr_handle=
 {
   .node_id      = 15U,
-  .priority    	= 3U
+  .priority    	= 0U
 };
 
 /* LLD Background Scan Init Structure */
@@ -161,17 +161,23 @@ const XMC_VADC_BACKGROUND_CONFIG_t backgnd_config =
   .load_mode         = (uint32_t) XMC_VADC_SCAN_LOAD_OVERWRITE
 };
 
-ADC_MEASUREMENT_t ADC_SENSOR=
+/* ADC_SENSOR runtime state */
+ADC_MEASUREMENT_RUNTIME_t ADC_SENSOR_runtime =
 {
-  .array		 	     = (ADC_MEASUREMENT_CHANNEL_ARRAY_t*) &ADC_MEASUREMENT_channel_array,
+  .init_state 			 = ADC_MEASUREMENT_STATUS_UNINITIALIZED
+};
+
+const ADC_MEASUREMENT_t ADC_SENSOR=
+{
+  .array		 	     = (const ADC_MEASUREMENT_CHANNEL_ARRAY_t*) &ADC_MEASUREMENT_channel_array,
   .backgnd_config_handle = (XMC_VADC_BACKGROUND_CONFIG_t*) &backgnd_config,
   .result_intr_handle	 = (ADC_MEASUREMENT_ISR_t *) &global_result_intr_handle,
   .iclass_config_handle  = ( XMC_VADC_GLOBAL_CLASS_t *) &global_iclass_config,
   .srv_req_node          = XMC_VADC_SR_SHARED_SR0,
-  .global_handle    	 = (GLOBAL_ADC_t *) &GLOBAL_ADC_0,
+  .global_handle    	 = (const GLOBAL_ADC_t *) &GLOBAL_ADC_0,
   .start_conversion		 = (bool) true,
   .mux_config			 = NULL,
-  .init_state 			 = ADC_MEASUREMENT_STATUS_UNINITIALIZED
+  .runtime_ptr 			 = &ADC_SENSOR_runtime
 };
 
 
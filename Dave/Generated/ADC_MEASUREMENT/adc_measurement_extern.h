@@ -101,12 +101,12 @@
  * MACROS
  **********************************************************************************************************************/
 
- extern ADC_MEASUREMENT_CHANNEL_t ADC_MEASUREMENT_Channel_A_handle;
+ extern const ADC_MEASUREMENT_CHANNEL_t ADC_MEASUREMENT_Channel_A_handle;
 
 /***********************************************************************************************************************
  * EXTERN DECLARATIONS
  ***********************************************************************************************************************/
-extern ADC_MEASUREMENT_t ADC_SENSOR;
+extern const ADC_MEASUREMENT_t ADC_SENSOR;
 
 #endif /* ADC_MEASUREMENT_EXTERN_H */
 
@@ -90,7 +90,7 @@ DAVE_APP_VERSION_t CLOCK_XMC1_GetAppVersion(void)
 /*
  * API to initialize the CLOCK_XMC1 APP Interrupts
  */
-CLOCK_XMC1_STATUS_t CLOCK_XMC1_Init(CLOCK_XMC1_t *handle)
+CLOCK_XMC1_STATUS_t CLOCK_XMC1_Init(const CLOCK_XMC1_t *const handle)
 {
   CLOCK_XMC1_STATUS_t status = CLOCK_XMC1_STATUS_SUCCESS;
   CLOCK_XMC1_STATUS_t loci_event_status = CLOCK_XMC1_STATUS_SUCCESS;
@@ -100,7 +100,7 @@ CLOCK_XMC1_STATUS_t CLOCK_XMC1_Init(CLOCK_XMC1_t *handle)
 
   XMC_ASSERT("CLOCK_XMC1_Init: CLOCK_XMC1 APP handle pointer uninitialized", (handle != NULL));
 
-  if (handle->init_status == false)
+  if (handle->runtime_ptr->init_status == false)
   {
 #ifdef CLOCK_XMC1_INTERRUPT_ENABLED
 
@@ -147,7 +147,7 @@ CLOCK_XMC1_STATUS_t CLOCK_XMC1_Init(CLOCK_XMC1_t *handle)
     		                       ((uint32_t)loss_ext_clock_event_status) | ((uint32_t)dco1_out_sync_status));
     if (CLOCK_XMC1_STATUS_SUCCESS == status)
     {
-      handle->init_status = true;
+      handle->runtime_ptr->init_status = true;
     }
   }
   return (status);
@@ -129,6 +129,14 @@ typedef enum CLOCK_XMC1_STATUS
  * @{
  */
 
+/**
+ * @brief Runtime state of the CLOCK_XMC1 APP (RAM, the handle itself is const and placed in flash)
+ */
+typedef struct CLOCK_XMC1_RUNTIME
+{
+  bool init_status;  /**<APP is initialized or not. */
+} CLOCK_XMC1_RUNTIME_t;
+
 /**
  * @brief Configuration structure for CLOCK_XMC1 APP
  */
@@ -155,7 +163,7 @@ typedef struct CLOCK_XMC1
 #endif
 
 #endif
-  bool init_status;  /**<APP is initialized or not. */
+  CLOCK_XMC1_RUNTIME_t *const runtime_ptr;  /**<Points to the runtime state of the APP */
 } CLOCK_XMC1_t;
 
 /**
@@ -245,7 +253,7 @@ DAVE_APP_VERSION_t CLOCK_XMC1_GetAppVersion(void);
  *
  * @endcode<BR>
  */
-CLOCK_XMC1_STATUS_t CLOCK_XMC1_Init(CLOCK_XMC1_t *handle);
+CLOCK_XMC1_STATUS_t CLOCK_XMC1_Init(const CLOCK_XMC1_t *const handle);
 
 /**
  * @brief API for ramping up/down the system clock frequency
@@ -60,11 +60,16 @@
 /**********************************************************************************************************************
 * DATA STRUCTURES
 **********************************************************************************************************************/
-CLOCK_XMC1_t CLOCK_XMC1_0 =
+CLOCK_XMC1_RUNTIME_t CLOCK_XMC1_0_runtime =
 {
   .init_status = false
 };
 
+const CLOCK_XMC1_t CLOCK_XMC1_0 =
+{
+  .runtime_ptr = &CLOCK_XMC1_0_runtime
+};
+
 /**********************************************************************************************************************
 * API IMPLEMENTATION
 **********************************************************************************************************************/
@@ -54,7 +54,7 @@
 
 #include "clock_xmc1.h"
 
-extern CLOCK_XMC1_t CLOCK_XMC1_0;
+extern const CLOCK_XMC1_t CLOCK_XMC1_0;
 
 #endif /* End of CLOCK_XMC1_EXTERN_H */
 
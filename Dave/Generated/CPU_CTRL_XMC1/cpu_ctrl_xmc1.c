@@ -86,7 +86,7 @@ DAVE_APP_VERSION_t CPU_CTRL_XMC1_GetAppVersion(void)
 }
 
 /* Dummy Init API to maintain backward compatibility */
-CPU_CTRL_XMC1_STATUS_t CPU_CTRL_XMC1_Init(CPU_CTRL_XMC1_t *const handler)
+CPU_CTRL_XMC1_STATUS_t CPU_CTRL_XMC1_Init(const CPU_CTRL_XMC1_t *const handler)
 {
   (void)handler;
   return CPU_CTRL_XMC1_STATUS_SUCCESS;
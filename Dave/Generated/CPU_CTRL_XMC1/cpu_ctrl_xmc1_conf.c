@@ -45,6 +45,8 @@
  *     - Added SystemCoreSetup API
  * 2018-07-11:
  *     - Enable prefetch unit for XMC1400
+ * 2026-10-14:
+ *     - SystemCoreSetup is weak (USB-Changer)
  *
  * @endcond
  *
@@ -57,12 +59,13 @@
 /**********************************************************************************************************************
 * DATA STRUCTURES
 **********************************************************************************************************************/
-CPU_CTRL_XMC1_t CPU_CTRL_XMC1_0 =
+const CPU_CTRL_XMC1_t CPU_CTRL_XMC1_0 =
 {
   .initialized = false
 };
  
-void SystemCoreSetup(void)
+/* Weak, the application may replace it (USB-Changer: boot.c sets the flash wait states and the relay pin) */
+__WEAK void SystemCoreSetup(void)
 {
 #if UC_SERIES == XMC14
   /* Enable Prefetch unit */
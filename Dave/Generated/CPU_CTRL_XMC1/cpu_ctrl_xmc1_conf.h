@@ -61,7 +61,7 @@
 #define CPU_CTRL_XMC1_MINOR_VERSION (0U)
 #define CPU_CTRL_XMC1_PATCH_VERSION (12U)
 
-#define CPU_CTRL_HANDLE (CPU_CTRL_XMC1_t *)(void *)(&CPU_CTRL_XMC1_0)
+#define CPU_CTRL_HANDLE (const CPU_CTRL_XMC1_t *)(const void *)(&CPU_CTRL_XMC1_0)
 
 #define HARDFAULT_ENABLED 0
 
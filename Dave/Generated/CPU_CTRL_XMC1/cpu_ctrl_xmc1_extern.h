@@ -61,7 +61,7 @@
  * EXTERN DECLARATIONS
 ***********************************************************************************************************************/
 
-extern CPU_CTRL_XMC1_t CPU_CTRL_XMC1_0; 
+extern const CPU_CTRL_XMC1_t CPU_CTRL_XMC1_0; 
 
 #endif
 
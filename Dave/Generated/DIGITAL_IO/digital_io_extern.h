@@ -87,6 +87,39 @@ extern const DIGITAL_IO_t IO_LED_USB2;
 	
 extern const DIGITAL_IO_t IO_LED_USB1; 
 	
+#define IO_USB_SI_PORT XMC_GPIO_PORT2
+#define IO_USB_SI_PIN 0U
+
+#define IO_USB_OE_PORT XMC_GPIO_PORT0
+#define IO_USB_OE_PIN 9U
+
+#define IO_LED_R_STATUS_PORT XMC_GPIO_PORT0
+#define IO_LED_R_STATUS_PIN 6U
+
+#define IO_SW_USB_PORT XMC_GPIO_PORT0
+#define IO_SW_USB_PIN 8U
+
+#define IO_SW_UP_PORT XMC_GPIO_PORT2
+#define IO_SW_UP_PIN 7U
+
+#define IO_SW_DOWN_PORT XMC_GPIO_PORT2
+#define IO_SW_DOWN_PIN 9U
+
+#define IO_USBPWR_2_PORT XMC_GPIO_PORT0
+#define IO_USBPWR_2_PIN 5U
+
+#define IO_USBPWR_1_PORT XMC_GPIO_PORT2
+#define IO_USBPWR_1_PIN 10U
+
+#define IO_RELAY_PORT XMC_GPIO_PORT0
+#define IO_RELAY_PIN 7U
+
+#define IO_LED_USB2_PORT XMC_GPIO_PORT0
+#define IO_LED_USB2_PIN 0U
+
+#define IO_LED_USB1_PORT XMC_GPIO_PORT2
+#define IO_LED_USB1_PIN 11U
+
  
 #endif  /* DIGITAL_IO_EXTERN_H */
 
@@ -64,6 +64,12 @@
 /* EMULATED EEPROM Global State Data type structure declaration */
 E_EEPROM_XMC1_DATA_t  E_EEPROM_XMC1_data;
 
+/* EMULATED EEPROM runtime state of the handle */
+E_EEPROM_XMC1_RUNTIME_t E_EEPROM_XMC1_0_runtime =
+{
+ .state                   = E_EEPROM_XMC1_STATUS_UNINITIALIZED
+};
+
 /**
  *  User defined Data Block configurations 
  */ 
@@ -71,47 +77,73 @@ const E_EEPROM_XMC1_BLOCK_t E_EEPROM_XMC1_block_Config[] =
 {  
     /** Block 1 Configuration */    
     {                 
-     EEPROM_LOWER_TH,    
-     4U 
+     EEPROM_SETTINGS,    
+     12U 
      }, 
     /** Block 2 Configuration */    
     {                 
-     EEPROM_UPPER_TH,    
-     4U 
+     EEPROM_CALIBRATION,    
+     34U 
      }, 
     /** Block 3 Configuration */    
     {                 
-     EEPROM_LATCHTIME,    
-     4U 
+     EEPROM_WEAR,    
+     36U 
      }, 
     /** Block 4 Configuration */    
     {                 
-     EEPROM_USB_STATE,    
+     EEPROM_RELAY_LIFE,    
+     8U 
+     }, 
+    /** Block 5 Configuration */    
+    {                 
+     EEPROM_PROFILES,    
+     22U 
+     }, 
+    /** Block 6 Configuration */    
+    {                 
+     EEPROM_RELAY_POSITION,    
      4U 
      }  
 };
 
+/**
+ *  Direct-mapped block index: configuration index of every block number (0xFF = not configured)
+ */
+const uint8_t E_EEPROM_XMC1_block_Index[E_EEPROM_XMC1_MAX_BLOCK_NUMBER + 1U] =
+{
+    0xFFU,
+    0U, /* EEPROM_SETTINGS */
+    1U, /* EEPROM_CALIBRATION */
+    2U, /* EEPROM_WEAR */
+    3U, /* EEPROM_RELAY_LIFE */
+    4U, /* EEPROM_PROFILES */
+    5U  /* EEPROM_RELAY_POSITION */
+};
+
 /*
 *  EMULATED_EEPROM handle structure definition
 */
-E_EEPROM_XMC1_t E_EEPROM_XMC1_0 =
+const E_EEPROM_XMC1_t E_EEPROM_XMC1_0 =
 {
- .block_config_ptr        = (E_EEPROM_XMC1_BLOCK_t *)(void*)E_EEPROM_XMC1_block_Config,
+ .block_config_ptr        = E_EEPROM_XMC1_block_Config,
+
+ .block_index_ptr         = E_EEPROM_XMC1_block_Index,
 
  .data_ptr                = &E_EEPROM_XMC1_data,
 
+ .runtime_ptr             = &E_EEPROM_XMC1_0_runtime,
+
 #ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
 
  .crc_handle_ptr          = null
 #endif
 
- .state                   = E_EEPROM_XMC1_STATUS_UNINITIALIZED,
-
  .block_count             = E_EEPROM_XMC1_MAX_BLOCK_COUNT,
 
  .erase_all_auto_recovery = 0U,
 
- .data_block_crc          = 0U,
+ .data_block_crc          = 1U, /* Built-in block CRC (E_EEPROM_XMC1_BLOCK_CRC_ENABLED) or CRC_SW */
 
  .garbage_collection      = 1U
 };
@@ -79,41 +79,69 @@
 /* 
  *  Flash address and Size informations as per user configuration
  */
-#define E_EEPROM_XMC1_FLASH_TOTAL_SIZE     (1024U)
-#define E_EEPROM_XMC1_FLASH_BANK_SIZE      (512U)
+#define E_EEPROM_XMC1_FLASH_TOTAL_SIZE     (1536U)
+#define E_EEPROM_XMC1_FLASH_BANK_SIZE      (768U)
 
 /* 
  *  EMULATED_EEPROM Bank, start and end addresses
  */
-#define E_EEPROM_XMC1_FLASH_BANK0_BASE     (0x10008c00U)
-#define E_EEPROM_XMC1_FLASH_BANK0_END      (0x10008dffU)
-#define E_EEPROM_XMC1_FLASH_BANK1_BASE     (0x10008e00U)
+#define E_EEPROM_XMC1_FLASH_BANK0_BASE     (0x10008a00U)
+#define E_EEPROM_XMC1_FLASH_BANK0_END      (0x10008cffU)
+#define E_EEPROM_XMC1_FLASH_BANK1_BASE     (0x10008d00U)
 #define E_EEPROM_XMC1_FLASH_BANK1_END      (0x10008fffU)
 
+/* 
+ *  Fast mount: Init takes the mounted state over from an index record in no-init RAM (linker section .no_init) if
+ *  it is valid, the marker and cache scan of the banks is only done after a power loss or an interrupted operation
+ */
+#define E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+
+/* 
+ *  Block CRC: data blocks get a CRC-16/CCITT in their header without the CRC_SW APP (nibble table in flash), checked
+ *  once by the cache scan of a full mount. A block with a wrong CRC is inconsistent like a torn write
+ */
+#define E_EEPROM_XMC1_BLOCK_CRC_ENABLED
+
+/* 
+ *  History: the addresses of the previous consistent copies of every block (newest first) are indexed by Init and by
+ *  every write, so E_EEPROM_XMC1_GetHistoryPointer reaches an older version without a scan. A garbage collection
+ *  only copies the latest versions and clears the history
+ */
+#define E_EEPROM_XMC1_HISTORY_DEPTH        (2U)
+
 /* Total number of configured Data blocks */
-#define E_EEPROM_XMC1_MAX_BLOCK_COUNT      (4U)
+#define E_EEPROM_XMC1_MAX_BLOCK_COUNT      (6U)
+
+/* Highest configured block number, size of the block index E_EEPROM_XMC1_block_Index minus 1 */
+#define E_EEPROM_XMC1_MAX_BLOCK_NUMBER     (6U)
 
 /* 
  *  Total number of pages per bank, resulting after division of banks
  *  i.e. E_EEPROM_XMC1_BANK_PAGES = (E_EEPROM_XMC1_FLASH_TOTAL_SIZE in Bytes / ((256 Bytes * 2 Banks)) 
  */
-#define E_EEPROM_XMC1_BANK_PAGES           (2U)
+#define E_EEPROM_XMC1_BANK_PAGES           (3U)
 
 /* 
  *  Block Names generated as per user configured in GUI 
  */
 
 /**  Block 1 */
-#define EEPROM_LOWER_TH  (1U)
+#define EEPROM_SETTINGS  (1U)
 
 /**  Block 2 */
-#define EEPROM_UPPER_TH  (2U)
+#define EEPROM_CALIBRATION  (2U)
 
 /**  Block 3 */
-#define EEPROM_LATCHTIME  (3U)
+#define EEPROM_WEAR  (3U)
 
 /**  Block 4 */
-#define EEPROM_USB_STATE  (4U)
+#define EEPROM_RELAY_LIFE  (4U)
+
+/**  Block 5 */
+#define EEPROM_PROFILES  (5U)
+
+/**  Block 6 */
+#define EEPROM_RELAY_POSITION  (6U)
 
 #endif
 
@@ -65,7 +65,7 @@
 ***********************************************************************************************************************/
 
 
-extern E_EEPROM_XMC1_t E_EEPROM_XMC1_0;
+extern const E_EEPROM_XMC1_t E_EEPROM_XMC1_0;
                 
 
 #endif  /* ifndef E_EEPROM_XMC1_EXTERN_H_ */
@@ -93,6 +93,42 @@
 /***********************************************************************************************************************
  * LOCAL ROUTINES
  **********************************************************************************************************************/
+#ifdef GLOBAL_ADC_STARTUP_CALIBRATION_DEFERRED
+/* Starts the startup calibration and returns as soon as it runs (XMC_VADC_GLOBAL_StartupCalibration() without the
+ * wait for its end). Waiting for the start here keeps GLOBAL_ADC_WaitStartupCalibration() from taking a calibration
+ * that has not yet begun for one that is already over. */
+static void GLOBAL_ADC_lStartStartupCalibration(const GLOBAL_ADC_t *const handle_ptr)
+{
+#if (XMC_VADC_GROUP_AVAILABLE == 1U)
+  uint32_t group_index;
+  XMC_VADC_GROUP_t *group_ptr;
+#endif
+
+  handle_ptr->module_ptr->GLOBCFG |= (uint32_t)VADC_GLOBCFG_SUCAL_Msk;
+
+#if (XMC_VADC_GROUP_AVAILABLE == 1U)
+#if UC_FAMILY == XMC1
+  for (group_index = 0U; group_index < XMC_VADC_MAXIMUM_NUM_GROUPS; group_index++)
+  {
+    group_ptr = handle_ptr->group_ptrs_array[group_index]->group_handle;
+    if ((group_ptr->ARBCFG) & (uint32_t)VADC_G_ARBCFG_ANONS_Msk)
+    {
+      while ((group_ptr->ARBCFG & (uint32_t)VADC_G_ARBCFG_CALS_Msk) == 0U)
+      {
+        __NOP();
+      }
+    }
+  }
+#endif
+#else
+  while ((((SHS0->SHSCFG) & (uint32_t)SHS_SHSCFG_STATE_Msk) >> (uint32_t)SHS_SHSCFG_STATE_Pos) !=
+         XMC_VADC_SHS_START_UP_CAL_ACTIVE)
+  {
+    __NOP();
+  }
+#endif
+}
+#endif
 
  /**********************************************************************************************************************
  * API IMPLEMENTATION
@@ -113,14 +149,14 @@ DAVE_APP_VERSION_t GLOBAL_ADC_GetAppVersion(void)
 /**
  * This function initializes all instances of the ADC Global APP and low level app.
  */
-GLOBAL_ADC_STATUS_t GLOBAL_ADC_Init(GLOBAL_ADC_t *const handle_ptr)
+GLOBAL_ADC_STATUS_t GLOBAL_ADC_Init(const GLOBAL_ADC_t *const handle_ptr)
 {
   XMC_ASSERT("GLOBAL_ADC_Init:Invalid handle_ptr", (handle_ptr != NULL));
 #if (XMC_VADC_GROUP_AVAILABLE == 1U)
   uint32_t group_index;
 #endif
 
-  if (GLOBAL_ADC_UNINITIALIZED == handle_ptr->init_state)
+  if (GLOBAL_ADC_UNINITIALIZED == handle_ptr->runtime_ptr->init_state)
   {  
     /* Initialize an instance of Global hardware */
     XMC_VADC_GLOBAL_Init(handle_ptr->module_ptr, handle_ptr->global_config_handle);
@@ -158,9 +194,51 @@ GLOBAL_ADC_STATUS_t GLOBAL_ADC_Init(GLOBAL_ADC_t *const handle_ptr)
 #endif
     if((bool)true == handle_ptr->enable_startup_calibration)
     {
+#ifdef GLOBAL_ADC_STARTUP_CALIBRATION_DEFERRED
+      GLOBAL_ADC_lStartStartupCalibration(handle_ptr);
+#else
     	XMC_VADC_GLOBAL_StartupCalibration(handle_ptr->module_ptr);
+#endif
     }
-    handle_ptr->init_state = GLOBAL_ADC_SUCCESS;
+    handle_ptr->runtime_ptr->init_state = GLOBAL_ADC_SUCCESS;
   }
-  return (handle_ptr->init_state);
+  return (handle_ptr->runtime_ptr->init_state);
 }
+
+#ifdef GLOBAL_ADC_STARTUP_CALIBRATION_DEFERRED
+/* Waits until the startup calibration started by GLOBAL_ADC_Init() is over */
+void GLOBAL_ADC_WaitStartupCalibration(const GLOBAL_ADC_t *const handle_ptr)
+{
+#if (XMC_VADC_GROUP_AVAILABLE == 1U)
+  uint32_t group_index;
+  XMC_VADC_GROUP_t *group_ptr;
+#endif
+
+  XMC_ASSERT("GLOBAL_ADC_WaitStartupCalibration:Invalid handle_ptr", (handle_ptr != NULL));
+
+  if ((GLOBAL_ADC_SUCCESS != handle_ptr->runtime_ptr->init_state) || ((bool)false == handle_ptr->enable_startup_calibration))
+  {
+    return;
+  }
+
+#if (XMC_VADC_GROUP_AVAILABLE == 1U)
+  for (group_index = 0U; group_index < XMC_VADC_MAXIMUM_NUM_GROUPS; group_index++)
+  {
+    group_ptr = handle_ptr->group_ptrs_array[group_index]->group_handle;
+    if ((group_ptr->ARBCFG) & (uint32_t)VADC_G_ARBCFG_ANONS_Msk)
+    {
+      while ((group_ptr->ARBCFG) & (uint32_t)VADC_G_ARBCFG_CAL_Msk)
+      {
+        __NOP();
+      }
+    }
+  }
+#else
+  while ((((SHS0->SHSCFG) & (uint32_t)SHS_SHSCFG_STATE_Msk) >> (uint32_t)SHS_SHSCFG_STATE_Pos) ==
+         XMC_VADC_SHS_START_UP_CAL_ACTIVE)
+  {
+    __NOP();
+  }
+#endif
+}
+#endif
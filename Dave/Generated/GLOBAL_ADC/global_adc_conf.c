@@ -117,15 +117,21 @@ const XMC_VADC_GLOBAL_CONFIG_t global_config =
 };	
 
 
+/* Runtime state of the GLOBAL_ADC APP */
+GLOBAL_ADC_RUNTIME_t GLOBAL_ADC_0_runtime =
+{
+  .init_state = GLOBAL_ADC_UNINITIALIZED
+};
+
 /**
  * This structure contains the all the Global Related Structures and also GLOBAL_ADC_GROUP_t Structures
  */
-GLOBAL_ADC_t GLOBAL_ADC_0 =
+const GLOBAL_ADC_t GLOBAL_ADC_0 =
 {
   .global_config_handle	      = (XMC_VADC_GLOBAL_CONFIG_t*) &global_config, /*Holds the global config structure */
   .module_ptr			      = (XMC_VADC_GLOBAL_t*)(void*) VADC, /*Holds the hardware module pointer*/
 .global_shs_ptr       = (XMC_VADC_GLOBAL_SHS_t*)(void*) SHS0,/* Holds the SHS module pointer*/
-  .init_state                 = GLOBAL_ADC_UNINITIALIZED,             /*The status of the GLOBAL_ADC APP */
+  .runtime_ptr                = &GLOBAL_ADC_0_runtime,                /*The status of the GLOBAL_ADC APP */
   .enable_startup_calibration = (uint32_t) true /* Enable Start up calibration*/
 };
 
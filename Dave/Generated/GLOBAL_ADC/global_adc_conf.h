@@ -86,10 +86,12 @@
  * MACROS
  **********************************************************************************************************************/
 
-#define GLOBAL_ADC_HANDLE ((GLOBAL_ADC_t *)(void *) &GLOBAL_ADC_0) /**< Instance handle of the GLOBAL_ADC APP*/
+#define GLOBAL_ADC_HANDLE ((const GLOBAL_ADC_t *)(const void *) &GLOBAL_ADC_0) /**< Instance handle of the GLOBAL_ADC APP*/
 
 #define GLOBAL_ADC_AREF_VALUE XMC_VADC_GLOBAL_SHS_AREF_EXTERNAL_VDD_UPPER_RANGE
 
+#define GLOBAL_ADC_STARTUP_CALIBRATION_DEFERRED /**< GLOBAL_ADC_Init() only starts the startup calibration, see GLOBAL_ADC_WaitStartupCalibration()*/
+
 #define GLOBAL_ADC_MAJOR_VERSION (4) /**< Major version number of GLOBAL_ADC APP*/
 #define GLOBAL_ADC_MINOR_VERSION (0) /**< Minor version number of GLOBAL_ADC APP*/
 #define GLOBAL_ADC_PATCH_VERSION (22) /**< Patch version number of GLOBAL_ADC APP*/
@@ -91,7 +91,7 @@
  * EXTERN DECLARATIONS
  ***********************************************************************************************************************/
 
-extern GLOBAL_ADC_t GLOBAL_ADC_0;
+extern const GLOBAL_ADC_t GLOBAL_ADC_0;
 
   
 #endif
@@ -79,18 +79,18 @@ DAVE_APP_VERSION_t GLOBAL_CCU4_GetAppVersion(void)
 }
 
 /* Initializes the slice with the generated configuration */
-GLOBAL_CCU4_STATUS_t GLOBAL_CCU4_Init(GLOBAL_CCU4_t* handle)
+GLOBAL_CCU4_STATUS_t GLOBAL_CCU4_Init(const GLOBAL_CCU4_t *const handle)
 {
   XMC_ASSERT("GLOBAL_CCU4_Init:NULL handler", (NULL != handle));
 
-  if (false == handle->is_initialized)
+  if (false == handle->runtime_ptr->is_initialized)
   {
     /* Enable CCU4 module */
     XMC_CCU4_Init(handle->module_ptr,handle->mcs_action);
     /* Start the prescaler */
     XMC_CCU4_StartPrescaler(handle->module_ptr);
     /* Restricts multiple initializations */
-    handle->is_initialized = true;
+    handle->runtime_ptr->is_initialized = true;
   }
 
   return (GLOBAL_CCU4_STATUS_SUCCESS);
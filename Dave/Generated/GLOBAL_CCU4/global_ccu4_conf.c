@@ -58,14 +58,20 @@
 * DATA STRUCTURES
 ***********************************************************************************************************************/
    
+/**< Runtime state of HandleGLOBAL_CCU4_0 */
+GLOBAL_CCU4_RUNTIME_t GLOBAL_CCU4_0_runtime =
+{
+  .is_initialized = false
+};
+
 /**< Configuration for HandleGLOBAL_CCU4_0 */
-GLOBAL_CCU4_t GLOBAL_CCU4_0 =
+const GLOBAL_CCU4_t GLOBAL_CCU4_0 =
 {
   .module_frequency = 64000000U,  /**< CCU4 input clock frequency */
   .syncstart_trigger_msk = XMC_SCU_CCU_TRIGGER_CCU40, 
   .module_ptr = (XMC_CCU4_MODULE_t*) CCU40,      /**< CCU4 Module Pointer */
   .mcs_action = (XMC_CCU4_SLICE_MCMS_ACTION_t)XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR,
-  .is_initialized = false
+  .runtime_ptr = &GLOBAL_CCU4_0_runtime
 };
 
 
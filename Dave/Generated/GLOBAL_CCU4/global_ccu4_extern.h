@@ -64,7 +64,7 @@
  * EXTERN DECLARATIONS
  ***********************************************************************************************************************/
 
-extern GLOBAL_CCU4_t GLOBAL_CCU4_0; /**< APP handle for handle GLOBAL_CCU4_0*/
+extern const GLOBAL_CCU4_t GLOBAL_CCU4_0; /**< APP handle for handle GLOBAL_CCU4_0*/
 
 #endif /* GLOBAL_CCU4_EXTERN_H */
 
@@ -69,6 +69,8 @@
  * HEADER FILES
  **********************************************************************************************************************/
 #include "pwm_ccu4.h"
+/* Function profiler markers of the application (empty unless FUNCPROF_ENABLED) */
+#include "funcprof.h"
 
 /***********************************************************************************************************************
  * MACROS
@@ -83,10 +85,10 @@
  **********************************************************************************************************************/
 
 /* Initialize the App Interrupts */
-static void PWM_CCU4_lInit_Interrupt(PWM_CCU4_t* handle_ptr);
+static void PWM_CCU4_lInit_Interrupt(const PWM_CCU4_t* handle_ptr);
 
 /* Initialize the App events and configurations */
-static void PWM_CCU4_lConfigure_Events(PWM_CCU4_t* handle_ptr);
+static void PWM_CCU4_lConfigure_Events(const PWM_CCU4_t* handle_ptr);
 
 /**********************************************************************************************************************
  * API IMPLEMENTATION
@@ -105,7 +107,7 @@ DAVE_APP_VERSION_t PWM_CCU4_GetAppVersion(void)
 }
 
 /* This function initializes the app */
-PWM_CCU4_STATUS_t PWM_CCU4_Init(PWM_CCU4_t* handle_ptr)
+PWM_CCU4_STATUS_t PWM_CCU4_Init(const PWM_CCU4_t* handle_ptr)
 {
   PWM_CCU4_STATUS_t status;
   GLOBAL_CCU4_STATUS_t status_ccu4_global;
@@ -116,7 +118,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Init(PWM_CCU4_t* handle_ptr)
   status_ccu4_global = GLOBAL_CCU4_STATUS_FAILURE;
   XMC_ASSERT("PWM_CCU4_Init:handle_ptr is NULL", (handle_ptr != NULL));
 
-  if (PWM_CCU4_STATE_UNINITIALIZED == handle_ptr->state)
+  if (PWM_CCU4_STATE_UNINITIALIZED == handle_ptr->runtime_ptr->state)
   {
     /* Initialize consumed Apps */
     status_ccu4_global = GLOBAL_CCU4_Init(handle_ptr->config_ptr->global_ccu4_handle);
@@ -172,9 +174,9 @@ PWM_CCU4_STATUS_t PWM_CCU4_Init(PWM_CCU4_t* handle_ptr)
       frequency_module = handle_ptr->config_ptr->global_ccu4_handle->module_frequency;
       prescalar = (uint32_t) handle_ptr->config_ptr->ccu4_cc4_slice_timer_ptr->prescaler_initval;
       frequency_module = frequency_module / ((uint32_t) 1 << prescalar);
-      handle_ptr->frequency_tclk = frequency_module;
+      handle_ptr->runtime_ptr->frequency_tclk = frequency_module;
 
-      handle_ptr->state = PWM_CCU4_STATE_INITIALIZED;
+      handle_ptr->runtime_ptr->state = PWM_CCU4_STATE_INITIALIZED;
       status = PWM_CCU4_STATUS_SUCCESS;
 
       /* Start the PWM generation if start at initialization is enabled */
@@ -185,7 +187,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Init(PWM_CCU4_t* handle_ptr)
     }
     else
     {
-      handle_ptr->state = PWM_CCU4_STATE_UNINITIALIZED;
+      handle_ptr->runtime_ptr->state = PWM_CCU4_STATE_UNINITIALIZED;
     }
 
   }
@@ -198,7 +200,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Init(PWM_CCU4_t* handle_ptr)
   return (status);
 } /* end of PWM_CCU4_Init() api */
 
-static void PWM_CCU4_lInit_Interrupt(PWM_CCU4_t* handle_ptr)
+static void PWM_CCU4_lInit_Interrupt(const PWM_CCU4_t* handle_ptr)
 {
 
   /* Enable events. Bind event to corresponding service request node.Enable Interrupts. The user may choose to 
@@ -260,7 +262,7 @@ static void PWM_CCU4_lInit_Interrupt(PWM_CCU4_t* handle_ptr)
   }
 }
 
-static void PWM_CCU4_lConfigure_Events(PWM_CCU4_t* handle_ptr)
+static void PWM_CCU4_lConfigure_Events(const PWM_CCU4_t* handle_ptr)
 {
 
   /* Configure slice to a external event 0 */
@@ -339,13 +341,13 @@ static void PWM_CCU4_lConfigure_Events(PWM_CCU4_t* handle_ptr)
 }
 /**********************************************************************************************************/
 /*Starts the CCU4_CC4 slice. This needs to be called even if external start is configured.*/
-PWM_CCU4_STATUS_t PWM_CCU4_Start(PWM_CCU4_t* handle_ptr)
+PWM_CCU4_STATUS_t PWM_CCU4_Start(const PWM_CCU4_t* handle_ptr)
 {
   PWM_CCU4_STATUS_t status;
 
   status = PWM_CCU4_STATUS_FAILURE;
   XMC_ASSERT("PWM_CCU4_Start:handle_ptr NULL", (handle_ptr != NULL));
-  if ((PWM_CCU4_STATE_INITIALIZED == handle_ptr->state) || (PWM_CCU4_STATE_STOPPED == handle_ptr->state))
+  if ((PWM_CCU4_STATE_INITIALIZED == handle_ptr->runtime_ptr->state) || (PWM_CCU4_STATE_STOPPED == handle_ptr->runtime_ptr->state))
   {
     /* clear IDLE mode for the slice; Start timer */
     XMC_CCU4_EnableClock(handle_ptr->ccu4_module_ptr, handle_ptr->slice_number);
@@ -355,7 +357,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Start(PWM_CCU4_t* handle_ptr)
       XMC_CCU4_SLICE_StartTimer(handle_ptr->ccu4_slice_ptr);
     }
 
-    handle_ptr->state = PWM_CCU4_STATE_RUNNING;
+    handle_ptr->runtime_ptr->state = PWM_CCU4_STATE_RUNNING;
     status = PWM_CCU4_STATUS_SUCCESS;
     XMC_DEBUG("PWM_CCU4_Start:start PWM");
   }
@@ -363,18 +365,18 @@ PWM_CCU4_STATUS_t PWM_CCU4_Start(PWM_CCU4_t* handle_ptr)
 } /* end of PWM_CCU4_Start() api */
 /**********************************************************************************************************/
 /*Stops the CCU4_CC4 slice. */
-PWM_CCU4_STATUS_t PWM_CCU4_Stop(PWM_CCU4_t* handle_ptr)
+PWM_CCU4_STATUS_t PWM_CCU4_Stop(const PWM_CCU4_t* handle_ptr)
 {
   PWM_CCU4_STATUS_t status;
 
   status = PWM_CCU4_STATUS_FAILURE;
   XMC_ASSERT("PWM_CCU4_Stop:handle_ptr NULL", (handle_ptr != NULL));
-  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->state)
+  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->runtime_ptr->state)
   {
     XMC_CCU4_SLICE_StopTimer(handle_ptr->ccu4_slice_ptr);
     XMC_CCU4_SLICE_ClearTimer(handle_ptr->ccu4_slice_ptr);
 
-    handle_ptr->state = PWM_CCU4_STATE_STOPPED;
+    handle_ptr->runtime_ptr->state = PWM_CCU4_STATE_STOPPED;
     status = PWM_CCU4_STATUS_SUCCESS;
     XMC_DEBUG("PWM_CCU4_Stop:stop PWM");
   }
@@ -383,7 +385,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Stop(PWM_CCU4_t* handle_ptr)
 } /* end of PWM_CCU4_Stop() api */
 /**********************************************************************************************************/
 /*Gets the timer value of  CCU4_CC4 slice. */
-uint32_t PWM_CCU4_GetTimerValue(PWM_CCU4_t* handle_ptr)
+uint32_t PWM_CCU4_GetTimerValue(const PWM_CCU4_t* handle_ptr)
 {
   uint32_t timer_value;
   XMC_ASSERT("PWM_CCU4_GetTimerValue:handle_ptr NULL", (handle_ptr != NULL));
@@ -393,7 +395,7 @@ uint32_t PWM_CCU4_GetTimerValue(PWM_CCU4_t* handle_ptr)
 }/* end of PWM_CCU4_GetTimerValue() api */
 /**********************************************************************************************************/
 /*Gets the status of  CCU4_CC4 slice. */
-bool PWM_CCU4_GetTimerStatus(PWM_CCU4_t* handle_ptr)
+bool PWM_CCU4_GetTimerStatus(const PWM_CCU4_t* handle_ptr)
 {
   bool status_timer;
   XMC_ASSERT("PWM_CCU4_GetTimerStatus:handle_ptr NULL", (handle_ptr != NULL));
@@ -405,7 +407,7 @@ bool PWM_CCU4_GetTimerStatus(PWM_CCU4_t* handle_ptr)
 /**********************************************************************************************************/
 
 /*Sets the frequency for CCU4_CC4 slice. */
-PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz)
+PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(const PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz)
 {
   PWM_CCU4_STATUS_t status;
   uint32_t frequency_tclk;
@@ -416,7 +418,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz)
   status = PWM_CCU4_STATUS_FAILURE;
   frequency_tclk = 0U;
   XMC_ASSERT("PWM_CCU4_SetFreq:handle_ptr NULL", (handle_ptr != NULL));
-  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->state)
+  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->runtime_ptr->state)
   {
     if (0U == pwm_freq_hz)
     {
@@ -424,7 +426,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz)
     }
     else
     {
-      frequency_tclk = handle_ptr->frequency_tclk;
+      frequency_tclk = handle_ptr->runtime_ptr->frequency_tclk;
       period = frequency_tclk / pwm_freq_hz;
 
       if ((uint32_t) XMC_CCU4_SLICE_TIMER_COUNT_MODE_CA == handle_ptr->config_ptr->ccu4_cc4_slice_timer_ptr->timer_mode)
@@ -435,7 +437,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz)
       if ((period != 0U) && (period <= PWM_CCU4_MAX_TIMER_COUNT))
       {
         /*Calculate the current duty cycle in no-timer concatenation mode*/
-        duty = handle_ptr->sym_duty;
+        duty = handle_ptr->runtime_ptr->sym_duty;
 
         duty = (PWM_CCU4_DUTY_FULL_SCALE - duty);
         duty = duty * period;
@@ -458,15 +460,16 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz)
 /**********************************************************************************************************/
 
 /*Sets the duty cycle (uint32_t) for CCU4_CC4 slice. */
-PWM_CCU4_STATUS_t PWM_CCU4_SetDutyCycle(PWM_CCU4_t* handle_ptr, uint32_t duty_cycle)
+PWM_CCU4_STATUS_t PWM_CCU4_SetDutyCycle(const PWM_CCU4_t* handle_ptr, uint32_t duty_cycle)
 {
   PWM_CCU4_STATUS_t status;
   uint32_t period;
   uint32_t compare;
 
+  FUNCPROF_ENTER();
   status = PWM_CCU4_STATUS_FAILURE;
   XMC_ASSERT("PWM_CCU4_SetDutyCycle:handle_ptr NULL", (handle_ptr != NULL));
-  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->state)
+  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->runtime_ptr->state)
   {
     /* duty cycle has to be in between 0 and 100 */
     if ((duty_cycle > PWM_CCU4_SYM_DUTY_MAX))
@@ -483,19 +486,20 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetDutyCycle(PWM_CCU4_t* handle_ptr, uint32_t duty_cy
       XMC_CCU4_SLICE_SetTimerCompareMatch(handle_ptr->ccu4_slice_ptr, (uint16_t) compare);
       XMC_CCU4_EnableShadowTransfer(handle_ptr->ccu4_module_ptr, handle_ptr->shadow_txfr_msk);
 
-      handle_ptr->sym_duty = duty_cycle;
+      handle_ptr->runtime_ptr->sym_duty = duty_cycle;
 
       XMC_DEBUG("PWM_CCU4_SetDutyCycle:dutycycle set");
       status = PWM_CCU4_STATUS_SUCCESS;
     }
   }
+  FUNCPROF_EXIT(FUNCPROF_PWM_DUTY);
   return (status);
 } /* end of PWM_CCU4_SetDutyCycle() api */
 
 /**********************************************************************************************************/
 
 /*Sets the frequency and duty cycle for CCU4_CC4 slice Symmetric Mode. */
-PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz, uint32_t duty)
+PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(const PWM_CCU4_t* handle_ptr, uint32_t pwm_freq_hz, uint32_t duty)
 {
 
   PWM_CCU4_STATUS_t status;
@@ -506,7 +510,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(PWM_CCU4_t* handle_ptr, uint32_t
   status = PWM_CCU4_STATUS_FAILURE;
   frequency_tclk = 0U;
   XMC_ASSERT("PWM_CCU4_SetFreqAndDutyCycle:handle_ptr NULL", (handle_ptr != NULL));
-  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->state)
+  if (PWM_CCU4_STATE_UNINITIALIZED != handle_ptr->runtime_ptr->state)
   {
     if (0U == pwm_freq_hz)
     {
@@ -518,7 +522,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(PWM_CCU4_t* handle_ptr, uint32_t
     }
     else
     {
-      frequency_tclk = handle_ptr->frequency_tclk;
+      frequency_tclk = handle_ptr->runtime_ptr->frequency_tclk;
       period = frequency_tclk / pwm_freq_hz;
 
       if ((uint32_t) XMC_CCU4_SLICE_TIMER_COUNT_MODE_CA == handle_ptr->config_ptr->ccu4_cc4_slice_timer_ptr->timer_mode)
@@ -536,7 +540,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(PWM_CCU4_t* handle_ptr, uint32_t
 
         XMC_CCU4_EnableShadowTransfer(handle_ptr->ccu4_module_ptr, handle_ptr->shadow_txfr_msk);
 
-        handle_ptr->sym_duty = duty;
+        handle_ptr->runtime_ptr->sym_duty = duty;
 
         XMC_DEBUG("PWM_CCU4_SetFreqAndDutyCycle:frequency set");
         status = PWM_CCU4_STATUS_SUCCESS;
@@ -550,7 +554,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(PWM_CCU4_t* handle_ptr, uint32_t
 /**********************************************************************************************************/
 
 /*Sets the dither value, enables the dither. */
-void PWM_CCU4_SetDither(PWM_CCU4_t* handle_ptr, bool dither_period, bool dither_comp, uint8_t dither_value)
+void PWM_CCU4_SetDither(const PWM_CCU4_t* handle_ptr, bool dither_period, bool dither_comp, uint8_t dither_value)
 {
 
   XMC_ASSERT("PWM_CCU4_SetDither:handle_ptr NULL", (handle_ptr != NULL));
@@ -563,7 +567,7 @@ void PWM_CCU4_SetDither(PWM_CCU4_t* handle_ptr, bool dither_period, bool dither_
 /**********************************************************************************************************/
 
 /*exits trap condition if trap signal is inactive */
-void PWM_CCU4_ClearTrap(PWM_CCU4_t* handle_ptr)
+void PWM_CCU4_ClearTrap(const PWM_CCU4_t* handle_ptr)
 {
 
   XMC_ASSERT("PWM_CCU4_ClearTrap:handle_ptr NULL", (handle_ptr != NULL));
@@ -575,7 +579,7 @@ void PWM_CCU4_ClearTrap(PWM_CCU4_t* handle_ptr)
 /**********************************************************************************************************/
 
 /*Gets the interrupt status of  CCU4_CC4 slice. */
-bool PWM_CCU4_GetInterruptStatus(PWM_CCU4_t* handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt)
+bool PWM_CCU4_GetInterruptStatus(const PWM_CCU4_t* handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt)
 {
   bool status = (bool) false;
   XMC_ASSERT("PWM_CCU4_GetInterruptStatus:handle_ptr NULL", (handle_ptr != NULL));
@@ -586,7 +590,7 @@ bool PWM_CCU4_GetInterruptStatus(PWM_CCU4_t* handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t
 /**********************************************************************************************************/
 
 /*Acknowledges the interrupt of  CCU4_CC4 slice. */
-void PWM_CCU4_ClearEvent(PWM_CCU4_t* handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt)
+void PWM_CCU4_ClearEvent(const PWM_CCU4_t* handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt)
 {
   XMC_ASSERT("PWM_CCU4_ClearEvent:handle_ptr NULL", (handle_ptr != NULL));
   XMC_CCU4_SLICE_ClearEvent(handle_ptr->ccu4_slice_ptr, pwm_interrupt);
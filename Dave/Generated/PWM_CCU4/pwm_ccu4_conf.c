@@ -179,10 +179,16 @@
       .gpio_ch_out_pin                     = 0U,
       .gpio_ch_out_config_ptr              = NULL,    
 
-      .global_ccu4_handle                   = (GLOBAL_CCU4_t*) &GLOBAL_CCU4_0,
+      .global_ccu4_handle                   = (const GLOBAL_CCU4_t*) &GLOBAL_CCU4_0,
     };
 
-    PWM_CCU4_t PWM_CCU4_LED_STATUS =
+    PWM_CCU4_RUNTIME_t PWM_CCU4_LED_STATUS_runtime =
+    {
+      .state                               = PWM_CCU4_STATE_UNINITIALIZED,
+      .sym_duty                            = 10000U,
+    };
+
+    const PWM_CCU4_t PWM_CCU4_LED_STATUS =
     {
       .config_ptr                          = &PWM_CCU4_LED_STATUS_config_handle,
       .ccu4_module_ptr                     = (XMC_CCU4_MODULE_t*) CCU40_BASE,
@@ -193,9 +199,7 @@
       .dither_shadow_txfr_msk              = (uint32_t)XMC_CCU4_SHADOW_TRANSFER_DITHER_SLICE_0,
       .prescaler_shadow_txfr_msk           = (uint32_t)XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_0,
 
-      .state                               = PWM_CCU4_STATE_UNINITIALIZED,
-      .sym_duty                            = 10000U,
-
+      .runtime_ptr                         = &PWM_CCU4_LED_STATUS_runtime,
     };
 
 /********************************************************************************************************/
@@ -64,7 +64,7 @@
 ***********************************************************************************************************************/
 
 
-    extern PWM_CCU4_t PWM_CCU4_LED_STATUS;
+    extern const PWM_CCU4_t PWM_CCU4_LED_STATUS;
 
 #endif
 
@@ -81,6 +81,10 @@
 
 /* Included to access APP data structure, functions & enumerations */
 #include "systimer.h"
+/* Function profiler markers of the application (empty unless FUNCPROF_ENABLED) */
+#include "funcprof.h"
+/* CCU4 microsecond time base of the application (TIMEBASE_ENABLED) */
+#include "timebase.h"
 
 /***********************************************************************************************************************
  * MACROS
@@ -88,6 +92,52 @@
 
 #define HW_TIMER_ADDITIONAL_CNT (1U)
 
+/* A timer ID holds the table index + 1 in its low bits and the generation of the table entry above them. The
+ * generation is advanced when a timer is deleted, so IDs of deleted timers no longer match their table entry.
+ */
+#define SYSTIMER_ID_INDEX_BITS (8U)
+#define SYSTIMER_ID_INDEX_MASK ((1U << SYSTIMER_ID_INDEX_BITS) - 1U)
+#define SYSTIMER_ID_GENERATION_STEP (1U << SYSTIMER_ID_INDEX_BITS)
+#if (SYSTIMER_CFG_POOL_SIZE > SYSTIMER_ID_INDEX_MASK)
+#error "SYSTIMER: SYSTIMER_CFG_POOL_SIZE exceeds the index bits of the timer ID"
+#endif
+
+/* SysTick clock cycles of one tick */
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+/* A tick lasts SYSTIMER_TIME_WARP_FACTOR times shorter, every conversion between ticks and cycles follows */
+#define SYSTIMER_TICK_CLOCKS (((SYSTIMER_SYSTICK_CLOCK / 1000000U) * SYSTIMER_TICK_PERIOD_US) / SYSTIMER_TIME_WARP_FACTOR)
+#if ((((SYSTIMER_SYSTICK_CLOCK / 1000000U) * SYSTIMER_TICK_PERIOD_US) % SYSTIMER_TIME_WARP_FACTOR) != 0U)
+#error "SYSTIMER: a tick must be a whole number of cycles at SYSTIMER_TIME_WARP_FACTOR"
+#endif
+#else
+#define SYSTIMER_TICK_CLOCKS ((SYSTIMER_SYSTICK_CLOCK / 1000000U) * SYSTIMER_TICK_PERIOD_US)
+#endif
+
+#ifdef SYSTIMER_CLOCK_SCALING_ENABLED
+/* SysTick counts at SYSTIMER_SYSTICK_CLOCK >> g_clock_shift, all cycle values are kept at SYSTIMER_SYSTICK_CLOCK */
+#define SYSTIMER_COUNTS_TO_CYCLES(counts) ((counts) << g_clock_shift)
+#define SYSTIMER_CYCLES_TO_COUNTS(cycles) ((cycles) >> g_clock_shift)
+/* Cycles a clock change leaves at least until the next wrap */
+#define SYSTIMER_CLOCK_CHANGE_MIN_COUNTS (64U)
+#else
+#define SYSTIMER_COUNTS_TO_CYCLES(counts) (counts)
+#define SYSTIMER_CYCLES_TO_COUNTS(cycles) (cycles)
+#endif
+
+#ifdef SYSTIMER_ISR_IN_RAM
+/* Code executed every tick, runs without flash wait states */
+#define SYSTIMER_RAM_FUNC __RAM_FUNC
+#else
+#define SYSTIMER_RAM_FUNC
+#endif
+
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/* Longest SysTick period in ticks (24 bit reload value) */
+#define SYSTIMER_TICKLESS_MAX_TICKS ((SysTick_LOAD_RELOAD_Msk + 1U) / SYSTIMER_TICK_CLOCKS)
+/* Cycles a restart of the SysTick counter leaves at least until the next wrap */
+#define SYSTIMER_TICKLESS_MIN_CYCLES (64U)
+#endif
+
 /***********************************************************************************************************************
  * LOCAL DATA
  **********************************************************************************************************************/
@@ -101,24 +151,89 @@ typedef struct SYSTIMER_OBJECT
   SYSTIMER_MODE_t mode; /**< timer Type (single shot or periodic) */
   SYSTIMER_STATE_t state; /**< timer state */
   void *args; /**< Parameter to callback function */
-  uint32_t id; /**< timer ID */
+  uint32_t id; /**< Index of the timer in g_timer_tbl */
+  uint32_t handle; /**< timer ID (index + 1 and generation) */
   uint32_t count; /**< timer count value */
   uint32_t reload; /**< timer Reload count value */
-  bool delete_swtmr; /**< To delete the timer */
+#ifdef SYSTIMER_DEFERRED_ENABLED
+  bool deferred; /**< Callback is run by SYSTIMER_DispatchDeferred instead of the SysTick handler */
+  volatile bool pending; /**< Expiration is posted to the deferred queue and not dispatched yet */
+#endif
+#ifdef SYSTIMER_TIMER_WHEEL_ENABLED
+  uint32_t expires; /**< SysTick count at which the running timer expires */
+  struct SYSTIMER_OBJECT **slot; /**< Wheel slot which holds the running timer */
+#endif
 } SYSTIMER_OBJECT_t;
 
 /** Table which save timer control block. */
-SYSTIMER_OBJECT_t g_timer_tbl[SYSTIMER_CFG_MAX_TMR];
-
+SYSTIMER_OBJECT_t g_timer_tbl[SYSTIMER_CFG_POOL_SIZE];
+
+#ifdef SYSTIMER_TIMER_WHEEL_ENABLED
+#define SYSTIMER_WHEEL_SLOTS (1U << SYSTIMER_WHEEL_BITS)
+#define SYSTIMER_WHEEL_MASK (SYSTIMER_WHEEL_SLOTS - 1U)
+#if ((SYSTIMER_WHEEL_BITS * SYSTIMER_WHEEL_LEVELS) >= 32U)
+#error "SYSTIMER: The timer wheel must span less than 2^32 ticks"
+#endif
+/* Time span of the wheel in ticks, timers further ahead are put into its last slot in reach and sorted in again */
+#define SYSTIMER_WHEEL_SPAN (1U << (SYSTIMER_WHEEL_BITS * SYSTIMER_WHEEL_LEVELS))
+
+/* Timer wheel: level n holds the running timers expiring in less than 2^(SYSTIMER_WHEEL_BITS * (n + 1)) ticks, a slot
+ * of level n covers 2^(SYSTIMER_WHEEL_BITS * n) ticks and is a doubly linked list in no particular order.
+ */
+SYSTIMER_OBJECT_t *g_timer_wheel[SYSTIMER_WHEEL_LEVELS][SYSTIMER_WHEEL_SLOTS];
+#else
 /* The header of the timer Control list. */
 SYSTIMER_OBJECT_t *g_timer_list = NULL;
+#endif
 
-/* Timer ID tracker */
-uint32_t g_timer_tracker = 0U;
+/* List of the free timers (linked by next) */
+SYSTIMER_OBJECT_t *g_timer_free = NULL;
 
 /* SysTick counter */
 volatile uint32_t g_systick_count = 0U;
 
+/* Upper 32 bit of the SysTick counter (incremented on wrap of g_systick_count) */
+volatile uint32_t g_systick_count_high = 0U;
+
+#ifdef SYSTIMER_DEFERRED_ENABLED
+#define SYSTIMER_DEFERRED_QUEUE_MASK (SYSTIMER_DEFERRED_QUEUE_SIZE - 1U)
+#if ((SYSTIMER_DEFERRED_QUEUE_SIZE & SYSTIMER_DEFERRED_QUEUE_MASK) != 0U)
+#error "SYSTIMER: SYSTIMER_DEFERRED_QUEUE_SIZE must be a power of 2"
+#endif
+
+/* Deferred queue: table indices of expired deferred timers, written by the SysTick handler only (head) and read by
+ * SYSTIMER_DispatchDeferred only (tail), so no lock is needed
+ */
+uint8_t g_deferred_queue[SYSTIMER_DEFERRED_QUEUE_SIZE];
+volatile uint32_t g_deferred_head = 0U;
+volatile uint32_t g_deferred_tail = 0U;
+
+/* Expirations dropped because the deferred queue was full */
+volatile uint32_t g_deferred_overflows = 0U;
+
+/* Called (SysTick context) whenever an expiration was posted */
+SYSTIMER_CALLBACK_t g_deferred_notify = NULL;
+void *g_deferred_notify_args = NULL;
+#endif
+
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/* Ticks of the running SysTick period, SysTick->LOAD - SysTick->VAL are the cycles since tick g_systick_count */
+volatile uint32_t g_tickless_ticks = 1U;
+
+/* SysTick handler is accounting ticks, timers started by callbacks are relative to g_systick_count */
+bool g_systick_in_handler = false;
+#endif
+
+#ifdef SYSTIMER_CLOCK_SCALING_ENABLED
+/* CPU clock divider (power of 2) against SYSTIMER_SYSTICK_CLOCK */
+uint32_t g_clock_shift = 0U;
+#endif
+
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+/* Ticks of requested jumps the SysTick handler has not stepped through yet */
+volatile uint32_t g_warp_ticks = 0U;
+#endif
+
 /***********************************************************************************************************************
  * LOCAL ROUTINES
  **********************************************************************************************************************/
@@ -138,6 +253,62 @@ static void SYSTIMER_lRemoveTimerList(uint32_t tbl_index);
  */
 static void SYSTIMER_lTimerHandler(void);
 
+/*
+ * This function is called to look up the timer of an ID.
+ */
+static SYSTIMER_OBJECT_t *SYSTIMER_lGetTimer(uint32_t id);
+
+/*
+ * This function is called to run the callback of an expired timer or to post it to the deferred queue.
+ */
+static void SYSTIMER_lExpire(SYSTIMER_OBJECT_t *object_ptr);
+
+#ifdef SYSTIMER_TIMER_WHEEL_ENABLED
+/*
+ * This function is called to put a timer into the wheel slot of its expiry time.
+ */
+static void SYSTIMER_lWheelAdd(SYSTIMER_OBJECT_t *object_ptr);
+
+/*
+ * This function is called to sort the timers of a higher level slot into the lower levels.
+ */
+static void SYSTIMER_lWheelCascade(uint32_t level, uint32_t index);
+#endif
+
+/*
+ * This function is called to advance the SysTick count by a number of ticks and to expire the timers due.
+ */
+static void SYSTIMER_lAdvance(uint32_t ticks);
+
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/*
+ * This function is called to get the SysTick cycles since tick g_systick_count.
+ */
+static uint32_t SYSTIMER_lTicklessElapsed(void);
+
+/*
+ * This function is called to get the ticks from g_systick_count until the next timer expires.
+ */
+static uint32_t SYSTIMER_lTicklessNextTicks(void);
+
+/*
+ * This function is called to let the running SysTick period end a number of ticks after tick g_systick_count.
+ */
+static void SYSTIMER_lTicklessRestart(uint32_t ticks);
+
+/*
+ * This function is called to insert a started timer into the timer list while SysTick may be in a long period.
+ */
+static void SYSTIMER_lTicklessInsert(uint32_t tbl_index);
+#endif
+
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+/*
+ * This function is called to step through the next part of a requested jump (SysTick handler).
+ */
+static void SYSTIMER_lWarpStep(void);
+#endif
+
 /*
  * SysTick handler which is the main interrupt service routine to service the
  * system timer's configured
@@ -147,6 +318,269 @@ void SysTick_Handler(void);
 /**********************************************************************************************************************
 * API IMPLEMENTATION
 **********************************************************************************************************************/
+__attribute__((always_inline)) __STATIC_INLINE uint32_t critical_section_enter(void)
+{
+  uint32_t status;
+  status = __get_PRIMASK();
+  __disable_irq ();
+  return status;
+}
+
+__attribute__((always_inline)) __STATIC_INLINE void critical_section_exit(uint32_t status)
+{
+  __set_PRIMASK(status);
+}
+
+/*
+ * This function is called to look up the timer of an ID, returns NULL for an invalid or stale ID.
+ */
+static SYSTIMER_OBJECT_t *SYSTIMER_lGetTimer(uint32_t id)
+{
+  SYSTIMER_OBJECT_t *object_ptr = NULL;
+  uint32_t tbl_index;
+
+  /* ID 0 wraps to an index out of range */
+  tbl_index = (id & SYSTIMER_ID_INDEX_MASK) - 1U;
+  if (tbl_index < SYSTIMER_CFG_POOL_SIZE)
+  {
+    if ((id == g_timer_tbl[tbl_index].handle) && (SYSTIMER_STATE_NOT_INITIALIZED != g_timer_tbl[tbl_index].state))
+    {
+      object_ptr = &g_timer_tbl[tbl_index];
+    }
+  }
+
+  return (object_ptr);
+}
+
+/*
+ * This function is called to run the callback of an expired timer or to post it to the deferred queue.
+ */
+static void SYSTIMER_lExpire(SYSTIMER_OBJECT_t *object_ptr)
+{
+#ifdef SYSTIMER_DEFERRED_ENABLED
+  uint32_t head;
+
+  if (true == object_ptr->deferred)
+  {
+    /* Not dispatched since its last expiration, the expirations are merged into one callback */
+    if (false == object_ptr->pending)
+    {
+      head = g_deferred_head;
+      if ((head - g_deferred_tail) < SYSTIMER_DEFERRED_QUEUE_SIZE)
+      {
+        g_deferred_queue[head & SYSTIMER_DEFERRED_QUEUE_MASK] = (uint8_t)object_ptr->id;
+        object_ptr->pending = true;
+        /* Publish the entry after it is written */
+        g_deferred_head = head + 1U;
+        if (NULL != g_deferred_notify)
+        {
+          (g_deferred_notify)(g_deferred_notify_args);
+        }
+      }
+      else
+      {
+        g_deferred_overflows++;
+      }
+    }
+  }
+  else
+#endif
+  {
+    /* Call timer callback function */
+    (object_ptr->callback)(object_ptr->args);
+  }
+}
+
+#ifdef SYSTIMER_TIMER_WHEEL_ENABLED
+/*
+ * This function is called to put a timer into the wheel slot of its expiry time.
+ */
+static void SYSTIMER_lWheelAdd(SYSTIMER_OBJECT_t *object_ptr)
+{
+  SYSTIMER_OBJECT_t **slot_ptr;
+  uint32_t delta_ticks;
+  uint32_t slot_time;
+  uint32_t level = 0U;
+  uint32_t shift = 0U;
+
+  delta_ticks = object_ptr->expires - g_systick_count;
+  /* Timer expires beyond the wheel, put it into the last slot in reach (it is sorted in again when cascaded) */
+  if (delta_ticks >= SYSTIMER_WHEEL_SPAN)
+  {
+    delta_ticks = SYSTIMER_WHEEL_SPAN - 1U;
+  }
+  slot_time = g_systick_count + delta_ticks;
+  /* Find the lowest level whose slots reach the expiry time */
+  while ((level < (SYSTIMER_WHEEL_LEVELS - 1U)) && (delta_ticks >= (SYSTIMER_WHEEL_SLOTS << shift)))
+  {
+    level++;
+    shift += SYSTIMER_WHEEL_BITS;
+  }
+  slot_ptr = &g_timer_wheel[level][(slot_time >> shift) & SYSTIMER_WHEEL_MASK];
+
+  /* Insert as first item of the slot */
+  object_ptr->slot = slot_ptr;
+  object_ptr->prev = NULL;
+  object_ptr->next = *slot_ptr;
+  if (NULL != *slot_ptr)
+  {
+    (*slot_ptr)->prev = object_ptr;
+  }
+  *slot_ptr = object_ptr;
+}
+
+/*
+ * This function is called to sort the timers of a higher level slot into the lower levels.
+ */
+static void SYSTIMER_lWheelCascade(uint32_t level, uint32_t index)
+{
+  SYSTIMER_OBJECT_t *object_ptr;
+  SYSTIMER_OBJECT_t *next_ptr;
+
+  /* Take the whole slot, each timer is put into the slot of its remaining time */
+  object_ptr = g_timer_wheel[level][index];
+  g_timer_wheel[level][index] = NULL;
+  while (NULL != object_ptr)
+  {
+    next_ptr = object_ptr->next;
+    SYSTIMER_lWheelAdd(object_ptr);
+    object_ptr = next_ptr;
+  }
+}
+
+/*
+ * This function is called to insert a timer into the timer list (count holds the ticks until expiry).
+ */
+static void SYSTIMER_lInsertTimerList(uint32_t tbl_index)
+{
+  g_timer_tbl[tbl_index].expires = g_systick_count + g_timer_tbl[tbl_index].count;
+  SYSTIMER_lWheelAdd(&g_timer_tbl[tbl_index]);
+}
+
+/*
+ * This function is called to remove a timer from the timer list.
+ */
+static void SYSTIMER_lRemoveTimerList(uint32_t tbl_index)
+{
+  SYSTIMER_OBJECT_t *object_ptr;
+  object_ptr = &g_timer_tbl[tbl_index];
+  /* Check if the first item of its slot */
+  if (NULL == object_ptr->prev)
+  {
+    *object_ptr->slot = object_ptr->next;
+  }
+  else
+  {
+    object_ptr->prev->next = object_ptr->next;
+  }
+  if (NULL != object_ptr->next)
+  {
+    object_ptr->next->prev = object_ptr->prev;
+  }
+  object_ptr->next = NULL;
+  object_ptr->prev = NULL;
+}
+
+/*
+ * Handler function called from SysTick event handler.
+ */
+static void SYSTIMER_lTimerHandler(void)
+{
+  SYSTIMER_OBJECT_t *object_ptr;
+  uint32_t level = 1U;
+  uint32_t index;
+
+  /* Lower level wrapped, cascade the slots of the higher levels which begin with this tick */
+  index = g_systick_count & SYSTIMER_WHEEL_MASK;
+  while ((0U == index) && (level < SYSTIMER_WHEEL_LEVELS))
+  {
+    index = (g_systick_count >> (level * SYSTIMER_WHEEL_BITS)) & SYSTIMER_WHEEL_MASK;
+    SYSTIMER_lWheelCascade(level, index);
+    level++;
+  }
+
+  /* All timers of the current level 0 slot expire with this tick (timers restarted by a callback never go into it) */
+  index = g_systick_count & SYSTIMER_WHEEL_MASK;
+  object_ptr = g_timer_wheel[0][index];
+  while (NULL != object_ptr)
+  {
+    /* Remove this timer from timer list */
+    SYSTIMER_lRemoveTimerList((uint32_t)object_ptr->id);
+    /* Check whether timer is a one shot timer */
+    if (SYSTIMER_MODE_ONE_SHOT == object_ptr->mode)
+    {
+      /* Set timer status as SYSTIMER_STATE_STOPPED */
+      object_ptr->state = SYSTIMER_STATE_STOPPED;
+      /* Call timer callback function */
+      SYSTIMER_lExpire(object_ptr);
+    }
+    else
+    {
+      /* Periodic timer, insert it again with its reload value */
+      object_ptr->count = object_ptr->reload;
+      SYSTIMER_lInsertTimerList((uint32_t)object_ptr->id);
+      /* Call timer callback function */
+      SYSTIMER_lExpire(object_ptr);
+    }
+    /* Get first item of the slot */
+    object_ptr = g_timer_wheel[0][index];
+  }
+}
+
+/*
+ * This function is called to advance the SysTick count by a number of ticks and to expire the timers due.
+ */
+SYSTIMER_RAM_FUNC static void SYSTIMER_lAdvance(uint32_t ticks)
+{
+  /* Step the wheel through every tick, each tick only looks at its own level 0 slot */
+  while (ticks > 0U)
+  {
+    g_systick_count++;
+    if (0U == g_systick_count)
+    {
+      g_systick_count_high++;
+    }
+
+    SYSTIMER_lTimerHandler();
+    ticks--;
+  }
+}
+
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/*
+ * This function is called to get the ticks from g_systick_count until the next timer expires.
+ */
+static uint32_t SYSTIMER_lTicklessNextTicks(void)
+{
+  uint32_t next_ticks = SYSTIMER_TICKLESS_MAX_TICKS;
+  uint32_t level;
+  uint32_t shift;
+  uint32_t slot;
+  uint32_t ticks;
+
+  /* Slot k of level n is due (expired or cascaded) at the k-th boundary of 2^(SYSTIMER_WHEEL_BITS * n) ticks */
+  for (level = 0U; level < SYSTIMER_WHEEL_LEVELS; level++)
+  {
+    shift = level * SYSTIMER_WHEEL_BITS;
+    for (slot = 1U; slot <= SYSTIMER_WHEEL_SLOTS; slot++)
+    {
+      ticks = (slot << shift) - (g_systick_count & ((1U << shift) - 1U));
+      if (ticks >= next_ticks)
+      {
+        break;
+      }
+      if (NULL != g_timer_wheel[level][((g_systick_count >> shift) + slot) & SYSTIMER_WHEEL_MASK])
+      {
+        next_ticks = ticks;
+        break;
+      }
+    }
+  }
+
+  return (next_ticks);
+}
+#endif
+#else
 /*
  * This function is called to insert a timer into the timer list.
  */
@@ -266,17 +700,8 @@ static void SYSTIMER_lTimerHandler(void)
   object_ptr = g_timer_list;
   while ((NULL != object_ptr) && (0U == object_ptr->count))
   {
-    if (true == object_ptr->delete_swtmr)
-    {
-      /* Yes, remove this timer from timer list */
-      SYSTIMER_lRemoveTimerList((uint32_t)object_ptr->id);
-      /* Set timer status as SYSTIMER_STATE_NOT_INITIALIZED */
-      object_ptr->state = SYSTIMER_STATE_NOT_INITIALIZED;
-      /* Release resource which are hold by this timer */
-      g_timer_tracker &= ~(1U << object_ptr->id);
-    }
     /* Check whether timer is a one shot timer */
-    else if (SYSTIMER_MODE_ONE_SHOT == object_ptr->mode)
+    if (SYSTIMER_MODE_ONE_SHOT == object_ptr->mode)
     {
       if (SYSTIMER_STATE_RUNNING == object_ptr->state)
       {
@@ -285,7 +710,7 @@ static void SYSTIMER_lTimerHandler(void)
         /* Set timer status as SYSTIMER_STATE_STOPPED */
         object_ptr->state = SYSTIMER_STATE_STOPPED;
         /* Call timer callback function */
-        (object_ptr->callback)(object_ptr->args);
+        SYSTIMER_lExpire(object_ptr);
       }
     }
     /* Check whether timer is periodic timer */
@@ -300,7 +725,7 @@ static void SYSTIMER_lTimerHandler(void)
         /* Insert timer into timer list */
         SYSTIMER_lInsertTimerList((uint32_t)object_ptr->id);
         /* Call timer callback function */
-        (object_ptr->callback)(object_ptr->args);
+        SYSTIMER_lExpire(object_ptr);
       }
     }
     else
@@ -313,19 +738,23 @@ static void SYSTIMER_lTimerHandler(void)
 }
 
 /*
- *  SysTick Event Handler.
+ * This function is called to advance the SysTick count by a number of ticks and to expire the timers due.
  */
-void SysTick_Handler(void)
+SYSTIMER_RAM_FUNC static void SYSTIMER_lAdvance(uint32_t ticks)
 {
   SYSTIMER_OBJECT_t *object_ptr;
   object_ptr = g_timer_list;
-  g_systick_count++;
+  g_systick_count += ticks;
+  if (g_systick_count < ticks)
+  {
+    g_systick_count_high++;
+  }
 
   if (NULL != object_ptr)
   {
-    if (object_ptr->count > 1UL)
+    if (object_ptr->count > ticks)
     {
-      object_ptr->count--;
+      object_ptr->count -= ticks;
     }
     else
     {
@@ -335,6 +764,194 @@ void SysTick_Handler(void)
   }
 }
 
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/*
+ * This function is called to get the ticks from g_systick_count until the next timer expires.
+ */
+static uint32_t SYSTIMER_lTicklessNextTicks(void)
+{
+  uint32_t next_ticks = SYSTIMER_TICKLESS_MAX_TICKS;
+
+  /* The head of the delta list expires first */
+  if ((NULL != g_timer_list) && (g_timer_list->count < next_ticks))
+  {
+    next_ticks = g_timer_list->count;
+  }
+  if (0U == next_ticks)
+  {
+    next_ticks = 1U;
+  }
+
+  return (next_ticks);
+}
+#endif
+#endif
+
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/*
+ * This function is called to get the SysTick cycles since tick g_systick_count (interrupts masked).
+ */
+static uint32_t SYSTIMER_lTicklessElapsed(void)
+{
+  uint32_t elapsed = 0U;
+
+  if (false == g_systick_in_handler)
+  {
+    elapsed = SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - SysTick->VAL);
+    /* Counter wrapped but the SysTick exception is not handled yet - the whole period passed */
+    if (0U != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+      elapsed = (g_tickless_ticks * SYSTIMER_TICK_CLOCKS) + SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - SysTick->VAL);
+    }
+  }
+
+  return (elapsed);
+}
+
+/*
+ * This function is called to let the running SysTick period end a number of ticks after tick g_systick_count
+ * (interrupts masked).
+ */
+static void SYSTIMER_lTicklessRestart(uint32_t ticks)
+{
+  uint32_t value;
+  uint32_t elapsed;
+
+  value = SysTick->VAL;
+  /* Counter wrapped or is about to, the SysTick exception accounts the period and programs the next one */
+  if ((0U == (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) && (value >= SYSTIMER_TICKLESS_MIN_CYCLES))
+  {
+    elapsed = SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - value);
+    /* Deadline already passed (e.g. long callbacks), end the period as soon as possible */
+    if ((elapsed + SYSTIMER_TICKLESS_MIN_CYCLES) >= (ticks * SYSTIMER_TICK_CLOCKS))
+    {
+      ticks = ((elapsed + SYSTIMER_TICKLESS_MIN_CYCLES) / SYSTIMER_TICK_CLOCKS) + 1U;
+    }
+    if (ticks <= SYSTIMER_TICKLESS_MAX_TICKS)
+    {
+      /* Restart the counter with the rest of the period */
+      SysTick->LOAD = SYSTIMER_CYCLES_TO_COUNTS((ticks * SYSTIMER_TICK_CLOCKS) - elapsed) - 1U;
+      SysTick->VAL = 0U;
+      /* Wait for the reload, then set the full period again so LOAD - VAL count the cycles since the last tick */
+      while (0U == SysTick->VAL)
+      {
+      }
+      SysTick->LOAD = SYSTIMER_CYCLES_TO_COUNTS(ticks * SYSTIMER_TICK_CLOCKS) - 1U;
+      g_tickless_ticks = ticks;
+    }
+  }
+}
+
+/*
+ * This function is called to insert a started timer into the timer list while SysTick may be in a long period.
+ */
+static void SYSTIMER_lTicklessInsert(uint32_t tbl_index)
+{
+  uint32_t ics;
+  uint32_t ticks;
+
+  if (true == g_systick_in_handler)
+  {
+    /* Started by a callback, the SysTick handler programs the next period when all timers are handled */
+    SYSTIMER_lInsertTimerList(tbl_index);
+  }
+  else
+  {
+    ics = critical_section_enter();
+
+    /* The timer list counts from tick g_systick_count, add the ticks which passed in the running period */
+    g_timer_tbl[tbl_index].count += SYSTIMER_lTicklessElapsed() / SYSTIMER_TICK_CLOCKS;
+    ticks = g_timer_tbl[tbl_index].count;
+    SYSTIMER_lInsertTimerList(tbl_index);
+    /* End the running period earlier if the timer expires before it */
+    if (ticks < g_tickless_ticks)
+    {
+      SYSTIMER_lTicklessRestart(ticks);
+    }
+
+    critical_section_exit(ics);
+  }
+}
+#endif
+
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+/*
+ * This function is called to step through the next part of a requested jump (SysTick handler).
+ */
+SYSTIMER_RAM_FUNC static void SYSTIMER_lWarpStep(void)
+{
+  uint32_t step;
+
+  step = g_warp_ticks;
+  if (step > SYSTIMER_TIME_WARP_STEP)
+  {
+    step = SYSTIMER_TIME_WARP_STEP;
+  }
+  g_warp_ticks -= step;
+  SYSTIMER_lAdvance(step);
+}
+#endif
+
+#ifdef SYSTIMER_ISR_HOOK_ENABLED
+/*
+ * Default ISR hook, does nothing.
+ */
+__WEAK void SYSTIMER_IsrHook(uint32_t latency, uint32_t cycles)
+{
+  (void)latency;
+  (void)cycles;
+}
+#endif
+
+/*
+ *  SysTick Event Handler.
+ */
+SYSTIMER_RAM_FUNC void SysTick_Handler(void)
+{
+#ifdef SYSTIMER_TICKLESS_ENABLED
+  uint32_t next_ticks;
+#endif
+#ifdef SYSTIMER_ISR_HOOK_ENABLED
+  uint32_t entry;
+
+  /* Cycles since the wrap, a restart of the tickless period keeps LOAD - VAL counting from that wrap */
+  entry = SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - SysTick->VAL);
+#endif
+  FUNCPROF_ENTER();
+#ifdef SYSTIMER_TICKLESS_ENABLED
+  /* Account all ticks of the period which just ended */
+  g_systick_in_handler = true;
+  SYSTIMER_lAdvance(g_tickless_ticks);
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+  SYSTIMER_lWarpStep();
+#endif
+  g_systick_in_handler = false;
+
+  /* Sleep until the next timer expires (or for the longest period if none is running) */
+  next_ticks = SYSTIMER_lTicklessNextTicks();
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+  /* The rest of a jump goes on with the next tick */
+  if (0U != g_warp_ticks)
+  {
+    next_ticks = 1U;
+  }
+#endif
+  if (next_ticks != g_tickless_ticks)
+  {
+    SYSTIMER_lTicklessRestart(next_ticks);
+  }
+#else
+  SYSTIMER_lAdvance(1U);
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+  SYSTIMER_lWarpStep();
+#endif
+#endif
+  FUNCPROF_EXIT(FUNCPROF_SYSTICK);
+#ifdef SYSTIMER_ISR_HOOK_ENABLED
+  SYSTIMER_IsrHook(entry, SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - SysTick->VAL) - entry);
+#endif
+}
+
 /** @ingroup Simple_System_Timer_App PublicFunc
  * @{
  */
@@ -356,21 +973,37 @@ DAVE_APP_VERSION_t SYSTIMER_GetAppVersion()
 /*
  * Initialization function which initializes the SYSTIMER APP, configures SysTick timer and SysTick exception.
  */
-SYSTIMER_STATUS_t SYSTIMER_Init(SYSTIMER_t *handle)
+SYSTIMER_STATUS_t SYSTIMER_Init(const SYSTIMER_t *const handle)
 {
   SYSTIMER_STATUS_t status = SYSTIMER_STATUS_SUCCESS;
+  uint32_t tbl_index;
+#ifdef SYSTIMER_TIMER_WHEEL_ENABLED
+  uint32_t level;
+  uint32_t index;
+#endif
 
   XMC_ASSERT("SYSTIMER_Init: SYSTIMER APP handle pointer uninitialized", (handle != NULL));
 
   /* Check APP initialization status to ensure whether SYSTIMER_Init called or not, initialize SYSTIMER if
    * SYSTIMER_Init called first time.
    */
-  if (false == handle->init_status)
+  if (false == handle->runtime_ptr->init_status)
   {
+#ifdef SYSTIMER_TIMER_WHEEL_ENABLED
+    /* Initialize the slots of the wheel */
+    for (level = 0U; level < SYSTIMER_WHEEL_LEVELS; level++)
+    {
+      for (index = 0U; index < SYSTIMER_WHEEL_SLOTS; index++)
+      {
+        g_timer_wheel[level][index] = NULL;
+      }
+    }
+#else
     /* Initialize the header of the list */
     g_timer_list = NULL;
+#endif
     /* Initialize SysTick timer */
-    status = (SYSTIMER_STATUS_t)SysTick_Config((uint32_t)(SYSTIMER_SYSTICK_CLOCK * SYSTIMER_TICK_PERIOD));
+    status = (SYSTIMER_STATUS_t)SysTick_Config((uint32_t)SYSTIMER_TICK_CLOCKS);
 
     if (SYSTIMER_STATUS_FAILURE == status)
     {
@@ -386,9 +1019,19 @@ SYSTIMER_STATUS_t SYSTIMER_Init(SYSTIMER_t *handle)
       /* setting of priority value for XMC1000 devices */
       NVIC_SetPriority(SysTick_IRQn, SYSTIMER_PRIORITY);
 #endif      
-      g_timer_tracker = 0U;
+      /* Put all timers into the free list, the first timer is allocated first */
+      g_timer_free = NULL;
+      for (tbl_index = SYSTIMER_CFG_POOL_SIZE; tbl_index > 0U; tbl_index--)
+      {
+        g_timer_tbl[tbl_index - 1U].id = tbl_index - 1U;
+        g_timer_tbl[tbl_index - 1U].handle = tbl_index;
+        g_timer_tbl[tbl_index - 1U].state = SYSTIMER_STATE_NOT_INITIALIZED;
+        g_timer_tbl[tbl_index - 1U].prev = NULL;
+        g_timer_tbl[tbl_index - 1U].next = g_timer_free;
+        g_timer_free = &g_timer_tbl[tbl_index - 1U];
+      }
       /* Update the Initialization status of the SYSTIMER APP instance */
-      handle->init_status = true;
+      handle->runtime_ptr->init_status = true;
       status = SYSTIMER_STATUS_SUCCESS;
     }
   }
@@ -407,9 +1050,10 @@ uint32_t SYSTIMER_CreateTimer
   void  *args
 )
 {
+  uint32_t ics;
   uint32_t id = 0U;
-  uint32_t count = 0U;
   uint32_t period_ratio = 0U;
+  SYSTIMER_OBJECT_t *object_ptr;
 
   XMC_ASSERT("SYSTIMER_CreateTimer: Timer creation failure due to invalid period value",
             ((period >= SYSTIMER_TICK_PERIOD_US) && (period > 0U) && (period <= 0xFFFFFFFFU)));
@@ -417,35 +1061,36 @@ uint32_t SYSTIMER_CreateTimer
             ((SYSTIMER_MODE_ONE_SHOT == mode) || (SYSTIMER_MODE_PERIODIC == mode)));
   XMC_ASSERT("SYSTIMER_CreateTimer: Can not create software without user callback", (NULL != callback));
   
-  if (period < SYSTIMER_TICK_PERIOD_US)
+  /* Callbacks may create and delete timers, the free list is only changed with interrupts masked */
+  ics = critical_section_enter();
+  object_ptr = g_timer_free;
+  if ((period >= SYSTIMER_TICK_PERIOD_US) && (NULL != object_ptr))
   {
-    id = 0U;
+    /* Take the first free timer */
+    g_timer_free = object_ptr->next;
   }
   else
   {
-    for (count = 0U; count < SYSTIMER_CFG_MAX_TMR; count++)
-    {
-      /* Check for free timer ID */
-      if (0U == (g_timer_tracker & (1U << count)))
-      {
-        /* If yes, assign ID to this timer */
-        g_timer_tracker |= (1U << count);
-        /* Initialize the timer as per input values */
-        g_timer_tbl[count].id     = count;
-        g_timer_tbl[count].mode   = mode;
-        g_timer_tbl[count].state  = SYSTIMER_STATE_STOPPED;
-        period_ratio = (uint32_t)(period / SYSTIMER_TICK_PERIOD_US);
-        g_timer_tbl[count].count  = (period_ratio + HW_TIMER_ADDITIONAL_CNT);
-        g_timer_tbl[count].reload  = period_ratio;
-        g_timer_tbl[count].callback = callback;
-        g_timer_tbl[count].args = args;
-        g_timer_tbl[count].prev   = NULL;
-        g_timer_tbl[count].next   = NULL;
-        id = count + 1U;
-        break;
-      }
-    }
-
+    object_ptr = NULL;
+  }
+  critical_section_exit(ics);
+  if (NULL != object_ptr)
+  {
+    /* Initialize the timer as per input values */
+    object_ptr->mode   = mode;
+    object_ptr->state  = SYSTIMER_STATE_STOPPED;
+    period_ratio = (uint32_t)(period / SYSTIMER_TICK_PERIOD_US);
+    object_ptr->count  = (period_ratio + HW_TIMER_ADDITIONAL_CNT);
+    object_ptr->reload  = period_ratio;
+    object_ptr->callback = callback;
+    object_ptr->args = args;
+    object_ptr->prev   = NULL;
+    object_ptr->next   = NULL;
+#ifdef SYSTIMER_DEFERRED_ENABLED
+    object_ptr->deferred = false;
+    object_ptr->pending = false;
+#endif
+    id = object_ptr->handle;
   }
 
   return (id);
@@ -456,23 +1101,33 @@ uint32_t SYSTIMER_CreateTimer
  */
 SYSTIMER_STATUS_t SYSTIMER_StartTimer(uint32_t id)
 {
+  uint32_t ics;
   SYSTIMER_STATUS_t status;
+  SYSTIMER_OBJECT_t *object_ptr;
   status = SYSTIMER_STATUS_FAILURE;
 
-  XMC_ASSERT("SYSTIMER_StartTimer: Failure in timer restart operation due to invalid timer ID",
-            ((id <= SYSTIMER_CFG_MAX_TMR) && (id > 0U)));
-  XMC_ASSERT("SYSTIMER_StartTimer: Error during start of software timer", (0U != (g_timer_tracker & (1U << (id - 1U)))));
+  object_ptr = SYSTIMER_lGetTimer(id);
+  XMC_ASSERT("SYSTIMER_StartTimer: Failure in timer start operation due to invalid or stale timer ID", (NULL != object_ptr));
   
+  /* The state check and the list update must not be split by the SysTick handler or a start / stop of an interrupt
+   * handler, which walk and change the same list
+   */
+  ics = critical_section_enter();
   /* Check if timer is running */
-  if (SYSTIMER_STATE_STOPPED == g_timer_tbl[id - 1U].state)
+  if ((NULL != object_ptr) && (SYSTIMER_STATE_STOPPED == object_ptr->state))
   {
-    g_timer_tbl[id - 1U].count = (g_timer_tbl[id - 1U].reload + HW_TIMER_ADDITIONAL_CNT);
+    object_ptr->count = (object_ptr->reload + HW_TIMER_ADDITIONAL_CNT);
     /* set timer status as SYSTIMER_STATE_RUNNING */
-    g_timer_tbl[id - 1U].state = SYSTIMER_STATE_RUNNING;
+    object_ptr->state = SYSTIMER_STATE_RUNNING;
     /* Insert this timer into timer list */
-    SYSTIMER_lInsertTimerList((id - 1U));
+#ifdef SYSTIMER_TICKLESS_ENABLED
+    SYSTIMER_lTicklessInsert(object_ptr->id);
+#else
+    SYSTIMER_lInsertTimerList(object_ptr->id);
+#endif
     status = SYSTIMER_STATUS_SUCCESS;
   }
+  critical_section_exit(ics);
 
   return (status);
 }
@@ -482,29 +1137,33 @@ SYSTIMER_STATUS_t SYSTIMER_StartTimer(uint32_t id)
  */
 SYSTIMER_STATUS_t SYSTIMER_StopTimer(uint32_t id)
 {
+  uint32_t ics;
   SYSTIMER_STATUS_t status;
+  SYSTIMER_OBJECT_t *object_ptr;
   status = SYSTIMER_STATUS_SUCCESS;
 
-  XMC_ASSERT("SYSTIMER_StopTimer: Failure in timer restart operation due to invalid timer ID",
-            ((id <= SYSTIMER_CFG_MAX_TMR) && (id > 0U)));
-  XMC_ASSERT("SYSTIMER_StopTimer: Error during stop of software timer", (0U != (g_timer_tracker & (1U << (id - 1U)))));
+  object_ptr = SYSTIMER_lGetTimer(id);
+  XMC_ASSERT("SYSTIMER_StopTimer: Failure in timer stop operation due to invalid or stale timer ID", (NULL != object_ptr));
 
-  if (SYSTIMER_STATE_NOT_INITIALIZED == g_timer_tbl[id - 1U].state)
+  if (NULL == object_ptr)
   {
     status = SYSTIMER_STATUS_FAILURE;
   }
   else
   {
+    /* Same as SYSTIMER_StartTimer, the list is also changed by the SysTick handler */
+    ics = critical_section_enter();
     /* Check whether Timer is in Stop state */
-    if (SYSTIMER_STATE_RUNNING == g_timer_tbl[id - 1U].state)
+    if (SYSTIMER_STATE_RUNNING == object_ptr->state)
     {
         /* Set timer status as SYSTIMER_STATE_STOPPED */
-        g_timer_tbl[id - 1U].state = SYSTIMER_STATE_STOPPED;
+        object_ptr->state = SYSTIMER_STATE_STOPPED;
 
         /* remove Timer from node list */
-        SYSTIMER_lRemoveTimerList(id - 1U);
+        SYSTIMER_lRemoveTimerList(object_ptr->id);
 
     }
+    critical_section_exit(ics);
   }
 
   return (status);
@@ -517,23 +1176,23 @@ SYSTIMER_STATUS_t SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec)
 {
   uint32_t period_ratio = 0U;
   SYSTIMER_STATUS_t status;
+  SYSTIMER_OBJECT_t *object_ptr;
   status = SYSTIMER_STATUS_SUCCESS;
 
-  XMC_ASSERT("SYSTIMER_RestartTimer: Failure in timer restart operation due to invalid timer ID",
-            ((id <= SYSTIMER_CFG_MAX_TMR) && (id > 0U)));
-  XMC_ASSERT("SYSTIMER_RestartTimer: Error during restart of software timer", (0U != (g_timer_tracker & (1U << (id - 1U)))));
+  object_ptr = SYSTIMER_lGetTimer(id);
+  XMC_ASSERT("SYSTIMER_RestartTimer: Failure in timer restart operation due to invalid or stale timer ID", (NULL != object_ptr));
   XMC_ASSERT("SYSTIMER_RestartTimer: Can not restart timer due to invalid period value",
             (microsec >= SYSTIMER_TICK_PERIOD_US) && (microsec > 0U));
 
 
-  if (SYSTIMER_STATE_NOT_INITIALIZED == g_timer_tbl[id - 1U].state)
+  if (NULL == object_ptr)
   {
       status = SYSTIMER_STATUS_FAILURE;
   }
   else
   {
     /* check whether timer is in run state */
-    if( SYSTIMER_STATE_STOPPED != g_timer_tbl[id - 1U].state)
+    if( SYSTIMER_STATE_STOPPED != object_ptr->state)
     {
          /* Stop the timer */
          status = SYSTIMER_StopTimer(id);
@@ -541,7 +1200,7 @@ SYSTIMER_STATUS_t SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec)
     if (SYSTIMER_STATUS_SUCCESS == status)
     {
       period_ratio = (uint32_t)(microsec / SYSTIMER_TICK_PERIOD_US);
-      g_timer_tbl[id - 1U].reload = period_ratio;
+      object_ptr->reload = period_ratio;
       /* Start the timer */
       status = SYSTIMER_StartTimer(id);
     }
@@ -555,32 +1214,40 @@ SYSTIMER_STATUS_t SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec)
  */
 SYSTIMER_STATUS_t SYSTIMER_DeleteTimer(uint32_t id)
 {
+  uint32_t ics;
   SYSTIMER_STATUS_t status;
+  SYSTIMER_OBJECT_t *object_ptr;
   status = SYSTIMER_STATUS_SUCCESS;
 
-  XMC_ASSERT("SYSTIMER_DeleteTimer: Failure in timer restart operation due to invalid timer ID",
-            ((id <= SYSTIMER_CFG_MAX_TMR) && (id > 0U)));
-  XMC_ASSERT("SYSTIMER_DeleteTimer: Error during deletion of software timer", (0U != (g_timer_tracker & (1U << (id - 1U)))));
+  object_ptr = SYSTIMER_lGetTimer(id);
+  XMC_ASSERT("SYSTIMER_DeleteTimer: Failure in timer delete operation due to invalid or stale timer ID", (NULL != object_ptr));
 
   /* Check whether Timer is in delete state */
-  if (SYSTIMER_STATE_NOT_INITIALIZED == g_timer_tbl[id - 1U].state)
+  if (NULL == object_ptr)
   {
       status = SYSTIMER_STATUS_FAILURE;
   }
   else
   {
-    if (SYSTIMER_STATE_STOPPED == g_timer_tbl[id - 1U].state)
+    /* Removal takes constant time and the timer handler fetches the next timer after each callback, a running timer
+     * is removed right away
+     */
+    ics = critical_section_enter();
+    if (SYSTIMER_STATE_RUNNING == object_ptr->state)
     {
-      /* Set timer status as SYSTIMER_STATE_NOT_INITIALIZED */
-      g_timer_tbl[id - 1U].state = SYSTIMER_STATE_NOT_INITIALIZED;
-      /* Release resource which are hold by this timer */
-      g_timer_tracker &= ~(1U << (id - 1U));
-    }
-    else
-    {
-      /* Yes, remove this timer from timer list during ISR execution */
-      g_timer_tbl[id - 1U].delete_swtmr = true;
+      SYSTIMER_lRemoveTimerList(object_ptr->id);
     }
+    /* Set timer status as SYSTIMER_STATE_NOT_INITIALIZED */
+    object_ptr->state = SYSTIMER_STATE_NOT_INITIALIZED;
+#ifdef SYSTIMER_DEFERRED_ENABLED
+    /* A queued expiration is skipped by the dispatcher */
+    object_ptr->pending = false;
+#endif
+    /* Invalidate the ID and release the timer into the free list */
+    object_ptr->handle += SYSTIMER_ID_GENERATION_STEP;
+    object_ptr->next = g_timer_free;
+    g_timer_free = object_ptr;
+    critical_section_exit(ics);
   }
 
   return (status);
@@ -591,7 +1258,11 @@ SYSTIMER_STATUS_t SYSTIMER_DeleteTimer(uint32_t id)
  */
 uint32_t SYSTIMER_GetTime(void)
 {
+#ifdef SYSTIMER_TICKLESS_ENABLED
+  return (SYSTIMER_GetTickCount() * SYSTIMER_TICK_PERIOD_US);
+#else
   return (g_systick_count * SYSTIMER_TICK_PERIOD_US);
+#endif
 }
 
 /*
@@ -599,7 +1270,52 @@ uint32_t SYSTIMER_GetTime(void)
  */
 uint32_t SYSTIMER_GetTickCount(void)
 {
+#ifdef SYSTIMER_TICKLESS_ENABLED
+  uint32_t ics;
+  uint32_t ticks;
+
+  /* g_systick_count is only updated at the end of a SysTick period, add the ticks of the running one */
+  ics = critical_section_enter();
+  ticks = g_systick_count + (SYSTIMER_lTicklessElapsed() / SYSTIMER_TICK_CLOCKS);
+  critical_section_exit(ics);
+
+  return (ticks);
+#else
   return (g_systick_count);
+#endif
+}
+
+/*
+ *  API to get the SysTick clock cycles since start (lower 32 bit).
+ */
+uint32_t SYSTIMER_GetCycles(void)
+{
+  uint32_t ics;
+  uint32_t count;
+  uint32_t elapsed;
+#ifndef SYSTIMER_TICKLESS_ENABLED
+  uint32_t value;
+#endif
+
+  ics = critical_section_enter();
+
+  count = g_systick_count;
+#ifdef SYSTIMER_TICKLESS_ENABLED
+  elapsed = SYSTIMER_lTicklessElapsed();
+#else
+  value = SysTick->VAL;
+  /* Counter wrapped but the SysTick exception is not handled yet - count that tick and read the reloaded value again */
+  if (0U != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+  {
+    value = SysTick->VAL;
+    count++;
+  }
+  elapsed = SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - value);
+#endif
+
+  critical_section_exit(ics);
+
+  return ((count * SYSTIMER_TICK_CLOCKS) + elapsed);
 }
 
 /*
@@ -607,21 +1323,196 @@ uint32_t SYSTIMER_GetTickCount(void)
  */
 SYSTIMER_STATE_t SYSTIMER_GetTimerState(uint32_t id)
 {
-  return (g_timer_tbl[id - 1U].state);
+  SYSTIMER_STATE_t state = SYSTIMER_STATE_NOT_INITIALIZED;
+  SYSTIMER_OBJECT_t *object_ptr;
+
+  object_ptr = SYSTIMER_lGetTimer(id);
+  if (NULL != object_ptr)
+  {
+    state = object_ptr->state;
+  }
+
+  return (state);
 }
 
-__attribute__((always_inline)) __STATIC_INLINE uint32_t critical_section_enter(void)
+#ifdef SYSTIMER_DEFERRED_ENABLED
+/*
+ *  API to select whether the callback of a timer is run in SysTick context or by SYSTIMER_DispatchDeferred.
+ */
+SYSTIMER_STATUS_t SYSTIMER_SetDeferred(uint32_t id, bool deferred)
 {
-  uint32_t status;
-  status = __get_PRIMASK();
-  __disable_irq ();
-  return status;
+  SYSTIMER_STATUS_t status = SYSTIMER_STATUS_FAILURE;
+  SYSTIMER_OBJECT_t *object_ptr;
+
+  object_ptr = SYSTIMER_lGetTimer(id);
+  XMC_ASSERT("SYSTIMER_SetDeferred: Invalid or stale timer ID", (NULL != object_ptr));
+
+  if (NULL != object_ptr)
+  {
+    object_ptr->deferred = deferred;
+    status = SYSTIMER_STATUS_SUCCESS;
+  }
+
+  return (status);
 }
 
-__attribute__((always_inline)) __STATIC_INLINE void critical_section_exit(uint32_t status)
+/*
+ *  API to register the function called (SysTick context) whenever an expiration was posted to the deferred queue.
+ */
+void SYSTIMER_SetDeferredNotify(SYSTIMER_CALLBACK_t notify, void *args)
 {
-  __set_PRIMASK(status);
+  uint32_t ics;
+  ics = critical_section_enter();
+  g_deferred_notify = notify;
+  g_deferred_notify_args = args;
+  critical_section_exit(ics);
+}
+
+/*
+ *  API to run the callbacks of all expirations in the deferred queue.
+ */
+uint32_t SYSTIMER_DispatchDeferred(void)
+{
+  SYSTIMER_OBJECT_t *object_ptr;
+  uint32_t tail;
+  uint32_t count = 0U;
+
+  FUNCPROF_ENTER();
+  tail = g_deferred_tail;
+  while (tail != g_deferred_head)
+  {
+    object_ptr = &g_timer_tbl[g_deferred_queue[tail & SYSTIMER_DEFERRED_QUEUE_MASK]];
+    /* Release the entry before the callback, so the queue is free for the next expirations */
+    tail++;
+    g_deferred_tail = tail;
+    /* Deleted after it was posted otherwise */
+    if (true == object_ptr->pending)
+    {
+      /* Cleared first, an expiration during the callback is posted again */
+      object_ptr->pending = false;
+      (object_ptr->callback)(object_ptr->args);
+      count++;
+    }
+  }
+  FUNCPROF_EXIT(FUNCPROF_DISPATCH);
+
+  return (count);
 }
+#endif
+
+#ifdef SYSTIMER_CLOCK_SCALING_ENABLED
+/*
+ *  API to adapt SysTick to a CPU clock of SYSTIMER_SYSTICK_CLOCK >> shift.
+ */
+SYSTIMER_STATUS_t SYSTIMER_SetClockShift(uint32_t shift)
+{
+  SYSTIMER_STATUS_t status = SYSTIMER_STATUS_FAILURE;
+  uint32_t ics;
+  uint32_t period;
+  uint32_t elapsed;
+  uint32_t remaining;
+
+  /* A tick must be a whole number of counts at the new clock */
+  if ((shift < 32U) && (0U == (SYSTIMER_TICK_CLOCKS & ((1U << shift) - 1U))))
+  {
+    ics = critical_section_enter();
+
+    /* Let a wrap which is about to happen occur first, a pending wrap is accounted by the SysTick exception */
+    while ((0U == (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) && (SysTick->VAL < SYSTIMER_CLOCK_CHANGE_MIN_COUNTS))
+    {
+    }
+#ifdef SYSTIMER_TICKLESS_ENABLED
+    period = g_tickless_ticks * SYSTIMER_TICK_CLOCKS;
+#else
+    period = SYSTIMER_TICK_CLOCKS;
+#endif
+    /* Cycles the running period already lasted, counted at the old clock */
+    elapsed = SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - SysTick->VAL);
+    g_clock_shift = shift;
+
+    /* Restart the counter with the rest of the period, then set the full period again (see SYSTIMER_lTicklessRestart) */
+    remaining = SYSTIMER_CYCLES_TO_COUNTS(period - elapsed);
+    if (remaining < 2U)
+    {
+      remaining = 2U;
+    }
+    SysTick->LOAD = remaining - 1U;
+    SysTick->VAL = 0U;
+    while (0U == SysTick->VAL)
+    {
+    }
+    SysTick->LOAD = SYSTIMER_CYCLES_TO_COUNTS(period) - 1U;
+
+    critical_section_exit(ics);
+    status = SYSTIMER_STATUS_SUCCESS;
+  }
+
+  return (status);
+}
+#endif
+
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+/*
+ *  API to jump the SysTick time forward (stepped through by the SysTick handler).
+ */
+SYSTIMER_STATUS_t SYSTIMER_Warp(uint32_t microsec)
+{
+  SYSTIMER_STATUS_t status = SYSTIMER_STATUS_FAILURE;
+  uint32_t ics;
+  uint32_t ticks;
+
+  ticks = microsec / SYSTIMER_TICK_PERIOD_US;
+  ics = critical_section_enter();
+  if (ticks <= (0xFFFFFFFFU - g_warp_ticks))
+  {
+    g_warp_ticks += ticks;
+#ifdef SYSTIMER_TICKLESS_ENABLED
+    /* End a long period after the next tick, the handler then keeps it short until the jump is done */
+    if (1U < g_tickless_ticks)
+    {
+      SYSTIMER_lTicklessRestart(1U);
+    }
+#endif
+    status = SYSTIMER_STATUS_SUCCESS;
+  }
+  critical_section_exit(ics);
+
+  return (status);
+}
+#endif
+
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/*
+ *  API to get the cycles until the running SysTick period ends.
+ */
+uint32_t SYSTIMER_GetIdleCycles(void)
+{
+  uint32_t cycles = 0U;
+
+  if (0U == (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+  {
+    cycles = SYSTIMER_COUNTS_TO_CYCLES(SysTick->VAL);
+  }
+
+  return (cycles);
+}
+
+/*
+ *  API to get the cycles since the SysTick exception got pending.
+ */
+uint32_t SYSTIMER_GetPendingAge(void)
+{
+  uint32_t cycles = 0U;
+
+  /* The counter reloaded LOAD at the wrap, LOAD - VAL count from there */
+  if (0U != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+  {
+    cycles = SYSTIMER_COUNTS_TO_CYCLES(SysTick->LOAD - SysTick->VAL);
+  }
+
+  return (cycles);
+}
+#endif
 
 void SYSTIMER_Start(void)
 {
@@ -708,3 +1599,70 @@ SYSTIMER_STATUS_t SYSTIMER_DeleteTimerFromISR(uint32_t id)
 
   return (status);
 }
+
+/*
+ *  API to get the current time in microsecond with SysTick->VAL resolution (64 bit, does not wrap).
+ */
+uint64_t SYSTIMER_GetTime64(void)
+{
+  uint32_t ics;
+  uint32_t count_low;
+  uint32_t count_high;
+  uint32_t value;
+  uint32_t reload;
+
+#if TIMEBASE_ENABLED
+  if (timebase_running)
+  {
+    return (timebase_now64());
+  }
+#endif
+
+  ics = critical_section_enter();
+
+  count_low = g_systick_count;
+  count_high = g_systick_count_high;
+#ifdef SYSTIMER_TICKLESS_ENABLED
+  /* Cycles since tick g_systick_count (a pending wrap included) */
+  value = 0U;
+  reload = SYSTIMER_lTicklessElapsed();
+#else
+  value = SysTick->VAL;
+  reload = SysTick->LOAD;
+
+  /* Counter wrapped but the SysTick exception is not handled yet - count that tick and read the reloaded value again */
+  if (0U != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+  {
+    value = SysTick->VAL;
+    count_low++;
+    if (0U == count_low)
+    {
+      count_high++;
+    }
+  }
+#ifdef SYSTIMER_CLOCK_SCALING_ENABLED
+  /* Cycles since tick count_low at SYSTIMER_SYSTICK_CLOCK */
+  reload = SYSTIMER_COUNTS_TO_CYCLES(reload - value);
+  value = 0U;
+#endif
+#endif
+
+  critical_section_exit(ics);
+
+  return ((((uint64_t)count_high << 32U) | count_low) * SYSTIMER_TICK_PERIOD_US) +
+         (((reload - value) * SYSTIMER_WARP_RATE) / (SYSTIMER_SYSTICK_CLOCK / 1000000U));
+}
+
+/*
+ *  API to get the current time in microsecond with SysTick->VAL resolution (lower 32 bit).
+ */
+uint32_t SYSTIMER_GetTimeUs(void)
+{
+#if TIMEBASE_ENABLED
+  if (timebase_running)
+  {
+    return (timebase_now());
+  }
+#endif
+  return ((uint32_t)SYSTIMER_GetTime64());
+}
@@ -62,11 +62,16 @@
   * @ingroup SYSTIMER_datastructures
   * @{
   */
-SYSTIMER_t SYSTIMER_0 =
+SYSTIMER_RUNTIME_t SYSTIMER_0_runtime =
 {
   .init_status = false /* APP initialization status to ensure whether SYSTIMER_Init called or not */ 
 };
 
+const SYSTIMER_t SYSTIMER_0 =
+{
+  .runtime_ptr = &SYSTIMER_0_runtime
+};
+
 /**
  * @}
  */
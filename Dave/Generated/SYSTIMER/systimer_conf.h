@@ -86,8 +86,59 @@
 /**< Maximum No of timer */
 #define SYSTIMER_CFG_MAX_TMR  (8U)
 
-#define SYSTIMER_PRIORITY  (3U)
+#define SYSTIMER_PRIORITY  (1U)
  
+/**< Size of the timer pool (independent of the GUI limit of SYSTIMER_CFG_MAX_TMR, at most 255) */
+#define SYSTIMER_CFG_POOL_SIZE  (32U)
+
+/*
+ *  Timer wheel: running timers are kept in SYSTIMER_WHEEL_LEVELS levels of 2^SYSTIMER_WHEEL_BITS slots instead of the
+ *  sorted delta list, start, stop and expiry of a timer take constant time. Remove the define for the delta list.
+ */
+#define SYSTIMER_TIMER_WHEEL_ENABLED
+#define SYSTIMER_WHEEL_BITS  (4U)
+#define SYSTIMER_WHEEL_LEVELS  (4U)
+
+/*
+ *  Tickless mode: SysTick is programmed to the next timer expiry (at most 2^24 clock cycles) instead of interrupting
+ *  every SYSTIMER_TICK_PERIOD_US, elapsed ticks are accounted when it expires or when a timer is started.
+ */
+#define SYSTIMER_TICKLESS_ENABLED
+
+/*
+ *  Deferred callbacks: expirations of timers selected by SYSTIMER_SetDeferred are posted to a queue of
+ *  SYSTIMER_DEFERRED_QUEUE_SIZE entries (power of 2) and dispatched by SYSTIMER_DispatchDeferred
+ */
+#define SYSTIMER_DEFERRED_ENABLED
+#define SYSTIMER_DEFERRED_QUEUE_SIZE  (64U)
+
+/*
+ *  ISR hook: SysTick_Handler reports its entry latency and execution time in SysTick clock cycles to
+ *  SYSTIMER_IsrHook (weak empty default, the application may replace it). Remove the define to drop the measurement.
+ */
+#define SYSTIMER_ISR_HOOK_ENABLED
+
+/*
+ *  Clock scaling: SYSTIMER_SetClockShift adapts SysTick to a CPU clock of SYSTIMER_SYSTICK_CLOCK divided by a power
+ *  of 2, times stay in ticks of SYSTIMER_TICK_PERIOD_US and cycles of SYSTIMER_SYSTICK_CLOCK.
+ */
+#define SYSTIMER_CLOCK_SCALING_ENABLED
+
+/*
+ *  Time warp (soak test builds only): SysTick time runs SYSTIMER_TIME_WARP_FACTOR times faster than real time (a tick
+ *  of SYSTIMER_TICK_PERIOD_US lasts that much shorter) and SYSTIMER_Warp jumps it forward, the SysTick handler steps
+ *  through at most SYSTIMER_TIME_WARP_STEP ticks of a jump per tick so every timer on the way expires in order.
+ *  Define SYSTIMER_TIME_WARP_ENABLED for such a build, never for a release.
+ */
+/* #define SYSTIMER_TIME_WARP_ENABLED */
+#define SYSTIMER_TIME_WARP_FACTOR  (16U)
+#define SYSTIMER_TIME_WARP_STEP  (16U)
+
+/*
+ *  SysTick_Handler and the tick processing are placed in the .ram_code section and run from SRAM.
+ */
+#define SYSTIMER_ISR_IN_RAM
+
 /**
  * @}
  */
@@ -60,7 +60,7 @@
 /***********************************************************************************************************************
  * EXTERN DECLARATIONS
 ***********************************************************************************************************************/
-extern SYSTIMER_t SYSTIMER_0;
+extern const SYSTIMER_t SYSTIMER_0;
  
 
 #endif /**< SYSTIMER_EXTERN_H */
@@ -93,6 +93,8 @@
  * HEADER FILES
  **********************************************************************************************************************/
 #include "adc_measurement.h"
+/* Function profiler markers of the application (empty unless FUNCPROF_ENABLED) */
+#include "funcprof.h"
 
 /***********************************************************************************************************************
  * MACROS
@@ -124,7 +126,7 @@ DAVE_APP_VERSION_t ADC_MEASUREMENT_GetAppVersion(void)
 
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 /* Initialization routine to call ADC LLD API's */
-ADC_MEASUREMENT_STATUS_t ADC_MEASUREMENT_Init(ADC_MEASUREMENT_t *const handle_ptr)
+ADC_MEASUREMENT_STATUS_t ADC_MEASUREMENT_Init(const ADC_MEASUREMENT_t *const handle_ptr)
 {
   const ADC_MEASUREMENT_CHANNEL_t *indexed;
   uint8_t j;
@@ -132,7 +134,7 @@ ADC_MEASUREMENT_STATUS_t ADC_MEASUREMENT_Init(ADC_MEASUREMENT_t *const handle_pt
 
   XMC_ASSERT("ADC_MEASUREMENT_Init:Invalid handle_ptr", (handle_ptr != NULL));
 
-  if (ADC_MEASUREMENT_STATUS_UNINITIALIZED == handle_ptr->init_state)
+  if (ADC_MEASUREMENT_STATUS_UNINITIALIZED == handle_ptr->runtime_ptr->init_state)
   {
     /* Call the function to initialise Clock and ADC global functional units*/
     status = (ADC_MEASUREMENT_STATUS_t) GLOBAL_ADC_Init(handle_ptr->global_handle);
@@ -220,24 +222,26 @@ ADC_MEASUREMENT_STATUS_t ADC_MEASUREMENT_Init(ADC_MEASUREMENT_t *const handle_pt
       /* Start conversion manually using load event trigger*/
       XMC_VADC_GLOBAL_BackgroundTriggerConversion(handle_ptr->global_handle->module_ptr);
     }
-    handle_ptr->init_state = status;
+    handle_ptr->runtime_ptr->init_state = status;
   }
-  return (handle_ptr->init_state);
+  return (handle_ptr->runtime_ptr->init_state);
 }
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 
 /* This API will Software trigger ADC Background request source and starts conversion*/
-void ADC_MEASUREMENT_StartConversion(ADC_MEASUREMENT_t *const handle_ptr)
+void ADC_MEASUREMENT_StartConversion(const ADC_MEASUREMENT_t *const handle_ptr)
 {
   XMC_ASSERT("ADC_MEASUREMENT_Start:Invalid handle_ptr", (handle_ptr != NULL));
 
+  FUNCPROF_ENTER();
   /* Generate a load event to start background request source conversion*/
   XMC_VADC_GLOBAL_BackgroundTriggerConversion(handle_ptr->global_handle->module_ptr);
+  FUNCPROF_EXIT(FUNCPROF_ADC_START);
 }
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 #if(XMC_VADC_GROUP_AVAILABLE == 1U)
 /* This API will get the result of a conversion for a specific channel*/
-XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_CHANNEL_t *const handle_ptr)
+XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(const ADC_MEASUREMENT_CHANNEL_t *const handle_ptr)
 {
   XMC_VADC_RESULT_SIZE_t result;
 
@@ -250,7 +254,7 @@ XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_CHANNEL_t *cons
 /*~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 
 /* This API will get the result of a conversion for a specific channel. It will return the complete result register*/
-uint32_t ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_CHANNEL_t *const handle_ptr)
+uint32_t ADC_MEASUREMENT_GetDetailedResult(const ADC_MEASUREMENT_CHANNEL_t *const handle_ptr)
 {
   uint32_t result;
 
@@ -266,7 +270,7 @@ uint32_t ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_CHANNEL_t *const hand
  *
  * This API has been deprecated. Use ADC_MEASUREMENT_GetGlobalResult() to get the global result.
  * */
-XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_t *const handle_ptr)
+XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(const ADC_MEASUREMENT_t *const handle_ptr)
 {
   XMC_VADC_RESULT_SIZE_t result;
 
@@ -283,7 +287,7 @@ XMC_VADC_RESULT_SIZE_t ADC_MEASUREMENT_GetResult(ADC_MEASUREMENT_t *const handle
  *
  * This API has been deprecated. Use ADC_MEASUREMENT_GetGlobalDetailedResult() to get the global result.
  * */
-uint32_t ADC_MEASUREMENT_GetDetailedResult(ADC_MEASUREMENT_t *const handle_ptr)
+uint32_t ADC_MEASUREMENT_GetDetailedResult(const ADC_MEASUREMENT_t *const handle_ptr)
 {
   uint32_t result;
 
@@ -162,7 +162,7 @@ extern "C" {
  */
 DAVE_APP_VERSION_t CPU_CTRL_XMC1_GetAppVersion(void);
 
-CPU_CTRL_XMC1_STATUS_t CPU_CTRL_XMC1_Init(CPU_CTRL_XMC1_t *const handler);
+CPU_CTRL_XMC1_STATUS_t CPU_CTRL_XMC1_Init(const CPU_CTRL_XMC1_t *const handler);
 /**
  * @}
  */
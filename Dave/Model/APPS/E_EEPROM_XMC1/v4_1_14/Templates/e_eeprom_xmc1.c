@@ -62,6 +62,9 @@
  **********************************************************************************************************************/
 
 #include "e_eeprom_xmc1.h"
+#include <stddef.h>
+/* Function profiler markers of the application (empty unless FUNCPROF_ENABLED) */
+#include "funcprof.h"
 
 /**********************************************************************************************************************
  * MACROS
@@ -193,10 +196,34 @@
 #define E_EEPROM_XMC1_EXECUTE_PREP_FLASH   (0x1U)
 #define E_EEPROM_XMC1_EXECUTE_GC_STATE     (0x2U)
 
+#define E_EEPROM_XMC1_INDEX_MAGIC          ((uint32_t)0x4D4E5458U) /* Marks a written fast mount index record */
+#define E_EEPROM_XMC1_INDEX_CRC_INIT       ((uint32_t)0xFFFFU)     /* CRC-16/CCITT of the index record */
+#define E_EEPROM_XMC1_BLOCK_CRC_INIT       ((uint32_t)0xFFFFU)     /* CRC-16/CCITT of the data blocks */
+
 /***********************************************************************************************************************
  * LOCAL DATA
  **********************************************************************************************************************/
 
+/* Flash wear counters (RAM only, the application persists and restores them) */
+static E_EEPROM_XMC1_WEAR_t E_EEPROM_XMC1_wear;
+
+/* Start addresses of the previous consistent copies per user block, newest first (0 = none, built by Init) */
+static uint32_t E_EEPROM_XMC1_history[E_EEPROM_XMC1_MAX_BLOCK_COUNT][E_EEPROM_XMC1_HISTORY_DEPTH];
+
+#ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+/* Fast mount index record (no-init RAM, survives resets without power loss) */
+static E_EEPROM_XMC1_INDEX_t E_EEPROM_XMC1_index __attribute__((section(".no_init")));
+#endif
+
+#if defined(E_EEPROM_XMC1_FAST_MOUNT_ENABLED) || defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
+/* CRC-16/CCITT (polynomial 0x1021) of every 4 bit value, two lookups per byte instead of 8 shift steps (32 bytes flash) */
+static const uint16_t E_EEPROM_XMC1_crc_table[16] =
+{
+  0x0000U, 0x1021U, 0x2042U, 0x3063U, 0x4084U, 0x50A5U, 0x60C6U, 0x70E7U,
+  0x8108U, 0x9129U, 0xA14AU, 0xB16BU, 0xC18CU, 0xD1ADU, 0xE1CEU, 0xF1EFU
+};
+#endif
+
 /***********************************************************************************************************************
  * LOCAL ROUTINES
  **********************************************************************************************************************/
@@ -220,6 +247,7 @@ static void E_EEPROM_XMC1_lInitGcDataCopyState(uint32_t current_state, uint32_t
 
 static void E_EEPROM_XMC1_lPrepareDFlash(void);
 static void E_EEPROM_XMC1_lGarbageCollection(void);
+static void E_EEPROM_XMC1_lGarbageCollectionStep(void);
 static void E_EEPROM_XMC1_lSetMarkerBlockBuffer(void);
 static void E_EEPROM_XMC1_lSetMarkerPageBuffer(uint32_t state);
 static uint32_t E_EEPROM_XMC1_lReadVerifyMarker(uint32_t bank, uint32_t block);
@@ -232,6 +260,21 @@ static void E_EEPROM_XMC1_lCopyProcessDirtyStateRecovery(uint32_t current_state
 static void E_EEPROM_XMC1_lUpdateCache(void);
 static void E_EEPROM_XMC1_lEvalBlockStatus(void);
 static void E_EEPROM_XMC1_lUpdateCurrBankInfo(void);
+
+#ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+static uint32_t E_EEPROM_XMC1_lIndexCrc(void);
+#endif
+#if defined(E_EEPROM_XMC1_FAST_MOUNT_ENABLED) || defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
+static uint32_t E_EEPROM_XMC1_lCrcUpdate(uint32_t crc, const uint8_t *data, uint32_t length);
+#endif
+#ifdef E_EEPROM_XMC1_BLOCK_CRC_ENABLED
+static uint32_t E_EEPROM_XMC1_lFlashBlockCrc(uint32_t address, uint32_t size);
+#endif
+#ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+static void E_EEPROM_XMC1_lSaveIndex(void);
+static void E_EEPROM_XMC1_lInvalidateIndex(void);
+static uint32_t E_EEPROM_XMC1_lFastMount(void);
+#endif
 static uint32_t E_EEPROM_XMC1_lUpdateCacheBlockRead(void);
 static uint32_t E_EEPROM_XMC1_lCacheEmptyBlkEval(uint32_t end_addr);
 
@@ -256,13 +299,17 @@ static void E_EEPROM_XMC1_lPopulateNextBlock(uint8_t block_number,
                                              uint8_t* const user_data_buffer_ptr ,
                                              uint32_t block_size);
 static void E_EEPROM_XMC1_lPopulateFirstBlock(uint8_t block_number, uint8_t* user_data_buffer_ptr, uint32_t block_size);
-#ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
+#if defined(E_EEPROM_XMC1_CRC_SW_ENABLED) || defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
 static E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_lReadBlockCrcStatus(uint8_t block_number,
                                                                           uint8_t* data_buffer_ptr,
                                                                           uint32_t block_size);
 #endif
 static uint32_t E_EEPROM_XMC1_lReadBlockContents(uint8_t *data_buffer_ptr, uint32_t length, uint32_t offset);
 static uint32_t E_EEPROM_XMC1_lGetPrevData(uint8_t block_number);
+static void E_EEPROM_XMC1_lLocateData(uint32_t address, uint32_t block_size, uint32_t offset,
+                                      const uint8_t **const data_pptr, uint32_t *const length_ptr);
+static void E_EEPROM_XMC1_lPushHistory(uint32_t user_block_index, uint32_t address);
+static void E_EEPROM_XMC1_lBuildHistory(void);
 static uint32_t E_EEPROM_XMC1_lSearchBlockCopy(uint8_t required_block_number,
                                                uint32_t read_addr ,
                                                uint32_t data_sec_start_addr);
@@ -323,7 +370,7 @@ DAVE_APP_VERSION_t E_EEPROM_XMC1_GetAppVersion(void)
  * Description     : Driver Module Initialization function. This service shall initialize the Flash EEPROM Emulation 
  *                   module using the values provided by configuration set.
  */
-E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(E_EEPROM_XMC1_t *const handle_ptr)
+E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(const E_EEPROM_XMC1_t *const handle_ptr)
 {
   uint32_t indx;
   uint32_t marker_state;
@@ -331,13 +378,13 @@ E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(E_EEPROM_XMC1_t *const handle_ptr)
   XMC_ASSERT("E_EEPROM_XMC1_Write:Invalid Buffer Pointer", (handle_ptr != NULL));
 
   /* Check if the E_EEPROM_XMC1_Init API is called once*/
-  if (handle_ptr->state != E_EEPROM_XMC1_STATUS_SUCCESS)
+  if (handle_ptr->runtime_ptr->state != E_EEPROM_XMC1_STATUS_SUCCESS)
   {
     #ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
-    handle_ptr->state = (E_EEPROM_XMC1_STATUS_t)CRC_SW_Init(handle_ptr->crc_handle_ptr);
-    if (handle_ptr->state != E_EEPROM_XMC1_STATUS_SUCCESS)
+    handle_ptr->runtime_ptr->state = (E_EEPROM_XMC1_STATUS_t)CRC_SW_Init(handle_ptr->crc_handle_ptr);
+    if (handle_ptr->runtime_ptr->state != E_EEPROM_XMC1_STATUS_SUCCESS)
     {
-      handle_ptr->state = E_EEPROM_XMC1_STATUS_FAILURE;
+      handle_ptr->runtime_ptr->state = E_EEPROM_XMC1_STATUS_FAILURE;
     }
     else
     #endif
@@ -377,28 +424,43 @@ E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(E_EEPROM_XMC1_t *const handle_ptr)
 
       XMC_FLASH_SetHardReadLevel(XMC_FLASH_HARDREAD_LEVEL_WRITTEN);
 
-      /* Read the marker blocks from flash and decide the MARKER STATES */
-      marker_state = E_EEPROM_XMC1_lReadMarkerBlocks();
+      #ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+      /* Take over the state of the last run from a valid index record, else fall back to the full scan */
+      if (E_EEPROM_XMC1_lFastMount() == 0U)
+      #endif
+      {
+        /* Read the marker blocks from flash and decide the MARKER STATES */
+        marker_state = E_EEPROM_XMC1_lReadMarkerBlocks();
 
 
-      /*
-       * Call INIT-GC state machine function to take decision on current MARKER STATE available.
-       * Progress to GC state machine or PrepareDFLASH State machine after completing  the Cache update
-       */
-      E_EEPROM_XMC1_lInitGc(marker_state);
+        /*
+         * Call INIT-GC state machine function to take decision on current MARKER STATE available.
+         * Progress to GC state machine or PrepareDFLASH State machine after completing  the Cache update
+         */
+        E_EEPROM_XMC1_lInitGc(marker_state);
+
+        #ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+        if (handle_ptr->data_ptr->gc_state == E_EEPROM_XMC1_GC_IDLE)
+        {
+          E_EEPROM_XMC1_lSaveIndex();
+        }
+        #endif
+      }
 
       /* If Initialization is done without any errors, set the INIT API called state into Initialized once */
       if (handle_ptr->data_ptr->gc_state == E_EEPROM_XMC1_GC_IDLE)
       {
-        handle_ptr->state = E_EEPROM_XMC1_STATUS_SUCCESS;
+        /* Index the previous copies of the mounted bank (both mount paths) */
+        E_EEPROM_XMC1_lBuildHistory();
+        handle_ptr->runtime_ptr->state = E_EEPROM_XMC1_STATUS_SUCCESS;
       }
       else
       {
-        handle_ptr->state = E_EEPROM_XMC1_STATUS_FAILURE;
+        handle_ptr->runtime_ptr->state = E_EEPROM_XMC1_STATUS_FAILURE;
       }
     }
   }
-  return (handle_ptr->state);
+  return (handle_ptr->runtime_ptr->state);
 }
 
 /*
@@ -414,6 +476,7 @@ E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Write(uint8_t block_number, uint8
   E_EEPROM_XMC1_OPERATION_STATUS_t status;
   E_EEPROM_XMC1_DATA_t *data_ptr;
   
+  FUNCPROF_ENTER();
   data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
   
   XMC_ASSERT("E_EEPROM_XMC1_Write:Wrong Block Number", (E_EEPROM_XMC1_lGetUsrBlockIndex(block_number) !=
@@ -427,8 +490,14 @@ E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Write(uint8_t block_number, uint8
   {
     /* Call local function to write the specified block of data into flash */
     status = (E_EEPROM_XMC1_OPERATION_STATUS_t)E_EEPROM_XMC1_lLocalWrite(block_number, data_buffer_ptr, 0U);
+
+    if (status == E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+    {
+      E_EEPROM_XMC1_wear.block_writes[E_EEPROM_XMC1_lGetUsrBlockIndex(block_number)]++;
+    }
   }
 
+  FUNCPROF_EXIT(FUNCPROF_EEPROM_WRITE);
   return((E_EEPROM_XMC1_OPERATION_STATUS_t)status);
 }
 
@@ -481,6 +550,7 @@ E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Read(uint8_t block_number,
   E_EEPROM_XMC1_DATA_t *data_ptr;
   E_EEPROM_XMC1_OPERATION_STATUS_t status;
 
+  FUNCPROF_ENTER();
   data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
   user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
   block_size = E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr[user_block_index].size;
@@ -512,6 +582,60 @@ E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Read(uint8_t block_number,
       }
     }
   }
+  FUNCPROF_EXIT(FUNCPROF_EEPROM_READ);
+  return((E_EEPROM_XMC1_OPERATION_STATUS_t)status);
+}
+
+/*
+ * Parameters(IN)  : block_number  - Number of logical block (Block-ID)
+ *                   offset        - Start location in the user data block
+ *
+ * Parameters(OUT) : data_pptr     - Address of the data at offset in memory mapped flash
+ *                   length_ptr    - Number of bytes stored contiguously from there
+ *
+ * Return value    : E_EEPROM_XMC1_OPERATION_STATUS_t
+ *                                                                   
+ * Description     : This function shall locate user data in flash without copying it. A user block is split over
+ *                   flash blocks (12 data bytes in the first, 14 in the following), so the returned length ends at
+ *                   the end of the flash block or of the user block.
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetDataPointer(uint8_t block_number,
+                                                              uint32_t offset,
+                                                              const uint8_t **const data_pptr,
+                                                              uint32_t *const length_ptr)
+{
+  uint32_t block_size;
+  uint32_t user_block_index;
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+  E_EEPROM_XMC1_OPERATION_STATUS_t status;
+
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+  user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
+
+  XMC_ASSERT("E_EEPROM_XMC1_GetDataPointer:Wrong Block Number", (user_block_index != E_EEPROM_XMC1_LOG_BLOCK_NOT_FOUND));
+  XMC_ASSERT("E_EEPROM_XMC1_GetDataPointer:Invalid Pointer", ((data_pptr != NULL) && (length_ptr != NULL)));
+
+  block_size = E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr[user_block_index].size;
+  status = E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED;
+
+  /* The data only stays at its location while no write or GC moves it */
+  if ((data_ptr->gc_state == E_EEPROM_XMC1_GC_IDLE) && (offset < block_size))
+  {
+    if (data_ptr->block_info[user_block_index].status.valid == 0U)
+    {
+      status = E_EEPROM_XMC1_OPERATION_STATUS_INVALID_BLOCK;
+    }
+    else if (data_ptr->block_info[user_block_index].status.consistent == 0U)
+    {
+      status = E_EEPROM_XMC1_OPERATION_STATUS_INCONSISTENT_BLOCK;
+    }
+    else
+    {
+      E_EEPROM_XMC1_lLocateData(data_ptr->block_info[user_block_index].address, block_size, offset,
+                                data_pptr, length_ptr);
+      status = E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+    }
+  }
   return((E_EEPROM_XMC1_OPERATION_STATUS_t)status);
 }
 
@@ -545,6 +669,9 @@ E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StartGarbageCollection(void)
     }
     else
     {
+      #ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+      E_EEPROM_XMC1_lSaveIndex();
+      #endif
       status = E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
     }
   }
@@ -552,6 +679,219 @@ E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StartGarbageCollection(void)
   return((E_EEPROM_XMC1_OPERATION_STATUS_t)status);
 }
 
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : E_EEPROM_XMC1_OPERATION_STATUS_t
+ * 
+ * Description     : This function shall request a garbage collection that is executed in steps by
+ *                   E_EEPROM_XMC1_StepGarbageCollection.
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_RequestGarbageCollection(void)
+{
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+  E_EEPROM_XMC1_OPERATION_STATUS_t status;
+  
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+  
+  status = E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED;
+
+  if (data_ptr->gc_state == E_EEPROM_XMC1_GC_IDLE)
+  {
+    data_ptr->gc_state = E_EEPROM_XMC1_GC_REQUESTED;
+    status = E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+  }
+  
+  return((E_EEPROM_XMC1_OPERATION_STATUS_t)status);
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : E_EEPROM_XMC1_OPERATION_STATUS_t
+ * 
+ * Description     : This function shall execute one state of a requested garbage collection (one marker or block
+ *                   copy write or one bank erase).
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StepGarbageCollection(void)
+{
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+  E_EEPROM_XMC1_OPERATION_STATUS_t status;
+  
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+  
+  FUNCPROF_ENTER();
+  status = E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+
+  if (E_EEPROM_XMC1_IsGarbageCollectionRunning() == true)
+  {
+    E_EEPROM_XMC1_lGarbageCollectionStep();
+
+    #ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+    if (data_ptr->gc_state == E_EEPROM_XMC1_GC_IDLE)
+    {
+      E_EEPROM_XMC1_lSaveIndex();
+    }
+    #endif
+  }
+  
+  if (data_ptr->gc_state == E_EEPROM_XMC1_GC_FAIL)
+  {
+    status = E_EEPROM_XMC1_OPERATION_STATUS_FAILURE;
+  }
+  
+  FUNCPROF_EXIT(FUNCPROF_EEPROM_GC_STEP);
+  return((E_EEPROM_XMC1_OPERATION_STATUS_t)status);
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : bool
+ * 
+ * Description     : This function shall return true while a garbage collection is requested or in progress.
+ */
+bool E_EEPROM_XMC1_IsGarbageCollectionRunning(void)
+{
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+  
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+  
+  return ((data_ptr->gc_state != E_EEPROM_XMC1_GC_IDLE) && (data_ptr->gc_state != E_EEPROM_XMC1_GC_FAIL) &&
+          (data_ptr->gc_state != E_EEPROM_XMC1_GC_UNINT));
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : const E_EEPROM_XMC1_WEAR_t*
+ *
+ * Description     : This function shall return the flash wear counters.
+ */
+const E_EEPROM_XMC1_WEAR_t *E_EEPROM_XMC1_GetWearCounters(void)
+{
+  return (&E_EEPROM_XMC1_wear);
+}
+
+/*
+ * Parameters(IN)  : counters - Pointer to the counter values to continue from
+ *
+ * Return value    : void
+ *
+ * Description     : This function shall overwrite the flash wear counters (restore of persisted totals).
+ */
+void E_EEPROM_XMC1_SetWearCounters(const E_EEPROM_XMC1_WEAR_t *const counters)
+{
+  XMC_ASSERT("E_EEPROM_XMC1_SetWearCounters:Invalid Pointer", (counters != NULL));
+
+  E_EEPROM_XMC1_wear = *counters;
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : uint32_t
+ *
+ * Description     : This function shall return the number of free flash blocks in the active bank.
+ */
+uint32_t E_EEPROM_XMC1_GetFreeBlocks(void)
+{
+  return (E_EEPROM_XMC1_lGetFreeDFLASHBlocks());
+}
+
+/*
+ * Parameters(IN)  : block_number - Number of logical block
+ *
+ * Return value    : uint32_t
+ *
+ * Description     : This function shall return the number of flash blocks one write of a logical block occupies.
+ */
+uint32_t E_EEPROM_XMC1_GetBlockFootprint(uint8_t block_number)
+{
+  uint32_t user_block_index;
+  const E_EEPROM_XMC1_BLOCK_t *block_ptr;
+
+  user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
+  XMC_ASSERT("E_EEPROM_XMC1_GetBlockFootprint:Wrong Block Number", (user_block_index  !=
+                                                                   E_EEPROM_XMC1_LOG_BLOCK_NOT_FOUND));
+  block_ptr = E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr + user_block_index;
+
+  return (E_EEPROM_XMC1_lGetDFLASHPhysicalBlocks(block_ptr->size));
+}
+
+/*
+ * Parameters(IN)  : block_number - Number of logical block
+ *
+ * Return value    : uint32_t
+ *
+ * Description     : This function shall return the number of indexed previous copies of a logical block.
+ */
+uint32_t E_EEPROM_XMC1_GetHistoryCount(uint8_t block_number)
+{
+  uint32_t age;
+  uint32_t user_block_index;
+
+  user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
+  XMC_ASSERT("E_EEPROM_XMC1_GetHistoryCount:Wrong Block Number", (user_block_index  !=
+                                                                 E_EEPROM_XMC1_LOG_BLOCK_NOT_FOUND));
+
+  age = 0U;
+  while ((age < E_EEPROM_XMC1_HISTORY_DEPTH) && (E_EEPROM_XMC1_history[user_block_index][age] != 0U))
+  {
+    age++;
+  }
+  return (age);
+}
+
+/*
+ * Parameters(IN)  : block_number  - Number of logical block
+ *                   age           - Previous copy (0 = the one before the latest, up to E_EEPROM_XMC1_HISTORY_DEPTH - 1)
+ *                   offset        - Byte position in the user data block
+ *
+ * Parameters(OUT) : data_pptr     - Address of the user data byte at offset in flash
+ *                   length_ptr    - Number of bytes stored contiguously from there
+ *
+ * Return value    : E_EEPROM_XMC1_OPERATION_STATUS_t
+ *
+ * Description     : This function shall locate the data of a previous copy in flash like E_EEPROM_XMC1_GetDataPointer
+ *                   does for the latest one. The copy is taken from the history index without a scan.
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetHistoryPointer(uint8_t block_number,
+                                                                 uint32_t age,
+                                                                 uint32_t offset,
+                                                                 const uint8_t **const data_pptr,
+                                                                 uint32_t *const length_ptr)
+{
+  uint32_t block_size;
+  uint32_t user_block_index;
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+  E_EEPROM_XMC1_OPERATION_STATUS_t status;
+
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+  user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
+
+  XMC_ASSERT("E_EEPROM_XMC1_GetHistoryPointer:Wrong Block Number", (user_block_index != E_EEPROM_XMC1_LOG_BLOCK_NOT_FOUND));
+  XMC_ASSERT("E_EEPROM_XMC1_GetHistoryPointer:Invalid Pointer", ((data_pptr != NULL) && (length_ptr != NULL)));
+
+  block_size = E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr[user_block_index].size;
+  status = E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED;
+
+  if ((data_ptr->gc_state == E_EEPROM_XMC1_GC_IDLE) && (offset < block_size) && (age < E_EEPROM_XMC1_HISTORY_DEPTH))
+  {
+    if (E_EEPROM_XMC1_history[user_block_index][age] == 0U)
+    {
+      status = E_EEPROM_XMC1_OPERATION_STATUS_INVALID_BLOCK;
+    }
+    else
+    {
+      E_EEPROM_XMC1_lLocateData(E_EEPROM_XMC1_history[user_block_index][age], block_size, offset,
+                                data_pptr, length_ptr);
+      status = E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+    }
+  }
+  return((E_EEPROM_XMC1_OPERATION_STATUS_t)status);
+}
+
 /*
  * Parameters(IN)  : void
  *
@@ -589,7 +929,7 @@ bool E_EEPROM_XMC1_IsGarbageCollectionNeeded(uint8_t block_number)
   uint32_t flash_blocks;
   uint32_t user_block_index;
   uint32_t remaining_blocks;
-  E_EEPROM_XMC1_BLOCK_t *block_ptr;
+  const E_EEPROM_XMC1_BLOCK_t *block_ptr;
 
   status = false;
   user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
@@ -609,7 +949,7 @@ bool E_EEPROM_XMC1_IsGarbageCollectionNeeded(uint8_t block_number)
   return (status);
 }
 
-#ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
+#if defined(E_EEPROM_XMC1_CRC_SW_ENABLED) || defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
 
 /*
  * Parameters(IN)  : block_number  - Number of logical block
@@ -878,6 +1218,171 @@ static uint32_t E_EEPROM_XMC1_lSearchBlockCopy(uint8_t required_block_number,
   return(block_start_address);
 }
 
+/*
+ * Parameters(IN)  : address       - Start address of a copy of the user block
+ *                   block_size    - Size of the user block
+ *                   offset        - Byte position in the user data block
+ *
+ * Parameters(OUT) : data_pptr     - Address of the user data byte at offset in flash
+ *                   length_ptr    - Number of bytes stored contiguously from there
+ *
+ * Return value    : void
+ *
+ * Description     : Maps a user offset to its flash block and position, like E_EEPROM_XMC1_lReadBlockContents does.
+ */
+static void E_EEPROM_XMC1_lLocateData(uint32_t address, uint32_t block_size, uint32_t offset,
+                                      const uint8_t **const data_pptr, uint32_t *const length_ptr)
+{
+  uint32_t block_count;
+  uint32_t block_offset;
+
+  block_count = 0U;
+  block_offset = offset;
+  if (block_offset >= E_EEPROM_XMC1_BLOCK1_DATA_SIZE)
+  {
+    block_count++;
+    block_offset = block_offset - E_EEPROM_XMC1_BLOCK1_DATA_SIZE;
+    while (block_offset >= E_EEPROM_XMC1_BLOCK2_DATA_SIZE)
+    {
+      block_count++;
+      block_offset = block_offset - E_EEPROM_XMC1_BLOCK2_DATA_SIZE;
+    }
+    block_offset += E_EEPROM_XMC1_BLOCK2_DATA_OFFSET;
+  }
+  else
+  {
+    block_offset += E_EEPROM_XMC1_BLOCK1_DATA_OFFSET;
+  }
+
+  *data_pptr = (const uint8_t*)(address + (block_count * E_EEPROM_XMC1_FLASH_BLOCK_SIZE) + block_offset);
+  *length_ptr = E_EEPROM_XMC1_FLASH_BLOCK_SIZE - block_offset;
+  if (*length_ptr > (block_size - offset))
+  {
+    *length_ptr = block_size - offset;
+  }
+}
+
+/*
+ * Parameters(IN)  : user_block_index - Index of the logical block
+ *                   address          - Start address of its copy that is replaced (0 = none)
+ *
+ * Return value    : void
+ *
+ * Description     : Makes a copy the newest entry of the history, the oldest entry is dropped.
+ */
+static void E_EEPROM_XMC1_lPushHistory(uint32_t user_block_index, uint32_t address)
+{
+  uint32_t age;
+
+  if (address != 0U)
+  {
+    for (age = E_EEPROM_XMC1_HISTORY_DEPTH - 1U; age > 0U; age--)
+    {
+      E_EEPROM_XMC1_history[user_block_index][age] = E_EEPROM_XMC1_history[user_block_index][age - 1U];
+    }
+    E_EEPROM_XMC1_history[user_block_index][0] = address;
+  }
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : void
+ *
+ * Description     : Indexes the previous copies of all blocks with one forward pass over the written part of the
+ *                   active bank. Copies are written in sequence, so a copy is its valid start block followed by the
+ *                   blocks of the same number. Complete copies without ECC errors are pushed from the oldest on, the
+ *                   latest copy (cache) is not part of the history.
+ */
+static void E_EEPROM_XMC1_lBuildHistory(void)
+{
+  uint32_t age;
+  uint32_t read_addr;
+  uint32_t copy_addr;
+  uint32_t header_word;
+  uint32_t block_count;
+  uint32_t expected_block_count;
+  uint32_t user_block_index;
+  uint32_t is_all_blocks_clean;
+  uint32_t is_copy_open;
+  uint8_t block_number;
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+  E_EEPROM_XMC1_BLOCK_HEADER_t* block_header_ptr;
+
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+  block_header_ptr = (E_EEPROM_XMC1_BLOCK_HEADER_t*)(void *)(&header_word);
+
+  for (user_block_index = 0U; user_block_index < E_EEPROM_XMC1_MAX_BLOCK_COUNT; user_block_index++)
+  {
+    for (age = 0U; age < E_EEPROM_XMC1_HISTORY_DEPTH; age++)
+    {
+      E_EEPROM_XMC1_history[user_block_index][age] = 0U;
+    }
+  }
+
+  if (data_ptr->current_bank == 0U)
+  {
+    read_addr = E_EEPROM_XMC1_FLASH_BANK0_BASE + E_EEPROM_XMC1_DATA_BLOCK_OFFSET;
+  }
+  else
+  {
+    read_addr = E_EEPROM_XMC1_FLASH_BANK1_BASE + E_EEPROM_XMC1_DATA_BLOCK_OFFSET;
+  }
+
+  while (read_addr < data_ptr->next_free_block_addr)
+  {
+    /* Clear all error status flags before flash operation*/
+    XMC_FLASH_ClearStatus();
+    header_word = E_EEPROM_XMC1_lReadSingleWord(read_addr);
+    block_number = block_header_ptr->block_number;
+    user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
+
+    if (((block_header_ptr->status & (uint8_t)(E_EEPROM_XMC1_START_BIT | E_EEPROM_XMC1_VALID_BIT)) ==
+         (uint8_t)(E_EEPROM_XMC1_START_BIT | E_EEPROM_XMC1_VALID_BIT)) &&
+        (user_block_index != E_EEPROM_XMC1_LOG_BLOCK_NOT_FOUND) &&
+        (read_addr != data_ptr->block_info[user_block_index].address))
+    {
+      expected_block_count =
+          E_EEPROM_XMC1_lGetDFLASHPhysicalBlocks(E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr[user_block_index].size);
+      block_count = 0U;
+      is_all_blocks_clean = 1U;
+      is_copy_open = 1U;
+      copy_addr = read_addr;
+      do
+      {
+        if ((E_EEPROM_XMC1_lGetFlashStatus() & (uint32_t)XMC_FLASH_STATUS_ECC2_READ_ERROR) != 0U)
+        {
+          is_all_blocks_clean = 0U;
+        }
+        block_count++;
+        copy_addr += E_EEPROM_XMC1_FLASH_BLOCK_SIZE;
+
+        /* The next block continues the copy if it has the same number and no start bit */
+        if ((block_count < expected_block_count) && (copy_addr < data_ptr->next_free_block_addr))
+        {
+          XMC_FLASH_ClearStatus();
+          header_word = E_EEPROM_XMC1_lReadSingleWord(copy_addr);
+          if ((block_header_ptr->block_number != block_number) ||
+              ((block_header_ptr->status & E_EEPROM_XMC1_START_BIT) != 0U))
+          {
+            is_copy_open = 0U;
+          }
+        }
+        else
+        {
+          is_copy_open = 0U;
+        }
+      } while (is_copy_open == 1U);
+
+      if ((block_count == expected_block_count) && (is_all_blocks_clean == 1U))
+      {
+        E_EEPROM_XMC1_lPushHistory(user_block_index, read_addr);
+      }
+    }
+    read_addr += E_EEPROM_XMC1_FLASH_BLOCK_SIZE;
+  }
+}
+
 /*
  * Parameters(IN)  : marker_dirty_state  - Dirty state
  *
@@ -1446,47 +1951,61 @@ static void E_EEPROM_XMC1_lGarbageCollection(void)
   
   do
   {
-    switch (data_ptr->gc_state)
-    {
-      case E_EEPROM_XMC1_GC_COPY_START:
-        E_EEPROM_XMC1_lHandleGcStartCopy();
-        break;
-      
-      case E_EEPROM_XMC1_GC_COPY_WRITE:
-        E_EEPROM_XMC1_lHandleGcCopyWrite();
-        break;
-      
-      case E_EEPROM_XMC1_GC_READ_NXTBLOCK:
-        XMC_FLASH_ClearStatus();
-        E_EEPROM_XMC1_lReadSingleBlock(data_ptr->gc_src_addr ,(uint32_t*)(void*)data_ptr->read_write_buffer);
-        data_ptr->gc_state = E_EEPROM_XMC1_GC_COPY_WRITE;
-        break;
-      
-      case E_EEPROM_XMC1_GC_COPY_END:
-        E_EEPROM_XMC1_lHandleGcEndOfCopy();
-        break;
-      
-      case E_EEPROM_XMC1_GC_NEXT_BANK_VALID:
-        E_EEPROM_XMC1_lHandleGcOtherStates(E_EEPROM_XMC1_GC_NEXT_BANK_VALID, E_EEPROM_XMC1_GC_ERASE_PREV_BANK);
-        break;
-      
-      case E_EEPROM_XMC1_GC_ERASE_PREV_BANK:
-        E_EEPROM_XMC1_lHandleGcOtherStates( E_EEPROM_XMC1_GC_ERASE_PREV_BANK, E_EEPROM_XMC1_GC_MARK_END_ERASE1);
-        break;
-      
-      case E_EEPROM_XMC1_GC_MARK_END_ERASE1:
-        E_EEPROM_XMC1_lHandleGcOtherStates(E_EEPROM_XMC1_GC_MARK_END_ERASE1, E_EEPROM_XMC1_GC_IDLE);
-        break;
-      
-      default:
-        E_EEPROM_XMC1_lHandleGcRequested(); /* E_EEPROM_XMC1_GC_REQUESTED state*/
-      break;
-    }
-    
+    E_EEPROM_XMC1_lGarbageCollectionStep();
   } while ((data_ptr->gc_state != E_EEPROM_XMC1_GC_IDLE) &&
   (data_ptr->gc_state != E_EEPROM_XMC1_GC_FAIL));
 }
 
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : void
+ *
+ * Description     : This function execute's one state of the garbage collection state machine.
+ */
+static void E_EEPROM_XMC1_lGarbageCollectionStep(void)
+{
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+  
+  switch (data_ptr->gc_state)
+  {
+    case E_EEPROM_XMC1_GC_COPY_START:
+      E_EEPROM_XMC1_lHandleGcStartCopy();
+      break;
+    
+    case E_EEPROM_XMC1_GC_COPY_WRITE:
+      E_EEPROM_XMC1_lHandleGcCopyWrite();
+      break;
+    
+    case E_EEPROM_XMC1_GC_READ_NXTBLOCK:
+      XMC_FLASH_ClearStatus();
+      E_EEPROM_XMC1_lReadSingleBlock(data_ptr->gc_src_addr ,(uint32_t*)(void*)data_ptr->read_write_buffer);
+      data_ptr->gc_state = E_EEPROM_XMC1_GC_COPY_WRITE;
+      break;
+    
+    case E_EEPROM_XMC1_GC_COPY_END:
+      E_EEPROM_XMC1_lHandleGcEndOfCopy();
+      break;
+    
+    case E_EEPROM_XMC1_GC_NEXT_BANK_VALID:
+      E_EEPROM_XMC1_lHandleGcOtherStates(E_EEPROM_XMC1_GC_NEXT_BANK_VALID, E_EEPROM_XMC1_GC_ERASE_PREV_BANK);
+      break;
+    
+    case E_EEPROM_XMC1_GC_ERASE_PREV_BANK:
+      E_EEPROM_XMC1_lHandleGcOtherStates( E_EEPROM_XMC1_GC_ERASE_PREV_BANK, E_EEPROM_XMC1_GC_MARK_END_ERASE1);
+      break;
+    
+    case E_EEPROM_XMC1_GC_MARK_END_ERASE1:
+      E_EEPROM_XMC1_lHandleGcOtherStates(E_EEPROM_XMC1_GC_MARK_END_ERASE1, E_EEPROM_XMC1_GC_IDLE);
+      break;
+    
+    default:
+      E_EEPROM_XMC1_lHandleGcRequested(); /* E_EEPROM_XMC1_GC_REQUESTED state*/
+    break;
+  }
+}
+
 /*
  * Parameters(IN)  : void
  *
@@ -1496,6 +2015,7 @@ static void E_EEPROM_XMC1_lGarbageCollection(void)
  */
 static void E_EEPROM_XMC1_lHandleGcRequested(void)
 {
+  uint32_t age;
   uint32_t status;
   uint32_t block_count;
   E_EEPROM_XMC1_DATA_t *data_ptr;
@@ -1503,6 +2023,22 @@ static void E_EEPROM_XMC1_lHandleGcRequested(void)
 
   data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
   
+  E_EEPROM_XMC1_wear.gc_runs++;
+
+  /* Only the latest copies are taken to the new bank */
+  for (block_count = 0U; block_count < E_EEPROM_XMC1_MAX_BLOCK_COUNT; block_count++)
+  {
+    for (age = 0U; age < E_EEPROM_XMC1_HISTORY_DEPTH; age++)
+    {
+      E_EEPROM_XMC1_history[block_count][age] = 0U;
+    }
+  }
+
+  #ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+  /* The banks change from now on - a reset before the end of the GC needs the full scan */
+  E_EEPROM_XMC1_lInvalidateIndex();
+  #endif
+
   E_EEPROM_XMC1_lSetMarkerBlockBuffer();
   /* Write Copy start state to new bank  (2A) or (A2) */
   status = E_EEPROM_XMC1_lGCWrite((uint32_t)(data_ptr->gc_dest_addr + E_EEPROM_XMC1_BEGIN_OFFSET));
@@ -2033,6 +2569,16 @@ static void E_EEPROM_XMC1_lEvalBlockStatus(void)
         if ( data_ptr->written_block_counter == physical_blocks)
         {
           cache_ptr->status.consistent = 1U;  /* EVALUATION RESULT : BLOCK CONSISTENT*/
+          #ifdef E_EEPROM_XMC1_BLOCK_CRC_ENABLED
+          /* Checked once while mounting (the start block header is in the buffer), reads of a consistent block and a
+             fast mount from the index do not compute the CRC again */
+          if ((cache_ptr->status.valid == 1U) && (cache_ptr->status.crc == 1U) &&
+              (E_EEPROM_XMC1_lFlashBlockCrc(cache_ptr->address, size) !=
+               (*((uint32_t *)(void *)data_ptr->read_write_buffer) >> E_EEPROM_XMC1_CRC_SHIFT)))
+          {
+            cache_ptr->status.consistent = 0U;  /* EVALUATION RESULT : BLOCK CORRUPTED */
+          }
+          #endif
         }
         else
         {
@@ -2099,24 +2645,19 @@ static uint32_t E_EEPROM_XMC1_lUpdateCacheBlockRead(void)
  *
  * Return value   : uint32_t : returns array index pointer of block configuration
  *
- * Description    : This utility function will return the Index (location) of the block in the user configuration.
+ * Description    : This utility function will return the Index (location) of the block in the user configuration
+ *                  (constant time, E_EEPROM_XMC1_block_Index of the configuration).
  */
 static uint32_t E_EEPROM_XMC1_lGetUsrBlockIndex(uint8_t block_number)
 {
   uint32_t indx;
-  E_EEPROM_XMC1_BLOCK_t  *block_ptr;
   
-  indx = 0U;
-  block_ptr = &(E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr[indx]);
-  
-  /* Check for max configured block count reached and block number is matched against the configured block numbers */
-  while ( (indx < E_EEPROM_XMC1_HANDLE_PTR->block_count) && (block_ptr->block_number != block_number) )
+  /* Direct-mapped lookup in the generated index, unused numbers hold E_EEPROM_XMC1_LOG_BLOCK_NOT_FOUND */
+  if ( block_number <= E_EEPROM_XMC1_MAX_BLOCK_NUMBER )
   {
-    indx++;
-    block_ptr++;
+    indx = E_EEPROM_XMC1_HANDLE_PTR->block_index_ptr[block_number];
   }
-  
-  if ( indx == E_EEPROM_XMC1_HANDLE_PTR->block_count )
+  else
   {
     indx = E_EEPROM_XMC1_LOG_BLOCK_NOT_FOUND;
   }
@@ -2435,6 +2976,10 @@ static uint32_t E_EEPROM_XMC1_lEraseBank(uint32_t page_address)
 {
   uint32_t indx;
   uint32_t status;
+
+  /* Count the erase in the wear counter of the bank that contains page_address */
+  E_EEPROM_XMC1_wear.bank_erases[(page_address >= E_EEPROM_XMC1_FLASH_BANK1_BASE) ? 1U : 0U]++;
+
   /* Clear all error status flags before flash operation*/
   page_address = ((page_address) - E_EEPROM_XMC1_FLASH_PAGE_SIZE );
   page_address += 1U;
@@ -2498,7 +3043,7 @@ static uint32_t E_EEPROM_XMC1_lLocalWrite( uint8_t block_number,
   uint32_t user_block_index;
   uint32_t remaining_blocks;
   E_EEPROM_XMC1_DATA_t *data_ptr;
-  E_EEPROM_XMC1_BLOCK_t *block_ptr;
+  const E_EEPROM_XMC1_BLOCK_t *block_ptr;
 
   data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
 
@@ -2506,6 +3051,11 @@ static uint32_t E_EEPROM_XMC1_lLocalWrite( uint8_t block_number,
   perform_write = 0U;
   user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
   block_ptr = E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr + user_block_index;
+
+  #ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+  /* Flash content and write pointer change from now on - a reset before the end of the write needs the full scan */
+  E_EEPROM_XMC1_lInvalidateIndex();
+  #endif
   
   flash_blocks = E_EEPROM_XMC1_lGetDFLASHPhysicalBlocks(block_ptr->size);
   remaining_blocks = E_EEPROM_XMC1_lGetFreeDFLASHBlocks();
@@ -2559,6 +3109,13 @@ static uint32_t E_EEPROM_XMC1_lLocalWrite( uint8_t block_number,
        status = (uint32_t)E_EEPROM_XMC1_OPERATION_STATUS_FAILURE;
     }
   }
+
+  #ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+  if ((status == 0U) && (data_ptr->gc_state == E_EEPROM_XMC1_GC_IDLE))
+  {
+    E_EEPROM_XMC1_lSaveIndex();
+  }
+  #endif
   return (status);
 }
 
@@ -2573,10 +3130,11 @@ static uint32_t E_EEPROM_XMC1_lLocalWrite( uint8_t block_number,
 static uint32_t E_EEPROM_XMC1_lHandleWriteReq(uint8_t block_number, uint8_t* data_buffer_ptr)
 {
   uint32_t block_size;
+  uint32_t previous_address;
   uint32_t user_block_index;
   uint32_t status;
   E_EEPROM_XMC1_DATA_t *data_ptr;
-  E_EEPROM_XMC1_BLOCK_t *block_ptr;
+  const E_EEPROM_XMC1_BLOCK_t *block_ptr;
   
   data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
   
@@ -2584,6 +3142,13 @@ static uint32_t E_EEPROM_XMC1_lHandleWriteReq(uint8_t block_number, uint8_t* dat
   user_block_index = E_EEPROM_XMC1_lGetUsrBlockIndex(block_number);
   block_ptr = E_EEPROM_XMC1_HANDLE_PTR->block_config_ptr + user_block_index;
   block_size = block_ptr->size;
+  /* The current copy becomes the newest previous one once the new copy is complete */
+  previous_address = 0U;
+  if ((data_ptr->block_info[user_block_index].status.valid == 1U) &&
+      (data_ptr->block_info[user_block_index].status.consistent == 1U))
+  {
+    previous_address = data_ptr->block_info[user_block_index].address;
+  }
   data_ptr->user_write_bytes_count = 0U;
   data_ptr->user_write_state = E_EEPROM_XMC1_FIRST_BLOCK_WRITE;
   status = 0U;
@@ -2603,6 +3168,7 @@ static uint32_t E_EEPROM_XMC1_lHandleWriteReq(uint8_t block_number, uint8_t* dat
       status = E_EEPROM_XMC1_lWriteDataBlock();
       if (status == (uint32_t)0U)
       {
+        E_EEPROM_XMC1_lPushHistory(user_block_index, previous_address);
         /* Mark the block as inconsistent */
         data_ptr->block_info[user_block_index].address = data_ptr->next_free_block_addr;
         data_ptr->block_info[user_block_index].status.valid = 1U;
@@ -2667,6 +3233,11 @@ static uint32_t E_EEPROM_XMC1_lHandleInvalidReq(uint8_t block_number, uint32_t
   
   if (status == 0U)
   {
+    if ((data_ptr->block_info[user_block_index].status.valid == 1U) &&
+        (data_ptr->block_info[user_block_index].status.consistent == 1U))
+    {
+      E_EEPROM_XMC1_lPushHistory(user_block_index, data_ptr->block_info[user_block_index].address);
+    }
     data_ptr->block_info[user_block_index].status.consistent = 1U;
     data_ptr->block_info[user_block_index].address = data_ptr->next_free_block_addr;
   }
@@ -2709,6 +3280,18 @@ static void E_EEPROM_XMC1_lPopulateFirstBlock(uint8_t block_number,
     CRC_SW_CalculateCRC(E_EEPROM_XMC1_HANDLE_PTR->crc_handle_ptr,user_data_buffer_ptr,block_size);
     crc_buffer = CRC_SW_GetCRCResult(E_EEPROM_XMC1_HANDLE_PTR->crc_handle_ptr);
     crc_bit = E_EEPROM_XMC1_CRC_BIT;
+  #elif defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
+    /* The header is written first, so the CRC of the whole user buffer is needed before the data is copied */
+    if (E_EEPROM_XMC1_HANDLE_PTR->data_block_crc == 1U)
+    {
+      crc_buffer = E_EEPROM_XMC1_lCrcUpdate(E_EEPROM_XMC1_BLOCK_CRC_INIT, user_data_buffer_ptr, block_size);
+      crc_bit = E_EEPROM_XMC1_CRC_BIT;
+    }
+    else
+    {
+      crc_buffer = E_EEPROM_XMC1_DUMMY_CRC;
+      crc_bit = 0U;
+    }
   #else
     crc_buffer = E_EEPROM_XMC1_DUMMY_CRC;
     crc_bit = 0U;
@@ -2905,7 +3488,7 @@ static uint32_t E_EEPROM_XMC1_lReadBlockContents(uint8_t *const data_buffer_ptr,
   return (status);
 }
 
-#ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
+#if defined(E_EEPROM_XMC1_CRC_SW_ENABLED) || defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
 /*
  * Parameters(IN)  : block_number   - User block number / ID
  *                   data_buffer_ptr - Data buffer address
@@ -2941,8 +3524,12 @@ static E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_lReadBlockCrcStatus( uint8
   if (data_ptr->block_info[block_index].status.crc == 1U)
   {
     /* IF Block CRC is enabled then update the block Header with 16 bit CRC calculated from the data buffer*/
+    #ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
     CRC_SW_CalculateCRC(E_EEPROM_XMC1_HANDLE_PTR->crc_handle_ptr,data_buffer_ptr,block_size);
     crc_buffer = CRC_SW_GetCRCResult(E_EEPROM_XMC1_HANDLE_PTR->crc_handle_ptr);
+    #else
+    crc_buffer = E_EEPROM_XMC1_lCrcUpdate(E_EEPROM_XMC1_BLOCK_CRC_INIT, data_buffer_ptr, block_size);
+    #endif
     /* Check the validity of CRC for the particular block */
     if (crc_buffer != (crc_read_from_flash >> E_EEPROM_XMC1_CRC_SHIFT))
     {
@@ -2969,6 +3556,7 @@ static E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_lReadBlockCrcStatus( uint8
  */
 static void E_EEPROM_XMC1_lWriteSingleBlock(uint32_t const address, const uint32_t *const data)
 {
+  FUNCPROF_ENTER();
   #ifdef E_EEPROM_XMC1_TEST_HOOK_ENABLE
   if (e_eeprom_xmc1_test_hook_writeblock == 1U)
   {
@@ -2979,6 +3567,7 @@ static void E_EEPROM_XMC1_lWriteSingleBlock(uint32_t const address, const uint32
   {
     XMC_FLASH_WriteBlocks( (uint32_t*)address, (uint32_t*)data , 1U , 1U);
   }
+  FUNCPROF_EXIT(FUNCPROF_FLASH_PROGRAM);
 }
 
 /*
@@ -3015,6 +3604,7 @@ static void E_EEPROM_XMC1_lReadSingleBlock(uint32_t const address, uint32_t *con
  */
 static void E_EEPROM_XMC1_lWriteSinglePage(uint32_t const address, const uint32_t *const data)
 {
+  FUNCPROF_ENTER();
   #ifdef E_EEPROM_XMC1_TEST_HOOK_ENABLE
   if (e_eeprom_xmc1_test_hook_writepage == 1U)
   {
@@ -3025,6 +3615,7 @@ static void E_EEPROM_XMC1_lWriteSinglePage(uint32_t const address, const uint32_
   {
     XMC_FLASH_ProgramPage( (uint32_t*)address , (uint32_t*)data);
   }
+  FUNCPROF_EXIT(FUNCPROF_FLASH_PROGRAM);
 }
 
 /*
@@ -3036,6 +3627,7 @@ static void E_EEPROM_XMC1_lWriteSinglePage(uint32_t const address, const uint32_
  */
 static void E_EEPROM_XMC1_lEraseSinglePage(uint32_t const address)
 {
+  FUNCPROF_ENTER();
   #ifdef E_EEPROM_XMC1_TEST_HOOK_ENABLE
   if (e_eeprom_xmc1_test_hook_erasepage == 1U)
   {
@@ -3046,6 +3638,7 @@ static void E_EEPROM_XMC1_lEraseSinglePage(uint32_t const address)
   {
     XMC_FLASH_ErasePages( (uint32_t*)address , 1U);
   }
+  FUNCPROF_EXIT(FUNCPROF_FLASH_ERASE);
 }
 
 /*
@@ -3094,3 +3687,157 @@ static uint32_t E_EEPROM_XMC1_lGetFlashStatus(void)
   return (status);
 }
 /*CODE_BLOCK_END*/
+
+#if defined(E_EEPROM_XMC1_FAST_MOUNT_ENABLED) || defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
+/*
+ * Parameters(IN)  : crc    - CRC of the bytes before (E_EEPROM_XMC1_*_CRC_INIT for the first part)
+ *                   data   - Bytes to add
+ *                   length - Number of bytes
+ *
+ * Return value    : uint32_t - CRC-16/CCITT including data
+ *
+ * Description     : Table driven CRC, one 16 entry lookup per 4 bit (the 256 entry table would cost 512 bytes flash)
+ */
+static uint32_t E_EEPROM_XMC1_lCrcUpdate(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+  uint32_t indx;
+
+  for (indx = 0U; indx < length; indx++)
+  {
+    crc = ((crc << 4U) & 0xFFFFU) ^ E_EEPROM_XMC1_crc_table[(crc >> 12U) ^ ((uint32_t)data[indx] >> 4U)];
+    crc = ((crc << 4U) & 0xFFFFU) ^ E_EEPROM_XMC1_crc_table[(crc >> 12U) ^ ((uint32_t)data[indx] & 0x0FU)];
+  }
+  return (crc);
+}
+#endif
+
+#ifdef E_EEPROM_XMC1_BLOCK_CRC_ENABLED
+/*
+ * Parameters(IN)  : address - Flash address of the start block of a logical block
+ *                   size    - Size of the logical block in bytes
+ *
+ * Return value    : uint32_t - CRC-16/CCITT of the data bytes
+ *
+ * Description     : Calculates the CRC over the data bytes of all flash blocks of a logical block in place in the
+ *                   memory mapped flash (12 bytes after the header of the start block, 14 in the following ones).
+ *                   Only used on blocks the cache scan read without ECC error.
+ */
+static uint32_t E_EEPROM_XMC1_lFlashBlockCrc(uint32_t address, uint32_t size)
+{
+  uint32_t crc;
+  uint32_t length;
+
+  length = (size < E_EEPROM_XMC1_BLOCK1_DATA_SIZE) ? size : E_EEPROM_XMC1_BLOCK1_DATA_SIZE;
+  crc = E_EEPROM_XMC1_lCrcUpdate(E_EEPROM_XMC1_BLOCK_CRC_INIT,
+                                 (const uint8_t*)(address + E_EEPROM_XMC1_BLOCK1_DATA_OFFSET), length);
+  size -= length;
+  while (size != 0U)
+  {
+    address += E_EEPROM_XMC1_FLASH_BLOCK_SIZE;
+    length = (size < E_EEPROM_XMC1_BLOCK2_DATA_SIZE) ? size : E_EEPROM_XMC1_BLOCK2_DATA_SIZE;
+    crc = E_EEPROM_XMC1_lCrcUpdate(crc, (const uint8_t*)(address + E_EEPROM_XMC1_BLOCK2_DATA_OFFSET), length);
+    size -= length;
+  }
+  return (crc);
+}
+#endif
+
+#ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : uint32_t - CRC-16/CCITT of the index record (without the crc member)
+ *
+ * Description     : Calculates the check sum of the fast mount index record
+ */
+static uint32_t E_EEPROM_XMC1_lIndexCrc(void)
+{
+  return (E_EEPROM_XMC1_lCrcUpdate(E_EEPROM_XMC1_INDEX_CRC_INIT, (const uint8_t*)(const void*)&E_EEPROM_XMC1_index,
+                                   (uint32_t)offsetof(E_EEPROM_XMC1_INDEX_t, crc)));
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : void
+ *
+ * Description     : Stores the mounted state (active bank, write pointer and cache table) in the index record.
+ *                   Must only be called while the emulation is idle and consistent.
+ */
+static void E_EEPROM_XMC1_lSaveIndex(void)
+{
+  uint32_t indx;
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+
+  E_EEPROM_XMC1_index.current_bank = data_ptr->current_bank;
+  E_EEPROM_XMC1_index.next_free_block_addr = data_ptr->next_free_block_addr;
+  E_EEPROM_XMC1_index.last_block_word = E_EEPROM_XMC1_lReadSingleWord(data_ptr->next_free_block_addr -
+                                                                      E_EEPROM_XMC1_FLASH_BLOCK_SIZE);
+  for (indx = 0U; indx < E_EEPROM_XMC1_MAX_BLOCK_COUNT; indx++)
+  {
+    E_EEPROM_XMC1_index.block_info[indx] = data_ptr->block_info[indx];
+  }
+  E_EEPROM_XMC1_index.magic = E_EEPROM_XMC1_INDEX_MAGIC;
+  E_EEPROM_XMC1_index.crc = E_EEPROM_XMC1_lIndexCrc();
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : void
+ *
+ * Description     : Marks the index record as outdated, the next Init will scan the flash
+ */
+static void E_EEPROM_XMC1_lInvalidateIndex(void)
+{
+  E_EEPROM_XMC1_index.magic = 0U;
+}
+
+/*
+ * Parameters(IN)  : void
+ *
+ * Return value    : uint32_t - 1U if the state was restored from the index record, 0U if a full scan is needed
+ *
+ * Description     : Restores the mounted state from the index record if its magic and CRC are valid, the write
+ *                   pointer lies inside the active bank and the last written flash block still holds the recorded
+ *                   content (detects flash that was erased or reprogrammed while the RAM was kept).
+ */
+static uint32_t E_EEPROM_XMC1_lFastMount(void)
+{
+  uint32_t indx;
+  uint32_t base_addr;
+  E_EEPROM_XMC1_DATA_t *data_ptr;
+
+  data_ptr = (E_EEPROM_XMC1_DATA_t*)(void*)(E_EEPROM_XMC1_HANDLE_PTR->data_ptr);
+
+  if ((E_EEPROM_XMC1_index.magic != E_EEPROM_XMC1_INDEX_MAGIC) ||
+      (E_EEPROM_XMC1_index.crc != E_EEPROM_XMC1_lIndexCrc()) ||
+      (E_EEPROM_XMC1_index.current_bank > 1U))
+  {
+    return (0U);
+  }
+
+  base_addr = (E_EEPROM_XMC1_index.current_bank == 0U) ? E_EEPROM_XMC1_FLASH_BANK0_BASE :
+                                                          E_EEPROM_XMC1_FLASH_BANK1_BASE;
+  if ((E_EEPROM_XMC1_index.next_free_block_addr <= base_addr) ||
+      (E_EEPROM_XMC1_index.next_free_block_addr > (base_addr + E_EEPROM_XMC1_FLASH_BANK_SIZE)) ||
+      (E_EEPROM_XMC1_lReadSingleWord(E_EEPROM_XMC1_index.next_free_block_addr - E_EEPROM_XMC1_FLASH_BLOCK_SIZE) !=
+       E_EEPROM_XMC1_index.last_block_word))
+  {
+    return (0U);
+  }
+
+  data_ptr->current_bank = E_EEPROM_XMC1_index.current_bank;
+  E_EEPROM_XMC1_lUpdateCurrBankInfo();
+  data_ptr->next_free_block_addr = E_EEPROM_XMC1_index.next_free_block_addr;
+  for (indx = 0U; indx < E_EEPROM_XMC1_MAX_BLOCK_COUNT; indx++)
+  {
+    data_ptr->block_info[indx] = E_EEPROM_XMC1_index.block_info[indx];
+  }
+  data_ptr->gc_state = E_EEPROM_XMC1_GC_IDLE;
+
+  return (1U);
+}
+#endif
@@ -211,6 +211,37 @@ typedef struct E_EEPROM_XMC1_TRAVERSE_BLOCK_RESULT
 } E_EEPROM_XMC1_TRAVERSE_BLOCK_RESULT_t;
 
 
+/** Data structure holding the flash wear counters. Use @ref E_EEPROM_XMC1_GetWearCounters for reading the values */
+typedef struct E_EEPROM_XMC1_WEAR
+{
+  uint32_t block_writes[E_EEPROM_XMC1_MAX_BLOCK_COUNT]; /**< Successful writes per user block (index of the block
+                                                             in the configuration table) */
+  uint32_t gc_runs; /**< Number of started garbage collections */
+
+  uint32_t bank_erases[2]; /**< Number of erases of bank 0 and bank 1 */
+
+} E_EEPROM_XMC1_WEAR_t;
+
+
+/** Compact copy of the mounted state, kept in no-init RAM to skip the flash scan of @ref E_EEPROM_XMC1_Init after a
+ *  reset (only used with E_EEPROM_XMC1_FAST_MOUNT_ENABLED) */
+typedef struct E_EEPROM_XMC1_INDEX
+{
+  uint32_t magic; /**< E_EEPROM_XMC1_INDEX_MAGIC while the record matches the flash content */
+
+  uint32_t current_bank; /**< Active bank */
+
+  uint32_t next_free_block_addr; /**< Flash address of the next block write */
+
+  uint32_t last_block_word; /**< First word of the last written flash block (detects flash changed behind the index)*/
+
+  E_EEPROM_XMC1_CACHE_t block_info[E_EEPROM_XMC1_MAX_BLOCK_COUNT]; /**< Latest address and status per user block */
+
+  uint32_t crc; /**< CRC-16/CCITT over all members above */
+
+} E_EEPROM_XMC1_INDEX_t;
+
+
 /** Data structure to hold the complete state data information of Emulation APP (Run Time Handler)*/
 typedef struct E_EEPROM_XMC1_DATA
 {
@@ -261,19 +292,30 @@ typedef struct E_EEPROM_XMC1_DATA
 } E_EEPROM_XMC1_DATA_t;
 
 
+/** Runtime state of the APP instance (RAM, the handle itself is const and placed in flash) */
+typedef struct E_EEPROM_XMC1_RUNTIME
+{
+  E_EEPROM_XMC1_STATUS_t  state; /**< Current state of the APP instance*/
+
+} E_EEPROM_XMC1_RUNTIME_t;
+
+
 /** Data structure to configure the APP properties. Use @ref E_EEPROM_XMC1_t type for accessing the members */
 typedef struct E_EEPROM_XMC1
 {
-  E_EEPROM_XMC1_BLOCK_t *block_config_ptr; /**< Pointer to user block configurations */
+  const E_EEPROM_XMC1_BLOCK_t *block_config_ptr; /**< Pointer to user block configurations */
+
+  const uint8_t *block_index_ptr; /**< Block number to configuration index (E_EEPROM_XMC1_MAX_BLOCK_NUMBER + 1 entries,
+                                       0xFF = not configured) */
 
-  E_EEPROM_XMC1_DATA_t *data_ptr; /**< Pointer to the state variable data structure */
+  E_EEPROM_XMC1_DATA_t *const data_ptr; /**< Pointer to the state variable data structure */
+
+  E_EEPROM_XMC1_RUNTIME_t *const runtime_ptr; /**< Pointer to the runtime state of the APP instance */
 
   #ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
   CRC_SW_t* const crc_handle_ptr;  /**< CRC APP handle pointer*/
   #endif
 
-  E_EEPROM_XMC1_STATUS_t  state; /**< Current state of the APP instance*/
-
   const uint8_t  block_count; /**< Number of configured user data blocks */
 
   const uint8_t  erase_all_auto_recovery; /**< Erase Complete emulation area and recover to default state */
@@ -284,7 +326,7 @@ typedef struct E_EEPROM_XMC1
 
 } E_EEPROM_XMC1_t;
 
-typedef E_EEPROM_XMC1_t* E_EEPROM_XMC1_HANDLE_PTR_t; /**< Defines a pointer to APP Handle*/
+typedef const E_EEPROM_XMC1_t* E_EEPROM_XMC1_HANDLE_PTR_t; /**< Defines a pointer to APP Handle*/
 
 /**
  *@}
@@ -400,7 +442,7 @@ DAVE_APP_VERSION_t E_EEPROM_XMC1_GetAppVersion(void);
  *  }
  *  @endcode<BR> </p>
  */
-E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(E_EEPROM_XMC1_t *const handle_ptr);
+E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(const E_EEPROM_XMC1_t *const handle_ptr);
 
 
 /**
@@ -585,6 +627,144 @@ E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Read(uint8_t block_number,
  */
 E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StartGarbageCollection(void);
 
+/**
+ * @brief Requests a garbage collection that is executed in steps instead of running to completion.
+ *
+ * @return <BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS, if the garbage collection is requested<BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED, if APP initialization is not completed or a garbage collection is
+ *    already running<BR>
+ *
+ * \par<b>Description:</b><br>
+ *  Only marks the garbage collection as requested, no flash operation is done. Every call of
+ *  E_EEPROM_XMC1_StepGarbageCollection() then executes one state of it. Write, read and invalidate requests are
+ *  rejected (E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED) until E_EEPROM_XMC1_IsGarbageCollectionRunning() is false.
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_RequestGarbageCollection(void);
+
+/**
+ * @brief Executes one state of a requested garbage collection.
+ *
+ * @return <BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS, if the step completed or no garbage collection is running<BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_FAILURE, if the garbage collection failed due to internal flash errors<BR>
+ *
+ * \par<b>Description:</b><br>
+ *  One step is one bounded flash operation: writing a bank marker, copying one data block to the new bank or
+ *  erasing the previous bank. The time of a single call is therefore limited to the longest of these operations
+ *  instead of the whole garbage collection.
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StepGarbageCollection(void);
+
+/**
+ * @brief Checks whether a garbage collection is requested or in progress.
+ *
+ * @return <BR>
+ *    true, if a garbage collection is requested or in progress, else false.
+ */
+bool E_EEPROM_XMC1_IsGarbageCollectionRunning(void);
+
+/**
+ * @brief Locates user data of a block in the memory mapped flash without copying it.
+ *
+ * @param block_number Number of logical block (Block-ID).
+ * @param offset Start location in the user data block.
+ * @param data_pptr Returns the address of the data at offset.
+ * @param length_ptr Returns the number of bytes stored contiguously from that address.
+ *
+ * @return <BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS, if the data was located<BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED, if a garbage collection is running or offset is outside the block<BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_INVALID_BLOCK, if the block was never written or is invalidated<BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_INCONSISTENT_BLOCK, if the block is inconsistent<BR>
+ *
+ * \par<b>Description:</b><br>
+ *  The block is validated from the cache, like @ref E_EEPROM_XMC1_Read does. Each flash block holds 12 (first) or
+ *  14 (following) bytes of user data, so a user block of up to 12 bytes is returned in one piece, larger ones have to
+ *  be walked with increasing offset. The pointer is only valid until the next write of the block or garbage
+ *  collection. The data CRC (if enabled) is not checked.
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetDataPointer(uint8_t block_number,
+                                                              uint32_t offset,
+                                                              const uint8_t **const data_pptr,
+                                                              uint32_t *const length_ptr);
+
+/**
+ * @brief Returns the flash wear counters.
+ *
+ * @return const E_EEPROM_XMC1_WEAR_t* Pointer to the counters (successful writes per block, garbage collection runs
+ *         and erases per bank).
+ *
+ * \par<b>Description:</b><br>
+ *  The counters are kept in RAM only and start at zero after reset. To get lifetime totals the application has to
+ *  store them (e.g. in an own data block) and hand them back with @ref E_EEPROM_XMC1_SetWearCounters after
+ *  @ref E_EEPROM_XMC1_Init.
+ */
+const E_EEPROM_XMC1_WEAR_t *E_EEPROM_XMC1_GetWearCounters(void);
+
+/**
+ * @brief Overwrites the flash wear counters.
+ *
+ * @param counters Pointer to the counter values to continue counting from.
+ *
+ * @return None
+ */
+void E_EEPROM_XMC1_SetWearCounters(const E_EEPROM_XMC1_WEAR_t *const counters);
+
+/**
+ * @brief Returns the number of free flash blocks in the active bank.
+ *
+ * @return uint32_t Flash blocks that can still be written before a garbage collection is needed.
+ *
+ * \par<b>Description:</b><br>
+ *  Together with @ref E_EEPROM_XMC1_GetBlockFootprint the application can see a garbage collection coming and
+ *  request it (@ref E_EEPROM_XMC1_RequestGarbageCollection) at a time of its choice.
+ */
+uint32_t E_EEPROM_XMC1_GetFreeBlocks(void);
+
+/**
+ * @brief Returns the number of flash blocks one write of a user data block occupies.
+ * @param block_number : Block ID Name/Number configured in the block table
+ *
+ * @return uint32_t Flash blocks of the block header and its data.
+ */
+uint32_t E_EEPROM_XMC1_GetBlockFootprint(uint8_t block_number);
+
+/**
+ * @brief Returns the number of previous copies of a user data block in the history.
+ * @param block_number : Block ID Name/Number configured in the block table
+ *
+ * @return uint32_t Previous copies that @ref E_EEPROM_XMC1_GetHistoryPointer can reach (up to
+ *         E_EEPROM_XMC1_HISTORY_DEPTH, 0 after a garbage collection).
+ */
+uint32_t E_EEPROM_XMC1_GetHistoryCount(uint8_t block_number);
+
+/**
+ * @brief Returns the flash address of user data of a previous copy of a user data block.
+ * @param block_number : Block ID Name/Number configured in the block table
+ * @param age : Previous copy, 0 is the one written before the latest
+ * @param offset : Byte position in the user data block
+ * @param data_pptr : Returns the flash address of the byte at offset
+ * @param length_ptr : Returns the number of bytes stored contiguously from there
+ *
+ * @return <BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS, if the data was located<BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED, if a garbage collection is running, offset is outside the block
+ *    or age is not below E_EEPROM_XMC1_HISTORY_DEPTH<BR>
+ *    E_EEPROM_XMC1_OPERATION_STATUS_INVALID_BLOCK, if no copy of that age is indexed<BR>
+ *
+ * \par<b>Description:</b><br>
+ *  Like @ref E_EEPROM_XMC1_GetDataPointer for the latest copy. The history is built by @ref E_EEPROM_XMC1_Init
+ *  with one pass over the active bank and kept up to date by every write, so a copy is found without a scan. Only
+ *  complete copies without ECC errors are indexed, their data CRC (if enabled) is not checked. A garbage collection
+ *  only keeps the latest copies and clears the history.
+ */
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetHistoryPointer(uint8_t block_number,
+                                                                 uint32_t age,
+                                                                 uint32_t offset,
+                                                                 const uint8_t **const data_pptr,
+                                                                 uint32_t *const length_ptr);
+
 /**
  * @brief Invalidate the user defined data block that was written into the flash.
  * @param block_number : Block ID Name/Number configured in the block table
@@ -750,7 +930,7 @@ E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_GetStatus(void);
 bool E_EEPROM_XMC1_IsGarbageCollectionNeeded(uint8_t block_number);
 
 
-#ifdef E_EEPROM_XMC1_CRC_SW_ENABLED
+#if defined(E_EEPROM_XMC1_CRC_SW_ENABLED) || defined(E_EEPROM_XMC1_BLOCK_CRC_ENABLED)
 /**
  * @brief Reads complete data block from flash and verify the data integrity using CRC checksum.
  * @param block_number : Block ID Name/Number configured in the block table. Use the names defined in
@@ -144,6 +144,14 @@ typedef struct GLOBAL_ADC_GROUP
   GLOBAL_ADC_STATUS_t state; 									/**<This enumerates the state of the APP. */
 } GLOBAL_ADC_GROUP_t;
 #endif
+/**
+ * @brief Runtime state of the GLOBAL_ADC APP (RAM, the handle itself is const and placed in flash)
+ */
+typedef struct GLOBAL_ADC_RUNTIME
+{
+  GLOBAL_ADC_STATUS_t init_state; 		 /**< This hold the State of the GLOBAL_ADC APP*/
+} GLOBAL_ADC_RUNTIME_t;
+
 /**
  *  @brief  Configuration Data structure of GLOBAL_ADC APP
  */
@@ -160,7 +168,7 @@ typedef struct GLOBAL_ADC
   XMC_VADC_GLOBAL_SHS_t* const global_shs_ptr; /**< This is the sample and hold structure pointer*/
   XMC_VADC_GLOBAL_SHS_CONFIG_t* const global_shscfg; /**< This is the sample and hold structure pointer*/
 #endif
-  GLOBAL_ADC_STATUS_t init_state; 		 /**< This hold the State of the GLOBAL_ADC APP*/
+  GLOBAL_ADC_RUNTIME_t *const runtime_ptr; /**< Points to the runtime state of the APP */
 
   const bool enable_startup_calibration;       /**< Enable startup calibration for all the converters*/
 } GLOBAL_ADC_t;
@@ -240,7 +248,37 @@ DAVE_APP_VERSION_t GLOBAL_ADC_GetAppVersion(void);
  *  }
  * @endcode 
  */
-GLOBAL_ADC_STATUS_t GLOBAL_ADC_Init(GLOBAL_ADC_t *const handle_ptr);
+GLOBAL_ADC_STATUS_t GLOBAL_ADC_Init(const GLOBAL_ADC_t *const handle_ptr);
+
+#ifdef GLOBAL_ADC_STARTUP_CALIBRATION_DEFERRED
+/**
+ * @brief Waits until the startup calibration started by GLOBAL_ADC_Init() is finished.
+ * @param handle_ptr pointer to the GLOBAL_ADC APP handle
+ * @return void
+ * <BR>
+ *
+  \par<b>Description:</b><br>
+ * With GLOBAL_ADC_STARTUP_CALIBRATION_DEFERRED defined GLOBAL_ADC_Init() only starts the startup calibration and
+ * returns while the converters are still calibrating, other peripherals can be initialized in the meantime. This
+ * function must be called before the first conversion is requested. It returns immediately if the calibration is
+ * disabled or the APP is not initialized.
+ *
+ * Example Usage:
+ * @code
+ *  #include "DAVE.h"
+ *
+ *  int main (void)
+ *  {
+ *    GLOBAL_ADC_Init(&GLOBAL_ADC_0);
+ *    DIGITAL_IO_Init(&DIGITAL_IO_0); // Runs while the converters calibrate
+ *    GLOBAL_ADC_WaitStartupCalibration(&GLOBAL_ADC_0);
+ *    while(1);
+ *    return 0;
+ *  }
+ * @endcode
+ */
+void GLOBAL_ADC_WaitStartupCalibration(const GLOBAL_ADC_t *const handle_ptr);
+#endif
 
 #include "global_adc_extern.h"
 
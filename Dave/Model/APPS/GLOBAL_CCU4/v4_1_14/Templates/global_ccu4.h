@@ -118,6 +118,14 @@ typedef enum GLOBAL_CCU4_STATUS
  * @{
  */
 
+/**
+ * @brief Runtime state of the GLOBAL_CCU4 APP (RAM, the handle itself is const and placed in flash)
+ */
+typedef struct GLOBAL_CCU4_RUNTIME
+{
+  bool  is_initialized; /**< Indicates initialized state of particular instance of the APP */
+} GLOBAL_CCU4_RUNTIME_t;
+
 /**
  * This saves the context of the GLOBAL_CCU4 APP.
  */
@@ -127,7 +135,7 @@ typedef struct GLOBAL_CCU4
   const XMC_SCU_CCU_TRIGGER_t syncstart_trigger_msk; /**< Mask to start the timers synchronously */
   XMC_CCU4_MODULE_t* const module_ptr;   /**< reference to module handle */
   XMC_CCU4_SLICE_MCMS_ACTION_t const mcs_action; /**< Shadow transfer of selected values in multi-channel mode */
-  bool  is_initialized; /**< Indicates initialized state of particular instance of the APP */
+  GLOBAL_CCU4_RUNTIME_t *const runtime_ptr; /**< Points to the runtime state of the APP */
 } GLOBAL_CCU4_t;
 
 /**
@@ -208,7 +216,7 @@ DAVE_APP_VERSION_t GLOBAL_CCU4_GetAppVersion(void);
  * }
  * @endcode<BR>
  */
-GLOBAL_CCU4_STATUS_t GLOBAL_CCU4_Init(GLOBAL_CCU4_t* handle);
+GLOBAL_CCU4_STATUS_t GLOBAL_CCU4_Init(const GLOBAL_CCU4_t *const handle);
 
 /**
  * @brief Start all the timers which are configured to start externally on positive edge.<br>
@@ -244,10 +244,20 @@ typedef struct PWM_CCU4_ConfigType
     const    uint8_t                                gpio_ch_out_pin;           /**<Pin number in the selected PORT*/
     const    XMC_GPIO_CONFIG_t *const               gpio_ch_out_config_ptr;    /**<Points to the variable containing GPIO configuration*/
 
-             GLOBAL_CCU4_t      *const              global_ccu4_handle;        /**<Points to GLOBAL_CCU4 APP handle*/
+    const    GLOBAL_CCU4_t      *const              global_ccu4_handle;        /**<Points to GLOBAL_CCU4 APP handle*/
 
 } PWM_CCU4_CONFIG_t;
 
+/**
+ * @brief Runtime state of the PWM_CCU4 APP (RAM, the handle itself is const and placed in flash)
+ */
+typedef struct PWM_CCU4_RuntimeType
+{
+  PWM_CCU4_STATE_t               state;                       /**<Defines the current state of the PWM_CCU4 APP*/
+  uint32_t                       frequency_tclk;              /**<Defines the operating frequency of the CCU4 slice*/
+  uint32_t                       sym_duty;                    /**<Defines the channel 1 duty cycle in symmetric mode*/
+} PWM_CCU4_RUNTIME_t;
+
 /**
  * @brief Initialization parameters of the PWM_CCU4 APP
  */
@@ -262,9 +272,7 @@ typedef struct PWM_CCU4_HandleType
   const uint32_t                       dither_shadow_txfr_msk;      /**<Mask for enabling shadow transfer of dither registers*/
   const uint32_t                       prescaler_shadow_txfr_msk;   /**<Mask for enabling shadow transfer of floating prescaler registers*/
 
-        PWM_CCU4_STATE_t               state;                       /**<Defines the current state of the PWM_CCU4 APP*/
-        uint32_t                       frequency_tclk;              /**<Defines the operating frequency of the CCU4 slice*/
-        uint32_t                       sym_duty;                    /**<Defines the channel 1 duty cycle in symmetric mode*/
+        PWM_CCU4_RUNTIME_t     *const  runtime_ptr;                 /**<Points to the runtime state of the PWM_CCU4 APP*/
 } PWM_CCU4_t;
 
 /**
@@ -328,7 +336,7 @@ DAVE_APP_VERSION_t PWM_CCU4_GetAppVersion(void);
  * }
  * @endcode
  */
-PWM_CCU4_STATUS_t PWM_CCU4_Init(PWM_CCU4_t* const handle_ptr);
+PWM_CCU4_STATUS_t PWM_CCU4_Init(const PWM_CCU4_t* const handle_ptr);
 
 /**
  * @brief Start the selected CCU4 slice.
@@ -355,7 +363,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Init(PWM_CCU4_t* const handle_ptr);
  * }
  * @endcode
 */
-PWM_CCU4_STATUS_t PWM_CCU4_Start(PWM_CCU4_t* const handle_ptr);
+PWM_CCU4_STATUS_t PWM_CCU4_Start(const PWM_CCU4_t* const handle_ptr);
 
 /**
  * @brief Stop the selected CCU4 slice.
@@ -379,7 +387,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Start(PWM_CCU4_t* const handle_ptr);
  * }
  * @endcode
  */
-PWM_CCU4_STATUS_t PWM_CCU4_Stop(PWM_CCU4_t* const handle_ptr);
+PWM_CCU4_STATUS_t PWM_CCU4_Stop(const PWM_CCU4_t* const handle_ptr);
 
 /**
  * @brief Returns the timer value.
@@ -403,7 +411,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_Stop(PWM_CCU4_t* const handle_ptr);
  * }
  * @endcode
  */
-uint32_t PWM_CCU4_GetTimerValue(PWM_CCU4_t* const handle_ptr);
+uint32_t PWM_CCU4_GetTimerValue(const PWM_CCU4_t* const handle_ptr);
 
 /**
  * @brief Returns the timer status.
@@ -427,7 +435,7 @@ uint32_t PWM_CCU4_GetTimerValue(PWM_CCU4_t* const handle_ptr);
  * }
  * @endcode
  */
-bool PWM_CCU4_GetTimerStatus(PWM_CCU4_t* const handle_ptr);
+bool PWM_CCU4_GetTimerStatus(const PWM_CCU4_t* const handle_ptr);
 
 /**
  * @brief Sets the PWM frequency.
@@ -453,7 +461,7 @@ bool PWM_CCU4_GetTimerStatus(PWM_CCU4_t* const handle_ptr);
  * }
  * @endcode
  */
-PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t* const handle_ptr, uint32_t pwm_freq_hz);
+PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(const PWM_CCU4_t* const handle_ptr, uint32_t pwm_freq_hz);
 
 /**
  * @brief Sets the duty cycle of PWM.
@@ -481,7 +489,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t* const handle_ptr, uint32_t pwm_fr
  * }
  * @endcode
  */
-PWM_CCU4_STATUS_t PWM_CCU4_SetDutyCycle(PWM_CCU4_t* const handle_ptr, uint32_t duty_cycle);
+PWM_CCU4_STATUS_t PWM_CCU4_SetDutyCycle(const PWM_CCU4_t* const handle_ptr, uint32_t duty_cycle);
 
 /**
  * @brief Sets the frequency duty cycle of PWM.
@@ -510,7 +518,75 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetDutyCycle(PWM_CCU4_t* const handle_ptr, uint32_t d
  * }
  * @endcode
  */
-PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(PWM_CCU4_t* const handle_ptr, uint32_t pwm_freq_hz, uint32_t duty);
+PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(const PWM_CCU4_t* const handle_ptr, uint32_t pwm_freq_hz, uint32_t duty);
+
+/**
+ * @brief Sets a precomputed compare value of PWM (fast path).
+ * @param handle_ptr Pointer to PWM_CCU4_t structure containing APP parameters.
+ * @param compare channel compare value in timer counts (0 to period register value + 1)
+ * @return None
+ *
+ * \par<b>Description: </b><br>
+ * Writes the compare shadow register and requests the shadow transfer of the slice, the value takes effect with the next
+ * period match. The compare value for a duty is (period register value + 1) * (10000 - duty) / 10000, as used by
+ * PWM_CCU4_SetDutyCycle().<br> No state or range check is done and "sym_duty" is not updated. Both writes are single
+ * register writes, so the function can be used from interrupt context (e.g. to update the duty every period).
+ *
+ * Example Usage:
+ * @code
+ * #include "DAVE.h"
+ * 
+ * int main(void)
+ * {
+ *   DAVE_Init();
+ *   // Compare value for 50% duty precomputed for a period register value of 63999
+ *   PWM_CCU4_SetCompareRaw(&PWM_CCU4_0, 32000U);
+ *   while(1);
+ *   return 0;
+ * }
+ * @endcode
+ */
+__STATIC_INLINE void PWM_CCU4_SetCompareRaw(const PWM_CCU4_t* const handle_ptr, uint16_t compare)
+{
+  XMC_ASSERT("PWM_CCU4_SetCompareRaw:handle_ptr NULL", (handle_ptr != NULL));
+  handle_ptr->ccu4_slice_ptr->CRS = compare;
+  handle_ptr->ccu4_module_ptr->GCSS = handle_ptr->shadow_txfr_msk;
+}
+
+/**
+ * @brief Sets a precomputed compare value and dither compare value of PWM (fast path).
+ * @param handle_ptr Pointer to PWM_CCU4_t structure containing APP parameters.
+ * @param compare channel compare value in timer counts (0 to period register value + 1)
+ * @param dither dither compare value (0 to 15)
+ * @return None
+ *
+ * \par<b>Description: </b><br>
+ * Like PWM_CCU4_SetCompareRaw(), additionally writes the dither compare shadow register and requests its transfer.
+ * With duty cycle dithering enabled (PWM_CCU4_SetDither()), the compare value is extended by one count in \a dither
+ * of 16 periods, so \a compare + \a dither / 16 is the effective compare value.
+ *
+ * Example Usage:
+ * @code
+ * #include "DAVE.h"
+ * 
+ * int main(void)
+ * {
+ *   DAVE_Init();
+ *   PWM_CCU4_SetDither(&PWM_CCU4_0, false, true, 0U);
+ *   // Effective compare value 100.25 counts
+ *   PWM_CCU4_SetCompareDitherRaw(&PWM_CCU4_0, 100U, 4U);
+ *   while(1);
+ *   return 0;
+ * }
+ * @endcode
+ */
+__STATIC_INLINE void PWM_CCU4_SetCompareDitherRaw(const PWM_CCU4_t* const handle_ptr, uint16_t compare, uint8_t dither)
+{
+  XMC_ASSERT("PWM_CCU4_SetCompareDitherRaw:handle_ptr NULL", (handle_ptr != NULL));
+  handle_ptr->ccu4_slice_ptr->CRS = compare;
+  handle_ptr->ccu4_slice_ptr->DITS = dither;
+  handle_ptr->ccu4_module_ptr->GCSS = handle_ptr->shadow_txfr_msk | handle_ptr->dither_shadow_txfr_msk;
+}
 
 /**
  * @brief Sets the dither value for period , duty or both.
@@ -539,7 +615,7 @@ PWM_CCU4_STATUS_t PWM_CCU4_SetFreqAndDutyCycle(PWM_CCU4_t* const handle_ptr, uin
  * }
  * @endcode
  */
-void PWM_CCU4_SetDither(PWM_CCU4_t* const handle_ptr, bool dither_period, bool dither_comp, uint8_t dither_value);
+void PWM_CCU4_SetDither(const PWM_CCU4_t* const handle_ptr, bool dither_period, bool dither_comp, uint8_t dither_value);
 
 /**
  * @brief Clears the trap event.
@@ -562,7 +638,7 @@ void PWM_CCU4_SetDither(PWM_CCU4_t* const handle_ptr, bool dither_period, bool d
  * }
  * @endcode
  */
-void PWM_CCU4_ClearTrap(PWM_CCU4_t* const handle_ptr);
+void PWM_CCU4_ClearTrap(const PWM_CCU4_t* const handle_ptr);
 
 /**
  * @brief Returns the interrupt status.
@@ -590,7 +666,7 @@ void PWM_CCU4_ClearTrap(PWM_CCU4_t* const handle_ptr);
  * }
  * @endcode
  */
-bool PWM_CCU4_GetInterruptStatus(PWM_CCU4_t* const handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt);
+bool PWM_CCU4_GetInterruptStatus(const PWM_CCU4_t* const handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt);
 
 /**
  * @brief Acknowledges the interrupt.
@@ -615,7 +691,7 @@ bool PWM_CCU4_GetInterruptStatus(PWM_CCU4_t* const handle_ptr, XMC_CCU4_SLICE_IR
  * }
  * @endcode
  */
-void PWM_CCU4_ClearEvent(PWM_CCU4_t* const handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt);
+void PWM_CCU4_ClearEvent(const PWM_CCU4_t* const handle_ptr, XMC_CCU4_SLICE_IRQ_ID_t pwm_interrupt);
 
 #include "pwm_ccu4_extern.h"
 
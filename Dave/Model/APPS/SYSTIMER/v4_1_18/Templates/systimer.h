@@ -69,6 +69,13 @@
  * 2021-01-08:
  *     - Modified check for minimum XMCLib version
  *
+ * 2026-10-14:
+ *     - Added SYSTIMER_GetTime64() and SYSTIMER_GetTimeUs() (microsecond resolution from SysTick->VAL)
+ *     - Added SYSTIMER_GetCycles() and the tickless mode (SYSTIMER_TICKLESS_ENABLED)
+ *     - Added deferred callbacks SYSTIMER_SetDeferred(), SYSTIMER_SetDeferredNotify() and SYSTIMER_DispatchDeferred()
+ *     - Added the time warp of soak test builds (SYSTIMER_TIME_WARP_ENABLED, SYSTIMER_Warp())
+ *     - SYSTIMER_GetTime64() and SYSTIMER_GetTimeUs() read the CCU4 time base of the application once it runs (TIMEBASE_ENABLED)
+ *
  * @endcond
  *
  */
@@ -96,6 +103,13 @@
 #error "SYSTIMER requires XMC Peripheral Library v2.0.0 or higher"
 #endif
 
+/* SysTick microseconds per real microsecond (1 without time warp), converts waits on real time timers */
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+#define SYSTIMER_WARP_RATE SYSTIMER_TIME_WARP_FACTOR
+#else
+#define SYSTIMER_WARP_RATE (1U)
+#endif
+
 /**********************************************************************************************************************
  * ENUMS
  **********************************************************************************************************************/
@@ -150,13 +164,21 @@ typedef enum SYSTIMER_MODE
  */
 typedef void (*SYSTIMER_CALLBACK_t)(void *args);
 
+/**
+ * @brief Runtime state of the SYSTIMER APP (RAM, the handle itself is const and placed in flash)
+ */
+typedef struct SYSTIMER_RUNTIME
+{
+  bool init_status; /**< APP initialization status to ensure whether SYSTIMER_Init called or not */
+} SYSTIMER_RUNTIME_t;
+
 /**
  * @brief This structure contains pointer which is used to hold CPU instance handle and
  * variables for priority group
  */
 typedef struct SYSTIMER
 {
-  bool init_status; /**< APP initialization status to ensure whether SYSTIMER_Init called or not */
+  SYSTIMER_RUNTIME_t *const runtime_ptr; /**< Points to the runtime state of the APP */
 } SYSTIMER_t;
 /**
  * @}
@@ -241,7 +263,7 @@ DAVE_APP_VERSION_t SYSTIMER_GetAppVersion(void);
  *  }
  *  @endcode
  */
- SYSTIMER_STATUS_t SYSTIMER_Init(SYSTIMER_t *handle);
+ SYSTIMER_STATUS_t SYSTIMER_Init(const SYSTIMER_t *const handle);
 
 /**
  * @brief Starts the SysTick timer.
@@ -269,7 +291,8 @@ void SYSTIMER_Stop(void);
  * @param args  Call back function parameter.
  *
  * @return uint32_t returns timer ID if timer created successfully otherwise returns 0 if timer creation failed.
- *                  Range: 0 to 16, 0: Invalid timer ID, 1-16: Valid timer ID.
+ *                  0: Invalid timer ID (no free timer in the pool of SYSTIMER_CFG_POOL_SIZE timers). A valid ID holds
+ *                  the pool index and a generation, the ID of a deleted timer is rejected by all other APIs.
  *
  * \par<b>Description: </b><br>
  * API for creating a new software timer instance. This also add created software timer to timer list.<br>
@@ -344,7 +367,8 @@ uint32_t SYSTIMER_CreateTimer
  * @param args  Call back function parameter.
  *
  * @return uint32_t returns timer ID if timer created successfully otherwise returns 0 if timer creation failed.
- *                  Range: 0 to 16, 0: Invalid timer ID, 1-16: Valid timer ID.
+ *                  0: Invalid timer ID (no free timer in the pool of SYSTIMER_CFG_POOL_SIZE timers). A valid ID holds
+ *                  the pool index and a generation, the ID of a deleted timer is rejected by all other APIs.
  *
  */
 uint32_t SYSTIMER_CreateTimerFromISR
@@ -357,7 +381,7 @@ uint32_t SYSTIMER_CreateTimerFromISR
 
 /**
  * @brief Starts the software timer. This function cannot be called from an ISR. Use SYSTIMER_StartTimerFromISR() instead. 
- * @param id  timer ID obtained from SYSTIMER_CreateTimer. Range : 1 to 16
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
  * \par<b>Description: </b><br>
@@ -413,7 +437,7 @@ SYSTIMER_STATUS_t SYSTIMER_StartTimer(uint32_t id);
 
 /**
  * @brief A version of SYSTIMER_StartTimer() that can be called from an ISR.
- * @param id  timer ID obtained from SYSTIMER_CreateTimer. Range : 1 to 16
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
  */
@@ -421,7 +445,7 @@ SYSTIMER_STATUS_t SYSTIMER_StartTimerFromISR(uint32_t id);
 
 /**
  * @brief Stops the software timer. This function cannot be called from an ISR. Use SYSTIMER_StopTimerFromISR() instead. 
- * @param id  timer ID obtained from SYSTIMER_CreateTimer. Range : 1 to 16
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
  * \par<b>Description: </b><br>
@@ -491,7 +515,7 @@ SYSTIMER_STATUS_t SYSTIMER_StopTimer(uint32_t id);
 
 /**
  * @brief A version of SYSTIMER_StopTimer() that can be called from an ISR.
- * @param id  timer ID obtained from SYSTIMER_CreateTimer. Range : 1 to 16
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
  */
@@ -499,7 +523,7 @@ SYSTIMER_STATUS_t SYSTIMER_StopTimerFromISR(uint32_t id);
 
 /**
  * @brief Function to modify the time interval and restart the timer for the new time interval. This function cannot be called from an ISR. Use SYSTIMER_RestartTimerFromISR() instead. <br>
- * @param id ID of already created system timer. Range : 1 to 16
+ * @param id ID of already created system timer
  * @param microsec new time interval. Range: (SYSTIMER_TICK_PERIOD_US) to pow(2,32).
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
@@ -583,7 +607,7 @@ SYSTIMER_STATUS_t SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec);
 
 /**
  * @brief A version of SYSTIMER_RestartTimer() that can be called from an ISR.
- * @param id ID of already created system timer. Range : 1 to 16
+ * @param id ID of already created system timer
  * @param microsec new time interval. Range: (SYSTIMER_TICK_PERIOD_US) to pow(2,32).
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
@@ -592,7 +616,7 @@ SYSTIMER_STATUS_t SYSTIMER_RestartTimerFromISR(uint32_t id, uint32_t microsec);
 
 /**
  * @brief Deletes the software timer from the timer list. This function cannot be called from an ISR. Use SYSTIMER_DeleteTimerFromISR() instead.
- * @param id  timer ID obtained from SYSTIMER_CreateTimer. Range : 1 to 16
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
  * \par<b>Description: </b><br>
@@ -674,7 +698,7 @@ SYSTIMER_STATUS_t SYSTIMER_DeleteTimer(uint32_t id);
 
 /**
  * @brief A version of SYSTIMER_DeleteTimer() that can be called from an ISR.
- * @param id  timer ID obtained from SYSTIMER_CreateTimer. Range : 1 to 16
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
  * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
  *
  */
@@ -801,9 +825,65 @@ uint32_t SYSTIMER_GetTime(void);
  */
 uint32_t SYSTIMER_GetTickCount(void);
 
+/**
+ * @brief Gives the SysTick clock cycles since start of hardware SysTick timer as 32 bit value.
+ * @return  uint32_t  returns current time in SysTick clock cycles. Range: 0 to pow(2,32) (wraps after 2^32 cycles).
+ *
+ * \par<b>Description: </b><br>
+ * API to measure short durations in clock cycles. The SysTick count and the elapsed part of the current SysTick period
+ * are read with interrupts masked, the result is also correct with the variable periods of the tickless mode.
+ */
+uint32_t SYSTIMER_GetCycles(void);
+
+/**
+ * @brief Gives the current time in microsecond since start of hardware SysTick timer as 64 bit value.
+ * @return  uint64_t  returns current time in microsecond. Range: 0 to pow(2,64) (does not wrap during product life).
+ *
+ * \par<b>Description: </b><br>
+ * API to get a monotonic time with true microsecond resolution. The SysTick count is combined with the elapsed part of
+ * the current SysTick period (SysTick->VAL down-counter). The count and the counter are read with interrupts masked,
+ * a SysTick wrap that is pending but not yet handled (e.g. when called from an ISR of same or higher priority) is
+ * taken into account. Therefore the API can be used from thread and ISR context.
+ * With TIMEBASE_ENABLED (timebase.h) the time is read from the concatenated CCU4 slices once timebase_init started
+ * them at the SysTick time.
+ *
+ * \par<b>Example Usage:</b><br>
+ *
+ * @code
+ *  #include "DAVE.h"
+ *
+ *  int main(void)
+ *  {
+ *    uint64_t start;
+ *    uint64_t duration_us;
+ *    DAVE_Init(); // SYSTIMER APP Initialized during DAVE Initialization
+ *    start = SYSTIMER_GetTime64();
+ *    // Add user code here
+ *    duration_us = SYSTIMER_GetTime64() - start;
+ *    while (1)
+ *    {
+ *
+ *    }
+ *    return (1);
+ *  }
+ * @endcode<BR> </p>
+ */
+uint64_t SYSTIMER_GetTime64(void);
+
+/**
+ * @brief Gives the current time in microsecond since start of hardware SysTick timer as 32 bit value.
+ * @return  uint32_t  returns current time in microsecond. Range: 0 to pow(2,32) (wraps after ~71 minutes).
+ *
+ * \par<b>Description: </b><br>
+ * Lower 32 bit of SYSTIMER_GetTime64(). Differences of two values are correct across the wrap as long as the measured
+ * duration is shorter than ~71 minutes (use unsigned subtraction). With TIMEBASE_ENABLED it is one read of the CCU4
+ * time base without masking interrupts.
+ */
+uint32_t SYSTIMER_GetTimeUs(void);
+
 /**
  * @brief Gives the current state of software timer.
- * @param id  timer ID obtained from SYSTIMER_CreateTimer. Range : 1 to 16
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
  * @return SYSTIMER_STATE_t Software timer state. Refer @ref SYSTIMER_STATE_t for details.
  *
  * \par<b>Description: </b><br>
@@ -883,6 +963,101 @@ uint32_t SYSTIMER_GetTickCount(void);
  */
 SYSTIMER_STATE_t SYSTIMER_GetTimerState(uint32_t id);
 
+#ifdef SYSTIMER_DEFERRED_ENABLED
+/**
+ * @brief Selects whether the callback of a software timer is run in SysTick context or deferred.
+ * @param id  timer ID obtained from SYSTIMER_CreateTimer
+ * @param deferred  true: expirations are posted to the deferred queue and the callback is run by
+ *                  SYSTIMER_DispatchDeferred(), false: the callback is run in SysTick context (default).
+ * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
+ *
+ * \par<b>Description: </b><br>
+ * A deferred callback does not extend the SysTick exception, it may take longer and call APIs that must not be used
+ * from an ISR. Expirations of a timer which are not dispatched yet are merged into one callback.
+ */
+SYSTIMER_STATUS_t SYSTIMER_SetDeferred(uint32_t id, bool deferred);
+
+/**
+ * @brief Registers the function called whenever an expiration was posted to the deferred queue.
+ * @param notify  Function called in SysTick context (e.g. to wake up the main loop), NULL for none.
+ * @param args  Parameter of notify.
+ */
+void SYSTIMER_SetDeferredNotify(SYSTIMER_CALLBACK_t notify, void *args);
+
+/**
+ * @brief Runs the callbacks of all expirations posted to the deferred queue.
+ * @return uint32_t Number of callbacks run.
+ *
+ * \par<b>Description: </b><br>
+ * Must always be called from the same context (e.g. the main loop), the queue has a single reader. Expirations
+ * posted while the callbacks run are dispatched in the same call.
+ */
+uint32_t SYSTIMER_DispatchDeferred(void);
+#endif
+
+#ifdef SYSTIMER_ISR_HOOK_ENABLED
+/**
+ * @brief Called at the end of every SysTick exception with its timing.
+ * @param latency  Cycles of SYSTIMER_SYSTICK_CLOCK from the SysTick wrap to the handler entry.
+ * @param cycles  Cycles of SYSTIMER_SYSTICK_CLOCK the handler took (without this call).
+ *
+ * \par<b>Description: </b><br>
+ * The APP provides an empty weak implementation, define this function in the application to collect ISR
+ * statistics. It is called in SysTick context and must return quickly.
+ */
+void SYSTIMER_IsrHook(uint32_t latency, uint32_t cycles);
+#endif
+
+#ifdef SYSTIMER_CLOCK_SCALING_ENABLED
+/**
+ * @brief Adapts SysTick to a changed CPU clock.
+ * @param shift  The CPU clock is now SYSTIMER_SYSTICK_CLOCK >> shift (0 = configured clock).
+ * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
+ *
+ * \par<b>Description: </b><br>
+ * Call right after the MCLK change with interrupts disabled. The running SysTick period is continued at the new clock,
+ * so the tick count, the time APIs and SYSTIMER_GetCycles() (which keeps counting cycles of SYSTIMER_SYSTICK_CLOCK)
+ * stay continuous. Fails if a tick is no whole number of SysTick counts at the new clock.
+ */
+SYSTIMER_STATUS_t SYSTIMER_SetClockShift(uint32_t shift);
+#endif
+
+#ifdef SYSTIMER_TICKLESS_ENABLED
+/**
+ * @brief Returns the cycles of SYSTIMER_SYSTICK_CLOCK until the running SysTick period ends.
+ * @return uint32_t Cycles until the next SysTick exception (0 = it is already pending).
+ *
+ * \par<b>Description: </b><br>
+ * In tickless mode the period ends at the next timer deadline (or after the longest period), so this is the time the
+ * CPU may sleep without a SysTick wake-up. Call with interrupts disabled.
+ */
+uint32_t SYSTIMER_GetIdleCycles(void);
+
+/**
+ * @brief Returns the cycles of SYSTIMER_SYSTICK_CLOCK since the pending SysTick exception got pending.
+ * @return uint32_t Cycles since the SysTick wrap (0 = no SysTick exception pending).
+ *
+ * \par<b>Description: </b><br>
+ * Call with interrupts disabled right after a wake-up (e.g. WFI with PRIMASK set) to measure the wake-up latency from
+ * the timer deadline. Only valid while the wrap is less than one period ago.
+ */
+uint32_t SYSTIMER_GetPendingAge(void);
+#endif
+
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+/**
+ * @brief Jumps the SysTick time forward.
+ * @param microsec  Time to add, rounded down to whole ticks.
+ * @return SYSTIMER_STATUS_t APP status. Refer @ref SYSTIMER_STATUS_t for details.
+ *
+ * \par<b>Description: </b><br>
+ * The jump is queued: the SysTick handler advances the time by up to SYSTIMER_TIME_WARP_STEP extra ticks per tick,
+ * so every timer due on the way expires in order and the tick count never moves backwards. A jump requested while one
+ * is running adds to it. Fails if the queued ticks would overflow. Soak test builds only.
+ */
+SYSTIMER_STATUS_t SYSTIMER_Warp(uint32_t microsec);
+#endif
+
 /**
  *@}
  */
@@ -0,0 +1,106 @@
+/*
+ * USB-Changer acmp.c
+ *
+ * Analog comparator fast path (see acmp.h). Both ETLs detect the rising edge of their comparator output (input
+ * exceeded the upper reference, fell below the lower one), set their status flag and trigger OGU1. The interrupt
+ * reads and clears the flags, so edges of both comparators in one interrupt are handled alike.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "acmp.h"
+#include "relay.h"
+#include "ramcode.h"
+
+#if ACMP_ENABLED
+	#if !defined(COMPARATOR)
+		#error "ACMP_ENABLED needs a part with analog comparators (XMC1200/1300/1400)"
+	#endif
+	#include "xmc_acmp.h"
+	#include "xmc_eru.h"
+
+	#define ACMP_UPPER				 0U							// ACMP0 / ERU0 ETL0: input above the upper reference
+	#define ACMP_LOWER				 1U							// ACMP1 / ERU0 ETL1: input below the lower reference (inverted output)
+	#define ACMP_ERU_OGU			 1U							// OGU raising ERU0_1_IRQn (OGU0 belongs to the buttons)
+#endif
+
+acmp_event_t acmp_callback = NULL;
+uint16_t acmp_count = 0;			// Crossings that started a latch time ahead of the ADC
+
+
+#if ACMP_ENABLED
+//****************************************************************************
+// ERU0_1_IRQHandler - ERU interrupt (IRQ_Hdlr_4): a comparator output rose
+//****************************************************************************
+RAMCODE
+void ERU0_1_IRQHandler(void){
+	uint32_t timestamp = SYSTIMER_GetTime();
+	relay_channel_t *channel = &relay_channels[ACMP_CHANNEL];
+	bool started = false;
+	if(XMC_ERU_ETL_GetStatusFlag(XMC_ERU0, ACMP_UPPER)){
+		XMC_ERU_ETL_ClearStatusFlag(XMC_ERU0, ACMP_UPPER);
+		started = relay_mark_exceeded(channel, true, timestamp);
+	}
+	if(XMC_ERU_ETL_GetStatusFlag(XMC_ERU0, ACMP_LOWER)){
+		XMC_ERU_ETL_ClearStatusFlag(XMC_ERU0, ACMP_LOWER);
+		started = relay_mark_exceeded(channel, false, timestamp) || started;
+	}
+	if(started){
+		acmp_count++;
+		if(acmp_callback != NULL)
+			acmp_callback();
+	}
+}
+#endif
+
+//****************************************************************************
+// acmp_init - starts both comparators and their ERU events. callback is called (ISR context) after a crossing got marked
+//****************************************************************************
+bool acmp_init(acmp_event_t callback){
+#if ACMP_ENABLED
+	acmp_callback = callback;
+
+	XMC_ACMP_CONFIG_t acmp_config = {
+		.filter_disable = 0U,
+		.output_invert = (uint32_t)XMC_ACMP_COMP_OUT_NO_INVERSION,
+		.hysteresis = (uint32_t)ACMP_HYSTERESIS
+	};
+	XMC_ACMP_Init(XMC_ACMP0, ACMP_UPPER, &acmp_config);
+	acmp_config.output_invert = (uint32_t)XMC_ACMP_COMP_OUT_INVERSION;
+	XMC_ACMP_Init(XMC_ACMP0, ACMP_LOWER, &acmp_config);
+	XMC_ACMP_EnableComparator(XMC_ACMP0, ACMP_UPPER);
+	XMC_ACMP_EnableComparator(XMC_ACMP0, ACMP_LOWER);
+
+	// ACMP0 -> ETL0, ACMP1 -> ETL1 (input B), both trigger OGU1 -> ERU0_1_IRQn
+	XMC_ERU_ETL_CONFIG_t etl_config = {
+		.input_b = ERU0_ETL0_INPUTB_ACMP0_OUT,
+		.enable_output_trigger = 1U,
+		.status_flag_mode = XMC_ERU_ETL_STATUS_FLAG_MODE_SWCTRL,
+		.edge_detection = XMC_ERU_ETL_EDGE_DETECTION_RISING,
+		.output_trigger_channel = XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL1,
+		.source = XMC_ERU_ETL_SOURCE_B
+	};
+	XMC_ERU_ETL_Init(XMC_ERU0, ACMP_UPPER, &etl_config);
+	etl_config.input_b = ERU0_ETL1_INPUTB_ACMP1_OUT;
+	XMC_ERU_ETL_Init(XMC_ERU0, ACMP_LOWER, &etl_config);
+	XMC_ERU_OGU_CONFIG_t ogu_config = {
+		.service_request = XMC_ERU_OGU_SERVICE_REQUEST_ON_TRIGGER
+	};
+	XMC_ERU_OGU_Init(XMC_ERU0, ACMP_ERU_OGU, &ogu_config);
+	NVIC_SetPriority(ERU0_1_IRQn, ACMP_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(ERU0_1_IRQn);
+	NVIC_EnableIRQ(ERU0_1_IRQn);
+	return true;
+#else
+	(void)callback;
+	return false;
+#endif
+}
+
+//****************************************************************************
+// acmp_get_count - returns the number of crossings the comparators reported first
+//****************************************************************************
+uint16_t acmp_get_count(void){
+	return acmp_count;
+}
@@ -0,0 +1,34 @@
+/*
+ * USB-Changer acmp.h
+ *
+ * Analog comparator fast path of the threshold detection (XMC1200/1300/1400, the XMC1100 has no ACMP). The sensor
+ * input of ACMP_CHANNEL also feeds ACMP0 (upper threshold) and ACMP1 (lower threshold, inverted output), their
+ * inverting inputs get reference voltages of the board at the two thresholds. A crossing raises an ERU event
+ * (ERU0 ETL0/ETL1 -> OGU1 -> ERU0_1_IRQn) within the comparator delay instead of the next conversion and the ADC
+ * interrupt: the interrupt starts the latch time of the crossing (relay_mark_exceeded) and the callback posts the
+ * boundary event. The ADC keeps converting for display, teach-in and confirmation, every result that is not beyond
+ * the threshold ends the latch time again (relay_check_thresholds), so a reference that does not match the setup
+ * thresholds only moves the start of the latch time by up to one sample. The comparators and the ERU keep running in
+ * sleep and wake the core with the event (deep sleep additionally needs XMC_ACMP_SetLowPowerMode).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef ACMP_H
+#define ACMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define ACMP_ENABLED				 0							// Determines if the comparator fast path is used (needs an ACMP part and reference inputs)
+#define ACMP_CHANNEL				 0							// Sensor channel whose input is connected to ACMP0 and ACMP1 INP
+#define ACMP_HYSTERESIS				 XMC_ACMP_HYSTERESIS_20		// Hysteresis of both comparators (noise on the sensor input)
+#define ACMP_IRQ_PRIORITY			 IRQPRIO_ACMP				// Priority of the ERU0 SR1 interrupt (equal to the ADC interrupt, both change the latch timestamps)
+
+typedef void (*acmp_event_t)(void);
+
+bool acmp_init(acmp_event_t callback);
+uint16_t acmp_get_count(void);
+
+#endif /* ACMP_H */
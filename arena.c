@@ -0,0 +1,51 @@
+/*
+ * USB-Changer arena.c
+ *
+ * Arena usage report (see arena.h). The partition limits are symbols of linker_script.ld.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "arena.h"
+#include "log.h"
+
+extern uint8_t __arena_start[], __arena_end[];
+extern uint8_t __arena_sensor_start[], __arena_sensor_end[], __arena_sensor_limit[];
+extern uint8_t __arena_capture_start[], __arena_capture_end[], __arena_capture_limit[];
+extern uint8_t __arena_log_start[], __arena_log_end[], __arena_log_limit[];
+extern uint8_t __arena_telemetry_start[], __arena_telemetry_end[], __arena_telemetry_limit[];
+extern uint8_t __arena_hostcmd_start[], __arena_hostcmd_end[], __arena_hostcmd_limit[];
+
+typedef struct {
+	const uint8_t *start;
+	const uint8_t *end;				// End of the placed buffers
+	const uint8_t *limit;			// End of the slot
+} arena_partition_t;
+
+const arena_partition_t arena_partitions_table[ARENA_COUNT] = {
+	[ARENA_SENSOR] = {__arena_sensor_start, __arena_sensor_end, __arena_sensor_limit},
+	[ARENA_CAPTURE] = {__arena_capture_start, __arena_capture_end, __arena_capture_limit},
+	[ARENA_LOG] = {__arena_log_start, __arena_log_end, __arena_log_limit},
+	[ARENA_TELEMETRY] = {__arena_telemetry_start, __arena_telemetry_end, __arena_telemetry_limit},
+	[ARENA_HOSTCMD] = {__arena_hostcmd_start, __arena_hostcmd_end, __arena_hostcmd_limit}
+};
+
+arena_usage_t arena_usage[ARENA_COUNT];
+
+
+//****************************************************************************
+// arena_report - records the used and reserved bytes of every partition in arena_usage
+//****************************************************************************
+void arena_report(void){
+	if(!ARENA_REPORT_ENABLED)
+		return;
+
+	uint32_t used = 0;
+	for(uint8_t i = 0; i < ARENA_COUNT; i++){
+		const arena_partition_t *partition = &arena_partitions_table[i];
+		arena_usage[i].used = (uint16_t)(partition->end - partition->start);
+		arena_usage[i].size = (uint16_t)(partition->limit - partition->start);
+		used += arena_usage[i].used;
+	}
+	LOG_INFO("Arena %u of %u bytes used", used, (uint32_t)(__arena_end - __arena_start));
+}
@@ -0,0 +1,45 @@
+/*
+ * USB-Changer arena.h
+ *
+ * Static buffer arena. The large buffers of the subsystems (rings and capture windows) are not allocated at run time:
+ * ARENA(partition) places a buffer in the input section .arena.<partition>, and linker_script.ld collects every
+ * partition into its own fixed slot of the output section .arena (neither loaded nor cleared at startup, like
+ * .noinit). The slot size is the arena_<partition>_size symbol of the linker script, so the SRAM split is fixed at
+ * build time and the link fails if a partition outgrows its slot, a buffer names an unknown partition or the arena
+ * does not fit the SRAM left by the stack, the variables and the .no_init records. There is no allocator and no heap
+ * behind it: taking a buffer costs nothing at run time and nothing can fragment. arena_report records the used and the
+ * reserved bytes of every partition at boot (arena_usage, meant to be read by a debugger or telemetry).
+ * A new partition needs its id below, its slot in the linker script and its symbols in arena.c.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+
+#define ARENA_REPORT_ENABLED		 0							// Determines if arena_report fills arena_usage at boot (debugger diagnostics, its flash is saved without)
+
+// Buffer in a partition of the arena (content undefined after a reset, the owner initialises its indices)
+#define ARENA(partition)			 __attribute__((section(".arena." #partition)))
+
+typedef enum {
+	ARENA_SENSOR,					// Sample ring (sensor_buffer)
+	ARENA_CAPTURE,					// Raw sample capture window (capture_buffer)
+	ARENA_LOG,						// Log entry ring (log_ring)
+	ARENA_TELEMETRY,				// UART transmit and receive rings (telemetry_tx, telemetry_rx)
+	ARENA_HOSTCMD,					// Host command frame (hostcmd_frame)
+	ARENA_COUNT
+} arena_partitions;
+
+typedef struct {
+	uint16_t used;					// In bytes. Buffers placed in the partition
+	uint16_t size;					// In bytes. Reserved slot (arena_<partition>_size)
+} arena_usage_t;
+
+extern arena_usage_t arena_usage[ARENA_COUNT];
+
+void arena_report(void);
+
+#endif /* ARENA_H */
@@ -0,0 +1,84 @@
+/*
+ * USB-Changer bands.c
+ *
+ * Multi-level threshold engine (see bands.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "bands.h"
+
+
+//****************************************************************************
+// bands_build_lut - fills a lookup table with the band at the start of every table step
+//****************************************************************************
+void bands_build_lut(uint8_t *lut, const uint16_t *thresholds, uint8_t count){
+	uint8_t band = 0;
+	for(uint16_t i = 0; i < BANDS_LUT_SIZE; i++){
+		uint16_t step_start = i * BANDS_LUT_STEP;
+		while(band < count && thresholds[band] <= step_start)
+			band++;
+		lut[i] = band;
+	}
+}
+
+//****************************************************************************
+// bands_build - checks the setpoints and precomputes the thresholds and tables (returns false if they are invalid)
+//****************************************************************************
+bool bands_build(bands_t *bands){
+	if(bands->count > BANDS_MAX_SETPOINTS)
+		return false;
+
+	for(uint8_t i = 0; i < bands->count; i++){
+		const bands_setpoint_t *setpoint = &bands->setpoints[i];
+		if(setpoint->setpoint >= (1U << BANDS_ADC_BITS) || setpoint->hysteresis > setpoint->setpoint)
+			return false;
+		bands->rising[i] = setpoint->setpoint;
+		bands->falling[i] = setpoint->setpoint - setpoint->hysteresis;
+
+		// Thresholds closer than one table step would need more than one compare per lookup
+		if(i > 0 && (bands->rising[i] < bands->rising[i - 1] + BANDS_LUT_STEP || bands->falling[i] < bands->falling[i - 1] + BANDS_LUT_STEP))
+			return false;
+	}
+
+	bands_build_lut(bands->lut_rising, bands->rising, bands->count);
+	bands_build_lut(bands->lut_falling, bands->falling, bands->count);
+	bands->band = 0;
+	return true;
+}
+
+//****************************************************************************
+// bands_classify - returns the number of thresholds the value reaches (= band) in constant time
+//****************************************************************************
+uint8_t bands_classify(const uint8_t *lut, const uint16_t *thresholds, uint8_t count, uint16_t value){
+	// At most one threshold lies inside a table step
+	uint8_t band = lut[value >> (BANDS_ADC_BITS - BANDS_LUT_BITS)];
+	if(band < count && value >= thresholds[band])
+		band++;
+	return band;
+}
+
+//****************************************************************************
+// bands_update - classifies a value with hysteresis. Returns true if the band changed
+//****************************************************************************
+bool bands_update(bands_t *bands, uint16_t value){
+	if(value >= (1U << BANDS_ADC_BITS))
+		value = (1U << BANDS_ADC_BITS) - 1U;
+
+	// Upwards the setpoints count, downwards the setpoints minus their hysteresis
+	uint8_t band = bands_classify(bands->lut_rising, bands->rising, bands->count, value);
+	if(band <= bands->band){
+		band = bands_classify(bands->lut_falling, bands->falling, bands->count, value);
+		if(band >= bands->band)
+			return false;
+	}
+	bands->band = band;
+	return true;
+}
+
+//****************************************************************************
+// bands_get_output - returns the output state of the current band
+//****************************************************************************
+uint8_t bands_get_output(const bands_t *bands){
+	return bands->outputs[bands->band];
+}
@@ -0,0 +1,47 @@
+/*
+ * USB-Changer bands.h
+ *
+ * Multi-level threshold engine. N ascending setpoints split the 12 bit ADC range into N+1 bands, every setpoint has
+ * its own hysteresis (the band below is entered when the value falls below setpoint - hysteresis) and every band is
+ * mapped to an output state (e.g. off/low/high for three-stage control with two setpoints).
+ * Classification is constant time for any number of bands: bands_build precomputes a table indexed by the top
+ * BANDS_LUT_BITS of the value for the rising and for the falling thresholds. Thresholds must be at least one table
+ * step (ADC range / 2^BANDS_LUT_BITS) apart, so a table entry needs at most one additional compare.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef BANDS_H
+#define BANDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BANDS_MAX_SETPOINTS			 7							// Maximum number of setpoints (bands = setpoints + 1)
+#define BANDS_ADC_BITS				 12							// Resolution of the classified values
+#define BANDS_LUT_BITS				 6							// Top bits of the value indexing the lookup tables (table step = 64 counts)
+#define BANDS_LUT_SIZE				 (1U << BANDS_LUT_BITS)
+#define BANDS_LUT_STEP				 (1U << (BANDS_ADC_BITS - BANDS_LUT_BITS))	// Minimum distance of two rising (or two falling) thresholds
+
+typedef struct {
+	uint16_t setpoint;				// Band above is entered when the value reaches the setpoint
+	uint16_t hysteresis;			// Band below is entered when the value falls below setpoint - hysteresis
+} bands_setpoint_t;
+
+typedef struct {
+	uint8_t count;										// Number of setpoints
+	bands_setpoint_t setpoints[BANDS_MAX_SETPOINTS];	// Ascending
+	uint8_t outputs[BANDS_MAX_SETPOINTS + 1];			// Output state of each band (band 0 = below the first setpoint)
+	uint16_t rising[BANDS_MAX_SETPOINTS];				// Rising thresholds (= setpoints, built by bands_build)
+	uint16_t falling[BANDS_MAX_SETPOINTS];				// Falling thresholds (built by bands_build)
+	uint8_t lut_rising[BANDS_LUT_SIZE];					// Band at the start of each table step (rising thresholds)
+	uint8_t lut_falling[BANDS_LUT_SIZE];				// Band at the start of each table step (falling thresholds)
+	uint8_t band;										// Current band
+} bands_t;
+
+bool bands_build(bands_t *bands);
+uint8_t bands_classify(const uint8_t *lut, const uint16_t *thresholds, uint8_t count, uint16_t value);
+bool bands_update(bands_t *bands, uint16_t value);
+uint8_t bands_get_output(const bands_t *bands);
+
+#endif /* BANDS_H */
@@ -0,0 +1,128 @@
+/*
+ * USB-Changer bistable.c
+ *
+ * Latching relay drive (see bistable.h). Target and pulse state are changed with all interrupts masked, bistable_set
+ * comes from any context and the pulse end from the hrtimer interrupt.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "bistable.h"
+#include "relay.h"
+#include "hrtimer.h"
+#include "storage.h"
+#include "coil.h"
+#include "pins.h"
+#include "critical.h"
+#include "ramcode.h"
+
+#if BISTABLE_ENABLED && COIL_ENABLED
+#error "BISTABLE_ENABLED and COIL_ENABLED both drive IO_RELAY"
+#endif
+
+typedef char bistable_config_check[(sizeof(bistable_record_t) == BISTABLE_STORAGE_SIZE && BISTABLE_PULSE_TIME >= 1
+		&& BISTABLE_PULSE_TIME <= BISTABLE_PULSE_MAX && BISTABLE_PULSE_MAX * 1000U <= HRTIMER_MAX_US) ? 1 : -1];
+
+uint8_t bistable_pulse_time = BISTABLE_PULSE_TIME;
+volatile uint8_t bistable_position = BISTABLE_UNKNOWN;
+uint32_t bistable_pulses = 0;
+volatile uint8_t bistable_target = BISTABLE_UNKNOWN;	// relay_states the contacts are driven to
+volatile uint8_t bistable_pulsing = BISTABLE_UNKNOWN;	// relay_states of the running pulse (BISTABLE_UNKNOWN = both coils off)
+uint8_t bistable_posted = BISTABLE_UNKNOWN;			// Position of the last posted record
+uint32_t bistable_timer = 0;						// hrtimer of the pulse end (0 = not created)
+
+
+//****************************************************************************
+// bistable_start - starts the pulse towards the target unless one is running or the contacts are there (interrupts masked)
+//****************************************************************************
+RAMCODE
+void bistable_start(void){
+	uint8_t target = bistable_target;
+	if(bistable_timer == 0 || bistable_pulsing != BISTABLE_UNKNOWN || target == BISTABLE_UNKNOWN || target == bistable_position)
+		return;
+	if(!hrtimer_request(bistable_timer, (uint32_t)bistable_pulse_time * 1000U))
+		return;
+	bistable_pulsing = target;
+	bistable_pulses++;
+	if(target == RELAY_HIGH)
+		PINS_SET_HIGH(IO_RELAY);
+	else
+		PINS_SET_HIGH(BISTABLE_RESET);
+}
+
+//****************************************************************************
+// bistable_callback - pulse end (hrtimer interrupt): coils off, the contacts are in position, a newer target pulses next
+//****************************************************************************
+RAMCODE
+void bistable_callback(void *args){
+	(void)args;
+	critical_state_t primask = critical_enter();
+	PINS_SET_LOW(IO_RELAY);
+	PINS_SET_LOW(BISTABLE_RESET);
+	bistable_position = bistable_pulsing;
+	bistable_pulsing = BISTABLE_UNKNOWN;
+	bistable_start();
+	critical_exit(primask, CRITICAL_SITE_BISTABLE);
+}
+
+//****************************************************************************
+// bistable_init - sets up the reset coil driver and the pulse timer (call after hrtimer_init, before relay_init)
+//****************************************************************************
+bool bistable_init(void){
+#if BISTABLE_ENABLED
+	const XMC_GPIO_CONFIG_t reset_config = {.mode = XMC_GPIO_MODE_OUTPUT_PUSH_PULL, .output_level = XMC_GPIO_OUTPUT_LEVEL_LOW};
+	XMC_GPIO_Init(BISTABLE_RESET_PORT, BISTABLE_RESET_PIN, &reset_config);
+	PINS_SET_LOW(IO_RELAY);
+	bistable_timer = hrtimer_create(bistable_callback, NULL);
+	return bistable_timer != 0;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// bistable_stored - reads the position stored in the EEPROM (false = never written or invalid)
+//****************************************************************************
+bool bistable_stored(uint8_t *position){
+	bistable_record_t record;
+	if(E_EEPROM_XMC1_Read(EEPROM_RELAY_POSITION, 0U, (uint8_t *)&record, BISTABLE_STORAGE_SIZE) != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS
+			|| record.position_check != (uint16_t)~record.position || (record.position != RELAY_HIGH && record.position != RELAY_LOW))
+		return false;
+	*position = (uint8_t)record.position;
+	bistable_posted = *position;
+	return true;
+}
+
+//****************************************************************************
+// bistable_configure - sets the pulse width (ms) of the next pulses. Returns false if out of range
+//****************************************************************************
+bool bistable_configure(uint8_t pulse_time){
+	if(pulse_time == 0 || pulse_time > BISTABLE_PULSE_MAX)
+		return false;
+	bistable_pulse_time = pulse_time;
+	return true;
+}
+
+//****************************************************************************
+// bistable_set - drives the contacts to on (set coil) or off (reset coil), any context
+//****************************************************************************
+RAMCODE
+void bistable_set(bool on){
+	critical_state_t primask = critical_enter();
+	bistable_target = on ? RELAY_HIGH : RELAY_LOW;
+	bistable_start();
+	critical_exit(primask, CRITICAL_SITE_BISTABLE);
+}
+
+//****************************************************************************
+// bistable_save - posts the position of the contacts when it changed (main context, a full queue is retried next time)
+//****************************************************************************
+void bistable_save(void){
+	uint8_t position = bistable_position;
+	if(!BISTABLE_ENABLED || position == BISTABLE_UNKNOWN || position == bistable_posted)
+		return;
+	bistable_record_t record = {.position = position, .position_check = (uint16_t)~position};
+	if(storage_post(EEPROM_RELAY_POSITION, (const uint8_t *)&record, BISTABLE_STORAGE_SIZE))
+		bistable_posted = position;
+}
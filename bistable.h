@@ -0,0 +1,50 @@
+/*
+ * USB-Changer bistable.h
+ *
+ * Bistable (latching) relay on IO_RELAY. A latching relay keeps its contacts without coil current, so the output is
+ * two coil drivers: IO_RELAY pulses the set coil (contacts closed, RELAY_HIGH) and BISTABLE_RESET_PIN the reset coil
+ * (RELAY_LOW), each for bistable_pulse_time. The pulse end is timed by an hrtimer (CCU40 slice 2), started with
+ * hrtimer_request, so relay_drive may come from the main loop, a latch timer or the ADC interrupt (fault safe state).
+ * A switch during a pulse is taken over when the pulse ends (never both coils at once), a switch to the position the
+ * contacts already have needs no pulse. The position of the last completed pulse goes to the warm reset record with
+ * the relay state and to the EEPROM block EEPROM_RELAY_POSITION (posted by retain_state when it changed, so one
+ * record per switch in the deferred write queue). After a reset the position is not trusted (a reset may have cut a
+ * pulse short): relay_init gives one pulse to its state, which does not move contacts that are already there. A warm
+ * reset pulses to the retained state (SystemCoreSetup leaves IO_RELAY low), a cold start to off or with BISTABLE_RESUME
+ * to the stored position, so the load stays as the relay kept it through a power loss. The board needs a second
+ * driver on BISTABLE_RESET_PIN (P0.12, not bonded on the TSSOP16 of this board) and COIL_ENABLED 0.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef BISTABLE_H
+#define BISTABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BISTABLE_ENABLED			 0							// Determines if IO_RELAY drives a latching relay (needs the reset coil driver and COIL_ENABLED 0)
+#define BISTABLE_RESET_PORT			 XMC_GPIO_PORT0				// Reset coil driver P0.12 (VQFN24 and TSSOP38)
+#define BISTABLE_RESET_PIN			 12U
+#define BISTABLE_PULSE_TIME			 20							// In ms. Default bistable_pulse_time (see the set and reset time in the data sheet of the relay)
+#define BISTABLE_PULSE_MAX			 65							// In ms. Longest pulse (HRTIMER_MAX_US)
+#define BISTABLE_RESUME				 0							// 1 = a cold start pulses to the stored position, 0 = to off like a monostable relay
+#define BISTABLE_UNKNOWN			 0xFFU						// bistable_position before the first pulse after a reset
+#define BISTABLE_STORAGE_SIZE		 4							// In bytes. Size of bistable_record_t = size of EEPROM_RELAY_POSITION
+
+typedef struct {
+	uint16_t position;				// relay_states of the contacts
+	uint16_t position_check;		// ~position (an erased or torn block never has a valid check)
+} bistable_record_t;
+
+extern uint8_t bistable_pulse_time;				// In ms. Width of the next pulses (bistable_configure)
+extern volatile uint8_t bistable_position;		// relay_states of the contacts after the last completed pulse (BISTABLE_UNKNOWN = none yet)
+extern uint32_t bistable_pulses;				// Coil pulses since reset
+
+bool bistable_init(void);
+bool bistable_stored(uint8_t *position);
+bool bistable_configure(uint8_t pulse_time);
+void bistable_set(bool on);
+void bistable_save(void);
+
+#endif /* BISTABLE_H */
@@ -0,0 +1,180 @@
+/*
+ * USB-Changer boot.c
+ *
+ * Startup sequence and boot time profiler (see boot.h). Until SYSTIMER_Init takes SysTick over it runs free with the
+ * full 24 bit reload and without interrupt, wraps are counted by polling COUNTFLAG in every stamp (so two stamps must
+ * be less than 2^24 cycles = 524ms apart). The SYSTIMER stage continues on SYSTIMER_GetCycles from the last raw count.
+ * DAVE_Init below runs the same APP init functions as the generated one in DAVE.c (an APP added in DAVE must be added
+ * here as well), but overlaps the VADC startup calibration with the other APPs: GLOBAL_ADC_Init only starts it
+ * (GLOBAL_ADC_STARTUP_CALIBRATION_DEFERRED), the pins, SYSTIMER, PWM and the E_EEPROM mount are initialized while the
+ * converters calibrate and ADC_MEASUREMENT_Init waits for its end. The relay pin does not wait for DAVE_Init at all,
+ * it is driven off in SystemCoreSetup right after reset (after a warm reset to its retained state, see retain.h).
+ * The retained USB port is powered right after the pins are initialized.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "boot.h"
+#include "relay.h"
+#include "usbswitch.h"
+#include "retain.h"
+#include "bistable.h"
+
+typedef char boot_record_size_check[(sizeof(boot_record_t) == BOOT_RECORD_SIZE) ? 1 : -1];
+
+boot_record_t boot_record __attribute__((section(".no_init")));
+boot_record_t boot_previous;
+uint32_t boot_wraps = 0;			// SysTick wraps before SYSTIMER_Init
+uint32_t boot_systimer_base = 0;	// In cycles. Boot time SYSTIMER_GetCycles started at (0 = SysTick still runs free)
+
+// DIGITAL_IO APP instances in the order of DAVE.c (IO_RELAY is initialized in SystemCoreSetup)
+const DIGITAL_IO_t *const boot_pins[] = {
+	&IO_USB_SI, &IO_USB_OE, &IO_LED_R_STATUS, &IO_SW_USB, &IO_SW_UP, &IO_SW_DOWN, &IO_USBPWR_2, &IO_USBPWR_1,
+	&IO_LED_USB2, &IO_LED_USB1
+};
+
+
+#if BOOT_PROFILER_ENABLED
+//****************************************************************************
+// boot_now - returns the cycles since boot_start
+//****************************************************************************
+uint32_t boot_now(void){
+	if(boot_systimer_base != 0)
+		return boot_systimer_base + SYSTIMER_GetCycles();
+
+	// COUNTFLAG is cleared by reading CTRL, a wrap right after reading VAL is caught by reading it again
+	uint32_t value = SysTick->VAL;
+	if(SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk){
+		boot_wraps++;
+		value = SysTick->VAL;
+	}
+	return (boot_wraps * (SysTick_LOAD_RELOAD_Msk + 1U)) + (SysTick_LOAD_RELOAD_Msk - value);
+}
+
+//****************************************************************************
+// boot_start - keeps the record of the last boot and starts SysTick as free running cycle counter
+//****************************************************************************
+void boot_start(void){
+	boot_previous = boot_record;
+	if(boot_previous.magic != BOOT_RECORD_MAGIC)
+		boot_previous.magic = 0;
+
+	boot_record.magic = BOOT_RECORD_MAGIC;
+	boot_record.flags = 0;
+	for(uint8_t i = 0; i < BOOT_STAGE_COUNT; i++)
+		boot_record.stamps[i] = 0;
+
+	SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+#endif
+
+//****************************************************************************
+// boot_stamp - records the end of a boot stage (see BOOT_STAMP)
+//****************************************************************************
+void boot_stamp(boot_stages stage){
+#if BOOT_PROFILER_ENABLED
+	uint32_t now = boot_now();
+	boot_record.stamps[stage] = now;
+	if(stage == BOOT_STAGE_FIRST_RELAY && now > BOOT_BUDGET_US * (SYSTIMER_SYSTICK_CLOCK / 1000000U))
+		boot_record.flags |= BOOT_FLAG_OVER_BUDGET;
+#else
+	(void)stage;
+#endif
+}
+
+//****************************************************************************
+// boot_cycles_to_us - converts a stamp to microseconds
+//****************************************************************************
+uint32_t boot_cycles_to_us(uint32_t cycles){
+	return cycles / (SYSTIMER_SYSTICK_CLOCK / 1000000U);
+}
+
+//****************************************************************************
+// SystemCoreSetup - flash wait states and relay off (or retained) right after reset (replaces the weak implementations in system_XMC1100.c and CPU_CTRL_XMC1)
+//****************************************************************************
+void SystemCoreSetup(void){
+#ifndef USE_DYNAMIC_FLASH_WS
+	// Fix flash wait states to 1 cycle (see DS Addendum)
+	NVM->NVMCONF |= NVM_NVMCONF_WS_Msk;
+	NVM->CONFIG1 |= NVM_CONFIG1_FIXWS_Msk;
+#endif
+	// Runs before .data and .bss are set up, DIGITAL_IO_Init only reads the const pin configuration
+	(void)DIGITAL_IO_Init(&IO_RELAY);
+	// Warm reset: the relay stays on (relay_init takes it over through the coil economiser, a latching relay holds itself)
+	if(!BISTABLE_ENABLED && retain_valid() && retain_record.channels[RETAIN_RELAY_CHANNEL].state == RELAY_HIGH)
+		DIGITAL_IO_SetOutputHigh(&IO_RELAY);
+}
+
+//****************************************************************************
+// boot_init_systimer - SYSTIMER_Init with the stamp time base handed over from the free running SysTick
+//****************************************************************************
+DAVE_STATUS_t boot_init_systimer(void){
+#if BOOT_PROFILER_ENABLED
+	uint32_t base = boot_now();
+	DAVE_STATUS_t status = (DAVE_STATUS_t)SYSTIMER_Init(&SYSTIMER_0);
+	if(status == DAVE_STATUS_SUCCESS)
+		boot_systimer_base = base;
+	return status;
+#else
+	return (DAVE_STATUS_t)SYSTIMER_Init(&SYSTIMER_0);
+#endif
+}
+
+//****************************************************************************
+// DAVE_Init - initializes the DAVE APPs and stamps every stage (replaces the weak implementation in DAVE.c)
+//****************************************************************************
+DAVE_STATUS_t DAVE_Init(void){
+	DAVE_STATUS_t status;
+#if BOOT_PROFILER_ENABLED
+	boot_start();
+#endif
+
+	status = (DAVE_STATUS_t)CLOCK_XMC1_Init(&CLOCK_XMC1_0);
+	BOOT_STAMP(BOOT_STAGE_CLOCK);
+
+	// Starts the VADC startup calibration, the stages up to EEPROM run while it is going
+	if(status == DAVE_STATUS_SUCCESS)
+		status = (DAVE_STATUS_t)GLOBAL_ADC_Init(ADC_SENSOR.global_handle);
+
+	if(status == DAVE_STATUS_SUCCESS){
+		for(uint8_t i = 0; i < sizeof(boot_pins) / sizeof(boot_pins[0]) && status == DAVE_STATUS_SUCCESS; i++)
+			status = (DAVE_STATUS_t)DIGITAL_IO_Init(boot_pins[i]);
+		// Warm reset: the retained USB port is powered again at once (main switches to it once more)
+		if(status == DAVE_STATUS_SUCCESS && retain_valid()){
+			usb_switch_init();
+			switchUSB((USB_states)retain_record.usb_state);
+		}
+		BOOT_STAMP(BOOT_STAGE_DIGITAL_IO);
+	}
+
+	if(status == DAVE_STATUS_SUCCESS){
+		status = boot_init_systimer();
+		BOOT_STAMP(BOOT_STAGE_SYSTIMER);
+	}
+
+	if(status == DAVE_STATUS_SUCCESS){
+		status = (DAVE_STATUS_t)PWM_CCU4_Init(&PWM_CCU4_LED_STATUS);
+		BOOT_STAMP(BOOT_STAGE_PWM);
+	}
+
+	if(status == DAVE_STATUS_SUCCESS){
+		status = (DAVE_STATUS_t)E_EEPROM_XMC1_Init(&E_EEPROM_XMC1_0);
+		BOOT_STAMP(BOOT_STAGE_EEPROM);
+	}
+
+	// GLOBAL_ADC_Init is already done, ADC_MEASUREMENT_Init only sets up the conversions and starts the first one
+	if(status == DAVE_STATUS_SUCCESS){
+		GLOBAL_ADC_WaitStartupCalibration(ADC_SENSOR.global_handle);
+		status = (DAVE_STATUS_t)ADC_MEASUREMENT_Init(&ADC_SENSOR);
+		BOOT_STAMP(BOOT_STAGE_ADC);
+	}
+
+#if BOOT_PROFILER_ENABLED
+	if(status != DAVE_STATUS_SUCCESS)
+		boot_record.flags |= BOOT_FLAG_INIT_FAILED;
+#endif
+	return status;
+}
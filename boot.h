@@ -0,0 +1,60 @@
+/*
+ * USB-Changer boot.h
+ *
+ * Startup sequence and boot time profiler. boot.c implements DAVE_Init (the generated one in DAVE.c is weak) and
+ * stamps the end of every init stage and of the application startup phases in CPU cycles since DAVE_Init was entered.
+ * The record lives in no-init RAM: it survives resets without power loss, so after a watchdog reset during startup
+ * boot_previous shows how far the last boot got. Read boot_record / boot_previous with a debugger or telemetry.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOT_PROFILER_ENABLED		 0							// Determines if boot stages are time stamped (0 removes all BOOT_STAMP* calls)
+#define BOOT_BUDGET_US				 50000U						// In us. Budget from DAVE_Init to the first relay evaluation (sets BOOT_FLAG_OVER_BUDGET)
+#define BOOT_RECORD_MAGIC			 0xB0075EC0U				// Marks a record written by this firmware
+#define BOOT_RECORD_SIZE			 48							// sizeof(boot_record_t), reserved in .no_init by the linker script
+
+typedef enum {
+	BOOT_STAGE_CLOCK,		// CLOCK_XMC1_Init
+	BOOT_STAGE_DIGITAL_IO,	// GLOBAL_ADC_Init (starts the VADC startup calibration) and DIGITAL_IO_Init of all pins
+	BOOT_STAGE_SYSTIMER,	// SYSTIMER_Init (SysTick runs from here on)
+	BOOT_STAGE_PWM,			// PWM_CCU4_Init (status LED)
+	BOOT_STAGE_EEPROM,		// E_EEPROM_XMC1_Init (fast mount or bank scan)
+	BOOT_STAGE_ADC,			// End of the VADC startup calibration and ADC_MEASUREMENT_Init
+	BOOT_STAGE_SETUP_READ,	// read_eeprom_setup
+	BOOT_STAGE_USB_SWITCH,	// First switchUSB
+	BOOT_STAGE_FIRST_ADC,	// First ADC result interrupt
+	BOOT_STAGE_FIRST_RELAY,	// First relay evaluation (manage_relay)
+	BOOT_STAGE_COUNT
+} boot_stages;
+
+#define BOOT_FLAG_OVER_BUDGET		 (1U << 0)					// The first relay evaluation came later than BOOT_BUDGET_US
+#define BOOT_FLAG_INIT_FAILED		 (1U << 1)					// A DAVE APP init function failed
+
+typedef struct {
+	uint32_t magic;							// BOOT_RECORD_MAGIC (anything else: no record, e.g. after power on)
+	uint32_t flags;							// BOOT_FLAG_*
+	uint32_t stamps[BOOT_STAGE_COUNT];		// In cycles since DAVE_Init was entered. End of each stage (0 = not reached)
+} boot_record_t;
+
+extern boot_record_t boot_record;			// Record of the running boot
+extern boot_record_t boot_previous;		// Record of the boot before the last reset (magic 0 = none)
+
+void boot_stamp(boot_stages stage);
+uint32_t boot_cycles_to_us(uint32_t cycles);
+
+#if BOOT_PROFILER_ENABLED
+	#define BOOT_STAMP(stage)			boot_stamp(stage)
+	#define BOOT_STAMP_ONCE(stage)		do{ if(boot_record.stamps[(stage)] == 0) boot_stamp(stage); }while(0)
+#else
+	#define BOOT_STAMP(stage)
+	#define BOOT_STAMP_ONCE(stage)
+#endif
+
+#endif /* BOOT_H */
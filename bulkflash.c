@@ -0,0 +1,295 @@
+/*
+ * USB-Changer bulkflash.c
+ *
+ * Append only flash region (see bulkflash.h). All functions run in main context, flash is only erased and programmed
+ * by bulkflash_flush, which the main loop calls when it is idle (like statelog_flush and storage_flush). The data pages
+ * are not trusted to be erased: every page is erased right before it is programmed.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <string.h>
+#include "DAVE.h"
+#include "bulkflash.h"
+#include "factory.h"
+#include "trace.h"
+#include "metrics.h"
+
+typedef char bulkflash_record_check[(BULKFLASH_RECORD_MAX < BULKFLASH_RECORD_SKIP) ? 1 : -1];
+typedef char bulkflash_entry_size_check[(sizeof(bulkflash_entry_t) == BULKFLASH_BLOCK_SIZE) ? 1 : -1];
+typedef char bulkflash_layout_check[(BULKFLASH_BASE + BULKFLASH_PAGES * BULKFLASH_PAGE_SIZE == FACTORY_BASE
+		&& BULKFLASH_PAGES >= 2 && BULKFLASH_PAGES - 1 <= BULKFLASH_ENTRIES) ? 1 : -1];
+
+typedef enum {
+	BULKFLASH_IDLE,
+	BULKFLASH_ERASE_DIRECTORY,	// Empty the region (bulkflash_erase or a directory without a valid entry)
+	BULKFLASH_ERASE_PAGE,		// Next step erases the data page of the sealed buffer
+	BULKFLASH_PROGRAM_PAGE,		// Next step programs it
+	BULKFLASH_COMMIT			// Next step writes the directory entry of the new length
+} bulkflash_states;
+
+uint32_t bulkflash_buffer[BULKFLASH_PAGE_SIZE / 4U];	// Page collected by bulkflash_append (words, the page program reads words)
+uint16_t bulkflash_fill = 0;		// In bytes. Records in bulkflash_buffer
+bool bulkflash_sealed = false;		// bulkflash_buffer is complete and waits to be programmed (no appends until committed)
+bulkflash_states bulkflash_state = BULKFLASH_IDLE;
+uint8_t bulkflash_attempts = 0;		// Failed tries of the current step
+uint32_t bulkflash_length = 0;		// In bytes. Committed data
+uint32_t bulkflash_pages = 0;		// Committed data pages
+uint8_t bulkflash_next = 0;			// Directory entry written by the next commit (BULKFLASH_ENTRIES = directory full)
+bool bulkflash_directory_erased = false;	// The directory holds valid entries or was erased (else it is erased before the first commit)
+uint16_t bulkflash_pages_written = 0;
+uint16_t bulkflash_failures = 0;
+METRICS_REGISTER(bulkflash_pages, METRICS_ID_BULKFLASH_PAGES, METRICS_TYPE_U16, METRICS_UNIT_COUNT, bulkflash_pages_written);
+METRICS_REGISTER(bulkflash_failures, METRICS_ID_BULKFLASH_FAILURES, METRICS_TYPE_U16, METRICS_UNIT_COUNT, bulkflash_failures);
+
+
+//****************************************************************************
+// bulkflash_entry - returns the flash address of a directory entry
+//****************************************************************************
+const bulkflash_entry_t *bulkflash_entry(uint8_t index){
+	return (const bulkflash_entry_t *)(BULKFLASH_BASE + (index * BULKFLASH_BLOCK_SIZE));
+}
+
+//****************************************************************************
+// bulkflash_page - returns the flash address of a data page
+//****************************************************************************
+uint32_t *bulkflash_page(uint32_t page){
+	return (uint32_t *)(BULKFLASH_DATA_BASE + (page * BULKFLASH_PAGE_SIZE));
+}
+
+//****************************************************************************
+// bulkflash_valid - returns true if a directory entry is completely written and describes a possible length
+//****************************************************************************
+bool bulkflash_valid(const bulkflash_entry_t *entry){
+	return entry->length_check == ~entry->length && entry->pages_check == ~entry->pages
+			&& entry->pages <= BULKFLASH_PAGES - 1U && entry->length <= entry->pages * BULKFLASH_PAGE_SIZE;
+}
+
+//****************************************************************************
+// bulkflash_init - takes the committed length from the newest directory entry (an empty directory is erased before the first page)
+//****************************************************************************
+void bulkflash_init(void){
+	bool found = false;
+
+	if(!BULKFLASH_ENABLED)
+		return;
+	bulkflash_length = 0;
+	bulkflash_pages = 0;
+	bulkflash_next = 0;
+	// Entries are written in order with a growing length, the last valid one is the newest
+	for(uint8_t index = 0; index < BULKFLASH_ENTRIES; index++){
+		const bulkflash_entry_t *entry = bulkflash_entry(index);
+		if(!bulkflash_valid(entry) || entry->pages < bulkflash_pages)
+			continue;
+		found = true;
+		bulkflash_length = entry->length;
+		bulkflash_pages = entry->pages;
+		bulkflash_next = index + 1U;
+	}
+	// Without an entry the directory page may hold anything (e.g. code of an older firmware), it is not erased on every boot
+	bulkflash_directory_erased = found;
+	bulkflash_state = BULKFLASH_IDLE;
+}
+
+//****************************************************************************
+// bulkflash_seal - marks the buffer complete (padded with 0xFF, read as BULKFLASH_RECORD_SKIP) and schedules its page
+//****************************************************************************
+void bulkflash_seal(void){
+	memset((uint8_t *)bulkflash_buffer + bulkflash_fill, 0xFF, BULKFLASH_PAGE_SIZE - bulkflash_fill);
+	bulkflash_sealed = true;
+	if(bulkflash_state == BULKFLASH_IDLE)
+		bulkflash_state = bulkflash_directory_erased ? BULKFLASH_ERASE_PAGE : BULKFLASH_ERASE_DIRECTORY;
+}
+
+//****************************************************************************
+// bulkflash_append - adds a record (1 to BULKFLASH_RECORD_MAX bytes) behind the committed data. Returns false if it was not taken (retry after the next flush, or the region is full)
+//****************************************************************************
+bool bulkflash_append(const uint8_t *data, uint16_t size){
+	// Buffer waits for its page or the region is full
+	if(!BULKFLASH_ENABLED || bulkflash_sealed || bulkflash_pages >= BULKFLASH_PAGES - 1U || size == 0 || size > BULKFLASH_RECORD_MAX)
+		return false;
+	if(bulkflash_fill + BULKFLASH_RECORD_HEADER + size > BULKFLASH_PAGE_SIZE){
+		// The record starts the next page
+		bulkflash_seal();
+		return false;
+	}
+	uint8_t *record = (uint8_t *)bulkflash_buffer + bulkflash_fill;
+	record[0] = (uint8_t)size;
+	record[1] = (uint8_t)(size >> 8);
+	memcpy(&record[BULKFLASH_RECORD_HEADER], data, size);
+	bulkflash_fill += BULKFLASH_RECORD_HEADER + size;
+	// No room left for another record
+	if(bulkflash_fill > BULKFLASH_PAGE_SIZE - (BULKFLASH_RECORD_HEADER + 1U))
+		bulkflash_seal();
+	return true;
+}
+
+//****************************************************************************
+// bulkflash_sync - schedules a partly filled buffer (the rest of its page stays unused, the next record starts a new page)
+//****************************************************************************
+void bulkflash_sync(void){
+	if(!bulkflash_sealed && bulkflash_fill != 0)
+		bulkflash_seal();
+}
+
+//****************************************************************************
+// bulkflash_erase - discards all data including the buffer (the directory is erased by the next flush, the data pages before they are programmed again)
+//****************************************************************************
+void bulkflash_erase(void){
+	bulkflash_fill = 0;
+	bulkflash_sealed = false;
+	bulkflash_length = 0;
+	bulkflash_pages = 0;
+	bulkflash_attempts = 0;
+	bulkflash_directory_erased = false;
+	bulkflash_state = BULKFLASH_ERASE_DIRECTORY;
+}
+
+//****************************************************************************
+// bulkflash_pending - returns true if a flash operation is waiting (sealed buffer or directory erase)
+//****************************************************************************
+bool bulkflash_pending(void){
+	return BULKFLASH_ENABLED && bulkflash_state != BULKFLASH_IDLE;
+}
+
+//****************************************************************************
+// bulkflash_drop - ends the current page after BULKFLASH_WRITE_ATTEMPTS failed tries (its data is lost)
+//****************************************************************************
+void bulkflash_drop(void){
+	TRACE(TRACE_BULKFLASH_WRITE, bulkflash_pages, 0xFFFFU);
+	bulkflash_fill = 0;
+	bulkflash_sealed = false;
+	bulkflash_attempts = 0;
+	bulkflash_state = BULKFLASH_IDLE;
+}
+
+//****************************************************************************
+// bulkflash_flush - executes one step of the pending page (main context, call when idle). Returns true if flash was erased or programmed
+//****************************************************************************
+bool bulkflash_flush(void){
+	if(!BULKFLASH_ENABLED || bulkflash_state == BULKFLASH_IDLE)
+		return false;
+
+	XMC_FLASH_ClearStatus();
+	switch(bulkflash_state){
+		case BULKFLASH_ERASE_DIRECTORY:
+			if(XMC_FLASH_ErasePage((uint32_t *)BULKFLASH_BASE) != NVM_PASS){
+				bulkflash_failures++;
+				// The next sealed page starts with the erase again
+				if(++bulkflash_attempts >= BULKFLASH_WRITE_ATTEMPTS)
+					bulkflash_drop();
+				break;
+			}
+			bulkflash_next = 0;
+			bulkflash_attempts = 0;
+			bulkflash_directory_erased = true;
+			bulkflash_state = bulkflash_sealed ? BULKFLASH_ERASE_PAGE : BULKFLASH_IDLE;
+			break;
+
+		case BULKFLASH_ERASE_PAGE:
+			if(bulkflash_next >= BULKFLASH_ENTRIES){
+				// Directory full (failed entries used up its slots)
+				bulkflash_failures++;
+				bulkflash_drop();
+				break;
+			}
+			XMC_FLASH_ErasePage(bulkflash_page(bulkflash_pages));
+			bulkflash_state = BULKFLASH_PROGRAM_PAGE;
+			break;
+
+		case BULKFLASH_PROGRAM_PAGE:
+			if(XMC_FLASH_ProgramVerifyPage(bulkflash_page(bulkflash_pages), bulkflash_buffer) == NVM_PASS
+					&& memcmp(bulkflash_page(bulkflash_pages), bulkflash_buffer, BULKFLASH_PAGE_SIZE) == 0){
+				bulkflash_attempts = 0;
+				bulkflash_state = BULKFLASH_COMMIT;
+				break;
+			}
+			bulkflash_failures++;
+			if(++bulkflash_attempts >= BULKFLASH_WRITE_ATTEMPTS)
+				bulkflash_drop();
+			else
+				bulkflash_state = BULKFLASH_ERASE_PAGE;
+			break;
+
+		case BULKFLASH_COMMIT:{
+			bulkflash_entry_t entry;
+			entry.length = bulkflash_pages * BULKFLASH_PAGE_SIZE + bulkflash_fill;
+			entry.pages = bulkflash_pages + 1U;
+			entry.length_check = ~entry.length;
+			entry.pages_check = ~entry.pages;
+
+			const bulkflash_entry_t *target = bulkflash_entry(bulkflash_next);
+			XMC_FLASH_WriteBlocks((uint32_t *)target, (const uint32_t *)&entry, 1U, true);
+			bulkflash_next++;
+			if(XMC_FLASH_GetStatus() == 0U && bulkflash_valid(target) && target->length == entry.length){
+				bulkflash_length = entry.length;
+				bulkflash_pages = entry.pages;
+				bulkflash_pages_written++;
+				TRACE(TRACE_BULKFLASH_WRITE, entry.pages - 1U, entry.length);
+				bulkflash_fill = 0;
+				bulkflash_sealed = false;
+				bulkflash_attempts = 0;
+				bulkflash_state = BULKFLASH_IDLE;
+				break;
+			}
+			// Entry was not erased (e.g. interrupted write before a reset) - the next one is tried
+			bulkflash_failures++;
+			if(++bulkflash_attempts >= BULKFLASH_WRITE_ATTEMPTS || bulkflash_next >= BULKFLASH_ENTRIES)
+				bulkflash_drop();
+			break;
+		}
+
+		default:
+			bulkflash_state = BULKFLASH_IDLE;
+			break;
+	}
+	return true;
+}
+
+//****************************************************************************
+// bulkflash_data - returns the committed stream (read in place, bulkflash_size bytes, records through bulkflash_record)
+//****************************************************************************
+const uint8_t *bulkflash_data(void){
+	return (const uint8_t *)BULKFLASH_DATA_BASE;
+}
+
+//****************************************************************************
+// bulkflash_record - returns the committed record at *offset (0 = first) or NULL after the last one, *offset moves behind it
+//****************************************************************************
+const uint8_t *bulkflash_record(uint32_t *offset, uint16_t *size){
+	const uint8_t *data = bulkflash_data();
+	uint32_t position = *offset;
+	while(position + BULKFLASH_RECORD_HEADER < bulkflash_length){
+		uint32_t rest = BULKFLASH_PAGE_SIZE - (position % BULKFLASH_PAGE_SIZE);
+		uint16_t length = BULKFLASH_RECORD_SKIP;
+		if(rest > BULKFLASH_RECORD_HEADER)
+			length = (uint16_t)(data[position] | ((uint16_t)data[position + 1U] << 8));
+		if(rest <= BULKFLASH_RECORD_HEADER || length == 0 || length > rest - BULKFLASH_RECORD_HEADER || position + BULKFLASH_RECORD_HEADER + length > bulkflash_length){
+			// Unused rest of the page (skip marker, padding of a synced page): the next record starts the next page
+			position += rest;
+			continue;
+		}
+		*offset = position + BULKFLASH_RECORD_HEADER + length;
+		*size = length;
+		return &data[position + BULKFLASH_RECORD_HEADER];
+	}
+	*offset = position;
+	return NULL;
+}
+
+//****************************************************************************
+// bulkflash_size - returns the number of committed bytes (data appended since the last commit is not included)
+//****************************************************************************
+uint32_t bulkflash_size(void){
+	return bulkflash_length;
+}
+
+//****************************************************************************
+// bulkflash_free - returns the number of bytes that can still be appended (a record takes BULKFLASH_RECORD_HEADER more and does not cross a page)
+//****************************************************************************
+uint32_t bulkflash_free(void){
+	if(bulkflash_pages >= BULKFLASH_PAGES - 1U)
+		return 0;
+	// A sealed buffer takes its whole page
+	return BULKFLASH_DATA_SIZE - bulkflash_pages * BULKFLASH_PAGE_SIZE - (bulkflash_sealed ? BULKFLASH_PAGE_SIZE : bulkflash_fill);
+}
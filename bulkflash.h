@@ -0,0 +1,61 @@
+/*
+ * USB-Changer bulkflash.h
+ *
+ * Append only flash region for large, read mostly data (calibration tables, factory data, captured waveforms) that
+ * does not fit the few small blocks of the emulated EEPROM. The region is BULKFLASH_PAGES flash pages directly below
+ * the factory calibration page (factory.h): the first page is a directory, the others hold the data as a stream of
+ * records that is read in place (bulkflash_record, memory mapped, no copy). A record is [length (2, little endian)]
+ * [data (length)] and never crosses a page: a record that does not fit the rest of the page starts the next one. The
+ * unused rest of a page reads as length 0xFFFF (erased flash, BULKFLASH_RECORD_SKIP) or is shorter than a header, the
+ * reader skips it, so a synced page does not put its padding into the data. bulkflash_append collects the records in a
+ * RAM page buffer, a full buffer (or a partial one after bulkflash_sync) is programmed as a whole page with XMC_FLASH_ProgramVerifyPage, so a
+ * page costs one erase and one program operation instead of 16 block writes with headers and the garbage collection
+ * copies of the emulated EEPROM. bulkflash_flush steps the programming from the idle main loop, one flash operation
+ * (page erase, page program or directory entry) per call. The directory entry written after every page commits the new
+ * length, a page interrupted by a reset is not part of the data after the reset. Data is never changed in place,
+ * bulkflash_erase empties the whole region (write once, e.g. erased again for a new calibration table).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef BULKFLASH_H
+#define BULKFLASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BULKFLASH_ENABLED			 0							// Determines if the region is mounted and written (0 = appends take nothing, the pages stay reserved)
+#define BULKFLASH_BASE				 0x10008000U				// Directory page, the data pages follow up to the factory page (the linker script keeps the program below it)
+#define BULKFLASH_PAGES				 7							// Flash pages of the region including the directory page
+#define BULKFLASH_PAGE_SIZE			 256U						// In bytes. XMC1 flash page (erase and page program unit)
+#define BULKFLASH_BLOCK_SIZE		 16U						// In bytes. XMC1 flash block (write unit) = one directory entry
+#define BULKFLASH_DATA_BASE			 (BULKFLASH_BASE + BULKFLASH_PAGE_SIZE)
+#define BULKFLASH_DATA_SIZE			 ((BULKFLASH_PAGES - 1U) * BULKFLASH_PAGE_SIZE)
+#define BULKFLASH_ENTRIES			 (BULKFLASH_PAGE_SIZE / BULKFLASH_BLOCK_SIZE)
+#define BULKFLASH_WRITE_ATTEMPTS	 3							// Number of tries of a page or directory entry before the page is dropped as failed
+#define BULKFLASH_RECORD_HEADER		 2U							// In bytes. Length field in front of every record
+#define BULKFLASH_RECORD_MAX		 (BULKFLASH_PAGE_SIZE - BULKFLASH_RECORD_HEADER)	// In bytes. Longest record (one page)
+#define BULKFLASH_RECORD_SKIP		 0xFFFFU					// Length of the unused rest of a page (erased flash)
+
+typedef struct {
+	uint32_t length;				// In bytes. Committed stream (pages before the last count whole, the reader skips their unused rest)
+	uint32_t pages;					// Programmed data pages (the next page starts at BULKFLASH_DATA_BASE + pages * BULKFLASH_PAGE_SIZE)
+	uint32_t length_check;			// ~length
+	uint32_t pages_check;			// ~pages (an erased or partly written block never has valid checks)
+} bulkflash_entry_t;
+
+extern uint16_t bulkflash_pages_written;	// Number of programmed data pages since reset
+extern uint16_t bulkflash_failures;			// Number of page or directory writes that failed
+
+void bulkflash_init(void);
+bool bulkflash_append(const uint8_t *data, uint16_t size);
+void bulkflash_sync(void);
+void bulkflash_erase(void);
+bool bulkflash_pending(void);
+bool bulkflash_flush(void);
+const uint8_t *bulkflash_data(void);
+const uint8_t *bulkflash_record(uint32_t *offset, uint16_t *size);
+uint32_t bulkflash_size(void);
+uint32_t bulkflash_free(void);
+
+#endif /* BULKFLASH_H */
@@ -0,0 +1,355 @@
+/*
+ * USB-Changer buttons.c
+ *
+ * Interrupt driven button front end and debounce engine (see buttons.h).
+ * UP and DOWN are both routed to ERU0 ETL3 (input A and B). As one ETL only detects edges of a single combined signal,
+ * the ETL source is re-armed after every edge to the AND combination that is true for the current levels of both pins.
+ * Its falling edge then fires on any change of either pin, so presses of both buttons at the same time are captured too.
+ * The USB button pin has no ERU connection on this package and is sampled by a SYSTIMER timer instead. Both sources run
+ * at the same interrupt priority and fill one edge queue that is emptied by main context. Without BUTTONS_ERU_ENABLED
+ * the timer samples UP and DOWN as well.
+ * buttons_update() processes the queued edges in one pass over the button table. Presses are published when all
+ * buttons are released again: a single button results in its own press state, several buttons pressed together
+ * (each at least its std_duration) result in a chord instead. Repeats are registered right away, a repeating press
+ * only counts while no other button is held.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_eru.h"
+#include "xmc1_eru_map.h"
+#include "buttons.h"
+#include "pins.h"
+#include "timing.h"
+
+#define BUTTONS_PIN_PRESSED			 0U							// Buttons are active low
+#define BUTTONS_ERU_ETL				 3U							// ETL channel of UP (input A) and DOWN (input B)
+#define BUTTONS_ERU_OGU				 0U							// OGU channel that raises ERU0_0_IRQn
+#define BUTTON_FLAG_HELD			 (1U << 0)					// Press edge was processed, release is pending
+#define BUTTON_FLAG_LONGEST			 (1U << 1)					// BTNPRESS_LONGEST is already reported for this press, release is ignored
+#define BUTTON_FLAG_REPEAT			 (1U << 2)					// Press follows a standard press within BTN_REPEAT_GAP, repeats when held
+#define BUTTON_FLAG_REPEATED		 (1U << 3)					// BTNPRESS_REPEAT was reported for this press, release is ignored
+#define BUTTONS_STD_US				 TIMING_MS_TO_US(BTN_STD_PRESS_DURATION)
+#define BUTTONS_LONG_US				 TIMING_MS_TO_US(BTN_LONG_PRESS_DURATION)
+#define BUTTONS_LONGEST_US			 TIMING_MS_TO_US(BTN_LONGEST_PRESS_DURATION)
+#define BUTTONS_REPEAT_GAP_US		 TIMING_MS_TO_US(BTN_REPEAT_GAP)
+#define BUTTONS_REPEAT_DELAY_US		 TIMING_MS_TO_US(BTN_REPEAT_DELAY)
+
+typedef char buttons_duration_check[(BTN_STD_PRESS_DURATION < BTN_LONG_PRESS_DURATION && BTN_LONG_PRESS_DURATION < BTN_LONGEST_PRESS_DURATION
+		&& BTN_LONGEST_PRESS_DURATION < TIMING_MS_MAX && BUTTONS_SAMPLE_PERIOD_US >= SYSTIMER_TICK_PERIOD_US) ? 1 : -1];
+typedef char buttons_repeat_check[(BTN_REPEAT_DELAY < BTN_LONG_PRESS_DURATION && BTN_REPEAT_INTERVAL_MIN <= BTN_REPEAT_INTERVAL
+		&& BTN_REPEAT_INTERVAL <= UINT16_MAX && BTN_REPEAT_RAMP > 0) ? 1 : -1];
+
+// Button table (index is buttons_id)
+const button_config_t buttons_config[BUTTON_COUNT] = {
+	[BUTTON_USB]  = {&IO_SW_USB,  1, BUTTONS_STD_US, BUTTONS_LONG_US, BUTTONS_LONGEST_US},
+	[BUTTON_UP]   = {&IO_SW_UP,   !BUTTONS_ERU_ENABLED, BUTTONS_STD_US, BUTTONS_LONG_US, BUTTONS_LONGEST_US},
+	[BUTTON_DOWN] = {&IO_SW_DOWN, !BUTTONS_ERU_ENABLED, BUTTONS_STD_US, BUTTONS_LONG_US, BUTTONS_LONGEST_US}
+};
+button_state_t buttons_state[BUTTON_COUNT];
+uint8_t buttons_held = 0;		// Mask of buttons with a pending release
+uint8_t buttons_session = 0;	// Mask of buttons with a valid press since all buttons were released last
+uint8_t buttons_chord = 0;		// Mask of the buttons of the last chorded press (0 = none) - the code reacting to it must clear it
+uint8_t buttons_repeat = 0;		// Mask of the buttons with auto-repeat enabled (buttons_set_repeat)
+
+volatile uint16_t buttons_edges_lost = 0; // Number of edges dropped because the queue was full (debug)
+
+button_edge_t buttons_edge_queue[BUTTONS_EDGE_QUEUE_SIZE];
+volatile uint8_t buttons_edge_head = 0; // Written in ISR context only
+volatile uint8_t buttons_edge_tail = 0; // Written in main context only
+volatile uint8_t buttons_pressed[BUTTON_COUNT]; // Last latched state of each button
+buttons_event_t buttons_callback = NULL;
+
+#if BUTTONS_ERU_ENABLED
+// ETL source that is true exactly while UP (A) and DOWN (B) keep the given pin levels [level A][level B]
+const XMC_ERU_ETL_SOURCE_t buttons_eru_source[2][2] = {
+	{XMC_ERU_ETL_SOURCE_NOT_A_AND_NOT_B, XMC_ERU_ETL_SOURCE_NOT_A_AND_B},
+	{XMC_ERU_ETL_SOURCE_A_AND_NOT_B, XMC_ERU_ETL_SOURCE_A_AND_B}
+};
+#endif
+
+
+//****************************************************************************
+// buttons_latch - records a level change of a button (ISR context). Returns true if the state changed
+//****************************************************************************
+bool buttons_latch(buttons_id button, uint32_t level, uint32_t timestamp){
+	uint8_t pressed = (level == BUTTONS_PIN_PRESSED);
+	if(buttons_pressed[button] == pressed)
+		return false;
+	buttons_pressed[button] = pressed;
+
+	uint8_t head = buttons_edge_head;
+	if((uint8_t)(head - buttons_edge_tail) >= BUTTONS_EDGE_QUEUE_SIZE){
+		buttons_edges_lost++;
+		return true;
+	}
+	button_edge_t *edge = &buttons_edge_queue[head & (BUTTONS_EDGE_QUEUE_SIZE - 1U)];
+	edge->timestamp = timestamp;
+	edge->button = button;
+	edge->pressed = pressed;
+	buttons_edge_head = head + 1U; // Publish after the record is complete
+	return true;
+}
+
+#if BUTTONS_ERU_ENABLED
+//****************************************************************************
+// ERU0_0_IRQHandler - ERU interrupt (IRQ_Hdlr_3): UP and/or DOWN changed
+//****************************************************************************
+void ERU0_0_IRQHandler(void){
+	uint32_t timestamp = SYSTIMER_GetTimeUs();
+	bool changed = false;
+	pins_snapshot_t pins;
+	pins_snapshot_t pins_after;
+
+	// Latch the levels and re-arm the ETL for leaving them. Repeat if a pin changed in between (its edge would be missed)
+	pins_snapshot(&pins);
+	do{
+		uint32_t level_up = pins_get_input(&pins, buttons_config[BUTTON_UP].io);
+		uint32_t level_down = pins_get_input(&pins, buttons_config[BUTTON_DOWN].io);
+		changed |= buttons_latch(BUTTON_UP, level_up, timestamp);
+		changed |= buttons_latch(BUTTON_DOWN, level_down, timestamp);
+		XMC_ERU_ETL_SetSource(XMC_ERU0, BUTTONS_ERU_ETL, buttons_eru_source[level_up][level_down]);
+
+		pins_after = pins;
+		pins_snapshot(&pins);
+	}while(pins_changed(&pins, &pins_after, buttons_config[BUTTON_UP].io) || pins_changed(&pins, &pins_after, buttons_config[BUTTON_DOWN].io));
+
+	if(changed && buttons_callback != NULL)
+		buttons_callback();
+}
+#endif
+
+//****************************************************************************
+// buttons_sample - SYSTIMER callback (SysTick ISR context): samples the buttons without ERU input
+//****************************************************************************
+void buttons_sample(void *args){
+	uint32_t timestamp = SYSTIMER_GetTimeUs();
+	bool changed = false;
+	pins_snapshot_t pins;
+
+	pins_snapshot(&pins);
+	for(uint8_t i = 0; i < BUTTON_COUNT; i++){
+		if(buttons_config[i].sampled)
+			changed |= buttons_latch((buttons_id)i, pins_get_input(&pins, buttons_config[i].io), timestamp);
+	}
+
+	if(changed && buttons_callback != NULL)
+		buttons_callback();
+}
+
+//****************************************************************************
+// buttons_init - sets up edge capture of all buttons. callback is called (ISR context) after new edges got queued
+//****************************************************************************
+bool buttons_init(buttons_event_t callback){
+	buttons_callback = callback;
+
+	// Start from the current levels, so buttons held during boot are not reported as pressed edge
+	pins_snapshot_t pins;
+	pins_snapshot(&pins);
+	for(uint8_t i = 0; i < BUTTON_COUNT; i++)
+		buttons_pressed[i] = (pins_get_input(&pins, buttons_config[i].io) == BUTTONS_PIN_PRESSED);
+#if BUTTONS_ERU_ENABLED
+	uint32_t level_up = pins_get_input(&pins, buttons_config[BUTTON_UP].io);
+	uint32_t level_down = pins_get_input(&pins, buttons_config[BUTTON_DOWN].io);
+
+	// UP/DOWN: ETL3 -> OGU0 -> ERU0_0_IRQn
+	XMC_ERU_ETL_CONFIG_t etl_config = {
+		.input_a = ERU0_ETL3_INPUTA_P2_7,
+		.input_b = ERU0_ETL3_INPUTB_P2_9,
+		.enable_output_trigger = 1U,
+		.status_flag_mode = XMC_ERU_ETL_STATUS_FLAG_MODE_HWCTRL,
+		.edge_detection = XMC_ERU_ETL_EDGE_DETECTION_FALLING,
+		.output_trigger_channel = XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL0,
+		.source = buttons_eru_source[level_up][level_down]
+	};
+	XMC_ERU_OGU_CONFIG_t ogu_config = {
+		.service_request = XMC_ERU_OGU_SERVICE_REQUEST_ON_TRIGGER
+	};
+	XMC_ERU_ETL_Init(XMC_ERU0, BUTTONS_ERU_ETL, &etl_config);
+	XMC_ERU_OGU_Init(XMC_ERU0, BUTTONS_ERU_OGU, &ogu_config);
+	NVIC_SetPriority(ERU0_0_IRQn, BUTTONS_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(ERU0_0_IRQn);
+	NVIC_EnableIRQ(ERU0_0_IRQn);
+#endif
+
+	// USB (and UP/DOWN without BUTTONS_ERU_ENABLED): sampled
+	uint32_t timer_id = SYSTIMER_CreateTimer(BUTTONS_SAMPLE_PERIOD_US, SYSTIMER_MODE_PERIODIC, buttons_sample, NULL);
+	if(timer_id == 0)
+		return false;
+	return SYSTIMER_StartTimer(timer_id) == SYSTIMER_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// buttons_get_edge - takes the oldest queued edge (main context). Returns false if no edge is queued
+//****************************************************************************
+bool buttons_get_edge(button_edge_t *edge){
+	uint8_t tail = buttons_edge_tail;
+	if(tail == buttons_edge_head)
+		return false;
+	*edge = buttons_edge_queue[tail & (BUTTONS_EDGE_QUEUE_SIZE - 1U)];
+	buttons_edge_tail = tail + 1U; // Release the slot after it is copied
+	return true;
+}
+
+//****************************************************************************
+// buttons_is_pressed - returns the last latched state of a button
+//****************************************************************************
+bool buttons_is_pressed(buttons_id button){
+	return buttons_pressed[button] != 0;
+}
+
+//****************************************************************************
+// buttons_classify - interprets the duration of a finished press
+//****************************************************************************
+button_press_states buttons_classify(const button_config_t *config, uint32_t duration_us){
+	// Compared in us (the configured durations are converted at compile time)
+	if(duration_us >= config->longest_duration)
+		return BTNPRESS_NOT; // In this case the press is already handled
+	if(duration_us >= config->long_duration)
+		return BTNPRESS_LONG;
+	if(duration_us >= config->std_duration)
+		return BTNPRESS_STD;
+	return BTNPRESS_NOT; // Bounce
+}
+
+//****************************************************************************
+// buttons_update - debounces and interprets all recorded edges and checks for too long presses (main context)
+//****************************************************************************
+void buttons_update(void){
+	button_edge_t edge;
+
+	/// Process all edges recorded since the last call
+	while(buttons_get_edge(&edge)){
+		const button_config_t *config = &buttons_config[edge.button];
+		button_state_t *state = &buttons_state[edge.button];
+		uint8_t mask = 1U << edge.button;
+
+		// Start of press: save the time of the edge
+		if(edge.pressed){
+			state->pressed_timestamp = edge.timestamp;
+			state->longest_deadline = timing_deadline_us(edge.timestamp, config->longest_duration + TIMING_US_PER_MS); // Held 1ms longer than longest_duration
+			state->flags = BUTTON_FLAG_HELD;
+			// Pressed again shortly after a standard press of its own: auto-repeats once held for BTN_REPEAT_DELAY
+			if((buttons_repeat & mask) && buttons_held == 0 && state->result == BTNPRESS_STD
+					&& edge.timestamp - state->released_timestamp <= BUTTONS_REPEAT_GAP_US){
+				state->flags |= BUTTON_FLAG_REPEAT;
+				state->repeat_deadline = timing_deadline_us(edge.timestamp, BUTTONS_REPEAT_DELAY_US);
+				state->repeat_interval = BTN_REPEAT_INTERVAL;
+				state->repeats = 0;
+			}
+			buttons_held |= mask;
+			continue;
+		}
+
+		// Release without a registered start (e.g. lost edge)
+		if(!(state->flags & BUTTON_FLAG_HELD))
+			continue;
+		buttons_held &= ~mask;
+		state->released_timestamp = edge.timestamp;
+
+		// Bounces are recorded as edge pairs shorter than std_duration and therefore ignored
+		if(!(state->flags & (BUTTON_FLAG_LONGEST | BUTTON_FLAG_REPEATED))){
+			state->result = buttons_classify(config, edge.timestamp - state->pressed_timestamp);
+			if(state->result != BTNPRESS_NOT)
+				buttons_session |= mask;
+		}
+		else
+			state->result = BTNPRESS_NOT; // A press right after a repeating one does not repeat
+		state->flags = 0;
+
+		// All buttons released: publish the press of a single button or the chord of several ones
+		if(buttons_held == 0 && buttons_session != 0){
+			if(buttons_session & (buttons_session - 1U))
+				buttons_chord = buttons_session;
+			else{
+				for(uint8_t i = 0; i < BUTTON_COUNT; i++){
+					if(buttons_session == (1U << i))
+						buttons_state[i].press = buttons_state[i].result;
+				}
+			}
+			buttons_session = 0;
+		}
+	}
+
+	/// Buttons that are held too long (only if no other button takes part)
+	uint32_t now = SYSTIMER_GetTimeUs();
+	for(uint8_t i = 0; i < BUTTON_COUNT; i++){
+		button_state_t *state = &buttons_state[i];
+		if(state->flags == BUTTON_FLAG_HELD && buttons_held == (1U << i) && buttons_session == 0
+				&& timing_reached(now, state->longest_deadline)){
+			state->flags |= BUTTON_FLAG_LONGEST; // ignore release of this press
+			state->press = BTNPRESS_LONGEST;
+		}
+		// Auto-repeat, the longest press is never reached by a repeating one (its flags differ from BUTTON_FLAG_HELD)
+		if((state->flags & BUTTON_FLAG_REPEAT) && buttons_held == (1U << i) && buttons_session == 0
+				&& timing_reached(now, state->repeat_deadline)){
+			state->flags |= BUTTON_FLAG_REPEATED; // ignore release of this press
+			state->press = BTNPRESS_REPEAT;
+			if(state->repeats < UINT8_MAX)
+				state->repeats++;
+			state->repeat_deadline = timing_deadline_us(now, (uint32_t)state->repeat_interval * TIMING_US_PER_MS);
+			if(state->repeat_interval >= BTN_REPEAT_INTERVAL_MIN + BTN_REPEAT_RAMP)
+				state->repeat_interval -= BTN_REPEAT_RAMP;
+			else
+				state->repeat_interval = BTN_REPEAT_INTERVAL_MIN;
+		}
+	}
+}
+
+//****************************************************************************
+// buttons_get_press - returns the registered press of a button
+//****************************************************************************
+button_press_states buttons_get_press(buttons_id button){
+	return (button_press_states)buttons_state[button].press;
+}
+
+//****************************************************************************
+// buttons_get_chord - returns the mask (1 << buttons_id) of the buttons of a registered chorded press (0 = none)
+//****************************************************************************
+uint8_t buttons_get_chord(void){
+	return buttons_chord;
+}
+
+//****************************************************************************
+// buttons_any_press - returns true if any press or chord is registered
+//****************************************************************************
+bool buttons_any_press(void){
+	if(buttons_chord != 0)
+		return true;
+	for(uint8_t i = 0; i < BUTTON_COUNT; i++){
+		if(buttons_state[i].press != BTNPRESS_NOT)
+			return true;
+	}
+	return false;
+}
+
+//****************************************************************************
+// buttons_clear_press - marks the press of a button as handled
+//****************************************************************************
+void buttons_clear_press(buttons_id button){
+	buttons_state[button].press = BTNPRESS_NOT;
+}
+
+//****************************************************************************
+// buttons_clear_presses - marks all presses and the chord as handled
+//****************************************************************************
+void buttons_clear_presses(void){
+	for(uint8_t i = 0; i < BUTTON_COUNT; i++)
+		buttons_state[i].press = BTNPRESS_NOT;
+	buttons_chord = 0;
+}
+
+//****************************************************************************
+// buttons_set_repeat - enables auto-repeat for the buttons of a mask (1 << buttons_id), 0 disables it for all
+//****************************************************************************
+void buttons_set_repeat(uint8_t mask){
+	buttons_repeat = mask;
+}
+
+//****************************************************************************
+// buttons_get_repeats - returns the number of repeats of the current press of a button (valid with BTNPRESS_REPEAT)
+//****************************************************************************
+uint8_t buttons_get_repeats(buttons_id button){
+	return buttons_state[button].repeats;
+}
@@ -0,0 +1,93 @@
+/*
+ * USB-Changer buttons.h
+ *
+ * Interrupt driven button front end and table driven debounce engine. Every level change of a button is latched in an
+ * ISR together with a microsecond timestamp (SYSTIMER_GetTimeUs) and queued, so the button logic in main context works
+ * on recorded edges instead of polling the GPIOs on every pass. All buttons are described by one configuration table
+ * (buttons_config) and share one state record type, adding a button only needs a new table entry.
+ * Auto-repeat: a button with repeat enabled (buttons_set_repeat) that is pressed again within BTN_REPEAT_GAP after a
+ * standard press and held registers BTNPRESS_REPEAT, first after BTN_REPEAT_DELAY and then at an interval that
+ * shrinks with every repeat from BTN_REPEAT_INTERVAL to BTN_REPEAT_INTERVAL_MIN. A plain hold keeps its long and
+ * longest meaning. The release of a press that repeated is ignored, buttons_get_repeats counts its repeats so the user
+ * can take larger steps after a number of them.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+#include "DIGITAL_IO/digital_io.h"
+#include "timing.h"
+
+#define BUTTONS_EDGE_QUEUE_SIZE		 16							// Number of edges that can be buffered between two button task passes (must be a power of 2)
+#define BUTTONS_SAMPLE_PERIOD		 1							// In ms. Sample period of buttons without ERU input (edge timestamps of these have this resolution)
+#define BUTTONS_ERU_ENABLED			 0							// Determines if the edges of UP and DOWN are captured by the ERU interrupt (0 = they are sampled like BUTTON_USB)
+#define BUTTONS_IRQ_PRIORITY		 IRQPRIO_BUTTONS			// Priority of the ERU interrupt (equal to the SysTick priority so the edge queue needs no locking between both)
+#define BTN_STD_PRESS_DURATION		 60							// The minimum duration of a button press that will be registered as such (debouncing)
+#define BTN_LONG_PRESS_DURATION		 1000						// The minimum duration of a long button press that will be registered as such (debouncing)
+#define BTN_LONGEST_PRESS_DURATION	 4000						// The maximum duration of a button press
+#define BTN_REPEAT_GAP				 400						// In ms. Longest release between a standard press and the press that auto-repeats
+#define BTN_REPEAT_DELAY			 400						// In ms. Hold time of that press before the first repeat
+#define BTN_REPEAT_INTERVAL			 250						// In ms. Interval of the first repeats
+#define BTN_REPEAT_INTERVAL_MIN		 40							// In ms. Shortest interval, reached after (BTN_REPEAT_INTERVAL - BTN_REPEAT_INTERVAL_MIN) / BTN_REPEAT_RAMP repeats
+#define BTN_REPEAT_RAMP				 15							// In ms. The interval shrinks by this after every repeat
+#define BUTTONS_SAMPLE_PERIOD_US	 TIMING_MS_TO_US(BUTTONS_SAMPLE_PERIOD)
+
+typedef enum {
+	BUTTON_USB,			// IO_SW_USB  (P0.8 - no ERU input on this package, sampled every BUTTONS_SAMPLE_PERIOD)
+	BUTTON_UP,			// IO_SW_UP   (P2.7 - ERU0 ETL3 input A with BUTTONS_ERU_ENABLED)
+	BUTTON_DOWN,		// IO_SW_DOWN (P2.9 - ERU0 ETL3 input B with BUTTONS_ERU_ENABLED)
+	BUTTON_COUNT		// Max. 8 (buttons are combined in 8 bit masks)
+} buttons_id;
+
+typedef enum {BTNPRESS_NOT, BTNPRESS_STD, BTNPRESS_LONG, BTNPRESS_LONGEST, BTNPRESS_REPEAT} button_press_states;
+
+typedef struct {
+	const DIGITAL_IO_t *io;			// Pin of the button (active low)
+	uint8_t sampled;				// 1 = pin is sampled by a SYSTIMER timer, 0 = edges are captured by the ERU
+	uint32_t std_duration;			// In us. Minimum duration of a standard press (shorter presses are treated as bounce)
+	uint32_t long_duration;			// In us. Minimum duration of a long press
+	uint32_t longest_duration;		// In us. Duration after which a held button is reported as BTNPRESS_LONGEST (release is ignored then)
+} button_config_t;
+
+typedef struct {
+	uint32_t pressed_timestamp;		// In us. Time of the last press edge
+	uint32_t released_timestamp;	// In us. Time of the last release edge
+	uint32_t longest_deadline;		// In us. Time after which the held button is reported as BTNPRESS_LONGEST
+	uint32_t repeat_deadline;		// In us. Time of the next BTNPRESS_REPEAT of an auto-repeating press
+	uint16_t repeat_interval;		// In ms. Interval to the repeat after the next one
+	uint8_t repeats;				// BTNPRESS_REPEAT registered by the current press (saturates at 255)
+	uint8_t flags;					// BUTTON_FLAG_* (see buttons.c)
+	uint8_t result;					// button_press_states. Classification of the last release (published when all buttons are released)
+	uint8_t press;					// button_press_states. Registered press - the code reacting to it must clear it
+} button_state_t;
+
+typedef struct {
+	uint32_t timestamp;		// In us (SYSTIMER_GetTimeUs). Time the edge was latched
+	uint8_t button;			// buttons_id of the button that changed
+	uint8_t pressed;		// 1 = button got pressed, 0 = button got released
+} button_edge_t;
+
+typedef void (*buttons_event_t)(void);
+
+extern const button_config_t buttons_config[BUTTON_COUNT];
+extern button_state_t buttons_state[BUTTON_COUNT];
+extern volatile uint16_t buttons_edges_lost;
+
+bool buttons_init(buttons_event_t callback);
+bool buttons_get_edge(button_edge_t *edge);
+bool buttons_is_pressed(buttons_id button);
+void buttons_update(void);
+button_press_states buttons_get_press(buttons_id button);
+uint8_t buttons_get_chord(void);
+bool buttons_any_press(void);
+void buttons_clear_press(buttons_id button);
+void buttons_clear_presses(void);
+void buttons_set_repeat(uint8_t mask);
+uint8_t buttons_get_repeats(buttons_id button);
+
+#endif /* BUTTONS_H */
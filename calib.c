@@ -0,0 +1,92 @@
+/*
+ * USB-Changer calib.c
+ *
+ * Sensor linearisation (see calib.h). The only division is in calib_build (once per segment when a table is loaded).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "calib.h"
+
+// The rise of a segment (up to 65535 units) in slope fractions, and so every interpolation offset, must fit int32
+typedef char calib_slope_check[((0xFFFFULL << CALIB_SLOPE_FRAC_BITS) + (1ULL << (CALIB_SLOPE_FRAC_BITS - 1)) <= 0x7FFFFFFFULL) ? 1 : -1];
+
+// Identity table stored in flash (engineering unit = ADC count), used if no valid table is stored in EEPROM
+const calib_table_t calib_default = {
+	.count = 2,
+	.points = {{0, 0}, {4095, 4095}}
+};
+
+
+//****************************************************************************
+// calib_build - checks the points and precomputes the segment slopes (returns false if the table is invalid)
+//****************************************************************************
+bool calib_build(calib_table_t *table){
+	if(table->count < 2 || table->count > CALIB_MAX_POINTS)
+		return false;
+
+	for(uint8_t i = 0; i < table->count - 1U; i++){
+		const calib_point_t *start = &table->points[i];
+		const calib_point_t *end = &table->points[i + 1U];
+		if(end->raw <= start->raw)
+			return false;
+		int32_t rise = ((int32_t)end->value - (int32_t)start->value) * (int32_t)(1L << CALIB_SLOPE_FRAC_BITS);
+		table->slopes[i] = rise / ((int32_t)end->raw - (int32_t)start->raw);
+	}
+	return true;
+}
+
+//****************************************************************************
+// calib_convert - converts a raw value to engineering units (table must be built by calib_build)
+//****************************************************************************
+uint16_t calib_convert(const calib_table_t *table, uint16_t raw){
+	const calib_point_t *points = table->points;
+	uint8_t last = table->count - 1U;
+
+	if(raw <= points[0].raw)
+		return points[0].value;
+	if(raw >= points[last].raw)
+		return points[last].value;
+
+	// Segment containing raw (few points, a linear search is faster than a binary one here)
+	uint8_t i = 0;
+	while(raw >= points[i + 1U].raw)
+		i++;
+
+	// Interpolation with rounding (the result always lies between the values of both points, |offset| <= |rise| of the segment)
+	int32_t offset = (int32_t)(raw - points[i].raw) * table->slopes[i];
+	return (uint16_t)((int32_t)points[i].value + ((offset + (1L << (CALIB_SLOPE_FRAC_BITS - 1))) >> CALIB_SLOPE_FRAC_BITS));
+}
+
+//****************************************************************************
+// calib_serialize - writes the points of a table to CALIB_STORAGE_SIZE bytes (little endian)
+//****************************************************************************
+void calib_serialize(const calib_table_t *table, uint8_t *data){
+	data[0] = CALIB_MAGIC;
+	data[1] = table->count;
+	for(uint8_t i = 0; i < CALIB_MAX_POINTS; i++){
+		uint8_t *entry = &data[2U + (i * 4U)];
+		calib_point_t point = {0, 0};
+		if(i < table->count)
+			point = table->points[i];
+		entry[0] = (uint8_t)point.raw;
+		entry[1] = (uint8_t)(point.raw >> 8);
+		entry[2] = (uint8_t)point.value;
+		entry[3] = (uint8_t)(point.value >> 8);
+	}
+}
+
+//****************************************************************************
+// calib_deserialize - reads a table written by calib_serialize and builds it (returns false if the data is invalid)
+//****************************************************************************
+bool calib_deserialize(calib_table_t *table, const uint8_t *data){
+	if(data[0] != CALIB_MAGIC || data[1] < 2 || data[1] > CALIB_MAX_POINTS)
+		return false;
+	table->count = data[1];
+	for(uint8_t i = 0; i < table->count; i++){
+		const uint8_t *entry = &data[2U + (i * 4U)];
+		table->points[i].raw = entry[0] + (entry[1] << 8);
+		table->points[i].value = entry[2] + (entry[3] << 8);
+	}
+	return calib_build(table);
+}
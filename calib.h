@@ -0,0 +1,42 @@
+/*
+ * USB-Changer calib.h
+ *
+ * Sensor linearisation. Converts scaled ADC counts to engineering units through a piecewise linear table of up to
+ * CALIB_MAX_POINTS points (ascending raw counts). Values between two points are interpolated, values outside the
+ * table are clamped to the first/last point. The slope of every segment is precomputed (calib_build), so a
+ * conversion costs a short segment search, one multiplication and one shift and can run per sample.
+ * A table can be stored in the EEPROM block EEPROM_CALIBRATION (calib_serialize/calib_deserialize).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef CALIB_H
+#define CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CALIB_MAX_POINTS			 8							// Maximum number of table points
+#define CALIB_SLOPE_FRAC_BITS		 15							// Fractional bits of the precomputed segment slopes (a full 16 bit rise still fits int32)
+#define CALIB_MAGIC					 0xCA						// First byte of a stored table (identifies a valid EEPROM block)
+#define CALIB_STORAGE_SIZE			 (2U + (CALIB_MAX_POINTS * 4U))	// Bytes of a serialized table (magic, count, points) = size of EEPROM_CALIBRATION
+
+typedef struct {
+	uint16_t raw;					// Scaled ADC value (12 bit)
+	uint16_t value;					// Value in engineering units at raw
+} calib_point_t;
+
+typedef struct {
+	uint8_t count;									// Number of points (min. 2)
+	calib_point_t points[CALIB_MAX_POINTS];			// Ascending by raw
+	int32_t slopes[CALIB_MAX_POINTS - 1];			// Slope of the segment starting at each point (built by calib_build)
+} calib_table_t;
+
+extern const calib_table_t calib_default;
+
+bool calib_build(calib_table_t *table);
+uint16_t calib_convert(const calib_table_t *table, uint16_t raw);
+void calib_serialize(const calib_table_t *table, uint8_t *data);
+bool calib_deserialize(calib_table_t *table, const uint8_t *data);
+
+#endif /* CALIB_H */
@@ -0,0 +1,170 @@
+/*
+ * USB-Changer capture.c
+ *
+ * Raw ADC capture (see capture.h). The ring has one producer (ADC interrupt) and one consumer (capture_task). In
+ * stream mode the interrupt keeps writing while a record is encoded, so the samples of a record are checked again
+ * after encoding: if the interrupt overwrote any of them the record is discarded and they are counted as lost.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "capture.h"
+#include "telemetry.h"
+#include "ramcode.h"
+#include "arena.h"
+#include "bulkflash.h"
+
+#define CAPTURE_HEADER_SIZE			 7							// mode, index, first sample
+
+typedef char capture_samples_check[((CAPTURE_SAMPLES & (CAPTURE_SAMPLES - 1)) == 0 && CAPTURE_POST_SAMPLES < CAPTURE_SAMPLES) ? 1 : -1];
+
+ARENA(capture) uint8_t capture_buffer[SAMPLE_PACKED_SIZE(CAPTURE_SAMPLES)];
+volatile uint8_t capture_state = CAPTURE_STATE_IDLE;
+volatile uint32_t capture_count = 0;
+uint32_t capture_stop = 0;
+uint32_t capture_lost = 0;
+volatile uint16_t capture_fill = 0;
+capture_modes capture_mode = CAPTURE_OFF;
+uint32_t capture_read = 0;				// capture_count of the next sample to send
+uint32_t capture_trigger_index = 0;		// capture_count at the trigger (window mode)
+bool capture_stored = false;			// The record at capture_read is in the bulk flash region already (its telemetry send is retried)
+
+
+//****************************************************************************
+// capture_set_mode - starts a capture mode (main context)
+//****************************************************************************
+void capture_set_mode(capture_modes mode){
+	if(mode >= CAPTURE_MODE_COUNT)
+		return;
+	capture_state = CAPTURE_STATE_IDLE;
+	capture_mode = mode;
+	capture_read = capture_count;
+	capture_fill = 0;
+	capture_stored = false;
+	if(mode != CAPTURE_OFF)
+		capture_state = CAPTURE_STATE_RUNNING;
+}
+
+//****************************************************************************
+// capture_get_mode - returns the current capture mode
+//****************************************************************************
+capture_modes capture_get_mode(void){
+	return capture_mode;
+}
+
+//****************************************************************************
+// capture_trigger - completes the window: CAPTURE_POST_SAMPLES more samples are recorded (main context, relay switch)
+//****************************************************************************
+void capture_trigger(void){
+	if(capture_mode != CAPTURE_WINDOW || capture_state != CAPTURE_STATE_RUNNING)
+		return;
+	// The window starts at the oldest sample captured since arming (fill first, a sample pushed meanwhile is not counted)
+	uint32_t pre = capture_fill;
+	capture_trigger_index = capture_count;
+	if(pre > CAPTURE_SAMPLES - CAPTURE_POST_SAMPLES)
+		pre = CAPTURE_SAMPLES - CAPTURE_POST_SAMPLES;
+	capture_read = capture_trigger_index - pre;
+	capture_stop = capture_trigger_index + CAPTURE_POST_SAMPLES;
+	capture_state = CAPTURE_STATE_POST; // After capture_stop, the interrupt reads both
+}
+
+//****************************************************************************
+// capture_encode - packs samples from capture_read up to end into one record, returns the number of samples packed
+//****************************************************************************
+uint32_t capture_encode(uint8_t *payload, uint8_t *length, uint32_t end, int32_t index){
+	uint32_t read = capture_read;
+	uint16_t previous = sample_unpack(capture_buffer, read & (CAPTURE_SAMPLES - 1U));
+	payload[0] = (uint8_t)capture_mode;
+	telemetry_put32(&payload[1], (uint32_t)index);
+	payload[5] = (uint8_t)previous;
+	payload[6] = (uint8_t)(previous >> 8);
+	uint8_t size = CAPTURE_HEADER_SIZE;
+	read++;
+
+	// A 12 bit difference takes at most 2 varint bytes
+	while(read != end && size + 2U <= TELEMETRY_PAYLOAD_MAX){
+		uint16_t sample = sample_unpack(capture_buffer, read & (CAPTURE_SAMPLES - 1U));
+		int32_t delta = (int32_t)sample - (int32_t)previous;
+		uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+		while(zigzag >= 0x80U){
+			payload[size++] = (uint8_t)(zigzag | 0x80U);
+			zigzag >>= 7;
+		}
+		payload[size++] = (uint8_t)zigzag;
+		previous = sample;
+		read++;
+	}
+	*length = size;
+	return read - capture_read;
+}
+
+//****************************************************************************
+// capture_send_stream - sends the samples captured since the last run (stream mode)
+//****************************************************************************
+void capture_send_stream(void){
+	uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+	uint8_t length;
+	for(uint8_t records = 0; records < CAPTURE_RECORDS_PER_RUN; records++){
+		uint32_t end = capture_count;
+		// Skip what was overwritten already, with some room for the interrupt to keep writing during the encoding
+		if(end - capture_read > CAPTURE_SAMPLES - (CAPTURE_SAMPLES / 8U)){
+			uint32_t start = end - (CAPTURE_SAMPLES - (CAPTURE_SAMPLES / 8U));
+			capture_lost += start - capture_read;
+			capture_read = start;
+		}
+		if(end == capture_read)
+			return;
+
+		uint32_t samples = capture_encode(payload, &length, end, (int32_t)capture_read);
+		if(capture_count - capture_read > CAPTURE_SAMPLES){
+			// Overwritten while encoding
+			capture_lost += samples;
+			capture_read += samples;
+			continue;
+		}
+		if(!telemetry_send(TELEMETRY_RECORD_CAPTURE, payload, length))
+			return; // Retried on the next run (or lost once the ring wrapped)
+		capture_read += samples;
+	}
+}
+
+//****************************************************************************
+// capture_send_window - sends a frozen window and keeps it in the bulk flash region, then arms the capture again (window mode)
+//****************************************************************************
+void capture_send_window(void){
+	if(capture_state != CAPTURE_STATE_FROZEN)
+		return;
+
+	uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+	uint8_t length;
+	for(uint8_t records = 0; records < CAPTURE_RECORDS_PER_RUN && capture_read != capture_stop; records++){
+		uint32_t samples = capture_encode(payload, &length, capture_stop, (int32_t)(capture_read - capture_trigger_index));
+		// Stored while the region has room, a sealed page is retried on the next run
+		if(BULKFLASH_ENABLED && !capture_stored && bulkflash_free() >= BULKFLASH_RECORD_HEADER + length){
+			if(!bulkflash_append(payload, length))
+				return;
+			capture_stored = true;
+		}
+		if(TELEMETRY_ENABLED && !telemetry_send(TELEMETRY_RECORD_CAPTURE, payload, length))
+			return;
+		capture_read += samples;
+		capture_stored = false;
+	}
+	if(capture_read == capture_stop){
+		// The last page of the window is programmed without waiting for the next one
+		bulkflash_sync();
+		capture_fill = 0;
+		capture_state = CAPTURE_STATE_RUNNING;
+	}
+}
+
+//****************************************************************************
+// capture_task - sends captured samples (scheduler task, CAPTURE_TASK_PERIOD)
+//****************************************************************************
+void capture_task(void){
+	if(capture_mode == CAPTURE_STREAM)
+		capture_send_stream();
+	else if(capture_mode == CAPTURE_WINDOW)
+		capture_send_window();
+}
@@ -0,0 +1,79 @@
+/*
+ * USB-Changer capture.h
+ *
+ * Raw ADC capture. The ADC result interrupt stores the unfiltered results of one sensor channel in an SRAM ring
+ * (capture_push). In CAPTURE_STREAM mode capture_task sends the ring continuously over the telemetry UART, in
+ * CAPTURE_WINDOW mode the ring keeps the last samples until a relay switch (capture_trigger), records
+ * CAPTURE_POST_SAMPLES more and freezes: capture_buffer then holds the waveform around the switch (readable with a
+ * debugger) and is sent once before the capture is armed again. With BULKFLASH_ENABLED the records of the window are
+ * also appended to the bulk flash region (one bulk flash record each, bulkflash.h), so the last windows survive a
+ * reset until the region is full. The ring stores the 12 bit samples packed, two in 3
+ * bytes (sample.h).
+ * Samples are sent as TELEMETRY_RECORD_CAPTURE records: [mode (1)][index of the first sample (4)][first sample (2)]
+ * followed by the differences to the previous sample, zigzag encoded (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) and
+ * written as varints (7 bits per byte, bit 7 set = more bytes follow). Most differences take one byte instead of two.
+ * The index counts all captured samples in stream mode (a gap = lost samples) and is relative to the trigger in
+ * window mode (negative = before the trigger). A window only holds samples captured since the capture was armed (mode
+ * set or the last window sent), a trigger right after arming sends a shorter pre-trigger part. Every record starts with an absolute sample, so a lost record does
+ * not affect the following ones.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sample.h"
+
+#define CAPTURE_ENABLED				 0							// Determines if the ADC interrupt feeds the capture ring (0 removes capture_push)
+#define CAPTURE_CHANNEL				 0							// Sensor channel that is captured
+#define CAPTURE_SAMPLES				 512						// Number of samples in the ring (power of 2, 1.5 bytes each)
+#define CAPTURE_POST_SAMPLES		 256						// Samples recorded after the trigger in window mode (the rest of the window is before it)
+#define CAPTURE_TASK_PERIOD			 5							// In ms. Period of capture_task (scheduler task)
+#define CAPTURE_RECORDS_PER_RUN		 3							// Maximum number of records sent per task run
+
+typedef enum {
+	CAPTURE_OFF,			// Nothing is recorded
+	CAPTURE_STREAM,			// All samples are sent
+	CAPTURE_WINDOW,			// Samples around the next relay switch are kept and sent
+	CAPTURE_MODE_COUNT
+} capture_modes;
+
+typedef enum {
+	CAPTURE_STATE_IDLE,		// Off
+	CAPTURE_STATE_RUNNING,	// The interrupt overwrites the oldest samples
+	CAPTURE_STATE_POST,		// Triggered, the interrupt records until capture_stop
+	CAPTURE_STATE_FROZEN	// Window complete, not written by the interrupt
+} capture_states;
+
+extern uint8_t capture_buffer[SAMPLE_PACKED_SIZE(CAPTURE_SAMPLES)];
+extern volatile uint8_t capture_state;		// capture_states
+extern volatile uint32_t capture_count;		// Number of captured samples (next write at capture_count % CAPTURE_SAMPLES)
+extern uint32_t capture_stop;				// capture_count the window freezes at
+extern uint32_t capture_lost;				// Samples that were overwritten before they were sent (stream mode)
+extern volatile uint16_t capture_fill;		// Samples captured since the capture was armed, up to CAPTURE_SAMPLES (older ring slots are stale)
+
+void capture_set_mode(capture_modes mode);
+capture_modes capture_get_mode(void);
+void capture_trigger(void);
+void capture_task(void);
+
+//****************************************************************************
+// capture_push - stores a raw sample (ADC result interrupt)
+//****************************************************************************
+static inline void capture_push(uint16_t value){
+	uint8_t state = capture_state;
+	if(state != CAPTURE_STATE_RUNNING && state != CAPTURE_STATE_POST)
+		return;
+	uint32_t count = capture_count;
+	sample_pack(capture_buffer, count & (CAPTURE_SAMPLES - 1U), value);
+	capture_count = ++count;
+	if(capture_fill < CAPTURE_SAMPLES)
+		capture_fill++;
+	if(state == CAPTURE_STATE_POST && count == capture_stop)
+		capture_state = CAPTURE_STATE_FROZEN;
+}
+
+#endif /* CAPTURE_H */
@@ -0,0 +1,119 @@
+/*
+ * USB-Changer clockscale.c
+ *
+ * Dynamic MCLK scaling (see clockscale.h). A change runs with interrupts masked: XMC_SCU_CLOCK_ScaleMCLKFrequency
+ * steps the divider towards the new value, then every timer user is told the new divider. The few microseconds of
+ * the divider steps are counted at intermediate clocks, SYSTIMER_GetTime can be off by that much per change.
+ * Compare values of the LED and period values of the sensor trigger are divided as well (the prescalers are already at
+ * their minimum), the hrtimer slice lowers its prescaler instead.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "clockscale.h"
+#include "ledfade.h"
+#include "sensor.h"
+#include "hrtimer.h"
+#include "timebase.h"
+#include "coil.h"
+#include "freqsensor.h"
+#include "telemetry.h"
+#include "modbus.h"
+#include "timing.h"
+#include "critical.h"
+
+// SysTick ticks, the LED period and the sensor trigger period must be whole numbers of counts at the low clock
+typedef char clockscale_shift_check[((((SYSTIMER_SYSTICK_CLOCK / 1000000U) * SYSTIMER_TICK_PERIOD_US) % (1U << CLOCKSCALE_LOW_SHIFT)) == 0
+		&& (LEDFADE_PERIOD % (1U << CLOCKSCALE_LOW_SHIFT)) == 0 && CLOCKSCALE_FULL_KHZ * 1000U == SYSTIMER_SYSTICK_CLOCK) ? 1 : -1];
+
+uint8_t clockscale_shift = 0;		// Current MCLK divider (power of 2) against CLOCKSCALE_FULL_KHZ
+uint8_t clockscale_holds_active = 0;	// Bit mask of set holds (clockscale_holds)
+uint32_t clockscale_idle_deadline = 0;	// In us. Time MCLK may be lowered at (SYSTIMER_GetTime)
+
+
+//****************************************************************************
+// clockscale_set - changes MCLK to CLOCKSCALE_FULL_KHZ >> shift and adapts all timer users
+//****************************************************************************
+bool clockscale_set(uint8_t shift){
+	if(shift == clockscale_shift)
+		return true;
+	if(!CLOCKSCALE_ENABLED)
+		return false;
+
+	critical_state_t primask = critical_enter();
+	CLOCK_XMC1_SetMCLKFrequency(CLOCKSCALE_FULL_KHZ >> shift);
+	bool success = SYSTIMER_SetClockShift(shift) == SYSTIMER_STATUS_SUCCESS;
+	ledfade_set_clock_shift(shift);
+	sensor_set_clock_shift(shift);
+	success = hrtimer_set_clock_shift(shift) && success;
+	success = timebase_set_clock_shift(shift) && success;
+	success = coil_set_clock_shift(shift) && success;
+	success = freqsensor_set_clock_shift(shift) && success;
+	telemetry_set_clock_shift(shift);
+	modbus_set_clock_shift(shift);
+	clockscale_shift = shift;
+	critical_exit(primask, CRITICAL_SITE_CLOCKSCALE);
+	return success;
+}
+
+//****************************************************************************
+// clockscale_init - starts the idle time (call after sensor_init and hrtimer_init)
+//****************************************************************************
+void clockscale_init(void){
+	clockscale_idle_deadline = timing_deadline(SYSTIMER_GetTime(), CLOCKSCALE_IDLE_TIME);
+}
+
+//****************************************************************************
+// clockscale_activity - restores the full clock and restarts the idle time (main context)
+//****************************************************************************
+void clockscale_activity(void){
+	clockscale_idle_deadline = timing_deadline(SYSTIMER_GetTime(), CLOCKSCALE_IDLE_TIME);
+	clockscale_set(0);
+}
+
+//****************************************************************************
+// clockscale_hold - sets or clears a hold, the full clock is kept while any hold is set (main context)
+//****************************************************************************
+void clockscale_hold(clockscale_holds hold, bool active){
+	if(!CLOCKSCALE_ENABLED)
+		return;
+	uint8_t mask = (uint8_t)(1U << hold);
+	if(active){
+		if(!(clockscale_holds_active & mask))
+			clockscale_activity();
+		clockscale_holds_active |= mask;
+	}
+	else if(clockscale_holds_active & mask){
+		// The idle time starts when the hold is released
+		clockscale_holds_active &= (uint8_t)~mask;
+		clockscale_activity();
+	}
+}
+
+//****************************************************************************
+// clockscale_task - lowers MCLK once the idle time passed without a hold (scheduler task)
+//****************************************************************************
+void clockscale_task(void){
+#if CLOCKSCALE_ENABLED
+	if(clockscale_shift == 0 && clockscale_holds_active == 0 && timing_reached(SYSTIMER_GetTime(), clockscale_idle_deadline))
+		clockscale_set(CLOCKSCALE_LOW_SHIFT);
+#endif
+}
+
+//****************************************************************************
+// clockscale_lower - lowers MCLK now unless a hold is set (main context, the next activity restores it)
+//****************************************************************************
+void clockscale_lower(void){
+#if CLOCKSCALE_ENABLED
+	if(clockscale_holds_active == 0)
+		clockscale_set(CLOCKSCALE_LOW_SHIFT);
+#endif
+}
+
+//****************************************************************************
+// clockscale_get_shift - returns the current MCLK divider (MCLK = CLOCKSCALE_FULL_KHZ >> shift)
+//****************************************************************************
+uint8_t clockscale_get_shift(void){
+	return clockscale_shift;
+}
@@ -0,0 +1,38 @@
+/*
+ * USB-Changer clockscale.h
+ *
+ * Dynamic MCLK scaling. MCLK is lowered to CLOCKSCALE_FULL_KHZ >> CLOCKSCALE_LOW_SHIFT after CLOCKSCALE_IDLE_TIME
+ * without user activity and restored on the next activity or while a hold is set (e.g. the setup menu is open).
+ * The CCU4 clock (PCLK = 2 * MCLK) is divided by the same power of 2, so SysTick, the status LED PWM, the sensor
+ * trigger, the hrtimer slice and the telemetry baud rate are adapted on every change and SYSTIMER_GetTime, PWM
+ * frequency, sample rate and baud rate stay as configured. Relay evaluation runs at either clock.
+ * clockscale_lower skips the idle time (e.g. the USB standby, nothing needs the full clock until the next activity).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef CLOCKSCALE_H
+#define CLOCKSCALE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CLOCKSCALE_ENABLED			 0							// Determines if MCLK is lowered while idle (0 = always the DAVE clock)
+#define CLOCKSCALE_FULL_KHZ			 32000U						// In kHz. MCLK as configured in DAVE (SYSTIMER_SYSTICK_CLOCK)
+#define CLOCKSCALE_LOW_SHIFT		 2							// MCLK while idle is CLOCKSCALE_FULL_KHZ >> shift (8MHz)
+#define CLOCKSCALE_IDLE_TIME		 10000						// In ms. Time without user activity after which MCLK is lowered
+#define CLOCKSCALE_TASK_PERIOD		 100						// In ms. Period of the idle check (clockscale_task, scheduler task)
+
+typedef enum {
+	CLOCKSCALE_HOLD_SETUP,		// Setup menu is open
+	CLOCKSCALE_HOLD_COUNT
+} clockscale_holds;
+
+void clockscale_init(void);
+void clockscale_activity(void);
+void clockscale_hold(clockscale_holds hold, bool active);
+void clockscale_task(void);
+void clockscale_lower(void);
+uint8_t clockscale_get_shift(void);
+
+#endif /* CLOCKSCALE_H */
@@ -0,0 +1,138 @@
+/*
+ * USB-Changer coil.c
+ *
+ * Relay coil economiser (see coil.h). CCU40 slice 1 runs edge aligned with a 1MHz timer clock, its status bit drives
+ * CCU40.OUT1 (passive level low: high from the compare match to the period match, compare 0 = full drive).
+ * coil_set(true) loads the pull-in (one period of coil_pullin_time at compare 0) into the stopped slice, where the
+ * software shadow transfer applies immediately, starts it and then writes the hold period and compare into the shadow
+ * registers. Their transfer waits for the period match at the end of the pull-in, from then on the slice repeats the
+ * hold PWM by itself. The counts are computed by coil_configure in main context, coil_set (relay_update, may run from
+ * the ADC interrupt) only writes registers.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "coil.h"
+#include "ramcode.h"
+#include "funcprof.h"
+#include "pins.h"
+#include "critical.h"
+
+#define COIL_SLICE					 CCU40_CC41					// PWM slice of the relay pin (CCU40.OUT1 = P0.7 ALT4)
+#define COIL_SLICE_NUMBER			 1U
+#define COIL_SHADOW					 XMC_CCU4_SHADOW_TRANSFER_SLICE_1
+#define COIL_PIN_MODE				 XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT4	// P0_7_AF_CCU40_OUT1
+#define COIL_CLOCK					 1000000U					// In Hz. Timer clock (1 tick = 1us)
+#define COIL_HOLD_PERIOD			 (COIL_CLOCK / COIL_HOLD_FREQUENCY)	// In timer ticks. Period of the hold PWM
+
+#if COIL_ENABLED && FUNCPROF_ENABLED
+	#error "COIL_ENABLED moves the sensor trigger to CCU40 slice 3, which FUNCPROF_ENABLED needs"
+#endif
+typedef char coil_period_check[(COIL_HOLD_PERIOD >= 10U && COIL_PULLIN_MAX * 1000U <= 65536U) ? 1 : -1];
+
+uint8_t coil_pullin_time = COIL_PULLIN_TIME;
+uint8_t coil_hold_duty = COIL_HOLD_DUTY;
+uint16_t coil_pullin_period = 0;	// In timer ticks. Period value of the pull-in (ticks - 1)
+uint16_t coil_hold_compare = 0;		// Compare value of the hold PWM (COIL_HOLD_PERIOD - high ticks)
+uint8_t coil_prescaler = 0;			// Prescaler giving COIL_CLOCK at the full CCU4 clock (0 = not initialized, plain output)
+
+
+//****************************************************************************
+// coil_init - sets up the PWM slice of the relay pin (CCU40 must be initialized, the module clock must be 2^n MHz)
+//****************************************************************************
+bool coil_init(void){
+#if COIL_ENABLED
+	// Prescaler that divides the module clock exactly to COIL_CLOCK (like hrtimer_init)
+	uint32_t prescaler = (uint32_t)XMC_CCU4_SLICE_PRESCALER_1;
+	while((GLOBAL_CCU4_0.module_frequency >> prescaler) > COIL_CLOCK && prescaler < (uint32_t)XMC_CCU4_SLICE_PRESCALER_32768)
+		prescaler++;
+	if((GLOBAL_CCU4_0.module_frequency >> prescaler) != COIL_CLOCK || (GLOBAL_CCU4_0.module_frequency & ((1UL << prescaler) - 1U)) != 0)
+		return false;
+
+	// Timer: edge aligned and repeating, the output is low while passive (stopped at the pin mode switch anyway)
+	XMC_CCU4_SLICE_COMPARE_CONFIG_t timer_config = {
+		.timer_mode = (uint32_t)XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+		.monoshot = (uint32_t)XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+		.passive_level = (uint32_t)XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_LOW,
+		.prescaler_initval = prescaler
+	};
+	XMC_CCU4_SLICE_CompareInit(COIL_SLICE, &timer_config);
+	XMC_CCU4_EnableClock(CCU40, COIL_SLICE_NUMBER);
+	if(!coil_configure(coil_pullin_time, coil_hold_duty))
+		return false;
+	coil_prescaler = (uint8_t)prescaler;
+	return true;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// coil_configure - sets pull-in time (ms) and hold duty (%) for the next switch on. Returns false if out of range
+//****************************************************************************
+bool coil_configure(uint8_t pullin_time, uint8_t hold_duty){
+	if(pullin_time == 0 || pullin_time > COIL_PULLIN_MAX || hold_duty == 0 || hold_duty > 100U)
+		return false;
+
+	uint16_t period = (uint16_t)((uint32_t)pullin_time * (COIL_CLOCK / 1000U) - 1U);
+	uint16_t compare = (uint16_t)(COIL_HOLD_PERIOD - (COIL_HOLD_PERIOD * hold_duty + 50U) / 100U);
+	critical_state_t primask = critical_enter();
+	coil_pullin_time = pullin_time;
+	coil_hold_duty = hold_duty;
+	coil_pullin_period = period;
+	coil_hold_compare = compare;
+	critical_exit(primask, CRITICAL_SITE_COIL);
+	return true;
+}
+
+//****************************************************************************
+// coil_set - switches the relay coil: pull-in then hold PWM (on) or a plain low output (off)
+//****************************************************************************
+RAMCODE
+void coil_set(bool on){
+	if(coil_prescaler == 0){
+		// Not initialized (or COIL_ENABLED 0): the pin stays a DIGITAL_IO output
+		if(on)
+			PINS_SET_HIGH(IO_RELAY);
+		else
+			PINS_SET_LOW(IO_RELAY);
+		return;
+	}
+
+	PINS_SET_LOW(IO_RELAY);
+	PINS_SET_MODE(IO_RELAY, XMC_GPIO_MODE_OUTPUT_PUSH_PULL);
+	XMC_CCU4_SLICE_StopTimer(COIL_SLICE);
+	XMC_CCU4_SLICE_ClearTimer(COIL_SLICE);
+	if(!on)
+		return;
+
+	// Pull-in: the stopped slice takes the values over immediately
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(COIL_SLICE, coil_pullin_period);
+	XMC_CCU4_SLICE_SetTimerCompareMatch(COIL_SLICE, 0U);
+	XMC_CCU4_EnableShadowTransfer(CCU40, COIL_SHADOW);
+	XMC_CCU4_SLICE_StartTimer(COIL_SLICE);
+	PINS_SET_MODE(IO_RELAY, COIL_PIN_MODE);
+	// Hold: transferred by the period match at the end of the pull-in
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(COIL_SLICE, (uint16_t)(COIL_HOLD_PERIOD - 1U));
+	XMC_CCU4_SLICE_SetTimerCompareMatch(COIL_SLICE, coil_hold_compare);
+	XMC_CCU4_EnableShadowTransfer(CCU40, COIL_SHADOW);
+}
+
+//****************************************************************************
+// coil_set_clock_shift - keeps the timer clock when the CCU4 clock was divided by 2^shift (false = not possible)
+//****************************************************************************
+bool coil_set_clock_shift(uint8_t shift){
+	if(coil_prescaler == 0)
+		return true;
+	if(shift > coil_prescaler)
+		return false;
+
+	// The prescaler can only be written with the timer stopped, a running pull-in or hold continues where it stopped
+	bool running = XMC_CCU4_SLICE_IsTimerRunning(COIL_SLICE);
+	XMC_CCU4_SLICE_StopTimer(COIL_SLICE);
+	XMC_CCU4_SLICE_SetPrescaler(COIL_SLICE, (XMC_CCU4_SLICE_PRESCALER_t)(coil_prescaler - shift));
+	if(running)
+		XMC_CCU4_SLICE_StartTimer(COIL_SLICE);
+	return true;
+}
@@ -0,0 +1,36 @@
+/*
+ * USB-Changer coil.h
+ *
+ * Relay coil economiser. While the relay is on, its driver pin (IO_RELAY, P0.7) is routed to CCU40.OUT1 and the coil
+ * gets full drive for COIL_PULLIN_TIME, then a PWM of coil_hold_duty at COIL_HOLD_FREQUENCY. A held armature needs
+ * only a fraction of the pull-in current, so the coil power drops roughly by the hold duty. Both phases are loaded into
+ * CCU40 slice 1 at the switch (the pull-in period directly, the hold period into the shadow registers), the shadow
+ * transfer at the end of the pull-in starts the hold without an interrupt. Off returns the pin to a plain low output.
+ * The sensor trigger moves to slice 3 then (see sensor.c), so FUNCPROF_ENABLED builds need COIL_ENABLED 0.
+ * The hold duty must stay above the drop-out voltage of the relay at the lowest supply (see the data sheet of the
+ * relay, the driver needs a freewheeling diode for the PWM).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef COIL_H
+#define COIL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define COIL_ENABLED				 0							// Determines if IO_RELAY is driven by the economiser (0 = plain DIGITAL_IO output, the driver needs a freewheeling diode for 1)
+#define COIL_PULLIN_TIME			 30							// In ms. Default coil_pullin_time, full drive after switching on (1 to COIL_PULLIN_MAX)
+#define COIL_PULLIN_MAX				 65							// In ms. Longest pull-in time (16 bit period at the 1MHz timer clock)
+#define COIL_HOLD_DUTY				 50							// In %. Default coil_hold_duty (1 to 100, 100 = full drive, no economiser)
+#define COIL_HOLD_FREQUENCY			 20000U						// In Hz. Frequency of the hold PWM (above the audible range)
+
+extern uint8_t coil_pullin_time;	// In ms. Pull-in time of the next switch on (coil_configure)
+extern uint8_t coil_hold_duty;		// In %. Hold duty of the next switch on (coil_configure)
+
+bool coil_init(void);
+bool coil_configure(uint8_t pullin_time, uint8_t hold_duty);
+void coil_set(bool on);
+bool coil_set_clock_shift(uint8_t shift);
+
+#endif /* COIL_H */
@@ -0,0 +1,282 @@
+/*
+ * USB-Changer container.c
+ *
+ * Fixed capacity containers (see container.h): pool, free list and deadline heap, and the boot time benchmark.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "container.h"
+#include "critical.h"
+#include "ramcode.h"
+#include "profiler.h"
+
+#define CONTAINER_DEBRUIJN			 0x077CB531U				// De Bruijn sequence B(2,5), the top 5 bits of (bit * it) are unique per bit
+
+// Bit number of the product of an isolated bit and CONTAINER_DEBRUIJN (by its top 5 bits)
+const uint8_t container_debruijn_bits[32] = {
+	0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+	31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+
+container_stat_t container_bench_results[CONTAINER_OP_COUNT];
+bool container_bench_done = false;
+
+
+//****************************************************************************
+// pool_init - marks the first slots (1..32) of a pool as free
+//****************************************************************************
+void pool_init(pool_t *pool, uint8_t slots){
+	pool->free = (slots >= 32U) ? 0xFFFFFFFFU : ((1U << slots) - 1U);
+}
+
+//****************************************************************************
+// pool_alloc - takes the lowest free slot (any context). Returns POOL_NONE if all are taken
+//****************************************************************************
+RAMCODE
+uint8_t pool_alloc(pool_t *pool){
+	critical_state_t primask = critical_enter();
+	uint32_t free = pool->free;
+	if(free == 0){
+		critical_exit(primask, CRITICAL_SITE_CONTAINER);
+		return POOL_NONE;
+	}
+	uint32_t bit = free & (0U - free); // Lowest set bit
+	pool->free = free & ~bit;
+	critical_exit(primask, CRITICAL_SITE_CONTAINER);
+	return container_debruijn_bits[(bit * CONTAINER_DEBRUIJN) >> 27];
+}
+
+//****************************************************************************
+// pool_free - gives a slot taken by pool_alloc back (any context)
+//****************************************************************************
+RAMCODE
+void pool_free(pool_t *pool, uint8_t slot){
+	critical_state_t primask = critical_enter();
+	pool->free |= 1U << slot;
+	critical_exit(primask, CRITICAL_SITE_CONTAINER);
+}
+
+//****************************************************************************
+// freelist_init - links all entries (at most 254) of next into the free list
+//****************************************************************************
+void freelist_init(freelist_t *list, uint8_t *next, uint8_t capacity){
+	list->next = next;
+	list->capacity = capacity;
+	for(uint8_t i = 0; i < capacity; i++)
+		next[i] = (uint8_t)(i + 1U);
+	if(capacity != 0)
+		next[capacity - 1U] = FREELIST_END;
+	list->head = (capacity != 0) ? 0 : FREELIST_END;
+}
+
+//****************************************************************************
+// freelist_alloc - takes the first free entry (any context). Returns FREELIST_END if all are taken
+//****************************************************************************
+RAMCODE
+uint8_t freelist_alloc(freelist_t *list){
+	critical_state_t primask = critical_enter();
+	uint8_t entry = list->head;
+	if(entry != FREELIST_END)
+		list->head = list->next[entry];
+	critical_exit(primask, CRITICAL_SITE_CONTAINER);
+	return entry;
+}
+
+//****************************************************************************
+// freelist_free - gives an entry taken by freelist_alloc back (any context, it is taken first again)
+//****************************************************************************
+RAMCODE
+void freelist_free(freelist_t *list, uint8_t entry){
+	critical_state_t primask = critical_enter();
+	list->next[entry] = list->head;
+	list->head = entry;
+	critical_exit(primask, CRITICAL_SITE_CONTAINER);
+}
+
+//****************************************************************************
+// heap_before - returns true if deadline a lies before deadline b (wrap safe)
+//****************************************************************************
+static inline bool heap_before(uint32_t a, uint32_t b){
+	return (int32_t)(a - b) < 0;
+}
+
+//****************************************************************************
+// heap_sift_up - moves the entry at position up to its place
+//****************************************************************************
+void heap_sift_up(heap_t *heap, uint8_t position){
+	heap_entry_t entry = heap->entries[position];
+	while(position != 0){
+		uint8_t parent = (uint8_t)((position - 1U) >> 1);
+		if(!heap_before(entry.key, heap->entries[parent].key))
+			break;
+		heap->entries[position] = heap->entries[parent];
+		position = parent;
+	}
+	heap->entries[position] = entry;
+}
+
+//****************************************************************************
+// heap_sift_down - moves the entry at position down to its place
+//****************************************************************************
+void heap_sift_down(heap_t *heap, uint8_t position){
+	heap_entry_t entry = heap->entries[position];
+	uint8_t count = heap->count;
+	while(1){
+		uint16_t child = (uint16_t)(2U * position + 1U);
+		if(child >= count)
+			break;
+		// The earlier of both children
+		if(child + 1U < count && heap_before(heap->entries[child + 1U].key, heap->entries[child].key))
+			child++;
+		if(!heap_before(heap->entries[child].key, entry.key))
+			break;
+		heap->entries[position] = heap->entries[child];
+		position = (uint8_t)child;
+	}
+	heap->entries[position] = entry;
+}
+
+//****************************************************************************
+// heap_push - adds a deadline of id. Returns false if the heap is full
+//****************************************************************************
+bool heap_push(heap_t *heap, uint32_t key, uint8_t id){
+	if(heap->count >= heap->capacity)
+		return false;
+	heap->entries[heap->count].key = key;
+	heap->entries[heap->count].id = id;
+	heap_sift_up(heap, heap->count++);
+	return true;
+}
+
+//****************************************************************************
+// heap_peek - copies the earliest deadline to entry without removing it. Returns false if the heap is empty
+//****************************************************************************
+bool heap_peek(const heap_t *heap, heap_entry_t *entry){
+	if(heap->count == 0)
+		return false;
+	*entry = heap->entries[0];
+	return true;
+}
+
+//****************************************************************************
+// heap_pop - removes the earliest deadline into entry. Returns false if the heap is empty
+//****************************************************************************
+bool heap_pop(heap_t *heap, heap_entry_t *entry){
+	if(heap->count == 0)
+		return false;
+	*entry = heap->entries[0];
+	heap->entries[0] = heap->entries[--heap->count];
+	if(heap->count != 0)
+		heap_sift_down(heap, 0);
+	return true;
+}
+
+//****************************************************************************
+// heap_remove - removes the first deadline of id found (O(n) search). Returns false if id has none
+//****************************************************************************
+bool heap_remove(heap_t *heap, uint8_t id){
+	for(uint8_t i = 0; i < heap->count; i++){
+		if(heap->entries[i].id != id)
+			continue;
+		heap->entries[i] = heap->entries[--heap->count];
+		if(i < heap->count){
+			// The moved last entry may belong above or below the removed one
+			heap_sift_up(heap, i);
+			heap_sift_down(heap, i);
+		}
+		return true;
+	}
+	return false;
+}
+
+#if CONTAINER_BENCH_ENABLED
+RING(uint32_t, 32) container_bench_ring;
+RING_CHECK(container_bench, 32);
+heap_entry_t container_bench_entries[CONTAINER_BENCH_HEAP];
+uint8_t container_bench_links[32];
+uint32_t container_bench_overhead;		// In cycles. Empty measurement, subtracted from every operation
+
+
+//****************************************************************************
+// container_bench_add - adds one measured duration (in cycles, including the timestamp overhead) to an operation
+//****************************************************************************
+void container_bench_add(container_ops op, uint32_t cycles){
+	container_stat_t *stat = &container_bench_results[op];
+	cycles = (cycles > container_bench_overhead) ? cycles - container_bench_overhead : 0;
+	if(cycles > stat->max)
+		stat->max = cycles;
+	stat->total += cycles;
+	stat->count++;
+}
+#endif
+
+//****************************************************************************
+// container_bench_run - measures every container operation CONTAINER_BENCH_OPS times (boot, interrupts enabled)
+//****************************************************************************
+void container_bench_run(void){
+#if CONTAINER_BENCH_ENABLED
+	uint32_t start;
+	uint32_t value = 0;
+	uint32_t key = 0x12345678U;
+
+	// Shortest empty measurement (an interrupt in between only makes one longer)
+	container_bench_overhead = 0xFFFFFFFFU;
+	for(uint8_t i = 0; i < 16; i++){
+		start = profiler_timestamp();
+		uint32_t cycles = profiler_timestamp() - start;
+		if(cycles < container_bench_overhead)
+			container_bench_overhead = cycles;
+	}
+
+	RING_INIT(&container_bench_ring);
+	pool_t pool;
+	pool_init(&pool, 32);
+	freelist_t list;
+	freelist_init(&list, container_bench_links, sizeof(container_bench_links));
+	heap_t heap = HEAP_INIT(container_bench_entries);
+	heap_entry_t entry;
+	for(uint8_t i = 0; i < CONTAINER_BENCH_HEAP - 1U; i++){
+		key = key * 1664525U + 1013904223U;
+		heap_push(&heap, key >> 1, i);
+	}
+
+	for(uint16_t n = 0; n < CONTAINER_BENCH_OPS; n++){
+		start = profiler_timestamp();
+		RING_PUT(&container_bench_ring, n);
+		container_bench_add(CONTAINER_RING_PUT, profiler_timestamp() - start);
+		start = profiler_timestamp();
+		RING_GET(&container_bench_ring, value);
+		container_bench_add(CONTAINER_RING_GET, profiler_timestamp() - start);
+
+		start = profiler_timestamp();
+		uint8_t slot = pool_alloc(&pool);
+		container_bench_add(CONTAINER_POOL_ALLOC, profiler_timestamp() - start);
+		start = profiler_timestamp();
+		pool_free(&pool, slot);
+		container_bench_add(CONTAINER_POOL_FREE, profiler_timestamp() - start);
+		// Every slot position once (the next alloc takes a higher one)
+		pool.free &= ~(1U << (n & 31U));
+		if((n & 31U) == 31U)
+			pool_init(&pool, 32);
+
+		start = profiler_timestamp();
+		uint8_t link = freelist_alloc(&list);
+		container_bench_add(CONTAINER_FREELIST_ALLOC, profiler_timestamp() - start);
+		start = profiler_timestamp();
+		freelist_free(&list, link);
+		container_bench_add(CONTAINER_FREELIST_FREE, profiler_timestamp() - start);
+
+		// Deadlines spread over 2^31 like timing.h allows
+		key = key * 1664525U + 1013904223U;
+		start = profiler_timestamp();
+		heap_push(&heap, key >> 1, (uint8_t)n);
+		container_bench_add(CONTAINER_HEAP_PUSH, profiler_timestamp() - start);
+		start = profiler_timestamp();
+		heap_pop(&heap, &entry);
+		container_bench_add(CONTAINER_HEAP_POP, profiler_timestamp() - start);
+	}
+	(void)value;
+	container_bench_done = true;
+#endif
+}
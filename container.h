@@ -0,0 +1,154 @@
+/*
+ * USB-Changer container.h
+ *
+ * Fixed capacity containers for the firmware. Nothing is allocated: the storage is a static array of the user, the
+ * capacity is fixed at build time.
+ *   RING		Single producer, single consumer ring (power of 2 capacity up to 32768). Free running 16 bit indices,
+ *				so all slots are used and the count is one subtraction. The producer only writes the head, the
+ *				consumer only the tail, and each side publishes its index after the slot access, so one side may be
+ *				an interrupt and neither needs a lock.
+ *   pool_t		Bitmap pool of up to 32 slots. pool_alloc takes the lowest free slot in constant time (de Bruijn
+ *				multiply, the M0 has no CLZ), alloc and free mask the interrupts for the few instructions of the
+ *				bitmap update (the M0 has no exclusive access), so both may be called from any context.
+ *   freelist_t	Indexed free list of up to 254 entries (one byte link per entry), constant time alloc and free, any
+ *				context like the pool.
+ *   heap_t		Binary min-heap of deadlines (wrap safe compare like timing.h, keys within 2^31 of each other) with a
+ *				byte id per entry, for timer queues. Push and pop are O(log n). Not locked: the caller masks the
+ *				interrupts if an interrupt uses the heap too.
+ * With CONTAINER_BENCH_ENABLED, container_bench_run measures the operations at boot (container_bench_results in
+ * cycles, "container_report" of tools/profiler_report.gdb). tools/host/test_container checks them on the host.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONTAINER_BENCH_ENABLED		 0							// Determines if the containers are measured at boot (0 removes container_bench_run)
+#define CONTAINER_BENCH_OPS			 256						// Operations measured per container operation
+#define CONTAINER_BENCH_HEAP		 16							// Entries of the measured heap (deadline queue size of the application)
+
+// Keeps the compiler from moving memory accesses across (a single core M0 needs no hardware barrier)
+#define CONTAINER_BARRIER()			 __asm volatile("" ::: "memory")
+
+
+// - Single producer, single consumer ring -
+typedef struct {
+	volatile uint16_t head;			// Next slot written by the producer (free running)
+	volatile uint16_t tail;			// Next slot read by the consumer (free running)
+} ring_index_t;
+
+// Ring type of capacity items of type (declare the variable with it, check the capacity with RING_CHECK)
+#define RING(type, capacity)		 struct { ring_index_t index; type items[capacity]; }
+#define RING_CHECK(name, capacity)	 typedef char name##_ring_check[(((capacity) & ((capacity) - 1)) == 0 && (capacity) <= 32768) ? 1 : -1]
+#define RING_CAPACITY(ring)			 ((uint16_t)(sizeof((ring)->items) / sizeof((ring)->items[0])))
+#define RING_INIT(ring)				 ((ring)->index.head = (ring)->index.tail = 0)
+#define RING_COUNT(ring)			 ring_count(&(ring)->index)
+#define RING_FREE(ring)				 ((uint16_t)(RING_CAPACITY(ring) - ring_count(&(ring)->index)))
+// Slot the producer writes next (valid while RING_FREE != 0) and slot the consumer reads next (valid while RING_COUNT != 0)
+#define RING_HEAD(ring)				 ((ring)->items[(ring)->index.head & (RING_CAPACITY(ring) - 1U)])
+#define RING_TAIL(ring)				 ((ring)->items[(ring)->index.tail & (RING_CAPACITY(ring) - 1U)])
+// Producer: writes value and publishes it. Returns false if the ring is full
+#define RING_PUT(ring, value)		 (RING_FREE(ring) != 0 ? (RING_HEAD(ring) = (value), ring_publish(&(ring)->index), true) : false)
+// Consumer: takes the oldest item into var. Returns false if the ring is empty
+#define RING_GET(ring, var)			 (RING_COUNT(ring) != 0 ? ((var) = RING_TAIL(ring), ring_release(&(ring)->index), true) : false)
+
+//****************************************************************************
+// ring_count - returns the number of items in the ring (exact for the consumer, a lower bound for the producer)
+//****************************************************************************
+static inline uint16_t ring_count(const ring_index_t *index){
+	return (uint16_t)(index->head - index->tail);
+}
+
+//****************************************************************************
+// ring_publish - hands the slot at the head to the consumer (producer, after the slot is written)
+//****************************************************************************
+static inline void ring_publish(ring_index_t *index){
+	CONTAINER_BARRIER();
+	index->head = (uint16_t)(index->head + 1U);
+}
+
+//****************************************************************************
+// ring_release - hands the slot at the tail back to the producer (consumer, after the slot is read)
+//****************************************************************************
+static inline void ring_release(ring_index_t *index){
+	CONTAINER_BARRIER();
+	index->tail = (uint16_t)(index->tail + 1U);
+}
+
+
+// - Bitmap pool -
+#define POOL_NONE					 0xFFU						// pool_alloc: no free slot
+
+typedef struct {
+	volatile uint32_t free;			// Bit n set: slot n is free
+} pool_t;
+
+void pool_init(pool_t *pool, uint8_t slots);
+uint8_t pool_alloc(pool_t *pool);
+void pool_free(pool_t *pool, uint8_t slot);
+
+
+// - Indexed free list -
+#define FREELIST_END				 0xFFU						// End of the list, freelist_alloc: no free entry
+
+typedef struct {
+	uint8_t *next;					// Link per entry (storage of the user, capacity bytes)
+	volatile uint8_t head;			// First free entry
+	uint8_t capacity;
+} freelist_t;
+
+void freelist_init(freelist_t *list, uint8_t *next, uint8_t capacity);
+uint8_t freelist_alloc(freelist_t *list);
+void freelist_free(freelist_t *list, uint8_t entry);
+
+
+// - Deadline heap -
+typedef struct {
+	uint32_t key;					// Deadline (e.g. in us, timing.h)
+	uint8_t id;						// Owner of the deadline
+} heap_entry_t;
+
+typedef struct {
+	heap_entry_t *entries;			// Storage of the user (HEAP_INIT)
+	uint8_t capacity;
+	uint8_t count;
+} heap_t;
+
+// Initialiser of a heap over the array entries
+#define HEAP_INIT(entries)			 {(entries), (uint8_t)(sizeof(entries) / sizeof((entries)[0])), 0}
+
+bool heap_push(heap_t *heap, uint32_t key, uint8_t id);
+bool heap_peek(const heap_t *heap, heap_entry_t *entry);
+bool heap_pop(heap_t *heap, heap_entry_t *entry);
+bool heap_remove(heap_t *heap, uint8_t id);
+
+
+// - Benchmark -
+typedef enum {
+	CONTAINER_RING_PUT,				// RING_PUT of a 32 bit item
+	CONTAINER_RING_GET,				// RING_GET of a 32 bit item
+	CONTAINER_POOL_ALLOC,			// pool_alloc of a 32 slot pool (any slot free)
+	CONTAINER_POOL_FREE,			// pool_free
+	CONTAINER_FREELIST_ALLOC,		// freelist_alloc
+	CONTAINER_FREELIST_FREE,		// freelist_free
+	CONTAINER_HEAP_PUSH,			// heap_push of a random deadline into a heap of CONTAINER_BENCH_HEAP - 1 entries
+	CONTAINER_HEAP_POP,				// heap_pop of a full heap
+	CONTAINER_OP_COUNT
+} container_ops;
+
+typedef struct {
+	uint32_t count;					// Number of operations
+	uint32_t max;					// In cycles. Longest operation
+	uint32_t total;					// In cycles. Sum of all operations (mean = total / count)
+} container_stat_t;
+
+extern container_stat_t container_bench_results[CONTAINER_OP_COUNT];
+extern bool container_bench_done;	// Set after a complete run
+
+void container_bench_run(void);
+
+#endif /* CONTAINER_H */
@@ -0,0 +1,65 @@
+/*
+ * USB-Changer critical.c
+ *
+ * Masked time accounting of the critical sections (see critical.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "critical.h"
+#include "ramcode.h"
+#include "metrics.h"
+
+critical_stat_t critical_stats[CRITICAL_SITE_COUNT];
+uint32_t critical_start = 0;
+uint32_t critical_max = 0;
+uint8_t critical_max_site = 0;
+uint32_t critical_over_budget = 0;
+#if CRITICAL_STATS_ENABLED
+METRICS_REGISTER(critical_max, METRICS_ID_CRITICAL_MAX, METRICS_TYPE_U32, METRICS_UNIT_CYCLES, critical_max);
+METRICS_REGISTER(critical_over_budget, METRICS_ID_CRITICAL_OVER_BUDGET, METRICS_TYPE_U32, METRICS_UNIT_COUNT, critical_over_budget);
+#endif
+
+
+//****************************************************************************
+// critical_cycles - returns the cycle count (SYSTIMER, also correct across tickless periods and clock scaling)
+//****************************************************************************
+RAMCODE
+uint32_t critical_cycles(void){
+	return SYSTIMER_GetCycles();
+}
+
+//****************************************************************************
+// critical_record - adds the masked time of the ending outermost section to its site (interrupts still masked)
+//****************************************************************************
+RAMCODE
+void critical_record(critical_sites site){
+	uint32_t cycles = critical_cycles() - critical_start;
+	critical_stat_t *stat = &critical_stats[site];
+
+	stat->count++;
+	stat->total += cycles;
+	if(cycles > stat->max)
+		stat->max = cycles;
+	if(cycles > critical_max){
+		critical_max = cycles;
+		critical_max_site = (uint8_t)site;
+	}
+	if(cycles > CRITICAL_BUDGET)
+		critical_over_budget++;
+}
+
+//****************************************************************************
+// critical_reset - clears the statistics (e.g. before a measurement run)
+//****************************************************************************
+void critical_reset(void){
+	critical_state_t state = critical_enter();
+	for(uint8_t i = 0; i < CRITICAL_SITE_COUNT; i++)
+		critical_stats[i] = (critical_stat_t){0};
+	critical_max = 0;
+	critical_max_site = 0;
+	critical_over_budget = 0;
+	// The reset section itself is not recorded into the cleared statistics
+	__set_PRIMASK(state);
+}
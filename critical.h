@@ -0,0 +1,98 @@
+/*
+ * USB-Changer critical.h
+ *
+ * Critical sections for data shared between interrupt handlers and the main loop. critical_enter saves PRIMASK and
+ * masks all interrupts, critical_exit restores the saved state, so sections nest and may be used in any context. The
+ * XMC1100 has no BASEPRI: a section masks every tier (irqprio.h), so it must only copy or update a few words. Every
+ * masked cycle adds to the entry latency of the ADC result interrupt.
+ * Each section names its call site. With CRITICAL_STATS_ENABLED, the outermost section (PRIMASK clear at the entry)
+ * records its masked time in cycles of SYSTIMER_SYSTICK_CLOCK per site in critical_stats: count, longest and
+ * total. Sections longer than CRITICAL_BUDGET are counted in critical_over_budget and the longest one overall in
+ * critical_max, so a change that masks for too long is noticed (metrics, "critical_report" of
+ * tools/profiler_report.gdb). The measurement adds about 100 cycles per section (two SYSTIMER_GetCycles), part of which
+ * is included in the recorded time.
+ * Not covered: the sections inside SYSTIMER (they count where they nest in an instrumented section), the profilers
+ * and the sleep of wait_for_event (which only masks the wake-up check, WFI still ends on a pending interrupt).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef CRITICAL_H
+#define CRITICAL_H
+
+#include <stdint.h>
+#include "xmc_common.h"
+
+#define CRITICAL_STATS_ENABLED		 0							// Determines if the masked time of the sections is measured (0 removes the accounting)
+#define CRITICAL_BUDGET				 320						// In cycles. Longest masked time of a section (10us at 32MHz), longer ones are counted in critical_over_budget
+
+typedef enum {
+	CRITICAL_SITE_EVENTS,			// post_event, take_events and the relay follow-up flags (main.c)
+	CRITICAL_SITE_SETTINGS,			// Threshold profile and host command settings (main.c)
+	CRITICAL_SITE_LOG,				// log_record
+	CRITICAL_SITE_TRACE,			// trace_record
+	CRITICAL_SITE_SENSOR,			// sensor_request_conversion and the governor rate
+	CRITICAL_SITE_DIVIDE,			// Divider operand writes and result reads (divide.c)
+	CRITICAL_SITE_LEDPATTERN,		// Status LED pattern stack (ledpattern.c)
+	CRITICAL_SITE_COIL,				// coil_configure
+	CRITICAL_SITE_RELAYTIME,		// Relay drive edge and statistics (relaytime.c)
+	CRITICAL_SITE_CLOCKSCALE,		// MCLK change with all timer users (clockscale_set)
+	CRITICAL_SITE_RETAIN,			// Channel copy of the warm reset state (retain.c)
+	CRITICAL_SITE_EVBUS,			// Event bus queue (evbus.c)
+	CRITICAL_SITE_CONTAINER,		// Pool and free list updates (container.c)
+	CRITICAL_SITE_SOFTPWM,			// Edge list hand over to the frame interrupt (softpwm.c)
+	CRITICAL_SITE_I2CMASTER,		// Transfer queue and start of the next transfer (i2cmaster.c)
+	CRITICAL_SITE_HRTIMER,			// Request mailbox taken over by the slice interrupt (hrtimer.c)
+	CRITICAL_SITE_BISTABLE,			// Target and pulse state of the latching relay (bistable.c)
+	CRITICAL_SITE_ADC_POLL,			// Result handling of the polling main loop (SENSOR_POLLED, main.c)
+	CRITICAL_SITE_EXPANDER,			// Shadow image of the shift register outputs (expander.c)
+	CRITICAL_SITE_TIMEBASE,			// Upper word of the 64 bit time (timebase.c)
+	CRITICAL_SITE_ZEROCROSS,		// Scheduled relay change of the zero cross synchronisation (zerocross.c)
+	CRITICAL_SITE_COUNT
+} critical_sites;
+
+typedef struct {
+	uint32_t count;					// Number of measured sections
+	uint32_t max;					// In cycles. Longest masked time
+	uint64_t total;					// In cycles. Sum of the masked times
+} critical_stat_t;
+
+typedef uint32_t critical_state_t;	// PRIMASK before the section
+
+extern critical_stat_t critical_stats[CRITICAL_SITE_COUNT];
+extern uint32_t critical_start;			// Cycle count at the entry of the running outermost section
+extern uint32_t critical_max;			// In cycles. Longest masked time of all sites
+extern uint8_t critical_max_site;		// critical_sites of critical_max
+extern uint32_t critical_over_budget;	// Sections longer than CRITICAL_BUDGET
+
+uint32_t critical_cycles(void);
+void critical_record(critical_sites site);
+void critical_reset(void);
+
+//****************************************************************************
+// critical_enter - masks all interrupts. Returns the state critical_exit restores
+//****************************************************************************
+static inline critical_state_t critical_enter(void){
+	critical_state_t primask = __get_PRIMASK();
+	__disable_irq();
+#if CRITICAL_STATS_ENABLED
+	if(primask == 0U)
+		critical_start = critical_cycles();
+#endif
+	return primask;
+}
+
+//****************************************************************************
+// critical_exit - ends the section of site: restores the interrupt state saved by critical_enter
+//****************************************************************************
+static inline void critical_exit(critical_state_t primask, critical_sites site){
+#if CRITICAL_STATS_ENABLED
+	if(primask == 0U)
+		critical_record(site);
+#else
+	(void)site;
+#endif
+	__set_PRIMASK(primask);
+}
+
+#endif /* CRITICAL_H */
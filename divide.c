@@ -0,0 +1,108 @@
+/*
+ * USB-Changer divide.c
+ *
+ * Integer division backends (see divide.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "divide.h"
+#include "critical.h"
+#if defined(MATH)
+	#include "xmc_math.h"
+#endif
+
+
+//****************************************************************************
+// divide_init - enables the clock of the MATH coprocessor (nothing to do without one)
+//****************************************************************************
+void divide_init(void){
+#if defined(MATH)
+	XMC_MATH_Enable();
+#endif
+}
+
+//****************************************************************************
+// divide_reciprocal_init - computes the reciprocal of a divisor (1 to 2^32-1) known only at run time (one 64 bit division)
+//****************************************************************************
+void divide_reciprocal_init(divide_reciprocal_t *reciprocal, uint32_t divisor){
+	uint8_t log2 = 0;
+	while(log2 < 32U && (1ULL << log2) < divisor)
+		log2++;
+	reciprocal->divisor = divisor;
+	reciprocal->multiplier = (uint32_t)((((1ULL << log2) - divisor) << 32) / divisor + 1U);
+	reciprocal->shift1 = (log2 > 0U) ? 1U : 0U;
+	reciprocal->shift2 = (log2 > 0U) ? (uint8_t)(log2 - 1U) : 0U;
+}
+
+//****************************************************************************
+// divide_start_u32 - starts dividend / divisor, the quotient is read by divide_finish_u32
+//****************************************************************************
+void divide_start_u32(divide_job_t *job, uint32_t dividend, uint32_t divisor){
+	job->dividend = dividend;
+	job->divisor = divisor;
+	job->is_signed = false;
+#if defined(MATH)
+	critical_state_t primask = critical_enter();
+	XMC_MATH_DIV_UnsignedDivNB(dividend, divisor);
+	critical_exit(primask, CRITICAL_SITE_DIVIDE);
+#endif
+}
+
+//****************************************************************************
+// divide_start_s32 - starts dividend / divisor, the quotient is read by divide_finish_s32
+//****************************************************************************
+void divide_start_s32(divide_job_t *job, int32_t dividend, int32_t divisor){
+	job->dividend = (uint32_t)dividend;
+	job->divisor = (uint32_t)divisor;
+	job->is_signed = true;
+#if defined(MATH)
+	critical_state_t primask = critical_enter();
+	XMC_MATH_DIV_SignedDivNB(dividend, divisor);
+	critical_exit(primask, CRITICAL_SITE_DIVIDE);
+#endif
+}
+
+#if defined(MATH)
+//****************************************************************************
+// divide_result - returns the quotient of the divider if it still holds the operands of job, otherwise divides again
+//****************************************************************************
+static uint32_t divide_result(const divide_job_t *job){
+	critical_state_t primask = critical_enter();
+	bool own = MATH->DVD == job->dividend && MATH->DVS == job->divisor
+			&& ((MATH->DIVCON & MATH_DIVCON_USIGN_Msk) == 0U) == job->is_signed;
+	uint32_t quotient = MATH->QUOT;
+	critical_exit(primask, CRITICAL_SITE_DIVIDE);
+	// Only the register reads are masked, the repeated division runs with interrupts enabled
+	if(!own)
+		quotient = job->is_signed ? (uint32_t)((int32_t)job->dividend / (int32_t)job->divisor) : job->dividend / job->divisor;
+	return quotient;
+}
+#endif
+
+//****************************************************************************
+// divide_finish_u32 - returns the quotient of the division started by divide_start_u32
+//****************************************************************************
+uint32_t divide_finish_u32(const divide_job_t *job){
+#if defined(MATH)
+	return divide_result(job);
+#else
+	return job->dividend / job->divisor;
+#endif
+}
+
+//****************************************************************************
+// divide_finish_s32 - returns the quotient of the division started by divide_start_s32
+//****************************************************************************
+int32_t divide_finish_s32(const divide_job_t *job){
+#if defined(MATH)
+	return (int32_t)divide_result(job);
+#else
+	// From the magnitudes: the unsigned library division is linked anyway, the signed one is not needed
+	uint32_t dividend = ((int32_t)job->dividend < 0) ? 0U - job->dividend : job->dividend;
+	uint32_t divisor = ((int32_t)job->divisor < 0) ? 0U - job->divisor : job->divisor;
+	uint32_t quotient = dividend / divisor;
+	return (int32_t)((((job->dividend ^ job->divisor) & 0x80000000U) != 0U) ? 0U - quotient : quotient);
+#endif
+}
@@ -0,0 +1,76 @@
+/*
+ * USB-Changer divide.h
+ *
+ * Integer division backends. The XMC1100 has no divider, a "/" costs a libgcc __aeabi_uidiv call of up to ~100 cycles.
+ * A divisor that is used more than once (constants like TIMING_US_PER_MS or a divisor fixed at configuration time) is
+ * turned into a reciprocal once (DIVIDE_RECIPROCAL at compile time, divide_reciprocal_init at run time) and every
+ * division by it is then 4 single cycle multiplications (divide_by_reciprocal, exact for all 32 bit dividends).
+ * The multiplications also beat the 35 cycle divider of the MATH coprocessor (XMC1300/XMC1400, MATH defined by the
+ * device header), which xmc_math.c already uses for every "/". For a divisor used once, divide_start_* starts the
+ * divider without waiting, so the caller can do other work until divide_finish_* reads the quotient. The divider is
+ * shared with the "/" of the interrupts, so divide_finish_* checks that the operands are still its own and divides
+ * again otherwise. Without MATH divide_start_* only stores the operands. The CORDIC unit is not used (no trigonometry in this firmware).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef DIVIDE_H
+#define DIVIDE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Number of powers of 2 below d (ceil(log2 d)), constant folded for a constant d
+#define DIVIDE_GT(d, k)				 ((uint32_t)((uint64_t)(d) > (1ULL << (k))))
+#define DIVIDE_GT4(d, k)			 (DIVIDE_GT(d, k) + DIVIDE_GT(d, (k) + 1) + DIVIDE_GT(d, (k) + 2) + DIVIDE_GT(d, (k) + 3))
+#define DIVIDE_CEIL_LOG2(d)			 (DIVIDE_GT4(d, 0) + DIVIDE_GT4(d, 4) + DIVIDE_GT4(d, 8) + DIVIDE_GT4(d, 12) \
+									 + DIVIDE_GT4(d, 16) + DIVIDE_GT4(d, 20) + DIVIDE_GT4(d, 24) + DIVIDE_GT4(d, 28))
+
+// Initializer of a divide_reciprocal_t for the constant divisor d (1 to 2^32-1)
+#define DIVIDE_RECIPROCAL(d)		 { \
+		.divisor = (d), \
+		.multiplier = (uint32_t)((((1ULL << DIVIDE_CEIL_LOG2(d)) - (d)) << 32) / (d) + 1U), \
+		.shift1 = (uint8_t)((DIVIDE_CEIL_LOG2(d) > 0U) ? 1U : 0U), \
+		.shift2 = (uint8_t)((DIVIDE_CEIL_LOG2(d) > 0U) ? DIVIDE_CEIL_LOG2(d) - 1U : 0U) }
+
+typedef struct {
+	uint32_t divisor;
+	uint32_t multiplier;				// 2^32 * (2^l - divisor) / divisor + 1 with l = ceil(log2 divisor)
+	uint8_t shift1;						// min(l, 1)
+	uint8_t shift2;						// max(l - 1, 0)
+} divide_reciprocal_t;
+
+typedef struct {
+	uint32_t dividend;
+	uint32_t divisor;
+	bool is_signed;
+} divide_job_t;
+
+void divide_init(void);
+void divide_reciprocal_init(divide_reciprocal_t *reciprocal, uint32_t divisor);
+void divide_start_u32(divide_job_t *job, uint32_t dividend, uint32_t divisor);
+void divide_start_s32(divide_job_t *job, int32_t dividend, int32_t divisor);
+uint32_t divide_finish_u32(const divide_job_t *job);
+int32_t divide_finish_s32(const divide_job_t *job);
+
+//****************************************************************************
+// divide_mulhi - returns the upper 32 bits of a * b (the M0 only multiplies 32 x 32 -> 32 bits)
+//****************************************************************************
+static inline uint32_t divide_mulhi(uint32_t a, uint32_t b){
+	uint32_t a_low = a & 0xFFFFU, a_high = a >> 16;
+	uint32_t b_low = b & 0xFFFFU, b_high = b >> 16;
+	uint32_t high_low = a_high * b_low;
+	// At most 0xFFFF + 0xFFFF + 0xFFFE0001, no carry is lost
+	uint32_t middle = ((a_low * b_low) >> 16) + (high_low & 0xFFFFU) + a_low * b_high;
+	return a_high * b_high + (high_low >> 16) + (middle >> 16);
+}
+
+//****************************************************************************
+// divide_by_reciprocal - returns dividend / divisor of the reciprocal (rounded towards zero like "/")
+//****************************************************************************
+static inline uint32_t divide_by_reciprocal(const divide_reciprocal_t *reciprocal, uint32_t dividend){
+	uint32_t high = divide_mulhi(reciprocal->multiplier, dividend);
+	return (high + ((dividend - high) >> reciprocal->shift1)) >> reciprocal->shift2;
+}
+
+#endif /* DIVIDE_H */
@@ -0,0 +1,153 @@
+/*
+ * USB-Changer eebench.c
+ *
+ * Emulated EEPROM benchmark (see eebench.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "eebench.h"
+#include "profiler.h"
+#include "settings.h"
+#include "calib.h"
+
+eebench_result_t eebench_results[EEBENCH_PATTERN_COUNT];
+bool eebench_done = false;
+
+#if EEBENCH_ENABLED
+uint8_t eebench_settings[SETTINGS_RECORD_SIZE];		// Settings record written by the patterns
+uint8_t eebench_calibration[CALIB_STORAGE_SIZE];	// Written calibration table
+uint8_t eebench_read[CALIB_STORAGE_SIZE];			// Read back buffer
+
+
+//****************************************************************************
+// eebench_add - adds one measured duration (in cycles) to an operation
+//****************************************************************************
+void eebench_add(eebench_stat_t *stat, uint32_t cycles){
+	if(cycles > stat->max)
+		stat->max = cycles;
+	stat->total += cycles;
+	stat->count++;
+}
+
+//****************************************************************************
+// eebench_save - reads the current content of a block. Returns false if the block holds no valid data
+//****************************************************************************
+bool eebench_save(uint8_t block_number, uint8_t *data, uint32_t size){
+	return E_EEPROM_XMC1_Read(block_number, 0U, data, size) == E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// eebench_restore - writes the saved content back or invalidates the block if it held none
+//****************************************************************************
+void eebench_restore(uint8_t block_number, uint8_t *data, bool valid){
+	if(E_EEPROM_XMC1_IsGarbageCollectionNeeded(block_number))
+		E_EEPROM_XMC1_StartGarbageCollection();
+	if(valid)
+		E_EEPROM_XMC1_Write(block_number, data);
+	else
+		E_EEPROM_XMC1_InvalidateBlock(block_number);
+}
+
+//****************************************************************************
+// eebench_write - writes a block like storage_flush (a full bank is collected in steps first) and reads it back
+//****************************************************************************
+void eebench_write(eebench_result_t *result, uint8_t block_number, uint8_t *data, uint32_t size){
+	uint32_t start;
+	if(E_EEPROM_XMC1_IsGarbageCollectionNeeded(block_number)){
+		E_EEPROM_XMC1_RequestGarbageCollection();
+		while(E_EEPROM_XMC1_IsGarbageCollectionRunning()){
+			start = profiler_timestamp();
+			E_EEPROM_XMC1_OPERATION_STATUS_t status = E_EEPROM_XMC1_StepGarbageCollection();
+			eebench_add(&result->ops[EEBENCH_GC_STEP], profiler_timestamp() - start);
+			if(status != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS){
+				result->failures++;
+				break;
+			}
+		}
+	}
+
+	start = profiler_timestamp();
+	E_EEPROM_XMC1_OPERATION_STATUS_t status = E_EEPROM_XMC1_Write(block_number, data);
+	uint32_t cycles = profiler_timestamp() - start;
+	eebench_add(&result->ops[EEBENCH_WRITE], cycles);
+	if(status != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		result->failures++;
+	// No room for another copy of the block: this was the last write before the bank swap
+	if(E_EEPROM_XMC1_IsGarbageCollectionNeeded(block_number))
+		eebench_add(&result->ops[EEBENCH_WRITE_LAST], cycles);
+
+	start = profiler_timestamp();
+	status = E_EEPROM_XMC1_Read(block_number, 0U, eebench_read, size);
+	eebench_add(&result->ops[EEBENCH_READ], profiler_timestamp() - start);
+	if(status != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		result->failures++;
+}
+
+//****************************************************************************
+// eebench_pattern - runs one write pattern followed by a full garbage collection and a remount
+//****************************************************************************
+void eebench_pattern(eebench_patterns pattern){
+	eebench_result_t *result = &eebench_results[pattern];
+	settings_record_t *record = (settings_record_t *)(void *)eebench_settings;
+	E_EEPROM_XMC1_WEAR_t wear = *E_EEPROM_XMC1_GetWearCounters();
+
+	for(uint16_t i = 0; i < EEBENCH_WRITES; i++){
+		if(pattern == EEBENCH_USB_STORM){
+			record->usb_state ^= 1U;
+			eebench_write(result, EEPROM_SETTINGS, eebench_settings, SETTINGS_RECORD_SIZE);
+		}
+		else if((i & 1U) == 0){
+			record->upper_threshold++;
+			eebench_write(result, EEPROM_SETTINGS, eebench_settings, SETTINGS_RECORD_SIZE);
+		}
+		else{
+			eebench_calibration[CALIB_STORAGE_SIZE - 1U]++;
+			eebench_write(result, EEPROM_CALIBRATION, eebench_calibration, CALIB_STORAGE_SIZE);
+		}
+	}
+
+	// Blocking garbage collection of the whole bank (what E_EEPROM_XMC1_Write does on its own in a full bank)
+	uint32_t start = profiler_timestamp();
+	if(E_EEPROM_XMC1_StartGarbageCollection() != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		result->failures++;
+	eebench_add(&result->ops[EEBENCH_GC_FULL], profiler_timestamp() - start);
+
+	const E_EEPROM_XMC1_WEAR_t *after = E_EEPROM_XMC1_GetWearCounters();
+	result->erases = (after->bank_erases[0] - wear.bank_erases[0]) + (after->bank_erases[1] - wear.bank_erases[1]);
+	result->gc_runs = after->gc_runs - wear.gc_runs;
+
+	// Mount of the banks as at boot (the counters are RAM only and kept across it)
+	wear = *after;
+	E_EEPROM_XMC1_0.runtime_ptr->state = E_EEPROM_XMC1_STATUS_UNINITIALIZED;
+	start = profiler_timestamp();
+	if(E_EEPROM_XMC1_Init(&E_EEPROM_XMC1_0) != E_EEPROM_XMC1_STATUS_SUCCESS)
+		result->failures++;
+	eebench_add(&result->ops[EEBENCH_MOUNT], profiler_timestamp() - start);
+	E_EEPROM_XMC1_SetWearCounters(&wear);
+}
+#endif
+
+//****************************************************************************
+// eebench_run - runs all patterns and restores the settings and calibration blocks (boot, before the setup is read)
+//****************************************************************************
+void eebench_run(void){
+#if EEBENCH_ENABLED
+	bool settings_valid = eebench_save(EEPROM_SETTINGS, eebench_settings, SETTINGS_RECORD_SIZE);
+	bool calibration_valid = eebench_save(EEPROM_CALIBRATION, eebench_calibration, CALIB_STORAGE_SIZE);
+	uint8_t settings[SETTINGS_RECORD_SIZE];
+	uint8_t calibration[CALIB_STORAGE_SIZE];
+	for(uint8_t i = 0; i < SETTINGS_RECORD_SIZE; i++)
+		settings[i] = eebench_settings[i];
+	for(uint8_t i = 0; i < CALIB_STORAGE_SIZE; i++)
+		calibration[i] = eebench_calibration[i];
+
+	for(uint8_t i = 0; i < EEBENCH_PATTERN_COUNT; i++)
+		eebench_pattern((eebench_patterns)i);
+
+	eebench_restore(EEPROM_SETTINGS, settings, settings_valid);
+	eebench_restore(EEPROM_CALIBRATION, calibration, calibration_valid);
+	eebench_done = true;
+#endif
+}
@@ -0,0 +1,60 @@
+/*
+ * USB-Changer eebench.h
+ *
+ * Emulated EEPROM benchmark. With EEBENCH_ENABLED eebench_run is called once at boot (before the setup is read) and
+ * drives E_EEPROM_XMC1 directly with the block sizes and write patterns of the application:
+ *   EEBENCH_USB_STORM	the whole settings record is written on every USB toggle (USB_STORE_STATE_LOG = 0)
+ *   EEBENCH_COMMIT		a setup commit: settings record and calibration table written one after the other
+ * Every write is read back. A bank filled up is collected in steps like storage_flush does, and each pattern ends with
+ * a full garbage collection and a remount, so both the incremental and the blocking variant are measured. Durations
+ * are kept in CPU cycles per operation (eebench_results), together with the bank erases and garbage collections
+ * triggered. The settings and calibration contents are restored afterwards. Read the results with a debugger
+ * ("eebench_report" of tools/profiler_report.gdb). Every run wears the flash: only enable it for a measurement build.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef EEBENCH_H
+#define EEBENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EEBENCH_ENABLED				 0							// Determines if the benchmark runs at boot (0 removes eebench_run)
+#define EEBENCH_WRITES				 200						// Number of write operations per pattern (each bank holds 48 flash blocks)
+
+typedef enum {
+	EEBENCH_USB_STORM,		// Settings record on every USB toggle
+	EEBENCH_COMMIT,			// Settings record and calibration table
+	EEBENCH_PATTERN_COUNT
+} eebench_patterns;
+
+typedef enum {
+	EEBENCH_WRITE,			// E_EEPROM_XMC1_Write of a block
+	EEBENCH_WRITE_LAST,		// Last write before the bank is full (worst case before a bank swap)
+	EEBENCH_READ,			// E_EEPROM_XMC1_Read of the block just written
+	EEBENCH_GC_STEP,		// E_EEPROM_XMC1_StepGarbageCollection (one copy or erase, as storage_flush does it)
+	EEBENCH_GC_FULL,		// E_EEPROM_XMC1_StartGarbageCollection (whole bank at once)
+	EEBENCH_MOUNT,			// E_EEPROM_XMC1_Init of the mounted banks (fast mount if the index record is valid)
+	EEBENCH_OP_COUNT
+} eebench_ops;
+
+typedef struct {
+	uint32_t count;			// Number of operations
+	uint32_t max;			// In cycles. Longest operation (maximum blocking time)
+	uint64_t total;			// In cycles. Sum of all operations (mean = total / count)
+} eebench_stat_t;
+
+typedef struct {
+	eebench_stat_t ops[EEBENCH_OP_COUNT];
+	uint32_t erases;		// Bank erases triggered by the pattern
+	uint32_t gc_runs;		// Garbage collections triggered by the pattern
+	uint32_t failures;		// Operations that did not succeed
+} eebench_result_t;
+
+extern eebench_result_t eebench_results[EEBENCH_PATTERN_COUNT];
+extern bool eebench_done;	// Set after a complete run
+
+void eebench_run(void);
+
+#endif /* EEBENCH_H */
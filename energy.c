@@ -0,0 +1,178 @@
+/*
+ * USB-Changer energy.c
+ *
+ * Estimated energy breakdown (see energy.h). The on times are kept in SysTick cycles (64 bit, no overflow) and only
+ * converted to ms and mJ by energy_update, so the 64 bit divisions run once per ENERGY_UPDATE_PERIOD.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "energy.h"
+#include "power.h"
+#include "clockscale.h"
+#include "sensor.h"
+#include "usbswitch.h"
+#include "timing.h"
+#include "pins.h"
+#include "frame.h"
+#include "metrics.h"
+
+#define ENERGY_CYCLES_PER_US		 (SYSTIMER_SYSTICK_CLOCK / 1000000U)
+#define ENERGY_CYCLES_PER_MS		 (SYSTIMER_SYSTICK_CLOCK / 1000U)
+#define ENERGY_ADC_RESULT_CYCLES	 (ENERGY_ADC_RESULT_TIME * ENERGY_CYCLES_PER_US)
+
+typedef char energy_setting_check[(ENERGY_CONSUMER_COUNT <= 256 && ENERGY_FLASH_OFF == ENERGY_SLEEP + POWER_STATE_FLASH_OFF
+		&& ENERGY_TASK_OTHER == 5) ? 1 : -1];
+
+// Profiler section of every task before ENERGY_TASK_OTHER
+const uint8_t energy_task_sections[ENERGY_TASK_OTHER] = {PROFILER_STATUS_LED, PROFILER_BUTTONS, PROFILER_RELAY, PROFILER_SETUP, PROFILER_RELAY_ISR};
+// The four slices of CCU40 (LED PWM, sensor trigger or coil, hrtimer, funcprof or sensor trigger)
+XMC_CCU4_SLICE_t *const energy_slices[4] = {CCU40_CC40, CCU40_CC41, CCU40_CC42, CCU40_CC43};
+
+uint32_t energy_current_ua[ENERGY_CONSUMER_COUNT] = {
+	ENERGY_CPU_RUN_UA, ENERGY_CPU_SCALED_UA, ENERGY_SLEEP_UA, ENERGY_FLASH_OFF_UA, ENERGY_ADC_UA,
+	ENERGY_CCU4_UA, ENERGY_FLASH_PROGRAM_UA, ENERGY_RELAY_UA, ENERGY_LED_STATUS_UA, ENERGY_LED_USB_UA
+};
+uint32_t energy_on_ms[ENERGY_CONSUMER_COUNT];
+uint32_t energy_mj[ENERGY_CONSUMER_COUNT];
+uint32_t energy_task_ms[ENERGY_TASK_COUNT];
+uint32_t energy_total_mj = 0;
+uint64_t energy_flash_cycles = 0;
+bool energy_running = false;
+uint8_t energy_selected = 0;							// Consumer of the last HOSTCMD_SETTING_ENERGY_CURRENT
+uint64_t energy_on_cycles[ENERGY_CONSUMER_COUNT];		// In cycles. Full on equivalent time per consumer
+uint64_t energy_task_cycles[ENERGY_TASK_COUNT];			// In cycles. CPU active time per task
+uint32_t energy_last_cycles;							// profiler_timestamp at the last step
+uint64_t energy_last_sleep[POWER_STATE_COUNT];			// power_stats[].cycles at the last step
+uint64_t energy_last_sections[ENERGY_TASK_OTHER];		// profiler_stats[].total at the last step
+uint64_t energy_last_flash;								// energy_flash_cycles at the last step
+uint32_t energy_last_results;							// sensor_result_count at the last step
+uint32_t energy_step_deadline;							// In us. Earliest time of the next step
+uint32_t energy_update_deadline;						// In us. Time of the next energy_update
+uint32_t energy_active_ms = 0;							// In ms. CPU active time (both clocks)
+uint32_t energy_sleep_ms = 0;							// In ms. Sleep time (both states)
+METRICS_REGISTER(energy_total_mj, METRICS_ID_ENERGY_TOTAL, METRICS_TYPE_U32, METRICS_UNIT_MJ, energy_total_mj);
+METRICS_REGISTER(energy_active_ms, METRICS_ID_ENERGY_ACTIVE_TIME, METRICS_TYPE_U32, METRICS_UNIT_MS, energy_active_ms);
+METRICS_REGISTER(energy_sleep_ms, METRICS_ID_ENERGY_SLEEP_TIME, METRICS_TYPE_U32, METRICS_UNIT_MS, energy_sleep_ms);
+
+
+//****************************************************************************
+// energy_update - converts the on times into ms and the estimated energy in mJ
+//****************************************************************************
+void energy_update(void){
+	uint32_t total = 0;
+	for(uint8_t i = 0; i < ENERGY_CONSUMER_COUNT; i++){
+		// us * uA = pC, in nC * mV = pJ (no overflow for years at the largest currents)
+		uint64_t charge = energy_on_cycles[i] / ENERGY_CYCLES_PER_US * energy_current_ua[i] / 1000U;
+		energy_mj[i] = (uint32_t)(charge * ENERGY_SUPPLY_MV / 1000000000U);
+		energy_on_ms[i] = (uint32_t)(energy_on_cycles[i] / ENERGY_CYCLES_PER_MS);
+		total += energy_mj[i];
+	}
+	energy_total_mj = total;
+	for(uint8_t i = 0; i < ENERGY_TASK_COUNT; i++)
+		energy_task_ms[i] = (uint32_t)(energy_task_cycles[i] / ENERGY_CYCLES_PER_MS);
+	energy_active_ms = energy_on_ms[ENERGY_CPU_RUN] + energy_on_ms[ENERGY_CPU_SCALED];
+	energy_sleep_ms = energy_on_ms[ENERGY_SLEEP] + energy_on_ms[ENERGY_FLASH_OFF];
+}
+
+//****************************************************************************
+// energy_init - starts the accounting at the current counts (after sensor_init and power_init)
+//****************************************************************************
+void energy_init(void){
+#if ENERGY_ENABLED
+	energy_last_cycles = profiler_timestamp();
+	for(uint8_t i = 0; i < POWER_STATE_COUNT; i++)
+		energy_last_sleep[i] = power_stats[i].cycles;
+#if PROFILER_ENABLED
+	for(uint8_t i = 0; i < ENERGY_TASK_OTHER; i++)
+		energy_last_sections[i] = profiler_stats[energy_task_sections[i]].total;
+#endif
+	energy_last_flash = energy_flash_cycles;
+	energy_last_results = sensor_result_count;
+	uint32_t now = SYSTIMER_GetTime();
+	energy_step_deadline = now;
+	energy_update_deadline = timing_deadline(now, ENERGY_UPDATE_PERIOD);
+	energy_running = true;
+#endif
+}
+
+//****************************************************************************
+// energy_step - adds the time since the last step to the consumers if ENERGY_STEP_PERIOD passed (idle passes of the main loop)
+//****************************************************************************
+void energy_step(const frame_t *frame){
+	uint32_t now = frame->now;
+	if(!ENERGY_ENABLED || !energy_running || !timing_reached(now, energy_step_deadline))
+		return;
+	energy_step_deadline = timing_deadline(now, ENERGY_STEP_PERIOD);
+
+	// Elapsed time (an idle pass at least every 134s keeps it below the wrap)
+	uint32_t cycles = profiler_timestamp();
+	uint32_t elapsed = cycles - energy_last_cycles;
+	energy_last_cycles = cycles;
+
+	// Sleep states and the CPU active time, by the clock in use now
+	uint64_t sleep = 0;
+	for(uint8_t i = 0; i < POWER_STATE_COUNT; i++){
+		uint64_t slept = power_stats[i].cycles - energy_last_sleep[i];
+		energy_last_sleep[i] = power_stats[i].cycles;
+		energy_on_cycles[ENERGY_SLEEP + i] += slept;
+		sleep += slept;
+	}
+	uint32_t active = (elapsed > sleep) ? elapsed - (uint32_t)sleep : 0;
+	energy_on_cycles[(clockscale_get_shift() != 0) ? ENERGY_CPU_SCALED : ENERGY_CPU_RUN] += active;
+
+	// Active time per task (a profiler_reset restarts the totals)
+	uint32_t profiled = 0;
+#if PROFILER_ENABLED
+	for(uint8_t i = 0; i < ENERGY_TASK_OTHER; i++){
+		uint64_t total = profiler_stats[energy_task_sections[i]].total;
+		uint64_t delta = (total >= energy_last_sections[i]) ? total - energy_last_sections[i] : total;
+		energy_last_sections[i] = total;
+		energy_task_cycles[i] += delta;
+		profiled += (uint32_t)delta;
+	}
+#endif
+	energy_task_cycles[ENERGY_TASK_OTHER] += (active > profiled) ? active - profiled : 0;
+
+	// Peripherals
+	uint32_t results = sensor_result_count;
+	energy_on_cycles[ENERGY_ADC] += (uint64_t)(results - energy_last_results) * ENERGY_ADC_RESULT_CYCLES;
+	energy_last_results = results;
+	for(uint8_t i = 0; i < 4U; i++){
+		if(XMC_CCU4_SLICE_IsTimerRunning(energy_slices[i]))
+			energy_on_cycles[ENERGY_CCU4] += elapsed;
+	}
+	energy_on_cycles[ENERGY_FLASH_PROGRAM] += energy_flash_cycles - energy_last_flash;
+	energy_last_flash = energy_flash_cycles;
+
+	// Outputs (pin levels of the pass, the status LED by its compare value, both scaled alike by clockscale)
+	if(pins_get_input(&frame->inputs, &IO_RELAY) != 0)
+		energy_on_cycles[ENERGY_RELAY] += elapsed;
+	for(uint8_t i = 0; i < USB_PORT_COUNT; i++){
+		if((pins_get_input(&frame->inputs, usb_ports[i].led) != 0) != USB_LED_ACTIVE_LOW)
+			energy_on_cycles[ENERGY_LED_USB] += elapsed;
+	}
+	const XMC_CCU4_SLICE_t *led = PWM_CCU4_LED_STATUS.ccu4_slice_ptr;
+	energy_on_cycles[ENERGY_LED_STATUS] += (uint64_t)elapsed * led->CR / (led->PR + 1U);
+
+	if(timing_reached(now, energy_update_deadline)){
+		energy_update_deadline = timing_deadline(now, ENERGY_UPDATE_PERIOD);
+		energy_update();
+	}
+}
+
+//****************************************************************************
+// energy_set_current - sets the current of a consumer (HOSTCMD_SETTING_ENERGY_CURRENT: consumer << ENERGY_SETTING_SHIFT | uA, checked)
+//****************************************************************************
+void energy_set_current(uint32_t setting){
+	energy_selected = (uint8_t)(setting >> ENERGY_SETTING_SHIFT);
+	energy_current_ua[energy_selected] = setting & ((1UL << ENERGY_SETTING_SHIFT) - 1U);
+}
+
+//****************************************************************************
+// energy_get_current - returns the consumer of the last energy_set_current and its current (same format)
+//****************************************************************************
+uint32_t energy_get_current(void){
+	return ((uint32_t)energy_selected << ENERGY_SETTING_SHIFT) | energy_current_ua[energy_selected];
+}
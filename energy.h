@@ -0,0 +1,93 @@
+/*
+ * USB-Changer energy.h
+ *
+ * Estimated energy breakdown. energy_step runs in idle passes of the main loop (at most once per ENERGY_STEP_PERIOD)
+ * and adds the time since its last run to the on time of every consumer:
+ *	CPU		active time (elapsed time minus the sleep time of power_idle) at the full or the lowered MCLK (clockscale),
+ *			split into the profiled functions (profiler totals, ENERGY_TASK_OTHER is the rest)
+ *	Sleep	time per power_states (power_stats)
+ *	ADC		valid results (sensor_result_count) times ENERGY_ADC_RESULT_TIME
+ *	CCU4	time of every running CCU40 slice (a slice running for 1s adds 1s)
+ *	Flash	time of the deferred flash writes (ENERGY_FLASH_START/STOP around the flushes in the main loop)
+ *	Outputs	IO_RELAY and the USB port indicators by their pin level, the status LED by the duty of its PWM
+ * Outputs are sampled at the steps, so their on time is exact for levels that last longer than the steps and a mean
+ * for faster ones (coil economiser PWM, LED patterns). Every ENERGY_UPDATE_PERIOD the on times are scaled by the
+ * current of the consumer (energy_current_ua, ENERGY_*_UA defaults, set with HOSTCMD_SETTING_ENERGY_CURRENT) and
+ * ENERGY_SUPPLY_MV into energy_mj. The coefficients scale the whole accumulated time, so a changed coefficient applies
+ * retroactively. The breakdown is sent in a TELEMETRY_RECORD_ENERGY with every statistics record, the totals are
+ * registered as metrics.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "profiler.h"
+#include "frame.h"
+
+#define ENERGY_ENABLED				 0							// Determines if the energy breakdown is collected (0 removes energy_step and the flash timing)
+#define ENERGY_STEP_PERIOD			 10							// In ms. Shortest time between two steps (output sampling rate)
+#define ENERGY_UPDATE_PERIOD		 1000						// In ms. Period of the energy and on time update
+#define ENERGY_SUPPLY_MV			 3300U						// In mV. Supply of all consumers
+#define ENERGY_ADC_RESULT_TIME		 3U							// In us. Converter active time per valid result (its conversions with the sample time)
+// Default currents in uA (XMC1100 data sheet typicals at 32MHz and the parts of the board)
+#define ENERGY_CPU_RUN_UA			 5500U						// CPU active at the full MCLK
+#define ENERGY_CPU_SCALED_UA		 2500U						// CPU active at the lowered MCLK
+#define ENERGY_SLEEP_UA				 1800U						// WFI, flash powered
+#define ENERGY_FLASH_OFF_UA			 1200U						// WFI, flash powered down
+#define ENERGY_ADC_UA				 1500U						// VADC converting
+#define ENERGY_CCU4_UA				 150U						// Per running CCU40 slice
+#define ENERGY_FLASH_PROGRAM_UA		 3500U						// Flash programming or erasing
+#define ENERGY_RELAY_UA				 30000U						// Relay coil at full drive
+#define ENERGY_LED_STATUS_UA		 5000U						// Status LED at full brightness
+#define ENERGY_LED_USB_UA			 2000U						// Per lit USB port indicator
+#define ENERGY_SETTING_SHIFT		 24							// HOSTCMD_SETTING_ENERGY_CURRENT: consumer in the bits above, current in uA below
+
+typedef enum {
+	ENERGY_CPU_RUN,			// CPU active at the full MCLK
+	ENERGY_CPU_SCALED,		// CPU active at the lowered MCLK
+	ENERGY_SLEEP,			// POWER_STATE_SLEEP
+	ENERGY_FLASH_OFF,		// POWER_STATE_FLASH_OFF
+	ENERGY_ADC,				// Conversions
+	ENERGY_CCU4,			// Running CCU40 slices
+	ENERGY_FLASH_PROGRAM,	// Deferred flash writes (state log, EEPROM, bulk flash)
+	ENERGY_RELAY,			// IO_RELAY high
+	ENERGY_LED_STATUS,		// Status LED (full brightness equivalent)
+	ENERGY_LED_USB,			// Lit USB port indicators
+	ENERGY_CONSUMER_COUNT
+} energy_consumers;
+
+typedef enum {
+	ENERGY_TASK_STATUS_LED,	// PROFILER_STATUS_LED
+	ENERGY_TASK_BUTTONS,	// PROFILER_BUTTONS
+	ENERGY_TASK_RELAY,		// PROFILER_RELAY
+	ENERGY_TASK_SETUP,		// PROFILER_SETUP
+	ENERGY_TASK_RELAY_ISR,	// PROFILER_RELAY_ISR
+	ENERGY_TASK_OTHER,		// Active time outside the profiled sections
+	ENERGY_TASK_COUNT
+} energy_tasks;
+
+extern uint32_t energy_current_ua[ENERGY_CONSUMER_COUNT];
+extern uint32_t energy_on_ms[ENERGY_CONSUMER_COUNT];	// In ms. Full on equivalent time per consumer (ENERGY_UPDATE_PERIOD)
+extern uint32_t energy_mj[ENERGY_CONSUMER_COUNT];		// In mJ. Estimated energy per consumer (ENERGY_UPDATE_PERIOD)
+extern uint32_t energy_task_ms[ENERGY_TASK_COUNT];		// In ms. CPU active time per task (ENERGY_UPDATE_PERIOD)
+extern uint32_t energy_total_mj;						// In mJ. Sum of energy_mj
+extern uint64_t energy_flash_cycles;					// In cycles. Time of the deferred flash writes
+
+void energy_init(void);
+void energy_step(const frame_t *frame);
+void energy_set_current(uint32_t setting);
+uint32_t energy_get_current(void);
+
+#if ENERGY_ENABLED
+	#define ENERGY_FLASH_START(start_var)		uint32_t start_var = profiler_timestamp()
+	#define ENERGY_FLASH_STOP(start_var)		(energy_flash_cycles += profiler_timestamp() - (start_var))
+#else
+	#define ENERGY_FLASH_START(start_var)
+	#define ENERGY_FLASH_STOP(start_var)
+#endif
+
+#endif /* ENERGY_H */
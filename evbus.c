@@ -0,0 +1,99 @@
+/*
+ * USB-Changer evbus.c
+ *
+ * Event bus (see evbus.h). Any number of producers post with interrupts masked for the few stores of one entry, the
+ * main loop is the only consumer. The subscribers of an event are found by a scan of the subscriber table, which has
+ * a few entries only.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "evbus.h"
+#include "critical.h"
+#include "metrics.h"
+
+typedef char evbus_queue_check[((EVBUS_QUEUE & (EVBUS_QUEUE - 1)) == 0 && EVBUS_QUEUE <= 256 && EVBUS_COUNT <= 256) ? 1 : -1];
+
+extern const evbus_subscriber_t evbus_subscribers_start[];	// Linker script
+extern const evbus_subscriber_t evbus_subscribers_end[];
+
+evbus_message_t evbus_queue[EVBUS_QUEUE];
+volatile uint8_t evbus_head = 0;	// Next entry written by evbus_post
+volatile uint8_t evbus_tail = 0;	// Next entry taken by evbus_dispatch
+evbus_notify_t evbus_notify = NULL;
+uint32_t evbus_dropped = 0;
+volatile uint32_t evbus_lost = 0;	// Events dropped since the last EVBUS_OVERFLOW
+METRICS_REGISTER(evbus_dropped, METRICS_ID_EVBUS_DROPPED, METRICS_TYPE_U32, METRICS_UNIT_COUNT, evbus_dropped);
+
+
+//****************************************************************************
+// evbus_init - empties the queue and sets the callback that wakes the consumer (called by every post)
+//****************************************************************************
+void evbus_init(evbus_notify_t notify){
+	evbus_head = evbus_tail = 0;
+	evbus_notify = notify;
+}
+
+//****************************************************************************
+// evbus_post - queues an event (main context and interrupts). Returns false if the ring is full (counted in evbus_dropped)
+//****************************************************************************
+bool evbus_post(evbus_events event, uint8_t arg, uint32_t value){
+	critical_state_t primask = critical_enter();
+	uint8_t head = evbus_head;
+	uint8_t next = (uint8_t)((head + 1U) & (EVBUS_QUEUE - 1U));
+	if(next == evbus_tail){
+		evbus_dropped++;
+		evbus_lost++;
+		critical_exit(primask, CRITICAL_SITE_EVBUS);
+		// The consumer still runs to deliver EVBUS_OVERFLOW
+		if(evbus_notify != NULL)
+			evbus_notify();
+		return false;
+	}
+	evbus_queue[head].event = (uint8_t)event;
+	evbus_queue[head].arg = arg;
+	evbus_queue[head].value = value;
+	evbus_head = next;
+	critical_exit(primask, CRITICAL_SITE_EVBUS);
+	if(evbus_notify != NULL)
+		evbus_notify();
+	return true;
+}
+
+//****************************************************************************
+// evbus_deliver - calls the subscribers of one event (main context)
+//****************************************************************************
+void evbus_deliver(const evbus_message_t *message){
+	for(const evbus_subscriber_t *subscriber = evbus_subscribers_start; subscriber < evbus_subscribers_end; subscriber++){
+		if(subscriber->event == message->event)
+			subscriber->handler(message);
+	}
+}
+
+//****************************************************************************
+// evbus_dispatch - calls the subscribers of all queued events, also of the events they post, then EVBUS_OVERFLOW after
+//                  drops (main context). Returns true if one was queued
+//****************************************************************************
+bool evbus_dispatch(void){
+	bool dispatched = false;
+	while(1){
+		while(evbus_tail != evbus_head){
+			// Only the consumer moves the tail, the entry stays valid until it does
+			uint8_t tail = evbus_tail;
+			evbus_message_t message = evbus_queue[tail];
+			evbus_tail = (uint8_t)((tail + 1U) & (EVBUS_QUEUE - 1U));
+			evbus_deliver(&message);
+			dispatched = true;
+		}
+		// After the queued events, so the subscribers read a state that is newer than all of them
+		if(evbus_lost == 0)
+			break;
+		critical_state_t primask = critical_enter();
+		evbus_message_t overflow = {.event = EVBUS_OVERFLOW, .arg = 0, .value = evbus_lost};
+		evbus_lost = 0;
+		critical_exit(primask, CRITICAL_SITE_EVBUS);
+		evbus_deliver(&overflow);
+		dispatched = true;
+	}
+	return dispatched;
+}
@@ -0,0 +1,56 @@
+/*
+ * USB-Changer evbus.h
+ *
+ * Publish/subscribe event bus between the subsystems. A module subscribes a handler to an event with EVBUS_SUBSCRIBE
+ * next to the handler: like METRICS_REGISTER the macro places a const evbus_subscriber_t in the section .evbus, which
+ * the linker script collects into one table in flash. evbus_post queues an event with a small payload (arg and value)
+ * in a fixed ring, from main context or any interrupt, and wakes the main loop through the notify callback.
+ * evbus_dispatch runs in the main loop and calls the subscribers of every queued event in queue order, the
+ * subscribers of one event in link order. Nothing is allocated, an event that does not fit into the ring is dropped
+ * and counted in evbus_dropped. A drop is never silent for the subscribers: once the ring is empty again,
+ * evbus_dispatch delivers EVBUS_OVERFLOW (a counter, so it needs no slot in the full ring), and every subscriber that
+ * follows a state through its events (relay outputs, failover) reads that state again.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef EVBUS_H
+#define EVBUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EVBUS_QUEUE					 16							// Queued events (power of 2)
+
+typedef enum {
+	EVBUS_RELAY_SWITCHED,			// arg: sensor channel, value: switch time in us (output switched or safe state of a fault driven)
+	EVBUS_FLASH_CORRUPT,			// arg: flash block, value: its address (CRC mismatch found by flashcheck_step)
+	EVBUS_OVERFLOW,					// arg: 0, value: events dropped since the last one (delivered by evbus_dispatch, never posted)
+	EVBUS_COUNT
+} evbus_events;
+
+typedef struct {
+	uint8_t event;					// evbus_events
+	uint8_t arg;
+	uint32_t value;
+} evbus_message_t;
+
+typedef void (*evbus_handler_t)(const evbus_message_t *message);
+typedef void (*evbus_notify_t)(void);
+
+typedef struct {
+	uint8_t event;					// evbus_events
+	evbus_handler_t handler;		// Called by evbus_dispatch (main context)
+} evbus_subscriber_t;
+
+// Subscribes a handler to an event (file scope, the entry name only has to be unique)
+#define EVBUS_SUBSCRIBE(name, event, handler) \
+	const evbus_subscriber_t evbus_subscriber_##name __attribute__((section(".evbus"), used)) = {(event), (handler)}
+
+extern uint32_t evbus_dropped;				// Events that did not fit into the ring
+
+void evbus_init(evbus_notify_t notify);
+bool evbus_post(evbus_events event, uint8_t arg, uint32_t value);
+bool evbus_dispatch(void);
+
+#endif /* EVBUS_H */
@@ -0,0 +1,117 @@
+/*
+ * USB-Changer expander.c
+ *
+ * Shift register output expander (see expander.h). The image is changed with all interrupts masked, expander_set
+ * comes from any context (relay_drive of the loop, the ADC and the latch timer interrupts), expander_flush only from
+ * the main loop. The transmit FIFO of channel 1 sits behind the 32 words channel 0 may use.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_spi.h"
+#include "expander.h"
+#include "sensor.h"
+#include "critical.h"
+#include "ramcode.h"
+
+#define EXPANDER_CHANNEL			 XMC_SPI0_CH1
+#define EXPANDER_FIFO_DPTR			 32U						// In words. Transmit FIFO of channel 1 (channel 0 uses 0 to 31)
+#define EXPANDER_FIFO_SIZE			 16U						// In words
+#define EXPANDER_PORT				 XMC_GPIO_PORT1				// The device header only maps the TSSOP16 pins, the modes are given as ALT numbers
+#define EXPANDER_MOSI_PIN			 2U							// P1.2 = U0C1.DOUT0 (ALT7)
+#define EXPANDER_SCLK_PIN			 3U							// P1.3 = U0C1.SCLKOUT (ALT6)
+#define EXPANDER_RCLK_PIN			 1U							// P1.1 = U0C1.SELO0 (ALT7)
+
+#if EXPANDER_ENABLED && (SENSOR_DITHER || SENSOR_EXCITATION)
+#error "The output expander shares P1.1 to P1.3 with SENSOR_DITHER and SENSOR_EXCITATION"
+#endif
+
+typedef char expander_config_check[(EXPANDER_OUTPUTS % 8 == 0 && EXPANDER_OUTPUTS >= 8 && EXPANDER_OUTPUTS <= 32
+		&& EXPANDER_BYTES <= EXPANDER_FIFO_SIZE) ? 1 : -1];
+
+volatile uint32_t expander_image = 0;
+uint32_t expander_frames = 0;
+uint32_t expander_deferred = 0;
+volatile bool expander_dirty = false;		// The image changed since the last frame
+
+
+//****************************************************************************
+// expander_set - sets output of the shadow image, the next expander_flush latches it (any context)
+//****************************************************************************
+RAMCODE
+void expander_set(uint8_t output, bool on){
+	if(output >= EXPANDER_OUTPUTS)
+		return;
+	uint32_t mask = 1UL << output;
+	critical_state_t primask = critical_enter();
+	uint32_t image = expander_image;
+	uint32_t next = on ? (image | mask) : (image & ~mask);
+	if(next != image){
+		expander_image = next;
+		expander_dirty = true;
+	}
+	critical_exit(primask, CRITICAL_SITE_EXPANDER);
+}
+
+//****************************************************************************
+// expander_flush - sends the image as one frame if it changed, the end of the frame latches all outputs (main loop, once per pass)
+//****************************************************************************
+void expander_flush(void){
+#if EXPANDER_ENABLED
+	if(!expander_dirty)
+		return;
+	if(XMC_USIC_CH_TXFIFO_GetLevel(EXPANDER_CHANNEL) > EXPANDER_FIFO_SIZE - EXPANDER_BYTES){
+		expander_deferred++;
+		return;
+	}
+	// A change after the dirty flag was cleared sets it again and goes out with the next pass
+	expander_dirty = false;
+	uint32_t image = expander_image;
+	// The first byte ends in the register farthest from the MCU
+	for(uint8_t i = EXPANDER_BYTES; i > 0; i--)
+		XMC_USIC_CH_TXFIFO_PutData(EXPANDER_CHANNEL, (uint16_t)((image >> ((i - 1U) * 8U)) & 0xFFU));
+	expander_frames++;
+#endif
+}
+
+//****************************************************************************
+// expander_init - sets up the SPI master, latches all outputs off and enables the chain (boot, before relay_init)
+//****************************************************************************
+void expander_init(void){
+#if EXPANDER_ENABLED
+	const XMC_SPI_CH_CONFIG_t spi_config = {
+		.baudrate = EXPANDER_BAUDRATE,
+		.bus_mode = XMC_SPI_CH_BUS_MODE_MASTER,
+		.selo_inversion = XMC_SPI_CH_SLAVE_SEL_INV_TO_MSLS,	// Low during the frame, the rising edge is RCLK
+		.parity_mode = XMC_USIC_CH_PARITY_MODE_NONE
+	};
+	XMC_SPI_CH_Init(EXPANDER_CHANNEL, &spi_config);
+	XMC_SPI_CH_SetBitOrderMsbFirst(EXPANDER_CHANNEL);
+	XMC_SPI_CH_SetWordLength(EXPANDER_CHANNEL, 8U);
+	XMC_SPI_CH_SetFrameLength(EXPANDER_CHANNEL, EXPANDER_OUTPUTS); // One frame per image, its end latches the chain
+	XMC_SPI_CH_ConfigureShiftClockOutput(EXPANDER_CHANNEL, XMC_SPI_CH_BRG_SHIFT_CLOCK_PASSIVE_LEVEL_0_DELAY_ENABLED, XMC_SPI_CH_BRG_SHIFT_CLOCK_OUTPUT_SCLK); // Mode 0
+	XMC_SPI_CH_SetInputSource(EXPANDER_CHANNEL, XMC_SPI_CH_INPUT_DIN0, USIC_INPUT_ALWAYS_1); // No MISO
+	XMC_SPI_CH_EnableSlaveSelect(EXPANDER_CHANNEL, XMC_SPI_CH_SLAVE_SELECT_0);
+	XMC_USIC_CH_TXFIFO_Configure(EXPANDER_CHANNEL, EXPANDER_FIFO_DPTR, XMC_USIC_CH_FIFO_SIZE_16WORDS, 1U);
+	XMC_SPI_CH_Start(EXPANDER_CHANNEL);
+
+	const XMC_GPIO_CONFIG_t oe_config = {.mode = XMC_GPIO_MODE_OUTPUT_PUSH_PULL, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	const XMC_GPIO_CONFIG_t mosi_config = {.mode = XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT7, .output_level = XMC_GPIO_OUTPUT_LEVEL_LOW};
+	const XMC_GPIO_CONFIG_t sclk_config = {.mode = XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT6, .output_level = XMC_GPIO_OUTPUT_LEVEL_LOW};
+	const XMC_GPIO_CONFIG_t rclk_config = {.mode = XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT7, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	XMC_GPIO_Init(EXPANDER_OE_PORT, EXPANDER_OE_PIN, &oe_config);
+	XMC_GPIO_Init(EXPANDER_PORT, EXPANDER_MOSI_PIN, &mosi_config);
+	XMC_GPIO_Init(EXPANDER_PORT, EXPANDER_SCLK_PIN, &sclk_config);
+	XMC_GPIO_Init(EXPANDER_PORT, EXPANDER_RCLK_PIN, &rclk_config);
+
+	// Latch an image of zeros before the outputs are enabled (the registers power up with random contents)
+	expander_image = 0;
+	expander_dirty = true;
+	expander_flush();
+	while(!XMC_USIC_CH_TXFIFO_IsEmpty(EXPANDER_CHANNEL) || (EXPANDER_CHANNEL->TCSR & USIC_CH_TCSR_TDV_Msk) != 0U
+			|| (XMC_SPI_CH_GetStatusFlag(EXPANDER_CHANNEL) & (uint32_t)XMC_SPI_CH_STATUS_FLAG_MSLS) != 0U)
+		;
+	XMC_GPIO_SetOutputLow(EXPANDER_OE_PORT, EXPANDER_OE_PIN);
+#endif
+}
@@ -0,0 +1,51 @@
+/*
+ * USB-Changer expander.h
+ *
+ * Output expander for installations with more relays than spare pins: a chain of 74HC595 shift registers clocked by
+ * USIC0 channel 1 as SPI master (MOSI on P1.2 = DOUT0, SCK on P1.3 = SCLKOUT, mode 0, MSB first). The storage clock
+ * (RCLK) of all registers is the slave select SELO0 on P1.1: it is driven low for exactly one frame of
+ * EXPANDER_OUTPUTS bits and its rising edge at the end of the frame latches the whole chain at once. Output n is bit n
+ * of the image, Q(n % 8) of register n / 8 counted from the one next to the MCU.
+ * expander_set only changes the shadow image (any context, a few masked cycles). expander_flush, once per main loop
+ * pass after the relay handling, puts the whole image into the transmit FIFO as one frame if anything changed since
+ * the last one, so the cost per control cycle is one frame no matter how many outputs changed, and every output
+ * changed in that pass (by the loop or by an interrupt before) switches on the same latch edge. A change an interrupt
+ * makes after the flush goes out with the next pass, which its event wakes up. The frame takes EXPANDER_OUTPUTS bit
+ * times of the baud rate (16us for 16 outputs at 1MHz, longer while clockscale lowered MCLK) and runs without the CPU.
+ * A relay channel drives a chain output instead of a pin with .expander_output = EXPANDER_OUTPUT(n) (relay.h), the
+ * other outputs are free for expander_set. The registers power up with random contents: the board holds their /OE
+ * high with a pull-up, expander_init latches an image of zeros, waits for the end of the frame and then drives /OE low
+ * on EXPANDER_OE_PORT/PIN.
+ * P1.1 to P1.3 are not bonded on the TSSOP16 of this board: the expander needs a VQFN24 or TSSOP38 board variant. It
+ * shares these pins with SENSOR_DITHER and SENSOR_EXCITATION.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef EXPANDER_H
+#define EXPANDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EXPANDER_ENABLED			 0							// Determines if the shift register chain is set up and flushed by the main loop (needs a board variant)
+#define EXPANDER_OUTPUTS			 16							// Outputs of the chain (8 per 74HC595, at most 32)
+#define EXPANDER_BAUDRATE			 1000000U					// In Hz. Shift clock at full MCLK (a 74HC595 at 3.3V takes about 20MHz)
+#define EXPANDER_OE_PORT			 XMC_GPIO_PORT1				// /OE of the chain P1.0 (low = outputs on, pulled high on the board)
+#define EXPANDER_OE_PIN				 0U
+#define EXPANDER_BYTES				 (EXPANDER_OUTPUTS / 8)
+
+//****************************************************************************
+// EXPANDER_OUTPUT - value of relay_channel_t.expander_output for output n of the chain (0 = the channel drives a pin)
+//****************************************************************************
+#define EXPANDER_OUTPUT(n)			 ((uint8_t)((n) + 1U))
+
+extern volatile uint32_t expander_image;	// Shadow image of all outputs (bit n = output n)
+extern uint32_t expander_frames;			// Frames sent (one per pass with a change)
+extern uint32_t expander_deferred;			// Flushes deferred to the next pass because the FIFO had no room for a frame
+
+void expander_init(void);
+void expander_set(uint8_t output, bool on);
+void expander_flush(void);
+
+#endif /* EXPANDER_H */
@@ -0,0 +1,129 @@
+/*
+ * USB-Changer factory.c
+ *
+ * Factory calibration block (see factory.h). The page is only erased and programmed by factory_flush, which the main
+ * loop calls when it is idle (like statelog_flush, storage_flush and bulkflash_flush).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "DAVE.h"
+#include "factory.h"
+#include "bulkflash.h"
+#include "statelog.h"
+#include "settings.h"
+#include "sensor.h"
+#include "log.h"
+
+typedef char factory_block_size_check[(sizeof(factory_block_t) == 2U * FACTORY_BLOCK_SIZE) ? 1 : -1];
+typedef char factory_layout_check[(BULKFLASH_BASE + BULKFLASH_PAGES * BULKFLASH_PAGE_SIZE == FACTORY_BASE
+		&& FACTORY_BASE + FACTORY_PAGE_SIZE == STATELOG_PAGE0_BASE) ? 1 : -1];
+
+typedef enum {
+	FACTORY_IDLE,
+	FACTORY_ERASE,			// Next step erases the page
+	FACTORY_PROGRAM			// Next step writes the block
+} factory_states;
+
+const factory_block_t *factory_valid = NULL;
+factory_block_t factory_buffer;				// Block queued by factory_write (words, the block write reads words)
+factory_states factory_state = FACTORY_IDLE;
+uint8_t factory_attempts = 0;				// Failed tries of the page
+
+
+//****************************************************************************
+// factory_check - returns true if a block holds the magic and a matching CRC
+//****************************************************************************
+bool factory_check(const factory_block_t *block){
+	return block->magic == FACTORY_MAGIC && block->crc == settings_crc((const uint8_t *)block, offsetof(factory_block_t, crc));
+}
+
+//****************************************************************************
+// factory_init - checks the block in the flash once (boot, before read_eeprom_setup)
+//****************************************************************************
+void factory_init(void){
+	const factory_block_t *block = (const factory_block_t *)FACTORY_BASE;
+	factory_valid = factory_check(block) ? block : NULL;
+	factory_state = FACTORY_IDLE;
+}
+
+//****************************************************************************
+// factory_calibration - builds the calibration table of the ADC offset and gain (boot). Returns false if they map no value into range
+//****************************************************************************
+bool factory_calibration(const factory_block_t *block, calib_table_t *table){
+	int32_t low = block->adc_offset;
+	int32_t high = (int32_t)((SENSOR_VALUE_MAX * (uint32_t)block->adc_gain) >> FACTORY_GAIN_FRAC_BITS) + block->adc_offset;
+	if(block->adc_gain == 0 || high <= 0 || low >= (int32_t)SENSOR_VALUE_MAX)
+		return false;
+
+	// The table ends where the line leaves the range of the thresholds (values beyond are clamped to the end points anyway)
+	table->count = 2;
+	table->points[0].raw = 0;
+	table->points[0].value = (uint16_t)low;
+	table->points[1].raw = SENSOR_VALUE_MAX;
+	table->points[1].value = (uint16_t)high;
+	if(low < 0){
+		table->points[0].raw = (uint16_t)((((uint32_t)-low << FACTORY_GAIN_FRAC_BITS) + block->adc_gain - 1U) / block->adc_gain);
+		table->points[0].value = 0;
+	}
+	if(high > (int32_t)SENSOR_VALUE_MAX){
+		table->points[1].raw = (uint16_t)(((uint32_t)((int32_t)SENSOR_VALUE_MAX - block->adc_offset) << FACTORY_GAIN_FRAC_BITS) / block->adc_gain);
+		table->points[1].value = SENSOR_VALUE_MAX;
+	}
+	return calib_build(table);
+}
+
+//****************************************************************************
+// factory_write - queues the block (magic and CRC are set here). Returns false if a valid block exists or a write is pending
+//****************************************************************************
+bool factory_write(const factory_block_t *block){
+	if(factory_valid != NULL || factory_state != FACTORY_IDLE)
+		return false;
+	factory_buffer = *block;
+	factory_buffer.magic = FACTORY_MAGIC;
+	factory_buffer.crc = settings_crc((const uint8_t *)&factory_buffer, offsetof(factory_block_t, crc));
+	factory_attempts = 0;
+	factory_state = FACTORY_ERASE;
+	return true;
+}
+
+//****************************************************************************
+// factory_pending - returns true while a queued block is not programmed yet
+//****************************************************************************
+bool factory_pending(void){
+	return factory_state != FACTORY_IDLE;
+}
+
+//****************************************************************************
+// factory_flush - executes one step of the queued block (main context, call when idle). Returns true if flash was erased or programmed
+//****************************************************************************
+bool factory_flush(void){
+	if(factory_state == FACTORY_IDLE)
+		return false;
+
+	XMC_FLASH_ClearStatus();
+	if(factory_state == FACTORY_ERASE){
+		XMC_FLASH_ErasePage((uint32_t *)FACTORY_BASE);
+		factory_state = FACTORY_PROGRAM;
+		return true;
+	}
+
+	const factory_block_t *target = (const factory_block_t *)FACTORY_BASE;
+	XMC_FLASH_WriteBlocks((uint32_t *)FACTORY_BASE, (const uint32_t *)&factory_buffer, sizeof(factory_block_t) / FACTORY_BLOCK_SIZE, true);
+	if(XMC_FLASH_GetStatus() == 0U && memcmp(target, &factory_buffer, sizeof(factory_block_t)) == 0){
+		factory_valid = target;
+		factory_state = FACTORY_IDLE;
+		LOG_INFO("Factory block of serial %u written", factory_buffer.serial);
+		return true;
+	}
+	// The page starts with the erase again
+	if(++factory_attempts >= FACTORY_WRITE_ATTEMPTS){
+		factory_state = FACTORY_IDLE;
+		LOG_WARN("Factory block write failed");
+	}
+	else
+		factory_state = FACTORY_ERASE;
+	return true;
+}
@@ -0,0 +1,61 @@
+/*
+ * USB-Changer factory.h
+ *
+ * Factory calibration of this unit, written once at the end of line test: ADC offset and gain of the sensor, default
+ * thresholds and latch time, operate and release time of the relay and the serial number. The block has a flash page
+ * of its own (FACTORY_BASE, between the bulk flash region and the state log), so neither the E_EEPROM_XMC1 banks nor
+ * the bulk flash ever erase it. It is read in place: factory_init checks magic and CRC once at boot, afterwards
+ * factory_block is a pointer into the flash (NULL = no valid block). The values replace the compiled in defaults where
+ * the setup read from EEPROM is missing or invalid (read_eeprom_setup), the ADC offset and gain become the calibration
+ * of the setup channel without a stored table (SENSOR_CALIBRATION builds) and the relay times are used until the
+ * contact feedback measured its own (relaytime_set_default).
+ * factory_write only queues the block, factory_flush programs it from the idle main loop (page erase, then both
+ * blocks). A page that already holds a valid block is never written again: a new calibration needs a full chip erase.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FACTORY_H
+#define FACTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "calib.h"
+
+#define FACTORY_BASE				 0x10008700U				// Flash page of the block (directly below the state log, the linker script keeps the program below the bulk flash)
+#define FACTORY_PAGE_SIZE			 256U						// In bytes. XMC1 flash page (erase unit)
+#define FACTORY_BLOCK_SIZE			 16U						// In bytes. XMC1 flash block (write unit)
+#define FACTORY_MAGIC				 0x46414354U				// "FACT"
+#define FACTORY_GAIN_FRAC_BITS		 15							// Fractional bits of adc_gain (1 << 15 = 1.0)
+#define FACTORY_WRITE_ATTEMPTS		 3							// Number of tries of the page before the write is dropped as failed
+
+typedef struct {
+	uint32_t magic;					// FACTORY_MAGIC
+	uint32_t serial;				// Serial number of the unit
+	uint32_t operate_time;			// In us. Relay drive on to contacts closed (0 = not measured)
+	uint32_t release_time;			// In us. Relay drive off to contacts open (0 = not measured)
+	int16_t adc_offset;				// ADC values. Added after the gain: value = ((raw * adc_gain) >> FACTORY_GAIN_FRAC_BITS) + adc_offset
+	uint16_t adc_gain;				// Gain of the sensor channel (1 << FACTORY_GAIN_FRAC_BITS = 1.0)
+	uint16_t upper_threshold;		// ADC value. Default upper threshold
+	uint16_t lower_threshold;		// ADC value. Default lower threshold
+	uint16_t latchtime;				// In ms. Default latch time
+	uint16_t reserved[2];			// 0
+	uint16_t crc;					// CRC-16/CCITT of all bytes before (settings_crc)
+} factory_block_t;
+
+extern const factory_block_t *factory_valid;	// Valid block in the flash (NULL = none)
+
+void factory_init(void);
+bool factory_write(const factory_block_t *block);
+bool factory_pending(void);
+bool factory_flush(void);
+bool factory_calibration(const factory_block_t *block, calib_table_t *table);
+
+//****************************************************************************
+// factory_block - returns the factory calibration of this unit (NULL = not written yet)
+//****************************************************************************
+static inline const factory_block_t *factory_block(void){
+	return factory_valid;
+}
+
+#endif /* FACTORY_H */
@@ -0,0 +1,120 @@
+/*
+ * USB-Changer failover.c
+ *
+ * Automatic USB port failover (see failover.h). Only the transition of a sense channel is evaluated (manage_relay
+ * after relay_update switched it), so a port that never shows a device is not left again. A transition within the
+ * hold-off is kept pending and checked again by failover_poll when the hold-off ends.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "failover.h"
+#include "timing.h"
+#include "trace.h"
+#include "metrics.h"
+
+#if FAILOVER_ENABLED && SENSOR_CHANNEL_COUNT < 2
+	#error "FAILOVER_ENABLED needs sense channels besides the relay sensor (SENSOR_CHANNEL_COUNT, usb_ports)"
+#endif
+#define FAILOVER_HOLDOFF_US			 TIMING_MS_TO_US(FAILOVER_HOLDOFF)
+typedef char failover_holdoff_check[(FAILOVER_HOLDOFF <= TIMING_MS_MAX) ? 1 : -1];
+
+bool failover_active = FAILOVER_ENABLED;
+uint16_t failover_count = 0;
+#if FAILOVER_ENABLED
+METRICS_REGISTER(failover_count, METRICS_ID_FAILOVER_COUNT, METRICS_TYPE_U16, METRICS_UNIT_COUNT, failover_count);
+#endif
+bool failover_holding = false;		// A port switch happened less than FAILOVER_HOLDOFF ago (at failover_switch_time)
+uint32_t failover_switch_time = 0;	// In us. SYSTIMER_GetTime of the last port switch
+bool failover_pending = false;		// The sense channel of the active port fell to RELAY_LOW within the hold-off
+
+
+//****************************************************************************
+// failover_init - sets the hysteresis and debounce of the sense channels and starts the hold-off (power up at boot)
+//****************************************************************************
+void failover_init(void){
+#if FAILOVER_ENABLED
+	for(uint8_t i = 0; i < USB_PORT_COUNT; i++){
+		uint8_t sense = usb_ports[i].sense;
+		if(sense >= SENSOR_CHANNEL_COUNT)
+			continue;
+		relay_channel_t *channel = &relay_channels[sense];
+		channel->upper_threshold = FAILOVER_UPPER_THRESHOLD;
+		channel->lower_threshold = FAILOVER_LOWER_THRESHOLD;
+		channel->latchtime = FAILOVER_LATCHTIME;
+	}
+	relay_publish();
+	failover_switched(SYSTIMER_GetTime());
+#endif
+}
+
+//****************************************************************************
+// failover_switched - starts the hold-off after a port switch at timestamp (every change of the USB state)
+//****************************************************************************
+void failover_switched(uint32_t timestamp){
+	failover_switch_time = timestamp;
+	failover_holding = true;
+	failover_pending = false;
+}
+
+//****************************************************************************
+// failover_check - returns the port to switch to after the transition of a relay channel at timestamp (state = active
+//                  USB state, returned unchanged if the channel is not the sense of the active port or it is healthy)
+//****************************************************************************
+USB_states failover_check(const relay_channel_t *channel, USB_states state, uint32_t timestamp){
+#if FAILOVER_ENABLED
+	if(!failover_active || state >= USB_PORT_COUNT || channel->state != RELAY_LOW
+			|| usb_ports[state].sense != (uint8_t)(channel - relay_channels))
+		return state;
+	// Unsigned elapsed time instead of a deadline compare, so the hold-off also ends after a long time without transitions
+	if(failover_holding){
+		if(timestamp - failover_switch_time < FAILOVER_HOLDOFF_US){
+			failover_pending = true;
+			return state;
+		}
+		failover_holding = false;
+	}
+	failover_pending = false;
+	USB_states next = usb_next_port(state);
+	failover_count++;
+	TRACE(TRACE_FAILOVER, next, channel - relay_channels);
+	return next;
+#else
+	(void)channel;
+	(void)timestamp;
+	return state;
+#endif
+}
+
+//****************************************************************************
+// failover_recheck - returns the port to switch to if the sense channel of the active port is RELAY_LOW at timestamp
+//                    (its transition may have been lost, e.g. in a full event bus)
+//****************************************************************************
+USB_states failover_recheck(USB_states state, uint32_t timestamp){
+#if FAILOVER_ENABLED
+	if(state >= USB_PORT_COUNT || usb_ports[state].sense >= SENSOR_CHANNEL_COUNT)
+		return state;
+	return failover_check(&relay_channels[usb_ports[state].sense], state, timestamp);
+#else
+	(void)timestamp;
+	return state;
+#endif
+}
+
+//****************************************************************************
+// failover_poll - returns the port to switch to once the hold-off ended after a pending drop of the active sense
+//                 channel (main loop, once per pass, state = active USB state, returned unchanged otherwise)
+//****************************************************************************
+USB_states failover_poll(USB_states state, uint32_t now){
+#if FAILOVER_ENABLED
+	// No further transition follows a drop within the hold-off, the port would never be left
+	if(!failover_pending || now - failover_switch_time < FAILOVER_HOLDOFF_US)
+		return state;
+	failover_pending = false;
+	return failover_recheck(state, now);
+#else
+	(void)now;
+	return state;
+#endif
+}
@@ -0,0 +1,44 @@
+/*
+ * USB-Changer failover.h
+ *
+ * Automatic USB port failover. Every port with a sense channel (usb_port_t.sense, a sensor channel converting VBUS or
+ * the load current of the port) is supervised by the relay context of that channel without an output: its thresholds
+ * are the hysteresis and its latch time the debounce, RELAY_HIGH means a device is attached and healthy. The channel
+ * is scanned with the others and checked by the ADC interrupt (boundary events), so the main loop only runs when the
+ * sense value crosses a threshold. When the channel of the active port falls to RELAY_LOW (device removed, power
+ * switch tripped by a fault), failover_check returns the next port of the port table, so the switch happens within
+ * FAILOVER_LATCHTIME plus one sample after the drop. No failover happens within FAILOVER_HOLDOFF after any switch
+ * (manual or failover, failover_switched): a new port gets that time to power its device up and a decaying VBUS of the
+ * old port is ignored, so two ports without a device never ping-pong. A drop of the active port within the hold-off is
+ * taken when the hold-off ends (failover_poll), if the channel is still RELAY_LOW. A drop whose event was lost in a full
+ * event bus is found by failover_recheck on EVBUS_OVERFLOW. The standby (USB_inactive) is never left.
+ * A board variant needs SENSOR_CHANNEL_COUNT of at least 1 + the sense channels, their VADC channels in
+ * sensor_adc_channels and the sense fields of usb_ports.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FAILOVER_H
+#define FAILOVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usbswitch.h"
+#include "relay.h"
+
+#define FAILOVER_ENABLED			 0							// Determines if the USB port follows the sense channels (needs sense inputs, see usb_ports)
+#define FAILOVER_UPPER_THRESHOLD	 2000						// ADC value. Sense value above which a device counts as attached (e.g. VBUS > 2.4V at a 1:2 divider)
+#define FAILOVER_LOWER_THRESHOLD	 1500						// ADC value. Sense value below which the device counts as lost (hysteresis)
+#define FAILOVER_LATCHTIME			 20							// In ms. Time the sense value must stay beyond a threshold (debounce of the detection)
+#define FAILOVER_HOLDOFF			 2000						// In ms. Time after a port switch without failover (power up of the new device)
+
+extern bool failover_active;		// Failover enabled at run time (HOSTCMD_SETTING_USB_FAILOVER, not stored)
+extern uint16_t failover_count;		// Number of failovers since reset
+
+void failover_init(void);
+void failover_switched(uint32_t timestamp);
+USB_states failover_check(const relay_channel_t *channel, USB_states state, uint32_t timestamp);
+USB_states failover_recheck(USB_states state, uint32_t timestamp);
+USB_states failover_poll(USB_states state, uint32_t now);
+
+#endif /* FAILOVER_H */
@@ -0,0 +1,33 @@
+/*
+ * USB-Changer fieldhist.c
+ *
+ * Latency histograms of production builds (see fieldhist.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "fieldhist.h"
+#include "metrics.h"
+
+typedef char fieldhist_ids_check[(FIELDHIST_BUCKETS == 8 && METRICS_ID_HIST_USB_LATENCY - METRICS_ID_HIST_RELAY_LATENCY == FIELDHIST_BUCKETS
+		&& METRICS_ID_HIST_LAST - METRICS_ID_HIST_RELAY_LATENCY == FIELDHIST_COUNT * FIELDHIST_BUCKETS - 1) ? 1 : -1];
+
+uint32_t fieldhist_counts[FIELDHIST_COUNT][FIELDHIST_BUCKETS];
+
+#if FIELDHIST_ENABLED
+// One metric per bucket, the ids of a histogram follow its first one
+#define FIELDHIST_REGISTER(name, hist, id) \
+	METRICS_REGISTER(name##_0, (id) + 0, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][0]); \
+	METRICS_REGISTER(name##_1, (id) + 1, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][1]); \
+	METRICS_REGISTER(name##_2, (id) + 2, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][2]); \
+	METRICS_REGISTER(name##_3, (id) + 3, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][3]); \
+	METRICS_REGISTER(name##_4, (id) + 4, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][4]); \
+	METRICS_REGISTER(name##_5, (id) + 5, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][5]); \
+	METRICS_REGISTER(name##_6, (id) + 6, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][6]); \
+	METRICS_REGISTER(name##_7, (id) + 7, METRICS_TYPE_U32, METRICS_UNIT_COUNT, fieldhist_counts[hist][7])
+
+FIELDHIST_REGISTER(hist_relay_latency, FIELDHIST_RELAY_LATENCY, METRICS_ID_HIST_RELAY_LATENCY);
+FIELDHIST_REGISTER(hist_usb_latency, FIELDHIST_USB_LATENCY, METRICS_ID_HIST_USB_LATENCY);
+FIELDHIST_REGISTER(hist_sample_age, FIELDHIST_SAMPLE_AGE, METRICS_ID_HIST_SAMPLE_AGE);
+FIELDHIST_REGISTER(hist_eeprom_blocking, FIELDHIST_EEPROM_BLOCKING, METRICS_ID_HIST_EEPROM_BLOCKING);
+#endif
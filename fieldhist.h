@@ -0,0 +1,60 @@
+/*
+ * USB-Changer fieldhist.h
+ *
+ * Latency histograms of production builds. The profiler (profiler.h) is for lab measurements: it keeps cycles, the
+ * total and min/max per section and is read with a debugger. These histograms stay on in every build and only
+ * count: an update is a shift loop to the bucket index and one increment, no timer read of its own (the caller passes
+ * the duration it already has). Each histogram has FIELDHIST_BUCKETS buckets on a log2 scale from its own shift:
+ * bucket 0 counts durations below 2^shift us, bucket n durations from 2^(shift + n - 1) to 2^(shift + n) - 1 us and
+ * the last one everything longer. Every bucket is a metric (METRICS_ID_HIST_*, the first bucket of a histogram has its
+ * id, the others follow), so the host reads the distribution of every deployed unit with HOSTCMD_METRICS_READ and
+ * derives the percentiles itself. The counts run from reset. Two contexts that record the same histogram at once can
+ * lose one increment (no lock on the hot paths, statistics only).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FIELDHIST_H
+#define FIELDHIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FIELDHIST_ENABLED			 0							// Determines if the histograms are recorded (0 removes all FIELDHIST_ADD calls)
+#define FIELDHIST_BUCKETS			 8							// Buckets per histogram (8 metric ids each, see metrics.h)
+#define FIELDHIST_RELAY_LATENCY_SHIFT	 5						// Bucket 0: below 32us, last bucket: 2ms and longer
+#define FIELDHIST_USB_LATENCY_SHIFT		 9						// Bucket 0: below 512us, last bucket: 32ms and longer
+#define FIELDHIST_SAMPLE_AGE_SHIFT		 6						// Bucket 0: below 64us, last bucket: 4ms and longer
+#define FIELDHIST_EEPROM_BLOCKING_SHIFT	 8						// Bucket 0: below 256us, last bucket: 16ms and longer
+
+typedef enum {
+	FIELDHIST_RELAY_LATENCY,	// End of the latch time of a threshold crossing to the write of the relay output (relay_record_latch)
+	FIELDHIST_USB_LATENCY,		// Release of the USB button to the start of its switchover (usb_record_latency)
+	FIELDHIST_SAMPLE_AGE,		// Age of the ADC result a relay decision of the main loop is based on
+	FIELDHIST_EEPROM_BLOCKING,	// One E_EEPROM_XMC1 write or garbage collection slice of storage_flush
+	FIELDHIST_COUNT
+} fieldhist_ids;
+
+extern uint32_t fieldhist_counts[FIELDHIST_COUNT][FIELDHIST_BUCKETS];
+
+//****************************************************************************
+// fieldhist_add - counts one duration (in us) in the bucket of a histogram
+//****************************************************************************
+static inline void fieldhist_add(fieldhist_ids hist, uint8_t shift, uint32_t us){
+	// log2 bucket (M0 has no CLZ instruction, so shift down)
+	uint32_t rest = us >> shift;
+	uint8_t bucket = 0;
+	while(rest != 0 && bucket < FIELDHIST_BUCKETS - 1U){
+		rest >>= 1;
+		bucket++;
+	}
+	fieldhist_counts[hist][bucket]++;
+}
+
+#if FIELDHIST_ENABLED
+	#define FIELDHIST_ADD(name, us)		 fieldhist_add(FIELDHIST_##name, FIELDHIST_##name##_SHIFT, (us))
+#else
+	#define FIELDHIST_ADD(name, us)		 ((void)(us))
+#endif
+
+#endif /* FIELDHIST_H */
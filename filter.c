@@ -0,0 +1,96 @@
+/*
+ * USB-Changer filter.c
+ *
+ * Integer-only digital filters for the sensor pipeline (see filter.h).
+ * The history is filled with the first sample, so there is no start-up phase with partly empty windows.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "filter.h"
+#include "ramcode.h"
+
+#if FILTER_WINDOW_SIZE < 5
+	#error "FILTER_WINDOW_SIZE must hold at least 5 median taps"
+#endif
+
+typedef char filter_state_size_check[(sizeof(filter_t) == FILTER_STATE_SIZE && sizeof(((filter_t *)0)->type) == 1) ? 1 : -1];
+
+
+//****************************************************************************
+// filter_init - resets a filter and selects its type
+//****************************************************************************
+void filter_init(filter_t *filter, filter_types type){
+	filter->type = (uint8_t)type;
+	filter->primed = 0;
+	filter->index = 0;
+	filter->iir_state = 0;
+	filter->sum = 0;
+}
+
+//****************************************************************************
+// filter_prime - fills the history with one sample (first call of filter_apply)
+//****************************************************************************
+void filter_prime(filter_t *filter, uint16_t sample){
+	for(uint8_t i = 0; i < FILTER_WINDOW_SIZE; i++)
+		filter->window[i] = sample;
+	filter->sum = (uint32_t)sample << FILTER_BOXCAR_SHIFT;
+	filter->iir_state = (int32_t)sample << FILTER_IIR_FRAC_BITS;
+	filter->primed = 1;
+}
+
+//****************************************************************************
+// filter_median - returns the median of the newest taps (3 or 5) samples of the history
+//****************************************************************************
+RAMCODE
+uint16_t filter_median(const filter_t *filter, uint8_t taps){
+	uint16_t sorted[5];
+
+	// Copy newest samples (index points to the oldest one, the newest is right before it)
+	for(uint8_t i = 0; i < taps; i++)
+		sorted[i] = filter->window[(uint8_t)(filter->index - 1U - i) & (FILTER_WINDOW_SIZE - 1U)];
+
+	// Insertion sort (at most 10 compares for 5 taps)
+	for(uint8_t i = 1; i < taps; i++){
+		uint16_t value = sorted[i];
+		uint8_t j = i;
+		while(j > 0 && sorted[j - 1] > value){
+			sorted[j] = sorted[j - 1];
+			j--;
+		}
+		sorted[j] = value;
+	}
+	return sorted[taps >> 1];
+}
+
+//****************************************************************************
+// filter_apply - feeds one sample into the filter and returns the filtered value
+//****************************************************************************
+RAMCODE
+uint16_t filter_apply(filter_t *filter, uint16_t sample){
+	if(filter->type == FILTER_NONE)
+		return sample;
+	if(!filter->primed)
+		filter_prime(filter, sample);
+
+	// Update history (replace oldest sample) and the boxcar sum
+	uint16_t oldest = filter->window[filter->index];
+	filter->window[filter->index] = sample;
+	filter->index = (filter->index + 1U) & (FILTER_WINDOW_SIZE - 1U);
+	filter->sum = filter->sum - oldest + sample;
+
+	switch(filter->type){
+		case FILTER_IIR:
+			// y += (x - y) >> n (arithmetic shift of the signed difference)
+			filter->iir_state += (((int32_t)sample << FILTER_IIR_FRAC_BITS) - filter->iir_state) >> FILTER_IIR_SHIFT;
+			return (uint16_t)((filter->iir_state + (1 << (FILTER_IIR_FRAC_BITS - 1))) >> FILTER_IIR_FRAC_BITS);
+		case FILTER_MEDIAN3:
+			return filter_median(filter, 3);
+		case FILTER_MEDIAN5:
+			return filter_median(filter, 5);
+		case FILTER_BOXCAR:
+			return (uint16_t)(filter->sum >> FILTER_BOXCAR_SHIFT);
+		default:
+			return sample;
+	}
+}
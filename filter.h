@@ -0,0 +1,36 @@
+/*
+ * USB-Changer filter.h
+ *
+ * Integer-only digital filters for the sensor pipeline (first-order IIR, 3/5-tap median, boxcar average).
+ * All filters work without division (the Cortex-M0 has no hardware divider): the IIR coefficient and the boxcar
+ * window length are powers of 2 and are applied with shifts.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+
+#define FILTER_IIR_SHIFT			 3							// IIR coefficient 1/2^n: y += (x - y) / 2^n (time constant approx. 2^n samples)
+#define FILTER_IIR_FRAC_BITS		 8							// Fractional bits of the IIR state (avoids the dead band of a plain integer IIR)
+#define FILTER_BOXCAR_SHIFT			 3							// Boxcar window length 2^n samples
+#define FILTER_WINDOW_SIZE			 (1U << FILTER_BOXCAR_SHIFT)	// Sample history length (must hold the boxcar window and at least 5 median taps)
+#define FILTER_STATE_SIZE			 (12U + 2U * FILTER_WINDOW_SIZE)	// sizeof(filter_t), equal with and without -fshort-enums (part of retain_record_t)
+
+typedef enum {FILTER_NONE, FILTER_IIR, FILTER_MEDIAN3, FILTER_MEDIAN5, FILTER_BOXCAR} filter_types;
+
+typedef struct {
+	uint8_t type;						// filter_types (a byte on every build, arm-none-eabi packs enums)
+	uint8_t primed;						// 0 until the first sample initialised the history
+	uint8_t index;						// Position of the oldest sample in window
+	int32_t iir_state;					// IIR output with FILTER_IIR_FRAC_BITS fractional bits
+	uint32_t sum;						// Sum of window (boxcar)
+	uint16_t window[FILTER_WINDOW_SIZE];	// Sample history (ring)
+} filter_t;
+
+void filter_init(filter_t *filter, filter_types type);
+uint16_t filter_apply(filter_t *filter, uint16_t sample);
+
+#endif /* FILTER_H */
@@ -0,0 +1,112 @@
+/*
+ * USB-Changer flashcheck.c
+ *
+ * Background flash integrity check (see flashcheck.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "flashcheck.h"
+#include "updater.h"
+#include "evbus.h"
+#include "timing.h"
+#include "metrics.h"
+
+typedef char flashcheck_layout_check[(FLASHCHECK_BLOCK % FLASHCHECK_SLICE == 0 && FLASHCHECK_SLICE <= UINT16_MAX
+		&& FLASHCHECK_BLOCKS * FLASHCHECK_BLOCK == UPDATER_APP_END - UPDATER_APP_BASE) ? 1 : -1];
+
+// CRC-16/CCITT (polynomial 0x1021) of the nibble values 0..15
+const uint16_t flashcheck_nibbles[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// Erased until tools/flashcheck_patch.py writes it (placed behind the load image by the linker script, volatile so the
+// initialiser is never folded into the code)
+const volatile flashcheck_table_t flashcheck_table __attribute__((section(".flashcheck"), used)) = {
+	.magic = 0xFFFFFFFFU
+};
+
+flashcheck_states flashcheck_state = FLASHCHECK_OFF;
+uint32_t flashcheck_passes = 0;
+uint32_t flashcheck_errors = 0;
+const uint8_t *flashcheck_end;				// First byte after the image (the table)
+const uint8_t *flashcheck_position;			// Next byte of the scan
+const uint8_t *flashcheck_block_end;		// End of the block in progress
+uint8_t flashcheck_block;					// Index of the block in progress
+uint16_t flashcheck_value;					// CRC of the block so far
+uint32_t flashcheck_deadline;				// In us. Earliest time of the next slice
+METRICS_REGISTER(flashcheck_passes, METRICS_ID_FLASHCHECK_PASSES, METRICS_TYPE_U32, METRICS_UNIT_COUNT, flashcheck_passes);
+METRICS_REGISTER(flashcheck_errors, METRICS_ID_FLASHCHECK_ERRORS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, flashcheck_errors);
+
+
+//****************************************************************************
+// flashcheck_crc - continues a CRC-16/CCITT (start with FLASHCHECK_CRC_INIT, same result as settings_crc) over length bytes
+//****************************************************************************
+uint16_t flashcheck_crc(uint16_t crc, const uint8_t *data, uint16_t length){
+	// Two table steps per byte instead of eight shifts (the high nibble first)
+	uint32_t value = crc;
+	for(uint16_t i = 0; i < length; i++){
+		uint32_t byte = data[i];
+		value = ((value << 4) ^ flashcheck_nibbles[((value >> 12) ^ (byte >> 4)) & 0x0FU]) & 0xFFFFU;
+		value = ((value << 4) ^ flashcheck_nibbles[((value >> 12) ^ byte) & 0x0FU]) & 0xFFFFU;
+	}
+	return (uint16_t)value;
+}
+
+//****************************************************************************
+// flashcheck_start_block - starts the CRC of the block at the scan position
+//****************************************************************************
+void flashcheck_start_block(void){
+	flashcheck_block = (uint8_t)((uint32_t)(flashcheck_position - (const uint8_t *)UPDATER_APP_BASE) / FLASHCHECK_BLOCK);
+	flashcheck_block_end = flashcheck_position + FLASHCHECK_BLOCK;
+	if(flashcheck_block_end > flashcheck_end)
+		flashcheck_block_end = flashcheck_end;
+	flashcheck_value = FLASHCHECK_CRC_INIT;
+}
+
+//****************************************************************************
+// flashcheck_init - starts the scan at the first block, if the image carries its CRCs
+//****************************************************************************
+void flashcheck_init(void){
+#if FLASHCHECK_ENABLED
+	if(flashcheck_table.magic != FLASHCHECK_MAGIC){
+		flashcheck_state = FLASHCHECK_UNPATCHED;
+		return;
+	}
+	flashcheck_end = (const uint8_t *)&flashcheck_table;
+	flashcheck_position = (const uint8_t *)UPDATER_APP_BASE;
+	flashcheck_start_block();
+	flashcheck_deadline = SYSTIMER_GetTime();
+	flashcheck_state = FLASHCHECK_SCANNING;
+#endif
+}
+
+//****************************************************************************
+// flashcheck_step - checks the next slice if FLASHCHECK_SLICE_PERIOD passed since the last one (idle passes of the main loop, now in us)
+//****************************************************************************
+void flashcheck_step(uint32_t now){
+	if(!FLASHCHECK_ENABLED || flashcheck_state != FLASHCHECK_SCANNING || !timing_reached(now, flashcheck_deadline))
+		return;
+	flashcheck_deadline = timing_deadline(now, FLASHCHECK_SLICE_PERIOD);
+
+	uint16_t length = FLASHCHECK_SLICE;
+	if(flashcheck_block_end - flashcheck_position < length)
+		length = (uint16_t)(flashcheck_block_end - flashcheck_position);
+	flashcheck_value = flashcheck_crc(flashcheck_value, flashcheck_position, length);
+	flashcheck_position += length;
+	if(flashcheck_position < flashcheck_block_end)
+		return;
+
+	// Block complete
+	if(flashcheck_value != flashcheck_table.crc[flashcheck_block]){
+		flashcheck_errors++;
+		evbus_post(EVBUS_FLASH_CORRUPT, flashcheck_block, UPDATER_APP_BASE + (uint32_t)flashcheck_block * FLASHCHECK_BLOCK);
+	}
+	if(flashcheck_position >= flashcheck_end){
+		flashcheck_passes++;
+		flashcheck_position = (const uint8_t *)UPDATER_APP_BASE;
+	}
+	flashcheck_start_block();
+}
@@ -0,0 +1,56 @@
+/*
+ * USB-Changer flashcheck.h
+ *
+ * Background flash integrity check. The application image (code, const tables and the load images of .data and
+ * .ram_code, from UPDATER_APP_BASE to the table) is checked continuously instead of at boot: flashcheck_step takes the
+ * CRC of FLASHCHECK_SLICE bytes in an idle pass of the main loop, at most once per FLASHCHECK_SLICE_PERIOD, and
+ * compares every FLASHCHECK_BLOCK bytes against the build time CRC of the block in flashcheck_table. The CRC is the
+ * CRC-16/CCITT of the EEPROM records (settings_crc), computed with a 16 entry nibble table.
+ * The linker script places flashcheck_table (section .flashcheck) behind the whole load image. The linker cannot
+ * compute a CRC, so tools/flashcheck_patch.py writes the block CRCs and FLASHCHECK_MAGIC into the .elf after the link
+ * (before the .hex and .bin are made from it). An image that was not patched keeps the erased value of the magic and
+ * is not checked (flashcheck_state FLASHCHECK_UNPATCHED).
+ * A block that does not match is counted in flashcheck_errors and published as EVBUS_FLASH_CORRUPT with the block and
+ * its address (the scan position), the scan continues with the next block. The resident updater is not covered, an
+ * update over the UART never changes it.
+ * With 256 bytes per 32ms slice (about 20 cycles per byte, 0.5% of the CPU at 32MHz) the 26KB application area is
+ * covered every 3.3s.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FLASHCHECK_H
+#define FLASHCHECK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLASHCHECK_ENABLED			 0							// Determines if the image is checked in the background
+#define FLASHCHECK_BLOCK			 1024						// In bytes. Flash covered by one table CRC (the resolution of the reported position)
+#define FLASHCHECK_SLICE			 256						// In bytes. Flash checked per idle slice (divides FLASHCHECK_BLOCK)
+#define FLASHCHECK_SLICE_PERIOD		 32							// In ms. Shortest time between two slices
+#define FLASHCHECK_BLOCKS			 26							// Table entries ((UPDATER_APP_END - UPDATER_APP_BASE) / FLASHCHECK_BLOCK)
+#define FLASHCHECK_MAGIC			 0x1C4EC4EDU				// Written by tools/flashcheck_patch.py after the CRCs
+#define FLASHCHECK_CRC_INIT			 0xFFFFU					// CRC-16/CCITT initial value (like settings_crc)
+
+typedef struct {
+	uint32_t magic;							// FLASHCHECK_MAGIC (anything else: not patched)
+	uint16_t crc[FLASHCHECK_BLOCKS];		// CRC of the blocks from UPDATER_APP_BASE on (the last ends at the table)
+} flashcheck_table_t;
+
+typedef enum {
+	FLASHCHECK_OFF,					// FLASHCHECK_ENABLED 0 or not initialised
+	FLASHCHECK_UNPATCHED,			// The image has no CRCs (tools/flashcheck_patch.py not run)
+	FLASHCHECK_SCANNING				// Checking, see flashcheck_passes and flashcheck_errors
+} flashcheck_states;
+
+extern const volatile flashcheck_table_t flashcheck_table;
+extern flashcheck_states flashcheck_state;
+extern uint32_t flashcheck_passes;			// Complete passes over the image
+extern uint32_t flashcheck_errors;			// Blocks that did not match
+
+uint16_t flashcheck_crc(uint16_t crc, const uint8_t *data, uint16_t length);
+void flashcheck_init(void);
+void flashcheck_step(uint32_t now);
+
+#endif /* FLASHCHECK_H */
@@ -0,0 +1,43 @@
+/*
+ * USB-Changer frame.h
+ *
+ * Context of one main loop pass. The main loop captures it once at the start of every pass (frame_capture): the
+ * time, the events taken for the pass, an input snapshot of all ports (pins.h) and the latest value of every sensor
+ * channel. The handlers of the pass get it instead of reading the timer, the pins or the channels themselves, so all
+ * time based decisions of one pass see the same now and one SYSTIMER_GetTime serves the whole pass. Scheduler tasks
+ * and event bus subscribers (dispatched within the pass) read it through main_frame.
+ * Code that arms a timer for a deadline (relay_timers_update) or timestamps an edge still reads the timer itself.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "DAVE.h"
+#include "pins.h"
+#include "relay.h"
+
+typedef struct {
+	uint32_t now;							// In us. SYSTIMER_GetTime at the start of the pass
+	uint32_t events;						// EVENT_* taken for the pass (main.c)
+	pins_snapshot_t inputs;					// Pin levels at the start of the pass
+	uint32_t values[SENSOR_CHANNEL_COUNT];	// relay_channels[].value (latest filtered ADC value, written by the ADC interrupt)
+} frame_t;
+
+extern frame_t main_frame;					// Context of the current main loop pass (main.c)
+
+//****************************************************************************
+// frame_capture - takes the context of a new pass with its events
+//****************************************************************************
+static inline void frame_capture(frame_t *frame, uint32_t events){
+	frame->now = SYSTIMER_GetTime();
+	frame->events = events;
+	pins_snapshot(&frame->inputs);
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
+		frame->values[i] = relay_channels[i].value;
+}
+
+#endif /* FRAME_H */
@@ -0,0 +1,187 @@
+/*
+ * USB-Changer freqsensor.c
+ *
+ * Frequency and PWM duty input by a CCU4 capture slice (see freqsensor.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "freqsensor.h"
+#include "metrics.h"
+#include "coil.h"
+#include "funcprof.h"
+#include "ramcode.h"
+
+#if FREQSENSOR_ENABLED
+	#if COIL_ENABLED
+		#error "FREQSENSOR_ENABLED needs CCU40 slice 3, the sensor trigger of COIL_ENABLED builds"
+	#endif
+	#if FUNCPROF_ENABLED
+		#error "FREQSENSOR_ENABLED and FUNCPROF_ENABLED both need CCU40 slice 3"
+	#endif
+	#if !defined(CCU40_IN3_P0_9)
+		#error "FREQSENSOR_ENABLED needs P0.9 on CCU40.IN3"
+	#endif
+#endif
+#define FREQSENSOR_SLICE			 CCU40_CC43					// Capture slice (slice 0 = LED PWM, 1 = sensor trigger, 2 = hrtimer)
+#define FREQSENSOR_SLICE_NUMBER		 3U
+#define FREQSENSOR_SR				 XMC_CCU4_SLICE_SR_ID_3		// CCU40.SR3 = CCU40_3_IRQn
+#define FREQSENSOR_IRQ				 CCU40_3_IRQn
+#define FREQSENSOR_INPUT			 CCU40_IN3_P0_9
+#define FREQSENSOR_VALUE_MAX		 4095U						// Value of FREQSENSOR_FULL_SCALE_HZ and of 100% duty (12 bit full scale of a conversion)
+#define FREQSENSOR_VALUE_SCALE		 ((uint32_t)((uint64_t)FREQSENSOR_CLOCK * FREQSENSOR_VALUE_MAX / FREQSENSOR_FULL_SCALE_HZ))	// Divided by the period in ticks
+#define FREQSENSOR_TIMEOUT_WRAPS	 ((FREQSENSOR_TIMEOUT * (FREQSENSOR_CLOCK / 1000U) + 0xFFFFU) >> 16)	// Timer wraps of FREQSENSOR_TIMEOUT
+
+typedef char freqsensor_timeout_check[(FREQSENSOR_TIMEOUT_WRAPS > 0 && FREQSENSOR_TIMEOUT_WRAPS < 0xFFFFU && FREQSENSOR_VALUE_SCALE > 0) ? 1 : -1];
+
+volatile uint32_t freqsensor_period = 0;
+volatile uint16_t freqsensor_edges = 0;
+#if FREQSENSOR_ENABLED
+METRICS_REGISTER(freqsensor_period, METRICS_ID_FREQSENSOR_PERIOD, METRICS_TYPE_U32, METRICS_UNIT_US, freqsensor_period);
+#endif
+volatile uint16_t freqsensor_high = 0;		// In ticks. High time of the last period below one timer wrap
+volatile uint16_t freqsensor_high_period = 0;	// In ticks. Period of freqsensor_high (0 = none measured)
+uint16_t freqsensor_wraps = FREQSENSOR_TIMEOUT_WRAPS;	// Timer wraps since the last rising edge (starts as lost, the first edge only starts a period)
+bool freqsensor_discard = false;			// The period running at a prescaler change is counted in two clocks
+uint8_t freqsensor_prescaler = 0;			// Prescaler giving FREQSENSOR_CLOCK at the full CCU4 clock (0 = not initialized)
+
+
+#if FREQSENSOR_ENABLED
+//****************************************************************************
+// CCU40_3_IRQHandler - timer wrap (period match) and rising edge (event 0) of the capture slice
+//****************************************************************************
+RAMCODE
+void CCU40_3_IRQHandler(void){
+	// A wrap pending together with an edge came before it (the edge clears the timer, the next wrap is 65ms away)
+	if(XMC_CCU4_SLICE_GetEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH)){
+		XMC_CCU4_SLICE_ClearEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+		if(freqsensor_wraps < FREQSENSOR_TIMEOUT_WRAPS)
+			freqsensor_wraps++;
+		if(freqsensor_wraps == FREQSENSOR_TIMEOUT_WRAPS){
+			freqsensor_period = 0;
+			freqsensor_high_period = 0;
+		}
+	}
+	if(!XMC_CCU4_SLICE_GetEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0))
+		return;
+	XMC_CCU4_SLICE_ClearEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0);
+
+	// C1V holds the timer at this edge, C3V at the falling edge before it (both captured by the hardware)
+	uint32_t period = XMC_CCU4_SLICE_GetCaptureRegisterValue(FREQSENSOR_SLICE, 1U) & CCU4_CC4_CV_CAPTV_Msk;
+	uint32_t high = XMC_CCU4_SLICE_GetCaptureRegisterValue(FREQSENSOR_SLICE, 3U) & CCU4_CC4_CV_CAPTV_Msk;
+	uint32_t wraps = freqsensor_wraps;
+	freqsensor_wraps = 0;
+	if(freqsensor_discard){
+		freqsensor_discard = false;
+		return;
+	}
+	if(wraps >= FREQSENSOR_TIMEOUT_WRAPS)
+		return; // First edge after a lost signal, the period starts here
+	freqsensor_period = (wraps << 16) + period;
+	if(wraps == 0 && high <= period){
+		freqsensor_high = (uint16_t)high;
+		freqsensor_high_period = (uint16_t)period;
+	}
+	freqsensor_edges++;
+}
+#endif
+
+//****************************************************************************
+// freqsensor_init - sets up the capture slice and its input (CCU40 must be initialized, false = not enabled or possible)
+//****************************************************************************
+bool freqsensor_init(void){
+#if FREQSENSOR_ENABLED
+	// The input pin must not be an output of this board
+	if(IO_USB_OE.gpio_port == FREQSENSOR_PORT && IO_USB_OE.gpio_pin == FREQSENSOR_PIN)
+		return false;
+
+	// Prescaler that divides the module clock exactly to FREQSENSOR_CLOCK
+	uint32_t prescaler = (uint32_t)XMC_CCU4_SLICE_PRESCALER_1;
+	while((GLOBAL_CCU4_0.module_frequency >> prescaler) > FREQSENSOR_CLOCK && prescaler < (uint32_t)XMC_CCU4_SLICE_PRESCALER_32768)
+		prescaler++;
+	if((GLOBAL_CCU4_0.module_frequency >> prescaler) != FREQSENSOR_CLOCK || (GLOBAL_CCU4_0.module_frequency & ((1UL << prescaler) - 1U)) != 0)
+		return false;
+
+	// Capture: the rising edge (event 0) captures into C1V and clears the timer, the falling edge (event 1) into C3V
+	XMC_CCU4_SLICE_CAPTURE_CONFIG_t capture_config = {
+		.fifo_enable = 0U,
+		.timer_clear_mode = (uint32_t)XMC_CCU4_SLICE_TIMER_CLEAR_MODE_CAP_LOW,
+		.same_event = 0U,
+		.ignore_full_flag = 1U,
+		.prescaler_mode = (uint32_t)XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
+		.prescaler_initval = prescaler
+	};
+	XMC_CCU4_SLICE_EVENT_CONFIG_t edge_config = {
+		.mapped_input = FREQSENSOR_INPUT,
+		.edge = XMC_CCU4_SLICE_EVENT_EDGE_SENSITIVITY_RISING_EDGE,
+		.level = XMC_CCU4_SLICE_EVENT_LEVEL_SENSITIVITY_ACTIVE_HIGH,
+		.duration = XMC_CCU4_SLICE_EVENT_FILTER_3_CYCLES
+	};
+	XMC_CCU4_SLICE_CaptureInit(FREQSENSOR_SLICE, &capture_config);
+	XMC_CCU4_SLICE_ConfigureEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_EVENT_0, &edge_config);
+	edge_config.edge = XMC_CCU4_SLICE_EVENT_EDGE_SENSITIVITY_FALLING_EDGE;
+	XMC_CCU4_SLICE_ConfigureEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_EVENT_1, &edge_config);
+	XMC_CCU4_SLICE_Capture0Config(FREQSENSOR_SLICE, XMC_CCU4_SLICE_EVENT_0);
+	XMC_CCU4_SLICE_Capture1Config(FREQSENSOR_SLICE, XMC_CCU4_SLICE_EVENT_1);
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(FREQSENSOR_SLICE, 0xFFFFU);
+	XMC_CCU4_EnableShadowTransfer(CCU40, XMC_CCU4_SHADOW_TRANSFER_SLICE_3);
+	XMC_CCU4_SLICE_SetInterruptNode(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, FREQSENSOR_SR);
+	XMC_CCU4_SLICE_SetInterruptNode(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0, FREQSENSOR_SR);
+	XMC_CCU4_SLICE_EnableEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	XMC_CCU4_SLICE_EnableEvent(FREQSENSOR_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0);
+
+	// Input with pull-up (open collector outputs of flow and speed sensors)
+	XMC_GPIO_SetMode(FREQSENSOR_PORT, FREQSENSOR_PIN, XMC_GPIO_MODE_INPUT_PULL_UP);
+	XMC_CCU4_EnableClock(CCU40, FREQSENSOR_SLICE_NUMBER);
+	freqsensor_prescaler = (uint8_t)prescaler;
+
+	NVIC_SetPriority(FREQSENSOR_IRQ, FREQSENSOR_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(FREQSENSOR_IRQ);
+	NVIC_EnableIRQ(FREQSENSOR_IRQ);
+	XMC_CCU4_SLICE_StartTimer(FREQSENSOR_SLICE);
+	return true;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// freqsensor_value - returns the measured frequency or duty as a 12 bit value (ADC result interrupt of FREQSENSOR_CHANNEL)
+//****************************************************************************
+RAMCODE
+uint16_t freqsensor_value(void){
+#if FREQSENSOR_DUTY_MODE
+	uint32_t period = freqsensor_high_period;
+	if(period == 0){
+		// No edges: the input rests at 0% or 100% duty
+		return XMC_GPIO_GetInput(FREQSENSOR_PORT, FREQSENSOR_PIN) ? (uint16_t)FREQSENSOR_VALUE_MAX : 0U;
+	}
+	return (uint16_t)((uint32_t)freqsensor_high * FREQSENSOR_VALUE_MAX / period);
+#else
+	uint32_t period = freqsensor_period;
+	if(period == 0)
+		return 0;
+	uint32_t value = FREQSENSOR_VALUE_SCALE / period;
+	return (value > FREQSENSOR_VALUE_MAX) ? (uint16_t)FREQSENSOR_VALUE_MAX : (uint16_t)value;
+#endif
+}
+
+//****************************************************************************
+// freqsensor_set_clock_shift - keeps the capture clock when the CCU4 clock was divided by 2^shift (false = not possible)
+//****************************************************************************
+bool freqsensor_set_clock_shift(uint8_t shift){
+	if(freqsensor_prescaler == 0)
+		return true;
+	if(shift > freqsensor_prescaler)
+		return false;
+
+	// The prescaler can only be written with the timer stopped, the period running meanwhile is not used
+	NVIC_DisableIRQ(FREQSENSOR_IRQ);
+	XMC_CCU4_SLICE_StopTimer(FREQSENSOR_SLICE);
+	XMC_CCU4_SLICE_SetPrescaler(FREQSENSOR_SLICE, (XMC_CCU4_SLICE_PRESCALER_t)(freqsensor_prescaler - shift));
+	freqsensor_discard = true;
+	XMC_CCU4_SLICE_StartTimer(FREQSENSOR_SLICE);
+	NVIC_EnableIRQ(FREQSENSOR_IRQ);
+	return true;
+}
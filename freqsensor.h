@@ -0,0 +1,44 @@
+/*
+ * USB-Changer freqsensor.h
+ *
+ * Frequency or PWM output sensor (flow meters, hall speed sensors, PWM output humidity or pressure sensors) on a
+ * relay channel instead of the ADC. CCU40 slice 3 runs in capture mode at FREQSENSOR_CLOCK: the rising edge of the
+ * input captures the timer into C1V and clears it (the period), the falling edge captures it into C3V (the high time).
+ * The capture itself needs no CPU, the rising edge interrupt (SR3) only reads both registers. The period match of the
+ * 16 bit timer counts wraps, so periods above 65ms are measured too (the high time only below), and no edge within
+ * FREQSENSOR_TIMEOUT means the signal is lost. The ADC result interrupt of FREQSENSOR_CHANNEL replaces the conversion
+ * by freqsensor_value (one division), so the measured value runs through the same fault check, filter, calibration,
+ * hysteresis and latch as a sample and is sampled at the conversion rate. The value is the frequency scaled to
+ * FREQSENSOR_FULL_SCALE_HZ = 4095 (12 bit full scale of a conversion), or the duty with FREQSENSOR_DUTY_MODE (100% = 4095).
+ * Slice 3 is the sensor trigger with COIL_ENABLED and the profiler timer with FUNCPROF_ENABLED, and the capture input
+ * P0.9 (CCU40.IN3) is IO_USB_OE on the TSSOP16 of this board: the input needs a board variant with the USB mux enable
+ * on another pin, both other options off.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FREQSENSOR_H
+#define FREQSENSOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define FREQSENSOR_ENABLED			 0							// Determines if FREQSENSOR_CHANNEL measures the input pin instead of the ADC (needs a board variant)
+#define FREQSENSOR_CHANNEL			 0							// Relay channel of the measured value
+#define FREQSENSOR_DUTY_MODE		 0							// 0 = value is the frequency, 1 = value is the duty (PWM output sensors)
+#define FREQSENSOR_PORT				 XMC_GPIO_PORT0				// Capture input P0.9 (CCU40.IN3, IO_USB_OE on this board)
+#define FREQSENSOR_PIN				 9U
+#define FREQSENSOR_CLOCK			 1000000U					// In Hz. Capture timer clock (1 tick = 1us, same prescaler search as the hrtimer)
+#define FREQSENSOR_FULL_SCALE_HZ	 1000U						// In Hz. Frequency of value 4095 (higher frequencies saturate)
+#define FREQSENSOR_TIMEOUT			 500						// In ms. Longest period, no rising edge within it is a lost signal (value 0 or the pin level)
+#define FREQSENSOR_IRQ_PRIORITY		 IRQPRIO_FREQSENSOR			// Priority of the CCU40 SR3 interrupt
+
+extern volatile uint32_t freqsensor_period;		// In ticks. Last full period (0 = no signal)
+extern volatile uint16_t freqsensor_edges;		// Measured periods (wraps around)
+
+bool freqsensor_init(void);
+uint16_t freqsensor_value(void);
+bool freqsensor_set_clock_shift(uint8_t shift);
+
+#endif /* FREQSENSOR_H */
@@ -0,0 +1,32 @@
+/*
+ * USB-Changer fsm.c
+ *
+ * Table driven state machine (see fsm.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stddef.h>
+#include "fsm.h"
+
+
+//****************************************************************************
+// fsm_dispatch - fires the first transition of state the pending events and its guard allow. Returns true if one fired
+//****************************************************************************
+bool fsm_dispatch(const fsm_t *fsm, uint8_t state, uint16_t events){
+	if(events == 0 || state >= fsm->state_count)
+		return false;
+	const fsm_transition_t *row = &fsm->transitions[fsm->first[state]];
+	const fsm_transition_t *end = &fsm->transitions[fsm->first[state + 1U]];
+	for(; row < end; row++){
+		if((row->events & events) == 0 || (row->guard != NULL && !row->guard(state)))
+			continue;
+		uint8_t next = (row->next == FSM_STAY) ? state : row->next;
+		if(next != state)
+			fsm->change(next);
+		if(row->action != NULL)
+			row->action(state, next);
+		return true;
+	}
+	return false;
+}
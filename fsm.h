@@ -0,0 +1,40 @@
+/*
+ * USB-Changer fsm.h
+ *
+ * Table driven state machine. The transitions of all states are one const table (flash), sorted by state and in
+ * priority order within a state; first holds the index of the first row of every state. fsm_dispatch only scans the
+ * rows of the current state and fires the first one whose events are pending and whose guard holds: the state is
+ * changed (change callback, skipped for FSM_STAY) and then the action runs with the old and the new state.
+ * Events are a bit mask, the meaning of the bits is up to the user (e.g. button presses, see manage_setup in main.c).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FSM_H
+#define FSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FSM_STAY					 0xFFU						// next of a transition that keeps the state
+
+typedef bool (*fsm_guard_t)(uint8_t state);
+typedef void (*fsm_action_t)(uint8_t from, uint8_t to);
+
+typedef struct {
+	uint16_t events;						// Events that fire the transition (any of them)
+	uint8_t next;							// State after the transition (FSM_STAY = unchanged)
+	fsm_guard_t guard;						// Additional condition, called with the current state (NULL = none)
+	fsm_action_t action;					// Run after the state change (NULL = none)
+} fsm_transition_t;
+
+typedef struct {
+	const fsm_transition_t *transitions;	// Rows of all states, sorted by state
+	const uint8_t *first;					// Index of the first row of every state, first[state_count] = number of rows
+	uint8_t state_count;
+	void (*change)(uint8_t state);			// Sets the state variable of the user
+} fsm_t;
+
+bool fsm_dispatch(const fsm_t *fsm, uint8_t state, uint16_t events);
+
+#endif /* FSM_H */
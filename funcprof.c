@@ -0,0 +1,129 @@
+/*
+ * USB-Changer funcprof.c
+ *
+ * Function level cycle profiler (see funcprof.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "funcprof.h"
+#include "ramcode.h"
+
+#define FUNCPROF_SLICE_NUMBER		 3U
+#define FUNCPROF_SR					 XMC_CCU4_SLICE_SR_ID_2		// CCU40.SR2 = CCU40_2_IRQn
+#define FUNCPROF_IRQ				 CCU40_2_IRQn
+
+funcprof_stat_t funcprof_stats[FUNCPROF_REGION_COUNT];
+funcprof_frame_t funcprof_stack[FUNCPROF_DEPTH];
+uint8_t funcprof_depth = 0;
+volatile uint32_t funcprof_wraps = 0;
+uint32_t funcprof_overflows = 0;
+uint32_t funcprof_unbalanced = 0;
+
+
+#if FUNCPROF_ENABLED
+//****************************************************************************
+// CCU40_2_IRQHandler - period match of the cycle slice: counts a wrap of the 16 bit timer
+//****************************************************************************
+RAMCODE
+void CCU40_2_IRQHandler(void){
+	XMC_CCU4_SLICE_ClearEvent(FUNCPROF_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	funcprof_wraps++;
+}
+#endif
+
+//****************************************************************************
+// funcprof_init - starts the cycle slice (CCU40 must be initialized). Returns false if profiling is not compiled in
+//****************************************************************************
+bool funcprof_init(void){
+#if FUNCPROF_ENABLED
+	// Timer: edge aligned and free running over the full 16 bits at PCLK / 2 = MCLK
+	XMC_CCU4_SLICE_COMPARE_CONFIG_t timer_config = {
+		.timer_mode = (uint32_t)XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+		.monoshot = (uint32_t)XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+		.prescaler_initval = (uint32_t)XMC_CCU4_SLICE_PRESCALER_2
+	};
+	XMC_CCU4_SLICE_CompareInit(FUNCPROF_SLICE, &timer_config);
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(FUNCPROF_SLICE, 0xFFFFU);
+	XMC_CCU4_SLICE_SetTimerCompareMatch(FUNCPROF_SLICE, 0U);
+	XMC_CCU4_EnableShadowTransfer(CCU40, (uint32_t)XMC_CCU4_SHADOW_TRANSFER_SLICE_3);
+	XMC_CCU4_SLICE_SetInterruptNode(FUNCPROF_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, FUNCPROF_SR);
+	XMC_CCU4_SLICE_EnableEvent(FUNCPROF_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	XMC_CCU4_EnableClock(CCU40, FUNCPROF_SLICE_NUMBER);
+
+	NVIC_SetPriority(FUNCPROF_IRQ, FUNCPROF_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(FUNCPROF_IRQ);
+	NVIC_EnableIRQ(FUNCPROF_IRQ);
+	XMC_CCU4_SLICE_StartTimer(FUNCPROF_SLICE);
+	return true;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// funcprof_reset - clears all statistics (regions running at the moment are recorded when they are left)
+//****************************************************************************
+void funcprof_reset(void){
+	__disable_irq();
+	for(uint8_t i = 0; i < FUNCPROF_REGION_COUNT; i++)
+		funcprof_stats[i] = (funcprof_stat_t){0};
+	funcprof_overflows = 0;
+	funcprof_unbalanced = 0;
+	__enable_irq();
+}
+
+//****************************************************************************
+// funcprof_cycles - returns the current cycle count (wraps after 2^32 cycles = 134s at 32MHz, 0 if not compiled in)
+//****************************************************************************
+uint32_t funcprof_cycles(void){
+#if FUNCPROF_ENABLED
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t cycles = funcprof_now();
+	__set_PRIMASK(primask);
+	return cycles;
+#else
+	return 0;
+#endif
+}
+
+//****************************************************************************
+// funcprof_exit - ends the innermost region and adds it to the statistics of region and to the nested time of its parent
+//****************************************************************************
+RAMCODE
+void funcprof_exit(funcprof_regions region){
+#if FUNCPROF_ENABLED
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t now = funcprof_now();
+	uint8_t depth = funcprof_depth;
+	if(depth == 0){
+		funcprof_unbalanced++;
+	}
+	else if(--depth >= FUNCPROF_DEPTH){
+		funcprof_overflows++;
+	}
+	else{
+		const funcprof_frame_t *frame = &funcprof_stack[depth];
+		uint32_t total = now - frame->start;
+		uint32_t self = total - frame->nested;
+		if(depth > 0)
+			funcprof_stack[depth - 1U].nested += total;
+
+		funcprof_stat_t *stat = &funcprof_stats[region];
+		if(total > stat->max)
+			stat->max = total;
+		if(self > stat->self_max)
+			stat->self_max = self;
+		stat->total += total;
+		stat->self += self;
+		stat->count++;
+	}
+	funcprof_depth = depth;
+	__set_PRIMASK(primask);
+#else
+	(void)region;
+#endif
+}
@@ -0,0 +1,113 @@
+/*
+ * USB-Changer funcprof.h
+ *
+ * Function level cycle profiler. The Cortex-M0 has no DWT cycle counter, so CCU40 slice 3 runs free at PCLK / 2 =
+ * MCLK as cycle source: its 16 bit timer is extended to 32 bits by a wrap counter (period match interrupt SR2), so a
+ * count is exactly one CPU cycle, also while clockscale lowers MCLK (PCLK is divided the same way).
+ * FUNCPROF_ENTER at the start and FUNCPROF_EXIT(region) before every return of a region read the timer (two register
+ * reads with interrupts masked, inline at the entry, first thing of funcprof_exit at the exit) and keep the entry time
+ * on a nesting stack. Per region the number of runs, the total and maximum time including the nested regions and the
+ * self time without them are recorded in funcprof_stats.
+ * Instrumented interrupts that preempt a region are nested regions of it, so its self time does not contain them.
+ * The stack is shared by all contexts, which is correct as long as every region is left in the context it was
+ * entered in (interrupts nest strictly).
+ * Regions cover the hot functions of main.c, SYSTIMER, E_EEPROM_XMC1, ADC_MEASUREMENT and PWM_CCU4 (the markers in the
+ * generated files have to be added again after a DAVE code generation). Read the results with a debugger
+ * ("funcprof_report" of tools/profiler_report.gdb). The markers cost about 20 cycles per run (counted in the parent).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef FUNCPROF_H
+#define FUNCPROF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define FUNCPROF_ENABLED			 0							// Determines if the region markers are compiled in (0 removes all FUNCPROF_* calls and leaves slice 3 unused)
+#define FUNCPROF_DEPTH				 8							// Maximum nesting depth of regions (deeper regions are only counted in funcprof_overflows)
+#define FUNCPROF_IRQ_PRIORITY		 IRQPRIO_FUNCPROF			// Priority of the CCU40 SR2 interrupt (highest, a wrap must be counted before the next one)
+
+typedef enum {
+	FUNCPROF_ADC_HANDLER,	// Adc_Measurement_Handler (main.c)
+	FUNCPROF_MANAGE_RELAY,	// manage_relay (main.c)
+	FUNCPROF_TASK_UI,		// task_ui: buttons, setup menu and USB switchover (main.c)
+	FUNCPROF_SYSTICK,		// SysTick_Handler (SYSTIMER)
+	FUNCPROF_DISPATCH,		// SYSTIMER_DispatchDeferred (SYSTIMER)
+	FUNCPROF_EEPROM_WRITE,	// E_EEPROM_XMC1_Write
+	FUNCPROF_EEPROM_READ,	// E_EEPROM_XMC1_Read
+	FUNCPROF_EEPROM_GC_STEP,// E_EEPROM_XMC1_StepGarbageCollection
+	FUNCPROF_FLASH_PROGRAM,	// Programming of one flash block or page (E_EEPROM_XMC1)
+	FUNCPROF_FLASH_ERASE,	// Erase of one flash page (E_EEPROM_XMC1)
+	FUNCPROF_ADC_START,		// ADC_MEASUREMENT_StartConversion (sensor_restart only, the other conversions start with hal_adc_start)
+	FUNCPROF_PWM_DUTY,		// PWM_CCU4_SetDutyCycle
+	FUNCPROF_LED_PWM_ISR,	// CCU40_0_IRQHandler: status LED fade step on the PWM_CCU4 slice (ledfade.c)
+	FUNCPROF_REGION_COUNT
+} funcprof_regions;
+
+typedef struct {
+	uint32_t count;			// Number of runs
+	uint32_t max;			// In cycles. Longest run including the nested regions
+	uint32_t self_max;		// In cycles. Longest run without the nested regions
+	uint64_t total;			// In cycles. Sum of all runs including the nested regions
+	uint64_t self;			// In cycles. Sum of all runs without the nested regions
+} funcprof_stat_t;
+
+typedef struct {
+	uint32_t start;			// Cycle count at the entry
+	uint32_t nested;		// In cycles. Time of the nested regions that completed so far
+} funcprof_frame_t;
+
+extern funcprof_stat_t funcprof_stats[FUNCPROF_REGION_COUNT];
+extern funcprof_frame_t funcprof_stack[FUNCPROF_DEPTH];
+extern uint8_t funcprof_depth;				// Number of entered regions (also the ones deeper than FUNCPROF_DEPTH)
+extern volatile uint32_t funcprof_wraps;	// Number of timer wraps (upper 16 bits of the cycle count)
+extern uint32_t funcprof_overflows;			// Regions not measured because the stack was full
+extern uint32_t funcprof_unbalanced;		// FUNCPROF_EXIT without a FUNCPROF_ENTER
+
+bool funcprof_init(void);
+void funcprof_reset(void);
+uint32_t funcprof_cycles(void);
+void funcprof_exit(funcprof_regions region);
+
+#if FUNCPROF_ENABLED
+#include "xmc_ccu4.h"
+
+#define FUNCPROF_SLICE				 CCU40_CC43					// Free running timer slice (slice 0 = LED PWM, 1 = sensor trigger, 2 = hrtimer, needs COIL_ENABLED 0)
+
+//****************************************************************************
+// funcprof_now - returns the cycle count (interrupts masked: a wrap that is not counted yet shows as the PMUS flag)
+//****************************************************************************
+static inline uint32_t funcprof_now(void){
+	uint32_t timer = FUNCPROF_SLICE->TIMER;
+	uint32_t wraps = funcprof_wraps;
+	// Small timer value with the flag set: the wrap happened before the timer was read
+	if((FUNCPROF_SLICE->INTS & CCU4_CC4_INTS_PMUS_Msk) != 0U && timer < 0x8000U)
+		wraps++;
+	return (wraps << 16) | timer;
+}
+
+//****************************************************************************
+// funcprof_enter - starts a region: pushes the entry time
+//****************************************************************************
+static inline void funcprof_enter(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint8_t depth = funcprof_depth;
+	if(depth < FUNCPROF_DEPTH){
+		funcprof_stack[depth].nested = 0;
+		funcprof_stack[depth].start = funcprof_now();
+	}
+	funcprof_depth = depth + 1U;
+	__set_PRIMASK(primask);
+}
+
+	#define FUNCPROF_ENTER()				funcprof_enter()
+	#define FUNCPROF_EXIT(region)			funcprof_exit(region)
+#else
+	#define FUNCPROF_ENTER()
+	#define FUNCPROF_EXIT(region)
+#endif
+
+#endif /* FUNCPROF_H */
@@ -0,0 +1,80 @@
+/*
+ * USB-Changer hal.h
+ *
+ * Thin register access for the hot paths (interrupts and every main loop pass). The DAVE APPs stay for the
+ * initialisation only: their run time functions take a handle in flash and load the slice, module or port pointer and
+ * the transfer masks from it on every call (flash wait states also from RAMCODE), the assert aside. The HAL_* constants
+ * below are the values of the DAVE configuration (pwm_ccu4_conf.c, adc_measurement_conf.c), so every access folds to
+ * a store to a fixed address. hal_check compares them with the handles at boot: a regenerated configuration that
+ * moved an instance is refused (ledfade_init fails) instead of driving the wrong slice.
+ * Pins of a DIGITAL_IO instance name are in pins.h (PINS_*). The DIGITAL_IO functions of the handles from tables
+ * (relay channels, USB ports) are inline already and stay, so the host simulation still sees every pin change.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "DAVE.h"
+
+// PWM_CCU4_LED_STATUS (pwm_ccu4_conf.c)
+#define HAL_LED_MODULE				 CCU40						// ccu4_module_ptr
+#define HAL_LED_SLICE				 CCU40_CC40					// ccu4_slice_ptr
+#define HAL_LED_SHADOW				 XMC_CCU4_SHADOW_TRANSFER_SLICE_0			// shadow_txfr_msk
+#define HAL_LED_DITHER_SHADOW		 XMC_CCU4_SHADOW_TRANSFER_DITHER_SLICE_0	// dither_shadow_txfr_msk
+// ADC_SENSOR (adc_measurement_conf.c, background request source of GLOBAL_ADC_0)
+#define HAL_ADC_MODULE				 VADC
+
+//****************************************************************************
+// hal_check - returns false if the DAVE configuration no longer matches the HAL_* constants (boot)
+//****************************************************************************
+static inline bool hal_check(void){
+	return PWM_CCU4_LED_STATUS.ccu4_module_ptr == (XMC_CCU4_MODULE_t *)HAL_LED_MODULE
+			&& PWM_CCU4_LED_STATUS.ccu4_slice_ptr == (XMC_CCU4_SLICE_t *)HAL_LED_SLICE
+			&& PWM_CCU4_LED_STATUS.shadow_txfr_msk == (uint32_t)HAL_LED_SHADOW
+			&& PWM_CCU4_LED_STATUS.dither_shadow_txfr_msk == (uint32_t)HAL_LED_DITHER_SHADOW
+			&& ADC_SENSOR.global_handle->module_ptr == (XMC_VADC_GLOBAL_t *)HAL_ADC_MODULE;
+}
+
+//****************************************************************************
+// hal_led_compare - writes the compare shadow register of the status LED (PWM_CCU4_SetCompareRaw)
+//****************************************************************************
+static inline void hal_led_compare(uint16_t compare){
+	HAL_LED_SLICE->CRS = compare;
+	HAL_LED_MODULE->GCSS = (uint32_t)HAL_LED_SHADOW;
+}
+
+//****************************************************************************
+// hal_led_compare_dither - writes the compare and dither compare shadow registers of the status LED (PWM_CCU4_SetCompareDitherRaw)
+//****************************************************************************
+static inline void hal_led_compare_dither(uint16_t compare, uint8_t dither){
+	HAL_LED_SLICE->CRS = compare;
+	HAL_LED_SLICE->DITS = dither;
+	HAL_LED_MODULE->GCSS = (uint32_t)HAL_LED_SHADOW | (uint32_t)HAL_LED_DITHER_SHADOW;
+}
+
+//****************************************************************************
+// hal_led_clear_period_match - acknowledges the period match event of the status LED slice
+//****************************************************************************
+static inline void hal_led_clear_period_match(void){
+	HAL_LED_SLICE->SWR = (uint32_t)CCU4_CC4_SWR_RPM_Msk;
+}
+
+//****************************************************************************
+// hal_led_timer - returns the timer value of the status LED slice
+//****************************************************************************
+static inline uint16_t hal_led_timer(void){
+	return (uint16_t)HAL_LED_SLICE->TIMER;
+}
+
+//****************************************************************************
+// hal_adc_start - issues a load event of the background source (ADC_MEASUREMENT_StartConversion)
+//****************************************************************************
+static inline void hal_adc_start(void){
+	HAL_ADC_MODULE->BRSMR |= (uint32_t)VADC_BRSMR_LDEV_Msk;
+}
+
+#endif /* HAL_H */
@@ -0,0 +1,65 @@
+/*
+ * USB-Changer hostbus.c
+ *
+ * Multi-drop host bus (see hostbus.h). The frame end times are a ring with one producer (the receive interrupt) and
+ * one consumer (hostcmd_task), each index is only written by one side. The task takes one time per frame it decodes,
+ * the receive ring keeps them in the same order.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "hostbus.h"
+#include "metrics.h"
+
+typedef char hostbus_stamps_check[((HOSTBUS_STAMPS & (HOSTBUS_STAMPS - 1)) == 0 && HOSTBUS_ADDRESS_MAX < HOSTBUS_REPLY
+		&& HOSTBUS_ADDRESS_DEFAULT >= 1U && HOSTBUS_ADDRESS_DEFAULT <= HOSTBUS_ADDRESS_MAX) ? 1 : -1];
+
+uint8_t hostbus_address = HOSTBUS_ADDRESS_DEFAULT;
+volatile uint8_t hostbus_rx_state = HOSTBUS_RX_CODE;
+volatile uint8_t hostbus_rx_code = 0;
+volatile uint32_t hostbus_frames = 0;
+volatile uint32_t hostbus_filtered = 0;
+uint32_t hostbus_stamps[HOSTBUS_STAMPS];		// In us. Delimiter times of the accepted frames
+volatile uint8_t hostbus_stamp_head = 0;		// Written by the interrupt
+volatile uint8_t hostbus_stamp_tail = 0;		// Written by main context
+METRICS_REGISTER(hostbus_frames, METRICS_ID_HOSTBUS_FRAMES, METRICS_TYPE_U32, METRICS_UNIT_COUNT, hostbus_frames);
+METRICS_REGISTER(hostbus_filtered, METRICS_ID_HOSTBUS_FILTERED, METRICS_TYPE_U32, METRICS_UNIT_COUNT, hostbus_filtered);
+
+
+//****************************************************************************
+// hostbus_stamp - takes the time of the delimiter of an accepted frame (receive interrupt)
+//****************************************************************************
+void hostbus_stamp(void){
+	hostbus_frames++;
+	uint8_t head = hostbus_stamp_head;
+	uint8_t next = (uint8_t)((head + 1U) & (HOSTBUS_STAMPS - 1U));
+	// A full ring keeps the older times: the task takes the fallback for the frames beyond
+	if(next == hostbus_stamp_tail)
+		return;
+	hostbus_stamps[head] = SYSTIMER_GetTimeUs();
+	hostbus_stamp_head = next;
+}
+
+//****************************************************************************
+// hostbus_frame_end - returns the delimiter time of the next decoded frame in us (fallback if none was taken, main context)
+//****************************************************************************
+uint32_t hostbus_frame_end(uint32_t fallback){
+	uint8_t tail = hostbus_stamp_tail;
+	if(tail == hostbus_stamp_head)
+		return fallback;
+	uint32_t time = hostbus_stamps[tail];
+	hostbus_stamp_tail = (uint8_t)((tail + 1U) & (HOSTBUS_STAMPS - 1U));
+	return time;
+}
+
+//****************************************************************************
+// hostbus_set_address - changes the address of this unit. Returns false if it is not a unit address
+//****************************************************************************
+bool hostbus_set_address(uint32_t address){
+	if(address == HOSTBUS_BROADCAST || address > HOSTBUS_ADDRESS_MAX)
+		return false;
+	// A byte write, the receive interrupt compares against the old or the new address
+	hostbus_address = (uint8_t)address;
+	return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * USB-Changer hostbus.h
+ *
+ * Addressed multi-drop variant of the host protocol for racks where one host manages many units on a shared RS-485
+ * line (the telemetry UART with a transceiver with automatic direction control, like the Modbus slave). Every request
+ * is led by the address of the unit: COBS([address][command][sequence][payload][CRC-8]), the CRC covers the address.
+ * Address HOSTBUS_BROADCAST (0) reaches every unit and is never answered, so a setting change or a timed command
+ * (HOSTCMD_AT) updates the whole fleet with one frame. The answer to an addressed request is led by the reply address
+ * (HOSTBUS_REPLY | address): unit addresses end at HOSTBUS_ADDRESS_MAX, so no unit ever takes an answer or the echo
+ * of its own for a request.
+ * The USIC has no address match in UART mode, so the receive interrupt filters (hostbus_filter): the COBS code byte
+ * after a delimiter is held back until the address behind it decides the frame, a code byte of 1 is the zero of a
+ * broadcast. Frames for other units never reach the receive ring and cost a few cycles per byte. The interrupt also
+ * takes the time of the delimiter of every accepted frame (hostbus_stamp): all units receive the last byte of a
+ * broadcast at the same moment, so times counted from it agree between the units within their interrupt latencies.
+ * There is only one talker on a bus: with HOSTBUS_ENABLED the telemetry stream stays off and only the answers are
+ * sent. The address is a host setting (HOSTCMD_SETTING_BUS_ADDRESS, stored by HOSTCMD_COMMIT). Units fresh from the
+ * factory share HOSTBUS_ADDRESS_DEFAULT, a broadcast HOSTCMD_BUS_ASSIGN gives the unit of one serial number its own.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef HOSTBUS_H
+#define HOSTBUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOSTBUS_ENABLED				 0							// Determines if requests are addressed and filtered and the telemetry stream is off (needs TELEMETRY_ENABLED and an RS-485 transceiver)
+#define HOSTBUS_BROADCAST			 0U							// Address of every unit (no answer)
+#define HOSTBUS_ADDRESS_MAX			 127U						// Highest unit address
+#define HOSTBUS_ADDRESS_DEFAULT		 HOSTBUS_ADDRESS_MAX		// Address of a unit without a stored one
+#define HOSTBUS_REPLY				 0x80U						// Set in the address that leads an answer
+#define HOSTBUS_STAMPS				 8							// Frame end times kept for the task (power of 2, more than the frames received within one HOSTCMD_TASK_PERIOD)
+
+typedef enum {
+	HOSTBUS_RX_CODE,		// Next byte is the first code byte of a frame
+	HOSTBUS_RX_ADDRESS,		// Code byte held, next byte is the address
+	HOSTBUS_RX_ACCEPT,		// Frame for this unit, bytes go to the receive ring
+	HOSTBUS_RX_REJECT		// Frame for another unit, dropped up to its delimiter
+} hostbus_rx_states;
+
+typedef enum {
+	HOSTBUS_DROP,			// The byte is not stored
+	HOSTBUS_KEEP,			// The byte is stored
+	HOSTBUS_KEEP_HELD		// hostbus_rx_code is stored first, then the byte
+} hostbus_actions;
+
+extern uint8_t hostbus_address;					// Address of this unit (1 to HOSTBUS_ADDRESS_MAX)
+extern volatile uint8_t hostbus_rx_state;		// hostbus_rx_states, written by the receive interrupt only
+extern volatile uint8_t hostbus_rx_code;		// Code byte held back until the address
+extern volatile uint32_t hostbus_frames;		// Frames accepted (own address and broadcasts)
+extern volatile uint32_t hostbus_filtered;		// Frames for other units dropped by the filter
+
+void hostbus_stamp(void);
+uint32_t hostbus_frame_end(uint32_t fallback);
+bool hostbus_set_address(uint32_t address);
+
+//****************************************************************************
+// hostbus_filter - decides on a received byte, returns a hostbus_actions (receive interrupt)
+//****************************************************************************
+static inline uint8_t hostbus_filter(uint8_t data){
+	uint8_t state = hostbus_rx_state;
+	if(data == 0){
+		hostbus_rx_state = HOSTBUS_RX_CODE;
+		if(state == HOSTBUS_RX_ACCEPT){
+			hostbus_stamp();
+			return HOSTBUS_KEEP;
+		}
+		if(state == HOSTBUS_RX_REJECT)
+			hostbus_filtered++;
+		return HOSTBUS_DROP;
+	}
+	switch(state){
+		case HOSTBUS_RX_CODE:
+			// A code byte of 1 is an empty block: the first decoded byte is the zero of a broadcast
+			if(data == 1U){
+				hostbus_rx_state = HOSTBUS_RX_ACCEPT;
+				return HOSTBUS_KEEP;
+			}
+			hostbus_rx_code = data;
+			hostbus_rx_state = HOSTBUS_RX_ADDRESS;
+			return HOSTBUS_DROP;
+		case HOSTBUS_RX_ADDRESS:
+			if(data == hostbus_address){
+				hostbus_rx_state = HOSTBUS_RX_ACCEPT;
+				return HOSTBUS_KEEP_HELD;
+			}
+			hostbus_rx_state = HOSTBUS_RX_REJECT;
+			return HOSTBUS_DROP;
+		case HOSTBUS_RX_ACCEPT:
+			return HOSTBUS_KEEP;
+		default:
+			return HOSTBUS_DROP;
+	}
+}
+
+#endif /* HOSTBUS_H */
@@ -0,0 +1,191 @@
+/*
+ * USB-Changer hostcmd.c
+ *
+ * Host command protocol (see hostcmd.h). The COBS decoder keeps its state between task runs: a code byte gives the
+ * number of data bytes that follow until the next code byte, a zero is inserted before every code byte except the
+ * first and after a 0xFF block. The trailing zero of the last block is never inserted, so a frame ends right at its
+ * delimiter.
+ * A HOSTCMD_AT request is copied into one slot and started on an hrtimer (created with the first one, so builds that
+ * never use it keep the timer), whose interrupt only wakes the main loop for hostcmd_run.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "hostcmd.h"
+#include "ramcode.h"
+#include "metrics.h"
+#include "arena.h"
+#include "hostbus.h"
+#include "hrtimer.h"
+
+#define HOSTCMD_FRAME_MAX			 (TELEMETRY_PAYLOAD_MAX + 4)	// address (host bus), command, sequence, payload, CRC
+#define HOSTCMD_ADDRESS_SIZE		 (HOSTBUS_ENABLED ? 1U : 0U)	// In bytes. Unit address that leads a request
+
+ARENA(hostcmd) uint8_t hostcmd_frame[HOSTCMD_FRAME_MAX];	// Decoded bytes of the frame being received
+uint8_t hostcmd_length = 0;					// Number of decoded bytes
+uint8_t hostcmd_block_left = 0;				// Data bytes left in the current COBS block (0 = next byte is a code byte)
+uint8_t hostcmd_block_code = 0;				// Code byte of the current block (0 = first block of the frame)
+bool hostcmd_overflow = false;				// Frame longer than HOSTCMD_FRAME_MAX, dropped at its delimiter
+hostcmd_handler_t hostcmd_handler = NULL;
+uint32_t hostcmd_requests = 0;
+uint32_t hostcmd_bad_frames = 0;
+uint32_t hostcmd_timed = 0;
+uint32_t hostcmd_late = 0;
+hostcmd_wake_t hostcmd_wake = NULL;
+uint32_t hostcmd_timer = 0;					// hrtimer of HOSTCMD_AT (0 = not created)
+uint8_t hostcmd_at[HOSTCMD_FRAME_MAX];		// [command][payload] of the pending HOSTCMD_AT
+uint8_t hostcmd_at_length = 0;
+volatile bool hostcmd_at_due = false;		// Set by the timer, hostcmd_run runs the command
+METRICS_REGISTER(hostcmd_requests, METRICS_ID_HOSTCMD_REQUESTS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, hostcmd_requests);
+METRICS_REGISTER(hostcmd_bad_frames, METRICS_ID_HOSTCMD_BAD_FRAMES, METRICS_TYPE_U32, METRICS_UNIT_COUNT, hostcmd_bad_frames);
+
+
+//****************************************************************************
+// hostcmd_init - sets the request handler
+//****************************************************************************
+void hostcmd_init(hostcmd_handler_t handler, hostcmd_wake_t wake){
+	hostcmd_handler = handler;
+	hostcmd_wake = wake;
+}
+
+//****************************************************************************
+// hostcmd_timer_callback - the delay of HOSTCMD_AT has passed (hrtimer interrupt)
+//****************************************************************************
+void hostcmd_timer_callback(void *args){
+	(void)args;
+	hostcmd_at_due = true;
+	if(hostcmd_wake != NULL)
+		hostcmd_wake();
+}
+
+//****************************************************************************
+// hostcmd_schedule - queues the command of a HOSTCMD_AT request for delay after frame_end (in us). Returns a hostcmd_status
+//****************************************************************************
+uint8_t hostcmd_schedule(const uint8_t *payload, uint8_t length, uint32_t frame_end){
+	if(length < 3)
+		return HOSTCMD_STATUS_BAD_LENGTH;
+	if(payload[2] == HOSTCMD_AT)
+		return HOSTCMD_STATUS_UNKNOWN_COMMAND;
+	if(hostcmd_timer == 0){
+		hostcmd_timer = hrtimer_create(hostcmd_timer_callback, NULL);
+		if(hostcmd_timer == 0)
+			return HOSTCMD_STATUS_NO_TIMER;
+	}
+	// A pending command is replaced
+	hrtimer_stop(hostcmd_timer);
+	hostcmd_at_due = false;
+	hostcmd_at_length = (uint8_t)(length - 2U);
+	for(uint8_t i = 0; i < hostcmd_at_length; i++)
+		hostcmd_at[i] = payload[2U + i];
+
+	uint32_t delay = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8);
+	uint32_t elapsed = SYSTIMER_GetTimeUs() - frame_end;
+	if(elapsed >= delay){
+		hostcmd_late++;
+		hostcmd_timer_callback(NULL);
+	}
+	else
+		hrtimer_start(hostcmd_timer, (delay - elapsed) / SYSTIMER_WARP_RATE); // The delay counts in SysTick time
+	return HOSTCMD_STATUS_OK;
+}
+
+//****************************************************************************
+// hostcmd_run - runs the command of HOSTCMD_AT once it is due (main loop, woken by the callback of hostcmd_init)
+//****************************************************************************
+void hostcmd_run(void){
+	if(!hostcmd_at_due)
+		return;
+	hostcmd_at_due = false;
+	hostcmd_timed++;
+	uint8_t response[HOSTCMD_RESPONSE_MAX];
+	uint8_t response_length = 0;
+	if(hostcmd_handler != NULL)
+		hostcmd_handler(hostcmd_at[0], &hostcmd_at[1], (uint8_t)(hostcmd_at_length - 1U), response, &response_length);
+}
+
+//****************************************************************************
+// hostcmd_append - adds a decoded byte to the frame
+//****************************************************************************
+void hostcmd_append(uint8_t data){
+	if(hostcmd_length >= HOSTCMD_FRAME_MAX)
+		hostcmd_overflow = true;
+	else
+		hostcmd_frame[hostcmd_length++] = data;
+}
+
+//****************************************************************************
+// hostcmd_dispatch - checks a complete frame, runs the handler and sends the response
+//****************************************************************************
+void hostcmd_dispatch(void){
+	// End of the frame on the bus (the time the receive interrupt took, the frame after a full ring takes now)
+	uint32_t frame_end = SYSTIMER_GetTimeUs();
+#if HOSTBUS_ENABLED
+	frame_end = hostbus_frame_end(frame_end);
+#endif
+	// The COBS code bytes must cover the frame exactly
+	if(hostcmd_overflow || hostcmd_block_left != 0 || hostcmd_length < 3U + HOSTCMD_ADDRESS_SIZE){
+		hostcmd_bad_frames++;
+		return;
+	}
+	uint8_t crc = 0;
+	for(uint8_t i = 0; i < hostcmd_length - 1U; i++)
+		crc = telemetry_crc8(crc, hostcmd_frame[i]);
+	if(crc != hostcmd_frame[hostcmd_length - 1U]){
+		hostcmd_bad_frames++;
+		return;
+	}
+	hostcmd_requests++;
+	// The filter of the receive interrupt only let this unit and broadcasts through
+	const uint8_t *request = &hostcmd_frame[HOSTCMD_ADDRESS_SIZE];
+	uint8_t length = (uint8_t)(hostcmd_length - 3U - HOSTCMD_ADDRESS_SIZE);
+	bool broadcast = HOSTBUS_ENABLED && hostcmd_frame[0] == HOSTBUS_BROADCAST;
+
+	uint8_t response[3 + HOSTCMD_RESPONSE_MAX];
+	uint8_t response_length = 0;
+	response[0] = request[0];
+	response[1] = request[1];
+	if(request[0] == HOSTCMD_AT)
+		response[2] = hostcmd_schedule(&request[2], length, frame_end);
+	else
+		response[2] = (hostcmd_handler != NULL) ? hostcmd_handler(request[0], &request[2], length, &response[3], &response_length) : (uint8_t)HOSTCMD_STATUS_UNKNOWN_COMMAND;
+	if(response[2] != HOSTCMD_STATUS_OK || response_length > HOSTCMD_RESPONSE_MAX)
+		response_length = 0;
+	// A broadcast is never answered (every unit would talk at once)
+	if(broadcast)
+		return;
+	// A response that does not fit is dropped (counted by telemetry), the host repeats the request
+	telemetry_send(TELEMETRY_RECORD_RESPONSE, response, (uint8_t)(3U + response_length));
+}
+
+//****************************************************************************
+// hostcmd_task - decodes the received bytes and handles complete requests (scheduler task, HOSTCMD_TASK_PERIOD)
+//****************************************************************************
+void hostcmd_task(void){
+	uint8_t data[HOSTCMD_BYTES_PER_RUN];
+	uint8_t count = telemetry_read(data, HOSTCMD_BYTES_PER_RUN);
+
+	for(uint8_t i = 0; i < count; i++){
+		uint8_t byte = data[i];
+		if(byte == 0){
+			// Delimiter (a lone delimiter between frames is no frame)
+			if(hostcmd_length != 0 || hostcmd_block_code != 0 || hostcmd_overflow)
+				hostcmd_dispatch();
+			hostcmd_length = 0;
+			hostcmd_block_left = 0;
+			hostcmd_block_code = 0;
+			hostcmd_overflow = false;
+		}
+		else if(hostcmd_block_left == 0){
+			// Code byte: the block before it ended with a zero (unless it was a full 0xFF block)
+			if(hostcmd_block_code != 0 && hostcmd_block_code != 0xFFU)
+				hostcmd_append(0);
+			hostcmd_block_code = byte;
+			hostcmd_block_left = (uint8_t)(byte - 1U);
+		}
+		else{
+			hostcmd_append(byte);
+			hostcmd_block_left--;
+		}
+	}
+}
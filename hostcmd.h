@@ -0,0 +1,149 @@
+/*
+ * USB-Changer hostcmd.h
+ *
+ * Host command protocol on the telemetry UART. Requests use the telemetry framing (COBS([command][sequence][payload]
+ * [CRC-8]) followed by 0x00, see telemetry.h) and are decoded byte by byte from the receive ring by hostcmd_task, a
+ * partial frame simply waits for the next run. Every valid request is answered by a TELEMETRY_RECORD_RESPONSE record
+ * with the payload [command][sequence of the request][status][data]. Values are 32 bit little endian.
+ *
+ *	HOSTCMD_GET		[id]					-> [id][value]		Read a setting
+ *	HOSTCMD_SET		[id][value]				-> [id]				Apply a setting (not stored yet)
+ *	HOSTCMD_BATCH	([id][value]) * n		-> [n]				Apply several settings at once (all or none)
+ *	HOSTCMD_COMMIT	-						-> -				Store the applied settings (one deferred EEPROM record write)
+ *	HOSTCMD_UPDATE	-						-> -				Reset into the resident firmware updater after the response (see updater.h)
+ *	HOSTCMD_METRICS_LIST [first]			-> [count][first]([id (2)][type][unit]) * n	Describe the registered metrics (see metrics.h)
+ *	HOSTCMD_METRICS_READ [first]			-> [count][first]([value]) * n	Read their values
+ *	HOSTCMD_SUBSCRIBE [id (2)][policy][interval (2)][deadband]	-> -	Send a metric as TELEMETRY_RECORD_DELTA when it moves (see telesub.h)
+ *	HOSTCMD_UNSUBSCRIBE [id (2)]			-> -				End a subscription (0xFFFF = all)
+ *	HOSTCMD_FACTORY_READ -					-> [factory fields]	Read the factory calibration (no data = not written, see factory.h)
+ *	HOSTCMD_FACTORY_WRITE [factory fields]	-> -				Write it once (end of line test, programmed when the main loop is idle)
+ *	HOSTCMD_AT		[delay (2, us)][command][payload]	-> -	Run the command delay after the end of this request (one pending, a new one replaces it)
+ *	HOSTCMD_BUS_ASSIGN [serial (4)][address]	-> -			The unit of this factory serial number takes the bus address (stored, see hostbus.h)
+ *	HOSTCMD_TIME_WARP [time (4, ms)]		-> -				Jump the SysTick time forward (soak test builds with SYSTIMER_TIME_WARP_ENABLED only)
+ *
+ * HOSTCMD_AT is the synchronised command of a fleet on the host bus: sent as a broadcast, every unit runs it at the same
+ * time counted from the end of the one frame (within the interrupt latencies, tens of us). The delay must cover the
+ * decoding (HOSTCMD_TASK_PERIOD and the pass that runs it, HOSTCMD_AT_DELAY_MIN is safe), a later decode runs the
+ * command at once and counts it in hostcmd_late. The command is run by the main loop through hostcmd_run (woken by the
+ * callback given to hostcmd_init) with the handler of the requests, its status is not answered.
+ *
+ * The metrics responses hold up to METRICS_VALUES_MAX entries from index first on and count, the size of the table: a
+ * host reads the whole table with first = 0, METRICS_VALUES_MAX, ... below count and needs no knowledge of the firmware.
+ *
+ * The factory fields are [serial (4)][operate time (4, us)][release time (4, us)][ADC offset (2, signed)][ADC gain (2,
+ * 1.0 = 0x8000)][upper threshold (2)][lower threshold (2)][latch time (2, ms)] (HOSTCMD_FACTORY_SIZE bytes).
+ *
+ * On the host bus (HOSTBUS_ENABLED) every request is led by the unit address, which the dispatch removes again, and
+ * broadcasts are never answered.
+ *
+ * The settings themselves are handled by the callback given to hostcmd_init (main.c).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef HOSTCMD_H
+#define HOSTCMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "telemetry.h"
+
+#define HOSTCMD_TASK_PERIOD			 5							// In ms. Period of hostcmd_task (scheduler task)
+#define HOSTCMD_BYTES_PER_RUN		 64							// Maximum number of received bytes decoded per task run
+#define HOSTCMD_AT_DELAY_MIN		 20000U						// In us. Delay of HOSTCMD_AT every unit decodes in time (the longest is HRTIMER_MAX_US)
+
+typedef enum {
+	HOSTCMD_GET = 0x10,
+	HOSTCMD_SET,
+	HOSTCMD_BATCH,
+	HOSTCMD_COMMIT,
+	HOSTCMD_UPDATE,
+	HOSTCMD_METRICS_LIST,
+	HOSTCMD_METRICS_READ,
+	HOSTCMD_SUBSCRIBE,
+	HOSTCMD_UNSUBSCRIBE,
+	HOSTCMD_FACTORY_READ,
+	HOSTCMD_FACTORY_WRITE,
+	HOSTCMD_AT,
+	HOSTCMD_BUS_ASSIGN,
+	HOSTCMD_TIME_WARP
+} hostcmd_commands;
+
+typedef enum {
+	HOSTCMD_STATUS_OK,
+	HOSTCMD_STATUS_UNKNOWN_COMMAND,
+	HOSTCMD_STATUS_BAD_LENGTH,
+	HOSTCMD_STATUS_BAD_ID,
+	HOSTCMD_STATUS_OUT_OF_RANGE,
+	HOSTCMD_STATUS_BUSY,			// The button setup menu is open
+	HOSTCMD_STATUS_NO_SPACE,		// No free subscription slot
+	HOSTCMD_STATUS_LOCKED,			// The factory calibration is already written (or its write is pending)
+	HOSTCMD_STATUS_NO_TIMER			// No hrtimer left for HOSTCMD_AT
+} hostcmd_status;
+
+typedef enum {
+	HOSTCMD_SETTING_UPPER_THRESHOLD,	// ADC value, stored
+	HOSTCMD_SETTING_LOWER_THRESHOLD,	// ADC value, stored
+	HOSTCMD_SETTING_LATCHTIME,			// In ms, stored
+	HOSTCMD_SETTING_SAMPLE_PERIOD,		// In ms. Telemetry sample record period (not stored)
+	HOSTCMD_SETTING_CAPTURE_MODE,		// capture_modes (not stored)
+	HOSTCMD_SETTING_WALLCLOCK,			// Unix time of the RTC (0 = not set, kept through warm resets)
+	HOSTCMD_SETTING_USB_ALARM,			// Unix time the USB port is switched at (0 = none, must be in the future, not stored)
+	HOSTCMD_SETTING_USB_PORT,			// USB_states (USB_inactive = standby, all ports off), stored like a switch by the USB button
+	HOSTCMD_SETTING_USB_FAILOVER,		// 1 = automatic port failover (FAILOVER_ENABLED builds, not stored)
+	HOSTCMD_SETTING_PREDICT_RATE,		// ADC values per ms. Slope that shortens the latch time (0 = off, not stored, see relay.h)
+	HOSTCMD_SETTING_MIN_HIGH_TIME,		// In ms. Shortest time the relay stays on (rate limiter, 0 = off, not stored)
+	HOSTCMD_SETTING_MIN_LOW_TIME,		// In ms. Shortest time the relay stays off (not stored)
+	HOSTCMD_SETTING_SWITCH_RATE_MAX,	// Most relay switches per RELAY_RATE_WINDOW (0 = unlimited, not stored)
+	HOSTCMD_SETTING_RELAY_CYCLES,		// Contact cycles of the relay (set 0 after replacing it, stored, see relaylife.h)
+	HOSTCMD_SETTING_COIL_PULLIN_TIME,	// In ms. Full drive of the relay coil after switching on (COIL_ENABLED builds, not stored, see coil.h)
+	HOSTCMD_SETTING_COIL_HOLD_DUTY,		// In %. PWM duty of the relay coil after the pull-in (not stored)
+	HOSTCMD_SETTING_ADC_PROFILE,		// sensor_profiles. Resolution and sample time of the conversions (not stored, see sensor.h)
+	HOSTCMD_SETTING_ADC_READ,			// Set: sensor channel, converts it at once (result in a TRACE_ADC_READ event). Get: last result
+	HOSTCMD_SETTING_ADC_SAMPLE_TIME,	// Sample time code (STCS) of all profiles, 0xFF = the ones of the profiles. Stored, set by HOSTCMD_SETTING_ADC_SAMPLE_CAL
+	HOSTCMD_SETTING_FAULT_SAFE_STATE,	// relay_states the relay is forced to on a sensor fault (applies to the next fault, not stored, see relay.h)
+	HOSTCMD_SETTING_RELAY_OPERATE_TIME,	// Get: average operate time of the relay in us (the factory time or 0 until measured, RELAYTIME_ENABLED builds). Set 0: clears its statistics
+	HOSTCMD_SETTING_RELAY_RELEASE_TIME,	// Get: average release time in us. Set 0: clears its statistics
+	HOSTCMD_SETTING_PROFILE,			// Active threshold profile (0 to SETTINGS_PROFILE_COUNT - 1), stored like a switch by the chord. Uncommitted changes of the old one are dropped
+	HOSTCMD_SETTING_PROFILE_DAY_START,	// Minute of the day (UTC wall clock) the schedule selects profile 0 at (1440 = no schedule, not stored)
+	HOSTCMD_SETTING_PROFILE_NIGHT_START,	// Minute of the day the schedule selects profile 1 at (1440 = no schedule, not stored)
+	HOSTCMD_SETTING_LATCH_AREA,			// ADC values * ms. Area beyond the threshold that switches the relay (0 = latch time, not stored, see relay.h)
+	HOSTCMD_SETTING_AREA_LEAK,			// ADC values. Excess that adds nothing to the area (not stored)
+	HOSTCMD_SETTING_LATCH_ADAPT_RATE,	// False switches per day the adapted latch time allows (0 = fixed latch time, not stored, see relay.h)
+	HOSTCMD_SETTING_LATCH_ADAPT_MIN,	// In ms. Shortest adapted latch time (not stored)
+	HOSTCMD_SETTING_LATCH_ADAPTED,		// In ms. Latch time in use (read only, writing 0 restarts the adaptation)
+	HOSTCMD_SETTING_ENERGY_CURRENT,		// energy_consumers << ENERGY_SETTING_SHIFT | current in uA of the energy estimate (not stored, see energy.h). Get: the last set consumer
+	HOSTCMD_SETTING_USB_LED_LEVEL,		// Brightness of the lit USB indicator (0 to LEDFADE_LEVEL_MAX, SOFTPWM_ENABLED builds, not stored, see softpwm.h)
+	HOSTCMD_SETTING_GOVERNOR_MARGIN,	// ADC value. Distance to a threshold below which the sensor converts at the full rate (SENSOR_GOVERNOR builds, not stored, see sensor.h)
+	HOSTCMD_SETTING_ROLLBACK,			// Previous settings record applied (1 = the one before the stored, 0 = the stored record, up to the kept ones). Stored by HOSTCMD_COMMIT
+	HOSTCMD_SETTING_BISTABLE_PULSE_TIME,	// In ms. Coil pulse of the latching relay (BISTABLE_ENABLED builds, not stored, see bistable.h)
+	HOSTCMD_SETTING_BUS_ADDRESS,		// Address on the host bus (1 to HOSTBUS_ADDRESS_MAX, the answer to the set already uses it), stored by HOSTCMD_COMMIT
+	HOSTCMD_SETTING_ADC_SAMPLE_CAL,		// Set: allowed error in ADC values (0 = SENSOR_SAMPLE_CAL_ERROR), calibrates and stores HOSTCMD_SETTING_ADC_SAMPLE_TIME. Get: 1 while it runs
+	HOSTCMD_SETTING_COUNT
+} hostcmd_settings;
+
+#define HOSTCMD_FACTORY_SIZE		 22							// In bytes. Factory fields of HOSTCMD_FACTORY_READ and HOSTCMD_FACTORY_WRITE
+#define HOSTCMD_RESPONSE_MAX		 (TELEMETRY_PAYLOAD_MAX - 3)	// In bytes. Longest response data (a response record carries command, sequence and status too)
+
+// Handles a decoded request: returns a hostcmd_status and writes up to HOSTCMD_RESPONSE_MAX bytes of response data
+typedef uint8_t (*hostcmd_handler_t)(uint8_t command, const uint8_t *payload, uint8_t length, uint8_t *response, uint8_t *response_length);
+// Wakes the main loop for hostcmd_run (hrtimer interrupt)
+typedef void (*hostcmd_wake_t)(void);
+
+extern uint32_t hostcmd_requests;			// Valid requests
+extern uint32_t hostcmd_bad_frames;			// Frames dropped for a wrong CRC, a wrong length or an overflow
+extern uint32_t hostcmd_timed;				// Commands run by HOSTCMD_AT
+extern uint32_t hostcmd_late;				// HOSTCMD_AT decoded after its time (run at once)
+
+void hostcmd_init(hostcmd_handler_t handler, hostcmd_wake_t wake);
+void hostcmd_task(void);
+void hostcmd_run(void);
+
+//****************************************************************************
+// hostcmd_get32 - reads a little endian value from a request payload
+//****************************************************************************
+static inline uint32_t hostcmd_get32(const uint8_t *p){
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#endif /* HOSTCMD_H */
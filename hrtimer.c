@@ -0,0 +1,284 @@
+/*
+ * USB-Changer hrtimer.c
+ *
+ * Microsecond one-shot timers (see hrtimer.h). CCU40 slice 2 runs in single shot mode with a 1MHz timer clock and is
+ * armed with the time until the earliest deadline, its period match interrupt (SR1) expires the timer. A compare
+ * match on a free running slice does not work here: the XMC1100 takes a new compare value over only at the next
+ * period match. Started timers are kept in a list sorted by deadline, each entry holds its ticks after the entry
+ * before it (delta list, like the SYSTIMER delta list). Whenever the list changes the slice is stopped, the ticks it
+ * ran are taken from the head and it is armed again for the new head. The few cycles between stop and restart are
+ * lost, so deadlines can only become later, never earlier.
+ * The list is changed with the slice interrupt disabled in the NVIC (like supply.c), so the functions can be used from
+ * main context and from the callbacks, but not from a second interrupt that could preempt the main context.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "hrtimer.h"
+#include "ramcode.h"
+#include "critical.h"
+#include "timebase.h"
+
+#if TIMEBASE_ENABLED
+	#define HRTIMER_SLICE			 CCU40_CC41					// Timer slice of the service (slices 2 and 3 = time base, the sensor is triggered by the sample task)
+	#define HRTIMER_SLICE_NUMBER	 1U
+	#define HRTIMER_SHADOW			 XMC_CCU4_SHADOW_TRANSFER_SLICE_1
+#else
+	#define HRTIMER_SLICE			 CCU40_CC42					// Timer slice of the service (slice 0 = LED PWM, slices 1 and 3 = sensor trigger and relay coil)
+	#define HRTIMER_SLICE_NUMBER	 2U
+	#define HRTIMER_SHADOW			 XMC_CCU4_SHADOW_TRANSFER_SLICE_2
+#endif
+#define HRTIMER_SR					 XMC_CCU4_SLICE_SR_ID_1		// CCU40.SR1 = CCU40_1_IRQn
+#define HRTIMER_IRQ					 CCU40_1_IRQn
+#define HRTIMER_CLOCK				 1000000U					// In Hz. Timer clock (1 tick = 1us)
+#define HRTIMER_NONE				 0xFFU						// End of the list
+
+typedef struct {
+	hrtimer_callback_t callback;
+	void *args;
+	uint16_t delta;			// In ticks. Time after the deadline of the previous timer in the list (head: after the slice was armed)
+	uint8_t next;			// Index of the next timer in the list
+	bool running;			// Timer is in the list
+} hrtimer_t;
+
+hrtimer_t hrtimer_tbl[HRTIMER_COUNT];
+uint8_t hrtimer_count = 0;			// Number of created timers
+uint8_t hrtimer_head = HRTIMER_NONE;	// Timer with the earliest deadline
+uint16_t hrtimer_armed = 0;			// In ticks. Time the slice was armed with (0 = stopped)
+uint8_t hrtimer_prescaler = 0;		// Prescaler giving HRTIMER_CLOCK at the full CCU4 clock (0 = not initialized)
+volatile uint16_t hrtimer_requests[HRTIMER_COUNT];	// In ticks. Timeout left by hrtimer_request (0 = none)
+
+
+//****************************************************************************
+// hrtimer_halt - stops the slice and takes the ticks it ran from the head timer (slice interrupt disabled)
+//****************************************************************************
+RAMCODE
+void hrtimer_halt(void){
+	if(hrtimer_armed == 0)
+		return;
+
+	// A period match stops the single shot timer, the ticks are complete then
+	uint32_t elapsed = hrtimer_armed;
+	XMC_CCU4_SLICE_StopTimer(HRTIMER_SLICE);
+	if(!XMC_CCU4_SLICE_GetEvent(HRTIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH)){
+		uint32_t value = XMC_CCU4_SLICE_GetTimerValue(HRTIMER_SLICE);
+		if(value < elapsed)
+			elapsed = value;
+	}
+	XMC_CCU4_SLICE_ClearTimer(HRTIMER_SLICE);
+	XMC_CCU4_SLICE_ClearEvent(HRTIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	NVIC_ClearPendingIRQ(HRTIMER_IRQ);
+	hrtimer_armed = 0;
+
+	if(hrtimer_head != HRTIMER_NONE)
+		hrtimer_tbl[hrtimer_head].delta -= (uint16_t)elapsed;
+}
+
+//****************************************************************************
+// hrtimer_arm - starts the slice for the head timer (slice interrupt disabled, slice stopped)
+//****************************************************************************
+RAMCODE
+void hrtimer_arm(void){
+	if(hrtimer_head == HRTIMER_NONE)
+		return;
+
+	uint16_t ticks = hrtimer_tbl[hrtimer_head].delta;
+	if(ticks == 0){
+		// Already due, the interrupt expires it once enabled again
+		NVIC_SetPendingIRQ(HRTIMER_IRQ);
+		return;
+	}
+	// The period match comes when the timer reaches the period value (the stopped slice takes it over immediately)
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(HRTIMER_SLICE, ticks);
+	XMC_CCU4_EnableShadowTransfer(CCU40, HRTIMER_SHADOW);
+	hrtimer_armed = ticks;
+	XMC_CCU4_SLICE_StartTimer(HRTIMER_SLICE);
+}
+
+//****************************************************************************
+// hrtimer_unlink - removes a running timer from the list, its ticks go to the next timer (slice halted)
+//****************************************************************************
+void hrtimer_unlink(uint8_t index){
+	hrtimer_t *timer = &hrtimer_tbl[index];
+	uint8_t *link = &hrtimer_head;
+	while(*link != index)
+		link = &hrtimer_tbl[*link].next;
+	*link = timer->next;
+	if(timer->next != HRTIMER_NONE)
+		hrtimer_tbl[timer->next].delta += timer->delta;
+	timer->running = false;
+}
+
+//****************************************************************************
+// hrtimer_link - adds a timer to the list ticks after now (slice halted)
+//****************************************************************************
+void hrtimer_link(uint8_t index, uint16_t ticks){
+	hrtimer_t *timer = &hrtimer_tbl[index];
+	uint8_t *link = &hrtimer_head;
+	// Behind timers with the same deadline, they were started first
+	while(*link != HRTIMER_NONE && hrtimer_tbl[*link].delta <= ticks){
+		ticks -= hrtimer_tbl[*link].delta;
+		link = &hrtimer_tbl[*link].next;
+	}
+	timer->delta = ticks;
+	timer->next = *link;
+	if(timer->next != HRTIMER_NONE)
+		hrtimer_tbl[timer->next].delta -= ticks;
+	*link = index;
+	timer->running = true;
+}
+
+//****************************************************************************
+// CCU40_1_IRQHandler - period match of the timer slice: runs the callbacks of all due timers
+//****************************************************************************
+#if HRTIMER_ENABLED
+RAMCODE
+void CCU40_1_IRQHandler(void){
+	hrtimer_halt();
+	// Timers requested from other interrupts (the slice is halted, the list is ours)
+	for(uint8_t i = 0; i < hrtimer_count; i++){
+		if(hrtimer_requests[i] == 0)
+			continue;
+		critical_state_t primask = critical_enter();
+		uint16_t ticks = hrtimer_requests[i];
+		hrtimer_requests[i] = 0;
+		critical_exit(primask, CRITICAL_SITE_HRTIMER);
+		if(hrtimer_tbl[i].running)
+			hrtimer_unlink((uint8_t)i);
+		hrtimer_link((uint8_t)i, ticks);
+	}
+	while(hrtimer_head != HRTIMER_NONE && hrtimer_tbl[hrtimer_head].delta == 0){
+		hrtimer_t *timer = &hrtimer_tbl[hrtimer_head];
+		hrtimer_head = timer->next;
+		timer->running = false;
+		// The callback may start timers (which arm the slice), so the slice is halted again afterwards
+		timer->callback(timer->args);
+		hrtimer_halt();
+	}
+	hrtimer_arm();
+}
+#endif
+
+//****************************************************************************
+// hrtimer_init - sets up the timer slice (CCU40 must be initialized, the module clock must be 2^n MHz)
+//****************************************************************************
+bool hrtimer_init(void){
+	// Prescaler that divides the module clock exactly to HRTIMER_CLOCK
+	uint32_t prescaler = (uint32_t)XMC_CCU4_SLICE_PRESCALER_1;
+	while((GLOBAL_CCU4_0.module_frequency >> prescaler) > HRTIMER_CLOCK && prescaler < (uint32_t)XMC_CCU4_SLICE_PRESCALER_32768)
+		prescaler++;
+	if((GLOBAL_CCU4_0.module_frequency >> prescaler) != HRTIMER_CLOCK || (GLOBAL_CCU4_0.module_frequency & ((1UL << prescaler) - 1U)) != 0)
+		return false;
+
+	// Timer: edge aligned, stops and raises the period match event after one period
+	XMC_CCU4_SLICE_COMPARE_CONFIG_t timer_config = {
+		.timer_mode = (uint32_t)XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+		.monoshot = (uint32_t)XMC_CCU4_SLICE_TIMER_REPEAT_MODE_SINGLE,
+		.prescaler_initval = prescaler
+	};
+	XMC_CCU4_SLICE_CompareInit(HRTIMER_SLICE, &timer_config);
+	XMC_CCU4_SLICE_SetTimerCompareMatch(HRTIMER_SLICE, 0U);
+	XMC_CCU4_SLICE_SetInterruptNode(HRTIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, HRTIMER_SR);
+	XMC_CCU4_SLICE_EnableEvent(HRTIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	XMC_CCU4_EnableClock(CCU40, HRTIMER_SLICE_NUMBER);
+	hrtimer_prescaler = (uint8_t)prescaler;
+
+	NVIC_SetPriority(HRTIMER_IRQ, HRTIMER_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(HRTIMER_IRQ);
+	NVIC_EnableIRQ(HRTIMER_IRQ);
+	return true;
+}
+
+//****************************************************************************
+// hrtimer_set_clock_shift - keeps the timer clock when the CCU4 clock was divided by 2^shift (false = not possible)
+//****************************************************************************
+bool hrtimer_set_clock_shift(uint8_t shift){
+	if(hrtimer_prescaler == 0)
+		return true;
+	if(shift > hrtimer_prescaler)
+		return false;
+
+	// The prescaler can only be written with the timer stopped
+	NVIC_DisableIRQ(HRTIMER_IRQ);
+	hrtimer_halt();
+	XMC_CCU4_SLICE_SetPrescaler(HRTIMER_SLICE, (XMC_CCU4_SLICE_PRESCALER_t)(hrtimer_prescaler - shift));
+	hrtimer_arm();
+	NVIC_EnableIRQ(HRTIMER_IRQ);
+	return true;
+}
+
+//****************************************************************************
+// hrtimer_create - creates a stopped timer, returns its id (0 = no timer left)
+//****************************************************************************
+uint32_t hrtimer_create(hrtimer_callback_t callback, void *args){
+	if(callback == NULL || hrtimer_count >= HRTIMER_COUNT)
+		return 0;
+
+	NVIC_DisableIRQ(HRTIMER_IRQ);
+	hrtimer_t *timer = &hrtimer_tbl[hrtimer_count];
+	timer->callback = callback;
+	timer->args = args;
+	timer->running = false;
+	uint32_t id = ++hrtimer_count;
+	NVIC_EnableIRQ(HRTIMER_IRQ);
+	return id;
+}
+
+//****************************************************************************
+// hrtimer_start - (re)starts a timer, its callback runs timeout us from now (1 to HRTIMER_MAX_US)
+//****************************************************************************
+bool hrtimer_start(uint32_t id, uint32_t timeout){
+	if(id == 0 || id > hrtimer_count || timeout == 0 || timeout > HRTIMER_MAX_US)
+		return false;
+
+	uint8_t index = (uint8_t)(id - 1U);
+	NVIC_DisableIRQ(HRTIMER_IRQ);
+	hrtimer_halt();
+	if(hrtimer_tbl[index].running)
+		hrtimer_unlink(index);
+	hrtimer_link(index, (uint16_t)timeout);
+	hrtimer_arm();
+	NVIC_EnableIRQ(HRTIMER_IRQ);
+	return true;
+}
+
+//****************************************************************************
+// hrtimer_request - starts a timer from any interrupt (1 to HRTIMER_MAX_US from when the slice interrupt takes it over)
+//****************************************************************************
+RAMCODE
+bool hrtimer_request(uint32_t id, uint32_t timeout){
+	if(id == 0 || id > hrtimer_count || timeout == 0 || timeout > HRTIMER_MAX_US)
+		return false;
+
+	hrtimer_requests[id - 1U] = (uint16_t)timeout;
+	NVIC_SetPendingIRQ(HRTIMER_IRQ);
+	return true;
+}
+
+//****************************************************************************
+// hrtimer_stop - stops a timer (its callback is not run)
+//****************************************************************************
+bool hrtimer_stop(uint32_t id){
+	if(id == 0 || id > hrtimer_count)
+		return false;
+
+	uint8_t index = (uint8_t)(id - 1U);
+	NVIC_DisableIRQ(HRTIMER_IRQ);
+	if(hrtimer_tbl[index].running){
+		hrtimer_halt();
+		hrtimer_unlink(index);
+		hrtimer_arm();
+	}
+	NVIC_EnableIRQ(HRTIMER_IRQ);
+	return true;
+}
+
+//****************************************************************************
+// hrtimer_running - returns true while a timer is started and its callback has not run yet
+//****************************************************************************
+bool hrtimer_running(uint32_t id){
+	if(id == 0 || id > hrtimer_count)
+		return false;
+	return hrtimer_tbl[id - 1U].running;
+}
@@ -0,0 +1,38 @@
+/*
+ * USB-Changer hrtimer.h
+ *
+ * Microsecond one-shot timers on CCU40 slice 2 (SYSTIMER timers have a resolution of one SysTick period). The API
+ * follows SYSTIMER: a timer is created once with its callback and started with a timeout in us, the callback runs in
+ * the interrupt of the slice. Any number of started timers are queued onto the single slice, which is always armed
+ * for the earliest deadline. Delays longer than HRTIMER_MAX_US belong to SYSTIMER.
+ * hrtimer_request starts a timer from an interrupt that may preempt the main context (e.g. the ADC result interrupt):
+ * it leaves the timeout in a mailbox and pends the slice interrupt, which starts the timer once no other hrtimer call
+ * is running. The timeout counts from there, a few us after the request.
+ * With TIMEBASE_ENABLED the service runs on slice 1, slices 2 and 3 are the time base then (timebase.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef HRTIMER_H
+#define HRTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define HRTIMER_ENABLED				 0							// Determines if the slice interrupt runs the timers (needed by the timer users, see main.c)
+#define HRTIMER_COUNT				 4							// Number of timers that can be created
+#define HRTIMER_MAX_US				 65535U						// In us. Longest timeout (16 bit timer at 1MHz)
+#define HRTIMER_IRQ_PRIORITY		 IRQPRIO_HRTIMER			// Priority of the CCU40 SR1 interrupt (time tier with SysTick, above the LED fade, deadlines are short)
+
+typedef void (*hrtimer_callback_t)(void *args);
+
+bool hrtimer_init(void);
+uint32_t hrtimer_create(hrtimer_callback_t callback, void *args);
+bool hrtimer_start(uint32_t id, uint32_t timeout);
+bool hrtimer_request(uint32_t id, uint32_t timeout);
+bool hrtimer_stop(uint32_t id);
+bool hrtimer_running(uint32_t id);
+bool hrtimer_set_clock_shift(uint8_t shift);
+
+#endif /* HRTIMER_H */
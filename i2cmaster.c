@@ -0,0 +1,251 @@
+/*
+ * USB-Changer i2cmaster.c
+ *
+ * Interrupt driven I2C master (see i2cmaster.h). The queue is changed with all interrupts masked, submits come from
+ * the main context, the SysTick poll timer and the completion callbacks in the channel interrupt alike. A transfer is
+ * started within the same masked section, so the FIFO is filled once with its complete sequence.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_i2c.h"
+#include "i2cmaster.h"
+#include "telemetry.h"
+#include "i2ctarget.h"
+#include "spistream.h"
+#include "modbus.h"
+#include "metrics.h"
+#include "timing.h"
+#include "critical.h"
+
+#if I2CMASTER_ENABLED && (TELEMETRY_ENABLED || I2CTARGET_ENABLED || SPISTREAM_ENABLED || MODBUS_ENABLED)
+#error "The I2C master shares USIC0 channel 0 and its pins with the telemetry UART, the I2C target, the SPI stream and the Modbus slave"
+#endif
+
+#define I2CMASTER_CHANNEL			 XMC_I2C0_CH0
+#define I2CMASTER_IRQ				 USIC0_4_IRQn
+#define I2CMASTER_SR				 4U							// Service request of the protocol events (SR4 = USIC0_4_IRQn)
+#define I2CMASTER_FIFO_SIZE			 16U						// In words. Transmit FIFO at DPTR 0, receive FIFO behind it
+#define I2CMASTER_EVENTS			 (XMC_I2C_CH_EVENT_STOP_CONDITION_RECEIVED | XMC_I2C_CH_EVENT_NACK | XMC_I2C_CH_EVENT_ARBITRATION_LOST | XMC_I2C_CH_EVENT_ERROR)
+#define I2CMASTER_FLAGS				 (XMC_I2C_CH_STATUS_FLAG_STOP_CONDITION_RECEIVED | XMC_I2C_CH_STATUS_FLAG_NACK_RECEIVED | XMC_I2C_CH_STATUS_FLAG_ARBITRATION_LOST | XMC_I2C_CH_STATUS_FLAG_ERROR)
+
+// Longest sequence: start, write bytes, repeated start, read commands, stop
+typedef char i2cmaster_fifo_check[(3 + 2 * I2CMASTER_DATA_MAX <= I2CMASTER_FIFO_SIZE && (I2CMASTER_QUEUE & (I2CMASTER_QUEUE - 1)) == 0
+		&& I2CMASTER_TIMEOUT >= 2 * I2CMASTER_TICK) ? 1 : -1];
+
+uint32_t i2cmaster_transfers = 0;
+uint32_t i2cmaster_errors = 0;
+#if I2CMASTER_ENABLED
+METRICS_REGISTER(i2cmaster_errors, METRICS_ID_I2CMASTER_ERRORS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, i2cmaster_errors);
+#endif
+i2cmaster_transfer_t *i2cmaster_queue[I2CMASTER_QUEUE];
+uint8_t i2cmaster_head = 0;						// Free running, the queue holds head - tail transfers
+uint8_t i2cmaster_tail = 0;
+i2cmaster_transfer_t *volatile i2cmaster_active = NULL;	// Transfer on the bus (NULL = idle)
+volatile uint8_t i2cmaster_result = I2CMASTER_STATUS_BUSY;	// Status of the active transfer once its stop is seen
+uint32_t i2cmaster_deadline = 0;				// In us. Timeout of the active transfer
+i2cmaster_poll_t *i2cmaster_polls = NULL;		// Registered polls
+bool i2cmaster_ready = false;
+
+
+//****************************************************************************
+// i2cmaster_reset - drops the sequence in the FIFOs and returns the channel to idle (no stop condition)
+//****************************************************************************
+void i2cmaster_reset(void){
+	XMC_USIC_CH_SetMode(I2CMASTER_CHANNEL, XMC_USIC_CH_OPERATING_MODE_IDLE);
+	XMC_USIC_CH_TXFIFO_Flush(I2CMASTER_CHANNEL);
+	XMC_USIC_CH_RXFIFO_Flush(I2CMASTER_CHANNEL);
+	XMC_I2C_CH_ClearStatusFlag(I2CMASTER_CHANNEL, I2CMASTER_FLAGS);
+	XMC_I2C_CH_Start(I2CMASTER_CHANNEL);
+	NVIC_ClearPendingIRQ(I2CMASTER_IRQ);
+}
+
+//****************************************************************************
+// i2cmaster_start_next - puts the sequence of the next queued transfer into the transmit FIFO (interrupts masked)
+//****************************************************************************
+void i2cmaster_start_next(void){
+	if(i2cmaster_active != NULL || i2cmaster_tail == i2cmaster_head)
+		return;
+	i2cmaster_transfer_t *transfer = i2cmaster_queue[i2cmaster_tail & (I2CMASTER_QUEUE - 1U)];
+	i2cmaster_tail++;
+	i2cmaster_active = transfer;
+	i2cmaster_result = I2CMASTER_STATUS_BUSY;
+	i2cmaster_deadline = timing_deadline(SYSTIMER_GetTime(), I2CMASTER_TIMEOUT);
+	transfer->status = I2CMASTER_STATUS_BUSY;
+
+	uint16_t address = (uint16_t)(transfer->address << 1);
+	if(transfer->write_count > 0){
+		XMC_I2C_CH_MasterStart(I2CMASTER_CHANNEL, address, XMC_I2C_CH_CMD_WRITE);
+		for(uint8_t i = 0; i < transfer->write_count; i++)
+			XMC_I2C_CH_MasterTransmit(I2CMASTER_CHANNEL, transfer->write[i]);
+		if(transfer->read_count > 0)
+			XMC_I2C_CH_MasterRepeatedStart(I2CMASTER_CHANNEL, address, XMC_I2C_CH_CMD_READ);
+	}
+	else
+		XMC_I2C_CH_MasterStart(I2CMASTER_CHANNEL, address, XMC_I2C_CH_CMD_READ);
+	// Every read byte but the last is acknowledged
+	for(uint8_t i = 0; i < transfer->read_count; i++){
+		if(i + 1U < transfer->read_count)
+			XMC_I2C_CH_MasterReceiveAck(I2CMASTER_CHANNEL);
+		else
+			XMC_I2C_CH_MasterReceiveNack(I2CMASTER_CHANNEL);
+	}
+	XMC_I2C_CH_MasterStop(I2CMASTER_CHANNEL);
+}
+
+//****************************************************************************
+// i2cmaster_finish - completes a transfer taken off the bus and starts the next one
+//****************************************************************************
+void i2cmaster_finish(i2cmaster_transfer_t *transfer, uint8_t status){
+	if(status == I2CMASTER_STATUS_DONE)
+		i2cmaster_transfers++;
+	else
+		i2cmaster_errors++;
+	transfer->status = status;
+	if(transfer->callback != NULL)
+		transfer->callback(transfer);
+
+	critical_state_t primask = critical_enter();
+	i2cmaster_start_next();
+	critical_exit(primask, CRITICAL_SITE_I2CMASTER);
+}
+
+#if I2CMASTER_ENABLED
+//****************************************************************************
+// USIC0_4_IRQHandler - end of the active transfer: stop condition, NACK, arbitration loss or protocol error
+//****************************************************************************
+void USIC0_4_IRQHandler(void){
+	uint32_t flags = XMC_I2C_CH_GetStatusFlag(I2CMASTER_CHANNEL) & I2CMASTER_FLAGS;
+	XMC_I2C_CH_ClearStatusFlag(I2CMASTER_CHANNEL, flags);
+	i2cmaster_transfer_t *transfer = i2cmaster_active;
+	if(transfer == NULL)
+		return; // Ended by the timeout meanwhile
+
+	if(flags & (XMC_I2C_CH_STATUS_FLAG_ARBITRATION_LOST | XMC_I2C_CH_STATUS_FLAG_ERROR)){
+		// Bus lost to another master or the sequence broken: no stop of our own
+		i2cmaster_reset();
+		i2cmaster_active = NULL;
+		i2cmaster_finish(transfer, I2CMASTER_STATUS_ERROR);
+		return;
+	}
+	if((flags & XMC_I2C_CH_STATUS_FLAG_NACK_RECEIVED) && i2cmaster_result == I2CMASTER_STATUS_BUSY){
+		// The rest of the sequence is dropped, its stop condition ends the transfer
+		XMC_USIC_CH_TXFIFO_Flush(I2CMASTER_CHANNEL);
+		XMC_I2C_CH_MasterStop(I2CMASTER_CHANNEL);
+		i2cmaster_result = I2CMASTER_STATUS_NACK;
+		return;
+	}
+	if(!(flags & XMC_I2C_CH_STATUS_FLAG_STOP_CONDITION_RECEIVED))
+		return;
+
+	uint8_t count = 0;
+	while(!XMC_USIC_CH_RXFIFO_IsEmpty(I2CMASTER_CHANNEL)){
+		uint8_t data = (uint8_t)XMC_USIC_CH_RXFIFO_GetData(I2CMASTER_CHANNEL);
+		if(count < transfer->read_count)
+			transfer->read[count] = data;
+		count++;
+	}
+	uint8_t status = i2cmaster_result;
+	if(status == I2CMASTER_STATUS_BUSY)
+		status = (count == transfer->read_count) ? I2CMASTER_STATUS_DONE : I2CMASTER_STATUS_ERROR;
+	i2cmaster_active = NULL;
+	i2cmaster_finish(transfer, status);
+}
+#endif
+
+//****************************************************************************
+// i2cmaster_tick - ends an expired transfer and submits the due polls (SYSTIMER callback, I2CMASTER_TICK)
+//****************************************************************************
+void i2cmaster_tick(void *args){
+	(void)args;
+	critical_state_t primask = critical_enter();
+	i2cmaster_transfer_t *transfer = i2cmaster_active;
+	if(transfer != NULL && timing_reached(SYSTIMER_GetTime(), i2cmaster_deadline)){
+		i2cmaster_reset();
+		i2cmaster_active = NULL;
+	}
+	else
+		transfer = NULL;
+	critical_exit(primask, CRITICAL_SITE_I2CMASTER);
+	if(transfer != NULL)
+		i2cmaster_finish(transfer, I2CMASTER_STATUS_TIMEOUT);
+
+	for(i2cmaster_poll_t *poll = i2cmaster_polls; poll != NULL; poll = poll->next){
+		if(poll->countdown > I2CMASTER_TICK){
+			poll->countdown -= I2CMASTER_TICK;
+			continue;
+		}
+		poll->countdown = poll->period;
+		i2cmaster_submit(poll->transfer); // Skipped while the last one is still queued or on the bus
+	}
+}
+
+//****************************************************************************
+// i2cmaster_init - sets up the channel as I2C master, its pins and the poll timer (call after power_init)
+//****************************************************************************
+bool i2cmaster_init(void){
+#if I2CMASTER_ENABLED
+	const XMC_I2C_CH_CONFIG_t i2c_config = {
+		.baudrate = I2CMASTER_BAUDRATE,
+		.address = 0U
+	};
+	XMC_I2C_CH_Init(I2CMASTER_CHANNEL, &i2c_config);
+	XMC_I2C_CH_SetInputSource(I2CMASTER_CHANNEL, XMC_I2C_CH_INPUT_SDA, USIC0_C0_DX0_P0_15);
+	XMC_I2C_CH_SetInputSource(I2CMASTER_CHANNEL, XMC_I2C_CH_INPUT_SCL, USIC0_C0_DX1_P0_14);
+	XMC_USIC_CH_TXFIFO_Configure(I2CMASTER_CHANNEL, 0U, XMC_USIC_CH_FIFO_SIZE_16WORDS, 1U);
+	XMC_USIC_CH_RXFIFO_Configure(I2CMASTER_CHANNEL, I2CMASTER_FIFO_SIZE, XMC_USIC_CH_FIFO_SIZE_16WORDS, I2CMASTER_FIFO_SIZE - 1U);
+	XMC_I2C_CH_EnableEvent(I2CMASTER_CHANNEL, I2CMASTER_EVENTS);
+	XMC_I2C_CH_SetInterruptNodePointer(I2CMASTER_CHANNEL, I2CMASTER_SR);
+	XMC_I2C_CH_Start(I2CMASTER_CHANNEL);
+
+	const XMC_GPIO_CONFIG_t sda_config = {.mode = XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN_ALT6, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	const XMC_GPIO_CONFIG_t scl_config = {.mode = XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN_ALT7, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	XMC_GPIO_Init(P0_15, &sda_config);
+	XMC_GPIO_Init(P0_14, &scl_config);
+
+	NVIC_SetPriority(I2CMASTER_IRQ, I2CMASTER_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(I2CMASTER_IRQ);
+	NVIC_EnableIRQ(I2CMASTER_IRQ);
+	i2cmaster_ready = true;
+
+	uint32_t timer_id = SYSTIMER_CreateTimer(TIMING_MS_TO_US(I2CMASTER_TICK), SYSTIMER_MODE_PERIODIC, i2cmaster_tick, NULL);
+	if(timer_id == 0)
+		return false;
+	return SYSTIMER_StartTimer(timer_id) == SYSTIMER_STATUS_SUCCESS;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// i2cmaster_submit - queues a transfer (any context), false = not set up, invalid, still in use or queue full
+//****************************************************************************
+bool i2cmaster_submit(i2cmaster_transfer_t *transfer){
+	if(!i2cmaster_ready || transfer == NULL || transfer->write_count > I2CMASTER_DATA_MAX || transfer->read_count > I2CMASTER_DATA_MAX
+			|| transfer->write_count + transfer->read_count == 0)
+		return false;
+
+	critical_state_t primask = critical_enter();
+	bool queued = transfer->status != I2CMASTER_STATUS_QUEUED && transfer->status != I2CMASTER_STATUS_BUSY
+			&& (uint8_t)(i2cmaster_head - i2cmaster_tail) < I2CMASTER_QUEUE;
+	if(queued){
+		transfer->status = I2CMASTER_STATUS_QUEUED;
+		i2cmaster_queue[i2cmaster_head & (I2CMASTER_QUEUE - 1U)] = transfer;
+		i2cmaster_head++;
+		i2cmaster_start_next();
+	}
+	critical_exit(primask, CRITICAL_SITE_I2CMASTER);
+	return queued;
+}
+
+//****************************************************************************
+// i2cmaster_poll_add - registers a transfer that is submitted every period (main context), the first one period from now
+//****************************************************************************
+void i2cmaster_poll_add(i2cmaster_poll_t *poll){
+	critical_state_t primask = critical_enter();
+	poll->countdown = poll->period;
+	poll->next = i2cmaster_polls;
+	i2cmaster_polls = poll;
+	critical_exit(primask, CRITICAL_SITE_I2CMASTER);
+}
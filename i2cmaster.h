@@ -0,0 +1,74 @@
+/*
+ * USB-Changer i2cmaster.h
+ *
+ * Interrupt driven I2C master for digital sensors (USIC0 channel 0, SCL P0.14, SDA P0.15). Transfers are queued by
+ * i2cmaster_submit and executed one after the other without the main loop: the start of a transfer writes its whole
+ * command sequence (start, write bytes, repeated start, read commands with ACK and a final NACK, stop) into the
+ * transmit FIFO at once, the USIC clocks it out on its own and the received bytes collect in the receive FIFO. The
+ * channel interrupt (SR4) only comes at the end: the stop condition drains the receive FIFO into the transfer, a NACK
+ * flushes the rest of the sequence and sends the stop, arbitration loss or a protocol error end it at once. Then the
+ * completion callback of the transfer runs (in the channel interrupt) and the next queued transfer starts.
+ * A periodic SYSTIMER timer (I2CMASTER_TICK) submits the registered polls (i2cmaster_poll_add) at their period and
+ * ends a transfer that did not complete within I2CMASTER_TIMEOUT (held bus, missing pull-ups), its callback runs in
+ * the SysTick interrupt then. Transfers and polls belong to the caller and must stay valid while they are in use.
+ * The bus timing is derived from MCLK and is not adapted by clockscale, the bus only runs slower at the lowered clock.
+ * It uses the channel and pins of the telemetry UART: it excludes TELEMETRY_ENABLED, I2CTARGET_ENABLED,
+ * SPISTREAM_ENABLED and MODBUS_ENABLED.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef I2CMASTER_H
+#define I2CMASTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define I2CMASTER_ENABLED			 0							// Determines if the I2C master is set up (needs TELEMETRY_ENABLED = 0)
+#define I2CMASTER_BAUDRATE			 100000U					// In Hz. Bus clock (standard mode)
+#define I2CMASTER_DATA_MAX			 6							// In bytes. Longest write and read part of a transfer (the sequence must fit the FIFO)
+#define I2CMASTER_QUEUE				 4							// Queued transfers (power of 2)
+#define I2CMASTER_TICK				 10							// In ms. Period of the poll and timeout timer
+#define I2CMASTER_TIMEOUT			 20							// In ms. Longest transfer (at least two ticks)
+#define I2CMASTER_IRQ_PRIORITY		 IRQPRIO_I2CMASTER			// Priority of the USIC0 SR4 interrupt
+
+typedef enum {
+	I2CMASTER_STATUS_IDLE,			// Not submitted yet
+	I2CMASTER_STATUS_QUEUED,		// Waits for the transfers before it
+	I2CMASTER_STATUS_BUSY,			// On the bus
+	I2CMASTER_STATUS_DONE,			// Completed, read holds the received bytes
+	I2CMASTER_STATUS_NACK,			// Address or a written byte not acknowledged
+	I2CMASTER_STATUS_ERROR,			// Arbitration lost, protocol error or fewer bytes received
+	I2CMASTER_STATUS_TIMEOUT		// Not completed within I2CMASTER_TIMEOUT
+} i2cmaster_states;
+
+typedef struct i2cmaster_transfer i2cmaster_transfer_t;
+typedef void (*i2cmaster_callback_t)(i2cmaster_transfer_t *transfer);
+
+struct i2cmaster_transfer {
+	uint8_t address;						// 7 bit target address
+	uint8_t write_count;					// Bytes of write sent first (0 = read only)
+	uint8_t read_count;						// Bytes read into read after a (repeated) start (0 = write only)
+	volatile uint8_t status;				// i2cmaster_states
+	uint8_t write[I2CMASTER_DATA_MAX];
+	uint8_t read[I2CMASTER_DATA_MAX];
+	i2cmaster_callback_t callback;			// Completion (channel or SysTick interrupt, NULL = none)
+	void *args;
+};
+
+typedef struct i2cmaster_poll {
+	i2cmaster_transfer_t *transfer;			// Submitted every period (skipped while still queued or busy)
+	uint16_t period;						// In ms. Multiple of I2CMASTER_TICK
+	uint16_t countdown;						// In ms. Time to the next submit
+	struct i2cmaster_poll *next;
+} i2cmaster_poll_t;
+
+extern uint32_t i2cmaster_transfers;		// Completed transfers
+extern uint32_t i2cmaster_errors;			// Transfers ended by NACK, error or timeout
+
+bool i2cmaster_init(void);
+bool i2cmaster_submit(i2cmaster_transfer_t *transfer);
+void i2cmaster_poll_add(i2cmaster_poll_t *poll);
+
+#endif /* I2CMASTER_H */
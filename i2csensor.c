@@ -0,0 +1,79 @@
+/*
+ * USB-Changer i2csensor.c
+ *
+ * Digital I2C sensor input (see i2csensor.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "i2csensor.h"
+#include "freqsensor.h"
+#include "ramcode.h"
+
+#if I2CSENSOR_ENABLED && !I2CMASTER_ENABLED
+#error "I2CSENSOR_ENABLED needs the I2C master (I2CMASTER_ENABLED)"
+#endif
+#if I2CSENSOR_ENABLED && FREQSENSOR_ENABLED && I2CSENSOR_CHANNEL == FREQSENSOR_CHANNEL
+#error "The I2C sensor and the frequency input replace the same channel"
+#endif
+
+#define I2CSENSOR_VALUE_MAX			 4095U						// 12 bit full scale of a conversion
+
+typedef char i2csensor_config_check[(I2CSENSOR_BYTES >= 1 && I2CSENSOR_BYTES <= 4 && I2CSENSOR_BYTES <= I2CMASTER_DATA_MAX
+		&& I2CSENSOR_PERIOD >= I2CMASTER_TICK && I2CSENSOR_PERIOD % I2CMASTER_TICK == 0) ? 1 : -1];
+
+volatile uint16_t i2csensor_reading = 0;
+uint16_t i2csensor_failures = 0;
+i2cmaster_transfer_t i2csensor_transfer;
+i2cmaster_poll_t i2csensor_poll;
+
+
+//****************************************************************************
+// i2csensor_complete - takes the reading of a finished read (I2C master completion callback)
+//****************************************************************************
+void i2csensor_complete(i2cmaster_transfer_t *transfer){
+	if(transfer->status != I2CMASTER_STATUS_DONE){
+		if(i2csensor_failures < 0xFFFFU)
+			i2csensor_failures++;
+		if(i2csensor_failures >= I2CSENSOR_STALE)
+			i2csensor_reading = 0;
+		return;
+	}
+	uint32_t raw = 0;
+	for(uint8_t i = 0; i < I2CSENSOR_BYTES; i++)
+		raw = (raw << 8) | transfer->read[i];
+	raw >>= I2CSENSOR_SHIFT;
+	i2csensor_reading = (uint16_t)((raw > I2CSENSOR_VALUE_MAX) ? I2CSENSOR_VALUE_MAX : raw);
+	i2csensor_failures = 0;
+}
+
+//****************************************************************************
+// i2csensor_init - registers the read poll (call after i2cmaster_init, false = not enabled or no master)
+//****************************************************************************
+bool i2csensor_init(void){
+#if I2CSENSOR_ENABLED
+	i2csensor_transfer.address = I2CSENSOR_ADDRESS;
+	i2csensor_transfer.write[0] = I2CSENSOR_REGISTER;
+	i2csensor_transfer.write_count = 1;
+	i2csensor_transfer.read_count = I2CSENSOR_BYTES;
+	i2csensor_transfer.status = I2CMASTER_STATUS_IDLE;
+	i2csensor_transfer.callback = i2csensor_complete;
+	i2csensor_transfer.args = NULL;
+	i2csensor_poll.transfer = &i2csensor_transfer;
+	i2csensor_poll.period = I2CSENSOR_PERIOD;
+	i2cmaster_poll_add(&i2csensor_poll);
+	// The first reading comes without waiting a period (false if the master is not set up)
+	return i2cmaster_submit(&i2csensor_transfer);
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// i2csensor_value - returns the latest reading (ADC result interrupt of I2CSENSOR_CHANNEL)
+//****************************************************************************
+RAMCODE
+uint16_t i2csensor_value(void){
+	return i2csensor_reading;
+}
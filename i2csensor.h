@@ -0,0 +1,38 @@
+/*
+ * USB-Changer i2csensor.h
+ *
+ * Digital I2C sensor (temperature, pressure, distance) on a relay channel instead of the ADC. The sensor register
+ * I2CSENSOR_REGISTER is read every I2CSENSOR_PERIOD by an I2C master poll (write the register address, repeated start,
+ * read I2CSENSOR_BYTES big endian bytes), the completion callback turns the reading into a 12 bit value (shifted right
+ * by I2CSENSOR_SHIFT, saturated at the conversion full scale). The ADC result interrupt of I2CSENSOR_CHANNEL replaces
+ * the conversion by the latest reading, so it runs through the same fault check, filter, calibration, hysteresis and
+ * latch as a sample. After I2CSENSOR_STALE failed reads in a row the value is 0, like an open analog line (the
+ * RELAY_FAULT_ENABLED check puts the relay into its safe state then). The defaults fit a TMP102 type temperature
+ * sensor (12 bit result left aligned in a 16 bit register, 1/16 degree C per step, negative readings saturate).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef I2CSENSOR_H
+#define I2CSENSOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2cmaster.h"
+
+#define I2CSENSOR_ENABLED			 0							// Determines if I2CSENSOR_CHANNEL reads the I2C sensor instead of the ADC (needs I2CMASTER_ENABLED)
+#define I2CSENSOR_CHANNEL			 0							// Relay channel of the reading
+#define I2CSENSOR_ADDRESS			 0x48						// 7 bit sensor address
+#define I2CSENSOR_REGISTER			 0x00						// Result register
+#define I2CSENSOR_BYTES				 2							// Result bytes (1 to 4, most significant first)
+#define I2CSENSOR_SHIFT				 4							// Right shift of the result to the 12 bit value
+#define I2CSENSOR_PERIOD			 100						// In ms. Read period (multiple of I2CMASTER_TICK)
+#define I2CSENSOR_STALE				 3							// Failed reads in a row until the value is 0
+
+extern volatile uint16_t i2csensor_reading;		// Latest 12 bit value (0 = none or stale)
+extern uint16_t i2csensor_failures;				// Failed reads in a row
+
+bool i2csensor_init(void);
+uint16_t i2csensor_value(void);
+
+#endif /* I2CSENSOR_H */
@@ -0,0 +1,198 @@
+/*
+ * USB-Changer i2ctarget.c
+ *
+ * I2C target interface (see i2ctarget.h). The interrupt looks the current address up in the map (a few entries) for
+ * every byte. The slave timing is derived from MCLK and is not adapted by clockscale, the lowered clock is still far
+ * above what the USIC needs for I2CTARGET_BAUDRATE.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_i2c.h"
+#include "i2ctarget.h"
+#include "telemetry.h"
+
+#if I2CTARGET_ENABLED && TELEMETRY_ENABLED
+#error "The I2C target and the telemetry UART share USIC0 channel 0 and its pins"
+#endif
+
+#define I2CTARGET_CHANNEL			 XMC_I2C0_CH0
+#define I2CTARGET_IRQ				 USIC0_1_IRQn
+#define I2CTARGET_SR				 1U							// Service request of all events (SR1 = USIC0_1_IRQn)
+#define I2CTARGET_PROTOCOL_EVENTS	 (XMC_I2C_CH_EVENT_START_CONDITION_RECEIVED | XMC_I2C_CH_EVENT_REPEATED_START_CONDITION_RECEIVED | XMC_I2C_CH_EVENT_STOP_CONDITION_RECEIVED | XMC_I2C_CH_EVENT_SLAVE_READ_REQUEST)
+#define I2CTARGET_RECEIVE_FLAGS		 (XMC_I2C_CH_STATUS_FLAG_RECEIVE_INDICATION | XMC_I2C_CH_STATUS_FLAG_ALTERNATIVE_RECEIVE_INDICATION)
+
+volatile uint8_t i2ctarget_command = 0;
+volatile uint8_t i2ctarget_command_status = I2CTARGET_CMD_STATUS_IDLE;
+uint32_t i2ctarget_transfers = 0;
+const i2ctarget_register_t *i2ctarget_map = NULL;
+uint8_t i2ctarget_map_count = 0;
+i2ctarget_command_t i2ctarget_command_callback = NULL;
+uint8_t i2ctarget_address = 0;				// Current register address
+bool i2ctarget_address_next = false;		// The next received byte is the register address
+uint32_t i2ctarget_read_shadow = 0;			// Latched value of the register being read
+uint32_t i2ctarget_write_shadow = 0;		// Collected bytes of the register being written
+const i2ctarget_register_t *i2ctarget_write_register = NULL;	// Register the write shadow belongs to (NULL = none)
+
+
+//****************************************************************************
+// i2ctarget_find - returns the register holding an address and the offset of the address in it (NULL = unmapped)
+//****************************************************************************
+const i2ctarget_register_t *i2ctarget_find(uint8_t address, uint8_t *offset){
+	uint8_t start = 0;
+	for(uint8_t i = 0; i < i2ctarget_map_count; i++){
+		const i2ctarget_register_t *reg = &i2ctarget_map[i];
+		if(address < start + reg->size){
+			*offset = (uint8_t)(address - start);
+			return reg;
+		}
+		start += reg->size;
+	}
+	return NULL;
+}
+
+//****************************************************************************
+// i2ctarget_load - reads a live variable with one load
+//****************************************************************************
+uint32_t i2ctarget_load(const i2ctarget_register_t *reg){
+	switch(reg->width){
+		case 1:
+			return *(volatile uint8_t *)reg->variable;
+		case 2:
+			return *(volatile uint16_t *)reg->variable;
+		default:
+			return *(volatile uint32_t *)reg->variable;
+	}
+}
+
+//****************************************************************************
+// i2ctarget_commit - stores the write shadow into its variable with one store (keeps the bytes above the register)
+//****************************************************************************
+void i2ctarget_commit(void){
+	const i2ctarget_register_t *reg = i2ctarget_write_register;
+	if(reg == NULL)
+		return;
+	i2ctarget_write_register = NULL;
+
+	uint32_t mask = (reg->size >= 4U) ? 0xFFFFFFFFU : ((1UL << (reg->size * 8U)) - 1U);
+	uint32_t value = (i2ctarget_load(reg) & ~mask) | (i2ctarget_write_shadow & mask);
+	switch(reg->width){
+		case 1:
+			*(volatile uint8_t *)reg->variable = (uint8_t)value;
+			break;
+		case 2:
+			*(volatile uint16_t *)reg->variable = (uint16_t)value;
+			break;
+		default:
+			*(volatile uint32_t *)reg->variable = value;
+			break;
+	}
+	if(reg->variable == &i2ctarget_command)
+		i2ctarget_command_status = I2CTARGET_CMD_STATUS_PENDING;
+}
+
+//****************************************************************************
+// i2ctarget_read_byte - returns the byte at the current address and advances it (0xFF = unmapped)
+//****************************************************************************
+uint8_t i2ctarget_read_byte(void){
+	uint8_t offset;
+	const i2ctarget_register_t *reg = i2ctarget_find(i2ctarget_address++, &offset);
+	if(reg == NULL)
+		return 0xFFU;
+	if(offset == 0)
+		i2ctarget_read_shadow = i2ctarget_load(reg);
+	return (uint8_t)(i2ctarget_read_shadow >> (offset * 8U));
+}
+
+//****************************************************************************
+// i2ctarget_write_byte - collects a byte for the current address and advances it (read only and unmapped bytes are ignored)
+//****************************************************************************
+void i2ctarget_write_byte(uint8_t data){
+	uint8_t offset;
+	const i2ctarget_register_t *reg = i2ctarget_find(i2ctarget_address++, &offset);
+	if(reg == NULL || !(reg->access & I2CTARGET_WRITE))
+		return;
+	// A new register commits the one before
+	if(reg != i2ctarget_write_register){
+		i2ctarget_commit();
+		i2ctarget_write_register = reg;
+		i2ctarget_write_shadow = i2ctarget_load(reg);
+	}
+	i2ctarget_write_shadow = (i2ctarget_write_shadow & ~(0xFFUL << (offset * 8U))) | ((uint32_t)data << (offset * 8U));
+}
+
+#if I2CTARGET_ENABLED
+//****************************************************************************
+// USIC0_1_IRQHandler - I2C target events: start, received bytes, read requests and stop
+//****************************************************************************
+void USIC0_1_IRQHandler(void){
+	uint32_t flags = XMC_I2C_CH_GetStatusFlag(I2CTARGET_CHANNEL);
+
+	if(flags & (XMC_I2C_CH_STATUS_FLAG_START_CONDITION_RECEIVED | XMC_I2C_CH_STATUS_FLAG_REPEATED_START_CONDITION_RECEIVED)){
+		XMC_I2C_CH_ClearStatusFlag(I2CTARGET_CHANNEL, XMC_I2C_CH_STATUS_FLAG_START_CONDITION_RECEIVED | XMC_I2C_CH_STATUS_FLAG_REPEATED_START_CONDITION_RECEIVED);
+		i2ctarget_address_next = true;
+	}
+	if(flags & I2CTARGET_RECEIVE_FLAGS){
+		XMC_I2C_CH_ClearStatusFlag(I2CTARGET_CHANNEL, I2CTARGET_RECEIVE_FLAGS);
+		uint8_t data = XMC_I2C_CH_GetReceivedData(I2CTARGET_CHANNEL);
+		if(i2ctarget_address_next){
+			i2ctarget_address_next = false;
+			i2ctarget_address = data;
+		}
+		else
+			i2ctarget_write_byte(data);
+	}
+	if(flags & XMC_I2C_CH_STATUS_FLAG_SLAVE_READ_REQUESTED){
+		XMC_I2C_CH_ClearStatusFlag(I2CTARGET_CHANNEL, XMC_I2C_CH_STATUS_FLAG_SLAVE_READ_REQUESTED);
+		i2ctarget_address_next = false;
+		XMC_I2C_CH_SlaveTransmit(I2CTARGET_CHANNEL, i2ctarget_read_byte());
+	}
+	if(flags & XMC_I2C_CH_STATUS_FLAG_STOP_CONDITION_RECEIVED){
+		XMC_I2C_CH_ClearStatusFlag(I2CTARGET_CHANNEL, XMC_I2C_CH_STATUS_FLAG_STOP_CONDITION_RECEIVED);
+		i2ctarget_commit();
+		i2ctarget_transfers++;
+	}
+}
+#endif
+
+//****************************************************************************
+// i2ctarget_init - sets up the channel as I2C target with a register map (call after power_init)
+//****************************************************************************
+void i2ctarget_init(const i2ctarget_register_t *map, uint8_t count, i2ctarget_command_t command){
+	i2ctarget_map = map;
+	i2ctarget_map_count = count;
+	i2ctarget_command_callback = command;
+#if I2CTARGET_ENABLED
+	const XMC_I2C_CH_CONFIG_t i2c_config = {
+		.baudrate = I2CTARGET_BAUDRATE,
+		.address = (uint16_t)(I2CTARGET_ADDRESS << 1)
+	};
+	XMC_I2C_CH_Init(I2CTARGET_CHANNEL, &i2c_config);
+	XMC_I2C_CH_SetInputSource(I2CTARGET_CHANNEL, XMC_I2C_CH_INPUT_SDA, USIC0_C0_DX0_P0_15);
+	XMC_I2C_CH_SetInputSource(I2CTARGET_CHANNEL, XMC_I2C_CH_INPUT_SCL, USIC0_C0_DX1_P0_14);
+	XMC_I2C_CH_EnableEvent(I2CTARGET_CHANNEL, I2CTARGET_PROTOCOL_EVENTS | XMC_I2C_CH_EVENT_STANDARD_RECEIVE | XMC_I2C_CH_EVENT_ALTERNATIVE_RECEIVE);
+	XMC_I2C_CH_SetInterruptNodePointer(I2CTARGET_CHANNEL, I2CTARGET_SR);
+	XMC_I2C_CH_Start(I2CTARGET_CHANNEL);
+
+	const XMC_GPIO_CONFIG_t sda_config = {.mode = XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN_ALT6, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	const XMC_GPIO_CONFIG_t scl_config = {.mode = XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN_ALT7, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	XMC_GPIO_Init(P0_15, &sda_config);
+	XMC_GPIO_Init(P0_14, &scl_config);
+
+	NVIC_SetPriority(I2CTARGET_IRQ, I2CTARGET_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(I2CTARGET_IRQ);
+	NVIC_EnableIRQ(I2CTARGET_IRQ);
+#endif
+}
+
+//****************************************************************************
+// i2ctarget_task - executes a command written by the controller (scheduler task, I2CTARGET_TASK_PERIOD)
+//****************************************************************************
+void i2ctarget_task(void){
+	if(i2ctarget_command_status != I2CTARGET_CMD_STATUS_PENDING)
+		return;
+	uint8_t command = i2ctarget_command;
+	bool accepted = i2ctarget_command_callback != NULL && i2ctarget_command_callback(command);
+	i2ctarget_command_status = accepted ? I2CTARGET_CMD_STATUS_DONE : I2CTARGET_CMD_STATUS_REJECTED;
+}
@@ -0,0 +1,57 @@
+/*
+ * USB-Changer i2ctarget.h
+ *
+ * I2C target (slave) interface for a supervisory controller (USIC0 channel 0, SCL P0.14, SDA P0.15). The register map
+ * is a table of live variables given to i2ctarget_init, register addresses follow the table order and sizes (byte
+ * addresses, auto increment over register boundaries). A write transfer starts with the register address, the data
+ * bytes that follow are written to writable registers, a read transfer reads from the current address.
+ * Multi byte registers are read consistently: reading the first byte of a register latches the whole variable with
+ * one load into a shadow and the remaining bytes come from the shadow. Writes collect in a shadow as well and are
+ * committed at the stop condition. All transfers are handled in the channel interrupt, writes to the command register
+ * are executed by i2ctarget_task through the callback given to i2ctarget_init.
+ * It uses the channel and pins of the telemetry UART: only one of TELEMETRY_ENABLED and I2CTARGET_ENABLED can be set.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef I2CTARGET_H
+#define I2CTARGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define I2CTARGET_ENABLED			 0							// Determines if the I2C target is set up (needs TELEMETRY_ENABLED = 0)
+#define I2CTARGET_ADDRESS			 0x42						// 7 bit target address
+#define I2CTARGET_BAUDRATE			 100000U					// In Hz. Bus clock of the controller (timing of the USIC sampling)
+#define I2CTARGET_TASK_PERIOD		 5							// In ms. Period of i2ctarget_task (scheduler task)
+#define I2CTARGET_IRQ_PRIORITY		 IRQPRIO_I2CTARGET		// Priority of the USIC0 SR1 interrupt (lowest, the controller waits for the ACK)
+
+#define I2CTARGET_READ				 0x00U						// Register access flags
+#define I2CTARGET_WRITE				 0x01U						// Register is written by the controller (committed at the stop condition)
+
+typedef struct {
+	volatile void *variable;	// Live variable (little endian, register bytes are its lowest bytes)
+	uint8_t width;				// In bytes. Size of the variable (1, 2 or 4), latched with one load
+	uint8_t size;				// In bytes. Size of the register (up to width)
+	uint8_t access;				// I2CTARGET_READ or I2CTARGET_WRITE
+} i2ctarget_register_t;
+
+typedef enum {
+	I2CTARGET_CMD_STATUS_IDLE,		// No command written yet
+	I2CTARGET_CMD_STATUS_PENDING,	// Written, waits for i2ctarget_task
+	I2CTARGET_CMD_STATUS_DONE,		// Executed
+	I2CTARGET_CMD_STATUS_REJECTED	// Unknown or not possible now
+} i2ctarget_command_states;
+
+// Executes a command written to the command register (main context), returns true if it was accepted
+typedef bool (*i2ctarget_command_t)(uint8_t command);
+
+extern volatile uint8_t i2ctarget_command;			// Command register (written by the controller)
+extern volatile uint8_t i2ctarget_command_status;	// i2ctarget_command_states
+extern uint32_t i2ctarget_transfers;				// Completed transfers (stop conditions)
+
+void i2ctarget_init(const i2ctarget_register_t *map, uint8_t count, i2ctarget_command_t command);
+void i2ctarget_task(void);
+
+#endif /* I2CTARGET_H */
@@ -0,0 +1,21 @@
+/*
+ * USB-Changer irqprio.c
+ *
+ * Interrupt priority table (see irqprio.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "irqprio.h"
+
+
+//****************************************************************************
+// irqprio_init - sets the priorities of the vectors DAVE_Init configured from the APP settings (after DAVE_Init)
+//****************************************************************************
+void irqprio_init(void){
+	// SYSTIMER_PRIORITY and the ADC_MEASUREMENT result interrupt priority of the DAVE project are overridden here, so a
+	// code generation with other APP settings cannot move the relay path out of its tier
+	NVIC_SetPriority(SysTick_IRQn, IRQPRIO_SYSTICK);
+	NVIC_SetPriority((IRQn_Type)ADC_SENSOR.result_intr_handle->node_id, IRQPRIO_ADC_RESULT);
+}
@@ -0,0 +1,54 @@
+/*
+ * USB-Changer irqprio.h
+ *
+ * Interrupt priority table. Every NVIC priority of the firmware is taken from here (the *_IRQ_PRIORITY options of the
+ * modules refer to it, irqprio_init applies it to the vectors configured by DAVE APPs), grouped in four tiers of the
+ * 2 bit XMC1100 NVIC priority (0 = highest):
+ *   IRQPRIO_TIER_CRITICAL  relay decision sources and protective events, never delayed by any other handler
+ *   IRQPRIO_TIER_TIME      time bases whose handlers must run within one period
+ *   IRQPRIO_TIER_COMM      communication and UI with hardware buffers of several bytes or periods
+ *   IRQPRIO_TIER_DEFERRED  work that only loses throughput when late (the peer waits or the buffers fill up)
+ * A handler of one tier waits for at most the longest handler of its own and every lower tier that is already running
+ * (one of them, handlers of one priority do not nest) plus all handlers of the higher tiers that get due meanwhile, plus
+ * the longest masked section (__disable_irq) of any context. The entry latency and execution time of the measured
+ * vectors are recorded per vector by PROFILER_ISR_* (profiler.h, table printed by profiler_report with the tier).
+ * Handlers of one tier that share data without a lock (noted below) must stay in the same tier.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef IRQPRIO_H
+#define IRQPRIO_H
+
+#define IRQPRIO_TIER_CRITICAL		 0
+#define IRQPRIO_TIER_TIME			 1
+#define IRQPRIO_TIER_COMM			 2
+#define IRQPRIO_TIER_DEFERRED		 3
+
+// Relay decision sources and protective events
+#define IRQPRIO_ADC_RESULT			 IRQPRIO_TIER_CRITICAL		// Adc_Measurement_Handler: threshold check and latch start of the relay channels
+#define IRQPRIO_ACMP				 IRQPRIO_TIER_CRITICAL		// ERU0 SR1: comparator crossings (same tier as the ADC, both change the latch timestamps)
+#define IRQPRIO_SUPPLY				 IRQPRIO_TIER_CRITICAL		// SCU SR1: supply warning (must be seen even while the main loop programs flash)
+#define IRQPRIO_FREQSENSOR			 IRQPRIO_TIER_CRITICAL		// CCU40 SR3: frequency input edges (same tier as the ADC, which reads period and high time as a pair)
+#define IRQPRIO_FUNCPROF			 IRQPRIO_TIER_CRITICAL		// CCU40 SR2: profiler counter wrap (profiling builds only, a wrap must be counted before the next)
+// Time bases
+#define IRQPRIO_SYSTICK				 IRQPRIO_TIER_TIME			// SysTick: SYSTIMER, scheduler tick, button sampling
+#define IRQPRIO_HRTIMER				 IRQPRIO_TIER_TIME			// CCU40 SR1: hrtimer deadlines
+#define IRQPRIO_BUTTONS				 IRQPRIO_TIER_TIME			// ERU0 SR0: button edges (same tier as SysTick, both fill the button edge queue)
+#define IRQPRIO_RELAYTIME			 IRQPRIO_TIER_TIME			// ERU0 SR2: relay contact feedback edges (the entry latency adds to the measured time)
+#define IRQPRIO_ZEROCROSS			 IRQPRIO_TIER_TIME			// ERU0 SR3: mains zero cross edges (the entry latency shifts the predicted zero crosses)
+// Communication and UI
+#define IRQPRIO_SPISTREAM			 IRQPRIO_TIER_COMM			// USIC0 SR2: SPI stream FIFO refill (32 words ahead of the host clock)
+#define IRQPRIO_LED_PWM				 IRQPRIO_TIER_COMM			// CCU40 SR0: status LED fade step (a late step only repeats one PWM period)
+#define IRQPRIO_I2CMASTER			 IRQPRIO_TIER_COMM			// USIC0 SR4: I2C master transfer end (the FIFO holds the whole transfer, only the next one waits)
+#define IRQPRIO_MODBUS				 IRQPRIO_TIER_COMM			// USIC0 SR3: Modbus slave (a response a fixed time after the request, below the hrtimer that ends the frame)
+// Deferred work
+#define IRQPRIO_TELEMETRY			 IRQPRIO_TIER_DEFERRED		// USIC0 SR0: telemetry UART (paced by its FIFOs and ring buffers)
+#define IRQPRIO_I2CTARGET			 IRQPRIO_TIER_DEFERRED		// USIC0 SR1: I2C target (the controller waits for the ACK)
+#define IRQPRIO_TIMEBASE			 IRQPRIO_TIER_DEFERRED		// CCU40 SR3: 32 bit wrap of the time base (once per 71min, every read carries it too)
+
+typedef char irqprio_tier_check[(IRQPRIO_TIER_DEFERRED < (1 << 2)) ? 1 : -1];
+
+void irqprio_init(void);
+
+#endif /* IRQPRIO_H */
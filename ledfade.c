@@ -0,0 +1,389 @@
+/*
+ * USB-Changer ledfade.c
+ *
+ * Status LED fade engine (see ledfade.h). The LED is active low, so full brightness is a compare value of period + 1
+ * and off is a compare value of 0. The brightness curve is a gamma corrected table of compare values in flash, the
+ * interrupt only advances a table position and writes the looked up value (interpolated between two entries). With
+ * LEDFADE_DITHER the table values are 1/16 counts of a 16 times shorter period: the upper bits are the compare value
+ * and the lower 4 bits the dither compare value, so the LED runs far above the visible flicker range without losing
+ * dark levels. All divisions are done in ledfade_ramp (divide.h: constant divisors by reciprocal, the increment with the
+ * divider of parts that have one running while the ramp is set up).
+ * A sequence changes the prescaler, which only takes effect with the timer stopped: entering and leaving one stops,
+ * clears and restarts the slice (the shadow registers are transferred at once while it stands), so the LED period
+ * running at that moment is cut short. Step times are scaled by ledfade_sequence_scale, counts per ms with 8 fractional
+ * bits at the full clock (8000 = 31.25 counts per ms), and the clock shift of clockscale.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "ledfade.h"
+#include "profiler.h"
+#include "funcprof.h"
+#include "divide.h"
+#include "hal.h"
+#include "outputs.h"
+
+typedef enum {LEDFADE_IDLE, LEDFADE_RAMP, LEDFADE_STREAM, LEDFADE_SEQUENCE} ledfade_states;
+
+volatile ledfade_states ledfade_state = LEDFADE_IDLE;
+bool ledfade_ready = false;			// ledfade_init routed the period match interrupt (without it no ramp, stream or sequence could end)
+int32_t ledfade_position = 0;		// Table position with LEDFADE_FRACTION_BITS fractional bits
+int32_t ledfade_increment;			// Added to ledfade_position every PWM period of the ramp
+uint8_t ledfade_target;				// Level the current ramp ends at
+uint32_t ledfade_steps;				// Number of PWM periods of the ramp
+uint32_t ledfade_step;				// Current PWM period of the ramp
+uint8_t ledfade_clock_shift = 0;	// Timer clock divider (power of 2) of clockscale, period and compare values are divided by it
+ledfade_source_t ledfade_source;	// Symbol source of the stream (LEDFADE_STREAM)
+uint8_t ledfade_symbol_periods;		// PWM periods per stream symbol
+uint8_t ledfade_symbol_countdown;	// PWM periods until the next stream symbol
+const uint8_t *ledfade_sequence_steps;	// Steps of the sequence (LEDFADE_SEQUENCE, LEDFADE_STEP_SIZE bytes each)
+uint8_t ledfade_sequence_count;		// Number of steps
+uint8_t ledfade_sequence_index;		// Step in the shadow registers (taken over at the next period match)
+uint32_t ledfade_sequence_scale;	// Slow clock counts per ms at the full clock, 8 fractional bits
+uint8_t ledfade_prescaler;			// Prescaler of the fast PWM (restored when a sequence ends)
+const divide_reciprocal_t ledfade_kilo = DIVIDE_RECIPROCAL(1000U);
+const divide_reciprocal_t ledfade_period = DIVIDE_RECIPROCAL(LEDFADE_PERIOD);
+
+// Compare values of PWM_CCU4_LED_STATUS (1/16 counts with LEDFADE_DITHER) from off to full brightness: round(LEDFADE_TABLE_FULL * (i*LEDFADE_TABLE_STEP/LEDFADE_LEVEL_MAX)^2.2)
+const uint16_t ledfade_table[LEDFADE_TABLE_SIZE] = {
+	    0,    11,    51,   126,   237,   387,   577,   810,  1087,  1409,  1776,  2191,  2653,  3164,  3724,  4334,
+	 4996,  5708,  6473,  7291,  8162,  9087, 10066, 11100, 12190, 13335, 14537, 15795, 17111, 18484, 19916, 21405,
+	22954, 24562, 26229, 27956, 29743, 31591, 33500, 35471, 37502, 39596, 41752, 43970, 46251, 48595, 51003, 53474,
+	56009, 58608, 61272, 64000
+};
+typedef char ledfade_table_check[(LEDFADE_LEVEL_MAX == 255 && LEDFADE_TABLE_STEP == 5 && LEDFADE_TABLE_FULL <= 65535) ? 1 : -1];
+
+
+//****************************************************************************
+// ledfade_write - writes a table value to the compare shadow register (taken over at the next period match)
+//****************************************************************************
+void ledfade_write(uint32_t value){
+	value >>= ledfade_clock_shift;
+
+#if LEDFADE_DITHER
+	hal_led_compare_dither((uint16_t)(value >> 4), (uint8_t)(value & 0x0FU));
+#else
+	hal_led_compare((uint16_t)value);
+#endif
+}
+
+#if OUTPUTS_ENABLED
+//****************************************************************************
+// ledfade_stage - like ledfade_write, but the value is written by the outputs_commit at the end of the main loop pass (main context)
+//****************************************************************************
+void ledfade_stage(uint32_t value){
+	value >>= ledfade_clock_shift;
+
+#if LEDFADE_DITHER
+	outputs_compare(OUTPUTS_SLICE_LED, (uint16_t)(value >> 4), (uint8_t)(value & 0x0FU));
+#else
+	outputs_compare(OUTPUTS_SLICE_LED, (uint16_t)value, 0U);
+#endif
+}
+#endif
+
+//****************************************************************************
+// ledfade_lookup - returns the table value of a position (level with LEDFADE_FRACTION_BITS fractional bits)
+//****************************************************************************
+uint32_t ledfade_lookup(int32_t position){
+	// Level with 8 fractional bits divided by LEDFADE_TABLE_STEP: x * 52429 >> 18 is x / 5 for every x below 2^16
+	uint32_t step = (((uint32_t)position >> (LEDFADE_FRACTION_BITS - 8)) * 52429U) >> 18;
+	uint32_t index = step >> 8;
+	uint32_t value = ledfade_table[index];
+	// Linear interpolation to the next entry with 8 bits of the fraction
+	if(index < LEDFADE_TABLE_SIZE - 1U)
+		value += ((ledfade_table[index + 1U] - value) * (step & 0xFFU)) >> 8;
+	return value;
+}
+
+//****************************************************************************
+// ledfade_value - returns the table value of the current level
+//****************************************************************************
+uint32_t ledfade_value(void){
+	return ledfade_lookup(ledfade_position);
+}
+
+//****************************************************************************
+// ledfade_apply - writes the current level (a stream keeps its symbol, the level is applied when it ends)
+//****************************************************************************
+void ledfade_apply(void){
+	if(ledfade_state == LEDFADE_STREAM || ledfade_state == LEDFADE_SEQUENCE)
+		return;
+	ledfade_write(ledfade_value());
+}
+
+//****************************************************************************
+// ledfade_halt - stops the period match interrupt and discards a pending one
+//****************************************************************************
+void ledfade_halt(void){
+	XMC_CCU4_SLICE_DisableEvent(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	XMC_CCU4_SLICE_ClearEvent(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	NVIC_ClearPendingIRQ(CCU40_0_IRQn);
+	ledfade_state = LEDFADE_IDLE;
+}
+
+//****************************************************************************
+// ledfade_sequence_load - writes step index of the sequence to the period and compare shadow registers
+//****************************************************************************
+void ledfade_sequence_load(uint8_t index){
+	const uint8_t *step = &ledfade_sequence_steps[(uint32_t)index * LEDFADE_STEP_SIZE];
+	uint32_t shift = 8U + ledfade_clock_shift;
+	uint32_t period = ((uint32_t)(step[0] | (step[1] << 8)) * ledfade_sequence_scale) >> shift;
+	uint32_t on = ((uint32_t)(step[2] | (step[3] << 8)) * ledfade_sequence_scale) >> shift;
+	if(period == 0)
+		period = 1;
+	if(period > 0x10000U)
+		period = 0x10000U;
+	// Active low: a compare value of period + 1 (the count) is full on
+	if(on > period)
+		on = period;
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, (uint16_t)(period - 1U));
+	hal_led_compare_dither((uint16_t)(on == 0x10000U ? 0xFFFFU : on), 0U);
+}
+
+//****************************************************************************
+// ledfade_restart - stops the slice, sets a prescaler, transfers the shadow registers and starts it again
+//****************************************************************************
+void ledfade_restart(uint8_t prescaler){
+	XMC_CCU4_SLICE_t *slice = PWM_CCU4_LED_STATUS.ccu4_slice_ptr;
+	XMC_CCU4_SLICE_StopTimer(slice);
+	XMC_CCU4_SLICE_ClearTimer(slice);
+	XMC_CCU4_SLICE_SetPrescaler(slice, (XMC_CCU4_SLICE_PRESCALER_t)prescaler);
+	// The values written to the shadow registers meanwhile are taken over at once while the timer stands
+	HAL_LED_MODULE->GCSS = (uint32_t)HAL_LED_SHADOW | (uint32_t)HAL_LED_DITHER_SHADOW;
+	XMC_CCU4_SLICE_StartTimer(slice);
+}
+
+//****************************************************************************
+// ledfade_sequence_end - ends a running sequence and restores the fast PWM with the current level
+//****************************************************************************
+void ledfade_sequence_end(void){
+	if(!LEDFADE_SEQUENCE_ENABLED || ledfade_state != LEDFADE_SEQUENCE)
+		return;
+	ledfade_halt();
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, (uint16_t)((LEDFADE_PERIOD >> ledfade_clock_shift) - 1U));
+	ledfade_apply();
+	ledfade_restart(ledfade_prescaler);
+}
+
+#if LEDFADE_RAMP_ENABLED || LEDFADE_STREAM_ENABLED || LEDFADE_SEQUENCE_ENABLED
+//****************************************************************************
+// CCU40_0_IRQHandler - period match of the status LED slice: one fade step per PWM period (or the next stream symbol)
+//****************************************************************************
+void CCU40_0_IRQHandler(void){
+	// The PWM timer restarted from 0 at the period match (prescaler 0: counts at the CCU4 module clock, a sequence at the slow clock)
+	PROFILER_ISR_ENTER(isr_entry, ((uint32_t)hal_led_timer() << (ledfade_clock_shift
+			+ ((ledfade_state == LEDFADE_SEQUENCE) ? LEDFADE_SEQUENCE_PRESCALER : 0U))) >> PROFILER_CCU4_CLOCK_SHIFT);
+	FUNCPROF_ENTER();
+	hal_led_clear_period_match();
+
+	if(ledfade_state == LEDFADE_STREAM){
+		// Full on or off for the next symbol, the edge is the period match it is taken over at
+		if(--ledfade_symbol_countdown == 0){
+			ledfade_symbol_countdown = ledfade_symbol_periods;
+			ledfade_write(ledfade_source() ? LEDFADE_TABLE_FULL : 0U);
+		}
+	}
+	else if(LEDFADE_SEQUENCE_ENABLED && ledfade_state == LEDFADE_SEQUENCE){
+		// The step in the shadow registers was just taken over, the following one is taken over at the next period match
+		if(++ledfade_sequence_index >= ledfade_sequence_count)
+			ledfade_sequence_index = 0;
+		ledfade_sequence_load(ledfade_sequence_index);
+	}
+	else if(!LEDFADE_RAMP_ENABLED || ledfade_state != LEDFADE_RAMP){
+		ledfade_halt();
+	}
+	else{
+		ledfade_step++;
+		ledfade_position += ledfade_increment;
+		// Land exactly on the target level (the increment is rounded towards zero)
+		if(ledfade_step >= ledfade_steps){
+			ledfade_position = (int32_t)ledfade_target << LEDFADE_FRACTION_BITS;
+			ledfade_halt();
+		}
+		ledfade_apply();
+	}
+	FUNCPROF_EXIT(FUNCPROF_LED_PWM_ISR);
+	PROFILER_ISR_EXIT(PROFILER_ISR_LED_PWM, isr_entry);
+}
+#endif
+
+//****************************************************************************
+// ledfade_init - routes the period match event of the status LED slice to its interrupt (PWM_CCU4 must be initialized)
+//****************************************************************************
+bool ledfade_init(void){
+	// The fade steps write the slice through hal.h, the DAVE configuration must still match it
+	if(PWM_CCU4_LED_STATUS.runtime_ptr->state == PWM_CCU4_STATE_UNINITIALIZED || !hal_check())
+		return false;
+#if LEDFADE_DITHER
+	// Shorter period with duty dither (taken over at the next period match)
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, (uint16_t)(LEDFADE_PERIOD - 1U));
+	PWM_CCU4_SetDither(&PWM_CCU4_LED_STATUS, false, true, 0U);
+	ledfade_apply();
+#else
+	// The table holds absolute compare values, it only fits the period it was generated for
+	if((uint32_t)XMC_CCU4_SLICE_GetTimerPeriodMatch(PWM_CCU4_LED_STATUS.ccu4_slice_ptr) + 1U != LEDFADE_TABLE_FULL)
+		return false;
+#endif
+
+	ledfade_halt();
+#if LEDFADE_RAMP_ENABLED || LEDFADE_STREAM_ENABLED || LEDFADE_SEQUENCE_ENABLED
+	XMC_CCU4_SLICE_SetInterruptNode(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_0);
+	NVIC_SetPriority(CCU40_0_IRQn, LEDFADE_IRQ_PRIORITY);
+	NVIC_EnableIRQ(CCU40_0_IRQn);
+#endif
+	ledfade_ready = true;
+	return true;
+}
+
+//****************************************************************************
+// ledfade_set_clock_shift - keeps PWM frequency and brightness when the CCU4 clock was divided by 2^shift (interrupts masked)
+//****************************************************************************
+void ledfade_set_clock_shift(uint8_t shift){
+	// Period and compare value are taken over together at the next period match, the current period ends at the new clock
+	ledfade_clock_shift = shift;
+	// A staged value was shifted for the old clock
+	outputs_cancel(OUTPUTS_SLICE_LED);
+	if(LEDFADE_SEQUENCE_ENABLED && ledfade_state == LEDFADE_SEQUENCE){
+		ledfade_sequence_load(ledfade_sequence_index);
+		return;
+	}
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, (uint16_t)((LEDFADE_PERIOD >> shift) - 1U));
+	ledfade_apply();
+}
+
+//****************************************************************************
+// ledfade_set - stops a running ramp and sets the LED to a level (0 = off, LEDFADE_LEVEL_MAX = full brightness)
+//****************************************************************************
+void ledfade_set(uint8_t level){
+	ledfade_sequence_end();
+	if(ledfade_state != LEDFADE_STREAM)
+		ledfade_halt();
+	ledfade_position = (int32_t)level << LEDFADE_FRACTION_BITS;
+#if OUTPUTS_ENABLED
+	// Several levels set in one pass (pattern steps, show_relay_state) reach the slice once (outputs.h)
+	if(ledfade_state != LEDFADE_STREAM)
+		ledfade_stage(ledfade_value());
+#else
+	ledfade_apply();
+#endif
+}
+
+//****************************************************************************
+// ledfade_ramp - fades the LED from its current level to level within time ms. Returns false if the level was set at
+//                once instead (no period match interrupt, ledfade_init failed or LEDFADE_RAMP_ENABLED 0), the caller must
+//                not wait for the ramp
+//****************************************************************************
+bool ledfade_ramp(uint8_t level, uint16_t time){
+	if(!LEDFADE_RAMP_ENABLED){
+		ledfade_set(level);
+		return false;
+	}
+	// A stream only takes the level over
+	if(ledfade_state == LEDFADE_STREAM || !ledfade_ready){
+		ledfade_set(level);
+		return ledfade_ready;
+	}
+	ledfade_sequence_end();
+	ledfade_halt();
+	// The interrupt drives the slice from now on, a level staged before must not replace the first steps
+	outputs_cancel(OUTPUTS_SLICE_LED);
+
+	// Number of PWM periods of the ramp
+	uint32_t clocks_per_ms = divide_by_reciprocal(&ledfade_kilo, PWM_CCU4_LED_STATUS.runtime_ptr->frequency_tclk);
+	ledfade_steps = divide_by_reciprocal(&ledfade_period, (uint32_t)time * clocks_per_ms);
+	if(ledfade_steps == 0){
+		ledfade_set(level);
+		return true;
+	}
+	divide_job_t increment;
+	divide_start_s32(&increment, ((int32_t)level << LEDFADE_FRACTION_BITS) - ledfade_position, (int32_t)ledfade_steps);
+	ledfade_target = level;
+	ledfade_step = 0;
+	ledfade_increment = divide_finish_s32(&increment);
+
+	ledfade_state = LEDFADE_RAMP;
+	XMC_CCU4_SLICE_EnableEvent(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	return true;
+}
+
+//****************************************************************************
+// ledfade_stop - stops a running ramp (the last applied level stays) or sequence (the level before it is restored)
+//****************************************************************************
+void ledfade_stop(void){
+	ledfade_sequence_end();
+	if(ledfade_state == LEDFADE_RAMP)
+		ledfade_halt();
+}
+
+//****************************************************************************
+// ledfade_running - returns true while a ramp is in progress
+//****************************************************************************
+bool ledfade_running(void){
+	return ledfade_state == LEDFADE_RAMP;
+}
+
+//****************************************************************************
+// ledfade_stream - drives the LED full on or off by symbols of source, one every periods PWM periods (from the period
+//                  match interrupt). Fades and levels set meanwhile only change the level restored by ledfade_stream_stop.
+//                  Returns false if the stream cannot run (invalid arguments, ledfade_init failed)
+//****************************************************************************
+bool ledfade_stream(ledfade_source_t source, uint8_t periods){
+	if(!LEDFADE_STREAM_ENABLED || source == NULL || periods == 0 || !ledfade_ready)
+		return false;
+	ledfade_sequence_end();
+	ledfade_halt();
+	outputs_cancel(OUTPUTS_SLICE_LED);
+	ledfade_source = source;
+	ledfade_symbol_periods = periods;
+	ledfade_symbol_countdown = 1;
+	ledfade_state = LEDFADE_STREAM;
+	XMC_CCU4_SLICE_EnableEvent(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	return true;
+}
+
+//****************************************************************************
+// ledfade_stream_stop - ends a stream and restores the level
+//****************************************************************************
+void ledfade_stream_stop(void){
+	if(ledfade_state != LEDFADE_STREAM)
+		return;
+	ledfade_halt();
+	ledfade_apply();
+}
+
+//****************************************************************************
+// ledfade_sequence - runs count steps (LEDFADE_STEP_SIZE bytes each, kept by the caller) from the slice at the slow
+//                    clock, repeated until a level, ramp or stream replaces it. Returns false if the LED is streaming
+//****************************************************************************
+bool ledfade_sequence(const uint8_t *steps, uint8_t count){
+#if LEDFADE_SEQUENCE_ENABLED
+	if(steps == NULL || count == 0 || ledfade_state == LEDFADE_STREAM || !ledfade_ready)
+		return false;
+	if(ledfade_state != LEDFADE_SEQUENCE)
+		ledfade_prescaler = (uint8_t)(PWM_CCU4_LED_STATUS.ccu4_slice_ptr->PSC & CCU4_CC4_PSC_PSIV_Msk);
+	ledfade_halt();
+	// The slice has the LED from here on, a level staged before must not replace the first step
+	outputs_cancel(OUTPUTS_SLICE_LED);
+	ledfade_sequence_steps = steps;
+	ledfade_sequence_count = count;
+	ledfade_sequence_index = 0;
+	ledfade_sequence_scale = divide_by_reciprocal(&ledfade_kilo,
+			(PWM_CCU4_LED_STATUS.runtime_ptr->frequency_tclk >> LEDFADE_SEQUENCE_PRESCALER) << 8);
+	ledfade_sequence_load(0);
+	ledfade_restart((uint8_t)(ledfade_prescaler + LEDFADE_SEQUENCE_PRESCALER));
+	ledfade_state = LEDFADE_SEQUENCE;
+	// A single step repeats without the interrupt, otherwise the next one waits in the shadow registers
+	if(count > 1){
+		ledfade_sequence_index = 1;
+		ledfade_sequence_load(1);
+		XMC_CCU4_SLICE_EnableEvent(PWM_CCU4_LED_STATUS.ccu4_slice_ptr, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	}
+	return true;
+#else
+	(void)steps;
+	(void)count;
+	return false;
+#endif
+}
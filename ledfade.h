@@ -0,0 +1,66 @@
+/*
+ * USB-Changer ledfade.h
+ *
+ * Hardware paced fade engine for the status LED. The compare value of PWM_CCU4_LED_STATUS is advanced in the period
+ * match interrupt of its CCU4 slice and applied by the slice's shadow transfer, so a fade advances exactly one step per
+ * PWM period regardless of how busy the main loop is (e.g. during EEPROM writes). The main loop only starts, stops and
+ * queries fades. Brightness is given as a level from 0 (off) to LEDFADE_LEVEL_MAX (full brightness).
+ * A stream (ledfade_stream) takes the LED over for data: the interrupt switches it full on or off by the symbols of a
+ * source every n PWM periods, so every edge lies on a period match (optical readout, see optical.h).
+ * A sequence (ledfade_sequence, LEDFADE_SEQUENCE_ENABLED) keeps a blink going without the CPU: the slice counts at
+ * fCCU4 / 2^LEDFADE_SEQUENCE_PRESCALER and every step of the sequence is one PWM period of period ms with the LED on
+ * for on ms. A single step repeats on its own in hardware, so the LED blinks through any sleep with no wake-up at all.
+ * With more steps the period match interrupt loads the following step into the shadow registers, one wake-up
+ * per step (a breathe made of a few steps with rising and falling on times wakes a few times per second instead of
+ * once per fade step). Any level, ramp or stream ends the sequence and restores the fast PWM.
+ * If ledfade_init fails (PWM_CCU4_LED_STATUS not initialized or not matching hal.h), nothing needs the interrupt: a
+ * ramp sets its level at once and returns false, streams and sequences are refused, so callers fall back. Without
+ * LEDFADE_RAMP_ENABLED every ramp takes this fallback (the interrupt only serves streams and sequences).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef LEDFADE_H
+#define LEDFADE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define LEDFADE_IRQ_PRIORITY		 IRQPRIO_LED_PWM			// Priority of the CCU40 SR0 interrupt (UI tier, a late step repeats the level of one PWM period)
+#define LEDFADE_FRACTION_BITS		 16							// Fractional bits of the table position (ramps interpolate between table entries)
+#define LEDFADE_LEVEL_MAX			 255						// Level of full brightness (last entry of the gamma corrected brightness table)
+#define LEDFADE_TABLE_FULL			 64000U						// Table value of full brightness (period_value + 1 of PWM_CCU4_LED_STATUS, in 1/16 counts if LEDFADE_DITHER is 1)
+#define LEDFADE_TABLE_STEP			 5U							// Levels per table entry (the levels between are interpolated)
+#define LEDFADE_TABLE_SIZE			 (LEDFADE_LEVEL_MAX / LEDFADE_TABLE_STEP + 1U)
+#define LEDFADE_RAMP_ENABLED		 0							// Determines if ramps are stepped by the period match interrupt (0 = a ramp sets its level at once, patterns keep its time)
+#define LEDFADE_STREAM_ENABLED		 0							// Determines if ledfade_stream drives the LED by symbols (needed by OPTICAL_ENABLED and STORM_ENABLED, see main.c)
+#define LEDFADE_SEQUENCE_ENABLED	 0							// Determines if LEDP_SEQUENCE patterns run from the slice at a slow clock (0 = their fallback instructions run)
+#define LEDFADE_SEQUENCE_PRESCALER	 11U						// fCCU4 / 2^11 (XMC_CCU4_SLICE_PRESCALER_2048, 31.25kHz at full MCLK) while a sequence runs
+#define LEDFADE_SEQUENCE_PERIOD_MAX	 2000U						// In ms. Longest step (65536 counts at the slow clock, clamped beyond)
+#define LEDFADE_DITHER				 0							// Determines if the PWM runs with a 16 times shorter period and the CCU4 duty dither provides the lower 4 bits
+#if LEDFADE_DITHER
+	#define LEDFADE_PERIOD			 (LEDFADE_TABLE_FULL / 16U)	// In timer counts. PWM period set by ledfade_init (4000 counts = 16kHz at the 64MHz CCU4 clock)
+#else
+	#define LEDFADE_PERIOD			 LEDFADE_TABLE_FULL			// In timer counts. PWM period as configured in DAVE
+#endif
+
+extern const uint16_t ledfade_table[LEDFADE_TABLE_SIZE];	// Gamma corrected brightness of every LEDFADE_TABLE_STEP level (0 to LEDFADE_TABLE_FULL)
+
+typedef bool (*ledfade_source_t)(void);	// Returns the next stream symbol (true = on, period match interrupt)
+
+// Sequence steps are 4 bytes each: period and on time in ms, 16 bit little endian (LEDP_STEP of ledpattern.h)
+#define LEDFADE_STEP_SIZE			 4U
+
+bool ledfade_init(void);
+uint32_t ledfade_lookup(int32_t position);
+void ledfade_set(uint8_t level);
+bool ledfade_ramp(uint8_t level, uint16_t time);
+void ledfade_stop(void);
+bool ledfade_running(void);
+void ledfade_set_clock_shift(uint8_t shift);
+bool ledfade_stream(ledfade_source_t source, uint8_t periods);
+void ledfade_stream_stop(void);
+bool ledfade_sequence(const uint8_t *steps, uint8_t count);
+
+#endif /* LEDFADE_H */
@@ -0,0 +1,265 @@
+/*
+ * USB-Changer ledpattern.c
+ *
+ * Status LED pattern interpreter (see ledpattern.h). Only the top pattern of the stack is run. A wait or a ramp ends the
+ * instructions of one ledpattern_run call and arms a one-shot SYSTIMER timer that resumes the pattern when its time passed,
+ * so nothing is polled between two LED changes. The timer callback is deferred to the main loop (SYSTIMER_DispatchDeferred),
+ * so the ledfade calls of a step do not extend the SysTick ISR. The main context functions below mask interrupts, which
+ * keeps them safe with SYSTIMER_DEFERRED_ENABLED removed as well.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "ledpattern.h"
+#include "ledfade.h"
+#include "profiler.h"
+#include "trace.h"
+#include "timing.h"
+#include "critical.h"
+
+typedef struct {
+	const uint8_t *start;		// First instruction of the loop body
+	uint8_t left;				// Remaining runs of the loop body (0 = endless)
+} ledpattern_loop_t;
+
+typedef struct {
+	const uint8_t *pattern;		// First instruction of the pattern
+	const uint8_t *pc;			// Next instruction
+	uint8_t arg;				// Loop count used by LEDP_LOOP(LEDP_ARG)
+	uint8_t loops;				// Number of active loops
+	ledpattern_loop_t loop[LEDPATTERN_LOOP_DEPTH];
+} ledpattern_frame_t;
+
+ledpattern_frame_t ledpattern_stack[LEDPATTERN_STACK_SIZE];
+uint8_t ledpattern_count = 0;		// Number of patterns on the stack
+bool ledpattern_ramping = false;	// The top pattern waits for the end of a ramp
+uint32_t ledpattern_timer_id = 0;	// One-shot SYSTIMER timer that resumes the top pattern
+
+
+//****************************************************************************
+// ledpattern_op_length - returns the length of the instruction at pc in bytes (opcode included)
+//****************************************************************************
+uint32_t ledpattern_op_length(const uint8_t *pc){
+	switch(pc[0]){
+		case LEDP_OP_SET:
+		case LEDP_OP_LOOP:
+			return 2;
+		case LEDP_OP_RAMP:
+			return 4;
+		case LEDP_OP_WAIT:
+			return 3;
+		case LEDP_OP_SEQUENCE:
+			return 2U + (uint32_t)pc[1] * LEDFADE_STEP_SIZE;
+		default:
+			return 1;
+	}
+}
+
+//****************************************************************************
+// ledpattern_restart - runs a pattern on the stack from its first instruction
+//****************************************************************************
+void ledpattern_restart(ledpattern_frame_t *frame){
+	frame->pc = frame->pattern;
+	frame->loops = 0;
+	ledpattern_ramping = false;
+	ledfade_stop();
+}
+
+//****************************************************************************
+// ledpattern_skip_loop - moves the program counter behind the LEDP_OP_NEXT matching the loop it points into
+//****************************************************************************
+void ledpattern_skip_loop(ledpattern_frame_t *frame){
+	uint8_t nesting = 0;
+	while(*frame->pc != LEDP_OP_RETURN){
+		uint8_t op = *frame->pc;
+		frame->pc += ledpattern_op_length(frame->pc);
+		if(op == LEDP_OP_LOOP)
+			nesting++;
+		else if(op == LEDP_OP_NEXT){
+			if(nesting == 0)
+				return;
+			nesting--;
+		}
+	}
+}
+
+//****************************************************************************
+// ledpattern_resume_after - arms the timer that resumes the top pattern after time ms
+//****************************************************************************
+void ledpattern_resume_after(uint16_t time){
+	if(time == 0)
+		time = 1;
+	SYSTIMER_RestartTimerFromISR(ledpattern_timer_id, (uint32_t)time * TIMING_US_PER_MS);
+}
+
+//****************************************************************************
+// ledpattern_run - runs the top pattern until it waits (deferred timer callback or interrupts masked)
+//****************************************************************************
+void ledpattern_run(void){
+	PROFILER_START(led_start);
+	SYSTIMER_StopTimerFromISR(ledpattern_timer_id);
+
+	for(uint8_t ops = 0; ops < LEDPATTERN_MAX_OPS; ops++){
+		ledpattern_frame_t *frame = &ledpattern_stack[ledpattern_count - 1];
+		const uint8_t *pc = frame->pc;
+		uint16_t time;
+
+		switch(pc[0]){
+			case LEDP_OP_SET:
+				ledfade_set(pc[1]);
+				frame->pc += 2;
+				break;
+			case LEDP_OP_RAMP:
+				time = (uint16_t)(pc[2] | (pc[3] << 8));
+				frame->pc += 4;
+				// Without fades the level is set at once and the pattern only keeps the time
+				ledpattern_ramping = ledfade_ramp(pc[1], time);
+				ledpattern_resume_after(time);
+				PROFILER_STOP(PROFILER_STATUS_LED, led_start);
+				return;
+			case LEDP_OP_WAIT:
+				time = (uint16_t)(pc[1] | (pc[2] << 8));
+				frame->pc += 3;
+				if(time > 0){
+					ledpattern_resume_after(time);
+					PROFILER_STOP(PROFILER_STATUS_LED, led_start);
+					return;
+				}
+				break;
+			case LEDP_OP_LOOP:{
+				uint8_t count = (pc[1] == LEDP_ARG) ? frame->arg : pc[1];
+				frame->pc += 2;
+				// A count of 0 given as argument runs the body zero times, a loop nested too deep is skipped as well
+				if((pc[1] == LEDP_ARG && count == 0) || frame->loops >= LEDPATTERN_LOOP_DEPTH){
+					ledpattern_skip_loop(frame);
+					break;
+				}
+				frame->loop[frame->loops].start = frame->pc;
+				frame->loop[frame->loops].left = count;
+				frame->loops++;
+				break;
+			}
+			case LEDP_OP_SEQUENCE:
+				// The slice runs the steps from here on, the pattern holds at this instruction (a restart runs it again)
+				if(ledfade_sequence(&pc[2], pc[1])){
+					PROFILER_STOP(PROFILER_STATUS_LED, led_start);
+					return;
+				}
+				frame->pc += ledpattern_op_length(pc);
+				break;
+			case LEDP_OP_NEXT:
+				frame->pc += 1;
+				if(frame->loops > 0){
+					ledpattern_loop_t *loop = &frame->loop[frame->loops - 1];
+					if(loop->left == LEDP_FOREVER || --loop->left > 0)
+						frame->pc = loop->start;
+					else
+						frame->loops--;
+				}
+				break;
+			default: // LEDP_OP_RETURN
+				// The base pattern stays at its end and holds the LED
+				if(ledpattern_count == 1){
+					PROFILER_STOP(PROFILER_STATUS_LED, led_start);
+					return;
+				}
+				ledpattern_count--;
+				ledpattern_restart(&ledpattern_stack[ledpattern_count - 1]);
+				break;
+		}
+	}
+	// Instruction limit reached without a wait - continue with the next tick
+	ledpattern_resume_after(1);
+	PROFILER_STOP(PROFILER_STATUS_LED, led_start);
+}
+
+//****************************************************************************
+// ledpattern_timer - wait or ramp of the top pattern is over (main loop, deferred SYSTIMER callback)
+//****************************************************************************
+void ledpattern_timer(void *args){
+	(void)args;
+	if(ledpattern_count == 0)
+		return;
+
+	// The ramp is stepped per PWM period, it can end slightly after its time in SysTick ticks
+	if(ledpattern_ramping && ledfade_running()){
+		ledpattern_resume_after(1);
+		return;
+	}
+	ledpattern_ramping = false;
+	ledpattern_run();
+}
+
+//****************************************************************************
+// ledpattern_init - creates the timer of the interpreter
+//****************************************************************************
+bool ledpattern_init(void){
+	ledpattern_timer_id = SYSTIMER_CreateTimer(SYSTIMER_TICK_PERIOD_US, SYSTIMER_MODE_ONE_SHOT, ledpattern_timer, NULL);
+	if(ledpattern_timer_id == 0)
+		return false;
+#ifdef SYSTIMER_DEFERRED_ENABLED
+	SYSTIMER_SetDeferred(ledpattern_timer_id, true);
+#endif
+	return true;
+}
+
+//****************************************************************************
+// ledpattern_set_base_locked - replaces the base pattern, returns true if it must be run (interrupts masked)
+//****************************************************************************
+bool ledpattern_set_base_locked(const uint8_t *pattern, uint8_t arg){
+	ledpattern_stack[0].pattern = pattern;
+	ledpattern_stack[0].arg = arg;
+	if(ledpattern_count > 1)
+		return false;
+	ledpattern_count = 1;
+	ledpattern_restart(&ledpattern_stack[0]);
+	return true;
+}
+
+//****************************************************************************
+// ledpattern_play - removes all patterns and runs pattern as new base pattern (main context)
+//****************************************************************************
+void ledpattern_play(const uint8_t *pattern, uint8_t arg){
+	critical_state_t primask = critical_enter();
+	ledpattern_count = 0;
+	ledpattern_set_base_locked(pattern, arg);
+	TRACE(TRACE_LED, ledpattern_count, (uintptr_t)pattern);
+	ledpattern_run();
+	critical_exit(primask, CRITICAL_SITE_LEDPATTERN);
+}
+
+//****************************************************************************
+// ledpattern_set_base - replaces the base pattern (a pushed pattern keeps running, the new base starts when it returns - main context)
+//****************************************************************************
+void ledpattern_set_base(const uint8_t *pattern, uint8_t arg){
+	critical_state_t primask = critical_enter();
+	TRACE(TRACE_LED, 1, (uintptr_t)pattern);
+	if(ledpattern_set_base_locked(pattern, arg))
+		ledpattern_run();
+	critical_exit(primask, CRITICAL_SITE_LEDPATTERN);
+}
+
+//****************************************************************************
+// ledpattern_push - runs pattern on top of the current one (replaces the top pattern if the stack is full - main context)
+//****************************************************************************
+void ledpattern_push(const uint8_t *pattern, uint8_t arg){
+	critical_state_t primask = critical_enter();
+	if(ledpattern_count >= LEDPATTERN_STACK_SIZE)
+		ledpattern_count = LEDPATTERN_STACK_SIZE - 1;
+
+	ledpattern_frame_t *frame = &ledpattern_stack[ledpattern_count++];
+	frame->pattern = pattern;
+	frame->arg = arg;
+	ledpattern_restart(frame);
+	TRACE(TRACE_LED, ledpattern_count, (uintptr_t)pattern);
+	ledpattern_run();
+	critical_exit(primask, CRITICAL_SITE_LEDPATTERN);
+}
+
+//****************************************************************************
+// ledpattern_depth - returns the number of patterns on the stack (more than 1 = a pushed pattern is running)
+//****************************************************************************
+uint8_t ledpattern_depth(void){
+	return ledpattern_count;
+}
@@ -0,0 +1,54 @@
+/*
+ * USB-Changer ledpattern.h
+ *
+ * Status LED pattern interpreter. A pattern is a const byte sequence built from the LEDP_* macros below and is run from
+ * the main loop, driven by a deferred one-shot SYSTIMER timer armed for the next LED change. Levels and ramps are applied
+ * through ledfade. Patterns are kept on a short stack: the bottom pattern is the base pattern (e.g. the LED following the
+ * relay), a pushed pattern (e.g. a blink sequence as user info) runs on top of it and the pattern below is restarted
+ * when it returns. ledpattern_init must be called before any other function of this module.
+ * LEDP_SEQUENCE hands the LED to a sequence of the slice (ledfade_sequence): the pattern stops there like at its end
+ * and arms no timer, so a blink keeps going through sleep without waking the CPU. The instructions behind the steps
+ * are the fallback where no sequence can run (LEDFADE_SEQUENCE_ENABLED 0, a stream owns the LED, the host build).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef LEDPATTERN_H
+#define LEDPATTERN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LEDPATTERN_STACK_SIZE		 3							// Maximum number of patterns on the stack (base pattern included)
+#define LEDPATTERN_LOOP_DEPTH		 2							// Maximum nesting of loops within one pattern
+#define LEDPATTERN_MAX_OPS			 16							// Maximum number of instructions run in one go (protects against loops without wait)
+
+typedef enum {
+	LEDP_OP_SET,		// level						Set the LED to level (0 = off, LEDFADE_LEVEL_MAX = full brightness)
+	LEDP_OP_RAMP,		// level, time (2 bytes)		Fade to level within time ms and wait until the ramp is done
+	LEDP_OP_WAIT,		// time (2 bytes)				Wait time ms
+	LEDP_OP_LOOP,		// count						Run the instructions up to the matching LEDP_OP_NEXT count times
+	LEDP_OP_NEXT,		//								End of a loop
+	LEDP_OP_SEQUENCE,	// count, count steps (4 bytes)	Run the steps from the LED slice until the pattern is replaced (see ledfade_sequence)
+	LEDP_OP_RETURN		//								End of the pattern (returns to the pattern below, the base pattern holds the LED)
+} ledpattern_ops;
+
+#define LEDP_FOREVER				 0							// Loop count of an endless loop
+#define LEDP_ARG					 0xFF						// Loop count given to ledpattern_play/push/set_base
+
+#define LEDP_SET(level)				 LEDP_OP_SET, (level)
+#define LEDP_RAMP(level, time)		 LEDP_OP_RAMP, (level), ((time) & 0xFF), ((time) >> 8)
+#define LEDP_WAIT(time)				 LEDP_OP_WAIT, ((time) & 0xFF), ((time) >> 8)
+#define LEDP_LOOP(count)			 LEDP_OP_LOOP, (count)
+#define LEDP_NEXT					 LEDP_OP_NEXT
+#define LEDP_SEQUENCE(count)		 LEDP_OP_SEQUENCE, (count)
+#define LEDP_STEP(period, on)		 ((period) & 0xFF), ((period) >> 8), ((on) & 0xFF), ((on) >> 8)	// In ms. One step of LEDP_SEQUENCE: PWM period, LED on within it
+#define LEDP_RETURN					 LEDP_OP_RETURN
+
+bool ledpattern_init(void);
+void ledpattern_play(const uint8_t *pattern, uint8_t arg);
+void ledpattern_set_base(const uint8_t *pattern, uint8_t arg);
+void ledpattern_push(const uint8_t *pattern, uint8_t arg);
+uint8_t ledpattern_depth(void);
+
+#endif /* LEDPATTERN_H */
@@ -0,0 +1,81 @@
+/*
+ * USB-Changer livestatus.c
+ *
+ * Live status block (see livestatus.h). The block lives in the section .livestatus, which the linker script keeps at
+ * LIVESTATUS_ADDRESS inside .no_init: it is neither loaded nor cleared, livestatus_init writes the header at boot.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <string.h>
+#include "DAVE.h"
+#include "livestatus.h"
+#include "sensor.h"
+#include "relay.h"
+#include "metrics.h"
+#include "trace.h"
+
+typedef char livestatus_size_check[(sizeof(livestatus_t) <= LIVESTATUS_SIZE && SENSOR_CHANNEL_COUNT <= LIVESTATUS_CHANNELS) ? 1 : -1];
+
+livestatus_t livestatus __attribute__((section(".livestatus")));	// At LIVESTATUS_ADDRESS (reserved by the linker script)
+
+
+//****************************************************************************
+// livestatus_init - clears the block and writes its header (boot, before the main loop)
+//****************************************************************************
+void livestatus_init(void){
+#if LIVESTATUS_ENABLED
+	// The magic goes last, a reader never takes a block with an old body for a valid one
+	livestatus.magic = 0;
+	__DMB();
+	memset((uint8_t *)&livestatus + sizeof(livestatus.magic), 0, sizeof(livestatus_t) - sizeof(livestatus.magic));
+	livestatus.version = LIVESTATUS_VERSION;
+	livestatus.size = (uint8_t)sizeof(livestatus_t);
+	livestatus.channels = SENSOR_CHANNEL_COUNT;
+	livestatus.metrics_count = metrics_count();
+	livestatus.metrics = (uint32_t)(uintptr_t)metrics_get_entry(0);
+	livestatus.trace = (uint32_t)(uintptr_t)&trace_buffer;
+	__DMB();
+	livestatus.magic = LIVESTATUS_MAGIC;
+#endif
+}
+
+//****************************************************************************
+// livestatus_update - refreshes the block from the frame of the pass (main loop, once per pass)
+//****************************************************************************
+void livestatus_update(const frame_t *frame, uint8_t usb_state, uint8_t setup_state, uint8_t profile){
+#if LIVESTATUS_ENABLED
+	uint8_t relays = 0;
+	uint8_t faults = 0;
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		if(relay_channels[i].state == RELAY_HIGH)
+			relays |= (uint8_t)(1U << i);
+		if(relay_channels[i].fault != RELAY_FAULT_NONE)
+			faults |= (uint8_t)(1U << i);
+	}
+
+	// Sequence lock: odd while the fields change, the barriers keep the stores in order for the probe
+	livestatus.sequence++;
+	__DMB();
+	livestatus.now = frame->now;
+	livestatus.passes++;
+	livestatus.events = frame->events;
+	livestatus.usb_state = usb_state;
+	livestatus.setup_state = setup_state;
+	livestatus.profile = profile;
+	livestatus.relays = relays;
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
+		livestatus.values[i] = frame->values[i];
+	livestatus.sensor_results = sensor_result_count;
+	livestatus.sensor_invalid = sensor_invalid_count;
+	livestatus.sensor_overruns = sensor_overruns;
+	livestatus.faults = faults;
+	__DMB();
+	livestatus.sequence++;
+#else
+	(void)frame;
+	(void)usb_state;
+	(void)setup_state;
+	(void)profile;
+#endif
+}
@@ -0,0 +1,62 @@
+/*
+ * USB-Changer livestatus.h
+ *
+ * Live status block for a debug probe or a production tester. The linker script places it at LIVESTATUS_ADDRESS, a
+ * fixed address right below the updater request at the top of the SRAM, so a reader needs no symbol file of the
+ * build: it finds the block by its address, checks magic, version and size and streams it by memory reads over SWD
+ * while the target runs (no halt, no telemetry link, no code on the target side beyond livestatus_update).
+ * The main loop refreshes the block once per pass from its frame (frame.h): the time and events of the pass, the
+ * state machines, the channel values and relay states and the sensor counters. Deeper structures are reached by the
+ * addresses in the block, the metrics table (metrics.h, metrics_count entries of metrics_entry_t) and the event trace
+ * ring (trace_buffer_t, trace.h).
+ * A refresh is a sequence lock: sequence is odd while the fields are written. A reader takes sequence, the fields and
+ * sequence again and keeps the copy if both are equal and even. Fields are only appended (version is raised and size
+ * grows), a reader of an older version just reads the first size bytes it knows.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef LIVESTATUS_H
+#define LIVESTATUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "frame.h"
+
+#define LIVESTATUS_ENABLED			 0							// Determines if the main loop refreshes the status block (its SRAM stays reserved by the linker script)
+#define LIVESTATUS_MAGIC			 0x3154534CU				// "LST1", start of a valid block
+#define LIVESTATUS_VERSION			 1							// Raised with every appended field
+#define LIVESTATUS_SIZE				 64U						// In bytes. Reserved block size (livestatus_size in linker_script.ld)
+#define LIVESTATUS_ADDRESS			 (0x20003FFCU - LIVESTATUS_SIZE)	// Right below the updater request (UPDATER_REQUEST_ADDRESS, updater.h)
+#define LIVESTATUS_CHANNELS			 4							// Channel values in the block (channels beyond SENSOR_CHANNEL_COUNT stay 0)
+
+typedef struct {
+	uint32_t magic;							// LIVESTATUS_MAGIC (anything else: block not set up yet, e.g. after power on)
+	uint8_t version;						// LIVESTATUS_VERSION
+	uint8_t size;							// In bytes. sizeof(livestatus_t)
+	uint8_t channels;						// SENSOR_CHANNEL_COUNT
+	uint8_t reserved;
+	volatile uint32_t sequence;				// Odd while the main loop writes the fields below
+	uint32_t now;							// In us. Time of the pass (frame_t.now)
+	uint32_t passes;						// Main loop passes since reset
+	uint32_t events;						// EVENT_* taken for the pass (main.c)
+	uint8_t usb_state;						// USB_states (main_state.usb_state)
+	uint8_t setup_state;					// setup_states
+	uint8_t profile;						// Active threshold profile
+	uint8_t relays;							// Bit per sensor channel whose output is RELAY_HIGH
+	uint32_t values[LIVESTATUS_CHANNELS];	// Latest filtered ADC value per channel (frame_t.values)
+	uint32_t sensor_results;				// sensor_result_count
+	uint32_t sensor_invalid;				// sensor_invalid_count
+	uint16_t sensor_overruns;				// sensor_overruns
+	uint8_t metrics_count;					// Entries of the metrics table
+	uint8_t faults;							// Bit per sensor channel with an active sensor fault
+	uint32_t metrics;						// Address of the metrics table (metrics_entry_t, metrics.h)
+	uint32_t trace;							// Address of the event trace ring (trace_buffer_t, trace.h)
+} livestatus_t;
+
+extern livestatus_t livestatus;
+
+void livestatus_init(void);
+void livestatus_update(const frame_t *frame, uint8_t usb_state, uint8_t setup_state, uint8_t profile);
+
+#endif /* LIVESTATUS_H */
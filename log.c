@@ -0,0 +1,76 @@
+/*
+ * USB-Changer log.c
+ *
+ * Log ring and printf backend (see log.h). The ring has several producers (any context, interrupts masked while an
+ * entry is written) and one consumer (telemetry_task). A full ring drops the new entry, so the oldest context of a
+ * burst survives.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "log.h"
+#include "telemetry.h"
+#include "ramcode.h"
+#include "metrics.h"
+#include "arena.h"
+#include "critical.h"
+
+typedef char log_entries_check[((LOG_ENTRIES & (LOG_ENTRIES - 1)) == 0 && LOG_ENTRIES <= 128) ? 1 : -1];
+
+ARENA(log) log_entry_t log_ring[LOG_ENTRIES];
+volatile uint8_t log_head = 0;		// Index the next entry is written to
+volatile uint8_t log_tail = 0;		// Index of the oldest entry
+uint32_t log_dropped = 0;
+METRICS_REGISTER(log_dropped, METRICS_ID_LOG_DROPPED, METRICS_TYPE_U32, METRICS_UNIT_COUNT, log_dropped);
+
+int _write(int file, char *ptr, int len) __attribute__((externally_visible));
+
+
+//****************************************************************************
+// log_record - appends an entry to the ring (main and interrupt context, see LOG_ERROR ... LOG_DEBUG)
+//****************************************************************************
+void log_record(uint16_t id, uint8_t level, uint8_t count, uint32_t arg0, uint32_t arg1){
+	critical_state_t primask = critical_enter();
+	uint8_t head = log_head;
+	if(((head - log_tail) & 0xFFU) >= LOG_ENTRIES)
+		log_dropped++;
+	else{
+		log_entry_t *entry = &log_ring[head & (LOG_ENTRIES - 1U)];
+		entry->id = id;
+		entry->level = level;
+		entry->count = count;
+		entry->args[0] = arg0;
+		entry->args[1] = arg1;
+		log_head = (uint8_t)(head + 1U);
+	}
+	critical_exit(primask, CRITICAL_SITE_LOG);
+}
+
+//****************************************************************************
+// log_read - takes the oldest entry out of the ring, returns false if it is empty (main context)
+//****************************************************************************
+bool log_read(log_entry_t *entry){
+	uint8_t tail = log_tail;
+	if(tail == log_head)
+		return false;
+	*entry = log_ring[tail & (LOG_ENTRIES - 1U)];
+	log_tail = (uint8_t)(tail + 1U);
+	return true;
+}
+
+//****************************************************************************
+// _write - newlib output of printf and puts: queues the text as telemetry records (main context, never blocks)
+//****************************************************************************
+int _write(int file, char *ptr, int len){
+	(void)file;
+	for(int sent = 0; sent < len; sent += TELEMETRY_PAYLOAD_MAX){
+		int length = len - sent;
+		if(length > TELEMETRY_PAYLOAD_MAX)
+			length = TELEMETRY_PAYLOAD_MAX;
+		// A full transmit ring drops the rest (counted by telemetry)
+		if(!telemetry_send(TELEMETRY_RECORD_TEXT, (const uint8_t *)&ptr[sent], (uint8_t)length))
+			break;
+	}
+	return len;
+}
@@ -0,0 +1,76 @@
+/*
+ * USB-Changer log.h
+ *
+ * Tokenised logging. LOG_ERROR/WARN/INFO/DEBUG(format, up to 2 integer arguments) store the format string in the
+ * .log_strings section, which the linker script keeps in the ELF file only (address 0, not loaded): the target never
+ * formats text, it records the offset of the string as id together with the level and the raw arguments (a few stores
+ * with interrupts masked, main and interrupt context). telemetry_task drains the ring as TELEMETRY_RECORD_LOG records,
+ * the host looks the id up in the .log_strings section of the ELF file and formats the arguments with it.
+ * Calls below LOG_LEVEL are removed by the preprocessor, their strings are not linked either.
+ * printf goes through _write (log.c) too: the text is queued as TELEMETRY_RECORD_TEXT records and dropped if the
+ * transmit ring is full (main context only, formatting costs what printf costs).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_LEVEL_NONE				 0
+#define LOG_LEVEL_ERROR				 1
+#define LOG_LEVEL_WARN				 2
+#define LOG_LEVEL_INFO				 3
+#define LOG_LEVEL_DEBUG				 4
+
+#define LOG_LEVEL					 LOG_LEVEL_NONE				// Highest level that is compiled in (LOG_LEVEL_NONE removes all LOG calls, LOG_LEVEL_INFO adds the notes of the normal operation)
+#define LOG_ENTRIES					 16							// Number of entries the ring holds (power of 2, 12 bytes each)
+#define LOG_ARGS_MAX				 2							// Arguments per entry
+
+typedef struct {
+	uint16_t id;					// Offset of the format string in .log_strings
+	uint8_t level;					// LOG_LEVEL_*
+	uint8_t count;					// Number of arguments
+	uint32_t args[LOG_ARGS_MAX];
+} log_entry_t;
+
+extern uint32_t log_dropped;		// Entries dropped because the ring was full
+
+void log_record(uint16_t id, uint8_t level, uint8_t count, uint32_t arg0, uint32_t arg1);
+bool log_read(log_entry_t *entry);
+
+// Places the format string in .log_strings and yields its offset
+#define LOG_ID(format)				 __extension__({static const char log_format[] __attribute__((section(".log_strings"), used)) = (format); (uint16_t)(uintptr_t)log_format;})
+// Number, first and second of 0 to 2 arguments (GNU comma elision)
+#define LOG_COUNT(...)				 LOG_COUNT_(0, ##__VA_ARGS__, 2, 1, 0)
+#define LOG_COUNT_(z, a, b, n, ...)	 n
+#define LOG_FIRST(...)				 LOG_FIRST_(0, ##__VA_ARGS__, 0, 0)
+#define LOG_FIRST_(z, a, ...)		 a
+#define LOG_SECOND(...)				 LOG_SECOND_(0, ##__VA_ARGS__, 0, 0)
+#define LOG_SECOND_(z, a, b, ...)	 b
+#define LOG_EMIT(level, format, ...) log_record(LOG_ID(format), (level), LOG_COUNT(__VA_ARGS__), (uint32_t)(LOG_FIRST(__VA_ARGS__)), (uint32_t)(LOG_SECOND(__VA_ARGS__)))
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+	#define LOG_ERROR(format, ...)	 LOG_EMIT(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+	#define LOG_ERROR(format, ...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+	#define LOG_WARN(format, ...)	 LOG_EMIT(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+	#define LOG_WARN(format, ...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+	#define LOG_INFO(format, ...)	 LOG_EMIT(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+	#define LOG_INFO(format, ...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+	#define LOG_DEBUG(format, ...)	 LOG_EMIT(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+	#define LOG_DEBUG(format, ...)
+#endif
+
+#endif /* LOG_H */
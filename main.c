@@ -4,10 +4,26 @@
  * A Infineon XMC1100 powered system used to switch between 2 USB Devices and to control a relay based on a sensor input with configurable hysteresis.
  *
  * Features: 	- Switching between 2 USB ports on button press
+ * 				- USB standby (all ports powered off, mux disabled) on a chord of the USB and down button
+ * 				- Optional automatic USB port failover on VBUS/current sense channels
  * 				- Relay controlled by an ADC input with hysteresis and pulse filter
+ * 				- Optional latching relay driven by timed set and reset coil pulses (no holding current)
+ * 				- Optional shift register output expander for many relays, all outputs of a pass latched at once
+ * 				- Status LED brightness changes of a loop pass written once at its end (output image)
+ * 				- Optional interrupt free 32 bit microsecond time base from two concatenated CCU4 slices
+ * 				- Optional relay switching synchronised to the zero crosses of an AC load
+ * 				- Live status block at a fixed SRAM address, streamed by a debug probe without halting the target
+ * 				- Status LED blink sequences run by the PWM slice at a slow clock, no wake-ups while the CPU sleeps
+ * 				- Optional addressed multi-drop host bus for racks of units, broadcast settings and synchronised timed commands
+ * 				- Optional frequency or PWM duty input measured by a CCU4 capture slice instead of the ADC
+ * 				- Optional digital I2C sensor input read by an interrupt driven I2C master instead of the ADC
+ * 				- Optional polled acquisition (the main loop reads the ADC results itself, lowest detection latency)
  * 				- Setup menu to configure Hysteresis (different threshold for off an on) and filter (threshold must be exceed for a certain time period)
+ * 				- Stored threshold profiles, switched by a chord of the USB and up button, the host or a day and night schedule
+ * 				- Rollback to previous settings records on a chord of the up and down button or by the host, stored once confirmed
  * 				- User interface with a status LED (blinking & fading patterns) and buttons (up, down, usb switch)
  * 				- Setup stored on emulated EEPROM
+ * 					- Per unit factory calibration (ADC offset and gain, default thresholds, relay times, serial number) in a flash page of its own
  * 					- USB state is stored after 10sec continuous state in order to prevent fast FLASH degeneration
  * 					- Thresholds and filter latch time is stored immediately
  *
@@ -16,77 +32,307 @@
  */
 
 #include "DAVE.h" //Declarations from DAVE Code Generation (includes SFR declaration)
+#include "scheduler.h"
+#include "profiler.h"
+#include "buttons.h"
+#include "sensor.h"
+#include "relay.h"
+#include "timing.h"
+#include "storage.h"
+#include "settings.h"
+#include "statelog.h"
+#include "bulkflash.h"
+#include "factory.h"
+#include "fieldhist.h"
+#include "updater.h"
+#include "supply.h"
+#include "ledfade.h"
+#include "ledpattern.h"
+#include "hrtimer.h"
+#include "clockscale.h"
+#include "boot.h"
+#include "ramcode.h"
+#include "power.h"
+#include "watchdog.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "hostcmd.h"
+#include "capture.h"
+#include "i2ctarget.h"
+#include "spistream.h"
+#include "log.h"
+#include "wallclock.h"
+#include "usbswitch.h"
+#include "failover.h"
+#include "relaylife.h"
+#include "relaytime.h"
+#include "coil.h"
+#include "acmp.h"
+#include "eebench.h"
+#include "storm.h"
+#include "stimulus.h"
+#include "funcprof.h"
+#include "recorder.h"
+#include "fsm.h"
+#include "divide.h"
+#include "irqprio.h"
+#include "metrics.h"
+#include "stackmon.h"
+#include "arena.h"
+#include "critical.h"
+#include "pt.h"
+#include "retain.h"
+#include "optical.h"
+#include "evbus.h"
+#include "container.h"
+#include "flashcheck.h"
+#include "energy.h"
+#include "telesub.h"
+#include "softpwm.h"
+#include "frame.h"
+#include "modbus.h"
+#include "freqsensor.h"
+#include "i2cmaster.h"
+#include "i2csensor.h"
+#include "bistable.h"
+#include "expander.h"
+#include "outputs.h"
+#include "timebase.h"
+#include "zerocross.h"
+#include "hostbus.h"
+#include "livestatus.h"
+#include "hal.h"
 
 
 // Constant settings (must be set hard-coded)
 #define USB_STORE_STATE_EEPROM		 1						// Determines if USB state shall be written to EEPROM
-#define USB_STORE_STATE_EEPROM_DELAY 5000						// After a change of USB state it will be saved to EEPROM after this delay (reduce FLASH degeneration)
-#define BTN_STD_PRESS_DURATION		 60							// The minimum duration of a button press that will be registered as such (debouncing)
-#define BTN_LONG_PRESS_DURATION		 1000						// The minimum duration of a long button press that will be registered as such (debouncing)
-#define BTN_LONGEST_PRESS_DURATION	 4000						// The maximum duration of a button press
-#define ADC_THRESHOLD_MAX			 4095						// Maximum ADC value. Note: 4095 can be divided by 1, 3, 5, 7, 9, 13, 15, 21, 35, 39, 45, 63, 65, 91, 105, 117, 195, 273, 315, 455, 585, 819, 1365 without decimals
+#define USB_STORE_STATE_LOG			 0							// Determines if USB state is recorded in the state log on every change (else it is saved with the setup after USB_STORE_STATE_EEPROM_DELAY)
+#define USB_STORE_STATE_EEPROM_DELAY 5000						// After a change of USB state it will be saved to EEPROM after this delay (reduce FLASH degeneration, USB_STORE_STATE_LOG = 0 only)
+#define ADC_THRESHOLD_MAX			 SENSOR_VALUE_MAX			// Maximum ADC value (4095 without SENSOR_DECIMATION_BITS). Note: 4095 can be divided by 1, 3, 5, 7, 9, 13, 15, 21, 35, 39, 45, 63, 65, 91, 105, 117, 195, 273, 315, 455, 585, 819, 1365 without decimals
 #define ADC_THRESHOLD_INCREMENT		 (ADC_THRESHOLD_MAX / 35)	// Value added/subtracted when adjusting threshold. 35 means there are 35 steps for setting thresholds
 #define ADC_TH_UPPER_DEFAULT		 3510						// Default upper threshold
 #define ADC_TH_LOWER_DEFAULT		 585							// Default lower threshold
+#define ADC_HYSTERESIS_MIN			 ADC_THRESHOLD_INCREMENT	// Smallest distance of the upper above the lower threshold the setup menu leaves
+#define SETUP_TEACH_TIME			 2000						// In ms. Sampling window of the teach-in started by the longest press (0 = the press saves the current value)
+#define SETUP_TEACH_SIGMA			 12							// In quarters of the standard deviation. Distance of a taught threshold from the mean of the window (12 = 3 sigma)
 #define RELAY_LATCHTIME_MAX			 60000						// Maximum configurable time that the threshold must be exceeded to trigger a state change of the relay
 #define RELAY_LATCHTIME_INCREMENT	 250							// Value added/subtracted when adjusting time
 #define RELAY_LATCHTIME_DEFAULT		 500							// Default lower threshold exceed time
 #define LED_PULSE_SHORT				 200							// In ms. Duration of a short led pulse used for led pattern "number"
 #define LED_PULSE_LONG				 1100						// In ms. Duration of a long led pulse used for led pattern "number"
+#define LED_FADE_TIME				 1500						// In ms. Time of one fade from one extreme to the other
+#define LED_FADE_HOLD				 400							// In ms. Time the end level of a fade is held (before it is repeated)
+#define LED_PULSE_FAULT				 50							// In ms. On and off time of the fast blink of a sensor fault
 #define PWM_FULL_ON					 PWM_CCU4_SYM_DUTY_MIN		// Integer that represents the lowest possible duty cycle of PWM
 #define PWM_FULL_OFF				 PWM_CCU4_SYM_DUTY_MAX		// Integer that represents the highest possible duty cycle of PWM
 #define TIMESTAMP_DEACTIVATED		 UINT32_MAX
-
-// Dynamic settings (can be changed by user - the here defined values are reset/default values)
-int32_t relay_threshold_latchtime = 500; // Time in ms that the threshold must stay exceeded in order to trigger a state change (=basically a filter)
-int32_t ADC_upper_threshold = 3393;    // Upper threshold that the ADC value must be exceed to trigger a state change (must be held exceeded for relay_threshold_latchtime)
-int32_t ADC_lower_threshold = 702;    // Upper threshold that the ADC value must be exceed to trigger a state change (must be held exceeded for relay_threshold_latchtime)
+#define MAIN_LOOP_SLEEP				 1							// Determines if the main loop sleeps (WFI) between events instead of busy polling
+#define SAMPLE_TASK_PERIOD			 1							// In ms. Period of software triggered ADC conversions (only used if SENSOR_FREE_RUNNING is 0)
+#define UI_TASK_PERIOD				 5							// In ms. Period of button timeout checks and setup menu handling (edges additionally trigger it)
+#define USB_SAVE_TASK_PERIOD		 100							// In ms. Period of the check whether the USB state must be stored (USB_STORE_STATE_LOG = 0 only)
+#define USB_STANDBY_CHORD			 ((1U << BUTTON_USB) | (1U << BUTTON_DOWN))	// Chord of the buttons that toggles the USB standby (USB_inactive, resumed to the last port)
+#define PROFILE_CHORD				 ((1U << BUTTON_USB) | (1U << BUTTON_UP))	// Chord of the buttons that selects the next threshold profile (blinks its number + 1)
+#define OPTICAL_CHORD				 ((1U << BUTTON_USB) | (1U << BUTTON_UP) | (1U << BUTTON_DOWN))	// Chord of the buttons that starts and stops the optical readout (optical.h)
+#define ROLLBACK_CHORD				 ((1U << BUTTON_UP) | (1U << BUTTON_DOWN))	// Chord of the buttons that applies the next older settings record (rollback_settings)
+#define SETUP_ROLLBACK				 0							// Determines if older settings records can be applied (rollback chord and HOSTCMD_SETTING_ROLLBACK, 0 = only the stored record is used)
+#define PROFILE_DAY					 0							// Threshold profile the schedule selects at the day start
+#define PROFILE_NIGHT				 1							// Threshold profile the schedule selects at the night start
+#define PROFILE_SCHEDULE_OFF		 1440						// Start minute of a schedule that is not set (the schedule needs both starts)
+#define PROFILE_SCHEDULE_PERIOD		 1000						// In ms. Period of the day and night schedule check
+#define PROFILE_NONE				 0xFFU						// main_state.profile_scheduled: no profile selected by the schedule yet
+#define ADC_BOUNDARY_EVENTS			 1							// Determines if the ADC interrupt checks the thresholds and only raises an event when the signal crosses one (instead of evaluating every result in the main loop)
+#define RELAY_IN_ISR				 0							// Determines if the ADC interrupt also evaluates the latch time and switches the outputs (the main loop only follows a switch up, needs SENSOR_FREE_RUNNING)
+#define RELAY_ISR_BUDGET			 800						// In cycles. Budget of the relay decision in the ADC interrupt (RELAY_IN_ISR, exceeding it is counted by profiling builds)
+#define RELAY_TIMED_LATCH			 0							// Determines if a microsecond timer (hrtimer.h) expires a running latch time and switches the output in its interrupt (ADC_BOUNDARY_EVENTS, else the deadline is only seen when the main loop wakes up)
+#define RELAY_TIMED_RETRY_US		 1000U						// In us. Next try of an expired latch time the limiter held back or that met an evaluation of the main loop
+
+// Durations are converted at compile time (see timing.h), LED pattern times are 16 bit operands in ms
+#define USB_STORE_STATE_EEPROM_DELAY_US	 TIMING_MS_TO_US(USB_STORE_STATE_EEPROM_DELAY + 1U)	// Saved once the delay is exceeded
+typedef char main_timing_check[(USB_STORE_STATE_EEPROM_DELAY < TIMING_MS_MAX && RELAY_LATCHTIME_MAX <= UINT16_MAX
+		&& LED_PULSE_SHORT < LED_PULSE_LONG && LED_PULSE_LONG <= UINT16_MAX && LED_FADE_TIME <= UINT16_MAX && LED_FADE_HOLD <= UINT16_MAX
+		&& 2U * LED_PULSE_FAULT <= LEDFADE_SEQUENCE_PERIOD_MAX) ? 1 : -1];
+
+// Dynamic settings (can be changed by user - reset/default values are defined in relay_channels)
+#define SETUP_CHANNEL				 0							// Sensor channel whose thresholds and latch time are configured by the setup menu and shown by the status LED
+relay_channel_t *const setup_channel = &relay_channels[SETUP_CHANNEL];
 
 
 // State machines
-typedef enum {USB_1_active, USB_2_active, USB_inactive} USB_states;
-typedef enum {RELAY_HIGH, RELAY_LOW} relay_states;
-typedef enum {SETUP_IDLE, SETUP_UPPER_TH, SETUP_LOWER_TH, SETUP_TIME_TH} setup_states;
-USB_states USB_state = USB_1_active;
-relay_states relay_state = RELAY_LOW;
-setup_states setup_state = SETUP_IDLE;
-uint32_t usb_changed_timestamp = 0;
-typedef enum {LED_OFF, LED_ON, LED_NUMBER, LED_FADE_DOWN, LED_FADE_UP, LED_MATCH_RELAY_STATE} LED_patterns;
-LED_patterns led_status_pattern = LED_OFF;
-LED_patterns led_status_pattern_last = LED_OFF;
-typedef enum {LED_PATTERN_CONTINUOUS, LED_PATTERN_SINGLE} LED_pattern_modes;
-LED_pattern_modes led_pattern_mode = LED_PATTERN_CONTINUOUS;
-LED_patterns led_status_pattern_after_single = LED_OFF; 	// Defines to what pattern will be switched after a LED_PATTERN_SINGLE execution
-uint16_t led_number_continuous = 0;
-uint16_t led_number_single = 0;
-uint16_t led_fadetime = 1500; // Time of one fade from one extreme to the other
-uint16_t led_fadesteps = 1000; // Number of steps used to fade led
-
-// Buttons
-typedef enum {BTNPRESS_NOT, BTNPRESS_STD, BTNPRESS_LONG, BTNPRESS_LONGEST} button_press_states;
-button_press_states buttonpress_usb = BTNPRESS_NOT;
-button_press_states buttonpress_up = BTNPRESS_NOT;
-button_press_states buttonpress_down = BTNPRESS_NOT;
-uint32_t button_usb_pressed_timestamp = 0; // If a button is pressed (or state = HIGH) the current time will be saved (used to calculate duration)
-uint32_t button_up_pressed_timestamp = 0;
-uint32_t button_down_pressed_timestamp = 0;
-uint16_t button_usb_pressed_duration = 0; // If a button is released (or state = LOW) duration is calculated (in ms)
-uint16_t button_up_pressed_duration = 0;
-uint16_t button_down_pressed_duration = 0;
-#define SW_ON 0
-#define SW_OFF 1
-
-// ADC
-uint32_t ADC_val_current = 0;
-uint32_t ADC_val_upper_thres_exceed_timestamp = 0; // If this is 0 the threshold is not exceeded. If threshold is exceeded this marks the point when it got started to be exceeded
-uint32_t ADC_val_lower_thres_exceed_timestamp = 0;
+typedef enum {SETUP_IDLE, SETUP_UPPER_TH, SETUP_LOWER_TH, SETUP_TIME_TH, SETUP_STATE_COUNT} setup_states;
+// Status LED patterns (see ledpattern.h)
+const uint8_t led_pattern_off[] = {LEDP_SET(0), LEDP_RETURN};
+const uint8_t led_pattern_on[] = {LEDP_SET(LEDFADE_LEVEL_MAX), LEDP_RETURN};
+const uint8_t led_pattern_number[] = {	// Argument number of pulses, repeated after a long low phase
+	LEDP_SET(0), LEDP_WAIT(LED_PULSE_SHORT),
+	LEDP_LOOP(LEDP_FOREVER),
+		LEDP_LOOP(LEDP_ARG),
+			LEDP_SET(LEDFADE_LEVEL_MAX), LEDP_WAIT(LED_PULSE_SHORT), LEDP_SET(0), LEDP_WAIT(LED_PULSE_SHORT),
+		LEDP_NEXT,
+		LEDP_WAIT(LED_PULSE_LONG - LED_PULSE_SHORT),
+	LEDP_NEXT,
+	LEDP_RETURN
+};
+const uint8_t led_pattern_number_single[] = {	// Argument number of pulses, played once (user info)
+	LEDP_SET(0), LEDP_WAIT(LED_PULSE_SHORT),
+	LEDP_LOOP(LEDP_ARG),
+		LEDP_SET(LEDFADE_LEVEL_MAX), LEDP_WAIT(LED_PULSE_SHORT), LEDP_SET(0), LEDP_WAIT(LED_PULSE_SHORT),
+	LEDP_NEXT,
+	LEDP_RETURN
+};
+const uint8_t led_pattern_fade_up[] = {
+	LEDP_LOOP(LEDP_FOREVER),
+		LEDP_SET(0), LEDP_RAMP(LEDFADE_LEVEL_MAX, LED_FADE_TIME), LEDP_WAIT(LED_FADE_HOLD),
+	LEDP_NEXT,
+	LEDP_RETURN
+};
+const uint8_t led_pattern_fade_down[] = {
+	LEDP_LOOP(LEDP_FOREVER),
+		LEDP_SET(LEDFADE_LEVEL_MAX), LEDP_RAMP(0, LED_FADE_TIME), LEDP_WAIT(LED_FADE_HOLD),
+	LEDP_NEXT,
+	LEDP_RETURN
+};
+const uint8_t led_pattern_fault[] = {	// Sensor fault of the setup channel (relay in its safe state), blinks from the LED slice during sleep
+	LEDP_SEQUENCE(1), LEDP_STEP(2 * LED_PULSE_FAULT, LED_PULSE_FAULT),
+	LEDP_LOOP(LEDP_FOREVER),
+		LEDP_SET(LEDFADE_LEVEL_MAX), LEDP_WAIT(LED_PULSE_FAULT), LEDP_SET(0), LEDP_WAIT(LED_PULSE_FAULT),
+	LEDP_NEXT,
+	LEDP_RETURN
+};
+
+
+// Events (posted by interrupts/callbacks, consumed by the main loop)
+#define EVENT_TICK					 (1U << 0)					// At least one scheduler task got due
+#define EVENT_ADC_RESULT			 (1U << 1)					// New samples are queued in the sensor ring buffer (ADC_BOUNDARY_EVENTS = 0)
+#define EVENT_ADC_BOUNDARY			 (1U << 2)					// The ADC value crossed a threshold (ADC_BOUNDARY_EVENTS = 1)
+#define EVENT_TIMER					 (1U << 3)					// A deferred SYSTIMER callback is due (status LED pattern steps)
+#define EVENT_ALARM					 (1U << 4)					// The wall clock alarm went off (timed USB switch)
+#define EVENT_USB_REQUEST			 (1U << 5)					// The host selected a USB port or the standby (main_state.usb_host_request)
+#define EVENT_RELAY_SWITCHED		 (1U << 6)					// The ADC interrupt (RELAY_IN_ISR = 1) or a latch timer (RELAY_TIMED_LATCH = 1) switched a relay output (channels in main_state.relay_switched)
+#define EVENT_SENSOR_FAULT			 (1U << 7)					// A sensor fault began or ended, the ADC interrupt drove the safe state (channels in main_state.relay_faulted)
+#define EVENT_PROFILE_REQUEST		 (1U << 8)					// The host selected a threshold profile (main_state.profile_host_request)
+#define EVENT_BUS					 (1U << 9)					// An event is queued on the event bus (evbus.h)
+#define EVENT_ROLLBACK_REQUEST		 (1U << 10)					// The host selected a previous settings record (main_state.rollback_host_request)
+#define EVENT_HOST_TIMED			 (1U << 11)					// The delay of a HOSTCMD_AT command has passed (hostcmd_run)
+// Application state of the main loop, the setup menu and the host interfaces in one record. Its fields are reached by
+// offsets from one base address instead of a literal pool address load per variable (Thumb-1), enums are kept as bytes
+typedef struct {
+	volatile uint32_t pending_events;	// EVENT_* posted by interrupts/callbacks, consumed by the main loop
+#if !USB_STORE_STATE_LOG
+	pt_t usb_store_pt;					// usb_save_thread
+	uint32_t usb_store_deadline;		// In us
+	bool usb_store_pending;				// USB state changed and must be saved once usb_store_deadline is reached
+#endif
+	uint8_t usb_state;					// USB_states. Active port or the standby (USB_inactive)
+	uint8_t usb_host_request;			// USB_states set by HOSTCMD_SETTING_USB_PORT
+	uint8_t usb_led_level;				// Brightness of the lit USB indicator (softpwm level, HOSTCMD_SETTING_USB_LED_LEVEL)
+	uint8_t setup_state;				// setup_states
+	bool setup_teaching;				// The menu of setup_state samples for a teach-in (setup_teach)
+	int8_t ui_task_id;					// Scheduler task of task_ui (triggered by button edges)
+	bool update_pending;				// HOSTCMD_UPDATE was answered, reset into the updater once the response and the flash writes are out
+	bool quiet;							// No button press or relay switch for STORAGE_GC_QUIET_TIME (planned garbage collection)
+	uint32_t quiet_deadline;			// In us. End of the quiet time (restarted by quiet_restart)
+	uint8_t profile;					// Active threshold profile (its values are the working copy in setup_channel)
+	uint8_t profile_host_request;		// Threshold profile set by HOSTCMD_SETTING_PROFILE
+	uint8_t profile_scheduled;			// Profile selected by the schedule for the current period (PROFILE_NONE = none yet)
+	uint16_t profile_day_start;			// In minutes of the day (UTC). Start of PROFILE_DAY (PROFILE_SCHEDULE_OFF = no schedule)
+	uint16_t profile_night_start;		// In minutes of the day (UTC). Start of PROFILE_NIGHT
+	uint8_t rollback;					// Previous settings record applied in RAM (0 = the stored one, see rollback_settings)
+	uint8_t rollback_host_request;		// Settings record set by HOSTCMD_SETTING_ROLLBACK
+#if ADC_BOUNDARY_EVENTS && !RELAY_IN_ISR
+	volatile uint32_t boundary_time;	// In us. Time of the result that posted the last EVENT_ADC_BOUNDARY (sample age of the decision)
+#endif
+#if RELAY_IN_ISR || RELAY_TIMED_LATCH
+	volatile uint32_t relay_switched;	// Bit per sensor channel whose output the ADC interrupt or the latch timer switched (taken with interrupts masked)
+#endif
+#if RELAY_TIMED_LATCH
+	uint32_t relay_timer[SENSOR_CHANNEL_COUNT];	// hrtimer expiring the latch time per sensor channel (0 = not created)
+	volatile bool relay_evaluating;		// The main loop runs manage_relay (an expired latch timer tries again later)
+#endif
+#if RELAY_FAULT_ENABLED
+	volatile uint32_t relay_faulted;	// Bit per sensor channel whose fault began or ended (taken with interrupts masked)
+#endif
+} main_state_t;
+main_state_t main_state = {.usb_state = USB_1_active, .usb_host_request = USB_1_active, .usb_led_level = SOFTPWM_USB_LEVEL, .setup_state = SETUP_IDLE,
+		.ui_task_id = SCHEDULER_INVALID_TASK, .profile_scheduled = PROFILE_NONE, .profile_day_start = PROFILE_SCHEDULE_OFF,
+		.profile_night_start = PROFILE_SCHEDULE_OFF};
+frame_t main_frame;	// Context of the current main loop pass
+METRICS_REGISTER(usb_state, METRICS_ID_USB_STATE, METRICS_TYPE_U8, METRICS_UNIT_STATE, main_state.usb_state);
+#if RELAY_IN_ISR && !SENSOR_FREE_RUNNING
+	#error "RELAY_IN_ISR needs SENSOR_FREE_RUNNING (the ADC interrupt must see every sample)"
+#endif
+#if RELAY_TIMED_LATCH && (RELAY_IN_ISR || !ADC_BOUNDARY_EVENTS)
+	#error "RELAY_TIMED_LATCH needs ADC_BOUNDARY_EVENTS without RELAY_IN_ISR (the latch time is evaluated in the main loop)"
+#endif
+#if HOSTBUS_ENABLED && !TELEMETRY_ENABLED
+	#error "HOSTBUS_ENABLED needs TELEMETRY_ENABLED (the bus runs on the telemetry UART)"
+#endif
+#if (RELAY_TIMED_LATCH || BISTABLE_ENABLED || SOFTPWM_ENABLED || ZEROCROSS_ENABLED || MODBUS_ENABLED || TELEMETRY_ENABLED) && !HRTIMER_ENABLED
+	#error "RELAY_TIMED_LATCH, BISTABLE_ENABLED, SOFTPWM_ENABLED, ZEROCROSS_ENABLED, MODBUS_ENABLED and TELEMETRY_ENABLED need HRTIMER_ENABLED (hrtimer.h)"
+#endif
+#if (TELEMETRY_ENABLED || OPTICAL_ENABLED || LIVESTATUS_ENABLED) && !METRICS_ENABLED
+	#error "TELEMETRY_ENABLED, OPTICAL_ENABLED and LIVESTATUS_ENABLED need METRICS_ENABLED (metrics.h, their readers enumerate the table)"
+#endif
+#if (OPTICAL_ENABLED || STORM_ENABLED) && !LEDFADE_STREAM_ENABLED
+	#error "OPTICAL_ENABLED and STORM_ENABLED need LEDFADE_STREAM_ENABLED (ledfade.h, both drive the LED by symbols)"
+#endif
+#if RELAY_TIMED_LATCH
+typedef char main_relay_timer_check[(SENSOR_CHANNEL_COUNT <= HRTIMER_COUNT) ? 1 : -1];
+#endif
+#if SENSOR_POLLED
+	#define ADC_POLL()				 adc_poll()					// Polls the result register between the sections of a main loop pass
+#else
+	#define ADC_POLL()
+#endif
+#if RELAY_IN_ISR && PROFILER_ENABLED
+uint32_t relay_isr_over_budget = 0;		// Relay decisions in the ADC interrupt that took longer than RELAY_ISR_BUDGET
+#endif
+
+// I2C target register map (see i2ctarget.h - addresses follow the table, new registers are appended)
+#define I2C_MAP_VERSION				 1							// Layout version of i2c_map (register 0x00, increment on every layout change)
+#define I2C_CMD_USB1				 0x01						// Commands of the command register
+#define I2C_CMD_USB2				 0x02
+#define I2C_CMD_USB_TOGGLE			 0x03						// Next port of the port table (like the USB button, resumes the last port from standby)
+#define I2C_CMD_USB_STANDBY			 0x04						// All ports off and the mux disabled (USB_inactive)
+#define I2C_CMD_USB_PORT			 0x10						// 0x10 + port index (USB_states) selects that port
+uint8_t i2c_map_version = I2C_MAP_VERSION;
+const i2ctarget_register_t i2c_map[] = {
+	{&i2c_map_version, 1, 1, I2CTARGET_READ},							// 0x00 Map version
+	{&relay_channels[0].state, sizeof(relay_states), 1, I2CTARGET_READ},	// 0x01 Relay state (relay_states)
+	{&main_state.usb_state, 1, 1, I2CTARGET_READ},						// 0x02 USB port (USB_states)
+	{&main_state.setup_state, 1, 1, I2CTARGET_READ},						// 0x03 Setup menu state (setup_states)
+	{&relay_channels[0].value, 4, 2, I2CTARGET_READ},					// 0x04 Filtered ADC value (12 bit)
+	{&relay_channels[0].upper_threshold, 4, 2, I2CTARGET_READ},			// 0x06 Upper threshold
+	{&relay_channels[0].lower_threshold, 4, 2, I2CTARGET_READ},			// 0x08 Lower threshold
+	{&relay_channels[0].latchtime, 4, 2, I2CTARGET_READ},				// 0x0A Latch time in ms
+	{&sensor_result_count, 4, 4, I2CTARGET_READ},						// 0x0C ADC results
+	{&sensor_invalid_count, 4, 4, I2CTARGET_READ},						// 0x10 Invalid ADC results
+	{&i2ctarget_command, 1, 1, I2CTARGET_WRITE},							// 0x14 Command (I2C_CMD_*, executed by i2ctarget_task)
+	{&i2ctarget_command_status, 1, 1, I2CTARGET_READ}					// 0x15 Command status (i2ctarget_command_states)
+};
+
+// Modbus register map (see modbus.h - 16 bit registers follow the table, new registers are appended)
+#define MODBUS_MAP_VERSION			 1							// Layout version of modbus_map (register 0, increment on every layout change)
+uint8_t modbus_map_version = MODBUS_MAP_VERSION;
+const modbus_register_t modbus_map[] = {
+	{&modbus_map_version, 1, 1, MODBUS_READ},							// 0 Map version
+	{&relay_channels[0].state, sizeof(relay_states), 1, MODBUS_READ},	// 1 Relay state (relay_states)
+	{&main_state.usb_state, 1, 1, MODBUS_READ},							// 2 USB port (USB_states)
+	{&main_state.setup_state, 1, 1, MODBUS_READ},						// 3 Setup menu state (setup_states)
+	{&relay_channels[0].value, 4, 1, MODBUS_READ},						// 4 Filtered ADC value (12 bit)
+	{&relay_channels[0].upper_threshold, 4, 1, MODBUS_READ},			// 5 Upper threshold
+	{&relay_channels[0].lower_threshold, 4, 1, MODBUS_READ},			// 6 Lower threshold
+	{&relay_channels[0].latchtime, 4, 1, MODBUS_READ},					// 7 Latch time in ms
+	{&sensor_result_count, 4, 2, MODBUS_READ},							// 8 ADC results (high word first)
+	{&sensor_invalid_count, 4, 2, MODBUS_READ},							// 10 Invalid ADC results
+	{&modbus_requests, 4, 2, MODBUS_READ},								// 12 Modbus requests
+	{&modbus_command, 2, 1, MODBUS_WRITE},								// 14 Command (I2C_CMD_*, executed by modbus_task)
+	{&modbus_command_status, 2, 1, MODBUS_READ}							// 15 Command status (modbus_command_states)
+};
 
 // Debug
-int systime_debug = 0;
-int32_t eeprom_latchtime = 0;
-int32_t eeprom_upper = 0;
-int32_t eeprom_lower = 0;
-int32_t eeprom_usb_state = 0;
+settings_record_t eeprom_settings; // Settings record as read at boot
+settings_profile_t threshold_profiles[SETTINGS_PROFILE_COUNT]; // Stored threshold profiles (read at boot, the active one is updated by write_eeprom_setup)
+volatile uint16_t host_read_value = 0; // Result of the last conversion requested with HOSTCMD_SETTING_ADC_READ
 
 
 
@@ -94,380 +340,1737 @@ int32_t eeprom_usb_state = 0;
 // delay_ms - millisecond delay function
 //****************************************************************************
 void delay_ms(uint32_t ms){
-	uint32_t targetMicroSec = SYSTIMER_GetTime() + (ms*1000);
-	while(targetMicroSec > SYSTIMER_GetTime())
+	// Wrap safe deadline compare, so the delay also works across the timer wrap
+	uint32_t deadline = timing_deadline(SYSTIMER_GetTime(), ms);
+	while(!timing_reached(SYSTIMER_GetTime(), deadline))
 		__NOP(); // do nothing
 }
 
 //****************************************************************************
-// reset_status_led_to_relay_state - gets state of relay and sets relay led according
+// post_event - marks an event as pending and wakes the main loop (may be called from ISR context)
 //****************************************************************************
-void reset_status_led_to_relay_state(){
-	uint32_t state = DIGITAL_IO_GetInput(&IO_RELAY);
-	if(state == 0){
-		led_status_pattern = LED_OFF;
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
+void post_event(uint32_t event){
+	// Posting ISRs run in different priority tiers (irqprio.h), a higher one may interrupt the read-modify-write
+	critical_state_t primask = critical_enter();
+	main_state.pending_events |= event;
+	critical_exit(primask, CRITICAL_SITE_EVENTS);
+}
+
+//****************************************************************************
+// take_events - returns all pending events and clears them atomically
+//****************************************************************************
+uint32_t take_events(void){
+	uint32_t events;
+	critical_state_t primask = critical_enter();
+	events = main_state.pending_events;
+	main_state.pending_events = 0;
+	critical_exit(primask, CRITICAL_SITE_EVENTS);
+	return events;
+}
+
+//****************************************************************************
+// adc_handle_result - processes one valid ADC result (inlined into Adc_Measurement_Handler, so it runs from RAM too)
+//****************************************************************************
+__attribute__((always_inline)) static inline void adc_handle_result(uint32_t adc_register){
+#if SENSOR_CHANNEL_COUNT > 1
+	// Find the sensor channel of the result (all scanned channels share the global result register)
+	int8_t channel = sensor_channel_index((adc_register & VADC_GLOBRES_CHNR_Msk) >> VADC_GLOBRES_CHNR_Pos);
+	if(channel < 0){
+		sensor_invalid_count++;
+		return;
 	}
-	else{
-		led_status_pattern = LED_ON;
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
+#else
+	const int8_t channel = 0;
+#endif
+	BOOT_STAMP_ONCE(BOOT_STAGE_FIRST_ADC);
+	sensor_result_count++;
+	uint32_t sum = adc_register & sensor_result_mask; // 12 bit full scale in every profile (sensor_set_profile)
+	uint32_t value = sum / ADC_OVERSAMPLING; // Scale accumulated sum back to one conversion (shift for 2 and 4)
+#if ADC_BOUNDARY_EVENTS || RECORDER_ENABLED || RELAY_IN_ISR || RELAY_FAULT_ENABLED
+	uint32_t time = SYSTIMER_GetTime(); // One timestamp for the recorder and the threshold check (replayed alike)
+#endif
+#if STIMULUS_ENABLED
+	if(channel == STIMULUS_CHANNEL && stimulus.running){
+		value = stimulus_next(&stimulus); // Synthetic input instead of the conversion (test builds)
+		sum = value * ADC_OVERSAMPLING; // Enters the decimation like a result
+	}
+#endif
+#if FREQSENSOR_ENABLED
+	if(channel == FREQSENSOR_CHANNEL){
+		value = freqsensor_value(); // Captured frequency or duty instead of the conversion (sampled at the conversion rate)
+		sum = value * ADC_OVERSAMPLING;
+	}
+#endif
+#if I2CSENSOR_ENABLED
+	if(channel == I2CSENSOR_CHANNEL){
+		value = i2csensor_value(); // Latest reading of the I2C sensor instead of the conversion
+		sum = value * ADC_OVERSAMPLING;
 	}
+#endif
+#if RELAY_FAULT_ENABLED
+	// Open or shorted sensor line: safe state at once, before the sample reaches filter and relay
+	if(relay_check_fault(&relay_channels[channel], value, time)){
+		main_state.relay_faulted |= 1U << channel;
+		post_event(EVENT_SENSOR_FAULT);
+	}
+#endif
+	if(sensor_requests != 0)
+		sensor_complete_request((uint8_t)channel, (uint16_t)value); // Conversion requested on demand
+#if CAPTURE_ENABLED
+	if(channel == CAPTURE_CHANNEL)
+		capture_push((uint16_t)value); // Raw waveform, before filter and calibration
+#endif
+#if SPISTREAM_ENABLED
+	if(channel == SPISTREAM_CHANNEL)
+		spistream_push((uint16_t)value);
+#endif
+#if RECORDER_ENABLED
+	if(channel == RECORDER_CHANNEL)
+		recorder_push((uint16_t)value, time, &sensor_filter_state[channel], &relay_channels[channel]); // Raw, with the filter and relay state it meets
+#endif
+#if SENSOR_DECIMATION_BITS
+	// Only every 4^n-th conversion goes on, with n more bits (SENSOR_VALUE_MAX full scale from here on)
+	if(!sensor_decimate((uint8_t)channel, sum, &value))
+		return;
+#endif
+	value = sensor_filter((uint8_t)channel, (uint16_t)value);
+#if SENSOR_CALIBRATION
+	value = sensor_calibrate((uint8_t)channel, (uint16_t)value);
+#endif
+	relay_channels[channel].value = value;
+#if SENSOR_STATS || SENSOR_GOVERNOR
+	// One published set for the whole result (relay_publish)
+	const relay_thresholds_t *thresholds = relay_thresholds(&relay_channels[channel]);
+#endif
+#if SENSOR_STATS
+	sensor_stats_update((uint8_t)channel, (uint16_t)value, thresholds->upper_threshold, thresholds->lower_threshold);
+#endif
+#if SENSOR_GOVERNOR
+	sensor_govern((int32_t)value, thresholds->upper_threshold, thresholds->lower_threshold);
+#endif
+#if RELAY_IN_ISR
+	// Whole relay decision at the conversion rate, independent of the main loop (latency <= one conversion period)
+	BOOT_STAMP_ONCE(BOOT_STAGE_FIRST_RELAY);
+	PROFILER_START(relay_start);
+	if(relay_update(&relay_channels[channel], value, time, true)){
+		// Only this interrupt sets bits (the relay tier is not interrupted by another writer)
+		main_state.relay_switched |= 1U << channel;
+		post_event(EVENT_RELAY_SWITCHED);
+	}
+#if PROFILER_ENABLED
+	uint32_t relay_cycles = profiler_timestamp() - relay_start;
+	profiler_record(PROFILER_RELAY_ISR, relay_cycles);
+	if(relay_cycles > RELAY_ISR_BUDGET)
+		relay_isr_over_budget++;
+#endif
+#elif ADC_BOUNDARY_EVENTS
+	if(relay_check_thresholds(&relay_channels[channel], value, time)){
+		main_state.boundary_time = time;
+		post_event(EVENT_ADC_BOUNDARY);
+	}
+#else
+	sensor_push((uint8_t)channel, (uint16_t)value, SYSTIMER_GetTimeUs());
+	post_event(EVENT_ADC_RESULT);
+#endif
 }
 
+#if SENSOR_POLLED
 //****************************************************************************
-// manage_status_led - blink the status led according to the given pattern and (user interface)
+// adc_poll - handles the results waiting in the result register (SENSOR_POLLED: main loop instead of the ADC interrupt). Returns true if there was one
 //****************************************************************************
-void manage_status_led(){
-	static uint16_t led_pattern_state;
-	static uint32_t led_pattern_state_timestamp;
-	static uint16_t led_pattern_state_length;
+RAMCODE
+bool adc_poll(void){
+	// Reading GLOBRES clears the valid flag, an empty read changes nothing
+	uint32_t adc_register = SENSOR_RESULT_READ();
+	if(!(adc_register & VADC_GLOBRES_VF_Msk))
+		return false;
+	// Recorded as the interrupt, the latency from the trigger is the polling delay (includes the conversion)
+	PROFILER_ISR_ENTER(poll_entry, sensor_trigger_age());
+	// Masked like the critical tier of the interrupt, a timer callback must not meet a half done result
+	critical_state_t primask = critical_enter();
+	do{
+		adc_handle_result(adc_register);
+	}while(SENSOR_RESULT_FIFO && ((adc_register = SENSOR_RESULT_READ()) & VADC_GLOBRES_VF_Msk));
+	critical_exit(primask, CRITICAL_SITE_ADC_POLL);
+	PROFILER_ISR_EXIT(PROFILER_ISR_ADC, poll_entry);
+	return true;
+}
+#else
+//****************************************************************************
+// Adc_Measurement_Handler - ADC result interrupt (fast path: executed from RAM, direct register access)
+//****************************************************************************
+RAMCODE
+void Adc_Measurement_Handler()
+{
+	// Latency from the trigger includes the conversion (and with several channels the conversions before this one)
+	PROFILER_ISR_ENTER(isr_entry, sensor_trigger_age());
+	FUNCPROF_ENTER();
+#if SENSOR_RESULT_FIFO
+	// Drains the FIFO: results converted while the interrupt waited for a higher tier are handled in the same pass
+	uint32_t adc_register;
+	while((adc_register = SENSOR_RESULT_READ()) & VADC_GLOBRES_VF_Msk)
+		adc_handle_result(adc_register);
+#else
+	// Reading GLOBRES clears the valid flag (wait-for-read mode releases the next result)
+	uint32_t adc_register = SENSOR_RESULT_READ();
+
+	if(adc_register & VADC_GLOBRES_VF_Msk)
+		adc_handle_result(adc_register);
+	else
+		sensor_invalid_count++;
+#endif
 
-	static uint16_t fade_duty_step;
+	FUNCPROF_EXIT(FUNCPROF_ADC_HANDLER);
+	PROFILER_ISR_EXIT(PROFILER_ISR_ADC, isr_entry);
+}
+#endif
 
-	// Check target pattern an initiate
-	if(led_status_pattern != led_status_pattern_last){
-		switch (led_status_pattern){
-			case LED_OFF:
-				PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-				break;
-			case LED_ON:
-				PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-				break;
-			case LED_NUMBER:
-				if((led_number_continuous >= 1 && led_pattern_mode == LED_PATTERN_CONTINUOUS) || (led_number_single >= 1 && led_pattern_mode == LED_PATTERN_SINGLE)){
-					led_pattern_state_timestamp = SYSTIMER_GetTime();
-					led_pattern_state_length = LED_PULSE_SHORT;
-					PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-					led_pattern_state = 0;
-				}
-				break;
-			case LED_FADE_DOWN:
-				if(led_fadetime > 0){
-					led_pattern_state_timestamp = SYSTIMER_GetTime();
-					led_pattern_state_length = led_fadetime/led_fadesteps;
-					fade_duty_step = PWM_FULL_OFF/led_fadesteps;
-					PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-					led_pattern_state = 0;
-				}
-				break;
-			case LED_FADE_UP:
-				if(led_fadetime > 0){
-					led_pattern_state_timestamp = SYSTIMER_GetTime();
-					led_pattern_state_length = led_fadetime/led_fadesteps;
-					fade_duty_step = PWM_FULL_OFF/led_fadesteps;
-					PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-					led_pattern_state = 0;
-				}
-				break;
-			case LED_MATCH_RELAY_STATE:
-				reset_status_led_to_relay_state();
-				break;
-		}
-		led_status_pattern_last = led_status_pattern;
-	}
-
-	// Handle LED_NUMBER pattern
-	if(led_status_pattern == LED_NUMBER){
-		if((SYSTIMER_GetTime() - led_pattern_state_timestamp) / 1000 >= led_pattern_state_length){
-			// Next state
-			led_pattern_state++;
-
-			// Use right pulse number based on current pattern mode
-			uint16_t led_number;
-			if(led_pattern_mode == LED_PATTERN_CONTINUOUS)
-				led_number = led_number_continuous;
-			else
-				led_number = led_number_single;
-
-			// Check if LED must be powered on or off for this state
-			if(led_pattern_state % 2)
-				PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-			else
-				PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-
-			// Detect last low phase and make it longer
-			if(led_pattern_state == (led_number*2) && led_pattern_mode == LED_PATTERN_CONTINUOUS)
-				led_pattern_state_length = LED_PULSE_LONG;
-			else
-				led_pattern_state_length = LED_PULSE_SHORT;
-
-			// Store current time
-			led_pattern_state_timestamp = SYSTIMER_GetTime();
-
-			// Check if LED pattern is finished
-			if(led_pattern_state > led_number*2){
-				if(led_pattern_mode == LED_PATTERN_CONTINUOUS) // Repeat pattern
-					led_pattern_state = 1;
-				else if(led_pattern_mode == LED_PATTERN_SINGLE){ // Reset led and pattern mode
-					led_pattern_mode = LED_PATTERN_CONTINUOUS;
-					led_status_pattern = led_status_pattern_after_single;
-				}
-			}
-		}
-	}
+//****************************************************************************
+// wait_for_event - sleeps until an interrupt posts an event (returns immediately if one is already pending)
+//****************************************************************************
+void wait_for_event(void){
+#if SENSOR_POLLED
+	// Spins on the result register instead (a handled result can post an event itself)
+	while(main_state.pending_events == 0)
+		adc_poll();
+#else
+	// Interrupts are masked while checking, so an event posted right before WFI still wakes the core (pending IRQ ends WFI even with PRIMASK set)
+	__disable_irq();
+	if(main_state.pending_events == 0 && MAIN_LOOP_SLEEP)
+		power_idle();
+	__enable_irq();
+#endif
+}
 
-	// Handle LED_FADE_UP pattern
-	else if(led_status_pattern == LED_FADE_DOWN){
-		if((SYSTIMER_GetTime() - led_pattern_state_timestamp) / 1000 >= led_pattern_state_length){
-			// Set intensity of led to a level based on maximum value and current step
-			PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, (led_pattern_state*fade_duty_step) + PWM_FULL_ON);
+//****************************************************************************
+// wakeup_callback - called by the scheduler (SysTick ISR context) whenever a task got due
+//****************************************************************************
+void wakeup_callback(void){
+	post_event(EVENT_TICK);
+}
 
-			// Store current time
-			led_pattern_state_timestamp = SYSTIMER_GetTime();
+//****************************************************************************
+// timer_callback - called by SYSTIMER (SysTick ISR context) whenever a deferred timer expired
+//****************************************************************************
+void timer_callback(void *args){
+	(void)args;
+	post_event(EVENT_TIMER);
+}
 
-			// Next state
-			led_pattern_state++;
+//****************************************************************************
+// alarm_callback - called by the wall clock when its alarm went off (SCU interrupt context)
+//****************************************************************************
+void alarm_callback(void){
+	post_event(EVENT_ALARM);
+}
 
-			// Make last state longer
-			if(led_pattern_state == led_fadesteps-1)
-				led_pattern_state_length = led_pattern_state_length + 400;
+//****************************************************************************
+// host_timed_wakeup - called when the delay of a HOSTCMD_AT command has passed (hrtimer interrupt context)
+//****************************************************************************
+void host_timed_wakeup(void){
+	post_event(EVENT_HOST_TIMED);
+}
 
-			// Check if LED pattern is finished
-			if(led_pattern_state >= led_fadesteps){
-				if(led_pattern_mode == LED_PATTERN_CONTINUOUS){ // Repeat pattern
-					led_pattern_state_length = led_pattern_state_length - 400;
-					led_pattern_state = 0;
-				}
-				else if(led_pattern_mode == LED_PATTERN_SINGLE){ // Reset led and pattern mode
-					led_pattern_mode = LED_PATTERN_CONTINUOUS;
-					led_status_pattern = led_status_pattern_after_single;
-				}
-			}
-		}
-	}
+//****************************************************************************
+// evbus_callback - called by the event bus for every posted event (any context)
+//****************************************************************************
+void evbus_callback(void){
+	post_event(EVENT_BUS);
+}
 
-	// Handle LED_FADE_DOWN pattern
-	else if(led_status_pattern == LED_FADE_UP){
-		if((SYSTIMER_GetTime() - led_pattern_state_timestamp) / 1000 >= led_pattern_state_length){
-			// Set intensity of led to a level based on maximum value and current step
-			PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF - (led_pattern_state*fade_duty_step) );
+//****************************************************************************
+// button_callback - called by the button interrupts whenever an edge got recorded (ISR context)
+//****************************************************************************
+void button_callback(void){
+	// Interpret the edge right away instead of waiting for the next UI period
+	scheduler_trigger(main_state.ui_task_id);
+}
 
-			// Store current time
-			led_pattern_state_timestamp = SYSTIMER_GetTime();
+//****************************************************************************
+// comparator_callback - called by the comparator interrupt after it started the latch time of a crossing (ISR context)
+//****************************************************************************
+void comparator_callback(void){
+	post_event(EVENT_ADC_BOUNDARY);
+}
 
-			// Next state
-			led_pattern_state++;
+//****************************************************************************
+// relay_led_pattern - returns the status led pattern matching the state of the relay
+//****************************************************************************
+const uint8_t *relay_led_pattern(void){
+	// The channel state is what relay_update drove the output to, no need to read the pin back
+	if(setup_channel->fault != RELAY_FAULT_NONE)
+		return led_pattern_fault;
+	if(setup_channel->state == RELAY_HIGH)
+		return led_pattern_on;
+	return led_pattern_off;
+}
 
-			// Make last state longer
-			if(led_pattern_state == led_fadesteps-1)
-				led_pattern_state_length = led_pattern_state_length + 400;
+//****************************************************************************
+// reset_status_led_to_relay_state - gets state of relay and sets relay led according (ends all other patterns)
+//****************************************************************************
+void reset_status_led_to_relay_state(){
+	ledpattern_play(relay_led_pattern(), 0);
+}
 
-			// Check if LED pattern is finished
-			if(led_pattern_state >= led_fadesteps){
-				if(led_pattern_mode == LED_PATTERN_CONTINUOUS){ // Repeat pattern
-					led_pattern_state_length = led_pattern_state_length - 400;
-					led_pattern_state = 0;
-				}
-				else if(led_pattern_mode == LED_PATTERN_SINGLE){ // Reset led and pattern mode
-					led_pattern_mode = LED_PATTERN_CONTINUOUS;
-					led_status_pattern = led_status_pattern_after_single;
-				}
-			}
-		}
-	}
+//****************************************************************************
+// load_profile - makes a threshold profile the working copy of the setup channel (no flash access)
+//****************************************************************************
+void load_profile(uint8_t profile){
+	const settings_profile_t *values = &threshold_profiles[profile];
+
+	// The ADC interrupt sees either the old or the new profile (e.g. never a new upper with the old lower threshold)
+	critical_state_t primask = critical_enter();
+	setup_channel->upper_threshold = values->upper_threshold;
+	setup_channel->lower_threshold = values->lower_threshold;
+	setup_channel->latchtime = values->latchtime;
+	critical_exit(primask, CRITICAL_SITE_SETTINGS);
+	main_state.profile = profile;
 }
 
 //****************************************************************************
-// read_eeprom_setup -
+// read_eeprom_setup - restores setup from EEPROM. Invalid values are replaced by defaults and indicated by a (non-blocking) LED pattern
 //****************************************************************************
 void read_eeprom_setup(void){
-	uint8_t ReadBuffer_LTH[4];
-	uint8_t ReadBuffer_UTH[4];
-	uint8_t ReadBuffer_LT[4];
-	uint8_t ReadBuffer_USB[4];
-
-	// Read from EEPROM and interpret value
-	E_EEPROM_XMC1_Read(EEPROM_LOWER_TH, 0, ReadBuffer_LTH, 4U);
-	E_EEPROM_XMC1_Read(EEPROM_UPPER_TH, 0U, ReadBuffer_UTH, 4U);
-	E_EEPROM_XMC1_Read(EEPROM_LATCHTIME, 0U, ReadBuffer_LT, 4U);
-	E_EEPROM_XMC1_Read(EEPROM_USB_STATE, 0U, ReadBuffer_USB, 4U);
-	eeprom_lower = ReadBuffer_LTH[0] + (ReadBuffer_LTH[1] << 8) + (ReadBuffer_LTH[2] << 16) + (ReadBuffer_LTH[3] << 24);
-	eeprom_upper = ReadBuffer_UTH[0] + (ReadBuffer_UTH[1] << 8) + (ReadBuffer_UTH[2] << 16) + (ReadBuffer_UTH[3] << 24);
-	eeprom_latchtime = ReadBuffer_LT[0] + (ReadBuffer_LT[1] << 8) + (ReadBuffer_LT[2] << 16) + (ReadBuffer_LT[3] << 24);
-	eeprom_usb_state = ReadBuffer_USB[0] + (ReadBuffer_USB[1] << 8) + (ReadBuffer_USB[2] << 16) + (ReadBuffer_USB[3] << 24);
+	/// Defaults of this unit: the factory calibration (factory.h) or the compiled in values where it has none or an invalid one
+	const factory_block_t *factory = factory_block();
+	uint32_t upper_default = ADC_TH_UPPER_DEFAULT;
+	uint32_t lower_default = ADC_TH_LOWER_DEFAULT;
+	uint32_t latchtime_default = RELAY_LATCHTIME_DEFAULT;
+	if(factory != NULL && factory->upper_threshold <= ADC_THRESHOLD_MAX && factory->lower_threshold <= factory->upper_threshold
+			&& factory->latchtime <= RELAY_LATCHTIME_MAX){
+		upper_default = factory->upper_threshold;
+		lower_default = factory->lower_threshold;
+		latchtime_default = factory->latchtime;
+	}
+
+	/// Read the settings record (one block, checked by version and CRC)
+	uint8_t error_count = 0;
+	if(!settings_read(&eeprom_settings)){
+		// No valid record: all values fall back to their defaults (indicated like one invalid value)
+		eeprom_settings.upper_threshold = upper_default;
+		eeprom_settings.lower_threshold = lower_default;
+		eeprom_settings.latchtime = latchtime_default;
+		eeprom_settings.usb_state = USB_1_active;
+		eeprom_settings.sample_time = 0;
+		eeprom_settings.profile = 0;
+		error_count++;
+	}
 
 	/// Check if values make sense, else return to default
 	// Restore upper threshold from EEPROM or blink on error
-	if(eeprom_upper < 0 || eeprom_upper > ADC_THRESHOLD_MAX){
-		ADC_upper_threshold = ADC_TH_UPPER_DEFAULT;
-		// Blink LED for error indication
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-		delay_ms(150);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-		delay_ms(200);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-		delay_ms(150);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-		delay_ms(500);
+	if(eeprom_settings.upper_threshold > ADC_THRESHOLD_MAX){
+		setup_channel->upper_threshold = upper_default;
+		error_count++;
 	}
 	else{
-		ADC_upper_threshold = eeprom_upper;
+		setup_channel->upper_threshold = eeprom_settings.upper_threshold;
 	}
 	// Restore lower threshold from EEPROM or blink on error
-	if(eeprom_lower < 0 || eeprom_lower > ADC_THRESHOLD_MAX){
-		ADC_lower_threshold = ADC_TH_LOWER_DEFAULT;
-		// Blink LED for error indication
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-		delay_ms(150);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-		delay_ms(200);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-		delay_ms(150);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-		delay_ms(500);
+	if(eeprom_settings.lower_threshold > ADC_THRESHOLD_MAX){
+		setup_channel->lower_threshold = lower_default;
+		error_count++;
 	}
 	else{
-		ADC_lower_threshold = eeprom_lower;
+		setup_channel->lower_threshold = eeprom_settings.lower_threshold;
 	}
 	// Restore latchtime from EEPROM or blink on error
-	if(eeprom_latchtime < 0 || eeprom_latchtime > ADC_THRESHOLD_MAX){
-		relay_threshold_latchtime = RELAY_LATCHTIME_DEFAULT;
-		// Blink LED for error indication
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-		delay_ms(150);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-		delay_ms(200);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_ON);
-		delay_ms(150);
-		PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
+	if(eeprom_settings.latchtime > RELAY_LATCHTIME_MAX){
+		setup_channel->latchtime = latchtime_default;
+		error_count++;
 	}
 	else{
-		relay_threshold_latchtime = eeprom_latchtime;
+		setup_channel->latchtime = eeprom_settings.latchtime;
 	}
+	// Restore the threshold profiles: profile 0 is the setup restored above, missing or invalid profiles start as a copy of it
+	settings_profiles_t profiles;
+	bool profiles_valid = settings_read_profiles(&profiles);
+	threshold_profiles[0].upper_threshold = (uint16_t)setup_channel->upper_threshold;
+	threshold_profiles[0].lower_threshold = (uint16_t)setup_channel->lower_threshold;
+	threshold_profiles[0].latchtime = (uint16_t)setup_channel->latchtime;
+	for(uint8_t profile = 1; profile < SETTINGS_PROFILE_COUNT; profile++){
+		const settings_profile_t *stored = &profiles.profiles[profile - 1U];
+		if(profiles_valid && stored->upper_threshold <= ADC_THRESHOLD_MAX && stored->lower_threshold <= ADC_THRESHOLD_MAX
+				&& stored->latchtime <= RELAY_LATCHTIME_MAX)
+			threshold_profiles[profile] = *stored;
+		else
+			threshold_profiles[profile] = threshold_profiles[0];
+	}
+	// Restore the host bus address (units without a stored one keep HOSTBUS_ADDRESS_DEFAULT)
+	if(profiles_valid && profiles.bus_address != 0 && !hostbus_set_address(profiles.bus_address))
+		error_count++;
+	if(eeprom_settings.profile >= SETTINGS_PROFILE_COUNT)
+		error_count++;
+	else
+		load_profile(eeprom_settings.profile);
+	// Restore the calibrated sample time (records without one keep the sample times of the profiles)
+	if(eeprom_settings.sample_time > SENSOR_SAMPLE_TIME_MAX + 1U)
+		error_count++;
+	else if(eeprom_settings.sample_time != 0)
+		sensor_set_sample_time(eeprom_settings.sample_time - 1U);
 	// Restore USB state from EEPROM or reset to USB1 on error
-	if(eeprom_usb_state < 0 || eeprom_usb_state > USB_inactive)
-		USB_state = USB_1_active;
+	uint32_t usb_state = eeprom_settings.usb_state;
+#if USB_STORE_STATE_LOG
+	// The newest USB state is in the state log (the setup record only holds a fallback, usb_state is kept if the log is empty)
+	if(USB_STORE_STATE_EEPROM)
+		statelog_init(&usb_state);
+#endif
+	if(usb_state > USB_inactive)
+		main_state.usb_state = USB_1_active;
 	else
-		USB_state = (USB_states)eeprom_usb_state;
+		main_state.usb_state = (USB_states)usb_state;
 
-	//     --    Use this to write a value to e_eeprom for debug purpose   --
-	//int32_t temp = 100001;
-	//EEPROM_WriteBuffer[0] = (uint8_t)temp;
-	//EEPROM_WriteBuffer[1] = (uint8_t)(temp >> 8);
-	//EEPROM_WriteBuffer[2] = (uint8_t)(temp >> 16);
-	//EEPROM_WriteBuffer[3] = (uint8_t)(temp >> 24);
-	//E_EEPROM_XMC1_Write(EEPROM_LOWER_TH, EEPROM_WriteBuffer);
-	//
-	//temp = 100002;
-	//EEPROM_WriteBuffer[0] = (uint8_t)temp;
-	//EEPROM_WriteBuffer[1] = (uint8_t)(temp >> 8);
-	//EEPROM_WriteBuffer[2] = (uint8_t)(temp >> 16);
-	//EEPROM_WriteBuffer[3] = (uint8_t)(temp >> 24);
-	//E_EEPROM_XMC1_Write(EEPROM_UPPER_TH, EEPROM_WriteBuffer);
-	//
-	//temp = 100002;
-	//EEPROM_WriteBuffer[0] = (uint8_t)temp;
-	//EEPROM_WriteBuffer[1] = (uint8_t)(temp >> 8);
-	//EEPROM_WriteBuffer[2] = (uint8_t)(temp >> 16);
-	//EEPROM_WriteBuffer[3] = (uint8_t)(temp >> 24);
-	//E_EEPROM_XMC1_Write(EEPROM_LATCHTIME, EEPROM_WriteBuffer);
+	// Queue error indication (2 blinks per invalid value), it is played by the status LED task while the relay is already controlled
+	if(error_count > 0){
+		ledpattern_play(led_pattern_off, 0); // Relays are off after relay_init
+		ledpattern_push(led_pattern_number_single, error_count * 2);
+	}
 }
 
 //****************************************************************************
-// write_eeprom - writes up to 4 byte to a given EEPROM block
+// write_eeprom_setup - queues the complete setup (thresholds, latch time, USB state) as one record (written by storage_flush when the main loop is idle)
 //****************************************************************************
-void write_eeprom(uint8_t block_number, int32_t value, uint8_t size){
-	uint8_t EEPROM_WriteBuffer[4];
+void write_eeprom_setup(void){
+	settings_record_t record;
+	settings_profiles_t profiles;
+
+	if(SETUP_ROLLBACK && main_state.rollback != 0){
+		// A rollback is only applied in RAM until commit_rollback: the stored record is written again with the other changes
+		if(!settings_read(&record))
+			return;
+	}
+	else{
+		// The setup channel holds the active profile, profile 0 goes to the setup record and the others to EEPROM_PROFILES
+		threshold_profiles[main_state.profile].upper_threshold = (uint16_t)setup_channel->upper_threshold;
+		threshold_profiles[main_state.profile].lower_threshold = (uint16_t)setup_channel->lower_threshold;
+		threshold_profiles[main_state.profile].latchtime = (uint16_t)setup_channel->latchtime;
+		record.upper_threshold = threshold_profiles[0].upper_threshold;
+		record.lower_threshold = threshold_profiles[0].lower_threshold;
+		record.latchtime = threshold_profiles[0].latchtime;
+		record.profile = main_state.profile;
+		record.sample_time = (sensor_get_sample_time() != SENSOR_SAMPLE_TIME_NONE) ? sensor_get_sample_time() + 1U : 0U;
+	}
+	record.usb_state = (USB_STORE_STATE_EEPROM && !USB_STORE_STATE_LOG) ? main_state.usb_state : eeprom_settings.usb_state; // Keep the stored state if the USB state is not stored or kept in the state log (an unchanged record is not written again)
+	settings_write(&record);
+	// Unchanged profiles are elided by the storage queue (a profile switch only writes the setup record)
+	for(uint8_t profile = 1; profile < SETTINGS_PROFILE_COUNT; profile++)
+		profiles.profiles[profile - 1U] = threshold_profiles[profile];
+	profiles.bus_address = HOSTBUS_ENABLED ? hostbus_address : 0U;
+	settings_write_profiles(&profiles);
+}
 
-	EEPROM_WriteBuffer[0] = (uint8_t)value;
-	for(int i = 1; i < size; i++){
-		EEPROM_WriteBuffer[i] = (uint8_t)(value >> (i*8));
+//****************************************************************************
+// commit_rollback - stores the settings record applied by rollback_settings as the new one (long press of the USB button, HOSTCMD_COMMIT)
+//****************************************************************************
+void commit_rollback(void){
+	main_state.rollback = 0;
+	write_eeprom_setup();
+}
+
+//****************************************************************************
+// apply_settings_record - applies a settings record in RAM (1 = the one before the stored, 0 = the stored one). Returns false if the record is not kept or invalid
+//****************************************************************************
+bool apply_settings_record(uint8_t step){
+	settings_record_t record;
+	if(step == 0){
+		if(!settings_read(&record))
+			return false;
 	}
-	E_EEPROM_XMC1_Write(block_number, EEPROM_WriteBuffer);
+	else if(!settings_read_previous(&record, step - 1U))
+		return false;
+	if(record.upper_threshold > ADC_THRESHOLD_MAX || record.lower_threshold > ADC_THRESHOLD_MAX || record.latchtime > RELAY_LATCHTIME_MAX
+			|| record.profile >= SETTINGS_PROFILE_COUNT || record.sample_time > SENSOR_SAMPLE_TIME_MAX + 1U)
+		return false;
+
+	// Nothing is written: the record is the working copy until commit_rollback stores it or step 0 brings the stored one back
+	TRACE(TRACE_ROLLBACK, step, main_state.rollback);
+	threshold_profiles[0].upper_threshold = record.upper_threshold;
+	threshold_profiles[0].lower_threshold = record.lower_threshold;
+	threshold_profiles[0].latchtime = record.latchtime;
+	load_profile(record.profile);
+	if(record.sample_time != 0)
+		sensor_set_sample_time(record.sample_time - 1U);
+	main_state.rollback = step;
+	return true;
+}
 
-	//EEPROM_WriteBuffer[1] = (uint8_t)(value >> 8);
-	//EEPROM_WriteBuffer[2] = (uint8_t)(value >> 16);
-	//EEPROM_WriteBuffer[3] = (uint8_t)(value >> 24);
+//****************************************************************************
+// drop_rollback - brings the stored settings record back before a change that is stored with the setup (profile switch, setup menu, calibration)
+//****************************************************************************
+void drop_rollback(void){
+	// Without a readable stored record the applied one is all there is, it is stored by the change
+	if(SETUP_ROLLBACK && main_state.rollback != 0 && !apply_settings_record(0))
+		main_state.rollback = 0;
 }
 
 //****************************************************************************
-// manage_buttons - function to manage, debounce and interpret button presses
+// select_profile - switches the setup channel to a stored threshold profile and stores the index (chord, host command and schedule). Returns false while the setup menu is open
 //****************************************************************************
-void manage_buttons(void)
-{
-	/// Detect start of press and save current system time
-	if(button_usb_pressed_timestamp == 0 && DIGITAL_IO_GetInput(&IO_SW_USB) == SW_ON)
-		button_usb_pressed_timestamp = SYSTIMER_GetTime();
-	if(button_up_pressed_timestamp == 0 && DIGITAL_IO_GetInput(&IO_SW_UP) == SW_ON)
-		button_up_pressed_timestamp = SYSTIMER_GetTime();
-	if(button_down_pressed_timestamp == 0 && DIGITAL_IO_GetInput(&IO_SW_DOWN) == SW_ON)
-		button_down_pressed_timestamp = SYSTIMER_GetTime();
-
-	// USB BUTTON: If a press in ongoing and release is detected, calculate time difference
-	if(button_usb_pressed_timestamp != 0 && DIGITAL_IO_GetInput(&IO_SW_USB) == SW_OFF){
-		button_usb_pressed_duration = (SYSTIMER_GetTime() - button_usb_pressed_timestamp) / 1000; // convert us to ms
-		button_usb_pressed_timestamp = 0;
-		// Interpret button press and activate "button pressed" marker
-		if(button_usb_pressed_duration >= BTN_LONGEST_PRESS_DURATION)
-			buttonpress_usb = BTNPRESS_NOT; // In this case the press is already handled
-		else if(button_usb_pressed_duration >= BTN_LONG_PRESS_DURATION)
-			buttonpress_usb = BTNPRESS_LONG;
-		else if(button_usb_pressed_duration >= BTN_STD_PRESS_DURATION)
-			buttonpress_usb = BTNPRESS_STD;
-	}
-	// USB BUTTON: If press is to long reset (simulate that press ended)
-	else if(button_usb_pressed_timestamp != 0 && button_usb_pressed_timestamp != TIMESTAMP_DEACTIVATED && ((SYSTIMER_GetTime() - button_usb_pressed_timestamp) / 1000) > BTN_LONGEST_PRESS_DURATION){
-		button_usb_pressed_timestamp = TIMESTAMP_DEACTIVATED; // deactivate timestamp till button is released
-		buttonpress_usb = BTNPRESS_LONGEST;
-	}
-
-	// UP BUTTON: If a press in ongoing and release is detected, calculate time difference
-	if(button_up_pressed_timestamp != 0 && DIGITAL_IO_GetInput(&IO_SW_UP) == SW_OFF){
-		button_up_pressed_duration = (SYSTIMER_GetTime() - button_up_pressed_timestamp) / 1000; // convert us to ms
-		button_up_pressed_timestamp = 0;
-		// Interpret button press and activate "button pressed" marker
-		if(button_up_pressed_duration >= BTN_LONGEST_PRESS_DURATION)
-			buttonpress_up = BTNPRESS_NOT; // In this case the press is already handled
-		else if(button_up_pressed_duration >= BTN_LONG_PRESS_DURATION)
-			buttonpress_up = BTNPRESS_LONG;
-		else if(button_up_pressed_duration >= BTN_STD_PRESS_DURATION)
-			buttonpress_up = BTNPRESS_STD;
-
-	}
-	// UP BUTTON: If press is to long reset (simulate that press ended)
-	else if(button_up_pressed_timestamp != 0 && button_up_pressed_timestamp != TIMESTAMP_DEACTIVATED && ((SYSTIMER_GetTime() - button_up_pressed_timestamp) / 1000) > BTN_LONGEST_PRESS_DURATION){
-		button_up_pressed_timestamp = TIMESTAMP_DEACTIVATED;
-		buttonpress_up = BTNPRESS_LONGEST;
-	}
-
-	// DOWN BUTTON: If a press in ongoing and release is detected, calculate time difference
-	if(button_down_pressed_timestamp != 0 && DIGITAL_IO_GetInput(&IO_SW_DOWN) == SW_OFF){
-		button_down_pressed_duration = (SYSTIMER_GetTime() - button_down_pressed_timestamp) / 1000; // convert us to ms
-		button_down_pressed_timestamp = 0;
-		// Interpret button press and activate "button pressed" marker. The code that is reacting to it must reset it afterwards!
-		if(button_down_pressed_duration >= BTN_LONGEST_PRESS_DURATION)
-			buttonpress_down = BTNPRESS_NOT; // In this case the press is already handled
-		else if(button_down_pressed_duration >= BTN_LONG_PRESS_DURATION)
-			buttonpress_down = BTNPRESS_LONG;
-		else if(button_down_pressed_duration >= BTN_STD_PRESS_DURATION)
-			buttonpress_down = BTNPRESS_STD;
-	}
-	// DOWN BUTTON: If press is to long reset (simulate that press ended)
-	else if(button_down_pressed_timestamp != 0 && button_down_pressed_timestamp != TIMESTAMP_DEACTIVATED && ((SYSTIMER_GetTime() - button_down_pressed_timestamp) / 1000) > BTN_LONGEST_PRESS_DURATION){
-		button_down_pressed_timestamp = TIMESTAMP_DEACTIVATED;
-		buttonpress_down = BTNPRESS_LONGEST;
-	}
-}
-
-//****************************************************************************
-// switchUSB -
-//****************************************************************************
-int switchUSB(USB_states state)
-{
-	if(state == USB_1_active){
-		DIGITAL_IO_SetOutputLow(&IO_USBPWR_2);
-		DIGITAL_IO_SetOutputLow(&IO_USB_SI);
-		DIGITAL_IO_SetOutputLow(&IO_LED_USB1);
-		DIGITAL_IO_SetOutputHigh(&IO_LED_USB2);
-		DIGITAL_IO_SetOutputHigh(&IO_USBPWR_1);
+bool select_profile(uint8_t profile){
+	if(main_state.setup_state != SETUP_IDLE)
+		return false;
+	drop_rollback();
+	if(profile != main_state.profile){
+		TRACE(TRACE_PROFILE, profile, main_state.profile);
+		// Applied changes of the old profile that were not committed are dropped
+		load_profile(profile);
+		write_eeprom_setup();
+	}
+	return true;
+}
+
+//****************************************************************************
+// rollback_settings - applies a settings record in RAM (see apply_settings_record). Returns false without SETUP_ROLLBACK, while the setup menu is open or if the record is not kept or invalid
+//****************************************************************************
+bool rollback_settings(uint8_t step){
+	if(!SETUP_ROLLBACK || main_state.setup_state != SETUP_IDLE)
+		return false;
+	return apply_settings_record(step);
+}
+
+//****************************************************************************
+// sample_time_calibrated - stores the sample time found by the calibration with the setup (sensor_check_health or host)
+//****************************************************************************
+void sample_time_calibrated(uint8_t sample_time){
+	// The calibration replaces the sample time of an applied rollback, the rest of the stored record comes back
+	drop_rollback();
+	sensor_set_sample_time(sample_time);
+	write_eeprom_setup();
+}
+
+//****************************************************************************
+// host_read_done - records the result of a conversion read by the host (ADC interrupt context, sensor_request_conversion)
+//****************************************************************************
+RAMCODE
+void host_read_done(uint8_t channel, uint16_t value){
+	host_read_value = value;
+	TRACE(TRACE_ADC_READ, channel, value); // Sent to the host as event record
+}
+
+//****************************************************************************
+// usb_indicators_update - dims the indicator of the active port to usb_led_level (softpwm), the others are off
+//****************************************************************************
+void usb_indicators_update(void){
+	for(uint8_t i = 0; i < USB_PORT_COUNT; i++)
+		softpwm_set(i, (i == main_state.usb_state) ? main_state.usb_led_level : 0U);
+}
+
+//****************************************************************************
+// host_setting_get - reads a setting for the host command protocol (false = unknown id)
+//****************************************************************************
+bool host_setting_get(uint8_t id, uint32_t *value){
+	switch(id){
+		case HOSTCMD_SETTING_UPPER_THRESHOLD:
+			*value = (uint32_t)setup_channel->upper_threshold;
+			return true;
+		case HOSTCMD_SETTING_LOWER_THRESHOLD:
+			*value = (uint32_t)setup_channel->lower_threshold;
+			return true;
+		case HOSTCMD_SETTING_LATCHTIME:
+			*value = (uint32_t)setup_channel->latchtime;
+			return true;
+		case HOSTCMD_SETTING_SAMPLE_PERIOD:
+			*value = telemetry_sample_period;
+			return true;
+		case HOSTCMD_SETTING_CAPTURE_MODE:
+			*value = capture_get_mode();
+			return true;
+		case HOSTCMD_SETTING_WALLCLOCK:
+			*value = wallclock_get();
+			return true;
+		case HOSTCMD_SETTING_USB_ALARM:
+			*value = wallclock_get_alarm();
+			return true;
+		case HOSTCMD_SETTING_USB_PORT:
+			*value = main_state.usb_state;
+			return true;
+		case HOSTCMD_SETTING_USB_FAILOVER:
+			*value = failover_active;
+			return true;
+		case HOSTCMD_SETTING_PREDICT_RATE:
+			*value = (uint32_t)setup_channel->predict_rate;
+			return true;
+		case HOSTCMD_SETTING_MIN_HIGH_TIME:
+			*value = setup_channel->min_high_time;
+			return true;
+		case HOSTCMD_SETTING_MIN_LOW_TIME:
+			*value = setup_channel->min_low_time;
+			return true;
+		case HOSTCMD_SETTING_SWITCH_RATE_MAX:
+			*value = setup_channel->switch_rate_max;
+			return true;
+		case HOSTCMD_SETTING_RELAY_CYCLES:
+			*value = relaylife_get_cycles();
+			return true;
+		case HOSTCMD_SETTING_COIL_PULLIN_TIME:
+			*value = coil_pullin_time;
+			return true;
+		case HOSTCMD_SETTING_COIL_HOLD_DUTY:
+			*value = coil_hold_duty;
+			return true;
+		case HOSTCMD_SETTING_BISTABLE_PULSE_TIME:
+			*value = bistable_pulse_time;
+			return true;
+		case HOSTCMD_SETTING_BUS_ADDRESS:
+			*value = hostbus_address;
+			return true;
+		case HOSTCMD_SETTING_ADC_PROFILE:
+			*value = sensor_get_profile();
+			return true;
+		case HOSTCMD_SETTING_ADC_READ:
+			*value = host_read_value;
+			return true;
+		case HOSTCMD_SETTING_ADC_SAMPLE_TIME:
+			*value = sensor_get_sample_time();
+			return true;
+		case HOSTCMD_SETTING_ADC_SAMPLE_CAL:
+			*value = sensor_sample_time_calibrating();
+			return true;
+		case HOSTCMD_SETTING_FAULT_SAFE_STATE:
+			*value = setup_channel->safe_state;
+			return true;
+		case HOSTCMD_SETTING_RELAY_OPERATE_TIME:
+			*value = relaytime_lead(true);
+			return true;
+		case HOSTCMD_SETTING_RELAY_RELEASE_TIME:
+			*value = relaytime_lead(false);
+			return true;
+		case HOSTCMD_SETTING_PROFILE:
+			*value = main_state.profile;
+			return true;
+		case HOSTCMD_SETTING_PROFILE_DAY_START:
+			*value = main_state.profile_day_start;
+			return true;
+		case HOSTCMD_SETTING_PROFILE_NIGHT_START:
+			*value = main_state.profile_night_start;
+			return true;
+		case HOSTCMD_SETTING_LATCH_AREA:
+			*value = setup_channel->latch_area;
+			return true;
+		case HOSTCMD_SETTING_AREA_LEAK:
+			*value = setup_channel->area_leak;
+			return true;
+		case HOSTCMD_SETTING_LATCH_ADAPT_RATE:
+			*value = setup_channel->adapt_rate;
+			return true;
+		case HOSTCMD_SETTING_LATCH_ADAPT_MIN:
+			*value = setup_channel->adapt_min;
+			return true;
+		case HOSTCMD_SETTING_LATCH_ADAPTED:
+			*value = relay_latchtime(setup_channel);
+			return true;
+		case HOSTCMD_SETTING_ENERGY_CURRENT:
+			*value = energy_get_current();
+			return true;
+		case HOSTCMD_SETTING_USB_LED_LEVEL:
+			*value = main_state.usb_led_level;
+			return true;
+		case HOSTCMD_SETTING_GOVERNOR_MARGIN:
+			*value = sensor_governor_margin;
+			return true;
+		case HOSTCMD_SETTING_ROLLBACK:
+			*value = main_state.rollback;
+			return true;
+		default:
+			return false;
+	}
+}
+
+//****************************************************************************
+// host_setting_check - returns the hostcmd_status of setting a value (same limits as the setup menu)
+//****************************************************************************
+uint8_t host_setting_check(uint8_t id, uint32_t value){
+	uint32_t max;
+	switch(id){
+		case HOSTCMD_SETTING_UPPER_THRESHOLD:
+		case HOSTCMD_SETTING_LOWER_THRESHOLD:
+			max = ADC_THRESHOLD_MAX;
+			break;
+		case HOSTCMD_SETTING_LATCHTIME:
+			max = RELAY_LATCHTIME_MAX;
+			break;
+		case HOSTCMD_SETTING_SAMPLE_PERIOD:
+			max = UINT16_MAX;
+			break;
+		case HOSTCMD_SETTING_CAPTURE_MODE:
+			max = CAPTURE_MODE_COUNT - 1U;
+			break;
+		case HOSTCMD_SETTING_WALLCLOCK:
+			max = UINT32_MAX;
+			break;
+		case HOSTCMD_SETTING_USB_ALARM:{
+			// An alarm needs a set clock and a time in the future
+			uint32_t now = wallclock_get();
+			return (value == 0 || (now != 0 && value > now)) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_OUT_OF_RANGE;
+		}
+		case HOSTCMD_SETTING_USB_PORT:
+			max = USB_inactive;
+			break;
+		case HOSTCMD_SETTING_USB_FAILOVER:
+			max = FAILOVER_ENABLED;
+			break;
+		case HOSTCMD_SETTING_PREDICT_RATE:
+			max = RELAY_PREDICT_ENABLED ? ADC_THRESHOLD_MAX : 0U;
+			break;
+		case HOSTCMD_SETTING_MIN_HIGH_TIME:
+		case HOSTCMD_SETTING_MIN_LOW_TIME:
+			max = RELAY_LIMIT_ENABLED ? UINT16_MAX : 0U;
+			break;
+		case HOSTCMD_SETTING_SWITCH_RATE_MAX:
+			max = RELAY_LIMIT_ENABLED ? UINT8_MAX : 0U;
+			break;
+		case HOSTCMD_SETTING_RELAY_CYCLES:
+			max = UINT32_MAX;
+			break;
+		case HOSTCMD_SETTING_COIL_PULLIN_TIME:
+			return (COIL_ENABLED && value >= 1U && value <= COIL_PULLIN_MAX) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_OUT_OF_RANGE;
+		case HOSTCMD_SETTING_COIL_HOLD_DUTY:
+			return (COIL_ENABLED && value >= 1U && value <= 100U) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_OUT_OF_RANGE;
+		case HOSTCMD_SETTING_BISTABLE_PULSE_TIME:
+			return (BISTABLE_ENABLED && value >= 1U && value <= BISTABLE_PULSE_MAX) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_OUT_OF_RANGE;
+		case HOSTCMD_SETTING_BUS_ADDRESS:
+			return (HOSTBUS_ENABLED && value != HOSTBUS_BROADCAST && value <= HOSTBUS_ADDRESS_MAX) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_OUT_OF_RANGE;
+		case HOSTCMD_SETTING_ADC_PROFILE:
+			max = SENSOR_PROFILE_COUNT - 1U;
+			break;
+		case HOSTCMD_SETTING_ADC_READ:
+			max = SENSOR_CHANNEL_COUNT - 1U;
+			break;
+		case HOSTCMD_SETTING_ADC_SAMPLE_TIME:
+			return (value <= SENSOR_SAMPLE_TIME_MAX || value == SENSOR_SAMPLE_TIME_NONE) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_OUT_OF_RANGE;
+		case HOSTCMD_SETTING_ADC_SAMPLE_CAL:
+			max = ADC_THRESHOLD_MAX;
+			break;
+		case HOSTCMD_SETTING_FAULT_SAFE_STATE:
+			max = RELAY_FAULT_ENABLED ? RELAY_LOW : 0U;
+			break;
+		case HOSTCMD_SETTING_RELAY_OPERATE_TIME:
+		case HOSTCMD_SETTING_RELAY_RELEASE_TIME:
+			max = 0U;
+			break;
+		case HOSTCMD_SETTING_PROFILE:
+			max = SETTINGS_PROFILE_COUNT - 1U;
+			break;
+		case HOSTCMD_SETTING_PROFILE_DAY_START:
+		case HOSTCMD_SETTING_PROFILE_NIGHT_START:
+			max = PROFILE_SCHEDULE_OFF;
+			break;
+		case HOSTCMD_SETTING_LATCH_AREA:
+			max = RELAY_AREA_ENABLED ? RELAY_LATCH_AREA_MAX : 0U;
+			break;
+		case HOSTCMD_SETTING_AREA_LEAK:
+			max = ADC_THRESHOLD_MAX;
+			break;
+		case HOSTCMD_SETTING_LATCH_ADAPT_RATE:
+			max = RELAY_ADAPT_ENABLED ? UINT16_MAX : 0U;
+			break;
+		case HOSTCMD_SETTING_LATCH_ADAPT_MIN:
+			max = RELAY_LATCHTIME_MAX;
+			break;
+		case HOSTCMD_SETTING_LATCH_ADAPTED:
+			max = 0U;
+			break;
+		case HOSTCMD_SETTING_ENERGY_CURRENT:
+			max = ((uint32_t)ENERGY_CONSUMER_COUNT << ENERGY_SETTING_SHIFT) - 1U;
+			break;
+		case HOSTCMD_SETTING_USB_LED_LEVEL:
+			max = SOFTPWM_ENABLED ? LEDFADE_LEVEL_MAX : 0U;
+			break;
+		case HOSTCMD_SETTING_GOVERNOR_MARGIN:
+			max = (SENSOR_GOVERNOR && SENSOR_FREE_RUNNING) ? ADC_THRESHOLD_MAX : 0U;
+			break;
+		case HOSTCMD_SETTING_ROLLBACK:
+			max = settings_history_count();
+			break;
+		default:
+			return HOSTCMD_STATUS_BAD_ID;
+	}
+	return (value <= max) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_OUT_OF_RANGE;
+}
+
+//****************************************************************************
+// host_setting_set - applies a checked setting (interrupts masked, the ADC interrupt compares against the thresholds)
+//****************************************************************************
+void host_setting_set(uint8_t id, uint32_t value){
+	switch(id){
+		case HOSTCMD_SETTING_UPPER_THRESHOLD:
+			setup_channel->upper_threshold = (int32_t)value;
+			break;
+		case HOSTCMD_SETTING_LOWER_THRESHOLD:
+			setup_channel->lower_threshold = (int32_t)value;
+			break;
+		case HOSTCMD_SETTING_LATCHTIME:
+			setup_channel->latchtime = (int32_t)value;
+			break;
+		case HOSTCMD_SETTING_SAMPLE_PERIOD:
+			telemetry_set_sample_period((uint16_t)value);
+			break;
+		case HOSTCMD_SETTING_CAPTURE_MODE:
+			capture_set_mode((capture_modes)value);
+			break;
+		case HOSTCMD_SETTING_WALLCLOCK:
+			wallclock_set(value);
+			break;
+		case HOSTCMD_SETTING_USB_ALARM:
+			wallclock_set_alarm(value);
+			break;
+		case HOSTCMD_SETTING_USB_PORT:
+			// Switched by the main loop (not with interrupts masked)
+			main_state.usb_host_request = (USB_states)value;
+			post_event(EVENT_USB_REQUEST);
+			break;
+		case HOSTCMD_SETTING_USB_FAILOVER:
+			failover_active = (value != 0);
+			break;
+		case HOSTCMD_SETTING_PREDICT_RATE:
+			setup_channel->predict_rate = (int32_t)value;
+			break;
+		case HOSTCMD_SETTING_MIN_HIGH_TIME:
+			setup_channel->min_high_time = (uint16_t)value;
+			break;
+		case HOSTCMD_SETTING_MIN_LOW_TIME:
+			setup_channel->min_low_time = (uint16_t)value;
+			break;
+		case HOSTCMD_SETTING_SWITCH_RATE_MAX:
+			setup_channel->switch_rate_max = (uint8_t)value;
+			break;
+		case HOSTCMD_SETTING_RELAY_CYCLES:
+			relaylife_set_cycles(value);
+			break;
+		case HOSTCMD_SETTING_COIL_PULLIN_TIME:
+			coil_configure((uint8_t)value, coil_hold_duty);
+			break;
+		case HOSTCMD_SETTING_COIL_HOLD_DUTY:
+			coil_configure(coil_pullin_time, (uint8_t)value);
+			break;
+		case HOSTCMD_SETTING_BISTABLE_PULSE_TIME:
+			bistable_configure((uint8_t)value);
+			break;
+		case HOSTCMD_SETTING_BUS_ADDRESS:
+			hostbus_set_address(value);
+			break;
+		case HOSTCMD_SETTING_ADC_PROFILE:
+			sensor_set_profile((sensor_profiles)value);
+			break;
+		case HOSTCMD_SETTING_ADC_READ:
+			// A pending read of the channel is answered by its event as well
+			sensor_request_conversion((uint8_t)value, host_read_done);
+			break;
+		case HOSTCMD_SETTING_ADC_SAMPLE_TIME:
+			// A code known from another unit of the same board, stored like a calibrated one
+			sample_time_calibrated((uint8_t)value);
+			break;
+		case HOSTCMD_SETTING_ADC_SAMPLE_CAL:
+			// Commissioning: the search runs in the background, the found code is stored with the setup
+			sensor_calibrate_sample_time((value != 0) ? (uint16_t)value : SENSOR_SAMPLE_CAL_ERROR, sample_time_calibrated);
+			break;
+		case HOSTCMD_SETTING_FAULT_SAFE_STATE:
+			setup_channel->safe_state = (relay_states)value;
+			break;
+		case HOSTCMD_SETTING_RELAY_OPERATE_TIME:
+		case HOSTCMD_SETTING_RELAY_RELEASE_TIME:
+			relaytime_reset(id == HOSTCMD_SETTING_RELAY_OPERATE_TIME);
+			break;
+		case HOSTCMD_SETTING_PROFILE:
+			// Switched by the main loop (the index is stored, not with interrupts masked)
+			main_state.profile_host_request = (uint8_t)value;
+			post_event(EVENT_PROFILE_REQUEST);
+			break;
+		case HOSTCMD_SETTING_PROFILE_DAY_START:
+			main_state.profile_day_start = (uint16_t)value;
+			main_state.profile_scheduled = PROFILE_NONE; // The new schedule selects its profile at the next check
+			break;
+		case HOSTCMD_SETTING_PROFILE_NIGHT_START:
+			main_state.profile_night_start = (uint16_t)value;
+			main_state.profile_scheduled = PROFILE_NONE;
+			break;
+		case HOSTCMD_SETTING_LATCH_AREA:
+			// A partly integrated area is dropped
+			setup_channel->latch_area = value;
+			setup_channel->area = 0;
+			break;
+		case HOSTCMD_SETTING_AREA_LEAK:
+			setup_channel->area_leak = (uint16_t)value;
+			break;
+		case HOSTCMD_SETTING_LATCH_ADAPT_RATE:
+			// The next statistics window estimates the latch time for the new rate
+			setup_channel->adapt_rate = (uint16_t)value;
+			setup_channel->latch_adapted = RELAY_ADAPT_NONE;
+			break;
+		case HOSTCMD_SETTING_LATCH_ADAPT_MIN:
+			setup_channel->adapt_min = (uint16_t)value;
+			setup_channel->latch_adapted = RELAY_ADAPT_NONE;
+			break;
+		case HOSTCMD_SETTING_LATCH_ADAPTED:
+			setup_channel->latch_adapted = RELAY_ADAPT_NONE;
+			break;
+		case HOSTCMD_SETTING_ENERGY_CURRENT:
+			energy_set_current(value);
+			break;
+		case HOSTCMD_SETTING_USB_LED_LEVEL:
+			main_state.usb_led_level = (uint8_t)value;
+			usb_indicators_update();
+			break;
+		case HOSTCMD_SETTING_GOVERNOR_MARGIN:
+			sensor_governor_margin = (uint16_t)value;
+			break;
+		case HOSTCMD_SETTING_ROLLBACK:
+			// Applied by the main loop (flash read and sample time change not with interrupts masked)
+			main_state.rollback_host_request = (uint8_t)value;
+			post_event(EVENT_ROLLBACK_REQUEST);
+			break;
+	}
+}
+
+//****************************************************************************
+// host_command - handles a request of the host command protocol (hostcmd_task, see hostcmd.h)
+//****************************************************************************
+uint8_t host_command(uint8_t command, const uint8_t *payload, uint8_t length, uint8_t *response, uint8_t *response_length){
+	switch(command){
+		case HOSTCMD_GET:{
+			uint32_t value;
+			if(length != 1)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			if(!host_setting_get(payload[0], &value))
+				return HOSTCMD_STATUS_BAD_ID;
+			response[0] = payload[0];
+			telemetry_put32(&response[1], value);
+			*response_length = 5;
+			return HOSTCMD_STATUS_OK;
+		}
+		case HOSTCMD_SET:
+		case HOSTCMD_BATCH:{
+			// [id][value] pairs, a set is a batch of one
+			uint8_t count = length / 5U;
+			if(count == 0 || length != count * 5U || (command == HOSTCMD_SET && count != 1))
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			if(main_state.setup_state != SETUP_IDLE)
+				return HOSTCMD_STATUS_BUSY;
+			// All or none: every pair is checked before the first one is applied
+			for(uint8_t i = 0; i < count; i++){
+				uint8_t status = host_setting_check(payload[i * 5U], hostcmd_get32(&payload[i * 5U + 1U]));
+				if(status != HOSTCMD_STATUS_OK)
+					return status;
+			}
+			// The ADC interrupt sees either the old or the new settings (e.g. never a new upper with the old lower threshold)
+			critical_state_t primask = critical_enter();
+			for(uint8_t i = 0; i < count; i++)
+				host_setting_set(payload[i * 5U], hostcmd_get32(&payload[i * 5U + 1U]));
+			critical_exit(primask, CRITICAL_SITE_SETTINGS);
+			response[0] = (command == HOSTCMD_SET) ? payload[0] : count;
+			*response_length = 1;
+			return HOSTCMD_STATUS_OK;
+		}
+		case HOSTCMD_COMMIT:
+			if(main_state.setup_state != SETUP_IDLE)
+				return HOSTCMD_STATUS_BUSY;
+			// One record with all settings, written by storage_flush when the main loop is idle (unchanged records are not written, an applied rollback is confirmed)
+			commit_rollback();
+			return HOSTCMD_STATUS_OK;
+		case HOSTCMD_UPDATE:
+			if(length != 0)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			if(main_state.setup_state != SETUP_IDLE)
+				return HOSTCMD_STATUS_BUSY;
+			// The main loop resets into the resident updater after the response (see updater.h)
+			main_state.update_pending = true;
+			return HOSTCMD_STATUS_OK;
+		case HOSTCMD_METRICS_LIST:
+		case HOSTCMD_METRICS_READ:
+			if(length != 1)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			if(payload[0] > metrics_count())
+				return HOSTCMD_STATUS_OUT_OF_RANGE;
+			*response_length = (command == HOSTCMD_METRICS_LIST) ? metrics_list(payload[0], response) : metrics_read(payload[0], response);
+			return HOSTCMD_STATUS_OK;
+		case HOSTCMD_SUBSCRIBE:
+			if(length != 9)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			return telesub_add((uint16_t)(payload[0] | (payload[1] << 8)), payload[2], (uint16_t)(payload[3] | (payload[4] << 8)), hostcmd_get32(&payload[5]));
+		case HOSTCMD_UNSUBSCRIBE:
+			if(length != 2)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			return telesub_remove((uint16_t)(payload[0] | (payload[1] << 8)));
+		case HOSTCMD_FACTORY_READ:{
+			if(length != 0)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			const factory_block_t *factory = factory_block();
+			if(factory == NULL)
+				return HOSTCMD_STATUS_OK;
+			uint8_t *p = telemetry_put32(response, factory->serial);
+			p = telemetry_put32(p, factory->operate_time);
+			p = telemetry_put32(p, factory->release_time);
+			p = telemetry_put16(p, (uint16_t)factory->adc_offset);
+			p = telemetry_put16(p, factory->adc_gain);
+			p = telemetry_put16(p, factory->upper_threshold);
+			p = telemetry_put16(p, factory->lower_threshold);
+			p = telemetry_put16(p, factory->latchtime);
+			*response_length = (uint8_t)(p - response);
+			return HOSTCMD_STATUS_OK;
+		}
+		case HOSTCMD_FACTORY_WRITE:{
+			if(length != HOSTCMD_FACTORY_SIZE)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			factory_block_t factory = {0};
+			factory.serial = hostcmd_get32(&payload[0]);
+			factory.operate_time = hostcmd_get32(&payload[4]);
+			factory.release_time = hostcmd_get32(&payload[8]);
+			factory.adc_offset = (int16_t)(payload[12] | (payload[13] << 8));
+			factory.adc_gain = (uint16_t)(payload[14] | (payload[15] << 8));
+			factory.upper_threshold = (uint16_t)(payload[16] | (payload[17] << 8));
+			factory.lower_threshold = (uint16_t)(payload[18] | (payload[19] << 8));
+			factory.latchtime = (uint16_t)(payload[20] | (payload[21] << 8));
+			if(factory.adc_gain == 0 || factory.upper_threshold > ADC_THRESHOLD_MAX || factory.lower_threshold > factory.upper_threshold
+					|| factory.latchtime > RELAY_LATCHTIME_MAX || factory.operate_time > TIMING_MS_TO_US(RELAYTIME_TIMEOUT)
+					|| factory.release_time > TIMING_MS_TO_US(RELAYTIME_TIMEOUT))
+				return HOSTCMD_STATUS_OUT_OF_RANGE;
+			// Programmed by factory_flush when the main loop is idle, read it back to confirm
+			return factory_write(&factory) ? HOSTCMD_STATUS_OK : HOSTCMD_STATUS_LOCKED;
+		}
+		case HOSTCMD_BUS_ASSIGN:{
+			if(!HOSTBUS_ENABLED)
+				return HOSTCMD_STATUS_UNKNOWN_COMMAND;
+			if(length != 5)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			// Every unit receives the broadcast, only the one of the serial number takes the address
+			if(factory_block() == NULL || factory_block()->serial != hostcmd_get32(&payload[0]))
+				return HOSTCMD_STATUS_BAD_ID;
+			if(main_state.setup_state != SETUP_IDLE)
+				return HOSTCMD_STATUS_BUSY;
+			if(!hostbus_set_address(payload[4]))
+				return HOSTCMD_STATUS_OUT_OF_RANGE;
+			write_eeprom_setup();
+			return HOSTCMD_STATUS_OK;
+		}
+		case HOSTCMD_TIME_WARP:{
+#ifdef SYSTIMER_TIME_WARP_ENABLED
+			if(length != 4)
+				return HOSTCMD_STATUS_BAD_LENGTH;
+			// Every deadline on the way is passed in order, like hours of operation in minutes
+			uint32_t time = hostcmd_get32(&payload[0]);
+			if(time > UINT32_MAX / TIMING_US_PER_MS || SYSTIMER_Warp(time * TIMING_US_PER_MS) != SYSTIMER_STATUS_SUCCESS)
+				return HOSTCMD_STATUS_OUT_OF_RANGE;
+			return HOSTCMD_STATUS_OK;
+#else
+			return HOSTCMD_STATUS_UNKNOWN_COMMAND;
+#endif
+		}
+		default:
+			return HOSTCMD_STATUS_UNKNOWN_COMMAND;
+	}
+}
+
+//****************************************************************************
+// eeprom_write_done - called by storage_flush when a queued EEPROM write finished
+//****************************************************************************
+void eeprom_write_done(uint8_t block_number, E_EEPROM_XMC1_OPERATION_STATUS_t status){
+	if(status == E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		return;
+	LOG_WARN("EEPROM block %u write failed (status %u)", block_number, status);
+	// A setting that could not be stored is lost after the next reset - indicate it like an invalid value at boot
+	if(main_state.setup_state == SETUP_IDLE && ledpattern_depth() <= 1)
+		ledpattern_push(led_pattern_number_single, 2);
+}
+
+#if SENSOR_CALIBRATION
+//****************************************************************************
+// read_eeprom_calibration - applies the calibration table stored in EEPROM to the setup channel (else the factory offset and gain or the flash default)
+//****************************************************************************
+void read_eeprom_calibration(void){
+	uint8_t ReadBuffer_CAL[CALIB_STORAGE_SIZE];
+	calib_table_t table;
+
+	if(E_EEPROM_XMC1_Read(EEPROM_CALIBRATION, 0U, ReadBuffer_CAL, CALIB_STORAGE_SIZE) == E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS
+			&& calib_deserialize(&table, ReadBuffer_CAL)){
+		sensor_set_calibration(0, &table);
+		return;
+	}
+	const factory_block_t *factory = factory_block();
+	if(factory != NULL && factory_calibration(factory, &table))
+		sensor_set_calibration(0, &table);
+}
+
+//****************************************************************************
+// write_eeprom_calibration - applies a calibration table to the setup channel and queues it for EEPROM. Returns false if the table is invalid
+//****************************************************************************
+bool write_eeprom_calibration(const calib_table_t *table){
+	uint8_t EEPROM_WriteBuffer[CALIB_STORAGE_SIZE];
+
+	if(!sensor_set_calibration(0, table))
+		return false;
+	calib_serialize(table, EEPROM_WriteBuffer);
+	return storage_post(EEPROM_CALIBRATION, EEPROM_WriteBuffer, CALIB_STORAGE_SIZE);
+}
+#endif
+
+#if !USB_STORE_STATE_LOG
+//****************************************************************************
+// usb_save_thread - stores the USB state to EEPROM after it did not change for USB_STORE_STATE_EEPROM_DELAY (pt.h)
+//****************************************************************************
+pt_status usb_save_thread(pt_t *pt){
+	PT_BEGIN(pt);
+	for(;;){
+		PT_WAIT_UNTIL(pt, main_state.usb_store_pending);
+		// Every further change moves the deadline (usb_state_changed)
+		PT_WAIT_DEADLINE(pt, main_state.usb_store_deadline);
+		main_state.usb_store_pending = false;
+		if(USB_STORE_STATE_EEPROM)
+			write_eeprom_setup();
+	}
+	PT_END(pt);
+}
+
+//****************************************************************************
+// manage_usb_save - resumes usb_save_thread (scheduler task, the task period is the resolution of the delay)
+//****************************************************************************
+void manage_usb_save(void){
+	pt_run(usb_save_thread, &main_state.usb_store_pt);
+}
+#endif
+
+//****************************************************************************
+// retain_state - saves the warm reset state (after a switch or a USB port change and every RETAIN_REFRESH_PERIOD)
+//****************************************************************************
+void retain_state(void){
+	retain_save(main_state.usb_state, main_state.profile, main_frame.now);
+	bistable_save();
+}
+
+//****************************************************************************
+// usb_state_changed - stores a new USB state (immediately to the state log or delayed with the setup)
+//****************************************************************************
+void usb_state_changed(void){
+	usb_indicators_update();
+	failover_switched(main_frame.now);
+#if USB_STORE_STATE_LOG
+	if(USB_STORE_STATE_EEPROM)
+		statelog_post(main_state.usb_state);
+#else
+	main_state.usb_store_deadline = timing_deadline_us(main_frame.now, USB_STORE_STATE_EEPROM_DELAY_US);
+	main_state.usb_store_pending = true;
+#endif
+	retain_state();
+}
+
+//****************************************************************************
+// usb_record_latency - records the time from the release of the USB button to its switchover (profiler and field histogram)
+//****************************************************************************
+void usb_record_latency(void){
+#if PROFILER_ENABLED || FIELDHIST_ENABLED
+	uint32_t latency = SYSTIMER_GetTimeUs() - buttons_state[BUTTON_USB].released_timestamp;
+	FIELDHIST_ADD(USB_LATENCY, latency);
+#endif
+#if PROFILER_ENABLED
+	profiler_record(PROFILER_USB_LATENCY, latency * (SYSTIMER_SYSTICK_CLOCK / 1000000U));
+#endif
+}
+
+//****************************************************************************
+// select_usb - switches to a USB port or the standby like a press of the USB button (host commands, chord and the wall clock alarm)
+//****************************************************************************
+void select_usb(USB_states state){
+	if(state != main_state.usb_state){
+		main_state.usb_state = state;
+		switchUSB(main_state.usb_state);
+		usb_state_changed();
+		// Nothing needs the full clock in standby, so power_idle can power the flash down right away
+		if(main_state.usb_state == USB_inactive)
+			clockscale_lower();
+	}
+}
+
+//****************************************************************************
+// manage_usb - USB state machine (switches port on button press, standby on the standby chord)
+//****************************************************************************
+void manage_usb(void){
+	// The standby chord powers all ports off or resumes the last port (cleared with the other presses by task_ui)
+	if(buttons_get_chord() == USB_STANDBY_CHORD){
+		select_usb((main_state.usb_state == USB_inactive) ? usb_last_port : USB_inactive);
+		return;
+	}
+	// USB state machine: every standard press switches to the next port of the port table (the last port from standby)
+	if(buttons_get_press(BUTTON_USB) == BTNPRESS_STD){
+		main_state.usb_state = usb_next_port(main_state.usb_state);
+		usb_record_latency();
+		switchUSB(main_state.usb_state);
+		buttons_clear_press(BUTTON_USB);
+		usb_state_changed();
+	}
+}
+
+//****************************************************************************
+// manage_profile - selects the next threshold profile on the profile chord (blinks the number of the new profile + 1)
+//****************************************************************************
+void manage_profile(void){
+	if(buttons_get_chord() != PROFILE_CHORD)
+		return;
+	uint8_t next = (main_state.profile + 1U < SETTINGS_PROFILE_COUNT) ? (uint8_t)(main_state.profile + 1U) : 0U;
+	if(select_profile(next))
+		ledpattern_push(led_pattern_number_single, next + 1U);
+}
+
+//****************************************************************************
+// manage_optical - starts or stops the optical readout through the status LED on the optical chord
+//****************************************************************************
+void manage_optical(void){
+	if(buttons_get_chord() != OPTICAL_CHORD)
+		return;
+	if(optical_running())
+		optical_stop();
+	else
+		optical_start();
+}
+
+//****************************************************************************
+// manage_rollback - applies the next older settings record on the rollback chord (blinks its step + 1), a long press of the USB button stores it
+//****************************************************************************
+void manage_rollback(void){
+	if(!SETUP_ROLLBACK)
+		return;
+	if(main_state.rollback != 0 && buttons_get_press(BUTTON_USB) == BTNPRESS_LONG){
+		commit_rollback();
+		buttons_clear_press(BUTTON_USB);
+		return;
 	}
-	else if(state == USB_2_active){
-		DIGITAL_IO_SetOutputLow(&IO_USBPWR_1);
-		DIGITAL_IO_SetOutputHigh(&IO_USB_SI);
-		DIGITAL_IO_SetOutputLow(&IO_LED_USB2);
-		DIGITAL_IO_SetOutputHigh(&IO_LED_USB1);
-		DIGITAL_IO_SetOutputHigh(&IO_USBPWR_2);
+	if(buttons_get_chord() != ROLLBACK_CHORD)
+		return;
+	// Past the oldest kept record the stored one comes back
+	uint8_t step = (uint8_t)(main_state.rollback + 1U);
+	if(step > settings_history_count() || !rollback_settings(step)){
+		step = 0;
+		if(!rollback_settings(0))
+			return;
 	}
+	ledpattern_push(led_pattern_number_single, step + 1U);
+}
+
+//****************************************************************************
+// profile_schedule_task - scheduler task: selects the day or night profile when the wall clock enters its period (PROFILE_SCHEDULE_PERIOD)
+//****************************************************************************
+void profile_schedule_task(void){
+	uint16_t day = main_state.profile_day_start;
+	uint16_t night = main_state.profile_night_start;
+	uint32_t now = wallclock_get();
+	if(now == 0 || day == PROFILE_SCHEDULE_OFF || night == PROFILE_SCHEDULE_OFF || day == night)
+		return;
+
+	// The night runs from its start to the day start (across midnight if it starts later on the day)
+	uint16_t minute = (uint16_t)((now % 86400U) / 60U);
+	bool is_night = (night < day) ? (minute >= night && minute < day) : (minute >= night || minute < day);
+	uint8_t profile = is_night ? PROFILE_NIGHT : PROFILE_DAY;
+	// Only a new period switches, a profile selected in between by chord or host stays until the next start
+	if(profile != main_state.profile_scheduled && select_profile(profile))
+		main_state.profile_scheduled = profile;
+}
+
+//****************************************************************************
+// adapt_latch_task - scheduler task: adapts the latch time of every channel to the noise of its rolling statistics (RELAY_ADAPT_PERIOD)
+//****************************************************************************
+void adapt_latch_task(void){
+	stats_result_t result;
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		if(relay_channels[i].adapt_rate != 0 && sensor_get_stats(i, false, &result))
+			relay_adapt(&relay_channels[i], &result);
+	}
+}
+
+//****************************************************************************
+// i2c_command - executes a command written to the I2C target command register (i2ctarget_task, also the Modbus command register by modbus_task)
+//****************************************************************************
+bool i2c_command(uint8_t command){
+	USB_states state;
+	switch(command){
+		case I2C_CMD_USB1:
+			state = USB_1_active;
+			break;
+		case I2C_CMD_USB2:
+			state = USB_2_active;
+			break;
+		case I2C_CMD_USB_TOGGLE:
+			state = usb_next_port(main_state.usb_state);
+			break;
+		case I2C_CMD_USB_STANDBY:
+			state = USB_inactive;
+			break;
+		default:
+			if(command < I2C_CMD_USB_PORT || command >= I2C_CMD_USB_PORT + USB_PORT_COUNT)
+				return false;
+			state = (USB_states)(command - I2C_CMD_USB_PORT);
+			break;
+	}
+	select_usb(state);
+	return true;
+}
+
+//****************************************************************************
+// relay_followup - publishes a switch of the output of a channel at timestamp (the subscribers below run in the next evbus_dispatch)
+//****************************************************************************
+void relay_followup(relay_channel_t *channel, uint32_t timestamp){
+	// Traced here, so the entry has the state of this switch
+	TRACE(TRACE_RELAY, channel - relay_channels, channel->state);
+	evbus_post(EVBUS_RELAY_SWITCHED, (uint8_t)(channel - relay_channels), timestamp);
+}
+
+//****************************************************************************
+// relay_capture - starts the capture post-trigger of the capture channel (EVBUS_RELAY_SWITCHED)
+//****************************************************************************
+#if CAPTURE_ENABLED
+void relay_capture(const evbus_message_t *message){
+	if(message->arg == CAPTURE_CHANNEL)
+		capture_trigger();
+}
+EVBUS_SUBSCRIBE(relay_capture, EVBUS_RELAY_SWITCHED, relay_capture);
+#endif
+
+//****************************************************************************
+// relay_record - keeps a field trace window of the recorder channel (EVBUS_RELAY_SWITCHED)
+//****************************************************************************
+#if RECORDER_ENABLED
+void relay_record(const evbus_message_t *message){
+	if(message->arg == RECORDER_CHANNEL)
+		recorder_trigger(&relay_channels[RECORDER_CHANNEL], message->value);
+}
+EVBUS_SUBSCRIBE(relay_record, EVBUS_RELAY_SWITCHED, relay_record);
+#endif
+
+//****************************************************************************
+// relay_failover - selects the next port if a sense channel of the active port lost its device (EVBUS_RELAY_SWITCHED)
+//****************************************************************************
+#if FAILOVER_ENABLED
+void relay_failover(const evbus_message_t *message){
+	// Within the latch time of the channel
+	USB_states port = failover_check(&relay_channels[message->arg], main_state.usb_state, message->value);
+	if(port != main_state.usb_state)
+		select_usb(port);
+}
+EVBUS_SUBSCRIBE(relay_failover, EVBUS_RELAY_SWITCHED, relay_failover);
+#endif
+
+//****************************************************************************
+// quiet_restart - restarts the quiet time of the planned garbage collection (button press or relay switch)
+//****************************************************************************
+void quiet_restart(void){
+	main_state.quiet = false;
+	main_state.quiet_deadline = timing_deadline(main_frame.now, STORAGE_GC_QUIET_TIME);
+}
+
+//****************************************************************************
+// relay_quiet - a switch ends the quiet time (EVBUS_RELAY_SWITCHED)
+//****************************************************************************
+#if STORAGE_GC_PLAN
+void relay_quiet(const evbus_message_t *message){
+	(void)message;
+	quiet_restart();
+}
+EVBUS_SUBSCRIBE(relay_quiet, EVBUS_RELAY_SWITCHED, relay_quiet);
+#endif
+
+//****************************************************************************
+// relay_led - lets the LED follow the setup channel, a running user info pattern is finished first (EVBUS_RELAY_SWITCHED)
+//****************************************************************************
+void relay_led(const evbus_message_t *message){
+	if(&relay_channels[message->arg] == setup_channel && main_state.setup_state == SETUP_IDLE)
+		ledpattern_set_base(relay_led_pattern(), 0);
+}
+EVBUS_SUBSCRIBE(relay_led, EVBUS_RELAY_SWITCHED, relay_led);
+
+//****************************************************************************
+// relay_retain - saves the warm reset state after a switch (EVBUS_RELAY_SWITCHED)
+//****************************************************************************
+#if RETAIN_ENABLED
+void relay_retain(const evbus_message_t *message){
+	(void)message;
+	retain_state();
+}
+EVBUS_SUBSCRIBE(relay_retain, EVBUS_RELAY_SWITCHED, relay_retain);
+#endif
+
+//****************************************************************************
+// relay_resync - catches up with relay switches whose events were dropped by a full event bus (EVBUS_OVERFLOW)
+//****************************************************************************
+void relay_resync(const evbus_message_t *message){
+	LOG_WARN("Event bus overflow (%u events dropped)", message->value);
+	// The failover reads the sense channel itself, a lost drop must not keep a dead port
+	USB_states port = failover_recheck(main_state.usb_state, main_frame.now);
+	if(port != main_state.usb_state)
+		select_usb(port);
+	quiet_restart();
+	if(main_state.setup_state == SETUP_IDLE)
+		ledpattern_set_base(relay_led_pattern(), 0);
+	retain_state();
+}
+EVBUS_SUBSCRIBE(relay_resync, EVBUS_OVERFLOW, relay_resync);
+
+//****************************************************************************
+// flash_corrupt - records a flash block that failed the background integrity check (EVBUS_FLASH_CORRUPT)
+//****************************************************************************
+#if FLASHCHECK_ENABLED
+void flash_corrupt(const evbus_message_t *message){
+	TRACE(TRACE_FLASH_CORRUPT, message->arg, message->value);
+	LOG_ERROR("Flash block %u at 0x%x corrupt", message->arg, message->value);
+}
+EVBUS_SUBSCRIBE(flash_corrupt, EVBUS_FLASH_CORRUPT, flash_corrupt);
+#endif
+
+//****************************************************************************
+// manage_relay - runs the relay state machine of a channel (evaluates an ADC value sampled at timestamp, in us)
+//****************************************************************************
+void manage_relay(relay_channel_t *channel, uint32_t value, uint32_t timestamp){
+	FUNCPROF_ENTER();
+	BOOT_STAMP_ONCE(BOOT_STAGE_FIRST_RELAY);
+	// Thresholds are already checked by the ADC interrupt in boundary event mode
+	if(relay_update(channel, value, timestamp, !ADC_BOUNDARY_EVENTS))
+		relay_followup(channel, timestamp);
+	FUNCPROF_EXIT(FUNCPROF_MANAGE_RELAY);
+}
+
+#if RELAY_TIMED_LATCH
+//****************************************************************************
+// relay_timer_arm - starts the latch timer of a channel for a deadline after now (at most HRTIMER_MAX_US, the callback arms it again)
+//****************************************************************************
+RAMCODE
+void relay_timer_arm(uint8_t channel, uint32_t deadline, uint32_t now){
+	// The deadline is SysTick time, the hrtimer runs at real time (SYSTIMER_WARP_RATE of soak test builds)
+	uint32_t timeout = (deadline - now) / SYSTIMER_WARP_RATE;
+	if(timeout > HRTIMER_MAX_US)
+		timeout = HRTIMER_MAX_US;
+	hrtimer_start(main_state.relay_timer[channel], timeout);
+}
+
+//****************************************************************************
+// relay_timer_callback - latch timer of a channel expired (hrtimer interrupt): switches the output at the deadline,
+//                        independent of the main loop. The main loop follows the switch up (EVENT_RELAY_SWITCHED)
+//****************************************************************************
+RAMCODE
+void relay_timer_callback(void *args){
+	relay_channel_t *channel = (relay_channel_t *)args;
+	uint8_t index = (uint8_t)(channel - relay_channels);
+	uint32_t now = SYSTIMER_GetTime();
+	uint32_t deadline;
+
+	// Ended meanwhile (return into the band, fault or a switch of the main loop), the timer stays stopped
+	if(!relay_latch_deadline(channel, &deadline))
+		return;
+	if(!timing_reached(now, deadline)){
+		relay_timer_arm(index, deadline, now);
+		return;
+	}
+	// A switch from here could interrupt the same switch of the main loop, which sees the deadline itself then
+	if(!main_state.relay_evaluating && relay_update(channel, channel->value, now, false)){
+		main_state.relay_switched |= 1U << index;
+		post_event(EVENT_RELAY_SWITCHED);
+		return;
+	}
+	hrtimer_start(main_state.relay_timer[index], RELAY_TIMED_RETRY_US);
+}
+
+//****************************************************************************
+// relay_timers_update - arms the latch timer of every channel with a running latch time, stops the others (main context)
+//****************************************************************************
+void relay_timers_update(void){
+	uint32_t now = SYSTIMER_GetTime();
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		uint32_t deadline;
+		// Armed again on every pass: the slope may have shortened the latch time meanwhile
+		if(relay_latch_deadline(&relay_channels[i], &deadline) && !timing_reached(now, deadline))
+			relay_timer_arm(i, deadline, now);
+		else if(hrtimer_running(main_state.relay_timer[i]))
+			hrtimer_stop(main_state.relay_timer[i]);
+	}
+}
+#endif
+
+
+//****************************************************************************
+// set_setup_state - changes the state of the setup menu
+//****************************************************************************
+void set_setup_state(setup_states state){
+	main_state.setup_state = state;
+	// Up and down auto-repeat inside the menus only, outside them a quick second press stays a standard press
+	buttons_set_repeat((state != SETUP_IDLE) ? (uint8_t)((1U << BUTTON_UP) | (1U << BUTTON_DOWN)) : 0U);
+	TRACE(TRACE_SETUP, state, 0);
+}
+
+// Setup menu (table driven, see fsm.h): the events are the registered presses of the up and down buttons
+#define SETUP_EVENT_UP(press)		 (1U << ((press) - 1U))		// Event bit of a button_press_states of the up button
+#define SETUP_EVENT_DOWN(press)		 (1U << ((press) + 3U))		// Event bit of a button_press_states of the down button
+#define SETUP_EVENT_UP_STD			 SETUP_EVENT_UP(BTNPRESS_STD)
+#define SETUP_EVENT_UP_LONGEST		 SETUP_EVENT_UP(BTNPRESS_LONGEST)
+#define SETUP_EVENT_UP_REPEAT		 SETUP_EVENT_UP(BTNPRESS_REPEAT)
+#define SETUP_EVENT_DOWN_STD		 SETUP_EVENT_DOWN(BTNPRESS_STD)
+#define SETUP_EVENT_DOWN_LONGEST	 SETUP_EVENT_DOWN(BTNPRESS_LONGEST)
+#define SETUP_EVENT_DOWN_REPEAT		 SETUP_EVENT_DOWN(BTNPRESS_REPEAT)
+#define SETUP_EVENT_LONG			 (SETUP_EVENT_UP(BTNPRESS_LONG) | SETUP_EVENT_DOWN(BTNPRESS_LONG))	// Long press of up or down
+#define SETUP_LIMIT_BLINKS			 2							// Blinks when a setting reaches its minimum or maximum (the menu pattern continues afterwards)
+#define SETUP_CAPTURE_BLINKS		 3							// Blinks when the current ADC value got saved as threshold
+#define SETUP_REPEAT_FAST_AFTER		 8							// Auto-repeats of a press after which every repeat takes SETUP_REPEAT_FAST_STEPS steps
+#define SETUP_REPEAT_FAST_STEPS		 4
+#define SETUP_REPEAT_FEEDBACK		 4							// Every this many auto-repeats one blink confirms them (throttled, a blink takes longer than a repeat)
+typedef char setup_events_check[(SETUP_EVENT_DOWN(BTNPRESS_REPEAT) <= UINT16_MAX && SETUP_REPEAT_FEEDBACK > 0) ? 1 : -1];
+
+typedef struct {
+	int32_t *value;				// Setting of setup_channel edited in the menu
+	int32_t step;				// Added by a short press of up, subtracted by one of down
+	int32_t min;				// Lower limit (reaching it is indicated)
+	int32_t max;				// Upper limit (exceeding it is indicated)
+	uint8_t block;				// EEPROM block the setting is stored in when the menu is left
+	const uint8_t *pattern;		// Status LED pattern while the menu is open
+	uint8_t pattern_arg;
+} setup_param_t;
+
+// Index: setup_states - 1 (SETUP_IDLE has no setting). The thresholds are additionally kept ADC_HYSTERESIS_MIN apart (setup_limits)
+const setup_param_t setup_params[] = {
+	{&relay_channels[SETUP_CHANNEL].upper_threshold, ADC_THRESHOLD_INCREMENT, 0, ADC_THRESHOLD_MAX, EEPROM_SETTINGS, led_pattern_fade_up, 0},		// SETUP_UPPER_TH
+	{&relay_channels[SETUP_CHANNEL].lower_threshold, ADC_THRESHOLD_INCREMENT, 0, ADC_THRESHOLD_MAX, EEPROM_SETTINGS, led_pattern_fade_down, 0},	// SETUP_LOWER_TH
+	{&relay_channels[SETUP_CHANNEL].latchtime, RELAY_LATCHTIME_INCREMENT, 0, RELAY_LATCHTIME_MAX, EEPROM_SETTINGS, led_pattern_number, 1}		// SETUP_TIME_TH
+};
+
+//****************************************************************************
+// setup_enter - opens the menu of a setting (shows its LED pattern)
+//****************************************************************************
+void setup_enter(uint8_t from, uint8_t to){
+	(void)from;
+	// The menu changes the stored settings, not an applied rollback
+	drop_rollback();
+	const setup_param_t *param = &setup_params[to - 1U];
+	ledpattern_play(param->pattern, param->pattern_arg);
+}
+
+//****************************************************************************
+// setup_limits - returns the range of the setting of a menu, the thresholds keep ADC_HYSTERESIS_MIN to each other
+//****************************************************************************
+void setup_limits(uint8_t state, int32_t *min, int32_t *max){
+	const setup_param_t *param = &setup_params[state - 1U];
+	*min = param->min;
+	*max = param->max;
+	// Signed, ADC_HYSTERESIS_MIN is unsigned and an upper threshold below it would wrap
+	const int32_t hysteresis = (int32_t)ADC_HYSTERESIS_MIN;
+	if(state == SETUP_UPPER_TH && setup_channel->lower_threshold + hysteresis > *min)
+		*min = setup_channel->lower_threshold + hysteresis;
+	else if(state == SETUP_LOWER_TH && setup_channel->upper_threshold - hysteresis < *max)
+		*max = setup_channel->upper_threshold - hysteresis;
+}
+
+//****************************************************************************
+// setup_step - returns the step of a menu for the press of a button, auto-repeats take faster steps after a while and blink now and then
+//****************************************************************************
+int32_t setup_step(const setup_param_t *param, buttons_id button){
+	if(buttons_get_press(button) != BTNPRESS_REPEAT)
+		return param->step;
+	uint8_t repeats = buttons_get_repeats(button);
+	if(repeats % SETUP_REPEAT_FEEDBACK == 0)
+		ledpattern_push(led_pattern_number_single, 1);
+	return (repeats > SETUP_REPEAT_FAST_AFTER) ? param->step * SETUP_REPEAT_FAST_STEPS : param->step;
+}
+
+//****************************************************************************
+// setup_increase - adds the step to the setting of a menu, the maximum is indicated by blinks
+//****************************************************************************
+void setup_increase(uint8_t from, uint8_t to){
+	(void)to;
+	const setup_param_t *param = &setup_params[from - 1U];
+	int32_t min, max;
+	setup_limits(from, &min, &max);
+	*param->value += setup_step(param, BUTTON_UP);
+	if(*param->value > max){
+		*param->value = max;
+		ledpattern_push(led_pattern_number_single, SETUP_LIMIT_BLINKS);
+	}
+}
+
+//****************************************************************************
+// setup_decrease - subtracts the step from the setting of a menu, reaching the minimum is indicated by blinks
+//****************************************************************************
+void setup_decrease(uint8_t from, uint8_t to){
+	(void)to;
+	const setup_param_t *param = &setup_params[from - 1U];
+	int32_t min, max;
+	setup_limits(from, &min, &max);
+	*param->value -= setup_step(param, BUTTON_DOWN);
+	if(*param->value <= min){
+		*param->value = min;
+		ledpattern_push(led_pattern_number_single, SETUP_LIMIT_BLINKS);
+	}
+}
+
+//****************************************************************************
+// setup_leave - stores the setting of a menu and returns the status LED to the relay state
+//****************************************************************************
+void setup_leave(uint8_t from, uint8_t to){
+	(void)to;
+	switch(setup_params[from - 1U].block){
+		case EEPROM_SETTINGS:
+			write_eeprom_setup();
+			break;
+	}
+	reset_status_led_to_relay_state();
+}
+
+//****************************************************************************
+// setup_set_threshold - sets the threshold of a menu, the other one moves away to keep ADC_HYSTERESIS_MIN
+//****************************************************************************
+void setup_set_threshold(uint8_t state, int32_t value){
+	int32_t *threshold = setup_params[state - 1U].value;
+	int32_t *other = setup_params[((state == SETUP_UPPER_TH) ? SETUP_LOWER_TH : SETUP_UPPER_TH) - 1U].value;
+	// Signed like the thresholds (see setup_limits)
+	const int32_t hysteresis = (int32_t)ADC_HYSTERESIS_MIN;
+	const int32_t limit = (int32_t)ADC_THRESHOLD_MAX;
+	if(value < 0)
+		value = 0;
+	if(value > limit)
+		value = limit;
+	// Near the end of the range the taught threshold gives way instead
+	if(state == SETUP_UPPER_TH){
+		if(value < hysteresis)
+			value = hysteresis;
+		if(*other > value - hysteresis)
+			*other = value - hysteresis;
+	}
+	else{
+		if(value > limit - hysteresis)
+			value = limit - hysteresis;
+		if(*other < value + hysteresis)
+			*other = value + hysteresis;
+	}
+	*threshold = value;
+}
+
+//****************************************************************************
+// setup_capture - saves the current ADC value as the setting of a menu and leaves it (3 blinks as user info)
+//****************************************************************************
+void setup_capture(uint8_t from, uint8_t to){
+	setup_set_threshold(from, (int32_t)setup_channel->value);
+	setup_leave(from, to);
+	ledpattern_push(led_pattern_number_single, SETUP_CAPTURE_BLINKS);
+}
+
+//****************************************************************************
+// setup_instant - guard of the longest press: true if it saves the current value (no teach-in window or sample rate)
+//****************************************************************************
+bool setup_instant(uint8_t state){
+	(void)state;
+	return SETUP_TEACH_TIME == 0 || !SENSOR_STATS || sensor_get_sample_rate() == 0;
+}
+
+//****************************************************************************
+// setup_teach - starts the teach-in of the threshold of a menu: samples for SETUP_TEACH_TIME, the menu stays open meanwhile
+//****************************************************************************
+void setup_teach(uint8_t from, uint8_t to){
+	(void)to;
+	main_state.setup_teaching = sensor_capture_start(SETUP_CHANNEL, SETUP_TEACH_TIME);
+	if(!main_state.setup_teaching){
+		set_setup_state(SETUP_IDLE);
+		setup_capture(from, SETUP_IDLE);
+	}
+}
+
+//****************************************************************************
+// setup_teach_update - ends a complete teach-in: the threshold becomes mean +- SETUP_TEACH_SIGMA of the window and the menu is left (main context, task_ui)
+//****************************************************************************
+void setup_teach_update(void){
+	stats_result_t result;
+	if(!SENSOR_STATS || !sensor_capture_result(SETUP_CHANNEL, &result))
+		return;
+	main_state.setup_teaching = false;
+	uint8_t state = main_state.setup_state;
+	// Standard deviation with half the fractional bits, the distance in quarters of it
+	int32_t mean = (int32_t)((result.mean + (1UL << (STATS_FRAC_BITS - 1U))) >> STATS_FRAC_BITS);
+	int32_t distance = (int32_t)((stats_isqrt(result.variance) * SETUP_TEACH_SIGMA) >> (STATS_FRAC_BITS / 2U + 2U));
+	setup_set_threshold(state, (state == SETUP_UPPER_TH) ? mean + distance : mean - distance);
+	set_setup_state(SETUP_IDLE);
+	setup_leave(state, SETUP_IDLE);
+	ledpattern_push(led_pattern_number_single, SETUP_CAPTURE_BLINKS);
+}
+
+//****************************************************************************
+// setup_change - state change callback of the setup menu state machine
+//****************************************************************************
+void setup_change(uint8_t state){
+	set_setup_state((setup_states)state);
+}
+
+// Transitions of the setup menu by state, the first row with a pending event fires
+const fsm_transition_t setup_transitions[] = {
+	// SETUP_IDLE: a long press of up or down opens the time menu, a short one the upper or the lower threshold menu
+	{SETUP_EVENT_LONG,			SETUP_TIME_TH,	NULL, setup_enter},
+	{SETUP_EVENT_UP_STD,		SETUP_UPPER_TH,	NULL, setup_enter},
+	{SETUP_EVENT_DOWN_STD,		SETUP_LOWER_TH,	NULL, setup_enter},
+	// SETUP_UPPER_TH: a long press leaves, short presses and auto-repeats change the threshold, the longest press of up teaches it (or saves the current ADC value)
+	{SETUP_EVENT_LONG,			SETUP_IDLE,		NULL, setup_leave},
+	{SETUP_EVENT_UP_STD | SETUP_EVENT_UP_REPEAT,		FSM_STAY,	NULL, setup_increase},
+	{SETUP_EVENT_DOWN_STD | SETUP_EVENT_DOWN_REPEAT,	FSM_STAY,	NULL, setup_decrease},
+	{SETUP_EVENT_UP_LONGEST,	SETUP_IDLE,		setup_instant, setup_capture},
+	{SETUP_EVENT_UP_LONGEST,	FSM_STAY,		NULL, setup_teach},
+	// SETUP_LOWER_TH: the same, the longest press of down teaches the lower threshold
+	{SETUP_EVENT_LONG,			SETUP_IDLE,		NULL, setup_leave},
+	{SETUP_EVENT_UP_STD | SETUP_EVENT_UP_REPEAT,		FSM_STAY,	NULL, setup_increase},
+	{SETUP_EVENT_DOWN_STD | SETUP_EVENT_DOWN_REPEAT,	FSM_STAY,	NULL, setup_decrease},
+	{SETUP_EVENT_DOWN_LONGEST,	SETUP_IDLE,		setup_instant, setup_capture},
+	{SETUP_EVENT_DOWN_LONGEST,	FSM_STAY,		NULL, setup_teach},
+	// SETUP_TIME_TH: a long press leaves, short presses and auto-repeats change the threshold exceed time
+	{SETUP_EVENT_LONG,			SETUP_IDLE,		NULL, setup_leave},
+	{SETUP_EVENT_UP_STD | SETUP_EVENT_UP_REPEAT,		FSM_STAY,	NULL, setup_increase},
+	{SETUP_EVENT_DOWN_STD | SETUP_EVENT_DOWN_REPEAT,	FSM_STAY,	NULL, setup_decrease}
+};
+const uint8_t setup_first[] = {0, 3, 8, 13, 16};	// First row per setup_states, number of rows
+const fsm_t setup_fsm = {setup_transitions, setup_first, SETUP_STATE_COUNT, setup_change};
+typedef char setup_tables_check[(sizeof(setup_params) / sizeof(setup_params[0]) == SETUP_STATE_COUNT - 1U && sizeof(setup_first) == SETUP_STATE_COUNT + 1U) ? 1 : -1];
+
+//****************************************************************************
+// manage_setup - setup menu state machine (interprets button presses registered by buttons_update)
+//****************************************************************************
+void manage_setup(void){
+	/// Relay settings handling - Todo auto exit menus after time?, led signal when reaching max?
+	uint16_t events = 0;
+	button_press_states press = buttons_get_press(BUTTON_UP);
+	if(press != BTNPRESS_NOT)
+		events |= SETUP_EVENT_UP(press);
+	press = buttons_get_press(BUTTON_DOWN);
+	if(press != BTNPRESS_NOT)
+		events |= SETUP_EVENT_DOWN(press);
+	// Presses are ignored while a teach-in samples, the menu is left when the window is complete
+	if(main_state.setup_teaching)
+		return;
+	fsm_dispatch(&setup_fsm, main_state.setup_state, events);
+}
+
+//****************************************************************************
+// task_sample - scheduler task: starts the next conversion (result is evaluated by manage_relay when it arrives)
+//****************************************************************************
+void task_sample(void){
+	hal_adc_start();
+}
+
+//****************************************************************************
+// task_ui - scheduler task: buttons and everything reacting to button presses
+//****************************************************************************
+void task_ui(void){
+	FUNCPROF_ENTER();
+	watchdog_checkin(WATCHDOG_UI);
+	PROFILER_START(buttons_start);
+	buttons_update();
+	PROFILER_STOP(PROFILER_BUTTONS, buttons_start);
+
+	// Only interpret presses if one was registered in this pass
+	if(buttons_any_press()){
+		clockscale_activity();
+		quiet_restart();
+		manage_usb();
+		manage_profile();
+		manage_optical();
+		manage_rollback();
+		PROFILER_START(setup_start);
+		manage_setup();
+		PROFILER_STOP(PROFILER_SETUP, setup_start);
+
+		// Reset all button presses
+		buttons_clear_presses();
+	}
+	if(main_state.setup_teaching)
+		setup_teach_update();
+
+	// Full clock while the setup menu is open (also left by timeout)
+	clockscale_hold(CLOCKSCALE_HOLD_SETUP, main_state.setup_state != SETUP_IDLE);
+	FUNCPROF_EXIT(FUNCPROF_TASK_UI);
 }
 
 
@@ -476,9 +2079,20 @@ int switchUSB(USB_states state)
 //****************************************************************************
 int main(void)
 {
+	// Stack high-water mark (painted before DAVE_Init, so its stack use counts too)
+	stackmon_paint();
+
 	// Initialization of DAVE APPs
 	DAVE_STATUS_t status;
 	status = DAVE_Init();
+	// MATH coprocessor clock of parts that have one (divide.h)
+	divide_init();
+	// Interrupt priority tiers (irqprio.h) for the vectors set up by DAVE_Init
+	irqprio_init();
+	// Event trace (records the reset reasons, so before watchdog_init clears them)
+	trace_init();
+	// Event bus between the subsystems (subscriber table in flash, evbus.h)
+	evbus_init(evbus_callback);
 
 	// Error routine
 	if (status != DAVE_STATUS_SUCCESS) {
@@ -494,305 +2108,384 @@ int main(void)
 		}
 	}
 
+	/// - SRAM usage of code, variables and stack (ramcode_usage) and of the arena partitions (arena_usage)
+	ramcode_report();
+	arena_report();
+
+	/// - Status LED (fades are stepped by the PWM period match interrupt, patterns by a deferred SYSTIMER one-shot timer)
+	SYSTIMER_SetDeferredNotify(timer_callback, NULL);
+	if(!ledfade_init())
+		LOG_WARN("Status LED without fades (PWM_CCU4_LED_STATUS not usable)");
+	ledpattern_init();
+
+	/// - Configure sensor acquisition (result accumulation, conversion trigger)
+	sensor_init();
+
+	/// - Microsecond one-shot timers (CCU40 slice 2, slice 1 with TIMEBASE_ENABLED), one expires the latch time of each channel (RELAY_TIMED_LATCH)
+#if RELAY_TIMED_LATCH
+	if(hrtimer_init()){
+		for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
+			main_state.relay_timer[i] = hrtimer_create(relay_timer_callback, &relay_channels[i]);
+	}
+#elif HRTIMER_ENABLED
+	hrtimer_init();
+#endif
+
+	/// - Interrupt free microsecond time base (CCU40 slices 2 and 3 concatenated, continues the SysTick time, TIMEBASE_ENABLED builds only)
+#if TIMEBASE_ENABLED
+	timebase_init(SYSTIMER_GetTime64());
+#endif
+
+	/// - Software PWM of the USB indicators (one more hrtimer, SOFTPWM_ENABLED builds)
+	softpwm_init();
+
+	/// - Function profiler cycle source (CCU40 slice 3, FUNCPROF_ENABLED builds only)
+	funcprof_init();
+
+	/// - Relay coil economiser (CCU40 slice 1, the relay is switched on by relay_update only)
+	coil_init();
+
+	/// - Latching relay coil pulses (one more hrtimer, BISTABLE_ENABLED builds)
+	bistable_init();
+
+	/// - Shift register output expander (USIC0 channel 1, all outputs latched off, EXPANDER_ENABLED board variants only)
+	expander_init();
+
+	/// - Frequency or PWM duty input (CCU40 slice 3, FREQSENSOR_ENABLED board variants only)
+	freqsensor_init();
+
+#if EEBENCH_ENABLED
+	/// - Emulated EEPROM benchmark (measurement builds only, restores the setup afterwards)
+	eebench_run();
+#endif
+#if CONTAINER_BENCH_ENABLED
+	/// - Container benchmark (measurement builds only)
+	container_bench_run();
+#endif
+
+	/// - Factory calibration of this unit (checked once, the defaults of the setup)
+	factory_init();
+
 	/// - Read setup from emulated EEPROM
 	read_eeprom_setup();
+	BOOT_STAMP(BOOT_STAGE_SETUP_READ);
+#if SENSOR_CALIBRATION
+	read_eeprom_calibration();
+#endif
+	/// - Warm reset: the state of the last run replaces the setup just read (also applied changes not stored yet) and keeps the outputs
+	uint8_t retained_states[SENSOR_CHANNEL_COUNT];
+	bool warm = retain_valid();
+	bool restore_states = warm;
+	if(warm){
+		main_state.usb_state = retain_record.usb_state;
+		main_state.profile = retain_record.profile;
+		retain_restore_channels(retained_states);
+	}
 
 	/// - Set initial state -
-	// Enable USB chip and switch to USB1, disable USB2
+	// Enable USB chip and switch to the restored port, power the others off (or all ports off and the chip disabled in standby)
 	DIGITAL_IO_SetOutputLow(&IO_USB_OE);
-	switchUSB(USB_state);
-	// Disable Relay and set LED off
-	DIGITAL_IO_SetOutputLow(&IO_RELAY);
-	PWM_CCU4_SetDutyCycle(&PWM_CCU4_LED_STATUS, PWM_FULL_OFF);
-	// Initialize next value conversion
-	ADC_MEASUREMENT_StartConversion(&ADC_SENSOR);
-
-	int main_loop_count = 0;
-
-	// Main loop
+	usb_switch_init();
+	switchUSB(main_state.usb_state);
+	usb_indicators_update();
+	BOOT_STAMP(BOOT_STAGE_USB_SWITCH);
+	// Disable Relays and set LED off (warm reset: retained states, the LED shows the relay)
+#if BISTABLE_ENABLED && BISTABLE_RESUME
+	// Latching relay: a cold start resumes the stored position of the contacts
+	if(!warm){
+		for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
+			retained_states[i] = RELAY_LOW;
+		restore_states = bistable_stored(&retained_states[RETAIN_RELAY_CHANNEL]);
+	}
+#endif
+	relay_init(restore_states ? retained_states : NULL);
+#if EXPANDER_ENABLED
+	expander_flush();
+#endif
+	// Operate and release time of the relay from its contact feedback (RELAYTIME_ENABLED boards)
+	relaytime_init();
+	if(factory_block() != NULL){
+		relaytime_set_default(true, factory_block()->operate_time);
+		relaytime_set_default(false, factory_block()->release_time);
+	}
+	// Relay changes at mains zero crosses ahead by the operate or release time (one more hrtimer, ZEROCROSS_ENABLED board variants only)
+	zerocross_init();
+	// Hysteresis and debounce of the USB sense channels
+	failover_init();
+#if STIMULUS_ENABLED
+	// Test builds: synthetic input for the thresholds just read instead of the sensor
+	stimulus_config_t stimulus_config;
+	stimulus_scenario(&stimulus_config, STIMULUS_SCENARIO, relay_channels[STIMULUS_CHANNEL].upper_threshold,
+			relay_channels[STIMULUS_CHANNEL].lower_threshold, SENSOR_FREE_RUNNING ? SENSOR_SAMPLE_RATE : (1000U / SAMPLE_TASK_PERIOD));
+	stimulus_init(&stimulus, &stimulus_config, 1);
+#endif
+	// Field trace recorder (keeps the windows recorded before a warm reset)
+	if(RECORDER_ENABLED)
+		recorder_init(sensor_get_sample_rate());
+	ledpattern_set_base(relay_led_pattern(), 0); // Keeps an error indication queued by read_eeprom_setup
+	// Register periodic tasks and start scheduler (tick wakes the main loop)
+#if !SENSOR_FREE_RUNNING
+	scheduler_add_task(task_sample, SAMPLE_TASK_PERIOD, 0);
+#endif
+	main_state.ui_task_id = scheduler_add_task(task_ui, UI_TASK_PERIOD, 1);
+#if !USB_STORE_STATE_LOG
+	scheduler_add_task(manage_usb_save, USB_SAVE_TASK_PERIOD, 2);
+#endif
+	scheduler_add_task(sensor_check_health, SENSOR_HEALTH_PERIOD, 3);
+	clockscale_init();
+	main_state.quiet_deadline = timing_deadline(SYSTIMER_GetTime(), STORAGE_GC_QUIET_TIME);
+	scheduler_add_task(clockscale_task, CLOCKSCALE_TASK_PERIOD, 4);
+	storage_init(eeprom_write_done);
+	bulkflash_init();
+#if RELAYLIFE_ENABLED
+	// Continue the stored contact cycles of the relay (written through the storage queue)
+	relaylife_init();
+	scheduler_add_task(relaylife_task, RELAYLIFE_TASK_PERIOD, 8);
+#endif
+#if WALLCLOCK_ENABLED
+	// Day and night threshold profiles by the wall clock (schedule set by the host)
+	scheduler_add_task(profile_schedule_task, PROFILE_SCHEDULE_PERIOD, 9);
+#endif
+#if RELAY_ADAPT_ENABLED
+	// Latch time from the noise of the last statistics window
+	scheduler_add_task(adapt_latch_task, RELAY_ADAPT_PERIOD, 10);
+#endif
+	supply_init();
+	power_init();
+	// Background CRC scan of the application image (instead of a check at boot)
+	flashcheck_init();
+	// Estimated energy breakdown (on times from here on)
+	energy_init();
+	wallclock_init(alarm_callback);
+#if I2CTARGET_ENABLED
+	// The I2C target takes the channel and pins of the telemetry UART (and its task slot)
+	i2ctarget_init(i2c_map, sizeof(i2c_map) / sizeof(i2c_map[0]), i2c_command);
+	scheduler_add_task(i2ctarget_task, I2CTARGET_TASK_PERIOD, 5);
+#elif SPISTREAM_ENABLED
+	// The SPI stream as well
+	spistream_init();
+	scheduler_add_task(spistream_task, SPISTREAM_TASK_PERIOD, 5);
+#elif MODBUS_ENABLED
+	// The Modbus slave as well (the same commands as the I2C target)
+	modbus_init(modbus_map, sizeof(modbus_map) / sizeof(modbus_map[0]), i2c_command);
+	scheduler_add_task(modbus_task, MODBUS_TASK_PERIOD, 5);
+#elif I2CMASTER_ENABLED
+	// The I2C master as well, it reads the digital sensor by itself (no task)
+	i2cmaster_init();
+	i2csensor_init();
+#elif TELEMETRY_ENABLED
+	telemetry_init();
+	scheduler_add_task(telemetry_task, TELEMETRY_TASK_PERIOD, 5);
+	hostcmd_init(host_command, host_timed_wakeup);
+	scheduler_add_task(hostcmd_task, HOSTCMD_TASK_PERIOD, 6);
+#endif
+#if CAPTURE_ENABLED
+	scheduler_add_task(capture_task, CAPTURE_TASK_PERIOD, 7);
+#endif
+	scheduler_init(wakeup_callback);
+	// Start button edge capture (edges wake the main loop and trigger the UI task)
+	buttons_init(button_callback);
+	// Comparator fast path of the threshold detection (ACMP parts only, ACMP_ENABLED)
+	acmp_init(comparator_callback);
+	// Live status block at its fixed address for a debug probe (metrics table and trace ring are set up by now)
+	livestatus_init();
+	// Supervise the loop and the tasks from here on (WDT)
+	watchdog_init();
+#if STORM_ENABLED
+	// Interrupt storm benchmark on top of the normal operation (measurement builds only, ends on its own)
+	storm_start(write_eeprom_setup);
+#endif
+
+#if PROFILER_ENABLED
+	uint32_t loop_pass_start_last = profiler_timestamp();
+#endif
+
+	// Main loop (event driven - sleeps until the scheduler or the ADC result interrupt posts work)
 	while(1U)
 	{
-		// - Status LED handling -
-		manage_status_led();
-		main_loop_count++;
-		systime_debug = SYSTIMER_GetTime();
-
-		//// - Button handling -
-		manage_buttons();
-
-		/// - USB Channel handling -
-		// Save state of USB if necessary (Enabled and timeout since state change happened)
-		if(usb_changed_timestamp != 0 && ((SYSTIMER_GetTime() - usb_changed_timestamp)/1000) > USB_STORE_STATE_EEPROM_DELAY){
-			usb_changed_timestamp = 0;
-			if(USB_STORE_STATE_EEPROM)
-				write_eeprom(EEPROM_USB_STATE, (uint32_t)USB_state, 4);
+		wait_for_event();
+		// One time sample, input snapshot and set of channel values for the whole pass (frame.h)
+		frame_capture(&main_frame, take_events());
+		const frame_t *frame = &main_frame;
+		PROFILER_START(loop_pass_start);
+		watchdog_checkin(WATCHDOG_LOOP);
+#if PROFILER_ENABLED
+		profiler_record(PROFILER_LOOP_PERIOD, loop_pass_start - loop_pass_start_last);
+		loop_pass_start_last = loop_pass_start;
+#endif
+
+#if RELAY_FAULT_ENABLED
+		// - Sensor faults - (the ADC interrupt already drove the safe state, only the follow-up is left)
+		if(frame->events & EVENT_SENSOR_FAULT){
+			critical_state_t primask = critical_enter();
+			uint32_t faulted = main_state.relay_faulted;
+			main_state.relay_faulted = 0;
+			critical_exit(primask, CRITICAL_SITE_EVENTS);
+			for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+				if(faulted & (1U << i))
+					relay_followup(&relay_channels[i], relay_channels[i].fault_time);
+			}
 		}
-		// USB state machine
-		switch (USB_state){
-			case USB_1_active:
-				// State code - none atm
-
-				// Transition statement
-				if(buttonpress_usb == BTNPRESS_STD){
-					USB_state = USB_2_active;
-					switchUSB(USB_state);
-					buttonpress_usb = BTNPRESS_NOT;
-					usb_changed_timestamp = SYSTIMER_GetTime();
-				}
-				break;
-			case USB_2_active:
-				// State code - none atm
-
-				// Transition statement
-				if(buttonpress_usb == BTNPRESS_STD){
-					USB_state = USB_1_active;
-					switchUSB(USB_state);
-					buttonpress_usb = BTNPRESS_NOT;
-					usb_changed_timestamp = SYSTIMER_GetTime();
+#endif
+
+		// - Relay handling - (threshold crossings are evaluated immediately, afterwards only while the latch time is running)
+#if RELAY_IN_ISR || RELAY_TIMED_LATCH
+		// The ADC interrupt or a latch timer already switched the outputs, only the follow-up is left (at the switch time of the channel)
+		if(frame->events & EVENT_RELAY_SWITCHED){
+			critical_state_t primask = critical_enter();
+			uint32_t switched = main_state.relay_switched;
+			main_state.relay_switched = 0;
+			critical_exit(primask, CRITICAL_SITE_EVENTS);
+			for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+				if(switched & (1U << i))
+					relay_followup(&relay_channels[i], relay_channels[i].switch_time);
+			}
+		}
+#endif
+#if ADC_BOUNDARY_EVENTS && !RELAY_IN_ISR
+		PROFILER_START(relay_start);
+#if RELAY_TIMED_LATCH
+		main_state.relay_evaluating = true;
+#endif
+		if(frame->events & EVENT_ADC_BOUNDARY)
+			FIELDHIST_ADD(SAMPLE_AGE, frame->now - main_state.boundary_time);
+		for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+			relay_channel_t *channel = &relay_channels[i];
+			if((frame->events & EVENT_ADC_BOUNDARY) || relay_latch_running(channel))
+				manage_relay(channel, frame->values[i], frame->now);
+		}
+#if RELAY_TIMED_LATCH
+		main_state.relay_evaluating = false;
+		// Latch times still running are expired by their timer, not by the next wake-up of the loop
+		relay_timers_update();
+#endif
+		PROFILER_STOP(PROFILER_RELAY, relay_start);
+#elif !RELAY_IN_ISR
+		// Every queued sample is evaluated (drained in batches)
+		if(frame->events & EVENT_ADC_RESULT){
+			sensor_sample_t samples[SENSOR_BATCH_SIZE];
+			uint8_t count;
+			PROFILER_START(relay_start);
+			while((count = sensor_read(samples, SENSOR_BATCH_SIZE)) != 0){
+				uint32_t decision_time = SYSTIMER_GetTimeUs();
+				for(uint8_t i = 0; i < count; i++){
+					FIELDHIST_ADD(SAMPLE_AGE, decision_time - samples[i].timestamp);
+					manage_relay(&relay_channels[samples[i].channel], samples[i].value, samples[i].timestamp);
 				}
-				break;
-			case USB_inactive:
-				// Currently not implemented!
-				break;
+			}
+			PROFILER_STOP(PROFILER_RELAY, relay_start);
+		}
+#endif
+#if EXPANDER_ENABLED
+		// - Output expander - (one frame latches every chain output changed above or by an interrupt since the last pass)
+		expander_flush();
+#endif
+
+		ADC_POLL();
+
+		// - Event bus - (subscribers of the switches above and of the events posted by interrupts, EVENT_BUS only wakes the loop)
+		evbus_dispatch();
+
+		// - Deferred timer callbacks - (status LED pattern steps)
+		if(frame->events & EVENT_TIMER)
+			SYSTIMER_DispatchDeferred();
+
+		// - Timed USB switch - (wall clock alarm set by the host, resumes the last port from standby)
+		if(frame->events & EVENT_ALARM)
+			select_usb(usb_next_port(main_state.usb_state));
+		ADC_POLL();
+
+		// - Timed host command - (HOSTCMD_AT, every unit of a broadcast runs it in the same pass time)
+#if TELEMETRY_ENABLED
+		if(frame->events & EVENT_HOST_TIMED)
+			hostcmd_run();
+#endif
+
+		// - USB port selected by the host -
+		if(frame->events & EVENT_USB_REQUEST)
+			select_usb(main_state.usb_host_request);
+
+		// - Threshold profile selected by the host - (a request while the setup menu is open is dropped)
+		if(frame->events & EVENT_PROFILE_REQUEST)
+			select_profile(main_state.profile_host_request);
+
+		// - Settings record selected by the host - (applied in RAM only, a request while the setup menu is open is dropped)
+		if(frame->events & EVENT_ROLLBACK_REQUEST)
+			rollback_settings(main_state.rollback_host_request);
+
+		// - Periodic tasks - (sampling, status LED, buttons/setup, USB save, sensor health)
+		scheduler_run();
+		ADC_POLL();
+
+		// - Warm reset state - (settings and filters, switches and USB port changes are saved at once)
+		if(retain_refresh_due(frame->now))
+			retain_state();
+
+		// - Flash integrity - (one slice of the background CRC scan per FLASHCHECK_SLICE_PERIOD, idle passes only)
+		if(main_state.pending_events == 0 && !relay_any_latch_running())
+			flashcheck_step(frame->now);
+
+		// - Energy estimate - (on times of the consumers per ENERGY_STEP_PERIOD, idle passes only)
+		if(main_state.pending_events == 0 && !relay_any_latch_running())
+			energy_step(frame);
+
+		// A flash write step starts right after the result register was emptied (a whole conversion period ahead)
+		ADC_POLL();
+
+		// - Deferred flash writes - (one state log entry, EEPROM block, factory block or bulk flash step and only in an idle pass, so flash programming never delays relay switching, not while the supply is failing)
+		if(main_state.pending_events == 0 && !relay_any_latch_running() && supply_flash_allowed()){
+			// Planned garbage collection: requested in a quiet period while the bank is close to full (a latched quiet flag, the deadline would wrap)
+			if(!main_state.quiet && timing_reached(frame->now, main_state.quiet_deadline))
+				main_state.quiet = true;
+			if(main_state.quiet && main_state.setup_state == SETUP_IDLE)
+				storage_plan_gc();
+			// A step blocks the loop up to a bank erase, longer than WATCHDOG_LOOP_DEADLINE
+			watchdog_hold(WATCHDOG_FLASH_HOLD);
+			ENERGY_FLASH_START(flash_start);
+			// The factory block is only written by host commands (telemetry UART)
+			if(!(USB_STORE_STATE_LOG && statelog_flush()) && !storage_flush() && !(TELEMETRY_ENABLED && factory_flush()))
+				bulkflash_flush();
+			ENERGY_FLASH_STOP(flash_start);
 		}
 
-		/// - Relay handling -
-		// Check for state change triggers based on current state
-		switch (relay_state){
-			case RELAY_LOW:
-				// State code
-				// Check if upper threshold is exceeded. If it is and timestamp is not already set - save timestamp. If timestamp is already saved and threshold is not exceeded anymore reset timestamp
-				if     (ADC_val_upper_thres_exceed_timestamp == 0 && ADC_val_current > ADC_upper_threshold){
-					ADC_val_upper_thres_exceed_timestamp = SYSTIMER_GetTime();
-				}
-				else if(ADC_val_upper_thres_exceed_timestamp != 0 && ADC_val_current < ADC_upper_threshold){
-					ADC_val_upper_thres_exceed_timestamp = 0;
-				}
+		// - Firmware update - (requested by the host, queued flash writes are completed first)
+		if(TELEMETRY_ENABLED && main_state.update_pending && telemetry_sent() && !storage_pending() && !statelog_pending() && !bulkflash_pending() && !factory_pending()){
+			retain_clear(); // The new firmware starts cold
+			updater_restart();
+		}
 
-				// Transition statement
-				// Check if threshold are exceeded long enough to trigger a switch
-				if(ADC_val_upper_thres_exceed_timestamp != 0){
-					uint16_t upperThresholdExceedDuration = (SYSTIMER_GetTime() - ADC_val_upper_thres_exceed_timestamp)/1000;
-					if(upperThresholdExceedDuration > relay_threshold_latchtime){
-						relay_state = RELAY_HIGH;
-						DIGITAL_IO_SetOutputHigh(&IO_RELAY);
-						ADC_val_upper_thres_exceed_timestamp = 0;
-						if(setup_state == SETUP_IDLE)
-							reset_status_led_to_relay_state();
-					}
-				}
-				break;
-			case RELAY_HIGH:
-				// State code
-				// Check if lower threshold is exceeded. If it is and timestamp is not already set - save timestamp. If timestamp is already saved and threshold is not exceeded anymore reset timestamp
-				if(ADC_val_lower_thres_exceed_timestamp == 0 && ADC_val_current < ADC_lower_threshold){
-					ADC_val_lower_thres_exceed_timestamp = SYSTIMER_GetTime();
-				}
-				else if(ADC_val_lower_thres_exceed_timestamp != 0 && ADC_val_current > ADC_lower_threshold){
-					ADC_val_lower_thres_exceed_timestamp = 0;
-				}
+		ADC_POLL();
 
-				// Transition statement
-				// Check if threshold are exceeded long enough to trigger a switch
-				if(ADC_val_lower_thres_exceed_timestamp != 0){
-					uint16_t lowerThresholdExceedDuration = (SYSTIMER_GetTime() - ADC_val_lower_thres_exceed_timestamp)/1000;
-					if(lowerThresholdExceedDuration > relay_threshold_latchtime){
-						relay_state = RELAY_LOW;
-						DIGITAL_IO_SetOutputLow(&IO_RELAY);
-						ADC_val_lower_thres_exceed_timestamp = 0;
-						if(setup_state == SETUP_IDLE)
-							reset_status_led_to_relay_state();
-					}
-				}
-				break;
-		}
-		// Init next value conversion
-		ADC_MEASUREMENT_StartConversion(&ADC_SENSOR);
-
-		/// - Relay settings handling - Todo auto exit menus after time?, led signal when reaching max?, upper threshold cant be lower than lower threshold?
-		switch(setup_state){
-			case SETUP_IDLE:
-				/// Interpret button press and change to according setup sub-menu (state)
-				// A long  press of up or down brings system in time setup menu
-				// A short press of up         brings system in upper threshold setup menu
-				// A short press of down       brings system in lower threshold setup menu
-				if(buttonpress_up == BTNPRESS_LONG || buttonpress_down == BTNPRESS_LONG){
-					setup_state = SETUP_TIME_TH;
-					led_status_pattern = LED_NUMBER;
-					led_number_continuous = 1;
-				}
-				else if(buttonpress_up == BTNPRESS_STD){
-					setup_state = SETUP_UPPER_TH;
-					led_status_pattern = LED_FADE_UP;
-					//led_status_pattern = LED_NUMBER;
-					//led_number_continuous = 5;
-				}
-				else if(buttonpress_down == BTNPRESS_STD){
-					setup_state = SETUP_LOWER_TH;
-					led_status_pattern = LED_FADE_DOWN;
-					//led_status_pattern = LED_NUMBER;
-					//led_number_continuous = 3;
-				}
-				break;
-			case SETUP_UPPER_TH:
-				// Blink relay LED
-
-				/// Interpret button press:
-				// A long  press of up or down brings system back to setup idle
-				// A short press of up         increases the upper threshold value
-				// A short press of down       decreases the upper threshold value
-				// A longest press of up saves the current ADC value as threshold
-				if(buttonpress_up == BTNPRESS_LONG || buttonpress_down == BTNPRESS_LONG){
-					write_eeprom(EEPROM_UPPER_TH, ADC_upper_threshold, 4);
-					setup_state = SETUP_IDLE;
-					led_status_pattern = LED_MATCH_RELAY_STATE;
-				}
-				else if(buttonpress_up == BTNPRESS_STD){ // Increase
-					ADC_upper_threshold += ADC_THRESHOLD_INCREMENT;
-					// If maximum is reached blink led 2 times, then continue fading
-					if(ADC_upper_threshold > ADC_THRESHOLD_MAX){
-						ADC_upper_threshold = ADC_THRESHOLD_MAX;
-						led_number_single = 2;
-						led_status_pattern = LED_NUMBER;
-						led_pattern_mode = LED_PATTERN_SINGLE;
-						led_status_pattern_after_single = LED_FADE_UP;
-					}
-				}
-				else if(buttonpress_down == BTNPRESS_STD){ // Decrease
-					ADC_upper_threshold -= ADC_THRESHOLD_INCREMENT;
-					// If minimum is reached blink led 2 times, then continue fading
-					if(ADC_upper_threshold <= 0){
-						ADC_upper_threshold = 0;
-						led_number_single = 2;
-						led_status_pattern = LED_NUMBER;
-						led_pattern_mode = LED_PATTERN_SINGLE;
-						led_status_pattern_after_single = LED_FADE_UP;
-					}
-					//if(ADC_upper_threshold <= ADC_lower_threshold)
-						//ADC_upper_threshold = ADC_lower_threshold;
-				}
-				else if(buttonpress_up == BTNPRESS_LONGEST){
-					// Save current ADC value as threshold and exit setup menu
-					ADC_upper_threshold = ADC_val_current;
-					write_eeprom(EEPROM_UPPER_TH, ADC_upper_threshold, 4);
-					setup_state = SETUP_IDLE;
-					// Blink LED 3 times (user info) and return to operation where led matches the state of the relay
-					led_number_single = 3;
-					led_status_pattern = LED_NUMBER;
-					led_pattern_mode = LED_PATTERN_SINGLE;
-					led_status_pattern_after_single = LED_MATCH_RELAY_STATE;
-				}
-				break;
-			case SETUP_LOWER_TH:
-				// Blink relay LED
-
-				/// Interpret button press:
-				// A long  press of up or down brings system back to setup idle
-				// A short press of up         increases the lower threshold value
-				// A short press of down       decreases the lower threshold value
-				// A longest press of down saves the current ADC value as threshold
-				if(buttonpress_up == BTNPRESS_LONG || buttonpress_down == BTNPRESS_LONG){
-					write_eeprom(EEPROM_LOWER_TH, ADC_lower_threshold, 4);
-					setup_state = SETUP_IDLE;
-					led_status_pattern = LED_MATCH_RELAY_STATE;
-				}
-				else if(buttonpress_up == BTNPRESS_STD){ // Increase
-					ADC_lower_threshold += ADC_THRESHOLD_INCREMENT;
-					// If maximum is reached blink led 2 times, then continue fading
-					if(ADC_lower_threshold > ADC_THRESHOLD_MAX){
-						ADC_lower_threshold = ADC_THRESHOLD_MAX;
-						led_number_single = 2;
-						led_status_pattern = LED_NUMBER;
-						led_pattern_mode = LED_PATTERN_SINGLE;
-						led_status_pattern_after_single = LED_FADE_DOWN;
-					}
-				}
-				else if(buttonpress_down == BTNPRESS_STD){ // Decrease
-					ADC_lower_threshold -= ADC_THRESHOLD_INCREMENT;
-					// If minimum is reached blink led 2 times, then continue fading
-					if(ADC_lower_threshold <= 0){
-						ADC_lower_threshold = 0;
-						led_number_single = 2;
-						led_status_pattern = LED_NUMBER;
-						led_pattern_mode = LED_PATTERN_SINGLE;
-						led_status_pattern_after_single = LED_FADE_DOWN;
-					}
-				}
-				else if(buttonpress_down == BTNPRESS_LONGEST){
-					// Save current ADC value as threshold
-					ADC_lower_threshold = ADC_val_current;
-					write_eeprom(EEPROM_LOWER_TH, ADC_lower_threshold, 4);
-					setup_state = SETUP_IDLE;
-					// Blink LED 3 times (user info) and return to operation where led matches the state of the relay
-					led_number_single = 3;
-					led_status_pattern = LED_NUMBER;
-					led_pattern_mode = LED_PATTERN_SINGLE;
-					led_status_pattern_after_single = LED_MATCH_RELAY_STATE;
-				}
-				break;
-			case SETUP_TIME_TH:
-				/// Interpret button press:
-				// A long  press of up or down brings system back to setup idle
-				// A short press of up         increases the threshold exceed time
-				// A short press of down       decreases the threshold exceed time
-				if(buttonpress_up == BTNPRESS_LONG || buttonpress_down == BTNPRESS_LONG){
-					write_eeprom(EEPROM_LATCHTIME, relay_threshold_latchtime, 4);
-					setup_state = SETUP_IDLE;
-					led_status_pattern = LED_MATCH_RELAY_STATE;
-				}
-				else if(buttonpress_up == BTNPRESS_STD){
-					relay_threshold_latchtime += RELAY_LATCHTIME_INCREMENT;
-					if(relay_threshold_latchtime > RELAY_LATCHTIME_MAX){
-						relay_threshold_latchtime = RELAY_LATCHTIME_MAX;
-						led_number_single = 2;
-						led_status_pattern = LED_NUMBER;
-						led_pattern_mode = LED_PATTERN_SINGLE;
-						led_status_pattern_after_single = LED_NUMBER;
-					}
-				}
-				else if(buttonpress_down == BTNPRESS_STD){
-					relay_threshold_latchtime -= RELAY_LATCHTIME_INCREMENT;
-					if(relay_threshold_latchtime <= 0){
-						relay_threshold_latchtime = 0;
-						led_number_single = 2;
-						led_status_pattern = LED_NUMBER;
-						led_pattern_mode = LED_PATTERN_SINGLE;
-						led_status_pattern_after_single = LED_NUMBER;
-					}
-				}
-				break;
-		}
+		// - Optical readout - (frames the next record for the status LED while it runs)
+		optical_poll();
 
-		// Reset all button presses
-		buttonpress_usb = BTNPRESS_NOT;
-		buttonpress_up = BTNPRESS_NOT;
-		buttonpress_down = BTNPRESS_NOT;
-	}
-}
+		// - Stack high-water mark - (a few words per pass)
+		stackmon_scan();
 
-int meas_invalid_count = 0;
+#if STORM_ENABLED
+		// - Interrupt storm - (keeps the transmit ring full and queues the EEPROM writes of the benchmark)
+		storm_step(frame->now);
+#endif
 
-void Adc_Measurement_Handler()
-{
-	//uint8_t channel_num;
-	//uint8_t group_num;
-	uint32_t adc_register;
+#if FAILOVER_ENABLED
+		// - Failover hold-off - (a sense channel drop within the hold-off of the last switch is taken when it ends)
+		USB_states failover_port = failover_poll(main_state.usb_state, frame->now);
+		if(failover_port != main_state.usb_state)
+			select_usb(failover_port);
+#endif
 
-	#if(UC_SERIES == XMC11)
-	adc_register = ADC_MEASUREMENT_GetGlobalDetailedResult();
-	#endif
+		// - Threshold snapshot - (thresholds and latch time changed by this pass, one index switch per channel for the interrupts)
+		relay_publish();
 
-	if((bool)(adc_register >> VADC_GLOBRES_VF_Pos))
-	{
-		//channel_num = (adc_register & VADC_GLOBRES_CHNR_Msk) >> VADC_GLOBRES_CHNR_Pos;
-		//group_num = ADC_MEASUREMENT_Channel_A.group_index;
-		ADC_val_current = (adc_register & VADC_GLOBRES_RESULT_Msk) >> ((uint32_t)(ADC_SENSOR.iclass_config_handle->conversion_mode_standard) * (uint32_t)2);
-	}
-	else{
-		meas_invalid_count++;
-	}
+		// - Output image - (status LED compare values staged by the handlers of this pass, one shadow transfer request)
+		outputs_commit();
 
-	//	ADC_val_current = ADC_MEASUREMENT_GetGlobalResult();
-	//	ADC_val_current = ADC_val_current >> ((uint32_t)ADC_SENSOR.iclass_config_handle->conversion_mode_standard * (uint32_t)2);
-}
+		// - Live status - (fixed address block a debug probe streams without halting the target)
+		livestatus_update(frame, main_state.usb_state, main_state.setup_state, main_state.profile);
 
+		// - Watchdog - (serviced only while all subsystems met their deadlines)
+		watchdog_service();
+
+		PROFILER_STOP(PROFILER_LOOP_PASS, loop_pass_start);
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * USB-Changer metrics.c
+ *
+ * Metrics table access (see metrics.h). The table is whatever the linker collected into .metrics, in link order.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "metrics.h"
+#include "hostcmd.h"
+
+typedef char metrics_response_check[(2 + METRICS_VALUES_MAX * 4 <= HOSTCMD_RESPONSE_MAX) ? 1 : -1];
+
+extern const metrics_entry_t metrics_start[];	// Linker script
+extern const metrics_entry_t metrics_end[];
+
+
+//****************************************************************************
+// metrics_count - returns the number of registered metrics
+//****************************************************************************
+uint8_t metrics_count(void){
+	return (uint8_t)(metrics_end - metrics_start);
+}
+
+//****************************************************************************
+// metrics_find - returns the table index of a metric id (METRICS_NONE if it is not registered)
+//****************************************************************************
+uint8_t metrics_find(uint16_t id){
+	uint8_t count = metrics_count();
+	for(uint8_t index = 0; index < count; index++){
+		if(metrics_start[index].id == id)
+			return index;
+	}
+	return METRICS_NONE;
+}
+
+//****************************************************************************
+// metrics_get_entry - returns the table entry at index (below metrics_count)
+//****************************************************************************
+const metrics_entry_t *metrics_get_entry(uint8_t index){
+	return &metrics_start[index];
+}
+
+//****************************************************************************
+// metrics_value - returns the current value of an entry (signed types sign extended)
+//****************************************************************************
+uint32_t metrics_value(const metrics_entry_t *entry){
+	switch(entry->type){
+		case METRICS_TYPE_U8:
+			return *(const volatile uint8_t *)entry->value;
+		case METRICS_TYPE_U16:
+			return *(const volatile uint16_t *)entry->value;
+		case METRICS_TYPE_U32:
+		case METRICS_TYPE_S32:
+			return *(const volatile uint32_t *)entry->value;
+		default:
+			return 0;
+	}
+}
+
+//****************************************************************************
+// metrics_list - writes [count][first]([id (2)][type][unit]) * n from entry first on. Returns the response length
+//****************************************************************************
+uint8_t metrics_list(uint8_t first, uint8_t *response){
+	uint8_t count = metrics_count();
+	uint8_t *p = &response[2];
+
+	response[0] = count;
+	response[1] = first;
+	for(uint8_t index = first; index < count && index - first < METRICS_VALUES_MAX; index++){
+		p = telemetry_put16(p, metrics_start[index].id);
+		*p++ = metrics_start[index].type;
+		*p++ = metrics_start[index].unit;
+	}
+	return (uint8_t)(p - response);
+}
+
+//****************************************************************************
+// metrics_read - writes [count][first]([value (4)]) * n from entry first on. Returns the response length
+//****************************************************************************
+uint8_t metrics_read(uint8_t first, uint8_t *response){
+	uint8_t count = metrics_count();
+	uint8_t *p = &response[2];
+
+	response[0] = count;
+	response[1] = first;
+	// 32 bit loads are single accesses, every value is consistent in itself (not a snapshot of all together)
+	for(uint8_t index = first; index < count && index - first < METRICS_VALUES_MAX; index++)
+		p = telemetry_put32(p, metrics_value(&metrics_start[index]));
+	return (uint8_t)(p - response);
+}
@@ -0,0 +1,123 @@
+/*
+ * USB-Changer metrics.h
+ *
+ * Registry of the counters and measurements the host can read without knowing the firmware. A module registers a
+ * variable with METRICS_REGISTER next to its definition: the macro places a const metrics_entry_t (id, type, unit,
+ * address) in the section .metrics, which the linker script collects into one table in flash between metrics_start and
+ * metrics_end. Registration costs no code and no RAM, only the 8 flash bytes of the entry, and a new metric needs no
+ * change outside its module except its id below. Without METRICS_ENABLED the table is empty (the readers see no
+ * entries) and its flash is saved.
+ * The host enumerates the table with HOSTCMD_METRICS_LIST and reads the values with HOSTCMD_METRICS_READ, both as many
+ * entries per response as fit from a start index on (see hostcmd.h). The ids are stable across firmware versions: a
+ * removed metric leaves a gap, a new one takes the next free id, so tools keep their id -> name table.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define METRICS_ENABLED				 0							// Determines if METRICS_REGISTER places entries in the table (needed by the host readers, see main.c)
+#define METRICS_VALUES_MAX			 14							// Entries per response ([count][first] and 4 bytes each in HOSTCMD_RESPONSE_MAX)
+#define METRICS_NONE				 0xFFU						// metrics_find: id not registered
+
+// Type of an enum variable (arm-none-eabi packs enums into the smallest fitting type)
+#define METRICS_TYPE_ENUM(variable)	 ((sizeof(variable) == 1) ? METRICS_TYPE_U8 : (sizeof(variable) == 2) ? METRICS_TYPE_U16 : METRICS_TYPE_U32)
+
+typedef enum {
+	METRICS_TYPE_U8,
+	METRICS_TYPE_U16,
+	METRICS_TYPE_U32,
+	METRICS_TYPE_S32
+} metrics_types;
+
+typedef enum {
+	METRICS_UNIT_COUNT,				// Events since reset
+	METRICS_UNIT_US,
+	METRICS_UNIT_MS,
+	METRICS_UNIT_ADC,				// ADC value
+	METRICS_UNIT_BYTES,
+	METRICS_UNIT_CYCLES,			// Cycles of SYSTIMER_SYSTICK_CLOCK
+	METRICS_UNIT_MJ,				// Estimated energy in mJ
+	METRICS_UNIT_STATE				// Value of a state enum (relay_states, USB_states)
+} metrics_units;
+
+// Ids of the registered metrics (never reused, the host keeps the names)
+typedef enum {
+	METRICS_ID_SENSOR_RESULTS = 1,
+	METRICS_ID_SENSOR_INVALID,
+	METRICS_ID_SENSOR_OVERRUNS,
+	METRICS_ID_HOSTCMD_REQUESTS,
+	METRICS_ID_HOSTCMD_BAD_FRAMES,
+	METRICS_ID_TELEMETRY_DROPPED,
+	METRICS_ID_TELEMETRY_RX_OVERFLOWS,
+	METRICS_ID_LOG_DROPPED,
+	METRICS_ID_STORAGE_WRITES,
+	METRICS_ID_STORAGE_FAILURES,
+	METRICS_ID_STATELOG_WRITES,
+	METRICS_ID_BULKFLASH_PAGES,
+	METRICS_ID_BULKFLASH_FAILURES,
+	METRICS_ID_RELAY_CYCLES,
+	METRICS_ID_RELAY_FAULTS,
+	METRICS_ID_RELAY_OPERATE_TIME,
+	METRICS_ID_RELAY_RELEASE_TIME,
+	METRICS_ID_FAILOVER_COUNT,
+	METRICS_ID_STACK_HIGH_WATER,
+	METRICS_ID_HEAP_USED,
+	METRICS_ID_CRITICAL_MAX,
+	METRICS_ID_CRITICAL_OVER_BUDGET,
+	METRICS_ID_EVBUS_DROPPED,
+	METRICS_ID_FLASHCHECK_PASSES,
+	METRICS_ID_FLASHCHECK_ERRORS,
+	METRICS_ID_MODBUS_REQUESTS,
+	METRICS_ID_MODBUS_CRC_ERRORS,
+	METRICS_ID_MODBUS_EXCEPTIONS,
+	METRICS_ID_ENERGY_TOTAL,
+	METRICS_ID_ENERGY_ACTIVE_TIME,
+	METRICS_ID_ENERGY_SLEEP_TIME,
+	METRICS_ID_RELAY_STATE,
+	METRICS_ID_USB_STATE,
+	METRICS_ID_UPPER_THRESHOLD,
+	METRICS_ID_LOWER_THRESHOLD,
+	METRICS_ID_SENSOR_RATE_SHIFT,
+	METRICS_ID_STORAGE_GC_PLANNED,
+	METRICS_ID_STORAGE_GC_FORCED,
+	METRICS_ID_FREQSENSOR_PERIOD,
+	METRICS_ID_I2CMASTER_ERRORS,
+	METRICS_ID_HIST_RELAY_LATENCY,								// Bucket 0 of each histogram of fieldhist.h, FIELDHIST_BUCKETS ids each
+	METRICS_ID_HIST_USB_LATENCY = METRICS_ID_HIST_RELAY_LATENCY + 8,
+	METRICS_ID_HIST_SAMPLE_AGE = METRICS_ID_HIST_USB_LATENCY + 8,
+	METRICS_ID_HIST_EEPROM_BLOCKING = METRICS_ID_HIST_SAMPLE_AGE + 8,
+	METRICS_ID_HIST_LAST = METRICS_ID_HIST_EEPROM_BLOCKING + 7,		// Last bucket (a new metric takes the id after it)
+	METRICS_ID_HOSTBUS_FRAMES,
+	METRICS_ID_HOSTBUS_FILTERED,
+	METRICS_ID_USB_SWITCH_OVERFLOWS
+} metrics_ids;
+
+typedef struct {
+	uint16_t id;					// metrics_ids
+	uint8_t type;					// metrics_types
+	uint8_t unit;					// metrics_units
+	const volatile void *value;		// Registered variable
+} metrics_entry_t;
+
+// Adds a variable to the metrics table (file scope, the entry name only has to be unique)
+#if METRICS_ENABLED
+#define METRICS_REGISTER(name, id, type, unit, variable) \
+	const metrics_entry_t metrics_entry_##name __attribute__((section(".metrics"), used)) = {(id), (type), (unit), &(variable)}
+#else
+#define METRICS_REGISTER(name, id, type, unit, variable) \
+	extern const metrics_entry_t metrics_entry_##name
+#endif
+
+uint8_t metrics_count(void);
+uint8_t metrics_find(uint16_t id);
+const metrics_entry_t *metrics_get_entry(uint8_t index);
+uint32_t metrics_value(const metrics_entry_t *entry);
+uint8_t metrics_list(uint8_t first, uint8_t *response);
+uint8_t metrics_read(uint8_t first, uint8_t *response);
+
+#endif /* METRICS_H */
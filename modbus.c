@@ -0,0 +1,416 @@
+/*
+ * USB-Changer modbus.c
+ *
+ * Modbus RTU slave (see modbus.h). One buffer holds the request and then the response built over it: bytes that arrive
+ * while a response is moved into the transmit FIFO are dropped (the master waits for the response), the frame timer
+ * is restarted by every other received byte. The interrupt looks every register address up in the map (a few entries).
+ * The baud rate generator runs from MCLK with a fixed fractional step like the telemetry UART, clockscale changes only
+ * multiply the step (modbus_set_clock_shift), the hrtimer keeps t3.5 by itself.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_uart.h"
+#include "modbus.h"
+#include "telemetry.h"
+#include "i2ctarget.h"
+#include "spistream.h"
+#include "hrtimer.h"
+#include "clockscale.h"
+#include "metrics.h"
+
+#if MODBUS_ENABLED && (TELEMETRY_ENABLED || I2CTARGET_ENABLED || SPISTREAM_ENABLED)
+#error "The Modbus slave shares USIC0 channel 0 and its pins with the telemetry UART, the I2C target and the SPI stream"
+#endif
+
+#define MODBUS_CHANNEL				 XMC_UART0_CH0
+#define MODBUS_IRQ					 USIC0_3_IRQn
+#define MODBUS_SR					 3U							// Service request of both FIFO events (SR3 = USIC0_3_IRQn)
+#define MODBUS_OVERSAMPLING			 16U
+#define MODBUS_FIFO_SIZE			 16U						// In words. Transmit FIFO at DPTR 0, receive FIFO behind it
+// Fractional divider step at the full clock (fFD = MCLK * step / 1024, baud = fFD / oversampling)
+#define MODBUS_STEP					 (((MODBUS_BAUDRATE * MODBUS_OVERSAMPLING * 1024ULL) + (SYSTIMER_SYSTICK_CLOCK / 2U)) / SYSTIMER_SYSTICK_CLOCK)
+#define MODBUS_CHARACTER_BITS		 11U						// Start bit, 8 data bits, parity, stop bit
+// In us. Silence that ends a frame (3.5 characters, fixed above 19200 baud by the Modbus serial line specification)
+#define MODBUS_T35_US				 ((MODBUS_BAUDRATE > 19200U) ? 1750U : ((35U * MODBUS_CHARACTER_BITS * 1000000U + 10U * MODBUS_BAUDRATE - 1U) / (10U * MODBUS_BAUDRATE)))
+#define MODBUS_CRC_INIT				 0xFFFFU
+#define MODBUS_BROADCAST			 0U
+#define MODBUS_FRAME_MAX			 (3U + 2U * MODBUS_READ_MAX + 2U)	// In bytes. Longest read response (address, function, byte count, registers, CRC)
+#define MODBUS_WRITE_FRAME			 (9U + 2U * MODBUS_WRITE_MAX)		// In bytes. Longest write multiple request
+
+#define MODBUS_READ_HOLDING			 0x03U						// Function codes
+#define MODBUS_READ_INPUT			 0x04U
+#define MODBUS_WRITE_SINGLE			 0x06U
+#define MODBUS_WRITE_MULTIPLE		 0x10U
+#define MODBUS_EXCEPTION			 0x80U						// Added to the function code of an exception response
+#define MODBUS_ILLEGAL_FUNCTION		 0x01U						// Exception codes
+#define MODBUS_ILLEGAL_ADDRESS		 0x02U
+#define MODBUS_ILLEGAL_VALUE		 0x03U
+
+typedef char modbus_step_check[(MODBUS_STEP > 0 && (MODBUS_STEP << CLOCKSCALE_LOW_SHIFT) <= 1023U) ? 1 : -1];
+typedef char modbus_frame_check[(MODBUS_WRITE_FRAME <= MODBUS_FRAME_MAX && MODBUS_FRAME_MAX <= 255U && MODBUS_T35_US <= HRTIMER_MAX_US
+		&& MODBUS_ADDRESS >= 1 && MODBUS_ADDRESS <= 247) ? 1 : -1];
+
+// CRC-16/MODBUS (polynomial 0xA001 reflected) of the byte values 0..255
+const uint16_t modbus_crc_table[256] = {
+	0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+	0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+	0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+	0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+	0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+	0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+	0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+	0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+	0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+	0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+	0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+	0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+	0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+	0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+	0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+	0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+	0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+	0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+	0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+	0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+	0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+	0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+	0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+	0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+	0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+	0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+	0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+	0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+	0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+	0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+	0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+	0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+volatile uint16_t modbus_command = 0;
+volatile uint16_t modbus_command_status = MODBUS_CMD_STATUS_IDLE;
+uint32_t modbus_requests = 0;
+uint32_t modbus_crc_errors = 0;
+uint32_t modbus_exceptions = 0;
+METRICS_REGISTER(modbus_requests, METRICS_ID_MODBUS_REQUESTS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, modbus_requests);
+METRICS_REGISTER(modbus_crc_errors, METRICS_ID_MODBUS_CRC_ERRORS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, modbus_crc_errors);
+METRICS_REGISTER(modbus_exceptions, METRICS_ID_MODBUS_EXCEPTIONS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, modbus_exceptions);
+const modbus_register_t *modbus_table = NULL;	// Register map given to modbus_init
+uint8_t modbus_table_count = 0;
+modbus_command_t modbus_command_callback = NULL;
+uint32_t modbus_timer = 0;					// hrtimer of t3.5 (0 = none, the slave is not started)
+bool modbus_ready = false;
+#if MODBUS_ENABLED
+uint8_t modbus_frame[MODBUS_FRAME_MAX];		// Request, then the response
+uint8_t modbus_length = 0;					// Received bytes of the request
+bool modbus_overflow = false;				// The request did not fit (dropped at its end)
+volatile bool modbus_complete = false;		// t3.5 passed after the last byte (set by the hrtimer)
+uint8_t modbus_tx_length = 0;				// Bytes of the response
+uint8_t modbus_tx_index = 0;				// Next byte moved into the transmit FIFO
+bool modbus_sending = false;
+uint32_t modbus_shadow = 0;					// Latched variable of the register being read
+const modbus_register_t *modbus_shadow_register = NULL;	// Entry of the shadow (NULL = none)
+#endif
+
+
+//****************************************************************************
+// modbus_crc - continues a CRC-16/MODBUS (start with 0xFFFF) over length bytes
+//****************************************************************************
+uint16_t modbus_crc(uint16_t crc, const uint8_t *data, uint8_t length){
+	for(uint8_t i = 0; i < length; i++)
+		crc = (uint16_t)((crc >> 8) ^ modbus_crc_table[(crc ^ data[i]) & 0xFFU]);
+	return crc;
+}
+
+#if MODBUS_ENABLED
+//****************************************************************************
+// modbus_find - returns the entry holding a register address and the register of the address in it (NULL = unmapped)
+//****************************************************************************
+const modbus_register_t *modbus_find(uint16_t address, uint8_t *offset){
+	uint16_t start = 0;
+	for(uint8_t i = 0; i < modbus_table_count; i++){
+		const modbus_register_t *reg = &modbus_table[i];
+		if(address < start + reg->registers){
+			*offset = (uint8_t)(address - start);
+			return reg;
+		}
+		start += reg->registers;
+	}
+	return NULL;
+}
+
+//****************************************************************************
+// modbus_load - reads a live variable with one load
+//****************************************************************************
+uint32_t modbus_load(const modbus_register_t *reg){
+	switch(reg->width){
+		case 1:
+			return *(volatile uint8_t *)reg->variable;
+		case 2:
+			return *(volatile uint16_t *)reg->variable;
+		default:
+			return *(volatile uint32_t *)reg->variable;
+	}
+}
+
+//****************************************************************************
+// modbus_read - returns the value of a register in value (latches the variable once per request). Returns false if unmapped
+//****************************************************************************
+bool modbus_read(uint16_t address, uint16_t *value){
+	uint8_t offset;
+	const modbus_register_t *reg = modbus_find(address, &offset);
+	if(reg == NULL)
+		return false;
+	if(reg != modbus_shadow_register){
+		modbus_shadow = modbus_load(reg);
+		modbus_shadow_register = reg;
+	}
+	// Two registers: the high word first
+	*value = (reg->registers == 2U && offset == 0) ? (uint16_t)(modbus_shadow >> 16) : (uint16_t)modbus_shadow;
+	return true;
+}
+
+//****************************************************************************
+// modbus_writable - returns true if all count registers from address on are mapped and writable
+//****************************************************************************
+bool modbus_writable(uint16_t address, uint16_t count){
+	uint8_t offset;
+	for(uint16_t i = 0; i < count; i++){
+		const modbus_register_t *reg = modbus_find((uint16_t)(address + i), &offset);
+		if(reg == NULL || !(reg->access & MODBUS_WRITE))
+			return false;
+	}
+	return true;
+}
+
+//****************************************************************************
+// modbus_write - merges a register into its variable with one load and one store (checked by modbus_writable)
+//****************************************************************************
+void modbus_write(uint16_t address, uint16_t value){
+	uint8_t offset;
+	const modbus_register_t *reg = modbus_find(address, &offset);
+	uint32_t variable = modbus_load(reg);
+	if(reg->registers == 2U && offset == 0)
+		variable = (variable & 0x0000FFFFU) | ((uint32_t)value << 16);
+	else{
+		uint32_t mask = (reg->width == 1U) ? 0xFFU : 0xFFFFU;
+		variable = (variable & ~mask) | (value & mask);
+	}
+	switch(reg->width){
+		case 1:
+			*(volatile uint8_t *)reg->variable = (uint8_t)variable;
+			break;
+		case 2:
+			*(volatile uint16_t *)reg->variable = (uint16_t)variable;
+			break;
+		default:
+			*(volatile uint32_t *)reg->variable = variable;
+			break;
+	}
+	if(reg->variable == &modbus_command)
+		modbus_command_status = MODBUS_CMD_STATUS_PENDING;
+}
+
+//****************************************************************************
+// modbus_get16 - returns the big endian 16 bit field at data
+//****************************************************************************
+static inline uint16_t modbus_get16(const uint8_t *data){
+	return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+//****************************************************************************
+// modbus_process - executes the received request and builds the response over it. Returns its length (0 = no response)
+//****************************************************************************
+uint8_t modbus_process(void){
+	uint8_t *frame = modbus_frame;
+	uint8_t length = modbus_length;
+	bool overflow = modbus_overflow;
+	modbus_length = 0;
+	modbus_overflow = false;
+
+	// The CRC over a frame including its CRC (low byte first) is 0
+	if(overflow || length < 4U || modbus_crc(MODBUS_CRC_INIT, frame, length) != 0){
+		modbus_crc_errors++;
+		return 0;
+	}
+	uint8_t address = frame[0];
+	if(address != MODBUS_ADDRESS && address != MODBUS_BROADCAST)
+		return 0;
+	modbus_requests++;
+
+	uint16_t start = modbus_get16(&frame[2]);
+	uint16_t count = modbus_get16(&frame[4]);
+	uint8_t exception = 0;
+	uint8_t response = 6;					// Write responses echo address, function, register and value or count
+	modbus_shadow_register = NULL;
+	switch(frame[1]){
+		case MODBUS_READ_HOLDING:
+		case MODBUS_READ_INPUT:
+			if(length != 8U || count == 0 || count > MODBUS_READ_MAX){
+				exception = MODBUS_ILLEGAL_VALUE;
+				break;
+			}
+			// The registers overwrite the request fields behind the byte count (already read)
+			for(uint16_t i = 0; i < count; i++){
+				uint16_t value;
+				if(!modbus_read((uint16_t)(start + i), &value)){
+					exception = MODBUS_ILLEGAL_ADDRESS;
+					break;
+				}
+				frame[3U + 2U * i] = (uint8_t)(value >> 8);
+				frame[4U + 2U * i] = (uint8_t)value;
+			}
+			frame[2] = (uint8_t)(2U * count);
+			response = (uint8_t)(3U + 2U * count);
+			break;
+
+		case MODBUS_WRITE_SINGLE:
+			if(length != 8U)
+				exception = MODBUS_ILLEGAL_VALUE;
+			else if(!modbus_writable(start, 1))
+				exception = MODBUS_ILLEGAL_ADDRESS;
+			else
+				modbus_write(start, count);
+			break;
+
+		case MODBUS_WRITE_MULTIPLE:
+			if(count == 0 || count > MODBUS_WRITE_MAX || frame[6] != 2U * count || length != 9U + 2U * count)
+				exception = MODBUS_ILLEGAL_VALUE;
+			else if(!modbus_writable(start, count))
+				exception = MODBUS_ILLEGAL_ADDRESS;
+			else{
+				for(uint16_t i = 0; i < count; i++)
+					modbus_write((uint16_t)(start + i), modbus_get16(&frame[7U + 2U * i]));
+			}
+			break;
+
+		default:
+			exception = MODBUS_ILLEGAL_FUNCTION;
+			break;
+	}
+	if(address == MODBUS_BROADCAST)
+		return 0;
+	if(exception != 0){
+		frame[1] |= MODBUS_EXCEPTION;
+		frame[2] = exception;
+		response = 3;
+		modbus_exceptions++;
+	}
+	uint16_t crc = modbus_crc(MODBUS_CRC_INIT, frame, response);
+	frame[response++] = (uint8_t)crc;
+	frame[response++] = (uint8_t)(crc >> 8);
+	return response;
+}
+
+//****************************************************************************
+// modbus_timer_callback - t3.5 passed after the last byte: the frame is complete (hrtimer interrupt context)
+//****************************************************************************
+void modbus_timer_callback(void *args){
+	(void)args;
+	modbus_complete = true;
+	NVIC_SetPendingIRQ(MODBUS_IRQ);
+}
+
+//****************************************************************************
+// USIC0_3_IRQHandler - answers a complete request, collects received bytes and moves the response into the transmit FIFO
+//****************************************************************************
+void USIC0_3_IRQHandler(void){
+	if(modbus_complete){
+		modbus_complete = false;
+		modbus_tx_length = modbus_process();
+		modbus_tx_index = 0;
+		modbus_sending = modbus_tx_length != 0;
+	}
+
+	XMC_USIC_CH_RXFIFO_ClearEvent(MODBUS_CHANNEL, XMC_USIC_CH_RXFIFO_EVENT_STANDARD);
+	bool received = false;
+	while(!XMC_USIC_CH_RXFIFO_IsEmpty(MODBUS_CHANNEL)){
+		uint8_t data = (uint8_t)XMC_USIC_CH_RXFIFO_GetData(MODBUS_CHANNEL);
+		if(modbus_sending)
+			continue;
+		if(modbus_length < MODBUS_FRAME_MAX)
+			modbus_frame[modbus_length++] = data;
+		else
+			modbus_overflow = true;
+		received = true;
+	}
+	// The channel interrupt preempts the main context, which starts and stops hrtimers itself
+	if(received)
+		hrtimer_request(modbus_timer, MODBUS_T35_US);
+
+	XMC_USIC_CH_TXFIFO_ClearEvent(MODBUS_CHANNEL, XMC_USIC_CH_TXFIFO_EVENT_STANDARD);
+	while(modbus_sending && !XMC_USIC_CH_TXFIFO_IsFull(MODBUS_CHANNEL)){
+		XMC_USIC_CH_TXFIFO_PutData(MODBUS_CHANNEL, modbus_frame[modbus_tx_index++]);
+		if(modbus_tx_index >= modbus_tx_length)
+			modbus_sending = false;
+	}
+}
+#endif
+
+//****************************************************************************
+// modbus_init - sets up the UART, its pins and the frame timer with a register map (call after power_init and hrtimer_init)
+//****************************************************************************
+void modbus_init(const modbus_register_t *map, uint8_t count, modbus_command_t command){
+	modbus_table = map;
+	modbus_table_count = count;
+	modbus_command_callback = command;
+#if MODBUS_ENABLED
+	// Without a free hrtimer the frames cannot be delimited, the slave stays off
+	modbus_timer = hrtimer_create(modbus_timer_callback, NULL);
+	if(modbus_timer == 0)
+		return;
+
+	const XMC_UART_CH_CONFIG_t uart_config = {
+		.baudrate = MODBUS_BAUDRATE,
+		.data_bits = 8U,
+		.frame_length = 8U,
+		.stop_bits = 1U,
+		.oversampling = MODBUS_OVERSAMPLING,
+		.parity_mode = XMC_USIC_CH_PARITY_MODE_EVEN
+	};
+	XMC_UART_CH_Init(MODBUS_CHANNEL, &uart_config);
+	// Exact step without the integer divider, so a clock change only has to shift it
+	MODBUS_CHANNEL->FDR = XMC_USIC_CH_BRG_CLOCK_DIVIDER_MODE_FRACTIONAL | ((uint32_t)MODBUS_STEP << USIC_CH_FDR_STEP_Pos);
+	MODBUS_CHANNEL->BRG &= ~USIC_CH_BRG_PDIV_Msk;
+	XMC_UART_CH_SetInputSource(MODBUS_CHANNEL, XMC_UART_CH_INPUT_RXD, USIC0_C0_DX0_P0_15);
+
+	XMC_USIC_CH_TXFIFO_Configure(MODBUS_CHANNEL, 0U, XMC_USIC_CH_FIFO_SIZE_16WORDS, MODBUS_FIFO_SIZE / 2U);
+	XMC_USIC_CH_RXFIFO_Configure(MODBUS_CHANNEL, MODBUS_FIFO_SIZE, XMC_USIC_CH_FIFO_SIZE_16WORDS, 0U);
+	XMC_USIC_CH_TXFIFO_SetInterruptNodePointer(MODBUS_CHANNEL, XMC_USIC_CH_TXFIFO_INTERRUPT_NODE_POINTER_STANDARD, MODBUS_SR);
+	XMC_USIC_CH_RXFIFO_SetInterruptNodePointer(MODBUS_CHANNEL, XMC_USIC_CH_RXFIFO_INTERRUPT_NODE_POINTER_STANDARD, MODBUS_SR);
+	XMC_USIC_CH_TXFIFO_EnableEvent(MODBUS_CHANNEL, XMC_USIC_CH_TXFIFO_EVENT_CONF_STANDARD);
+	XMC_USIC_CH_RXFIFO_EnableEvent(MODBUS_CHANNEL, XMC_USIC_CH_RXFIFO_EVENT_CONF_STANDARD);
+	XMC_UART_CH_Start(MODBUS_CHANNEL);
+
+	const XMC_GPIO_CONFIG_t rx_config = {.mode = XMC_GPIO_MODE_INPUT_PULL_UP, .input_hysteresis = XMC_GPIO_INPUT_HYSTERESIS_STANDARD};
+	const XMC_GPIO_CONFIG_t tx_config = {.mode = (XMC_GPIO_MODE_t)P0_14_AF_U0C0_DOUT0, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	XMC_GPIO_Init(P0_15, &rx_config);
+	XMC_GPIO_Init(P0_14, &tx_config);
+	modbus_ready = true;
+
+	NVIC_SetPriority(MODBUS_IRQ, MODBUS_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(MODBUS_IRQ);
+	NVIC_EnableIRQ(MODBUS_IRQ);
+#endif
+}
+
+//****************************************************************************
+// modbus_set_clock_shift - keeps the baud rate when MCLK was divided by 2^shift (interrupts masked)
+//****************************************************************************
+void modbus_set_clock_shift(uint8_t shift){
+	if(!modbus_ready)
+		return;
+	MODBUS_CHANNEL->FDR = XMC_USIC_CH_BRG_CLOCK_DIVIDER_MODE_FRACTIONAL | (((uint32_t)MODBUS_STEP << shift) << USIC_CH_FDR_STEP_Pos);
+}
+
+//****************************************************************************
+// modbus_task - executes a command written by the master (scheduler task, MODBUS_TASK_PERIOD)
+//****************************************************************************
+void modbus_task(void){
+	if(modbus_command_status != MODBUS_CMD_STATUS_PENDING)
+		return;
+	uint8_t command = (uint8_t)modbus_command;
+	bool accepted = modbus_command_callback != NULL && modbus_command_callback(command);
+	modbus_command_status = accepted ? MODBUS_CMD_STATUS_DONE : MODBUS_CMD_STATUS_REJECTED;
+}
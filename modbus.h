@@ -0,0 +1,72 @@
+/*
+ * USB-Changer modbus.h
+ *
+ * Modbus RTU slave for PLC networks (USIC0 channel 0, TX P0.14, RX P0.15, 8E1, an RS-485 transceiver with automatic
+ * direction control). The register map is a table of live variables given to modbus_init, register addresses follow
+ * the table order (one or two 16 bit registers per entry, two registers hold the high word first). Function codes:
+ *	0x03, 0x04	read holding / input registers (both read the same map, up to MODBUS_READ_MAX registers)
+ *	0x06, 0x10	write single / multiple registers (writable entries only, up to MODBUS_WRITE_MAX registers)
+ * Anything else is answered with the Modbus exception codes (illegal function, address or value), requests to
+ * address 0 (broadcast) are executed without a response. A variable is latched with one load when the first of its
+ * registers is read, so a request sees every entry consistently, writes merge their register with one load and store.
+ * Everything runs in interrupts, the main loop is never involved: the channel interrupt (SR3) collects the bytes of a
+ * request and restarts an hrtimer (CCU40 slice 2) with the 3.5 character silence that ends a frame (t3.5, fixed 1750us
+ * above 19200 baud). Its expiry pends the channel interrupt, which checks the CRC (CRC-16/MODBUS with a 256 entry
+ * table), builds the response and feeds it to the transmit FIFO. So the response leaves a fixed time after the end of
+ * the request, bounded by the longest request, and polling at any rate only costs interrupt time in the COMM tier,
+ * below the relay decision and the time bases. Writes to the command register are executed by modbus_task through the
+ * callback given to modbus_init (same commands as the I2C target).
+ * It uses the channel and pins of the telemetry UART: it excludes TELEMETRY_ENABLED, I2CTARGET_ENABLED and
+ * SPISTREAM_ENABLED.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef MODBUS_H
+#define MODBUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define MODBUS_ENABLED				 0							// Determines if the Modbus slave is set up (needs TELEMETRY_ENABLED = 0)
+#define MODBUS_ADDRESS				 1							// Slave address (1 to 247)
+#define MODBUS_BAUDRATE				 19200U						// In baud (8 data bits, even parity, 1 stop bit)
+#define MODBUS_READ_MAX				 32							// Registers per read request (the response buffer holds them)
+#define MODBUS_WRITE_MAX			 16							// Registers per write multiple request
+#define MODBUS_TASK_PERIOD			 5							// In ms. Period of modbus_task (scheduler task)
+#define MODBUS_IRQ_PRIORITY			 IRQPRIO_MODBUS				// Priority of the USIC0 SR3 interrupt
+
+#define MODBUS_READ					 0x00U						// Register access flags
+#define MODBUS_WRITE				 0x01U						// Register is written by the master
+
+typedef struct {
+	volatile void *variable;	// Live variable (little endian, the registers hold its lowest bytes)
+	uint8_t width;				// In bytes. Size of the variable (1, 2 or 4), latched with one load
+	uint8_t registers;			// Registers of the entry (1 or 2)
+	uint8_t access;				// MODBUS_READ or MODBUS_WRITE
+} modbus_register_t;
+
+typedef enum {
+	MODBUS_CMD_STATUS_IDLE,			// No command written yet
+	MODBUS_CMD_STATUS_PENDING,		// Written, waits for modbus_task
+	MODBUS_CMD_STATUS_DONE,			// Executed
+	MODBUS_CMD_STATUS_REJECTED		// Unknown or not possible now
+} modbus_command_states;
+
+// Executes a command written to the command register (main context), returns true if it was accepted
+typedef bool (*modbus_command_t)(uint8_t command);
+
+extern volatile uint16_t modbus_command;			// Command register (written by the master)
+extern volatile uint16_t modbus_command_status;		// modbus_command_states
+extern uint32_t modbus_requests;					// Requests for this slave (including broadcasts)
+extern uint32_t modbus_crc_errors;					// Frames dropped for a wrong CRC, a wrong length or an overflow
+extern uint32_t modbus_exceptions;					// Exception responses
+extern const modbus_register_t modbus_map[];		// Register map of the application (main.c), given to modbus_init
+
+uint16_t modbus_crc(uint16_t crc, const uint8_t *data, uint8_t length);
+void modbus_init(const modbus_register_t *map, uint8_t count, modbus_command_t command);
+void modbus_set_clock_shift(uint8_t shift);
+void modbus_task(void);
+
+#endif /* MODBUS_H */
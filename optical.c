@@ -0,0 +1,172 @@
+/*
+ * USB-Changer optical.c
+ *
+ * Optical diagnostic readout (see optical.h). optical_poll frames the next record into the ring whenever a whole frame
+ * fits (main context), optical_next takes the bits out of it in the LED period match interrupt. The metrics are read
+ * when their record is framed, the trace entries are taken oldest first from the entries present when the pass started.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "optical.h"
+#include "ledfade.h"
+#include "telemetry.h"
+#include "metrics.h"
+#include "trace.h"
+#include "ramcode.h"
+#include "container.h"
+
+#define OPTICAL_BYTE_BITS			 10U						// Start bit, 8 data bits, stop bit
+#define OPTICAL_STOP_BIT			 (1U << 9)
+
+RING_CHECK(optical, OPTICAL_BUFFER);
+typedef char optical_buffer_check[(TELEMETRY_FRAME_MAX <= OPTICAL_BUFFER) ? 1 : -1];
+
+typedef enum {
+	OPTICAL_IDLE,
+	OPTICAL_METRICS_LIST,		// Ids, types and units of the metrics from optical_index on
+	OPTICAL_METRICS_VALUES,		// Their values
+	OPTICAL_TRACE				// Trace entry optical_index of the pass (0 = oldest)
+} optical_states;
+
+RING(uint8_t, OPTICAL_BUFFER) optical_ring;	// Filled by optical_poll, emptied by optical_next
+uint16_t optical_shift;				// Bits of the current byte not sent yet (LSB first)
+uint8_t optical_bits = 0;			// Number of bits in optical_shift
+bool optical_second = false;		// The second half of the current bit is next
+bool optical_level;					// Level of the second half
+optical_states optical_state = OPTICAL_IDLE;
+uint8_t optical_index = 0;
+uint8_t optical_sequence = 0;
+uint8_t optical_trace_head;			// trace_buffer.head when the trace pass started
+uint8_t optical_trace_count;		// Trace entries of the pass
+
+
+//****************************************************************************
+// optical_next - returns the level of the next half bit (ledfade_source_t, LED period match interrupt)
+//****************************************************************************
+RAMCODE
+bool optical_next(void){
+	if(optical_second){
+		optical_second = false;
+		return optical_level;
+	}
+	if(optical_bits == 0){
+		// Off while the ring is empty (no edges, the reader sees the gap)
+		uint8_t byte;
+		if(!RING_GET(&optical_ring, byte))
+			return false;
+		optical_shift = OPTICAL_STOP_BIT | ((uint16_t)byte << 1);
+		optical_bits = OPTICAL_BYTE_BITS;
+	}
+	bool bit = (optical_shift & 1U) != 0;
+	optical_shift >>= 1;
+	optical_bits--;
+	// Manchester: the level changes in the middle of every bit, a 1 to on
+	optical_level = bit;
+	optical_second = true;
+	return !bit;
+}
+
+//****************************************************************************
+// optical_queue - frames a record into the ring. Returns false if the frame does not fit yet
+//****************************************************************************
+bool optical_queue(uint8_t type, const uint8_t *payload, uint8_t length){
+	uint8_t frame[TELEMETRY_FRAME_MAX];
+	if(RING_FREE(&optical_ring) < TELEMETRY_FRAME_MAX)
+		return false;
+	uint8_t frame_length = telemetry_frame(frame, type, optical_sequence++, payload, length);
+	for(uint8_t i = 0; i < frame_length; i++)
+		RING_PUT(&optical_ring, frame[i]);
+	return true;
+}
+
+//****************************************************************************
+// optical_start - starts the readout from the first metric
+//****************************************************************************
+void optical_start(void){
+#if OPTICAL_ENABLED
+	if(optical_state != OPTICAL_IDLE)
+		return;
+	RING_INIT(&optical_ring);
+	optical_bits = 0;
+	optical_second = false;
+	optical_index = 0;
+	optical_state = OPTICAL_METRICS_LIST;
+	// Without the LED interrupt there is no readout, the patterns keep the LED
+	if(!ledfade_stream(optical_next, OPTICAL_HALF_PERIODS))
+		optical_state = OPTICAL_IDLE;
+#endif
+}
+
+//****************************************************************************
+// optical_stop - ends the readout (the current byte is cut off) and gives the LED back to the patterns
+//****************************************************************************
+void optical_stop(void){
+	if(optical_state == OPTICAL_IDLE)
+		return;
+	ledfade_stream_stop();
+	optical_state = OPTICAL_IDLE;
+}
+
+//****************************************************************************
+// optical_running - returns true while the readout runs
+//****************************************************************************
+bool optical_running(void){
+	return optical_state != OPTICAL_IDLE;
+}
+
+//****************************************************************************
+// optical_poll - frames the next record while the ring has room for one (main loop)
+//****************************************************************************
+void optical_poll(void){
+	uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+	uint8_t length;
+	if(!OPTICAL_ENABLED)
+		return;
+
+	switch(optical_state){
+		case OPTICAL_METRICS_LIST:
+			length = metrics_list(optical_index, payload);
+			if(!optical_queue(TELEMETRY_RECORD_METRICS_LIST, payload, length))
+				break;
+			optical_state = OPTICAL_METRICS_VALUES;
+			break;
+
+		case OPTICAL_METRICS_VALUES:
+			length = metrics_read(optical_index, payload);
+			if(!optical_queue(TELEMETRY_RECORD_METRICS_VALUES, payload, length))
+				break;
+			// Next entries of the registry or on to the trace
+			optical_index += METRICS_VALUES_MAX;
+			if(optical_index < metrics_count()){
+				optical_state = OPTICAL_METRICS_LIST;
+				break;
+			}
+			optical_index = 0;
+			optical_trace_head = trace_buffer.head;
+			optical_trace_count = (uint8_t)trace_buffer.count;
+			optical_state = OPTICAL_TRACE;
+			break;
+
+		case OPTICAL_TRACE:{
+			if(optical_index >= optical_trace_count){
+				// Pass complete, the next one starts with the metrics again
+				optical_index = 0;
+				optical_state = OPTICAL_METRICS_LIST;
+				break;
+			}
+			const trace_entry_t *entry = &trace_buffer.entries[(optical_trace_head - optical_trace_count + optical_index) & (TRACE_ENTRIES - 1U)];
+			uint8_t *p = telemetry_put32(payload, entry->time);
+			p = telemetry_put16(p, entry->value);
+			*p++ = entry->type;
+			*p++ = entry->arg;
+			if(optical_queue(TELEMETRY_RECORD_EVENT, payload, (uint8_t)(p - payload)))
+				optical_index++;
+			break;
+		}
+
+		default:
+			break;
+	}
+}
@@ -0,0 +1,33 @@
+/*
+ * USB-Changer optical.h
+ *
+ * Optical diagnostic readout through the status LED, for boards without a connector the telemetry can use. While it
+ * runs, the LED streams the metrics registry (ids, types, units and values) and the event trace as telemetry records
+ * (same COBS frames as telemetry.h, METRICS_LIST, METRICS_VALUES and EVENT records). The stream repeats from the
+ * start, so a photodiode or camera reader can start at any time.
+ * Every byte is sent like on a UART as start bit (0), 8 data bits (LSB first) and stop bit (1). Every bit is Manchester
+ * coded: a 0 is on then off, a 1 is off then on. The LED is off while no byte is queued. One half bit lasts
+ * OPTICAL_HALF_PERIODS periods of the 16kHz LED PWM, and the edges lie on its period matches (ledfade_stream). A
+ * period match of the UI tier interrupt that comes late stretches one half bit by one PWM period.
+ * The chord of all three buttons starts and stops the readout (main.c). The LED patterns continue meanwhile, their
+ * level is shown again when it stops.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef OPTICAL_H
+#define OPTICAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define OPTICAL_ENABLED				 0							// Determines if the readout can be started (0 = the chord is ignored)
+#define OPTICAL_HALF_PERIODS		 4							// LED PWM periods per half bit (16kHz PWM: 2000 bit/s, 200 bytes/s)
+#define OPTICAL_BUFFER				 128						// In bytes. Ring of the framed records waiting for the LED (power of 2, holds one frame)
+
+void optical_start(void);
+void optical_stop(void);
+bool optical_running(void);
+void optical_poll(void);
+
+#endif /* OPTICAL_H */
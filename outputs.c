@@ -0,0 +1,82 @@
+/*
+ * USB-Changer outputs.c
+ *
+ * Output image of the main loop (see outputs.h). Staging and commit both run in main context, so the image needs no
+ * locking; the interrupts that write the same slices (fade ramps and streams) cancel nothing themselves, the main
+ * context functions that start them do.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "outputs.h"
+#include "hal.h"
+
+typedef struct {
+	CCU4_CC4_TypeDef *slice;
+	uint32_t shadow;			// GCSS bits of the compare shadow transfer
+	uint32_t dither_shadow;		// GCSS bits of the dither compare shadow transfer
+} outputs_slice_t;
+
+typedef struct {
+	uint16_t compare;
+	uint8_t dither;
+} outputs_value_t;
+
+typedef char outputs_slices_check[(OUTPUTS_SLICE_COUNT <= 8) ? 1 : -1];
+
+// Slices of CCU40 (index is outputs_slices)
+const outputs_slice_t outputs_slices_table[OUTPUTS_SLICE_COUNT] = {
+	[OUTPUTS_SLICE_LED] = {HAL_LED_SLICE, (uint32_t)HAL_LED_SHADOW, (uint32_t)HAL_LED_DITHER_SHADOW}
+};
+outputs_value_t outputs_image[OUTPUTS_SLICE_COUNT];
+uint8_t outputs_pending = 0;		// Slices with a staged value
+uint32_t outputs_commits = 0;
+uint32_t outputs_elided = 0;
+
+
+//****************************************************************************
+// outputs_compare - stages the compare and dither compare value of a slice for the next outputs_commit (main context)
+//****************************************************************************
+void outputs_compare(uint8_t slice, uint16_t compare, uint8_t dither){
+	if(outputs_pending & (1U << slice))
+		outputs_elided++;
+	outputs_image[slice].compare = compare;
+	outputs_image[slice].dither = dither;
+	outputs_pending |= (uint8_t)(1U << slice);
+}
+
+//****************************************************************************
+// outputs_cancel - drops the staged value of a slice, an interrupt drives it from now on (main context)
+//****************************************************************************
+void outputs_cancel(uint8_t slice){
+	outputs_pending &= (uint8_t)~(1U << slice);
+}
+
+//****************************************************************************
+// outputs_commit - writes the staged values that differ from the shadow registers, one shadow transfer request for all (main context, end of the pass)
+//****************************************************************************
+void outputs_commit(void){
+	if(!OUTPUTS_ENABLED || outputs_pending == 0)
+		return;
+	uint32_t transfer = 0;
+	for(uint8_t i = 0; i < OUTPUTS_SLICE_COUNT; i++){
+		if(!(outputs_pending & (1U << i)))
+			continue;
+		const outputs_slice_t *slice = &outputs_slices_table[i];
+		const outputs_value_t *value = &outputs_image[i];
+		// The shadow registers hold the value of the last transfer request (or of one still pending)
+		if(slice->slice->CRS == value->compare && slice->slice->DITS == value->dither){
+			outputs_elided++;
+			continue;
+		}
+		slice->slice->CRS = value->compare;
+		slice->slice->DITS = value->dither;
+		transfer |= slice->shadow | slice->dither_shadow;
+	}
+	outputs_pending = 0;
+	if(transfer != 0){
+		HAL_LED_MODULE->GCSS = transfer;
+		outputs_commits++;
+	}
+}
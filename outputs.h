@@ -0,0 +1,38 @@
+/*
+ * USB-Changer outputs.h
+ *
+ * Output image of the main loop. PWM compare values set by the handlers of a pass are only staged in RAM
+ * (outputs_compare) and written at the end of the pass by outputs_commit, so every staged output changes at one
+ * defined point per pass and a value set twice in a pass (a pattern step followed by reset_status_led_to_relay_state)
+ * reaches the peripheral once. The commit writes only the slices whose value differs from their shadow registers and
+ * requests the shadow transfer of all of them with one GCSS write.
+ * Only the main context stages. Outputs with a timing of their own stay direct writes: the relay outputs (also
+ * switched by the ADC and latch timer interrupts, a staged level could undo such a switch), the USB switchover (one
+ * precomputed Pn_OMR write per port and phase already, its break-before-make order needs them in sequence), the
+ * software PWM of the USB indicators and the fade ramps and streams of the status LED (interrupt driven). A ramp or
+ * stream that takes the LED over cancels a staged value (outputs_cancel).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef OUTPUTS_H
+#define OUTPUTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define OUTPUTS_ENABLED				 0							// Determines if main context compare values are staged and committed once per pass (else written at once)
+
+typedef enum {
+	OUTPUTS_SLICE_LED,		// PWM_CCU4_LED_STATUS (hal.h)
+	OUTPUTS_SLICE_COUNT		// Max. 8 (pending slices are a bit mask)
+} outputs_slices;
+
+extern uint32_t outputs_commits;		// Commits that wrote at least one slice
+extern uint32_t outputs_elided;			// Staged values that never reached the peripheral (set again in the pass or unchanged)
+
+void outputs_compare(uint8_t slice, uint16_t compare, uint8_t dither);
+void outputs_cancel(uint8_t slice);
+void outputs_commit(void);
+
+#endif /* OUTPUTS_H */
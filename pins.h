@@ -0,0 +1,58 @@
+/*
+ * USB-Changer pins.h
+ *
+ * Input snapshots of DIGITAL_IO pins. pins_snapshot reads the IN register of every port once, pins_get_input answers
+ * pin queries from such a snapshot by a bit test. All queries of one snapshot see the pin levels of the same instant
+ * and cost neither a function call nor a port access.
+ * The PINS_* macros take a DIGITAL_IO instance name instead of a handle and use the <name>_PORT and <name>_PIN
+ * constants generated into digital_io_extern.h, so the port address and the pin mask are folded at compile time and
+ * a pin operation is a single OMR store or IN load (DIGITAL_IO_SetOutputHigh(&IO_...) first loads both from the
+ * handle in flash). Handles from tables (usb_ports, buttons) still need the DIGITAL_IO functions.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef PINS_H
+#define PINS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "DIGITAL_IO/digital_io.h"
+
+#define PINS_PORT_COUNT				 3							// P0, P1 and P2 (port registers are 0x100 apart, starting at PORT0_BASE)
+#define PINS_PORT_INDEX(port)		 ((((uint32_t)(uintptr_t)(port)) - PORT0_BASE) >> 8)
+
+#define PINS_SET_HIGH(io)			 XMC_GPIO_SetOutputHigh(io##_PORT, io##_PIN)
+#define PINS_SET_LOW(io)			 XMC_GPIO_SetOutputLow(io##_PORT, io##_PIN)
+#define PINS_TOGGLE(io)				 XMC_GPIO_ToggleOutput(io##_PORT, io##_PIN)
+#define PINS_GET_INPUT(io)			 XMC_GPIO_GetInput(io##_PORT, io##_PIN)
+#define PINS_SET_MODE(io, mode)		 XMC_GPIO_SetMode(io##_PORT, io##_PIN, (mode))
+
+typedef struct {
+	uint32_t in[PINS_PORT_COUNT];	// Pn_IN of all ports
+} pins_snapshot_t;
+
+//****************************************************************************
+// pins_snapshot - reads the input levels of all ports
+//****************************************************************************
+static inline void pins_snapshot(pins_snapshot_t *snapshot){
+	snapshot->in[0] = XMC_GPIO_PORT0->IN;
+	snapshot->in[1] = XMC_GPIO_PORT1->IN;
+	snapshot->in[2] = XMC_GPIO_PORT2->IN;
+}
+
+//****************************************************************************
+// pins_get_input - returns the level of a pin in a snapshot (0 or 1, like DIGITAL_IO_GetInput)
+//****************************************************************************
+static inline uint32_t pins_get_input(const pins_snapshot_t *snapshot, const DIGITAL_IO_t *io){
+	return (snapshot->in[PINS_PORT_INDEX(io->gpio_port)] >> io->gpio_pin) & 1U;
+}
+
+//****************************************************************************
+// pins_changed - returns true if a pin has a different level in two snapshots
+//****************************************************************************
+static inline bool pins_changed(const pins_snapshot_t *a, const pins_snapshot_t *b, const DIGITAL_IO_t *io){
+	return pins_get_input(a, io) != pins_get_input(b, io);
+}
+
+#endif /* PINS_H */
@@ -0,0 +1,79 @@
+/*
+ * USB-Changer power.c
+ *
+ * Idle power management (see power.h). The XMC1100 deep sleep mode is not used: it runs MCLK and PCLK from the 32kHz
+ * standby clock, which stops the LED PWM, slows the sensor trigger and SysTick by a factor of about 2000 and cannot
+ * be left often enough for the 1ms sampling of the USB button (no ERU input). The sleep states therefore keep the
+ * clocks running and only differ in the flash power.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "power.h"
+#include "clockscale.h"
+#include "relay.h"
+#include "ledfade.h"
+#include "storage.h"
+#include "statelog.h"
+#include "bulkflash.h"
+#include "telemetry.h"
+#include "i2ctarget.h"
+#include "spistream.h"
+#include "wallclock.h"
+
+#define POWER_CYCLES_PER_US			 (SYSTIMER_SYSTICK_CLOCK / 1000000U)
+
+power_stat_t power_stats[POWER_STATE_COUNT];
+bool power_flash_off_blocked = false;		// The flash off state exceeded POWER_WAKE_LATENCY_MAX and is no longer used
+
+
+//****************************************************************************
+// power_quiet - returns true if nothing needs fast reactions or the flash (quiet phase)
+//****************************************************************************
+bool power_quiet(void){
+	return clockscale_get_shift() != 0 && !relay_any_latch_running() && !ledfade_running() && !storage_pending() && !statelog_pending() && !bulkflash_pending();
+}
+
+//****************************************************************************
+// power_init - gates the clocks of the peripherals the firmware does not use (VADC and CCU40 are used, USIC0 with telemetry, the I2C target or the SPI stream, RTC with the wall clock)
+//****************************************************************************
+void power_init(void){
+#if !TELEMETRY_ENABLED && !I2CTARGET_ENABLED && !SPISTREAM_ENABLED
+	XMC_SCU_CLOCK_GatePeripheralClock(XMC_SCU_PERIPHERAL_CLOCK_USIC0);
+#endif
+#if !WALLCLOCK_ENABLED
+	XMC_SCU_CLOCK_GatePeripheralClock(XMC_SCU_PERIPHERAL_CLOCK_RTC);
+#endif
+}
+
+//****************************************************************************
+// power_idle - sleeps until an interrupt is pending (interrupts masked, the handlers run after the caller unmasks them)
+//****************************************************************************
+void power_idle(void){
+	power_states state = POWER_STATE_SLEEP;
+#if POWER_FLASH_OFF_ENABLED
+	if(!power_flash_off_blocked && SYSTIMER_GetIdleCycles() >= POWER_FLASH_OFF_MIN_TIME * POWER_CYCLES_PER_US && power_quiet())
+		state = POWER_STATE_FLASH_OFF;
+#endif
+
+	if(state == POWER_STATE_FLASH_OFF)
+		XMC_SCU_CLOCK_EnableFlashPowerDown();
+	uint32_t start = SYSTIMER_GetCycles();
+	__WFI();
+	// Right after the wake-up (this code runs from flash, so the flash power up is included)
+	uint32_t latency = SYSTIMER_GetPendingAge();
+	if(state == POWER_STATE_FLASH_OFF)
+		XMC_SCU_CLOCK_DisableFlashPowerDown();
+
+	power_stat_t *stat = &power_stats[state];
+	stat->count++;
+	stat->cycles += SYSTIMER_GetCycles() - start;
+	if(latency != 0){
+		stat->timed_wakes++;
+		if(latency > stat->latency_max)
+			stat->latency_max = latency;
+		if(state == POWER_STATE_FLASH_OFF && latency > POWER_WAKE_LATENCY_MAX * POWER_CYCLES_PER_US)
+			power_flash_off_blocked = true;
+	}
+}
@@ -0,0 +1,43 @@
+/*
+ * USB-Changer power.h
+ *
+ * Idle power management. The main loop sleeps through power_idle, which picks the sleep state for every WFI: in a
+ * quiet phase (user idle so MCLK is lowered, relay stable, no LED fade, no flash write pending) and with the next
+ * timer deadline far enough away the flash is powered down while the CPU sleeps, otherwise a plain sleep is used.
+ * Button edges (ERU), ADC results and SysTick deadlines wake the CPU as before. The wake-up latency from a SysTick
+ * deadline is measured per state, a latency above POWER_WAKE_LATENCY_MAX stops the use of the flash off state.
+ * Peripherals the firmware does not use are clock gated by power_init.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define POWER_FLASH_OFF_ENABLED		 0							// Determines if the flash is powered down during sleeps in a quiet phase (0 = always plain sleep)
+#define POWER_FLASH_OFF_MIN_TIME	 200						// In us. Shortest time until the next timer deadline the flash is powered down for
+#define POWER_WAKE_LATENCY_MAX		 20							// In us. Longest accepted wake-up latency with the flash powered down
+
+typedef enum {
+	POWER_STATE_SLEEP,		// WFI, flash stays powered
+	POWER_STATE_FLASH_OFF,	// WFI with the flash powered down (quiet phase only)
+	POWER_STATE_COUNT
+} power_states;
+
+typedef struct {
+	uint32_t count;			// Number of sleeps in this state
+	uint32_t timed_wakes;	// Number of them ended by a SysTick deadline (wake-up latency measured)
+	uint32_t latency_max;	// In cycles. Longest time from the SysTick deadline to the first instruction after WFI
+	uint64_t cycles;		// In cycles. Time slept in this state (WFI to the wake-up, the handlers run after it)
+} power_stat_t;
+
+extern power_stat_t power_stats[POWER_STATE_COUNT];
+extern bool power_flash_off_blocked;
+
+void power_init(void);
+void power_idle(void);
+
+#endif /* POWER_H */
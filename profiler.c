@@ -0,0 +1,121 @@
+/*
+ * USB-Changer profiler.c
+ *
+ * Main loop cycle time profiler (see profiler.h). All statistics are kept in CPU cycles so recording needs no
+ * division, conversion to microseconds is only done on request.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "profiler.h"
+#include "ramcode.h"
+#include "irqprio.h"
+
+profiler_stat_t profiler_stats[PROFILER_SECTION_COUNT];
+profiler_isr_stat_t profiler_isr_stats[PROFILER_ISR_COUNT];
+const uint8_t profiler_isr_priority[PROFILER_ISR_COUNT] = {IRQPRIO_SYSTICK, IRQPRIO_ADC_RESULT, IRQPRIO_LED_PWM};	// Tier of every vector (irqprio.h)
+
+
+//****************************************************************************
+// profiler_timestamp - returns the current time in CPU cycles (wraps after 2^32 cycles = 134s at 32MHz)
+//****************************************************************************
+uint32_t profiler_timestamp(void){
+	// SysTick count and down-counter are combined by SYSTIMER (also correct with the variable periods of the tickless mode)
+	return SYSTIMER_GetCycles();
+}
+
+//****************************************************************************
+// profiler_record - adds one measured duration to a section
+//****************************************************************************
+void profiler_record(profiler_sections section, uint32_t cycles){
+	profiler_stat_t *stat = &profiler_stats[section];
+
+	if(stat->count == 0 || cycles < stat->min)
+		stat->min = cycles;
+	if(cycles > stat->max)
+		stat->max = cycles;
+	stat->total += cycles;
+	stat->count++;
+
+	// log2 bin (M0 has no CLZ instruction, so shift down)
+	uint8_t bin = 0;
+	while(cycles > 1U && bin < PROFILER_HIST_BINS - 1){
+		cycles >>= 1;
+		bin++;
+	}
+	stat->histogram[bin]++;
+}
+
+//****************************************************************************
+// profiler_get_mean - returns the mean duration of a section in cycles
+//****************************************************************************
+uint32_t profiler_get_mean(profiler_sections section){
+	const profiler_stat_t *stat = &profiler_stats[section];
+	if(stat->count == 0)
+		return 0;
+	return (uint32_t)(stat->total / stat->count);
+}
+
+//****************************************************************************
+// profiler_cycles_to_us - converts a duration in cycles to microseconds
+//****************************************************************************
+uint32_t profiler_cycles_to_us(uint32_t cycles){
+	return cycles / (SYSTIMER_SYSTICK_CLOCK / 1000000U);
+}
+
+//****************************************************************************
+// profiler_reset - clears all statistics
+//****************************************************************************
+void profiler_reset(void){
+	for(uint8_t i = 0; i < PROFILER_SECTION_COUNT; i++){
+		profiler_stat_t *stat = &profiler_stats[i];
+		stat->count = 0;
+		stat->min = 0;
+		stat->max = 0;
+		stat->total = 0;
+		for(uint8_t bin = 0; bin < PROFILER_HIST_BINS; bin++)
+			stat->histogram[bin] = 0;
+	}
+	__disable_irq();
+	for(uint8_t i = 0; i < PROFILER_ISR_COUNT; i++){
+		profiler_isr_stats[i].count = 0;
+		profiler_isr_stats[i].latency_max = 0;
+		profiler_isr_stats[i].cycles_max = 0;
+	}
+	__enable_irq();
+}
+
+//****************************************************************************
+// profiler_isr_record - updates the statistics of an interrupt at the end of its handler (see PROFILER_ISR_EXIT)
+//****************************************************************************
+RAMCODE
+void profiler_isr_record(profiler_isrs isr, const profiler_isr_entry_t *entry){
+	// SysTick counts down, a wrap in between is corrected by one reload period
+	uint32_t end = SysTick->VAL;
+	uint32_t cycles = (entry->start >= end) ? (entry->start - end) : (entry->start + SysTick->LOAD + 1U - end);
+	profiler_isr_stat_t *stat = &profiler_isr_stats[isr];
+
+	// Handlers of a higher priority can interrupt this one, update with interrupts masked
+	__disable_irq();
+	if(entry->latency > stat->latency_max)
+		stat->latency_max = entry->latency;
+	if(cycles > stat->cycles_max)
+		stat->cycles_max = cycles;
+	stat->count++;
+	__enable_irq();
+}
+
+#if PROFILER_ENABLED && PROFILER_ISR_ENABLED && defined(SYSTIMER_ISR_HOOK_ENABLED)
+//****************************************************************************
+// SYSTIMER_IsrHook - records SysTick_Handler (replaces the weak default of SYSTIMER)
+//****************************************************************************
+void SYSTIMER_IsrHook(uint32_t latency, uint32_t cycles){
+	profiler_isr_stat_t *stat = &profiler_isr_stats[PROFILER_ISR_SYSTICK];
+	if(latency > stat->latency_max)
+		stat->latency_max = latency;
+	if(cycles > stat->cycles_max)
+		stat->cycles_max = cycles;
+	stat->count++;
+}
+#endif
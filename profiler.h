@@ -0,0 +1,90 @@
+/*
+ * USB-Changer profiler.h
+ *
+ * Main loop cycle time profiler. Measures sections in CPU cycles using the SysTick tick count and the SysTick->VAL
+ * down-counter (sub-microsecond resolution) and keeps min/max/mean and a log2 histogram per section in RAM.
+ * The statistics (profiler_stats) are meant to be read by a debugger or telemetry.
+ * With PROFILER_ISR_ENABLED the interrupt handlers additionally record their entry latency (time from the hardware
+ * trigger to the first instruction of the handler) and execution time per vector in profiler_isr_stats.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+#define PROFILER_ENABLED			 0							// Determines if profiling code is compiled in (0 removes all PROFILER_* calls)
+#define PROFILER_HIST_BINS			 16							// Bin n counts durations of 2^n to 2^(n+1)-1 cycles. The last bin also holds all longer durations
+#define PROFILER_ISR_ENABLED		 0							// Determines if interrupt latency and execution time are recorded (0 removes all PROFILER_ISR_* calls)
+#define PROFILER_CCU4_CLOCK_SHIFT	 1							// CPU cycles = CCU4 timer clocks >> shift (module clock PCLK = 64MHz is 2 * MCLK)
+
+typedef enum {
+	PROFILER_LOOP_PERIOD,	// Time from start of one main loop pass to the start of the next one (includes sleep)
+	PROFILER_LOOP_PASS,		// Active part of a main loop pass (without sleep)
+	PROFILER_STATUS_LED,	// Status LED pattern instructions (ledpattern_run, main context)
+	PROFILER_BUTTONS,		// buttons_update()
+	PROFILER_RELAY,			// manage_relay()
+	PROFILER_SETUP,			// manage_setup()
+	PROFILER_RELAY_LATENCY,	// Time from the end of the latch time to the relay output switching (relay_update)
+	PROFILER_USB_LATENCY,	// Time from the release of the USB button to the start of its switchover (manage_usb)
+	PROFILER_USB_WRITES,	// Port writes of a USB switchover, first to last pin change (switchUSB)
+	PROFILER_RELAY_ISR,		// Relay decision of a sample in the ADC interrupt (RELAY_IN_ISR, main.c)
+	PROFILER_SECTION_COUNT
+} profiler_sections;
+
+typedef struct {
+	uint32_t count;							// Number of measurements
+	uint32_t min;							// In cycles. Shortest measured duration
+	uint32_t max;							// In cycles. Longest measured duration
+	uint64_t total;							// In cycles. Sum of all durations (mean = total / count)
+	uint32_t histogram[PROFILER_HIST_BINS];	// log2 histogram of durations
+} profiler_stat_t;
+
+typedef enum {
+	PROFILER_ISR_SYSTICK,	// SysTick_Handler (SYSTIMER, latency from the SysTick wrap)
+	PROFILER_ISR_ADC,		// Adc_Measurement_Handler or adc_poll with SENSOR_POLLED (latency from the trigger timer period match, includes the conversion time)
+	PROFILER_ISR_LED_PWM,	// CCU40_0_IRQHandler (ledfade, latency from the PWM period match)
+	PROFILER_ISR_COUNT
+} profiler_isrs;
+
+typedef struct {
+	uint32_t count;			// Number of handler runs
+	uint32_t latency_max;	// In cycles. Longest time from the trigger to the handler entry
+	uint32_t cycles_max;	// In cycles. Longest execution time of the handler
+} profiler_isr_stat_t;
+
+typedef struct {
+	uint32_t start;			// SysTick->VAL at handler entry
+	uint32_t latency;		// In cycles. Time from the trigger to the handler entry
+} profiler_isr_entry_t;
+
+extern profiler_stat_t profiler_stats[PROFILER_SECTION_COUNT];
+extern profiler_isr_stat_t profiler_isr_stats[PROFILER_ISR_COUNT];
+extern const uint8_t profiler_isr_priority[PROFILER_ISR_COUNT];
+
+uint32_t profiler_timestamp(void);
+void profiler_record(profiler_sections section, uint32_t cycles);
+uint32_t profiler_get_mean(profiler_sections section);
+uint32_t profiler_cycles_to_us(uint32_t cycles);
+void profiler_reset(void);
+void profiler_isr_record(profiler_isrs isr, const profiler_isr_entry_t *entry);
+
+#if PROFILER_ENABLED
+	#define PROFILER_START(start_var)			uint32_t start_var = profiler_timestamp()
+	#define PROFILER_STOP(section, start_var)	profiler_record((section), profiler_timestamp() - (start_var))
+#else
+	#define PROFILER_START(start_var)
+	#define PROFILER_STOP(section, start_var)
+#endif
+
+#if PROFILER_ENABLED && PROFILER_ISR_ENABLED
+	#define PROFILER_ISR_ENTER(entry_var, latency)	profiler_isr_entry_t entry_var = {SysTick->VAL, (latency)}
+	#define PROFILER_ISR_EXIT(isr, entry_var)		profiler_isr_record((isr), &(entry_var))
+#else
+	#define PROFILER_ISR_ENTER(entry_var, latency)
+	#define PROFILER_ISR_EXIT(isr, entry_var)
+#endif
+
+#endif /* PROFILER_H */
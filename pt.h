@@ -0,0 +1,87 @@
+/*
+ * USB-Changer pt.h
+ *
+ * Stackless coroutines (protothreads) for sequential flows that wait in between: a thread is a function that runs from
+ * PT_BEGIN to the next wait and returns PT_WAITING, the next call resumes right after that wait. The resume point is
+ * the __LINE__ of the wait, stored in the pt_t of the thread (a switch on it jumps back), so a thread costs the 8 bytes
+ * of its pt_t and no stack of its own. Threads are called from a scheduler task (pt_run), which polls the wait
+ * conditions every task period: a deadline is taken at the first poll at or after it, so the task period is the
+ * resolution of PT_WAIT_DEADLINE and PT_DELAY. PT_WAIT_EVENT waits for bits of an event mask that an interrupt or
+ * another module sets with pt_post and takes (clears) them when the thread continues.
+ * Rules of the switch: local variables do not keep their value across a wait (use static or pt_t members such as
+ * deadline), a thread body must not contain a switch statement itself and only one wait per line.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef PT_H
+#define PT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timing.h"
+#include "critical.h"
+
+typedef enum {
+	PT_WAITING,					// Thread waits (call it again)
+	PT_ENDED					// Thread reached PT_END or PT_EXIT (restarts from PT_BEGIN after pt_init)
+} pt_status;
+
+typedef struct {
+	uint16_t line;				// Resume point (__LINE__ of the wait, 0 = PT_BEGIN)
+	uint32_t deadline;			// In us. Time of PT_WAIT_DEADLINE / PT_DELAY (SYSTIMER_GetTime)
+} pt_t;
+
+typedef pt_status (*pt_thread_t)(pt_t *pt);
+
+#define PT_BEGIN(pt)				 switch((pt)->line){ case 0:
+#define PT_END(pt)					 } (pt)->line = 0; return PT_ENDED
+// Returns until condition is true at a call (checked right away, no wait if it already holds)
+#define PT_WAIT_UNTIL(pt, condition) do{ (pt)->line = __LINE__; case __LINE__: if(!(condition)) return PT_WAITING; }while(0)
+// Returns once, the next call continues
+#define PT_YIELD(pt)				 do{ (pt)->line = __LINE__; return PT_WAITING; case __LINE__: ; }while(0)
+// Ends the thread (the next call restarts it)
+#define PT_EXIT(pt)					 do{ (pt)->line = 0; return PT_ENDED; }while(0)
+// Waits until time (in us, SYSTIMER_GetTime) is reached. The expression is evaluated at every call, so it may move
+#define PT_WAIT_DEADLINE(pt, time)	 PT_WAIT_UNTIL(pt, timing_reached(SYSTIMER_GetTime(), (time)))
+// Waits us microseconds from now
+#define PT_DELAY_US(pt, us)			 do{ (pt)->deadline = timing_deadline_us(SYSTIMER_GetTime(), (us)); PT_WAIT_DEADLINE(pt, (pt)->deadline); }while(0)
+#define PT_DELAY(pt, ms)			 PT_DELAY_US(pt, TIMING_MS_TO_US(ms))
+// Waits for any bit of mask in *events (pt_post) and clears the bits of mask
+#define PT_WAIT_EVENT(pt, events, mask) PT_WAIT_UNTIL(pt, pt_take((events), (mask)) != 0U)
+
+//****************************************************************************
+// pt_init - restarts a thread from PT_BEGIN
+//****************************************************************************
+static inline void pt_init(pt_t *pt){
+	pt->line = 0;
+}
+
+//****************************************************************************
+// pt_run - calls a thread once (a scheduler task calls its threads every period). Returns false once it ended
+//****************************************************************************
+static inline bool pt_run(pt_thread_t thread, pt_t *pt){
+	return thread(pt) == PT_WAITING;
+}
+
+//****************************************************************************
+// pt_post - sets event bits for PT_WAIT_EVENT (main and interrupt context)
+//****************************************************************************
+static inline void pt_post(volatile uint32_t *events, uint32_t bits){
+	critical_state_t primask = critical_enter();
+	*events |= bits;
+	critical_exit(primask, CRITICAL_SITE_EVENTS);
+}
+
+//****************************************************************************
+// pt_take - returns the set bits of mask in *events and clears them
+//****************************************************************************
+static inline uint32_t pt_take(volatile uint32_t *events, uint32_t mask){
+	critical_state_t primask = critical_enter();
+	uint32_t taken = *events & mask;
+	*events &= ~taken;
+	critical_exit(primask, CRITICAL_SITE_EVENTS);
+	return taken;
+}
+
+#endif /* PT_H */
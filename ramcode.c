@@ -0,0 +1,41 @@
+/*
+ * USB-Changer ramcode.c
+ *
+ * SRAM usage report (see ramcode.h). The section limits are symbols of linker_script.ld.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "ramcode.h"
+
+#define RAMCODE_SRAM_START			 0x20000000U				// ORIGIN of region SRAM
+#define RAMCODE_SRAM_END			 0x20004000U				// End of the 16KB SRAM (ORIGIN + LENGTH of region SRAM)
+
+extern uint8_t __ram_code_start[], __ram_code_end[];
+extern uint8_t __data_start[], __data_end[];
+extern uint8_t __bss_start[], __bss_end[];
+extern uint8_t __noinit_start[], __noinit_end[];
+extern uint8_t __arena_start[], __arena_end[];
+extern uint8_t __initial_sp[];
+extern uint8_t Heap_Bank1_Start[], Heap_Bank1_End[];
+
+ramcode_usage_t ramcode_usage;
+
+
+//****************************************************************************
+// ramcode_report - records the size of the SRAM sections in ramcode_usage
+//****************************************************************************
+void ramcode_report(void){
+	if(!RAMCODE_REPORT_ENABLED)
+		return;
+
+	ramcode_usage.ram_code = (uint16_t)(__ram_code_end - __ram_code_start);
+	ramcode_usage.data = (uint16_t)(__data_end - __data_start);
+	ramcode_usage.bss = (uint16_t)(__bss_end - __bss_start);
+	ramcode_usage.noinit = (uint16_t)(__noinit_end - __noinit_start);
+	ramcode_usage.arena = (uint16_t)(__arena_end - __arena_start);
+	ramcode_usage.stack = (uint16_t)((uint32_t)(uintptr_t)__initial_sp - RAMCODE_SRAM_START);
+	ramcode_usage.no_init = (uint16_t)(RAMCODE_SRAM_END - (uint32_t)(uintptr_t)Heap_Bank1_End);
+	ramcode_usage.free = (uint16_t)(Heap_Bank1_End - Heap_Bank1_Start);
+}
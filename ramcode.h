@@ -0,0 +1,51 @@
+/*
+ * USB-Changer ramcode.h
+ *
+ * Placement of hot code in SRAM. Functions marked RAMCODE go to the .ram_code section of linker_script.ld, which the
+ * startup code copies from flash to SRAM before main, and run without flash wait states. Calls between RAM and flash
+ * functions go through linker long-branch veneers, so only whole hot paths (interrupt handlers and the functions they
+ * call per event) are worth moving. The linker checks the section against ram_code_budget. ramcode_report records how
+ * the 16KB SRAM is split between the sections (ramcode_usage, meant to be read by a debugger or telemetry).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef RAMCODE_H
+#define RAMCODE_H
+
+#include <stdint.h>
+#include "xmc_common.h"
+
+#define RAMCODE_ENABLED				 1							// Determines if RAMCODE functions are placed in SRAM (0 leaves all code in flash)
+#define RAMCODE_REPORT_ENABLED		 0							// Determines if ramcode_report fills ramcode_usage at boot (debugger diagnostics, its flash is saved without)
+
+// Buffers whose content is only read after it was written (rings with separate indices) skip the clearing at startup
+#define NOINIT							 __attribute__((section(".noinit")))
+
+#if RAMCODE_ENABLED && defined(__GNUC__) && defined(__arm__)
+	// Target build only (the host build keeps the empty __RAM_FUNC of its shim). A section of its own per function (.ram_code.<n>), so --gc-sections drops the ones nothing calls in this build
+	#define RAMCODE_SECTION_NAME(n)		".ram_code." #n
+	#define RAMCODE_SECTION(n)			__attribute__((section(RAMCODE_SECTION_NAME(n)), long_call))
+	#define RAMCODE						RAMCODE_SECTION(__COUNTER__)
+#elif RAMCODE_ENABLED
+	#define RAMCODE						__RAM_FUNC
+#else
+	#define RAMCODE
+#endif
+
+typedef struct {
+	uint16_t ram_code;		// In bytes. Functions executed from SRAM (.ram_code)
+	uint16_t data;			// In bytes. Initialized variables (.data)
+	uint16_t bss;			// In bytes. Zero initialized variables (.bss)
+	uint16_t noinit;		// In bytes. Buffers not cleared at startup (.noinit)
+	uint16_t arena;			// In bytes. Slots of the static arena (.arena, see arena.h)
+	uint16_t stack;			// In bytes. Reserved main stack (stack_size, interrupt veneers included)
+	uint16_t no_init;		// In bytes. Variables kept over a reset (.no_init)
+	uint16_t free;			// In bytes. Unused SRAM between .arena and .no_init (heap)
+} ramcode_usage_t;
+
+extern ramcode_usage_t ramcode_usage;
+
+void ramcode_report(void);
+
+#endif /* RAMCODE_H */
@@ -0,0 +1,175 @@
+/*
+ * USB-Changer recorder.c
+ *
+ * Field trace recorder (see recorder.h). The current window has one producer (ADC interrupt) and is only completed
+ * by the main context (recorder_trigger): the interrupt freezes it at stop and starts the next one, so a frozen window
+ * is never written again until its slot comes round.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "recorder.h"
+#include "ramcode.h"
+
+typedef char recorder_buffer_size_check[(sizeof(recorder_buffer_t) == RECORDER_BUFFER_SIZE) ? 1 : -1];
+typedef char recorder_samples_check[((RECORDER_BLOCK_SAMPLES & (RECORDER_BLOCK_SAMPLES - 1)) == 0 && (RECORDER_BLOCKS & (RECORDER_BLOCKS - 1)) == 0
+		&& RECORDER_POST_SAMPLES < RECORDER_SAMPLES && RECORDER_DECIMATION >= 1 && RECORDER_DECIMATION <= 255) ? 1 : -1];
+
+recorder_buffer_t recorder_buffer __attribute__((section(".no_init")));
+volatile bool recorder_running = false;
+uint32_t recorder_sample_rate = 0;		// In mHz. Stored in every started window
+
+
+//****************************************************************************
+// recorder_start - starts recording into the next window slot (overwrites the oldest window)
+//****************************************************************************
+RAMCODE
+void recorder_start(void){
+	// No division in the interrupt (the Cortex-M0 has no divider)
+	uint8_t current = recorder_buffer.current + 1U;
+	recorder_buffer.current = (current < RECORDER_WINDOWS) ? current : 0U;
+	recorder_window_t *window = &recorder_buffer.windows[recorder_buffer.current];
+	window->state = RECORDER_STATE_EMPTY;
+	window->sequence = ++recorder_buffer.sequence;
+	window->count = 0;
+	window->stop = 0;
+	window->switch_time = 0;
+	window->sample_rate = recorder_sample_rate;
+	window->flags = (SENSOR_CALIBRATION ? RECORDER_FLAG_CALIBRATED : 0U) | ((RECORDER_DECIMATION > 1) ? RECORDER_FLAG_DECIMATED : 0U);
+	window->decimation = RECORDER_DECIMATION;
+	window->phase = 0;
+	window->state = RECORDER_STATE_RECORDING;
+}
+
+//****************************************************************************
+// recorder_init - keeps the frozen windows of the last run (clears them after power on) and starts recording. A window
+//                 a reset ended after its switch is kept as truncated, one without a switch is recorded again
+//****************************************************************************
+void recorder_init(uint32_t sample_rate){
+#if RECORDER_ENABLED
+	recorder_running = false;
+	recorder_sample_rate = sample_rate;
+	if(recorder_buffer.magic != RECORDER_MAGIC || recorder_buffer.current >= RECORDER_WINDOWS){
+		recorder_buffer.magic = RECORDER_MAGIC;
+		recorder_buffer.sequence = 0;
+		recorder_buffer.current = 0;
+		for(uint8_t i = 0; i < RECORDER_WINDOWS; i++)
+			recorder_buffer.windows[i].state = RECORDER_STATE_EMPTY;
+	}
+	recorder_window_t *window = &recorder_buffer.windows[recorder_buffer.current];
+	if(window->state == RECORDER_STATE_POST){
+		window->flags |= RECORDER_FLAG_TRUNCATED;
+		window->state = RECORDER_STATE_FROZEN;
+	}
+	// The slot of a window without a switch is reused
+	if(window->state != RECORDER_STATE_FROZEN)
+		recorder_buffer.current = (recorder_buffer.current != 0) ? (uint8_t)(recorder_buffer.current - 1U) : (uint8_t)(RECORDER_WINDOWS - 1U);
+	recorder_start();
+	recorder_running = true;
+#else
+	(void)sample_rate;
+#endif
+}
+
+//****************************************************************************
+// recorder_push - records a raw result sampled at timestamp (SYSTIMER_GetTime) with the state of the filter and relay
+//                 channel it is evaluated with next (ADC result interrupt, before the filter)
+//****************************************************************************
+RAMCODE
+void recorder_push(uint16_t value, uint32_t timestamp, const filter_t *filter, const relay_channel_t *channel){
+	if(!recorder_running)
+		return;
+	recorder_window_t *window = &recorder_buffer.windows[recorder_buffer.current];
+	if(window->phase != 0){
+		window->phase--;
+		return;
+	}
+	window->phase = RECORDER_DECIMATION - 1U;
+
+	uint32_t count = window->count;
+	uint32_t ticks = 0;
+	if(count != 0){
+		// Ticks since the previous sample without a division (normally 0 or 1)
+		uint32_t elapsed = timestamp - window->last_time;
+		while(elapsed >= SYSTIMER_TICK_PERIOD_US && ticks < RECORDER_TICKS_MAX){
+			elapsed -= SYSTIMER_TICK_PERIOD_US;
+			ticks++;
+		}
+		if(elapsed >= SYSTIMER_TICK_PERIOD_US)
+			window->flags |= RECORDER_FLAG_GAP;
+	}
+	else
+		window->filter = (uint8_t)filter->type;
+
+	if((count & (RECORDER_BLOCK_SAMPLES - 1U)) == 0){
+		recorder_snapshot_t *snapshot = &window->snapshots[(count / RECORDER_BLOCK_SAMPLES) & (RECORDER_BLOCKS - 1U)];
+		snapshot->time = timestamp;
+		snapshot->upper_exceed_timestamp = channel->upper_exceed_timestamp;
+		snapshot->lower_exceed_timestamp = channel->lower_exceed_timestamp;
+		snapshot->state = (uint8_t)channel->state;
+		snapshot->latch_shift = channel->latch_shift;
+		snapshot->iir_state = filter->iir_state;
+		snapshot->sum = filter->sum;
+		snapshot->primed = filter->primed;
+		snapshot->index = filter->index;
+		for(uint8_t i = 0; i < FILTER_WINDOW_SIZE; i++)
+			snapshot->window[i] = filter->window[i];
+	}
+
+	window->samples[count & (RECORDER_SAMPLES - 1U)] = sample_tagged(value, (uint8_t)ticks);
+	window->last_time = timestamp;
+	window->count = ++count;
+	if(window->state == RECORDER_STATE_POST && count == window->stop){
+		window->state = RECORDER_STATE_FROZEN;
+		recorder_start();
+	}
+}
+
+//****************************************************************************
+// recorder_trigger - completes the window at a relay switch detected at timestamp: RECORDER_POST_SAMPLES more samples
+//                    are recorded (main context, after relay_update switched the channel)
+//****************************************************************************
+void recorder_trigger(const relay_channel_t *channel, uint32_t timestamp){
+#if RECORDER_ENABLED
+	recorder_window_t *window = &recorder_buffer.windows[recorder_buffer.current];
+	// A switch during the post samples of the last one is part of its window
+	if(!recorder_running || window->state != RECORDER_STATE_RECORDING)
+		return;
+	window->switch_time = timestamp;
+	window->new_state = (uint8_t)channel->state;
+	// The set the switch was decided with (relay_thresholds)
+	const relay_thresholds_t *thresholds = relay_thresholds(channel);
+	window->upper_threshold = thresholds->upper_threshold;
+	window->lower_threshold = thresholds->lower_threshold;
+	window->latchtime = thresholds->latchtime;
+	window->predict_rate = (uint16_t)channel->predict_rate;
+	if(channel->predict_rate > 0)
+		window->flags |= RECORDER_FLAG_PREDICTED;
+	if(channel->limited)
+		window->flags |= RECORDER_FLAG_LIMITED;
+	window->stop = window->count + RECORDER_POST_SAMPLES;
+	window->state = RECORDER_STATE_POST; // After stop, the interrupt reads both
+#else
+	(void)channel;
+	(void)timestamp;
+#endif
+}
+
+//****************************************************************************
+// recorder_restore - sets a filter (its type is kept) and a relay channel to the state of a snapshot (replay)
+//****************************************************************************
+void recorder_restore(const recorder_snapshot_t *snapshot, filter_t *filter, relay_channel_t *channel){
+	filter->iir_state = snapshot->iir_state;
+	filter->sum = snapshot->sum;
+	filter->primed = snapshot->primed;
+	filter->index = snapshot->index;
+	for(uint8_t i = 0; i < FILTER_WINDOW_SIZE; i++)
+		filter->window[i] = snapshot->window[i];
+	channel->state = (relay_states)snapshot->state;
+	channel->upper_exceed_timestamp = snapshot->upper_exceed_timestamp;
+	channel->lower_exceed_timestamp = snapshot->lower_exceed_timestamp;
+	channel->latch_shift = snapshot->latch_shift;
+	channel->slope = 0;
+	channel->slope_time = 0;
+}
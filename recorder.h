@@ -0,0 +1,110 @@
+/*
+ * USB-Changer recorder.h
+ *
+ * Field trace recorder. The ADC result interrupt stores the raw results of one sensor channel (before filter and
+ * calibration) in a ring of RECORDER_SAMPLES samples in no-init RAM (recorder_push). A relay switch of the channel
+ * (recorder_trigger) records RECORDER_POST_SAMPLES more and freezes the window, recording goes on in the next one,
+ * so the last RECORDER_WINDOWS - 1 switches are kept, also across a warm reset (watchdog, fault, reset pin).
+ * A sample takes 2 bytes: the result in bits 0-11 and the SysTick ticks since the previous sample as the tag in bits
+ * 12-15 (tagged sample of sample.h). At the first sample of every block of RECORDER_BLOCK_SAMPLES the state of the
+ * filter and the relay channel is stored in a snapshot, so a window can be replayed from its oldest complete block: tools/host/tracereplay feeds the samples
+ * with the reconstructed timestamps (SYSTIMER_GetTime) through the unchanged filter and relay sources and compares the
+ * switch with the recorded one, also with other thresholds, latch time or filter for offline tuning.
+ * The replay is bit-exact with RECORDER_DECIMATION 1 (every result is recorded) and ADC_BOUNDARY_EVENTS (thresholds
+ * checked with the same timestamp in the interrupt), only the main loop may detect an expired latch time later than
+ * the replay. A larger decimation gives a longer window for viewing, but the filter and thresholds then see only every
+ * n-th result (RECORDER_FLAG_DECIMATED). With the predictive latch (predict_rate of the channel) only the latch time
+ * reduction is in the snapshots, the slope starts flat at the block, so a crossing in its first ms may replay later.
+ * Read recorder_buffer with a debugger ("recorder_dump" of tools/profiler_report.gdb writes recorder.bin).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "filter.h"
+#include "relay.h"
+#include "sample.h"
+
+#ifndef RECORDER_ENABLED
+#define RECORDER_ENABLED			 0							// Determines if the ADC interrupt feeds the recorder (0 removes recorder_push, the host build sets it, tools/host/Makefile)
+#endif
+#define RECORDER_CHANNEL			 0							// Sensor channel that is recorded
+#define RECORDER_DECIMATION			 1							// Every n-th result is recorded (1 = all, needed for a bit-exact replay)
+#define RECORDER_BLOCK_SAMPLES		 64							// Samples per block (power of 2), a block starts with a filter and relay snapshot
+#define RECORDER_BLOCKS				 4							// Blocks per window (power of 2)
+#define RECORDER_SAMPLES			 (RECORDER_BLOCK_SAMPLES * RECORDER_BLOCKS)	// Samples per window (2 bytes each)
+#define RECORDER_POST_SAMPLES		 64							// Samples recorded after the switch (the rest of the window is before it)
+#define RECORDER_WINDOWS			 2							// Number of windows (the one being recorded and the last frozen ones)
+#define RECORDER_TICKS_MAX			 SAMPLE_TAG_MAX				// Largest tick difference (saturated, RECORDER_FLAG_GAP)
+#define RECORDER_MAGIC				 0x5EC0DE01U				// Marks a buffer written by this firmware
+#define RECORDER_BUFFER_SIZE		 1444						// sizeof(recorder_buffer_t), reserved in .no_init by the linker script
+
+#define RECORDER_FLAG_CALIBRATED	 0x01U						// Results are converted by the calibration table before the thresholds (not replayed)
+#define RECORDER_FLAG_DECIMATED		 0x02U						// Not every result is recorded (RECORDER_DECIMATION > 1)
+#define RECORDER_FLAG_GAP			 0x04U						// A tick difference was saturated (the timestamps after it are too early)
+#define RECORDER_FLAG_TRUNCATED		 0x08U						// A reset ended the window before all post samples were recorded
+#define RECORDER_FLAG_PREDICTED		 0x10U						// The latch time was shortened by the slope (predict_rate at the switch, replayed approximately)
+#define RECORDER_FLAG_LIMITED		 0x20U						// The switch was held back by the rate limiter (replayed without, see relay.h)
+
+typedef enum {
+	RECORDER_STATE_EMPTY,		// Never recorded
+	RECORDER_STATE_RECORDING,	// The interrupt overwrites the oldest samples
+	RECORDER_STATE_POST,		// Triggered, the interrupt records until stop
+	RECORDER_STATE_FROZEN		// Window complete, kept until its slot is recorded again
+} recorder_states;
+
+typedef struct {
+	uint32_t time;							// In us. SYSTIMER_GetTime of the first sample of the block
+	uint32_t upper_exceed_timestamp;		// Relay channel before the first sample
+	uint32_t lower_exceed_timestamp;
+	int32_t iir_state;						// Filter before the first sample (filter_t)
+	uint32_t sum;
+	uint16_t window[FILTER_WINDOW_SIZE];
+	uint8_t primed;
+	uint8_t index;
+	uint8_t state;							// relay_states
+	uint8_t latch_shift;					// Latch time reduction of the relay channel
+} recorder_snapshot_t;
+
+typedef struct {
+	uint32_t sequence;						// Number of the window since power on (1 = first)
+	uint32_t count;							// Number of recorded samples (next write at count % RECORDER_SAMPLES)
+	uint32_t stop;							// count the window freezes at
+	uint32_t last_time;						// In us. SYSTIMER_GetTime of the last recorded sample
+	uint32_t switch_time;					// In us. SYSTIMER_GetTime the relay switch was detected at
+	uint32_t sample_rate;					// In mHz. Conversion rate of the sensor (sensor_get_sample_rate, 0 = sample task)
+	int32_t upper_threshold;				// Relay setup at the switch
+	int32_t lower_threshold;
+	int32_t latchtime;						// In ms
+	uint8_t state;							// recorder_states
+	uint8_t new_state;						// relay_states after the switch
+	uint8_t filter;							// filter_types
+	uint8_t flags;							// RECORDER_FLAG_*
+	uint8_t decimation;						// RECORDER_DECIMATION
+	uint8_t phase;							// Results left until the next recorded one
+	uint16_t predict_rate;					// Relay setup at the switch, ADC values per ms (0 = full latch time)
+	recorder_snapshot_t snapshots[RECORDER_BLOCKS];	// Index: block number % RECORDER_BLOCKS
+	uint16_t samples[RECORDER_SAMPLES];
+} recorder_window_t;
+
+typedef struct {
+	uint32_t magic;							// RECORDER_MAGIC (anything else: no recording, e.g. after power on)
+	uint32_t sequence;						// Number of started windows since power on
+	uint8_t current;						// Window being recorded
+	uint8_t reserved[3];
+	recorder_window_t windows[RECORDER_WINDOWS];
+} recorder_buffer_t;
+
+extern recorder_buffer_t recorder_buffer;
+extern volatile bool recorder_running;		// Set by recorder_init, recorder_push does nothing before
+
+void recorder_init(uint32_t sample_rate);
+void recorder_push(uint16_t value, uint32_t timestamp, const filter_t *filter, const relay_channel_t *channel);
+void recorder_trigger(const relay_channel_t *channel, uint32_t timestamp);
+void recorder_restore(const recorder_snapshot_t *snapshot, filter_t *filter, relay_channel_t *channel);
+
+#endif /* RECORDER_H */
@@ -0,0 +1,640 @@
+/*
+ * USB-Changer relay.c
+ *
+ * Hysteresis comparator with latch time per sensor channel (see relay.h).
+ * The threshold comparison can either run in relay_update() for every sample or ahead of it in the ADC interrupt
+ * (relay_check_thresholds), in which case relay_update() only evaluates the latch time.
+ * The slope of the predictive latch is stepped once per ms of timestamps without a division: the first value after at
+ * least 1ms is compared with the value the step started from, a gap of 2ms or more counts as a flat step.
+ * The dwell and window times of the limiter are unsigned elapsed times. They alias after the 71 minute wrap of the
+ * timestamps, which can hold a switch back by at most one dwell time or window once in a long quiet period.
+ * A fault is detected and its safe state driven by the ADC interrupt, also while relay_update runs in the main loop:
+ * a switch of relay_update checks the fault again after driving its output, so a safe state driven in between is
+ * restored at once and never overwritten for longer than a few instructions.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "relay.h"
+#include "timing.h"
+#include "ramcode.h"
+#include "trace.h"
+#include "profiler.h"
+#include "fieldhist.h"
+#include "coil.h"
+#include "bistable.h"
+#include "relaytime.h"
+#include "expander.h"
+#include "zerocross.h"
+#include "metrics.h"
+#include "divide.h"
+#include "container.h"
+
+#define RELAY_CYCLES_PER_US			 (SYSTIMER_SYSTICK_CLOCK / 1000000U)
+#define RELAY_RATE_WINDOW_US		 TIMING_MS_TO_US(RELAY_RATE_WINDOW)
+#define RELAY_SLOPE_FLAT_US			 TIMING_MS_TO_US(2U)			// Gap of the slope step that counts as flat
+#define RELAY_FAULT_RAIL_US			 TIMING_MS_TO_US(RELAY_FAULT_RAIL_TIME)
+#define RELAY_FAULT_CLEAR_US		 TIMING_MS_TO_US(RELAY_FAULT_CLEAR_TIME)
+#define RELAY_FAULT_RAW_NONE		 0xFFFFU					// fault_raw before the first result
+#define RELAY_AREA_STEP_MAX_US		 TIMING_MS_TO_US(RELAY_AREA_STEP_MAX)
+#define RELAY_ADAPT_STEPS			 25							// Entries of relay_adapt_tail
+#define RELAY_ADAPT_PER_DAY			 4971U						// 2^32 / ms per day * 100 (false switches per day -> chance per try in Q32)
+
+typedef char relay_window_check[(RELAY_RATE_WINDOW <= TIMING_MS_MAX && RELAY_FAULT_RAIL_TIME <= TIMING_MS_MAX
+		&& RELAY_FAULT_CLEAR_TIME <= TIMING_MS_MAX && RELAY_FAULT_LOW_LIMIT < RELAY_FAULT_HIGH_LIMIT) ? 1 : -1];
+// An area step (excess * time of one result) fits 32 bits
+typedef char relay_area_check[(RELAY_AREA_STEP_MAX_US <= UINT32_MAX / (SENSOR_VALUE_MAX + 1U) && RELAY_LATCH_AREA <= RELAY_LATCH_AREA_MAX) ? 1 : -1];
+// The chance limit of the largest adapt_rate fits 32 bits
+typedef char relay_adapt_check[(RELAY_ADAPT_CORRELATION >= 1 && RELAY_ADAPT_CORRELATION <= UINT32_MAX / 0xFFFFU / RELAY_ADAPT_PER_DAY) ? 1 : -1];
+
+#if TRACE_THRESHOLDS_ENABLED
+	#define RELAY_TRACE_THRESHOLD(channel, flags)	TRACE(TRACE_THRESHOLD, (channel) - relay_channels, (flags))
+#else
+	#define RELAY_TRACE_THRESHOLD(channel, flags)
+#endif
+
+// Channel contexts (index is the sensor channel). Thresholds and latch time are the reset values, they are overwritten by the setup
+relay_channel_t relay_channels[SENSOR_CHANNEL_COUNT] = {
+	{.output = &IO_RELAY, .upper_threshold = 3393, .lower_threshold = 702, .latchtime = 500, .state = RELAY_LOW, .predict_rate = RELAY_PREDICT_RATE,
+		.min_high_time = RELAY_MIN_HIGH_TIME, .min_low_time = RELAY_MIN_LOW_TIME, .switch_rate_max = RELAY_RATE_MAX,
+		.fault_detect = RELAY_FAULT_ENABLED, .safe_state = RELAY_FAULT_SAFE_STATE, .latch_area = RELAY_LATCH_AREA, .area_leak = RELAY_AREA_LEAK,
+		.adapt_rate = RELAY_ADAPT_RATE, .adapt_min = RELAY_ADAPT_MIN}
+};
+METRICS_REGISTER(relay_cycles, METRICS_ID_RELAY_CYCLES, METRICS_TYPE_U32, METRICS_UNIT_COUNT, relay_channels[0].cycles);
+#if RELAY_FAULT_ENABLED
+METRICS_REGISTER(relay_faults, METRICS_ID_RELAY_FAULTS, METRICS_TYPE_U16, METRICS_UNIT_COUNT, relay_channels[0].fault_count);
+#endif
+METRICS_REGISTER(relay_state, METRICS_ID_RELAY_STATE, METRICS_TYPE_ENUM(relay_channels[0].state), METRICS_UNIT_STATE, relay_channels[0].state);
+METRICS_REGISTER(relay_upper_threshold, METRICS_ID_UPPER_THRESHOLD, METRICS_TYPE_S32, METRICS_UNIT_ADC, relay_channels[0].upper_threshold);
+METRICS_REGISTER(relay_lower_threshold, METRICS_ID_LOWER_THRESHOLD, METRICS_TYPE_S32, METRICS_UNIT_ADC, relay_channels[0].lower_threshold);
+
+#if RELAY_ADAPT_ENABLED
+// Chance that Gaussian noise exceeds z standard deviations (upper tail), z = index / 4 from 0 to 6, in Q32
+const uint32_t relay_adapt_tail[RELAY_ADAPT_STEPS] = {
+	2147483648U, 1723543207U, 1325158638U, 973357067U, 681419127U, 453762323U, 286934745U, 172052769U, 97711073U,
+	52503710U, 26670309U, 12797986U, 5797768U, 2478304U, 999134U, 379749U, 136027U, 45907U, 14593U, 4368U, 1231U,
+	327U, 82U, 19U, 4U
+};
+#endif
+
+
+//****************************************************************************
+// relay_output - sets the output of a channel at once (IO_RELAY through the coil economiser, a chain output through the expander image)
+//****************************************************************************
+RAMCODE
+void relay_output(const relay_channel_t *channel, bool on){
+#if EXPANDER_ENABLED
+	if(channel->expander_output != 0){
+		expander_set(channel->expander_output - 1U, on);
+		return;
+	}
+#endif
+	if(channel->output == NULL)
+		return;
+	if(channel->output == &IO_RELAY)
+		relaytime_driven(on);
+#if COIL_ENABLED
+	if(channel->output == &IO_RELAY){
+		coil_set(on);
+		return;
+	}
+#endif
+#if BISTABLE_ENABLED
+	if(channel->output == &IO_RELAY){
+		bistable_set(on);
+		return;
+	}
+#endif
+	if(on)
+		DIGITAL_IO_SetOutputHigh(channel->output);
+	else
+		DIGITAL_IO_SetOutputLow(channel->output);
+}
+
+//****************************************************************************
+// relay_drive - sets the output of a channel, a change of IO_RELAY waits for a zero cross of the load voltage (ZEROCROSS_ENABLED)
+//****************************************************************************
+RAMCODE
+void relay_drive(const relay_channel_t *channel, bool on){
+#if ZEROCROSS_ENABLED
+	if(channel->output == &IO_RELAY && channel->expander_output == 0 && zerocross_schedule(channel, on))
+		return;
+#endif
+	relay_output(channel, on);
+}
+
+//****************************************************************************
+// relay_init - switches all outputs off (RELAY_LOW) or to states (relay_states per channel, warm reset)
+//****************************************************************************
+void relay_init(const uint8_t *states){
+	relay_publish();
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		relay_channel_t *channel = &relay_channels[i];
+		channel->state = (states != NULL) ? (relay_states)states[i] : RELAY_LOW;
+		channel->upper_exceed_timestamp = 0;
+		channel->lower_exceed_timestamp = 0;
+		channel->slope = 0;
+		channel->slope_time = 0;
+		channel->latch_shift = 0;
+		channel->limited = false;
+		channel->window_switches = 0;
+		channel->window_start = 0;
+		channel->switch_time = 0;
+		channel->fault = RELAY_FAULT_NONE;
+		channel->fault_raw = RELAY_FAULT_RAW_NONE;
+		channel->rail_time = 0;
+		channel->area = 0;
+		channel->area_time = 0;
+		channel->latch_adapted = RELAY_ADAPT_NONE;
+		relay_drive(channel, channel->state == RELAY_HIGH);
+	}
+}
+
+//****************************************************************************
+// relay_publish - publishes the working copies of thresholds and latch time that changed (main context only). Returns true if any changed
+//****************************************************************************
+bool relay_publish(void){
+	bool changed = false;
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		relay_channel_t *channel = &relay_channels[i];
+		uint8_t index = channel->published_index;
+		const relay_thresholds_t *active = &channel->published[index];
+		if(active->upper_threshold == channel->upper_threshold && active->lower_threshold == channel->lower_threshold
+				&& active->latchtime == channel->latchtime)
+			continue;
+		// Readers never hold the spare: the buffer they take only changes by the index store below
+		relay_thresholds_t *spare = &channel->published[index ^ 1U];
+		spare->upper_threshold = channel->upper_threshold;
+		spare->lower_threshold = channel->lower_threshold;
+		spare->latchtime = channel->latchtime;
+		CONTAINER_BARRIER();
+		channel->published_index = (uint8_t)(index ^ 1U);
+		changed = true;
+	}
+	return changed;
+}
+
+//****************************************************************************
+// relay_predict - steps the slope with a value sampled at timestamp and shortens a running latch time of a fast crossing
+//****************************************************************************
+RAMCODE
+void relay_predict(relay_channel_t *channel, uint32_t value, uint32_t timestamp){
+#if RELAY_PREDICT_ENABLED
+	uint32_t elapsed = timestamp - channel->slope_time;
+	if(elapsed < TIMING_US_PER_MS)
+		return;
+	int32_t step = 0;
+	if(elapsed < RELAY_SLOPE_FLAT_US)
+		step = ((int32_t)value - (int32_t)channel->slope_value) * RELAY_SLOPE_SCALE;
+	channel->slope += (step - channel->slope) >> RELAY_SLOPE_SHIFT; // Arithmetic shift of the signed difference
+	channel->slope_time = timestamp;
+	channel->slope_value = value;
+
+	// Only the slope towards the threshold of the running latch time counts
+	int32_t slope;
+	if(channel->state == RELAY_LOW){
+		if(channel->upper_exceed_timestamp == 0)
+			return;
+		slope = channel->slope;
+	}
+	else{
+		if(channel->lower_exceed_timestamp == 0)
+			return;
+		slope = -channel->slope;
+	}
+	int32_t rate = channel->predict_rate * RELAY_SLOPE_SCALE;
+	if(rate <= 0)
+		return;
+	uint8_t shift = 0;
+	while(shift < RELAY_PREDICT_SHIFT_MAX && slope >= rate){
+		rate <<= 1;
+		shift++;
+	}
+	if(shift > channel->latch_shift)
+		channel->latch_shift = shift;
+#else
+	(void)channel;
+	(void)value;
+	(void)timestamp;
+#endif
+}
+
+//****************************************************************************
+// relay_integrate - adds the excess of a value sampled at timestamp beyond the threshold of the next switch to the area
+//                   (area latch). Returns true if the area reached latch_area with this value
+//****************************************************************************
+RAMCODE
+bool relay_integrate(relay_channel_t *channel, uint32_t value, uint32_t timestamp){
+#if RELAY_AREA_ENABLED
+	uint32_t elapsed = timestamp - channel->area_time;
+	channel->area_time = timestamp;
+	if(channel->latch_area == 0 || channel->fault != RELAY_FAULT_NONE)
+		return false;
+	if(elapsed > RELAY_AREA_STEP_MAX_US)
+		elapsed = RELAY_AREA_STEP_MAX_US;
+
+	// Excess towards the next switch: positive beyond its threshold by more than the leak, negative on a dip
+	const relay_thresholds_t *thresholds = relay_thresholds(channel);
+	int32_t excess = (channel->state == RELAY_LOW) ? (int32_t)value - thresholds->upper_threshold : thresholds->lower_threshold - (int32_t)value;
+	excess -= channel->area_leak;
+	uint32_t target = channel->latch_area * TIMING_US_PER_MS;
+	uint32_t area = channel->area;
+	if(area >= target)
+		return false; // Already due, held back by the rate limiter
+	if(excess > 0){
+		uint32_t step = (uint32_t)excess * elapsed;
+		area = (step >= target - area) ? target : area + step;
+	}
+	else{
+		uint32_t step = (uint32_t)(-excess) * elapsed;
+		area = (step >= area) ? 0U : area - step;
+	}
+	channel->area = area;
+	if(area < target)
+		return false;
+	channel->area_due = timestamp;
+	return true;
+#else
+	(void)channel;
+	(void)value;
+	(void)timestamp;
+	return false;
+#endif
+}
+
+//****************************************************************************
+// relay_mark_exceeded - starts the latch time of a crossing of the upper (upper = true) or lower threshold at timestamp
+//                       (ADC value or comparator edge). Returns false if that crossing is already running
+//****************************************************************************
+bool relay_mark_exceeded(relay_channel_t *channel, bool upper, uint32_t timestamp){
+	// A faulted sensor starts no latch time
+	if(channel->fault != RELAY_FAULT_NONE)
+		return false;
+	if(upper){
+		if(channel->upper_exceed_timestamp != 0)
+			return false;
+		channel->upper_exceed_timestamp = timestamp;
+		if(channel->state == RELAY_LOW){
+			channel->latch_shift = 0; // New crossing, full latch time until the slope shortens it
+			channel->limited = false;
+		}
+		RELAY_TRACE_THRESHOLD(channel, TRACE_THRESHOLD_UPPER | TRACE_THRESHOLD_EXCEEDED);
+	}
+	else{
+		if(channel->lower_exceed_timestamp != 0)
+			return false;
+		channel->lower_exceed_timestamp = timestamp;
+		if(channel->state == RELAY_HIGH){
+			channel->latch_shift = 0;
+			channel->limited = false;
+		}
+		RELAY_TRACE_THRESHOLD(channel, TRACE_THRESHOLD_EXCEEDED);
+	}
+	return true;
+}
+
+//****************************************************************************
+// relay_check_thresholds - boundary check of a value (ADC interrupt or main context). Returns true if a threshold got crossed
+//****************************************************************************
+RAMCODE
+bool relay_check_thresholds(relay_channel_t *channel, uint32_t value, uint32_t timestamp){
+	// Check if a threshold is exceeded. If it is and timestamp is not already set - save timestamp. If timestamp is already saved and threshold is not exceeded anymore reset timestamp (equality keeps the current state)
+	bool crossed = false;
+	const relay_thresholds_t *thresholds = relay_thresholds(channel);
+	int32_t upper_threshold = thresholds->upper_threshold;
+	int32_t lower_threshold = thresholds->lower_threshold;
+	if(channel->upper_exceed_timestamp == 0 && value > upper_threshold){
+		crossed = relay_mark_exceeded(channel, true, timestamp);
+	}
+	else if(channel->upper_exceed_timestamp != 0 && value < upper_threshold){
+		channel->upper_exceed_timestamp = 0;
+		crossed = true;
+		RELAY_TRACE_THRESHOLD(channel, TRACE_THRESHOLD_UPPER);
+	}
+	if(channel->lower_exceed_timestamp == 0 && value < lower_threshold){
+		crossed = relay_mark_exceeded(channel, false, timestamp) || crossed;
+	}
+	else if(channel->lower_exceed_timestamp != 0 && value > lower_threshold){
+		channel->lower_exceed_timestamp = 0;
+		crossed = true;
+		RELAY_TRACE_THRESHOLD(channel, 0);
+	}
+	relay_predict(channel, value, timestamp);
+	// A due area latch is a crossing too (the main loop evaluates it like a threshold crossed by the ADC interrupt)
+	crossed = relay_integrate(channel, value, timestamp) || crossed;
+	return crossed;
+}
+
+//****************************************************************************
+// relay_latch_running - returns true if the threshold relevant for the current state is exceeded (latch time is running)
+//****************************************************************************
+bool relay_latch_running(const relay_channel_t *channel){
+#if RELAY_AREA_ENABLED
+	if(channel->latch_area != 0)
+		return channel->area != 0;
+#endif
+	if(channel->state == RELAY_LOW)
+		return channel->upper_exceed_timestamp != 0;
+	return channel->lower_exceed_timestamp != 0;
+}
+
+//****************************************************************************
+// relay_latch_deadline - gets the time (in us) the latch time of the current state expires, like relay_update computes it.
+//                        Returns false if none is running (or the channel uses the area latch, which has no deadline)
+//****************************************************************************
+RAMCODE
+bool relay_latch_deadline(const relay_channel_t *channel, uint32_t *deadline){
+#if RELAY_AREA_ENABLED
+	if(channel->latch_area != 0)
+		return false;
+#endif
+	uint32_t exceed_timestamp = (channel->state == RELAY_LOW) ? channel->upper_exceed_timestamp : channel->lower_exceed_timestamp;
+	if(exceed_timestamp == 0)
+		return false;
+	*deadline = timing_deadline(exceed_timestamp, (relay_latchtime(channel) >> channel->latch_shift) + 1U);
+	return true;
+}
+
+//****************************************************************************
+// relay_latchtime - returns the latch time in ms the channel uses (latchtime or the shorter adapted one)
+//****************************************************************************
+RAMCODE
+uint32_t relay_latchtime(const relay_channel_t *channel){
+	uint32_t latchtime = (uint32_t)relay_thresholds(channel)->latchtime;
+#if RELAY_ADAPT_ENABLED
+	uint16_t adapted = channel->latch_adapted;
+	if(channel->adapt_rate != 0 && adapted < latchtime)
+		latchtime = adapted;
+#endif
+	return latchtime;
+}
+
+//****************************************************************************
+// relay_adapt - chooses the latch time of a channel from the noise in its rolling statistics (main context, every RELAY_ADAPT_PERIOD)
+//****************************************************************************
+void relay_adapt(relay_channel_t *channel, const stats_result_t *stats){
+#if RELAY_ADAPT_ENABLED
+	// A crossing in the window is no noise, the last estimate stays
+	if(channel->adapt_rate == 0 || stats->count == 0 || stats->upper_crossings != 0 || stats->lower_crossings != 0)
+		return;
+	// Distance from the mean to the threshold of the next switch (STATS_FRAC_BITS fractional bits)
+	const relay_thresholds_t *thresholds = relay_thresholds(channel);
+	int32_t threshold = (channel->state == RELAY_LOW) ? thresholds->upper_threshold : thresholds->lower_threshold;
+	int32_t distance = (threshold << STATS_FRAC_BITS) - (int32_t)stats->mean;
+	if(channel->state == RELAY_HIGH)
+		distance = -distance;
+	if(distance <= 0)
+		return;
+
+	// Standard deviation with half the fractional bits, z in quarters rounded down (a smaller z is the safe side)
+	uint32_t deviation = stats_isqrt(stats->variance);
+	uint32_t index = RELAY_ADAPT_STEPS - 1U;
+	if(deviation != 0){
+		index = (uint32_t)distance / (deviation << (STATS_FRAC_BITS / 2U - 2U));
+		if(index > RELAY_ADAPT_STEPS - 1U)
+			index = RELAY_ADAPT_STEPS - 1U;
+	}
+
+	// Every further try of the latch time multiplies the chance of a false switch by the tail chance
+	uint32_t limit = (uint32_t)channel->adapt_rate * RELAY_ADAPT_CORRELATION * RELAY_ADAPT_PER_DAY / 100U;
+	uint32_t tail = relay_adapt_tail[index];
+	uint32_t chance = tail;
+	uint32_t latchtime = RELAY_ADAPT_CORRELATION;
+	while(chance > limit && latchtime < (uint32_t)thresholds->latchtime){
+		chance = divide_mulhi(chance, tail);
+		latchtime += RELAY_ADAPT_CORRELATION;
+	}
+	if(latchtime < channel->adapt_min)
+		latchtime = channel->adapt_min;
+	if(latchtime > (uint32_t)thresholds->latchtime)
+		latchtime = (uint32_t)thresholds->latchtime;
+	channel->latch_adapted = (uint16_t)latchtime;
+#else
+	(void)channel;
+	(void)stats;
+#endif
+}
+
+//****************************************************************************
+// relay_record_latch - records how late the output was written after the expiry of a latch time (call right after the output write: trace, profiler and field histogram)
+//****************************************************************************
+void relay_record_latch(const relay_channel_t *channel, uint32_t deadline){
+#if TRACE_ENABLED || PROFILER_ENABLED || FIELDHIST_ENABLED
+	// The time of the write, not of the sample the decision was taken on (a scheduled zero cross switch is counted at its scheduling)
+	uint32_t timestamp = SYSTIMER_GetTime();
+#endif
+#if TRACE_ENABLED || PROFILER_ENABLED
+	uint32_t late = timestamp - deadline;
+	if(late > UINT16_MAX)
+		late = UINT16_MAX;
+	TRACE(TRACE_LATCH, channel - relay_channels, late);
+#endif
+#if PROFILER_ENABLED
+	profiler_record(PROFILER_RELAY_LATENCY, late * RELAY_CYCLES_PER_US);
+#endif
+#if FIELDHIST_ENABLED
+	FIELDHIST_ADD(RELAY_LATENCY, timestamp - deadline);
+#endif
+	(void)channel;
+	(void)deadline;
+}
+
+//****************************************************************************
+// relay_switch_allowed - rate limiter: returns true if the output may switch at timestamp (dwell time and rate window)
+//****************************************************************************
+RAMCODE
+bool relay_switch_allowed(relay_channel_t *channel, uint32_t timestamp){
+#if RELAY_LIMIT_ENABLED
+	uint32_t dwell = (channel->state == RELAY_HIGH) ? channel->min_high_time : channel->min_low_time;
+	bool allowed = (timestamp - channel->switch_time) >= dwell * TIMING_US_PER_MS;
+	if(channel->switch_rate_max != 0){
+		if(timestamp - channel->window_start >= RELAY_RATE_WINDOW_US){
+			channel->window_start = timestamp;
+			channel->window_switches = 0;
+		}
+		if(channel->window_switches >= channel->switch_rate_max)
+			allowed = false;
+	}
+	if(!allowed && !channel->limited){
+		channel->limited = true;
+		channel->limited_count++;
+		TRACE(TRACE_RELAY_LIMIT, channel - relay_channels, channel->state);
+	}
+	return allowed;
+#else
+	(void)channel;
+	(void)timestamp;
+	return true;
+#endif
+}
+
+//****************************************************************************
+// relay_switched - records a switch at timestamp for the limiter and the contact cycle counter
+//****************************************************************************
+RAMCODE
+void relay_switched(relay_channel_t *channel, uint32_t timestamp){
+	channel->latch_shift = 0;
+	channel->area = 0; // The area towards the next switch starts empty
+	channel->switch_time = timestamp;
+	channel->window_switches++;
+	if(channel->state == RELAY_HIGH)
+		channel->cycles++;
+}
+
+//****************************************************************************
+// relay_force_safe - drives the safe state of a faulted channel at timestamp (ends running latch times, bypasses the limiter)
+//****************************************************************************
+void relay_force_safe(relay_channel_t *channel, uint32_t timestamp){
+	channel->upper_exceed_timestamp = 0;
+	channel->lower_exceed_timestamp = 0;
+	channel->area = 0;
+	channel->limited = false;
+	bool changed = channel->state != channel->safe_state;
+	channel->state = channel->safe_state;
+	// Also driven without a change of the state: a switch of the main loop may have been interrupted before its output
+#if ZEROCROSS_ENABLED
+	// Protective, at once and not at a zero cross (a scheduled change would undo it)
+	if(channel->output == &IO_RELAY)
+		zerocross_cancel();
+#endif
+	relay_output(channel, channel->safe_state == RELAY_HIGH);
+	if(changed)
+		relay_switched(channel, timestamp);
+}
+
+//****************************************************************************
+// relay_update - relay state machine with hysteresis and latch time. Evaluates a value sampled at timestamp (in us),
+//                compare = false if the thresholds are already checked by relay_check_thresholds. Returns true if the output switched
+//****************************************************************************
+RAMCODE
+bool relay_update(relay_channel_t *channel, uint32_t value, uint32_t timestamp, bool compare){
+	// The output of a faulted sensor stays in its safe state (relay_check_fault)
+	if(channel->fault != RELAY_FAULT_NONE)
+		return false;
+	if(compare)
+		relay_check_thresholds(channel, value, timestamp);
+
+#if RELAY_AREA_ENABLED
+	// Area latch: switches once the integrated excess reached latch_area (relay_integrate)
+	if(channel->latch_area != 0){
+		if(channel->area < channel->latch_area * TIMING_US_PER_MS || !relay_switch_allowed(channel, timestamp))
+			return false;
+		channel->state = (channel->state == RELAY_LOW) ? RELAY_HIGH : RELAY_LOW;
+		relay_drive(channel, channel->state == RELAY_HIGH);
+		relay_record_latch(channel, channel->area_due);
+		relay_switched(channel, timestamp);
+		channel->upper_exceed_timestamp = 0;
+		channel->lower_exceed_timestamp = 0;
+		// A fault detected by the ADC interrupt meanwhile wins
+		if(channel->fault != RELAY_FAULT_NONE)
+			relay_force_safe(channel, timestamp);
+		return true;
+	}
+#endif
+
+	// Transition statement
+	// Check if threshold are exceeded long enough to trigger a switch
+	switch (channel->state){
+		case RELAY_LOW:
+			if(channel->upper_exceed_timestamp != 0){
+				// Latch time exceeded (by 1ms or more, like an elapsed time in whole ms > latchtime, shortened by a fast crossing)
+				uint32_t deadline = timing_deadline(channel->upper_exceed_timestamp, (relay_latchtime(channel) >> channel->latch_shift) + 1U);
+				if(timing_reached(timestamp, deadline) && relay_switch_allowed(channel, timestamp)){
+					channel->state = RELAY_HIGH;
+					relay_drive(channel, true);
+					relay_record_latch(channel, deadline);
+					relay_switched(channel, timestamp);
+					channel->upper_exceed_timestamp = 0;
+					// A fault detected by the ADC interrupt meanwhile wins
+					if(channel->fault != RELAY_FAULT_NONE)
+						relay_force_safe(channel, timestamp);
+					return true;
+				}
+			}
+			break;
+		case RELAY_HIGH:
+			if(channel->lower_exceed_timestamp != 0){
+				// Latch time exceeded (by 1ms or more, like an elapsed time in whole ms > latchtime, shortened by a fast crossing)
+				uint32_t deadline = timing_deadline(channel->lower_exceed_timestamp, (relay_latchtime(channel) >> channel->latch_shift) + 1U);
+				if(timing_reached(timestamp, deadline) && relay_switch_allowed(channel, timestamp)){
+					channel->state = RELAY_LOW;
+					relay_drive(channel, false);
+					relay_record_latch(channel, deadline);
+					relay_switched(channel, timestamp);
+					channel->lower_exceed_timestamp = 0;
+					// A fault detected by the ADC interrupt meanwhile wins
+					if(channel->fault != RELAY_FAULT_NONE)
+						relay_force_safe(channel, timestamp);
+					return true;
+				}
+			}
+			break;
+	}
+	return false;
+}
+
+//****************************************************************************
+// relay_any_latch_running - returns true if the latch time of any channel is running
+//****************************************************************************
+bool relay_any_latch_running(void){
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		if(relay_latch_running(&relay_channels[i]))
+			return true;
+	}
+	return false;
+}
+
+//****************************************************************************
+// relay_check_fault - checks a raw result of a channel sampled at timestamp for an open or shorted sensor line (ADC
+//                     interrupt). Drives the safe state when a fault is detected. Returns true if a fault began or ended
+//****************************************************************************
+bool relay_check_fault(relay_channel_t *channel, uint32_t raw, uint32_t timestamp){
+#if RELAY_FAULT_ENABLED
+	if(!channel->fault_detect)
+		return false;
+	relay_faults fault = RELAY_FAULT_NONE;
+	// Slew: a step no front end filter lets through (line opened or shorted between two conversions)
+	if(RELAY_FAULT_STEP_MAX != 0 && channel->fault_raw != RELAY_FAULT_RAW_NONE){
+		uint32_t step = (raw > channel->fault_raw) ? raw - channel->fault_raw : channel->fault_raw - raw;
+		if(step > RELAY_FAULT_STEP_MAX)
+			fault = RELAY_FAULT_SLEW;
+	}
+	channel->fault_raw = (uint16_t)raw;
+
+	// Rail: pinned for longer than RELAY_FAULT_RAIL_TIME (a signal passing a rail is not a fault)
+	bool pinned = raw <= RELAY_FAULT_LOW_LIMIT || raw >= RELAY_FAULT_HIGH_LIMIT;
+	if(!pinned)
+		channel->rail_time = 0;
+	else if(channel->rail_time == 0)
+		channel->rail_time = timestamp;
+	else if(timestamp - channel->rail_time >= RELAY_FAULT_RAIL_US)
+		fault = (raw <= RELAY_FAULT_LOW_LIMIT) ? RELAY_FAULT_RAIL_LOW : RELAY_FAULT_RAIL_HIGH;
+
+	if(channel->fault == RELAY_FAULT_NONE){
+		if(fault == RELAY_FAULT_NONE)
+			return false;
+		channel->fault = fault;
+		channel->fault_time = timestamp;
+		channel->fault_count++;
+		relay_force_safe(channel, timestamp);
+		TRACE(TRACE_SENSOR_FAULT, channel - relay_channels, fault);
+		return true;
+	}
+	// Active fault: ends after RELAY_FAULT_CLEAR_TIME without a pinned or implausible result
+	if(fault != RELAY_FAULT_NONE || pinned){
+		channel->fault_time = timestamp;
+		return false;
+	}
+	if(timestamp - channel->fault_time < RELAY_FAULT_CLEAR_US)
+		return false;
+	channel->fault = RELAY_FAULT_NONE;
+	TRACE(TRACE_SENSOR_FAULT, channel - relay_channels, RELAY_FAULT_NONE);
+	return true;
+#else
+	(void)channel;
+	(void)raw;
+	(void)timestamp;
+	return false;
+#endif
+}
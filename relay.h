@@ -0,0 +1,160 @@
+/*
+ * USB-Changer relay.h
+ *
+ * Hysteresis comparator with latch time per sensor channel. Each channel (index = sensor channel, see sensor.h) has its
+ * own thresholds, latch time, output and state in one context record, so all channels share one state machine.
+ * Predictive latch (RELAY_PREDICT_ENABLED, predict_rate of the channel > 0): the threshold check also smooths the slope
+ * of the value per ms. While the latch time runs, every doubling of the slope towards the threshold beyond predict_rate
+ * halves the latch time of that crossing (up to RELAY_PREDICT_SHIFT_MAX times, never undone until the crossing ends), so
+ * a step or a fast ramp through the band switches early and a slow wander near a threshold keeps the full latch time.
+ * Rate limiter (RELAY_LIMIT_ENABLED): a due switch is held back until the output stayed in its state for min_high_time
+ * or min_low_time and while switch_rate_max switches happened in the current RELAY_RATE_WINDOW. The crossing stays
+ * pending, so the switch follows as soon as it is allowed if the value is still beyond the threshold. Every switch
+ * to RELAY_HIGH is counted as a contact cycle (cycles, stored by relaylife.h).
+ * Sensor fault detection (RELAY_FAULT_ENABLED, fault_detect of the channel): the ADC interrupt checks every raw result
+ * (relay_check_fault, before filter and calibration) for a line that opened or shorted: a result pinned to a rail for
+ * longer than RELAY_FAULT_RAIL_TIME or a step between two results larger than a front end lets through. A fault forces
+ * the output into safe_state at once, without latch time and rate limiter, and the thresholds are ignored until the
+ * results stayed plausible for RELAY_FAULT_CLEAR_TIME. The output then keeps safe_state until a regular crossing.
+ * Area latch (RELAY_AREA_ENABLED, latch_area of the channel > 0): instead of a latch time that restarts on every dip
+ * back over the threshold, the threshold check integrates how far the value is beyond the threshold of the next switch,
+ * minus area_leak, over time. The area grows with the excess and shrinks with a dip (or an excess below area_leak), it
+ * never goes below 0, and the output switches once it reaches latch_area. A large crossing switches after a fraction of
+ * the time a small one needs, a single noise sample only takes back its own share instead of the whole latch time.
+ * The latch time and the predictive latch are not used by a channel in area mode.
+ * Adaptive latch time (RELAY_ADAPT_ENABLED, adapt_rate of the channel > 0): relay_adapt estimates the noise of the
+ * value from the rolling statistics of the channel (sensor_get_stats, a window without crossings) and shortens the
+ * latch time to the shortest one that keeps the predicted false switches below adapt_rate per day, never below
+ * adapt_min and never above latchtime, which stays the upper bound. The noise is assumed Gaussian around the mean and
+ * independent after RELAY_ADAPT_CORRELATION: a false switch needs the noise beyond the distance from the mean to the
+ * threshold of the next switch for all samples of the latch time, one new try every RELAY_ADAPT_CORRELATION. A
+ * window with a crossing or a mean beyond that threshold keeps the last latch time, so a real transition never
+ * counts as noise. relay_latchtime returns the latch time in use.
+ * Threshold snapshot: upper_threshold, lower_threshold and latchtime of a channel are the working copy of the setup
+ * (menu, host settings, profiles, failover, warm reset), changed one field at a time. The decision never reads them, it
+ * reads the published set (relay_thresholds): relay_publish copies a changed working copy into the spare of two
+ * buffers and then switches published_index, one byte store. Only the main context publishes and no interrupt handler
+ * is ever preempted by it, so a handler sees one complete set for its whole run without masking, and a change takes
+ * effect at the first result after the pass that made it. The main loop publishes at the end of every pass.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef RELAY_H
+#define RELAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "DIGITAL_IO/digital_io.h"
+#include "sensor.h"
+
+#define RELAY_PREDICT_ENABLED		 0							// Determines if the threshold check estimates the slope for the predictive latch (0 removes it)
+#define RELAY_PREDICT_RATE			 0							// ADC values per ms. Default predict_rate (0 = always the full latch time)
+#define RELAY_PREDICT_SHIFT_MAX		 3							// Largest latch time reduction (latchtime >> 3 = 1/8)
+#define RELAY_SLOPE_SCALE			 16							// Fixed point factor of the slope (1/16 ADC value per ms)
+#define RELAY_SLOPE_SHIFT			 2							// Smoothing of the slope per ms: slope += (step - slope) >> shift
+#define RELAY_LIMIT_ENABLED			 0							// Determines if the dwell times and the switching rate are enforced (0 removes the limiter, relays switch as before)
+#define RELAY_MIN_HIGH_TIME			 100						// In ms. Default min_high_time (0 = off)
+#define RELAY_MIN_LOW_TIME			 100						// In ms. Default min_low_time (0 = off)
+#define RELAY_RATE_MAX				 30							// Default switch_rate_max (0 = unlimited)
+#define RELAY_RATE_WINDOW			 60000						// In ms. Window of switch_rate_max (fixed windows)
+#define RELAY_FAULT_ENABLED			 1							// Determines if the raw results are checked for an open or shorted sensor line (0 removes the fault detection)
+#define RELAY_FAULT_LOW_LIMIT		 16							// ADC value. Results at or below are pinned to ground (shorted line)
+#define RELAY_FAULT_HIGH_LIMIT	 4079						// ADC value. Results at or above are pinned to the reference (open line, at most the 8 bit full scale of 4080)
+#define RELAY_FAULT_RAIL_TIME		 150						// In ms. Time a result must stay pinned to a rail to be a fault (a signal turning near a rail stays shorter)
+#define RELAY_FAULT_STEP_MAX		 3500						// ADC value. Largest plausible change between two results of a channel (0 = no slew check, lower it to what the front end filter lets through)
+#define RELAY_FAULT_CLEAR_TIME		 1000						// In ms. Time the results must stay plausible before a fault ends
+#define RELAY_FAULT_SAFE_STATE		 RELAY_LOW					// Default safe_state
+#define RELAY_AREA_ENABLED			 0							// Determines if the threshold check integrates the excess for the area latch (0 removes it)
+#define RELAY_LATCH_AREA			 0							// ADC values * ms. Default latch_area (0 = latch time)
+#define RELAY_AREA_LEAK				 16							// ADC values. Default area_leak: excess that adds nothing, a value closer to the threshold drains the area
+#define RELAY_AREA_STEP_MAX			 10							// In ms. Longest time a result counts for (the first result after a pause, e.g. a profile switch)
+#define RELAY_LATCH_AREA_MAX		 (UINT32_MAX / 1000U)		// ADC values * ms. Largest latch_area (the area is summed in ADC values * us)
+#define RELAY_ADAPT_ENABLED			 0							// Determines if the latch time can follow the noise of the channel (0 removes the adaptive latch time)
+#define RELAY_ADAPT_RATE			 0							// False switches per day. Default adapt_rate (0 = fixed latch time)
+#define RELAY_ADAPT_MIN				 20							// In ms. Default adapt_min, shortest adapted latch time
+#define RELAY_ADAPT_CORRELATION		 4							// In ms. Time after which the filtered noise is independent (one new try of a false switch)
+#define RELAY_ADAPT_PERIOD			 1000						// In ms. Period of the adaptation task (4096 samples per statistics window)
+#define RELAY_ADAPT_NONE			 0xFFFFU					// latch_adapted before the first estimate (full latch time)
+
+typedef enum {RELAY_HIGH, RELAY_LOW} relay_states;
+
+typedef enum {
+	RELAY_FAULT_NONE,
+	RELAY_FAULT_RAIL_LOW,		// Result pinned to ground (shorted line)
+	RELAY_FAULT_RAIL_HIGH,		// Result pinned to the reference (open line, also after a broken wire precharge)
+	RELAY_FAULT_SLEW			// Implausible step between two results
+} relay_faults;
+
+typedef struct {
+	int32_t upper_threshold;
+	int32_t lower_threshold;
+	int32_t latchtime;							// In ms
+} relay_thresholds_t;
+
+typedef struct {
+	const DIGITAL_IO_t *output;					// Output switched by the channel (high = RELAY_HIGH, NULL = none, e.g. a USB sense channel)
+	uint8_t expander_output;					// Output of the shift register chain switched instead (EXPANDER_OUTPUT(n), 0 = none, see expander.h)
+	int32_t upper_threshold;					// Upper threshold that the ADC value must be exceed to trigger a state change (must be held exceeded for latchtime)
+	int32_t lower_threshold;					// Lower threshold that the ADC value must be fall below to trigger a state change (must be held for latchtime)
+	int32_t latchtime;							// In ms. Time that the threshold must stay exceeded in order to trigger a state change (=basically a filter)
+	relay_thresholds_t published[2];			// Thresholds and latch time the decision uses (double buffer, written by relay_publish)
+	volatile uint8_t published_index;			// Buffer of published the readers take
+	relay_states state;
+	volatile uint32_t value;					// Latest (filtered) ADC value of the channel
+	volatile uint32_t upper_exceed_timestamp;	// If this is 0 the threshold is not exceeded. If threshold is exceeded this marks the point when it got started to be exceeded
+	volatile uint32_t lower_exceed_timestamp;
+	int32_t predict_rate;						// ADC values per ms. Slope from which the latch time is shortened (0 = off, see RELAY_PREDICT_ENABLED)
+	int32_t slope;								// ADC values per ms * RELAY_SLOPE_SCALE, smoothed (relay_check_thresholds)
+	uint32_t slope_time;						// In us. Timestamp of the value the next slope step starts from
+	uint32_t slope_value;
+	volatile uint8_t latch_shift;				// Reduction of the running latch time (latchtime >> latch_shift)
+	uint16_t min_high_time;						// In ms. Shortest time the output stays RELAY_HIGH (rate limiter, 0 = off)
+	uint16_t min_low_time;						// In ms. Shortest time the output stays RELAY_LOW
+	uint8_t switch_rate_max;					// Most switches per RELAY_RATE_WINDOW (0 = unlimited)
+	uint8_t window_switches;					// Switches in the current window
+	volatile bool limited;						// The switch of the current crossing was held back by the limiter
+	uint16_t limited_count;						// Number of crossings whose switch was held back
+	uint32_t window_start;						// In us. Start of the current rate window
+	uint32_t switch_time;						// In us. Timestamp of the last switch
+	uint32_t cycles;							// Switches to RELAY_HIGH since reset (contact cycles)
+	bool fault_detect;							// The raw results are checked for a sensor fault (RELAY_FAULT_ENABLED, off for inputs that may rest at a rail)
+	relay_states safe_state;					// State the output is forced to while the sensor is faulted
+	volatile uint8_t fault;						// relay_faults of the active fault (RELAY_FAULT_NONE = sensor healthy)
+	uint16_t fault_raw;							// Previous raw result (RELAY_FAULT_RAW_NONE = none since the reset)
+	uint32_t rail_time;							// In us. Start of the current run of pinned results (0 = not pinned)
+	uint32_t fault_time;						// In us. Last implausible result of the active fault
+	uint16_t fault_count;						// Number of detected faults since reset
+	uint32_t latch_area;						// ADC values * ms. Area beyond the threshold that switches the output (0 = latch time, see RELAY_AREA_ENABLED)
+	uint16_t area_leak;							// ADC values. Subtracted from the excess of every result
+	volatile uint32_t area;						// ADC values * us. Integrated excess towards the next switch (up to latch_area * 1000)
+	uint32_t area_time;							// In us. Timestamp of the last integrated result
+	uint32_t area_due;							// In us. Time the area reached latch_area
+	uint16_t adapt_rate;						// False switches per day the adapted latch time allows (0 = latchtime, see RELAY_ADAPT_ENABLED)
+	uint16_t adapt_min;							// In ms. Shortest adapted latch time
+	volatile uint16_t latch_adapted;			// In ms. Latch time chosen by relay_adapt (RELAY_ADAPT_NONE = no estimate yet)
+} relay_channel_t;
+
+extern relay_channel_t relay_channels[SENSOR_CHANNEL_COUNT];
+
+//****************************************************************************
+// relay_thresholds - returns the published thresholds and latch time of a channel (any context, one complete set)
+//****************************************************************************
+static inline const relay_thresholds_t *relay_thresholds(const relay_channel_t *channel){
+	return &channel->published[channel->published_index];
+}
+
+void relay_output(const relay_channel_t *channel, bool on);
+void relay_init(const uint8_t *states);
+bool relay_publish(void);
+bool relay_mark_exceeded(relay_channel_t *channel, bool upper, uint32_t timestamp);
+bool relay_check_thresholds(relay_channel_t *channel, uint32_t value, uint32_t timestamp);
+bool relay_latch_running(const relay_channel_t *channel);
+bool relay_latch_deadline(const relay_channel_t *channel, uint32_t *deadline);
+uint32_t relay_latchtime(const relay_channel_t *channel);
+void relay_adapt(relay_channel_t *channel, const stats_result_t *stats);
+bool relay_any_latch_running(void);
+bool relay_update(relay_channel_t *channel, uint32_t value, uint32_t timestamp, bool compare);
+bool relay_check_fault(relay_channel_t *channel, uint32_t raw, uint32_t timestamp);
+
+#endif /* RELAY_H */
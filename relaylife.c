@@ -0,0 +1,89 @@
+/*
+ * USB-Changer relaylife.c
+ *
+ * Persistent contact cycle counter (see relaylife.h). relay_update only increments a RAM counter of the channel, all
+ * flash access is done here in main context.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "relaylife.h"
+#include "relay.h"
+#include "storage.h"
+#include "timing.h"
+#include "log.h"
+
+typedef char relaylife_record_size_check[(sizeof(relaylife_record_t) == RELAYLIFE_STORAGE_SIZE && RELAYLIFE_CHANNEL < SENSOR_CHANNEL_COUNT) ? 1 : -1];
+
+#define RELAYLIFE_WARN_CYCLES		 ((RELAYLIFE_RATED_CYCLES / 100U) * RELAYLIFE_WARN_PERCENT)
+#define RELAYLIFE_SAVE_DELAY_US		 TIMING_MS_TO_US(RELAYLIFE_SAVE_DELAY)
+typedef char relaylife_delay_check[(RELAYLIFE_SAVE_DELAY <= TIMING_MS_MAX) ? 1 : -1];
+
+uint32_t relaylife_base = 0;		// Stored cycles at boot (or set) minus the cycles the channel counted until then
+uint32_t relaylife_posted = 0;		// Total of the last posted record
+bool relaylife_save_now = false;	// The counter was set, write it with the next task run
+bool relaylife_warned = false;		// End of life warning logged
+
+
+//****************************************************************************
+// relaylife_init - continues the stored total (starts at 0 if the block was never written or is invalid)
+//****************************************************************************
+void relaylife_init(void){
+	relaylife_record_t record;
+	uint32_t cycles = 0;
+	if(E_EEPROM_XMC1_Read(EEPROM_RELAY_LIFE, 0U, (uint8_t *)&record, RELAYLIFE_STORAGE_SIZE) == E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS
+			&& record.cycles_check == ~record.cycles)
+		cycles = record.cycles;
+	relaylife_base = cycles - relay_channels[RELAYLIFE_CHANNEL].cycles;
+	relaylife_posted = cycles;
+	relaylife_warned = cycles >= RELAYLIFE_WARN_CYCLES;
+}
+
+//****************************************************************************
+// relaylife_task - posts the total after RELAYLIFE_SAVE_STEP new cycles or RELAYLIFE_SAVE_DELAY without a switch (scheduler task)
+//****************************************************************************
+void relaylife_task(void){
+	const relay_channel_t *channel = &relay_channels[RELAYLIFE_CHANNEL];
+	uint32_t cycles = relaylife_get_cycles();
+	uint32_t unsaved = cycles - relaylife_posted;
+
+	if(!relaylife_warned && cycles >= RELAYLIFE_WARN_CYCLES){
+		relaylife_warned = true;
+		LOG_WARN("Relay at %u of %u rated cycles", cycles, RELAYLIFE_RATED_CYCLES);
+	}
+
+	if(!relaylife_save_now && (unsaved == 0 || (unsaved < RELAYLIFE_SAVE_STEP
+			&& SYSTIMER_GetTime() - channel->switch_time < RELAYLIFE_SAVE_DELAY_US)))
+		return;
+	relaylife_record_t record = {.cycles = cycles, .cycles_check = ~cycles};
+	// A full queue is retried with the next run
+	if(storage_post(EEPROM_RELAY_LIFE, (const uint8_t *)&record, RELAYLIFE_STORAGE_SIZE)){
+		relaylife_posted = cycles;
+		relaylife_save_now = false;
+	}
+}
+
+//****************************************************************************
+// relaylife_get_cycles - returns the contact cycles of the relay including the stored ones
+//****************************************************************************
+uint32_t relaylife_get_cycles(void){
+	return relaylife_base + relay_channels[RELAYLIFE_CHANNEL].cycles;
+}
+
+//****************************************************************************
+// relaylife_set_cycles - sets the total (e.g. 0 after the relay was replaced), stored by the next task run
+//****************************************************************************
+void relaylife_set_cycles(uint32_t cycles){
+	relaylife_base = cycles - relay_channels[RELAYLIFE_CHANNEL].cycles;
+	relaylife_warned = cycles >= RELAYLIFE_WARN_CYCLES;
+	relaylife_save_now = true;
+}
+
+//****************************************************************************
+// relaylife_remaining - returns the contact cycles left until the rated endurance (0 = exceeded)
+//****************************************************************************
+uint32_t relaylife_remaining(void){
+	uint32_t cycles = relaylife_get_cycles();
+	return (cycles < RELAYLIFE_RATED_CYCLES) ? RELAYLIFE_RATED_CYCLES - cycles : 0U;
+}
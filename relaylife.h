@@ -0,0 +1,40 @@
+/*
+ * USB-Changer relaylife.h
+ *
+ * Persistent contact cycle counter of the relay output. relay_update counts every switch of a channel to RELAY_HIGH
+ * (cycles of the channel context), relaylife adds the count stored in the EEPROM block EEPROM_RELAY_LIFE at boot and
+ * posts the total through the deferred write queue (storage.h) only after RELAYLIFE_SAVE_STEP new cycles or once the
+ * relay was quiet for RELAYLIFE_SAVE_DELAY, so a toggle never costs a flash write of its own. A power loss loses at
+ * most RELAYLIFE_SAVE_STEP cycles. The total is compared with the rated electrical endurance of the relay to predict
+ * the end of its contact life (relaylife_remaining, a warning is logged at RELAYLIFE_WARN_PERCENT).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef RELAYLIFE_H
+#define RELAYLIFE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RELAYLIFE_ENABLED			 0							// Determines if the contact cycles are counted over resets (0 = nothing is stored, relaylife_get_cycles counts since reset)
+#define RELAYLIFE_CHANNEL			 0							// Sensor channel whose relay output is counted (IO_RELAY)
+#define RELAYLIFE_RATED_CYCLES		 100000U					// Electrical endurance of the relay at rated load (see data sheet of the relay)
+#define RELAYLIFE_WARN_PERCENT		 90							// Share of the rated cycles at which the end of life warning is logged
+#define RELAYLIFE_SAVE_STEP			 100						// Number of unsaved cycles that trigger a write
+#define RELAYLIFE_SAVE_DELAY		 60000						// In ms. Time without a switch after which fewer unsaved cycles are written
+#define RELAYLIFE_TASK_PERIOD		 1000						// In ms. Period of the save check (relaylife_task, scheduler task)
+#define RELAYLIFE_STORAGE_SIZE		 8							// In bytes. Size of relaylife_record_t = size of EEPROM_RELAY_LIFE
+
+typedef struct {
+	uint32_t cycles;				// Contact cycles since the relay was fitted (or the counter was set)
+	uint32_t cycles_check;			// ~cycles (an erased or torn block never has a valid check)
+} relaylife_record_t;
+
+void relaylife_init(void);
+void relaylife_task(void);
+uint32_t relaylife_get_cycles(void);
+void relaylife_set_cycles(uint32_t cycles);
+uint32_t relaylife_remaining(void);
+
+#endif /* RELAYLIFE_H */
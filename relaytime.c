@@ -0,0 +1,180 @@
+/*
+ * USB-Changer relaytime.c
+ *
+ * Relay operate and release time measurement (see relaytime.h). The drive edge (relay_drive, main or ADC interrupt
+ * context) and the feedback interrupt share relaytime_pending and relaytime_drive_time: a drive edge always restarts
+ * the measurement, the interrupt only ends one whose driven state matches the contact state it reads.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "relaytime.h"
+#include "timing.h"
+#include "ramcode.h"
+#include "trace.h"
+#include "acmp.h"
+#include "metrics.h"
+#include "critical.h"
+
+#if RELAYTIME_ENABLED
+	#if ACMP_ENABLED
+		#error "RELAYTIME_ENABLED and ACMP_ENABLED both need ERU0 ETL1"
+	#endif
+	#include "xmc_eru.h"
+	#if !defined(ERU0_ETL1_INPUTB_P2_1)
+		#error "RELAYTIME_ENABLED needs P2.1 on ERU0 ETL1 (VQFN24 and TSSOP38 packages, every ERU input of the TSSOP16 is in use)"
+	#endif
+
+	#define RELAYTIME_ERU_ETL		 1U							// ETL of the feedback input (ETL0 and ETL1 belong to the comparators on ACMP parts)
+	#define RELAYTIME_ERU_OGU		 2U							// OGU raising ERU0_2_IRQn (OGU0 buttons, OGU1 comparators)
+#endif
+#define RELAYTIME_TIMEOUT_US		 TIMING_MS_TO_US(RELAYTIME_TIMEOUT)
+#define RELAYTIME_NONE				 0U							// relaytime_pending: no measurement running
+#define RELAYTIME_ON				 1U							// relaytime_pending: waiting for the contacts to close
+#define RELAYTIME_OFF				 2U							// relaytime_pending: waiting for the contacts to open
+
+relaytime_stats_t relaytime_operate;
+relaytime_stats_t relaytime_release;
+uint32_t relaytime_default[2] = {0, 0};			// In us. Release and operate time without a measurement (relaytime_set_default)
+#if RELAYTIME_ENABLED
+METRICS_REGISTER(relay_operate_time, METRICS_ID_RELAY_OPERATE_TIME, METRICS_TYPE_U32, METRICS_UNIT_US, relaytime_operate.last);
+METRICS_REGISTER(relay_release_time, METRICS_ID_RELAY_RELEASE_TIME, METRICS_TYPE_U32, METRICS_UNIT_US, relaytime_release.last);
+#endif
+volatile uint8_t relaytime_pending = RELAYTIME_NONE;
+volatile uint32_t relaytime_drive_time = 0;		// In us (SYSTIMER_GetTimeUs). Drive edge of the pending measurement
+bool relaytime_on = false;						// Last driven state (relay_init drives off)
+
+
+//****************************************************************************
+// relaytime_add - adds a measured time (in us) to the statistics of a direction
+//****************************************************************************
+RAMCODE
+void relaytime_add(relaytime_stats_t *stats, uint32_t time){
+	stats->last = time;
+	if(stats->count == 0 || time < stats->min)
+		stats->min = time;
+	if(time > stats->max)
+		stats->max = time;
+	if(stats->average == 0)
+		stats->average = time << RELAYTIME_AVERAGE_SHIFT;
+	else
+		stats->average += time - (stats->average >> RELAYTIME_AVERAGE_SHIFT);
+	if(stats->count < UINT16_MAX)
+		stats->count++;
+}
+
+//****************************************************************************
+// relaytime_miss - counts the pending measurement as missed (no feedback within RELAYTIME_TIMEOUT)
+//****************************************************************************
+RAMCODE
+void relaytime_miss(void){
+	bool on = relaytime_pending == RELAYTIME_ON;
+	relaytime_stats_t *stats = on ? &relaytime_operate : &relaytime_release;
+	if(stats->missed < UINT16_MAX)
+		stats->missed++;
+	relaytime_pending = RELAYTIME_NONE;
+	TRACE(TRACE_RELAY_TIME, on, 0xFFFFU);
+}
+
+#if RELAYTIME_ENABLED
+//****************************************************************************
+// ERU0_2_IRQHandler - ERU interrupt (IRQ_Hdlr_5): the feedback input changed
+//****************************************************************************
+RAMCODE
+void ERU0_2_IRQHandler(void){
+	uint32_t now = SYSTIMER_GetTimeUs();
+	bool closed = XMC_GPIO_GetInput(RELAYTIME_PORT, RELAYTIME_PIN) == RELAYTIME_CLOSED_LEVEL;
+	uint8_t pending = relaytime_pending;
+	// Bounce edges and edges against the driven state end no measurement
+	if(pending == RELAYTIME_NONE || closed != (pending == RELAYTIME_ON))
+		return;
+	uint32_t time = now - relaytime_drive_time;
+	if(time > RELAYTIME_TIMEOUT_US){
+		relaytime_miss();
+		return;
+	}
+	relaytime_add(closed ? &relaytime_operate : &relaytime_release, time);
+	relaytime_pending = RELAYTIME_NONE;
+	TRACE(TRACE_RELAY_TIME, closed, time);
+}
+#endif
+
+//****************************************************************************
+// relaytime_init - starts the feedback edge detection (pull-up input, both edges)
+//****************************************************************************
+void relaytime_init(void){
+	relaytime_reset(true);
+	relaytime_reset(false);
+#if RELAYTIME_ENABLED
+	XMC_GPIO_SetMode(RELAYTIME_PORT, RELAYTIME_PIN, XMC_GPIO_MODE_INPUT_PULL_UP);
+
+	// P2.1 -> ETL1 (input B) -> OGU2 -> ERU0_2_IRQn
+	XMC_ERU_ETL_CONFIG_t etl_config = {
+		.input_b = ERU0_ETL1_INPUTB_P2_1,
+		.enable_output_trigger = 1U,
+		.status_flag_mode = XMC_ERU_ETL_STATUS_FLAG_MODE_HWCTRL,
+		.edge_detection = XMC_ERU_ETL_EDGE_DETECTION_BOTH,
+		.output_trigger_channel = XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL2,
+		.source = XMC_ERU_ETL_SOURCE_B
+	};
+	XMC_ERU_OGU_CONFIG_t ogu_config = {
+		.service_request = XMC_ERU_OGU_SERVICE_REQUEST_ON_TRIGGER
+	};
+	XMC_ERU_ETL_Init(XMC_ERU0, RELAYTIME_ERU_ETL, &etl_config);
+	XMC_ERU_OGU_Init(XMC_ERU0, RELAYTIME_ERU_OGU, &ogu_config);
+	NVIC_SetPriority(ERU0_2_IRQn, RELAYTIME_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(ERU0_2_IRQn);
+	NVIC_EnableIRQ(ERU0_2_IRQn);
+#endif
+}
+
+//****************************************************************************
+// relaytime_driven - timestamps a drive edge of IO_RELAY (relay_drive, main or ADC interrupt context)
+//****************************************************************************
+RAMCODE
+void relaytime_driven(bool on){
+#if RELAYTIME_ENABLED
+	// Driving the same level again (e.g. a safe state drive) is no edge
+	if(on == relaytime_on)
+		return;
+	uint32_t now = SYSTIMER_GetTimeUs();
+	critical_state_t primask = critical_enter();
+	relaytime_on = on;
+	// A pending edge older than RELAYTIME_TIMEOUT got no feedback, a younger one is replaced (switched back before the contacts followed)
+	if(relaytime_pending != RELAYTIME_NONE && now - relaytime_drive_time > RELAYTIME_TIMEOUT_US)
+		relaytime_miss();
+	relaytime_drive_time = now;
+	relaytime_pending = on ? RELAYTIME_ON : RELAYTIME_OFF;
+	critical_exit(primask, CRITICAL_SITE_RELAYTIME);
+#else
+	(void)on;
+#endif
+}
+
+//****************************************************************************
+// relaytime_lead - returns the average operate (on) or release time in us (0 = not measured), the lead of a timed drive
+//****************************************************************************
+uint32_t relaytime_lead(bool on){
+	uint32_t average = on ? relaytime_operate.average : relaytime_release.average;
+	if(average == 0)
+		return relaytime_default[on ? 1 : 0];
+	return average >> RELAYTIME_AVERAGE_SHIFT;
+}
+
+//****************************************************************************
+// relaytime_set_default - sets the operate (on) or release time in us returned by relaytime_lead until one is measured
+//****************************************************************************
+void relaytime_set_default(bool on, uint32_t time){
+	relaytime_default[on ? 1 : 0] = time;
+}
+
+//****************************************************************************
+// relaytime_reset - clears the operate (on) or release statistics (e.g. after replacing the relay)
+//****************************************************************************
+void relaytime_reset(bool on){
+	relaytime_stats_t *stats = on ? &relaytime_operate : &relaytime_release;
+	critical_state_t primask = critical_enter();
+	*stats = (relaytime_stats_t){0};
+	critical_exit(primask, CRITICAL_SITE_RELAYTIME);
+}
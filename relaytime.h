@@ -0,0 +1,55 @@
+/*
+ * USB-Changer relaytime.h
+ *
+ * Operate and release time of the relay, measured with a contact feedback input (an auxiliary contact or the switched
+ * load through an optocoupler on RELAYTIME_PIN, closed = RELAYTIME_CLOSED_LEVEL). relay_drive timestamps the drive
+ * edge of IO_RELAY (relaytime_driven), the first feedback edge to the driven state timestamps the contact (ERU0 ETL1
+ * input B -> OGU2 -> ERU0_2_IRQn, both edges), the difference is the operate (on) or release (off) time of this unit.
+ * Contact bounce after the first edge is ignored. Each direction keeps the last, shortest and longest time and an
+ * average that follows the ageing of the relay (relaytime_stats_t). A drive edge without feedback within
+ * RELAYTIME_TIMEOUT counts as missed (welded contact, broken feedback wire), counted at the next edge of either kind.
+ * relaytime_lead returns the average (the default set by relaytime_set_default until the first measurement, e.g. the
+ * factory calibration of factory.h) for the compensation of a timed switch: a caller that needs the contacts to
+ * change at a given time (e.g. aligned to a zero cross of the load voltage) drives the relay that much earlier.
+ * All CCU4 slices are in use (LED, sensor trigger, hrtimer, profiler or coil), so both edges are timestamped with
+ * SYSTIMER_GetTimeUs instead of a capture: the interrupt latency (a few us in the time tier) is far below the
+ * millisecond times of a relay. P2.1 is not bonded on the TSSOP16 of this board, where every ERU input is in use:
+ * the measurement needs a VQFN24 or TSSOP38 board variant.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef RELAYTIME_H
+#define RELAYTIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define RELAYTIME_ENABLED			 0							// Determines if the contact feedback input is measured (needs a feedback contact on RELAYTIME_PIN)
+#define RELAYTIME_PORT				 XMC_GPIO_PORT2				// Contact feedback input P2.1 (ERU0 ETL1 input B0, not bonded on the TSSOP16)
+#define RELAYTIME_PIN				 1U
+#define RELAYTIME_CLOSED_LEVEL		 0U							// Input level of closed contacts (contact to ground, internal pull-up)
+#define RELAYTIME_TIMEOUT			 50							// In ms. Longest operate or release time, a later feedback edge counts as missed
+#define RELAYTIME_AVERAGE_SHIFT		 3							// Smoothing of the average per measurement: average += (time - average) >> shift
+#define RELAYTIME_IRQ_PRIORITY		 IRQPRIO_RELAYTIME			// Priority of the ERU0 SR2 interrupt (time tier, its latency is part of the measured time)
+
+typedef struct {
+	uint16_t count;			// Measured edges since reset or relaytime_reset
+	uint16_t missed;		// Drive edges without feedback within RELAYTIME_TIMEOUT
+	uint32_t last;			// In us
+	uint32_t min;			// In us
+	uint32_t max;			// In us
+	uint32_t average;		// In us << RELAYTIME_AVERAGE_SHIFT (0 = no measurement yet)
+} relaytime_stats_t;
+
+extern relaytime_stats_t relaytime_operate;		// Drive on to contacts closed
+extern relaytime_stats_t relaytime_release;		// Drive off to contacts open
+
+void relaytime_init(void);
+void relaytime_driven(bool on);
+uint32_t relaytime_lead(bool on);
+void relaytime_reset(bool on);
+void relaytime_set_default(bool on, uint32_t time);
+
+#endif /* RELAYTIME_H */
@@ -0,0 +1,133 @@
+/*
+ * USB-Changer retain.c
+ *
+ * Warm reset state (see retain.h). retain_valid runs in SystemCoreSetup before .data and .bss are set up, so it only
+ * reads the record and SCU registers. A reset in the middle of retain_save leaves a record with a wrong CRC, the next
+ * boot is cold then.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "retain.h"
+#include "relay.h"
+#include "settings.h"
+#include "usbswitch.h"
+#include "timing.h"
+#include "critical.h"
+
+// Resets that start cold: power on and the errors that may have corrupted the RAM
+#define RETAIN_COLD_REASONS			 (XMC_SCU_RESET_REASON_PORST | XMC_SCU_RESET_REASON_FLASH | XMC_SCU_RESET_REASON_PARITY_ERROR)
+#define RETAIN_CRC_OFFSET			 8U							// Bytes before the CRC covered part (magic, size, crc)
+#define RETAIN_REFRESH_US			 TIMING_MS_TO_US(RETAIN_REFRESH_PERIOD)
+
+typedef char retain_size_check[(sizeof(retain_record_t) == RETAIN_RECORD_SIZE && RETAIN_RECORD_SIZE - RETAIN_CRC_OFFSET <= UINT8_MAX
+		&& RETAIN_RELAY_CHANNEL < SENSOR_CHANNEL_COUNT) ? 1 : -1];
+
+retain_record_t retain_record __attribute__((section(".no_init")));
+uint32_t retain_saved = 0;			// In us. Time of the last save
+
+
+//****************************************************************************
+// retain_crc - returns the CRC of the record
+//****************************************************************************
+uint16_t retain_crc(void){
+	return settings_crc((const uint8_t *)&retain_record + RETAIN_CRC_OFFSET, (uint8_t)(sizeof(retain_record_t) - RETAIN_CRC_OFFSET));
+}
+
+//****************************************************************************
+// retain_valid - returns true after a warm reset if the record is complete (uses no RAM variables, SystemCoreSetup)
+//****************************************************************************
+bool retain_valid(void){
+#if RETAIN_ENABLED
+	// RSTSTAT accumulates the reasons until watchdog_init clears them
+	if((XMC_SCU_RESET_GetDeviceResetReason() & RETAIN_COLD_REASONS) != 0)
+		return false;
+	if(retain_record.magic != RETAIN_MAGIC || retain_record.size != sizeof(retain_record_t) || retain_record.crc != retain_crc())
+		return false;
+	if(retain_record.usb_state > USB_inactive || retain_record.profile >= SETTINGS_PROFILE_COUNT)
+		return false;
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		if(retain_record.channels[i].state != RELAY_LOW && retain_record.channels[i].state != RELAY_HIGH)
+			return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// retain_save - writes the record from the relay channels and filters and the given USB port and profile at now (main context)
+//****************************************************************************
+void retain_save(uint8_t usb_state, uint8_t profile, uint32_t now){
+#if RETAIN_ENABLED
+	retain_record.magic = 0; // Invalid until complete
+	retain_record.size = sizeof(retain_record_t);
+	retain_record.usb_state = usb_state;
+	retain_record.profile = profile;
+	retain_record.reserved[0] = 0;
+	retain_record.reserved[1] = 0;
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		const relay_channel_t *channel = &relay_channels[i];
+		retain_channel_t *retained = &retain_record.channels[i];
+		// The ADC interrupt steps the filter and may switch or fault the channel, the copy is one consistent point
+		critical_state_t primask = critical_enter();
+		retained->upper_threshold = (uint16_t)channel->upper_threshold;
+		retained->lower_threshold = (uint16_t)channel->lower_threshold;
+		retained->latchtime = (uint16_t)channel->latchtime;
+		retained->state = (uint8_t)channel->state;
+		retained->filter = sensor_filter_state[i];
+		critical_exit(primask, CRITICAL_SITE_RETAIN);
+		retained->reserved = 0;
+	}
+	retain_record.crc = retain_crc();
+	retain_record.magic = RETAIN_MAGIC;
+	retain_saved = now;
+#else
+	(void)usb_state;
+	(void)profile;
+	(void)now;
+#endif
+}
+
+//****************************************************************************
+// retain_refresh_due - returns true if the last save is RETAIN_REFRESH_PERIOD or more before now
+//****************************************************************************
+bool retain_refresh_due(uint32_t now){
+#if RETAIN_ENABLED
+	return now - retain_saved >= RETAIN_REFRESH_US;
+#else
+	(void)now;
+	return false;
+#endif
+}
+
+//****************************************************************************
+// retain_restore_channels - takes the working setup and the filters of a valid record over and returns the relay states
+//                           (states: SENSOR_CHANNEL_COUNT entries for relay_init)
+//****************************************************************************
+void retain_restore_channels(uint8_t *states){
+#if RETAIN_ENABLED
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		relay_channel_t *channel = &relay_channels[i];
+		const retain_channel_t *retained = &retain_record.channels[i];
+		critical_state_t primask = critical_enter();
+		channel->upper_threshold = retained->upper_threshold;
+		channel->lower_threshold = retained->lower_threshold;
+		channel->latchtime = retained->latchtime;
+		sensor_filter_state[i] = retained->filter;
+		critical_exit(primask, CRITICAL_SITE_RETAIN);
+		states[i] = retained->state;
+	}
+#else
+	(void)states;
+#endif
+}
+
+//****************************************************************************
+// retain_clear - invalidates the record, the next boot is cold (firmware update)
+//****************************************************************************
+void retain_clear(void){
+	retain_record.magic = 0;
+}
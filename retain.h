@@ -0,0 +1,58 @@
+/*
+ * USB-Changer retain.h
+ *
+ * Warm reset state. The record lives in no-init RAM and holds what a reset would otherwise rebuild from the EEPROM
+ * and a relay in RELAY_LOW: the relay state, the working setup and the filter state of every channel, the active USB
+ * port and threshold profile. The main loop saves it after every relay switch and USB port change and refreshes it every
+ * RETAIN_REFRESH_PERIOD for the settings and filters (retain_save, CRC-16 like the setup record).
+ * After a reset without power loss (watchdog, software, fault, reset pin) a valid record restores the outputs before
+ * the application starts: SystemCoreSetup drives the relay to its retained state instead of off, DAVE_Init powers the
+ * retained USB port right after the pin init, and main takes the working setup and the filters over after
+ * read_eeprom_setup. So a restart does not show at the outputs. A power on, a flash or RAM parity error and a firmware
+ * update start cold.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef RETAIN_H
+#define RETAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "filter.h"
+#include "sensor.h"
+
+#define RETAIN_ENABLED				 0							// Determines if a warm reset restores the outputs and the working state of the last run
+#define RETAIN_MAGIC				 0x5E7A1A3DU				// Marks a record written by this firmware
+#define RETAIN_RECORD_SIZE			 48							// sizeof(retain_record_t), reserved in .no_init by the linker script
+#define RETAIN_REFRESH_PERIOD		 100						// In ms. Period the settings and filter states are saved in (switches are saved at once)
+#define RETAIN_RELAY_CHANNEL		 0							// Sensor channel that drives IO_RELAY (driven by SystemCoreSetup)
+
+typedef struct {
+	uint16_t upper_threshold;
+	uint16_t lower_threshold;
+	uint16_t latchtime;						// In ms
+	uint8_t state;							// relay_states
+	uint8_t reserved;
+	filter_t filter;						// sensor_filter_state of the channel
+} retain_channel_t;
+
+typedef struct {
+	uint32_t magic;							// RETAIN_MAGIC (anything else: no record, e.g. after power on)
+	uint16_t size;							// sizeof(retain_record_t) of the firmware that wrote it
+	uint16_t crc;							// CRC-16/CCITT of all bytes after it
+	uint8_t usb_state;						// USB_states
+	uint8_t profile;						// Active threshold profile
+	uint8_t reserved[2];
+	retain_channel_t channels[SENSOR_CHANNEL_COUNT];
+} retain_record_t;
+
+extern retain_record_t retain_record;
+
+bool retain_valid(void);
+void retain_save(uint8_t usb_state, uint8_t profile, uint32_t now);
+bool retain_refresh_due(uint32_t now);
+void retain_restore_channels(uint8_t *states);
+void retain_clear(void);
+
+#endif /* RETAIN_H */
@@ -0,0 +1,72 @@
+/*
+ * USB-Changer sample.h
+ *
+ * Storage formats of 12 bit ADC samples (0 - 4095, every acquisition profile keeps the 12 bit full scale).
+ * Packed: two samples in 3 bytes, sample 2n in byte 3n and the low nibble of byte 3n + 1, sample 2n + 1 in the high
+ * nibble of byte 3n + 1 and byte 3n + 2 (little endian like the telemetry). 25% less than a uint16_t array, for
+ * raw waveforms (capture ring). A write changes only the nibble of its own sample in the shared byte, so the writer
+ * (one interrupt) never corrupts a sample a reader is taking at the same time.
+ * Tagged: one sample in the bits 0-11 of a uint16_t and a 4 bit tag (channel, flags or a tick difference) in the bits
+ * 12-15, for samples that need some context (recorder windows).
+ * The helpers are inline and only shift and mask (no division), so the ADC interrupt can use them.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdint.h>
+
+#define SAMPLE_MAX					 0x0FFFU					// Largest sample value (12 bit)
+#define SAMPLE_TAG_SHIFT			 12							// Position of the tag in a tagged sample
+#define SAMPLE_TAG_MAX				 15U						// Largest tag
+#define SAMPLE_PACKED_SIZE(count)	 (((count) * 3U + 1U) / 2U)	// In bytes. Packed storage of count samples
+
+//****************************************************************************
+// sample_pack - stores value (12 bit) as sample index of a packed array
+//****************************************************************************
+static inline void sample_pack(uint8_t *packed, uint32_t index, uint16_t value){
+	uint8_t *pair = &packed[(index >> 1) * 3U];
+	if((index & 1U) == 0){
+		pair[0] = (uint8_t)value;
+		pair[1] = (uint8_t)((pair[1] & 0xF0U) | ((value >> 8) & 0x0FU));
+	}
+	else{
+		pair[1] = (uint8_t)((pair[1] & 0x0FU) | (value << 4));
+		pair[2] = (uint8_t)(value >> 4);
+	}
+}
+
+//****************************************************************************
+// sample_unpack - returns sample index of a packed array
+//****************************************************************************
+static inline uint16_t sample_unpack(const uint8_t *packed, uint32_t index){
+	const uint8_t *pair = &packed[(index >> 1) * 3U];
+	if((index & 1U) == 0)
+		return (uint16_t)(pair[0] | ((pair[1] & 0x0FU) << 8));
+	return (uint16_t)((pair[1] >> 4) | (pair[2] << 4));
+}
+
+//****************************************************************************
+// sample_tagged - returns value (12 bit) with tag (4 bit) as tagged sample
+//****************************************************************************
+static inline uint16_t sample_tagged(uint16_t value, uint8_t tag){
+	return (uint16_t)((value & SAMPLE_MAX) | ((uint16_t)tag << SAMPLE_TAG_SHIFT));
+}
+
+//****************************************************************************
+// sample_value - returns the sample of a tagged sample
+//****************************************************************************
+static inline uint16_t sample_value(uint16_t tagged){
+	return tagged & SAMPLE_MAX;
+}
+
+//****************************************************************************
+// sample_tag - returns the tag of a tagged sample
+//****************************************************************************
+static inline uint8_t sample_tag(uint16_t tagged){
+	return (uint8_t)(tagged >> SAMPLE_TAG_SHIFT);
+}
+
+#endif /* SAMPLE_H */
@@ -0,0 +1,117 @@
+/*
+ * USB-Changer scheduler.c
+ *
+ * Cooperative periodic task scheduler built on a SYSTIMER software timer.
+ * Every subsystem registers its own period and phase (offset to the first call), so expensive work can be spread over
+ * different ticks. Tasks are never preempted by each other - a task that takes longer than a tick delays the next ones.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "scheduler.h"
+#include "timing.h"
+
+#define SCHEDULER_TICK_US			 TIMING_MS_TO_US(SCHEDULER_TICK_MS)
+
+typedef char scheduler_tick_check[(SCHEDULER_TICK_MS > 0 && (SCHEDULER_TICK_US % SYSTIMER_TICK_PERIOD_US) == 0) ? 1 : -1];
+
+scheduler_task_t scheduler_tasks[SCHEDULER_MAX_TASKS];
+uint8_t scheduler_task_count = 0;
+uint32_t scheduler_timer_id = 0;
+scheduler_wakeup_t scheduler_wakeup = NULL;
+
+
+//****************************************************************************
+// scheduler_tick - SYSTIMER callback (SysTick ISR context), marks all tasks that are due as pending
+//****************************************************************************
+void scheduler_tick(void *args){
+	bool due = false;
+
+	for(uint8_t i = 0; i < scheduler_task_count; i++){
+		scheduler_task_t *task = &scheduler_tasks[i];
+		if(task->countdown > SCHEDULER_TICK_MS){
+			task->countdown -= SCHEDULER_TICK_MS;
+			continue;
+		}
+		task->countdown = task->period;
+		if(task->pending)
+			task->missed++;
+		task->pending = 1;
+		due = true;
+	}
+
+	// Wake up main loop
+	if(due && scheduler_wakeup != NULL)
+		scheduler_wakeup();
+}
+
+//****************************************************************************
+// scheduler_init - creates and starts the SYSTIMER timer driving the scheduler. wakeup is called (ISR context) whenever a task got due
+//****************************************************************************
+bool scheduler_init(scheduler_wakeup_t wakeup){
+	scheduler_wakeup = wakeup;
+
+	scheduler_timer_id = SYSTIMER_CreateTimer(SCHEDULER_TICK_US, SYSTIMER_MODE_PERIODIC, scheduler_tick, NULL);
+	if(scheduler_timer_id == 0)
+		return false;
+
+	return SYSTIMER_StartTimer(scheduler_timer_id) == SYSTIMER_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// scheduler_add_task - registers a periodic task. phase_ms delays the first call (0 means due in the next tick)
+//****************************************************************************
+int8_t scheduler_add_task(scheduler_task_callback_t callback, uint16_t period_ms, uint16_t phase_ms){
+	if(callback == NULL || period_ms < SCHEDULER_TICK_MS || scheduler_task_count >= SCHEDULER_MAX_TASKS)
+		return SCHEDULER_INVALID_TASK;
+
+	// Prepare slot before it becomes visible to the tick (count is incremented last)
+	scheduler_task_t *task = &scheduler_tasks[scheduler_task_count];
+	task->callback = callback;
+	task->period = period_ms;
+	task->countdown = phase_ms;
+	task->pending = 0;
+	task->missed = 0;
+
+	return (int8_t)scheduler_task_count++;
+}
+
+//****************************************************************************
+// scheduler_trigger - requests an immediate (out of period) call of a task. May be called from ISR context
+//****************************************************************************
+void scheduler_trigger(int8_t task_id){
+	if(task_id < 0 || task_id >= scheduler_task_count)
+		return;
+	scheduler_tasks[task_id].pending = 1;
+	if(scheduler_wakeup != NULL)
+		scheduler_wakeup();
+}
+
+//****************************************************************************
+// scheduler_run - dispatches all pending tasks in registration order (main context). Returns the number of callbacks run
+//****************************************************************************
+uint8_t scheduler_run(void){
+	uint8_t run_count = 0;
+
+	for(uint8_t i = 0; i < scheduler_task_count; i++){
+		scheduler_task_t *task = &scheduler_tasks[i];
+		if(task->pending){
+			// Clear before calling, so a tick during the callback is not lost
+			task->pending = 0;
+			task->callback();
+			run_count++;
+		}
+	}
+
+	return run_count;
+}
+
+//****************************************************************************
+// scheduler_get_task - read access to a task record (e.g. the overrun counter) for diagnosis
+//****************************************************************************
+const scheduler_task_t *scheduler_get_task(int8_t task_id){
+	if(task_id < 0 || task_id >= scheduler_task_count)
+		return NULL;
+	return &scheduler_tasks[task_id];
+}
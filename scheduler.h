@@ -0,0 +1,37 @@
+/*
+ * USB-Changer scheduler.h
+ *
+ * Cooperative periodic task scheduler built on a SYSTIMER software timer.
+ * The timer callback (SysTick ISR context) only marks tasks as due, the callbacks are dispatched from the main loop.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHEDULER_MAX_TASKS			 11							// Maximum number of registered tasks
+#define SCHEDULER_TICK_MS			 1							// Resolution of task periods and phases in ms (must be a multiple of the SysTick period)
+#define SCHEDULER_INVALID_TASK		 (-1)						// Returned by scheduler_add_task() if no task slot is left
+
+typedef void (*scheduler_task_callback_t)(void);
+typedef void (*scheduler_wakeup_t)(void);
+
+typedef struct {
+	scheduler_task_callback_t callback;	// Function called from main context when the task is due
+	uint16_t period;					// In ms. Time between two calls
+	uint16_t countdown;					// In ms. Time until the task is due next (only modified in tick context)
+	volatile uint8_t pending;			// Set in tick context when due, cleared before the callback is dispatched
+	uint16_t missed;					// Number of periods the task was still pending when it got due again (overrun)
+} scheduler_task_t;
+
+bool scheduler_init(scheduler_wakeup_t wakeup);
+int8_t scheduler_add_task(scheduler_task_callback_t callback, uint16_t period_ms, uint16_t phase_ms);
+void scheduler_trigger(int8_t task_id);
+uint8_t scheduler_run(void);
+const scheduler_task_t *scheduler_get_task(int8_t task_id);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,855 @@
+/*
+ * USB-Changer sensor.c
+ *
+ * Sensor acquisition (see sensor.h).
+ * In free running mode CCU40 slice 1 (slice 3 with COIL_ENABLED, slice 1 then drives the relay pin, slice 0 is the LED
+ * PWM) runs as plain timer. Its period match event is
+ * routed to service request line SR2, which is hard-wired to VADC background trigger input A. Every period therefore
+ * loads the background channel and starts one conversion without any software involvement, the sample rate does not
+ * depend on how busy the main loop is. The CCU40 SR2 interrupt itself stays disabled in the NVIC.
+ * The sample ring buffer uses free running 8 bit indices: the head is only written by the producer (ADC interrupt), the
+ * tail only by the consumer (main loop), so neither side has to mask interrupts. A full buffer drops the new sample.
+ * Additional sensor channels are added to the background scan sequence of the ADC_MEASUREMENT channel. The XMC1100
+ * has only the global result register, so with wait-for-read mode every channel of a scan raises its own result
+ * interrupt (the channel is identified by GLOBRES.CHNR). Accumulation would mix channels and is not allowed then.
+ * The running statistics of a channel are updated by the ADC interrupt and read by the main loop while acquisition
+ * continues: the reader copies the record and repeats the copy if the sequence counter changed meanwhile.
+ * The health check compares the result counter of the ADC interrupt with its last value. If it did not move for
+ * SENSOR_WATCHDOG_TIMEOUT the scan is restarted: pending conversions are aborted, a result blocked by wait-for-read
+ * mode is released and a new conversion is started.
+ * A sample time calibration step runs with the health check: the result interrupt is masked, the results of the
+ * reference and the candidate sample time are polled from GLOBRES (about 9 ms at 4 kHz, the first result of each
+ * setting is dropped as its conversion may have started before the change) and the active profile is restored.
+ * The relay outputs keep their state meanwhile.
+ * The governor changes only the period of the trigger timer (its prescaler is chosen at init so the lowest rate still
+ * fits in 16 bit). The ADC interrupt raises the rate, the health check lowers it with interrupts masked, both write
+ * the period through sensor_write_period and the shadow transfer takes it over at the next period match. A near
+ * flag set by the interrupt right after the health check cleared it is only seen at the next check, at the full rate
+ * that flag already caused.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "sensor.h"
+#include "timing.h"
+#include "profiler.h"
+#include "ramcode.h"
+#include "watchdog.h"
+#include "log.h"
+#include "coil.h"
+#include "divide.h"
+#include "metrics.h"
+#include "arena.h"
+#include "critical.h"
+#include "hal.h"
+#include "pins.h"
+
+#if COIL_ENABLED
+	#define SENSOR_TIMER_SLICE		 CCU40_CC43					// Timer slice triggering the conversions (slice 1 drives the relay pin)
+	#define SENSOR_TIMER_SLICE_NUMBER 3U
+	#define SENSOR_TIMER_SHADOW		 XMC_CCU4_SHADOW_TRANSFER_SLICE_3
+	#define SENSOR_EXCITATION_PORT	 XMC_GPIO_PORT1				// Excitation output P1.3 = CCU40.OUT3 (ALT2)
+	#define SENSOR_EXCITATION_PIN	 3U
+#else
+	#define SENSOR_TIMER_SLICE		 CCU40_CC41					// Timer slice triggering the conversions
+	#define SENSOR_TIMER_SLICE_NUMBER 1U
+	#define SENSOR_TIMER_SHADOW		 XMC_CCU4_SHADOW_TRANSFER_SLICE_1
+	#define SENSOR_EXCITATION_PORT	 XMC_GPIO_PORT1				// Excitation output P1.1 = CCU40.OUT1 (ALT2)
+	#define SENSOR_EXCITATION_PIN	 1U
+#endif
+#define SENSOR_EXCITATION_MODE		 XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT2
+#define SENSOR_ADC_GROUP			 0U							// Background scan group of all channels
+#define SENSOR_TIMER_SR				 XMC_CCU4_SLICE_SR_ID_2		// CCU40.SR2 = VADC trigger input A (XMC_VADC_REQ_TR_CCU40_SR2)
+
+uint8_t sensor_trigger_prescaler = 0;	// CCU4 prescaler (XMC_CCU4_SLICE_PRESCALER_t) of the trigger timer
+uint32_t sensor_trigger_period = 0;		// In timer ticks. Period of the trigger timer (0 = not running)
+uint8_t sensor_trigger_shift = 0;		// Timer clock divider (power of 2) of clockscale, the period is divided by it
+volatile uint8_t sensor_rate_shift = 0;	// Trigger period multiplier (power of 2) of the governor (0 = full rate)
+#if SENSOR_GOVERNOR && SENSOR_FREE_RUNNING
+	#define SENSOR_RATE_SHIFT_MAX	 SENSOR_GOVERNOR_SHIFT
+#else
+	#define SENSOR_RATE_SHIFT_MAX	 0U
+#endif
+#if SENSOR_CHANNEL_COUNT > 1 && ADC_OVERSAMPLING > 1
+	#error "ADC_OVERSAMPLING needs a single sensor channel (all channels share the global result register)"
+#endif
+#if SENSOR_RESULT_FIFO && !XMC_VADC_GROUP_AVAILABLE
+	#error "SENSOR_RESULT_FIFO needs a part with VADC groups (the XMC1100 only has the global result register)"
+#endif
+#if SENSOR_RESULT_FIFO && ADC_OVERSAMPLING > 1
+	#error "SENSOR_RESULT_FIFO needs ADC_OVERSAMPLING 1 (the accumulation runs in a single result register)"
+#endif
+#if SENSOR_DECIMATION_BITS > 4 || (SENSOR_DECIMATION_BITS > 0 && ((1U << (2U * SENSOR_DECIMATION_BITS)) % ADC_OVERSAMPLING) != 0)
+	#error "SENSOR_DECIMATION_BITS must be 0 to 4 and 4^n a multiple of ADC_OVERSAMPLING (the 16 bit values of the pipeline)"
+#endif
+#if SENSOR_CALIBRATION && SENSOR_DECIMATION_BITS > 2
+	#error "SENSOR_CALIBRATION needs SENSOR_DECIMATION_BITS <= 2 (the segment interpolation of calib_convert is 32 bit)"
+#endif
+#if SENSOR_SAMPLE_RATE < 1
+	#error "SENSOR_SAMPLE_RATE is in whole Hz, the lowest rate is 1 Hz (the trigger timer itself would reach about 0.03 Hz)"
+#endif
+#if (SENSOR_SAMPLE_CAL_COUNT % SENSOR_SAMPLE_CAL_CHUNK) != 0
+	#error "SENSOR_SAMPLE_CAL_COUNT must be a multiple of SENSOR_SAMPLE_CAL_CHUNK (whole chunks per calibration step)"
+#endif
+#if SENSOR_EXCITATION && !SENSOR_FREE_RUNNING
+	#error "SENSOR_EXCITATION needs SENSOR_FREE_RUNNING (the trigger slice switches the excitation)"
+#endif
+uint32_t sensor_excitation_ticks = 0;	// In timer ticks. SENSOR_EXCITATION_SETTLE at the full clock
+
+// VADC channel number of each sensor channel (channel index 0 is the ADC_MEASUREMENT Channel_A)
+const uint8_t sensor_adc_channels[SENSOR_CHANNEL_COUNT] = {0};
+filter_t sensor_filter_state[SENSOR_CHANNEL_COUNT];
+stats_t sensor_stats[SENSOR_CHANNEL_COUNT];
+calib_table_t sensor_calib[SENSOR_CHANNEL_COUNT];
+volatile uint16_t sensor_overruns = 0; // Number of samples dropped because the ring buffer was full (debug)
+volatile uint32_t sensor_result_count = 0; // Number of valid results (incremented by the ADC interrupt)
+volatile uint32_t sensor_invalid_count = 0; // Number of result interrupts without valid result or with an unknown channel
+METRICS_REGISTER(sensor_results, METRICS_ID_SENSOR_RESULTS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, sensor_result_count);
+METRICS_REGISTER(sensor_invalid, METRICS_ID_SENSOR_INVALID, METRICS_TYPE_U32, METRICS_UNIT_COUNT, sensor_invalid_count);
+METRICS_REGISTER(sensor_overruns, METRICS_ID_SENSOR_OVERRUNS, METRICS_TYPE_U16, METRICS_UNIT_COUNT, sensor_overruns);
+sensor_health_t sensor_health;
+uint32_t sensor_health_results_last = 0;	// sensor_result_count at the last health check
+uint32_t sensor_health_results_second = 0;	// sensor_result_count at the start of the current rate window
+uint32_t sensor_health_second_start = 0;	// In us. Start of the current rate window
+uint32_t sensor_health_last_result = 0;		// In us. Time of the last health check that saw new results
+const divide_reciprocal_t sensor_health_ms = DIVIDE_RECIPROCAL(TIMING_US_PER_MS);	// us -> ms without a library division
+
+// 10 and 8 bit results are left aligned to 12 bit (bits 11:2 and 11:4, also in the accumulated sum)
+const sensor_profile_t sensor_profile_table[SENSOR_PROFILE_COUNT] = {
+	[SENSOR_PROFILE_PRECISE] = {.conversion_mode = (uint8_t)XMC_VADC_CONVMODE_12BIT, .sample_time = 31U, .resolution = 12U},
+	[SENSOR_PROFILE_BALANCED] = {.conversion_mode = (uint8_t)XMC_VADC_CONVMODE_10BIT, .sample_time = 16U, .resolution = 10U},
+	[SENSOR_PROFILE_FAST] = {.conversion_mode = (uint8_t)XMC_VADC_CONVMODE_8BIT, .sample_time = 0U, .resolution = 8U}
+};
+sensor_profiles sensor_profile = SENSOR_PROFILE;
+uint8_t sensor_sample_time = SENSOR_SAMPLE_TIME_NONE;	// Calibrated STCS code for all profiles (SENSOR_SAMPLE_TIME_NONE = the one of the profile)
+bool sensor_sample_cal_running = false;				// A sample time calibration is running (one chunk per health check)
+uint8_t sensor_sample_cal_low = 0;						// Shortest sample time code not excluded yet
+uint8_t sensor_sample_cal_high = 0;					// Shortest sample time code known to be within the error
+uint16_t sensor_sample_cal_error = 0;					// ADC value. Allowed deviation of the mean from the reference
+uint8_t sensor_sample_cal_results = 0;					// Results of the step collected per sample time
+uint32_t sensor_sample_cal_reference = 0;				// Sum of the results at the longest sample time
+uint32_t sensor_sample_cal_value = 0;					// Sum of the results at the candidate
+sensor_calibrated_t sensor_sample_cal_done = NULL;		// Called with the found code
+volatile uint32_t sensor_requests = 0;					// Bit per sensor channel with a requested conversion (checked by the ADC interrupt)
+sensor_conversion_t sensor_request_done[SENSOR_CHANNEL_COUNT];	// Callback of the requested conversion of each channel
+volatile uint32_t sensor_result_mask = VADC_GLOBRES_RESULT_Msk; // Valid bits of GLOBRES.RESULT in the active profile (read by the ADC interrupt)
+volatile uint16_t sensor_governor_margin = SENSOR_GOVERNOR_MARGIN;	// ADC value. Distance to a threshold below which the full rate is used
+uint32_t sensor_decimation_sum[SENSOR_CHANNEL_COUNT];		// Sum of the results of the sample being decimated
+uint16_t sensor_decimation_count[SENSOR_CHANNEL_COUNT];	// Results in sensor_decimation_sum
+uint16_t sensor_dither_lfsr = 0xACE1U;					// Dither sequence (any value but 0)
+volatile bool sensor_governor_near = false;			// A value came within the margin since the last health check (set by the ADC interrupt)
+uint32_t sensor_governor_last_near = 0;				// In us. Last health check that saw a near value
+METRICS_REGISTER(sensor_rate_shift, METRICS_ID_SENSOR_RATE_SHIFT, METRICS_TYPE_U8, METRICS_UNIT_STATE, sensor_rate_shift);
+#if SENSOR_RESULT_FIFO
+VADC_G_TypeDef *sensor_fifo_group = NULL;			// Group of the sensor channels
+uint8_t sensor_fifo_tail = 0;						// Result register the results are read from (lowest of the FIFO)
+#endif
+
+ARENA(sensor) sensor_sample_t sensor_buffer[SENSOR_BUFFER_SIZE];
+volatile uint8_t sensor_buffer_head = 0; // Written by producer only
+volatile uint8_t sensor_buffer_tail = 0; // Written by consumer only
+
+
+//****************************************************************************
+// sensor_init_oversampling - configures the data reduction (accumulation) of the global result register
+//****************************************************************************
+void sensor_init_oversampling(void){
+	// The VADC adds up ADC_OVERSAMPLING conversions in GLOBRES and raises the result event only for the sum (max. 14 bit)
+	XMC_VADC_RESULT_CONFIG_t res_config = *ADC_SENSOR.array->res_handle;		// The DAVE configuration is const (flash)
+	res_config.data_reduction_control = ADC_OVERSAMPLING - 1U;
+	XMC_VADC_GLOBAL_ResultInit(VADC, &res_config);
+}
+
+//****************************************************************************
+// sensor_init_fifo - chains the result registers below the one of Channel_A into a FIFO written by all sensor channels
+//****************************************************************************
+void sensor_init_fifo(void){
+#if SENSOR_RESULT_FIFO
+	const ADC_MEASUREMENT_CHANNEL_t *channel = ADC_SENSOR.array->channel_array[0];
+	uint32_t head = channel->ch_handle->result_reg_number;
+	if(head < SENSOR_RESULT_FIFO - 1U){
+		LOG_ERROR("Result register %u too low for a FIFO of %u", head, SENSOR_RESULT_FIFO);
+		return;
+	}
+	// The converter writes the head (DAVE settings, raises the result event), the stages below only move the results on
+	XMC_VADC_RESULT_CONFIG_t config = *channel->res_handle;
+	config.part_of_fifo = 1U;
+	config.event_gen_enable = 0U;
+	uint32_t tail = head - (SENSOR_RESULT_FIFO - 1U);
+	for(uint32_t reg = tail; reg < head; reg++)
+		XMC_VADC_GROUP_ResultInit(channel->group_handle, reg, &config);
+	for(uint8_t i = 1; i < SENSOR_CHANNEL_COUNT; i++)
+		XMC_VADC_GROUP_ChannelSetResultRegister(channel->group_handle, sensor_adc_channels[i], head);
+	sensor_fifo_tail = (uint8_t)tail;
+	sensor_fifo_group = channel->group_handle;
+#endif
+}
+
+//****************************************************************************
+// sensor_result_release - discards the results waiting in the result register or FIFO (wait-for-read mode holds the next conversion)
+//****************************************************************************
+void sensor_result_release(void){
+#if SENSOR_RESULT_FIFO
+	for(uint8_t i = 0; i < SENSOR_RESULT_FIFO; i++)
+		(void)SENSOR_RESULT_READ();
+#else
+	(void)SENSOR_RESULT_READ();
+#endif
+}
+
+//****************************************************************************
+// sensor_init_polled - stops the result interrupt, the main loop polls the result register (SENSOR_POLLED)
+//****************************************************************************
+void sensor_init_polled(void){
+#if SENSOR_POLLED
+	// Without the service request the NVIC masks of the pipeline (calibration, statistics) stay harmless
+#if SENSOR_RESULT_FIFO
+	XMC_VADC_GROUP_DisableResultEvent(sensor_fifo_group, sensor_fifo_tail + SENSOR_RESULT_FIFO - 1U);
+#else
+	VADC->GLOBRCR &= ~(uint32_t)VADC_GLOBRCR_SRGEN_Msk;
+#endif
+	NVIC_ClearPendingIRQ((IRQn_Type)ADC_SENSOR.result_intr_handle->node_id);
+#endif
+}
+
+//****************************************************************************
+// sensor_init_broken_wire - enables the VAREF precharge of the sensor channels (an open input reads full scale)
+//****************************************************************************
+void sensor_init_broken_wire(void){
+#if SENSOR_BROKEN_WIRE && XMC_VADC_GROUP_AVAILABLE
+	VADC_G_TypeDef *const group = (SENSOR_ADC_GROUP == 0U) ? VADC_G0 : VADC_G1;
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
+		group->CHCTR[sensor_adc_channels[i]] |= VADC_G_CHCTR_BWDEN_Msk | ((uint32_t)XMC_VADC_CHANNEL_BWDCH_VAREF << VADC_G_CHCTR_BWDCH_Pos);
+#endif
+}
+
+//****************************************************************************
+// sensor_write_period - writes the trigger period of the governor rate at the current clock (interrupts masked or ADC interrupt)
+//****************************************************************************
+RAMCODE
+void sensor_write_period(void){
+	uint32_t ticks = (sensor_trigger_period << sensor_rate_shift) >> sensor_trigger_shift;
+#if SENSOR_EXCITATION
+	// Center aligned: up to the period match (trigger) and back down, the output is on between the two compare matches
+	uint32_t top = (ticks >> 1) - 1U;
+	uint32_t settle = sensor_excitation_ticks >> sensor_trigger_shift;
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(SENSOR_TIMER_SLICE, (uint16_t)top);
+	XMC_CCU4_SLICE_SetTimerCompareMatch(SENSOR_TIMER_SLICE, (uint16_t)((settle < top) ? top - settle : 1U));
+#else
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(SENSOR_TIMER_SLICE, (uint16_t)(ticks - 1U));
+#endif
+	// Taken over at the next period match (the prescaler could only be changed with the timer stopped)
+	XMC_CCU4_EnableShadowTransfer(CCU40, SENSOR_TIMER_SHADOW);
+}
+
+//****************************************************************************
+// sensor_init_trigger - starts the CCU4 timer and lets its period match trigger the background conversions
+//****************************************************************************
+bool sensor_init_trigger(void){
+	// Smallest prescaler (best resolution) whose timer period fits in 16 bit. The period is rounded to the nearest tick
+	uint32_t prescaler = (uint32_t)XMC_CCU4_SLICE_PRESCALER_1;
+	uint32_t period;
+	while(1){
+		uint32_t timer_clock = GLOBAL_CCU4_0.module_frequency >> prescaler;
+		period = (timer_clock + (SENSOR_SAMPLE_RATE / 2U)) / SENSOR_SAMPLE_RATE;
+		if((period << SENSOR_RATE_SHIFT_MAX) <= 0x10000U)
+			break;
+		if(prescaler >= (uint32_t)XMC_CCU4_SLICE_PRESCALER_32768)
+			return false;
+		prescaler++;
+	}
+	if(period < 2U)
+		return false;
+	sensor_trigger_prescaler = (uint8_t)prescaler;
+	sensor_trigger_period = period;
+#if SENSOR_EXCITATION
+	// The excitation window (settle time on both sides of the trigger) must leave the sensor unpowered for a while
+	sensor_excitation_ticks = (uint32_t)(((uint64_t)(GLOBAL_CCU4_0.module_frequency >> prescaler) * SENSOR_EXCITATION_SETTLE + 999999U) / 1000000U);
+	if(2U * sensor_excitation_ticks + 2U >= period)
+		return false;
+#endif
+
+	// Timer: edge aligned (center aligned for the excitation window), repeating, output high while ST is set
+	XMC_CCU4_SLICE_COMPARE_CONFIG_t timer_config = {
+		.timer_mode = (uint32_t)(SENSOR_EXCITATION ? XMC_CCU4_SLICE_TIMER_COUNT_MODE_CA : XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA),
+		.monoshot = (uint32_t)XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+		.passive_level = (uint32_t)XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_LOW,
+		.prescaler_initval = prescaler
+	};
+	XMC_CCU4_SLICE_CompareInit(SENSOR_TIMER_SLICE, &timer_config);
+	XMC_CCU4_SLICE_SetTimerCompareMatch(SENSOR_TIMER_SLICE, 0U);
+	sensor_write_period();
+	XMC_CCU4_SLICE_SetInterruptNode(SENSOR_TIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, SENSOR_TIMER_SR);
+	XMC_CCU4_SLICE_EnableEvent(SENSOR_TIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+
+	// Background source: load the channel on each rising edge of trigger input A
+	XMC_VADC_GLOBAL_BackgroundSelectTrigger(VADC, (uint32_t)XMC_VADC_REQ_TR_CCU40_SR2);
+	XMC_VADC_GLOBAL_BackgroundSelectTriggerEdge(VADC, XMC_VADC_TRIGGER_EDGE_RISING);
+	XMC_VADC_GLOBAL_BackgroundEnableExternalTrigger(VADC);
+
+	XMC_CCU4_EnableClock(CCU40, SENSOR_TIMER_SLICE_NUMBER);
+	XMC_CCU4_SLICE_StartTimer(SENSOR_TIMER_SLICE);
+#if SENSOR_EXCITATION
+	// The pin stays an input (sensor unpowered) until the slice drives it
+	XMC_GPIO_SetMode(SENSOR_EXCITATION_PORT, SENSOR_EXCITATION_PIN, SENSOR_EXCITATION_MODE);
+#endif
+	return true;
+}
+
+//****************************************************************************
+// sensor_get_sample_rate - returns the conversion rate in mHz the trigger timer actually runs at (0 = not free running)
+//****************************************************************************
+uint32_t sensor_get_sample_rate(void){
+	if(sensor_trigger_period == 0)
+		return 0;
+	uint64_t timer_clock = (uint64_t)(GLOBAL_CCU4_0.module_frequency >> sensor_trigger_prescaler) * 1000U;
+	return (uint32_t)(timer_clock / (sensor_trigger_period << sensor_rate_shift));
+}
+
+//****************************************************************************
+// sensor_trigger_age - returns the CPU cycles since the last conversion trigger (0 = not free running, for ISR latency)
+//****************************************************************************
+uint32_t sensor_trigger_age(void){
+	if(sensor_trigger_period == 0)
+		return 0;
+	// The edge aligned timer restarts from 0 at the period match which triggered the conversion
+	uint32_t ticks = XMC_CCU4_SLICE_GetTimerValue(SENSOR_TIMER_SLICE);
+#if SENSOR_EXCITATION
+	// The center aligned timer counts down from the period match and up again
+	uint32_t top = XMC_CCU4_SLICE_GetTimerPeriodMatch(SENSOR_TIMER_SLICE);
+	ticks = (XMC_CCU4_SLICE_GetCountingDir(SENSOR_TIMER_SLICE) == XMC_CCU4_SLICE_TIMER_COUNT_DIR_DOWN) ? top - ticks : top + 1U + ticks;
+#endif
+	return (ticks << (sensor_trigger_prescaler + sensor_trigger_shift)) >> PROFILER_CCU4_CLOCK_SHIFT;
+}
+
+//****************************************************************************
+// sensor_set_clock_shift - keeps the sample rate when the CCU4 clock was divided by 2^shift (interrupts masked)
+//****************************************************************************
+void sensor_set_clock_shift(uint8_t shift){
+	sensor_trigger_shift = shift;
+	if(sensor_trigger_period == 0)
+		return;
+	sensor_write_period();
+}
+
+//****************************************************************************
+// sensor_govern - restores the full rate if a filtered value is within the margin of a threshold (ADC interrupt context)
+//****************************************************************************
+void sensor_govern(int32_t value, int32_t upper_threshold, int32_t lower_threshold){
+#if SENSOR_GOVERNOR && SENSOR_FREE_RUNNING
+	uint32_t margin = sensor_governor_margin;
+	uint32_t to_upper = (value > upper_threshold) ? (uint32_t)(value - upper_threshold) : (uint32_t)(upper_threshold - value);
+	uint32_t to_lower = (value > lower_threshold) ? (uint32_t)(value - lower_threshold) : (uint32_t)(lower_threshold - value);
+	if(to_upper >= margin && to_lower >= margin)
+		return;
+	sensor_governor_near = true;
+	if(sensor_rate_shift != 0 && sensor_trigger_period != 0){
+		sensor_rate_shift = 0;
+		sensor_write_period();
+	}
+#else
+	(void)value;
+	(void)upper_threshold;
+	(void)lower_threshold;
+#endif
+}
+
+//****************************************************************************
+// sensor_governor_step - lowers the rate once no value was near a threshold for SENSOR_GOVERNOR_HOLD (sensor_check_health)
+//****************************************************************************
+void sensor_governor_step(uint32_t now){
+	// The calibration polls results against a timeout, it runs at the full rate
+	if(sensor_governor_near || sensor_sample_cal_running || sensor_trigger_period == 0){
+		sensor_governor_near = false;
+		sensor_governor_last_near = now;
+		return;
+	}
+	if(sensor_rate_shift != 0 || !timing_reached(now, timing_deadline(sensor_governor_last_near, SENSOR_GOVERNOR_HOLD)))
+		return;
+
+	// A value that came near meanwhile keeps the full rate
+	critical_state_t primask = critical_enter();
+	if(!sensor_governor_near){
+		sensor_rate_shift = SENSOR_GOVERNOR_SHIFT;
+		sensor_write_period();
+	}
+	critical_exit(primask, CRITICAL_SITE_SENSOR);
+}
+
+//****************************************************************************
+// sensor_governor_slow - returns true while the governor runs the conversions at the lowered rate
+//****************************************************************************
+bool sensor_governor_slow(void){
+	return sensor_rate_shift != 0;
+}
+
+//****************************************************************************
+// sensor_init - applies the acquisition settings (call after DAVE_Init)
+//****************************************************************************
+bool sensor_init(void){
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		filter_init(&sensor_filter_state[i], SENSOR_FILTER);
+#if SENSOR_STATS
+		stats_init(&sensor_stats[i]);
+#endif
+#if SENSOR_CALIBRATION
+		sensor_calib[i] = calib_default;
+#if SENSOR_DECIMATION_BITS
+		// Identity over the extended full scale
+		sensor_calib[i].points[sensor_calib[i].count - 1U] = (calib_point_t){SENSOR_VALUE_MAX, SENSOR_VALUE_MAX};
+#endif
+		calib_build(&sensor_calib[i]);
+#endif
+		// Channel_A is already part of the sequence (ADC_MEASUREMENT), add the other ones
+		if(i > 0)
+			XMC_VADC_GLOBAL_BackgroundAddChannelToSequence(VADC, SENSOR_ADC_GROUP, sensor_adc_channels[i]);
+	}
+	sensor_init_oversampling();
+	sensor_init_fifo();
+	sensor_init_polled();
+	sensor_init_broken_wire();
+#if SENSOR_DITHER
+	PINS_SET_MODE(SENSOR_DITHER, XMC_GPIO_MODE_OUTPUT_PUSH_PULL);
+#endif
+	sensor_set_profile(SENSOR_PROFILE);
+	sensor_health_last_result = SYSTIMER_GetTime();
+	sensor_health_second_start = sensor_health_last_result;
+#if SENSOR_FREE_RUNNING
+	return sensor_init_trigger();
+#else
+	return true;
+#endif
+}
+
+//****************************************************************************
+// sensor_decimate - adds a result (sum of ADC_OVERSAMPLING conversions) to the decimation of its channel, returns true
+//                   with the sample in *value once 4^SENSOR_DECIMATION_BITS conversions are summed (ADC interrupt context)
+//****************************************************************************
+RAMCODE
+bool sensor_decimate(uint8_t channel, uint32_t sum, uint32_t *value){
+#if SENSOR_DITHER
+	// Galois LFSR x^16 + x^14 + x^13 + x^11 + 1 (period 65535), the next bit is on the line for the next conversion
+	uint32_t lfsr = sensor_dither_lfsr;
+	lfsr = (lfsr >> 1) ^ ((0U - (lfsr & 1U)) & 0xB400U);
+	sensor_dither_lfsr = (uint16_t)lfsr;
+	if(lfsr & 1U)
+		PINS_SET_HIGH(SENSOR_DITHER);
+	else
+		PINS_SET_LOW(SENSOR_DITHER);
+#endif
+	sensor_decimation_sum[channel] += sum;
+	if(++sensor_decimation_count[channel] < SENSOR_DECIMATION_RESULTS)
+		return false;
+	*value = sensor_decimation_sum[channel] >> SENSOR_DECIMATION_BITS;
+	sensor_decimation_sum[channel] = 0;
+	sensor_decimation_count[channel] = 0;
+	return true;
+}
+
+//****************************************************************************
+// sensor_filter - passes a scaled ADC result through the filter stage (ADC interrupt context)
+//****************************************************************************
+RAMCODE
+uint16_t sensor_filter(uint8_t channel, uint16_t value){
+	// The XMC1100 result register only supports accumulation (no FIR/IIR post processing), so filtering is done in software
+	return filter_apply(&sensor_filter_state[channel], value);
+}
+
+//****************************************************************************
+// sensor_calibrate - converts a filtered result to engineering units (ADC interrupt context)
+//****************************************************************************
+uint16_t sensor_calibrate(uint8_t channel, uint16_t value){
+	return calib_convert(&sensor_calib[channel], value);
+}
+
+//****************************************************************************
+// sensor_set_calibration - replaces the calibration table of a channel (main context). Returns false if the table is invalid
+//****************************************************************************
+bool sensor_set_calibration(uint8_t channel, const calib_table_t *table){
+	if(channel >= SENSOR_CHANNEL_COUNT)
+		return false;
+	calib_table_t built = *table;
+	if(!calib_build(&built))
+		return false;
+
+	// Masked so the ADC interrupt never converts with a half copied table
+	IRQn_Type result_irq = (IRQn_Type)ADC_SENSOR.result_intr_handle->node_id;
+	NVIC_DisableIRQ(result_irq);
+	sensor_calib[channel] = built;
+	NVIC_EnableIRQ(result_irq);
+	return true;
+}
+
+//****************************************************************************
+// sensor_get_calibration - returns the calibration table of a channel
+//****************************************************************************
+const calib_table_t *sensor_get_calibration(uint8_t channel){
+	return &sensor_calib[channel];
+}
+
+//****************************************************************************
+// sensor_stats_update - adds a filtered result to the running statistics of a channel (ADC interrupt context)
+//****************************************************************************
+void sensor_stats_update(uint8_t channel, uint16_t value, int32_t upper_threshold, int32_t lower_threshold){
+	stats_update(&sensor_stats[channel], value, upper_threshold, lower_threshold);
+}
+
+//****************************************************************************
+// sensor_get_stats - evaluates the rolling (lifetime = false) or lifetime statistics of a channel (main context)
+//****************************************************************************
+bool sensor_get_stats(uint8_t channel, bool lifetime, stats_result_t *result){
+	if(channel >= SENSOR_CHANNEL_COUNT)
+		return false;
+	stats_t *stats = &sensor_stats[channel];
+	stats_window_t window;
+	uint32_t sequence;
+
+	// Consistent copy without stopping the ADC interrupt (retry if it updated the record in between)
+	do{
+		sequence = stats->sequence;
+		if(lifetime){
+			window = stats->lifetime;
+			stats_merge(&window, &stats->window);
+		}
+		else{
+			window = stats->last_window;
+		}
+	}while(sequence != stats->sequence);
+
+	stats_evaluate(&window, sensor_get_sample_rate() / SENSOR_DECIMATION_RESULTS, result);
+	return true;
+}
+
+//****************************************************************************
+// sensor_reset_stats - clears the statistics of a channel (main context)
+//****************************************************************************
+void sensor_reset_stats(uint8_t channel){
+	if(channel >= SENSOR_CHANNEL_COUNT)
+		return;
+	// Masked so the ADC interrupt does not update a half cleared record
+	IRQn_Type result_irq = (IRQn_Type)ADC_SENSOR.result_intr_handle->node_id;
+	NVIC_DisableIRQ(result_irq);
+	stats_init(&sensor_stats[channel]);
+	NVIC_EnableIRQ(result_irq);
+}
+
+//****************************************************************************
+// sensor_capture_start - starts collecting the results of the next time (in ms) of a channel (main context). Returns false if the rate is unknown
+//****************************************************************************
+bool sensor_capture_start(uint8_t channel, uint32_t time){
+	uint32_t rate = sensor_get_sample_rate() / SENSOR_DECIMATION_RESULTS;
+	if(!SENSOR_STATS || channel >= SENSOR_CHANNEL_COUNT || rate == 0)
+		return false;
+	// rate in mHz: samples = time / 1000 * rate / 1000
+	uint32_t samples = (uint32_t)(((uint64_t)time * rate) / 1000000U);
+	if(samples == 0)
+		samples = 1;
+	// Masked so the ADC interrupt does not add to a half cleared capture
+	IRQn_Type result_irq = (IRQn_Type)ADC_SENSOR.result_intr_handle->node_id;
+	NVIC_DisableIRQ(result_irq);
+	stats_capture_start(&sensor_stats[channel], samples);
+	NVIC_EnableIRQ(result_irq);
+	return true;
+}
+
+//****************************************************************************
+// sensor_capture_result - evaluates the capture of a channel (main context). Returns false while it runs
+//****************************************************************************
+bool sensor_capture_result(uint8_t channel, stats_result_t *result){
+	if(channel >= SENSOR_CHANNEL_COUNT || sensor_stats[channel].capture_remaining != 0)
+		return false;
+	// The ADC interrupt no longer touches a complete capture
+	stats_evaluate(&sensor_stats[channel].capture, 0, result);
+	return true;
+}
+
+//****************************************************************************
+// sensor_channel_index - returns the sensor channel index of a VADC channel number (-1 if it is not scanned)
+//****************************************************************************
+int8_t sensor_channel_index(uint32_t adc_channel){
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		if(sensor_adc_channels[i] == adc_channel)
+			return (int8_t)i;
+	}
+	return -1;
+}
+
+//****************************************************************************
+// sensor_push - queues a sample (producer: ADC interrupt context only)
+//****************************************************************************
+RAMCODE
+void sensor_push(uint8_t channel, uint16_t value, uint32_t timestamp){
+	uint8_t head = sensor_buffer_head;
+	if((uint8_t)(head - sensor_buffer_tail) >= SENSOR_BUFFER_SIZE){
+		sensor_overruns++;
+		return;
+	}
+	sensor_sample_t *sample = &sensor_buffer[head & (SENSOR_BUFFER_SIZE - 1U)];
+	sample->timestamp = timestamp;
+	sample->value = value;
+	sample->channel = channel;
+	sensor_buffer_head = head + 1U; // Publish after the sample is complete
+}
+
+//****************************************************************************
+// sensor_read - takes up to max_count of the oldest samples (consumer: main context only). Returns the number taken
+//****************************************************************************
+uint8_t sensor_read(sensor_sample_t *samples, uint8_t max_count){
+	uint8_t tail = sensor_buffer_tail;
+	uint8_t count = (uint8_t)(sensor_buffer_head - tail);
+	if(count > max_count)
+		count = max_count;
+
+	for(uint8_t i = 0; i < count; i++)
+		samples[i] = sensor_buffer[(uint8_t)(tail + i) & (SENSOR_BUFFER_SIZE - 1U)];
+
+	sensor_buffer_tail = tail + count; // Release the slots after they are copied
+	return count;
+}
+
+//****************************************************************************
+// sensor_available - returns the number of queued samples
+//****************************************************************************
+uint8_t sensor_available(void){
+	return (uint8_t)(sensor_buffer_head - sensor_buffer_tail);
+}
+
+//****************************************************************************
+// sensor_restart - restarts a stalled background scan (main context)
+//****************************************************************************
+void sensor_restart(void){
+	XMC_VADC_GLOBAL_BackgroundAbortSequence(VADC);
+	sensor_result_release(); // Wait-for-read mode blocks the next result until this one is read
+#if SENSOR_FREE_RUNNING
+	XMC_CCU4_SLICE_StartTimer(SENSOR_TIMER_SLICE);
+#endif
+	ADC_MEASUREMENT_StartConversion(&ADC_SENSOR);
+	sensor_health.restarts++;
+	LOG_WARN("ADC scan restarted (%u restarts)", sensor_health.restarts);
+}
+
+//****************************************************************************
+// sensor_set_class - writes the conversion mode and sample time code (STCS) of the input class of the sensor channels
+//****************************************************************************
+void sensor_set_class(uint8_t conversion_mode, uint8_t sample_time){
+	XMC_VADC_GLOBAL_CLASS_t config = {
+		.conversion_mode_standard = conversion_mode,
+		.sample_time_std_conv = sample_time
+	};
+	XMC_VADC_GLOBAL_InputClassInit(VADC, config, XMC_VADC_GROUP_CONV_STD, ADC_MEASUREMENT_ICLASS_NUM);
+#if (UC_SERIES == XMC11)
+	XMC_VADC_GLOBAL_InputClassInit(VADC, config, XMC_VADC_GROUP_CONV_STD, ADC_MEASUREMENT_ICLASS_NUM_XMC11);
+#endif
+}
+
+//****************************************************************************
+// sensor_set_profile - switches the conversion mode and sample time of the input class. Returns false for an unknown profile
+//****************************************************************************
+bool sensor_set_profile(sensor_profiles profile){
+	if(profile >= SENSOR_PROFILE_COUNT)
+		return false;
+	const sensor_profile_t *entry = &sensor_profile_table[profile];
+	// A conversion already running finishes in the old mode, its result has the same full scale (left aligned)
+	sensor_result_mask = (VADC_GLOBRES_RESULT_Msk << (12U - entry->resolution)) & VADC_GLOBRES_RESULT_Msk;
+	sensor_set_class(entry->conversion_mode, (sensor_sample_time != SENSOR_SAMPLE_TIME_NONE) ? sensor_sample_time : entry->sample_time);
+	sensor_profile = profile;
+	return true;
+}
+
+//****************************************************************************
+// sensor_get_profile - returns the active acquisition profile
+//****************************************************************************
+sensor_profiles sensor_get_profile(void){
+	return sensor_profile;
+}
+
+//****************************************************************************
+// sensor_set_sample_time - uses a sample time code (STCS) in every profile (SENSOR_SAMPLE_TIME_NONE = the ones of the profiles)
+//****************************************************************************
+void sensor_set_sample_time(uint8_t sample_time){
+	sensor_sample_time = (sample_time <= SENSOR_SAMPLE_TIME_MAX) ? sample_time : SENSOR_SAMPLE_TIME_NONE;
+	sensor_set_profile(sensor_profile);
+}
+
+//****************************************************************************
+// sensor_get_sample_time - returns the calibrated sample time code (SENSOR_SAMPLE_TIME_NONE = not calibrated)
+//****************************************************************************
+uint8_t sensor_get_sample_time(void){
+	return sensor_sample_time;
+}
+
+//****************************************************************************
+// sensor_calibrate_sample_time - starts the search of the shortest sample time within max_error (ADC value) of the
+//                                longest one, done is called with the found code. Returns false without SENSOR_SAMPLE_CAL or if one is running
+//****************************************************************************
+bool sensor_calibrate_sample_time(uint16_t max_error, sensor_calibrated_t done){
+	if(!SENSOR_SAMPLE_CAL || sensor_sample_cal_running)
+		return false;
+	sensor_sample_cal_low = 0;
+	sensor_sample_cal_high = SENSOR_SAMPLE_TIME_MAX;
+	sensor_sample_cal_error = max_error;
+	sensor_sample_cal_done = done;
+	sensor_sample_cal_results = 0;
+	sensor_sample_cal_reference = 0;
+	sensor_sample_cal_value = 0;
+	sensor_sample_cal_running = true;
+	if(sensor_rate_shift != 0 && sensor_trigger_period != 0){
+		critical_state_t primask = critical_enter();
+		sensor_rate_shift = 0;
+		sensor_write_period();
+		critical_exit(primask, CRITICAL_SITE_SENSOR);
+	}
+	return true;
+}
+
+//****************************************************************************
+// sensor_sample_time_calibrating - returns true while a sample time calibration runs
+//****************************************************************************
+bool sensor_sample_time_calibrating(void){
+	return sensor_sample_cal_running;
+}
+
+//****************************************************************************
+// sensor_sample_cal_sum - converts the first sensor channel at a sample time code and adds SENSOR_SAMPLE_CAL_CHUNK
+//                         results to *sum (result interrupt masked). Returns false on a timeout
+//****************************************************************************
+bool sensor_sample_cal_sum(uint8_t sample_time, uint32_t *sum){
+	sensor_set_class((uint8_t)XMC_VADC_CONVMODE_12BIT, sample_time);
+	uint32_t start = SYSTIMER_GetTime();
+	// Result 0 is dropped (converted with the setting before)
+	for(uint8_t count = 0; count <= SENSOR_SAMPLE_CAL_CHUNK; ){
+#if !SENSOR_FREE_RUNNING
+		hal_adc_start();
+#endif
+		uint32_t adc_register;
+		do{
+			if(SYSTIMER_GetTime() - start >= TIMING_MS_TO_US(SENSOR_SAMPLE_CAL_TIMEOUT))
+				return false;
+			adc_register = SENSOR_RESULT_READ();
+		}while(!(adc_register & VADC_GLOBRES_VF_Msk));
+		if(((adc_register & VADC_GLOBRES_CHNR_Msk) >> VADC_GLOBRES_CHNR_Pos) != sensor_adc_channels[0])
+			continue;
+		if(count > 0)
+			*sum += adc_register & VADC_GLOBRES_RESULT_Msk;
+		count++;
+	}
+	return true;
+}
+
+//****************************************************************************
+// sensor_sample_cal_step - collects a chunk of the calibration step and halves the sample time range once the step
+//                          has all results (sensor_check_health)
+//****************************************************************************
+void sensor_sample_cal_step(void){
+	uint8_t candidate = (uint8_t)((sensor_sample_cal_low + sensor_sample_cal_high) / 2U);
+
+	IRQn_Type result_irq = (IRQn_Type)ADC_SENSOR.result_intr_handle->node_id;
+	NVIC_DisableIRQ(result_irq);
+	// The reference right before the candidate in every chunk, so a slowly moving input does not count as error
+	bool valid = sensor_sample_cal_sum(SENSOR_SAMPLE_TIME_MAX, &sensor_sample_cal_reference)
+			&& sensor_sample_cal_sum(candidate, &sensor_sample_cal_value);
+	sensor_set_profile(sensor_profile);
+	sensor_result_release(); // Releases a result of the calibration settings (wait-for-read mode)
+	NVIC_ClearPendingIRQ(result_irq);
+	NVIC_EnableIRQ(result_irq);
+
+	if(!valid){
+		sensor_sample_cal_running = false;
+		LOG_WARN("Sample time calibration aborted (no results)");
+		return;
+	}
+	sensor_sample_cal_results += SENSOR_SAMPLE_CAL_CHUNK;
+	if(sensor_sample_cal_results < SENSOR_SAMPLE_CAL_COUNT)
+		return;
+	uint32_t reference = (sensor_sample_cal_reference + (SENSOR_SAMPLE_CAL_COUNT * ADC_OVERSAMPLING / 2U)) / (SENSOR_SAMPLE_CAL_COUNT * ADC_OVERSAMPLING);
+	uint32_t value = (sensor_sample_cal_value + (SENSOR_SAMPLE_CAL_COUNT * ADC_OVERSAMPLING / 2U)) / (SENSOR_SAMPLE_CAL_COUNT * ADC_OVERSAMPLING);
+	sensor_sample_cal_results = 0;
+	sensor_sample_cal_reference = 0;
+	sensor_sample_cal_value = 0;
+	uint32_t error = (value > reference) ? value - reference : reference - value;
+	if(error <= sensor_sample_cal_error)
+		sensor_sample_cal_high = candidate;
+	else
+		sensor_sample_cal_low = (uint8_t)(candidate + 1U);
+	if(sensor_sample_cal_low < sensor_sample_cal_high)
+		return;
+
+	sensor_sample_cal_running = false;
+	sensor_set_sample_time(sensor_sample_cal_high);
+	LOG_INFO("Sample time code %u of %u", sensor_sample_cal_high, SENSOR_SAMPLE_TIME_MAX);
+	if(sensor_sample_cal_done != NULL)
+		sensor_sample_cal_done(sensor_sample_cal_high);
+}
+
+//****************************************************************************
+// sensor_check_health - updates sensor_health and restarts the scan if no results arrive (scheduler task, SENSOR_HEALTH_PERIOD)
+//****************************************************************************
+void sensor_check_health(void){
+	uint32_t now = SYSTIMER_GetTime();
+	uint32_t results = sensor_result_count;
+
+	if(results != sensor_health_results_last){
+		sensor_health_results_last = results;
+		sensor_health_last_result = now;
+		sensor_health.stalled = false;
+		watchdog_checkin(WATCHDOG_SENSOR);
+	}
+	if(SENSOR_SAMPLE_CAL && sensor_sample_cal_running)
+		sensor_sample_cal_step();
+#if SENSOR_GOVERNOR && SENSOR_FREE_RUNNING
+	sensor_governor_step(now);
+#endif
+	sensor_health.last_result_age = divide_by_reciprocal(&sensor_health_ms, now - sensor_health_last_result);
+	sensor_health.invalid_results = sensor_invalid_count;
+	sensor_health.overruns = sensor_overruns;
+
+	// Results per second (counted over whole seconds)
+	uint32_t window_end = timing_deadline(sensor_health_second_start, 1000U);
+	if(timing_reached(now, window_end)){
+		sensor_health.results_per_second = results - sensor_health_results_second;
+		sensor_health_results_second = results;
+		sensor_health_second_start = now;
+	}
+
+	// Watchdog
+	if(sensor_health.last_result_age >= SENSOR_WATCHDOG_TIMEOUT){
+		sensor_health.stalled = true;
+		sensor_health_last_result = now; // Next restart earliest after another timeout
+		sensor_restart();
+	}
+}
+
+//****************************************************************************
+// sensor_request_conversion - starts a conversion now (SENSOR_EXCITATION: at the next trigger), done gets the next result of the channel (ADC interrupt context).
+//                             Returns false if the channel is unknown or already has a request
+//****************************************************************************
+bool sensor_request_conversion(uint8_t channel, sensor_conversion_t done){
+	if(channel >= SENSOR_CHANNEL_COUNT || done == NULL)
+		return false;
+	critical_state_t primask = critical_enter();
+	bool busy = (sensor_requests & (1U << channel)) != 0;
+	if(!busy){
+		sensor_request_done[channel] = done;
+		sensor_requests |= 1U << channel;
+	}
+	critical_exit(primask, CRITICAL_SITE_SENSOR);
+	if(busy)
+		return false;
+#if !SENSOR_EXCITATION
+	// Load event of the background source (a running scan finishes first, its result may be the one delivered)
+	hal_adc_start();
+#endif
+	return true;
+}
+
+//****************************************************************************
+// sensor_complete_request - passes a result to the request of its channel (ADC interrupt, only if sensor_requests is set)
+//****************************************************************************
+RAMCODE
+void sensor_complete_request(uint8_t channel, uint16_t value){
+	if(!(sensor_requests & (1U << channel)))
+		return;
+	sensor_requests &= ~(1U << channel); // Cleared first, so done can request the next conversion
+	sensor_request_done[channel](channel, value);
+}
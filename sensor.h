@@ -0,0 +1,190 @@
+/*
+ * USB-Changer sensor.h
+ *
+ * Sensor acquisition. Configures how the ADC_MEASUREMENT background source is sampled: conversions are either
+ * started by the sample task (software trigger) or free running, triggered by a CCU4 timer at a fixed rate.
+ * Results are delivered by the ADC result interrupt (Adc_Measurement_Handler in main.c), which can queue them as
+ * timestamped samples in a lock-free single producer (ISR) / single consumer (main loop) ring buffer.
+ * Several sensor channels can be scanned: each background scan converts all VADC channels of sensor_adc_channels.
+ * The conversion mode and sample time of the input class are selected at run time by an acquisition profile
+ * (sensor_profiles). The VADC left aligns 10 and 8 bit results to the 12 bit result field, so every value of the
+ * pipeline keeps the 12 bit full scale: thresholds, filter states and calibration tables stay valid in every
+ * profile, only the bits below the active resolution are cut off (sensor_result_mask).
+ * The sample time a source with unknown impedance needs is measured at commissioning (sensor_calibrate_sample_time):
+ * the channel is converted at the longest sample time and at a shorter candidate, a binary search finds the shortest
+ * one whose mean stays within the allowed error of the long sample reference. The settling error only grows with
+ * shorter sample times, so 5 steps cover all 32 codes. A step collects its results in chunks over several health
+ * checks, both sample times per chunk, so the result interrupt is only masked for a few conversions at a time.
+ * The found code replaces the sample time of every profile and is stored with the setup (settings_record_t).
+ * A conversion can be requested on demand (sensor_request_conversion, e.g. a host read): it issues a load event of
+ * the background source at once instead of waiting for the next trigger, and the next result of the channel is passed
+ * to the callback (ADC interrupt context, scaled like all results, before the filter). The XMC1100 VADC has no queue
+ * source (XMC_VADC_QUEUE_AVAILABLE is 0), so the extra conversion is a background scan of its own and its result also
+ * feeds the relay like any other sample.
+ * Broken wire detection (SENSOR_BROKEN_WIRE): parts with VADC groups (XMC_VADC_GROUP_AVAILABLE, not the XMC1100)
+ * precharge the sample capacitor to VAREF before every conversion of a sensor channel, so an open input reads full
+ * scale instead of a floating value and the rail check of the relay (relay_check_fault) detects it. The XMC1100 relies
+ * on that rail check alone (an open input drifts to a rail through the pull resistor of the front end).
+ * Result FIFO (SENSOR_RESULT_FIFO): parts with VADC groups can chain SENSOR_RESULT_FIFO group result registers below
+ * the result register of Channel_A into a FIFO that all sensor channels write. The converter keeps going while the
+ * ADC interrupt is delayed by a higher tier, and the interrupt drains every buffered result in one pass (the result
+ * event is still raised per result, the NVIC merges the ones that arrive while it is pending). The XMC1100 has only
+ * the global result register: with wait-for-read mode the converter holds a result until it is read and the hardware
+ * accumulation (ADC_OVERSAMPLING) is what saves interrupts. SENSOR_RESULT_READ reads either source.
+ * Sampling governor (SENSOR_GOVERNOR, free running mode): far from the thresholds the trigger period is stretched to
+ * SENSOR_SAMPLE_RATE >> SENSOR_GOVERNOR_SHIFT. The ADC interrupt compares every filtered value with the thresholds of
+ * its channel (sensor_govern) and restores the full rate at once when it comes within sensor_governor_margin of one,
+ * the health check lowers it again once no channel was near for SENSOR_GOVERNOR_HOLD. The filters work per sample, so
+ * their bandwidth follows the rate: fast and wide near a threshold, slow and narrow far from it. Statistics windows
+ * are evaluated at the rate of their end.
+ * Excitation gating (SENSOR_EXCITATION, free running mode): the supply of a resistive sensor is taken from the output
+ * of the trigger slice (CCU40.OUT1 on P1.1, CCU40.OUT3 on P1.3 with COIL_ENABLED, not bonded on the TSSOP16 of this
+ * board). The slice then counts center aligned: its compare matches switch the output on SENSOR_EXCITATION_SETTLE
+ * before the period match that triggers the conversion and off the same time after it, so the sensor is powered only
+ * for the settling and the sample phase of every conversion. The window follows the governor and clockscale periods.
+ * A requested conversion waits for the next trigger instead of its own load event (the input is unpowered between).
+ * Oversampling and decimation (SENSOR_DECIMATION_BITS): the hardware sums of ADC_OVERSAMPLING conversions are added up
+ * per channel until 4^n conversions are summed, the sum shifted right by n is one sample with n more bits
+ * (SENSOR_VALUE_MAX full scale for filter, calibration, thresholds and statistics, the raw taps before it keep 12 bit).
+ * ADC_OVERSAMPLING 4 with one extra bit is the hardware sum itself. The extra bits need at least about one LSB of noise
+ * on the input: the natural noise of the sensor, or the dither line (SENSOR_DITHER) that puts out one bit of a 16 bit
+ * LFSR per conversion, RC filtered into the input through a large resistor. Its mean is a constant offset.
+ * Polled acquisition (SENSOR_POLLED): the result event raises no interrupt, the main loop reads the result register
+ * itself (adc_poll in main.c) and never sleeps. Between events it spins on the valid flag, during a pass it polls
+ * again between the sections, so a result waits at most for one section (a scheduler task or one flash write step)
+ * instead of the interrupt entry and the wake-up of the loop. Latency and execution time are recorded as
+ * PROFILER_ISR_ADC in both modes, so the two builds compare directly (profiler_report).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SENSOR_H
+#define SENSOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "filter.h"
+#include "stats.h"
+#include "calib.h"
+
+#define SENSOR_CHANNEL_COUNT		 1							// Number of scanned sensor channels (VADC channel numbers in sensor_adc_channels, relay contexts in relay_channels)
+#define SENSOR_FREE_RUNNING			 1							// Determines if conversions are triggered by the CCU40 slice 1 timer (1) or by the sample task (0)
+#define SENSOR_SAMPLE_RATE			 4000						// In Hz. Conversion rate in free running mode, whole Hz from 1 up (the timer prescaler is chosen automatically, see sensor_get_sample_rate for the exact rate)
+#define ADC_OVERSAMPLING			 4							// Number of conversions the VADC accumulates in hardware per result (1 = off, max. 4, only with 1 channel)
+#define SENSOR_DECIMATION_BITS		 0							// Extra bits of the pipeline by oversampling and decimation (4^n conversions per sample, max. 4)
+#define SENSOR_DITHER				 0							// Determines if a pseudo random bit per conversion is put out for an RC filtered dither into the input (not on the TSSOP16)
+#define SENSOR_DITHER_PORT			 XMC_GPIO_PORT1				// Dither line P1.2 (not bonded on the TSSOP16 of this board)
+#define SENSOR_DITHER_PIN			 2U
+#define SENSOR_VALUE_MAX			 ((4096U << SENSOR_DECIMATION_BITS) - 1U)	// Full scale of filter, calibration, thresholds and statistics
+#define SENSOR_DECIMATION_RESULTS	 ((SENSOR_DECIMATION_BITS == 0) ? 1U : ((1U << (2U * SENSOR_DECIMATION_BITS)) / ADC_OVERSAMPLING))	// Results (sums of ADC_OVERSAMPLING conversions) per sample
+#define SENSOR_FILTER				 FILTER_NONE				// Filter stage between ADC result and threshold comparison (filter_types, see filter.h)
+#define SENSOR_PROFILE				 SENSOR_PROFILE_PRECISE		// Acquisition profile at boot (sensor_profiles, the DAVE configuration of global_iclass_config)
+#define SENSOR_SAMPLE_TIME_MAX		 31U						// Longest sample time code (STCS, reference of the sample time calibration)
+#define SENSOR_SAMPLE_TIME_NONE		 0xFFU						// No calibrated sample time, the profiles use their own
+#define SENSOR_SAMPLE_CAL			 0							// Determines if the shortest sample time can be calibrated (sensor_calibrate_sample_time, 0 = the profiles or a stored code set it)
+#define SENSOR_SAMPLE_CAL_COUNT		 16							// Number of results averaged per sample time of the calibration
+#define SENSOR_SAMPLE_CAL_CHUNK		 4							// Results per sample time and health check (the result interrupt is masked for about 2.5 ms)
+#define SENSOR_SAMPLE_CAL_ERROR		 4							// ADC value. Default of the allowed deviation from the reference mean
+#define SENSOR_SAMPLE_CAL_TIMEOUT	 10							// In ms. Longest wait for the results of one chunk (the calibration is aborted)
+#define SENSOR_POLLED				 0							// Determines if the main loop polls the result register instead of the ADC result interrupt (lowest detection latency, no sleep)
+#define SENSOR_RESULT_FIFO			 0							// Number of result registers chained into a FIFO (0 = single result register, parts with VADC groups only, needs ADC_OVERSAMPLING 1)
+#define SENSOR_BROKEN_WIRE			 1							// Determines if the sensor channels are precharged to VAREF for the broken wire detection (parts with VADC groups only)
+#define SENSOR_CALIBRATION			 0							// Determines if filtered results are converted to engineering units (calib.h) before thresholds and statistics
+#define SENSOR_STATS				 0							// Determines if every result is added to the running statistics of its channel (see stats.h, 0 = the teach-in press saves the current value)
+#define SENSOR_HEALTH_PERIOD		 100						// In ms. Period of the pipeline health check (sensor_check_health, scheduler task)
+#define SENSOR_WATCHDOG_TIMEOUT		 200						// In ms. The background scan is restarted if no valid result arrived for this time
+#define SENSOR_GOVERNOR				 0							// Determines if the conversion rate is lowered far from the thresholds (free running mode only)
+#define SENSOR_GOVERNOR_SHIFT		 2							// Conversion rate far from the thresholds is SENSOR_SAMPLE_RATE >> shift (1kHz)
+#define SENSOR_GOVERNOR_MARGIN		 (200U << SENSOR_DECIMATION_BITS)	// ADC value. Default distance to a threshold below which the full rate is used (HOSTCMD_SETTING_GOVERNOR_MARGIN)
+#define SENSOR_GOVERNOR_HOLD		 500						// In ms. Time all channels must stay outside the margin before the rate is lowered
+#define SENSOR_EXCITATION			 0							// Determines if the sensor excitation is switched around every conversion by the trigger slice (free running mode, not on the TSSOP16)
+#define SENSOR_EXCITATION_SETTLE	 20U						// In us. Excitation time before and after every conversion trigger (settling of the sensor and the sample phase)
+#define SENSOR_BUFFER_SIZE			 32							// Number of samples the ring buffer holds (must be a power of 2, max. 128)
+#define SENSOR_BATCH_SIZE			 8							// Number of samples the main loop takes out of the ring buffer at once
+
+typedef enum {
+	SENSOR_PROFILE_PRECISE,		// 12 bit, 256 ADC clocks sample time (high source impedance, slow signals)
+	SENSOR_PROFILE_BALANCED,	// 10 bit, 32 ADC clocks sample time
+	SENSOR_PROFILE_FAST,		// 8 bit, 2 ADC clocks sample time (low impedance source, fast moving signals)
+	SENSOR_PROFILE_COUNT
+} sensor_profiles;
+
+typedef struct {
+	uint8_t conversion_mode;	// XMC_VADC_CONVMODE_t of the input class
+	uint8_t sample_time;		// STCS code of the input class (0-15 = 2 + n ADC clocks, 16-31 = 2 + (n - 15) * 16 ADC clocks)
+	uint8_t resolution;			// In bits
+} sensor_profile_t;
+
+typedef void (*sensor_calibrated_t)(uint8_t sample_time);
+typedef void (*sensor_conversion_t)(uint8_t channel, uint16_t value);
+
+typedef struct {
+	uint32_t timestamp;		// In us (SYSTIMER_GetTimeUs). Time the result was read
+	uint16_t value;			// Scaled and filtered ADC result (12 bit)
+	uint8_t channel;		// Sensor channel index
+} sensor_sample_t;
+
+typedef struct {
+	uint32_t results_per_second;	// Valid results in the last second
+	uint32_t last_result_age;		// In ms. Time since the last valid result (at the last check)
+	uint32_t invalid_results;		// Copy of sensor_invalid_count (at the last check)
+	uint16_t overruns;				// Copy of sensor_overruns (at the last check)
+	uint16_t restarts;				// Number of background scan restarts by the watchdog
+	bool stalled;					// Results stopped arriving, set until the next valid result (relay outputs are not up to date)
+} sensor_health_t;
+
+extern const uint8_t sensor_adc_channels[SENSOR_CHANNEL_COUNT];
+extern filter_t sensor_filter_state[SENSOR_CHANNEL_COUNT];
+extern volatile uint16_t sensor_overruns;
+extern volatile uint32_t sensor_result_count;
+extern volatile uint32_t sensor_invalid_count;
+extern sensor_health_t sensor_health;
+extern const sensor_profile_t sensor_profile_table[SENSOR_PROFILE_COUNT];
+extern volatile uint32_t sensor_result_mask;
+extern volatile uint32_t sensor_requests;
+extern volatile uint16_t sensor_governor_margin;
+#if SENSOR_RESULT_FIFO
+extern VADC_G_TypeDef *sensor_fifo_group;
+extern uint8_t sensor_fifo_tail;
+#endif
+
+// Reads the next result and releases it (GLOBRES layout, the group result registers have the same VF, CHNR and RESULT fields)
+#if SENSOR_RESULT_FIFO
+	#define SENSOR_RESULT_READ()	 (sensor_fifo_group->RES[sensor_fifo_tail])
+#else
+	#define SENSOR_RESULT_READ()	 (VADC->GLOBRES)
+#endif
+
+bool sensor_init(void);
+bool sensor_decimate(uint8_t channel, uint32_t sum, uint32_t *value);
+uint32_t sensor_get_sample_rate(void);
+uint32_t sensor_trigger_age(void);
+void sensor_set_clock_shift(uint8_t shift);
+void sensor_govern(int32_t value, int32_t upper_threshold, int32_t lower_threshold);
+bool sensor_governor_slow(void);
+int8_t sensor_channel_index(uint32_t adc_channel);
+uint16_t sensor_filter(uint8_t channel, uint16_t value);
+uint16_t sensor_calibrate(uint8_t channel, uint16_t value);
+bool sensor_set_calibration(uint8_t channel, const calib_table_t *table);
+const calib_table_t *sensor_get_calibration(uint8_t channel);
+void sensor_stats_update(uint8_t channel, uint16_t value, int32_t upper_threshold, int32_t lower_threshold);
+bool sensor_get_stats(uint8_t channel, bool lifetime, stats_result_t *result);
+void sensor_reset_stats(uint8_t channel);
+bool sensor_capture_start(uint8_t channel, uint32_t time);
+bool sensor_capture_result(uint8_t channel, stats_result_t *result);
+void sensor_push(uint8_t channel, uint16_t value, uint32_t timestamp);
+uint8_t sensor_read(sensor_sample_t *samples, uint8_t max_count);
+uint8_t sensor_available(void);
+void sensor_check_health(void);
+void sensor_restart(void);
+void sensor_result_release(void);
+bool sensor_set_profile(sensor_profiles profile);
+sensor_profiles sensor_get_profile(void);
+void sensor_set_sample_time(uint8_t sample_time);
+uint8_t sensor_get_sample_time(void);
+bool sensor_calibrate_sample_time(uint16_t max_error, sensor_calibrated_t done);
+bool sensor_sample_time_calibrating(void);
+bool sensor_request_conversion(uint8_t channel, sensor_conversion_t done);
+void sensor_complete_request(uint8_t channel, uint16_t value);
+
+#endif /* SENSOR_H */
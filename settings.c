@@ -0,0 +1,119 @@
+/*
+ * USB-Changer settings.c
+ *
+ * Persistent setup record (see settings.h). The XMC1100 has no CRC unit, the CRC is computed bitwise (12 bytes).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "settings.h"
+#include "storage.h"
+
+#define SETTINGS_CRC_POLYNOMIAL		 0x1021U					// CRC-16/CCITT
+#define SETTINGS_CRC_INIT			 0xFFFFU
+#define SETTINGS_CRC_LENGTH			 (SETTINGS_RECORD_SIZE - 2U)	// The CRC covers everything except itself
+
+// Compile time check of the record layout (array size is negative if the record is padded)
+typedef char settings_size_check[(sizeof(settings_record_t) == SETTINGS_RECORD_SIZE) ? 1 : -1];
+typedef char settings_profiles_size_check[(sizeof(settings_profiles_t) == SETTINGS_PROFILES_SIZE && SETTINGS_PROFILE_COUNT >= 2) ? 1 : -1];
+
+
+//****************************************************************************
+// settings_crc - returns the CRC-16/CCITT of a byte sequence
+//****************************************************************************
+uint16_t settings_crc(const uint8_t *data, uint8_t length){
+	uint16_t crc = SETTINGS_CRC_INIT;
+	for(uint8_t i = 0; i < length; i++){
+		crc ^= (uint16_t)data[i] << 8;
+		for(uint8_t bit = 0; bit < 8; bit++){
+			if(crc & 0x8000U)
+				crc = (uint16_t)((crc << 1) ^ SETTINGS_CRC_POLYNOMIAL);
+			else
+				crc = (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+//****************************************************************************
+// settings_get - returns the record in flash (no copy, valid until the next EEPROM write). Returns NULL if none is stored or its version or CRC do not match
+//****************************************************************************
+const settings_record_t *settings_get(void){
+	const uint8_t *data;
+	uint32_t length;
+
+	// The record fits into the first flash block of EEPROM_SETTINGS, so it is stored in one piece
+	if(E_EEPROM_XMC1_GetDataPointer(EEPROM_SETTINGS, 0U, &data, &length) != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS || length != SETTINGS_RECORD_SIZE)
+		return NULL;
+	const settings_record_t *record = (const settings_record_t *)data;
+	if(record->version != SETTINGS_VERSION)
+		return NULL;
+	if(record->crc != settings_crc(data, SETTINGS_CRC_LENGTH))
+		return NULL;
+	return record;
+}
+
+//****************************************************************************
+// settings_read - copies the record from EEPROM. Returns false if none is stored or its version or CRC do not match
+//****************************************************************************
+bool settings_read(settings_record_t *record){
+	const settings_record_t *stored = settings_get();
+	if(stored == NULL)
+		return false;
+	*record = *stored;
+	return true;
+}
+
+//****************************************************************************
+// settings_history_count - returns the number of previous records kept in the EEPROM bank
+//****************************************************************************
+uint8_t settings_history_count(void){
+	return (uint8_t)E_EEPROM_XMC1_GetHistoryCount(EEPROM_SETTINGS);
+}
+
+//****************************************************************************
+// settings_read_previous - copies a previous record (age 0 = the one before the stored). Returns false if none is kept or its version or CRC do not match
+//****************************************************************************
+bool settings_read_previous(settings_record_t *record, uint8_t age){
+	const uint8_t *data;
+	uint32_t length;
+
+	if(E_EEPROM_XMC1_GetHistoryPointer(EEPROM_SETTINGS, age, 0U, &data, &length) != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS || length != SETTINGS_RECORD_SIZE)
+		return false;
+	const settings_record_t *stored = (const settings_record_t *)data;
+	if(stored->version != SETTINGS_VERSION || stored->crc != settings_crc(data, SETTINGS_CRC_LENGTH))
+		return false;
+	*record = *stored;
+	return true;
+}
+
+//****************************************************************************
+// settings_write - sets version and CRC of the record and queues it for EEPROM (see storage.h)
+//****************************************************************************
+bool settings_write(settings_record_t *record){
+	record->version = SETTINGS_VERSION;
+	record->crc = settings_crc((const uint8_t *)record, SETTINGS_CRC_LENGTH);
+	return storage_post(EEPROM_SETTINGS, (const uint8_t *)record, SETTINGS_RECORD_SIZE);
+}
+
+//****************************************************************************
+// settings_read_profiles - copies the profiles 1 and up from EEPROM. Returns false if none are stored or their version or CRC do not match
+//****************************************************************************
+bool settings_read_profiles(settings_profiles_t *profiles){
+	// The record spans two flash blocks, so it is copied instead of used in place
+	if(E_EEPROM_XMC1_Read(EEPROM_PROFILES, 0U, (uint8_t *)profiles, SETTINGS_PROFILES_SIZE) != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		return false;
+	if(profiles->version != SETTINGS_PROFILES_VERSION)
+		return false;
+	return profiles->crc == settings_crc((const uint8_t *)profiles, SETTINGS_PROFILES_SIZE - 2U);
+}
+
+//****************************************************************************
+// settings_write_profiles - sets version and CRC of the profiles and queues them for EEPROM (see storage.h)
+//****************************************************************************
+bool settings_write_profiles(settings_profiles_t *profiles){
+	profiles->version = SETTINGS_PROFILES_VERSION;
+	profiles->crc = settings_crc((const uint8_t *)profiles, SETTINGS_PROFILES_SIZE - 2U);
+	return storage_post(EEPROM_PROFILES, (const uint8_t *)profiles, SETTINGS_PROFILES_SIZE);
+}
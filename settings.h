@@ -0,0 +1,63 @@
+/*
+ * USB-Changer settings.h
+ *
+ * Persistent setup record. All settings are kept in one packed, versioned record with a CRC in the E_EEPROM block
+ * EEPROM_SETTINGS. It is read with one call at boot and always written as a whole, so related values (e.g. both
+ * thresholds) can never be torn by a power loss between two writes. The record fits into one flash block, so it can
+ * also be used in place (settings_get) without a copy.
+ * Further threshold profiles (e.g. a less sensitive one for the night) are kept in the block EEPROM_PROFILES, profile 0
+ * is the one of the setup record, which also holds the index of the active profile. All profiles are read into RAM at
+ * boot, so switching profiles needs no flash access and only the index is written again.
+ * The emulated EEPROM keeps the previous versions of EEPROM_SETTINGS in its bank until the next garbage collection and
+ * indexes them at mount (E_EEPROM_XMC1_HISTORY_DEPTH). settings_read_previous copies one of them without a scan, which
+ * lets the application go back to the last known good settings (see rollback_settings in main.c).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SETTINGS_VERSION			 1							// Layout version of settings_record_t (increment on every layout change)
+#define SETTINGS_RECORD_SIZE		 12							// In bytes. Size of settings_record_t = size of EEPROM_SETTINGS
+#define SETTINGS_PROFILE_COUNT		 4							// Number of threshold profiles (profile 0 in the setup record)
+#define SETTINGS_PROFILES_VERSION	 1							// Layout version of settings_profiles_t
+#define SETTINGS_PROFILES_SIZE		 (4 + (SETTINGS_PROFILE_COUNT - 1) * 6)	// In bytes. Size of settings_profiles_t = size of EEPROM_PROFILES
+
+typedef struct {
+	uint8_t version;				// SETTINGS_VERSION the record was written with
+	uint8_t usb_state;				// USB_states
+	uint16_t upper_threshold;
+	uint16_t lower_threshold;
+	uint16_t latchtime;				// In ms
+	uint8_t sample_time;			// Calibrated sample time code of the sensor + 1 (0 = not calibrated, see sensor_calibrate_sample_time)
+	uint8_t profile;				// Active threshold profile (0 = the thresholds of this record, older records hold 0)
+	uint16_t crc;					// CRC-16/CCITT of all bytes before
+} settings_record_t;				// All members naturally aligned, no padding
+
+typedef struct {
+	uint16_t upper_threshold;
+	uint16_t lower_threshold;
+	uint16_t latchtime;				// In ms
+} settings_profile_t;
+
+typedef struct {
+	uint8_t version;				// SETTINGS_PROFILES_VERSION the record was written with
+	uint8_t bus_address;			// Host bus address (0 = none stored, records of older firmware hold 0)
+	settings_profile_t profiles[SETTINGS_PROFILE_COUNT - 1];	// Profiles 1 to SETTINGS_PROFILE_COUNT - 1
+	uint16_t crc;					// CRC-16/CCITT of all bytes before
+} settings_profiles_t;				// All members naturally aligned, no padding
+
+uint16_t settings_crc(const uint8_t *data, uint8_t length);
+const settings_record_t *settings_get(void);
+bool settings_read(settings_record_t *record);
+uint8_t settings_history_count(void);
+bool settings_read_previous(settings_record_t *record, uint8_t age);
+bool settings_write(settings_record_t *record);
+bool settings_read_profiles(settings_profiles_t *profiles);
+bool settings_write_profiles(settings_profiles_t *profiles);
+
+#endif /* SETTINGS_H */
@@ -0,0 +1,142 @@
+/*
+ * USB-Changer softpwm.c
+ *
+ * Software PWM of the GPIO LEDs (see softpwm.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "softpwm.h"
+#include "hrtimer.h"
+#include "ledfade.h"
+#include "critical.h"
+#include "ramcode.h"
+
+#define SOFTPWM_START				 0xFFU						// softpwm_edge: the next callback starts a frame
+#define SOFTPWM_ALL					 ((1U << SOFTPWM_CHANNELS) - 1U)
+
+typedef char softpwm_frame_check[(SOFTPWM_CHANNELS <= 8 && SOFTPWM_FRAME <= HRTIMER_MAX_US && SOFTPWM_FRAME > 2U * SOFTPWM_MIN_TIME) ? 1 : -1];
+
+softpwm_frame_t softpwm_frames[2];			// Edge lists, the interrupt runs softpwm_frames[softpwm_active]
+volatile uint8_t softpwm_active = 0;
+volatile bool softpwm_pending = false;		// The other buffer holds a new list (taken over at the next frame start)
+volatile bool softpwm_running = false;		// Timer started (cleared by the interrupt at a frame without edges)
+uint8_t softpwm_edge = SOFTPWM_START;		// Next edge of the active frame (interrupt)
+uint8_t softpwm_levels[SOFTPWM_CHANNELS];	// Level per channel (main context)
+uint32_t softpwm_timer = 0;					// hrtimer of the frames (0 = not created)
+
+
+//****************************************************************************
+// softpwm_write - switches the channels of a bit mask on or off
+//****************************************************************************
+RAMCODE
+void softpwm_write(uint32_t channels, bool lit){
+	for(uint8_t i = 0; i < SOFTPWM_CHANNELS; i++){
+		if((channels & (1U << i)) == 0)
+			continue;
+		if(lit != USB_LED_ACTIVE_LOW)
+			DIGITAL_IO_SetOutputHigh(usb_ports[i].led);
+		else
+			DIGITAL_IO_SetOutputLow(usb_ports[i].led);
+	}
+}
+
+//****************************************************************************
+// softpwm_callback - frame start (takes a new list over, lights the channels) or the next off edge (hrtimer interrupt)
+//****************************************************************************
+RAMCODE
+void softpwm_callback(void *args){
+	(void)args;
+	if(softpwm_edge == SOFTPWM_START){
+		if(softpwm_pending){
+			softpwm_active ^= 1U;
+			softpwm_pending = false;
+		}
+		const softpwm_frame_t *frame = &softpwm_frames[softpwm_active];
+		softpwm_write(frame->lit, true);
+		softpwm_write(~frame->lit & SOFTPWM_ALL, false);
+		if(frame->count == 0){
+			softpwm_running = false;
+			return;
+		}
+		softpwm_edge = 0;
+		hrtimer_start(softpwm_timer, frame->edges[0].time);
+		return;
+	}
+
+	const softpwm_frame_t *frame = &softpwm_frames[softpwm_active];
+	const softpwm_edge_t *edge = &frame->edges[softpwm_edge];
+	softpwm_write(edge->channels, false);
+	uint16_t next = SOFTPWM_FRAME;
+	if(++softpwm_edge < frame->count)
+		next = frame->edges[softpwm_edge].time;
+	else
+		softpwm_edge = SOFTPWM_START;
+	hrtimer_start(softpwm_timer, next - edge->time);
+}
+
+//****************************************************************************
+// softpwm_init - creates the frame timer (call after hrtimer_init), the channels start off
+//****************************************************************************
+bool softpwm_init(void){
+#if SOFTPWM_ENABLED
+	softpwm_timer = hrtimer_create(softpwm_callback, NULL);
+	return softpwm_timer != 0;
+#else
+	return true;
+#endif
+}
+
+//****************************************************************************
+// softpwm_set - sets the level of a channel (0 = off to LEDFADE_LEVEL_MAX, main context), applied at the next frame start
+//****************************************************************************
+void softpwm_set(uint8_t channel, uint8_t level){
+	if(!SOFTPWM_ENABLED || channel >= SOFTPWM_CHANNELS || softpwm_timer == 0)
+		return;
+	softpwm_levels[channel] = level;
+
+	// Edge list of all channels, sorted by insertion (channels with the same on time share an edge)
+	softpwm_frame_t frame = {.lit = 0, .count = 0};
+	for(uint8_t i = 0; i < SOFTPWM_CHANNELS; i++){
+		uint32_t on = ledfade_lookup((int32_t)softpwm_levels[i] << LEDFADE_FRACTION_BITS) * SOFTPWM_FRAME / LEDFADE_TABLE_FULL;
+		if(softpwm_levels[i] == 0)
+			continue;
+		frame.lit |= (uint8_t)(1U << i);
+		if(on > SOFTPWM_FRAME - SOFTPWM_MIN_TIME)
+			continue; // Full brightness, no edge
+		if(on < SOFTPWM_MIN_TIME)
+			on = SOFTPWM_MIN_TIME;
+
+		uint8_t pos = 0;
+		while(pos < frame.count && frame.edges[pos].time < on)
+			pos++;
+		if(pos < frame.count && frame.edges[pos].time == on){
+			frame.edges[pos].channels |= (uint8_t)(1U << i);
+			continue;
+		}
+		for(uint8_t j = frame.count; j > pos; j--)
+			frame.edges[j] = frame.edges[j - 1U];
+		frame.edges[pos].time = (uint16_t)on;
+		frame.edges[pos].channels = (uint8_t)(1U << i);
+		frame.count++;
+	}
+
+	// The interrupt takes the list at its next frame start, a stopped timer starts a frame at once
+	critical_state_t primask = critical_enter();
+	softpwm_frames[softpwm_active ^ 1U] = frame;
+	softpwm_pending = true;
+	if(!softpwm_running){
+		softpwm_running = true;
+		softpwm_edge = SOFTPWM_START;
+		hrtimer_start(softpwm_timer, 1U);
+	}
+	critical_exit(primask, CRITICAL_SITE_SOFTPWM);
+}
+
+//****************************************************************************
+// softpwm_get - returns the level of a channel
+//****************************************************************************
+uint8_t softpwm_get(uint8_t channel){
+	return (channel < SOFTPWM_CHANNELS) ? softpwm_levels[channel] : 0;
+}
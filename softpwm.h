@@ -0,0 +1,45 @@
+/*
+ * USB-Changer softpwm.h
+ *
+ * Software PWM for the LEDs on plain GPIO outputs (the USB port indicators). All channels share one frame of
+ * SOFTPWM_FRAME us driven by one hrtimer (CCU40 slice 2): the frame start lights every dimmed channel, then the timer
+ * runs from one off edge to the next. The edges are kept as a list sorted by time with the channels that go off
+ * together merged into one entry, so an interrupt costs one entry and a frame costs one interrupt per distinct
+ * brightness, independent of the resolution. Levels are the brightness levels of the status LED (0 to
+ * LEDFADE_LEVEL_MAX, through the same gamma table, see ledfade.h). Off and full brightness need no edges: with no dimmed
+ * channel the timer is not restarted and the pins keep their level.
+ * softpwm_set builds the new edge list in the second of two buffers, the interrupt takes it over at the next frame
+ * start, so a frame always runs with a complete list.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SOFTPWM_H
+#define SOFTPWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usbswitch.h"
+
+#define SOFTPWM_ENABLED				 0							// Determines if the USB indicators are dimmed (0 = switched on and off by switchUSB only)
+#define SOFTPWM_FRAME				 4000U						// In us. PWM period of all channels (250Hz)
+#define SOFTPWM_MIN_TIME			 20U						// In us. Shortest on and off time (a shorter on time is extended, a shorter off time is full brightness)
+#define SOFTPWM_CHANNELS			 USB_PORT_COUNT				// Channels (the indicators of usb_ports in their order)
+#define SOFTPWM_USB_LEVEL			 96							// Default brightness level of the lit USB indicator (HOSTCMD_SETTING_USB_LED_LEVEL)
+
+typedef struct {
+	uint16_t time;					// In us. Off edge after the frame start
+	uint8_t channels;				// Bit n: channel n goes off
+} softpwm_edge_t;
+
+typedef struct {
+	uint8_t lit;					// Bit n: channel n is on at the frame start (dimmed or full brightness)
+	uint8_t count;					// Number of edges (0 = no dimmed channel, the timer stops)
+	softpwm_edge_t edges[SOFTPWM_CHANNELS];
+} softpwm_frame_t;
+
+bool softpwm_init(void);
+void softpwm_set(uint8_t channel, uint8_t level);
+uint8_t softpwm_get(uint8_t channel);
+
+#endif /* SOFTPWM_H */
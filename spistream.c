@@ -0,0 +1,232 @@
+/*
+ * USB-Changer spistream.c
+ *
+ * SPI sample offload (see spistream.h). The transmit FIFO (32 words) raises SR2 whenever its level falls below half,
+ * the interrupt refills it from the block being sent and picks the next block when it is done: the older full
+ * window first, then the statistics block. Blocks are written in place (the window the ADC interrupt filled) and
+ * only switch owners through their state, every state has one writer: FILLING/FULL the ADC interrupt, READY
+ * spistream_task (header and CRC), SENDING/FREE the SPI interrupt.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_spi.h"
+#include "spistream.h"
+#include "telemetry.h"
+#include "i2ctarget.h"
+#include "sensor.h"
+#include "stats.h"
+
+#if SPISTREAM_ENABLED && (TELEMETRY_ENABLED || I2CTARGET_ENABLED)
+#error "The SPI stream, the telemetry UART and the I2C target share USIC0 channel 0 and its pins"
+#endif
+
+#define SPISTREAM_CHANNEL_USIC		 XMC_SPI0_CH0
+#define SPISTREAM_IRQ				 USIC0_2_IRQn
+#define SPISTREAM_SR				 2U							// Service request of the transmit FIFO event (SR2 = USIC0_2_IRQn)
+#define SPISTREAM_FIFO_SIZE			 32U						// In words. Transmit FIFO at DPTR 0
+#define SPISTREAM_WINDOW_PAYLOAD	 (4U + 2U * SPISTREAM_WINDOW_SAMPLES)
+#define SPISTREAM_STATS_PAYLOAD		 44U
+#define SPISTREAM_NONE				 0xFFU						// No block is sent
+
+spistream_window_t spistream_windows[2];
+volatile uint8_t spistream_state[2] = {SPISTREAM_FREE, SPISTREAM_FREE};
+volatile uint8_t spistream_fill = 0;
+volatile uint16_t spistream_fill_count = 0;
+volatile uint32_t spistream_index = 0;
+volatile uint32_t spistream_dropped = 0;
+uint32_t spistream_resyncs = 0;
+uint8_t spistream_stats[SPISTREAM_HEADER_SIZE + SPISTREAM_STATS_PAYLOAD + 1U];	// Statistics block
+volatile uint8_t spistream_stats_state = SPISTREAM_FREE;
+uint8_t spistream_sequence = 0;
+const uint8_t *spistream_tx = NULL;			// Next byte of the block being sent
+uint16_t spistream_tx_left = 0;				// Bytes of the block not yet in the FIFO
+uint8_t spistream_block = SPISTREAM_NONE;	// Block being sent (0/1 = window, 2 = statistics)
+uint16_t spistream_stats_countdown = SPISTREAM_STATS_PERIOD;
+uint32_t spistream_last_progress = 0;		// spistream_tx_left and FIFO level at the last task run
+uint16_t spistream_idle_time = 0;			// In ms. Time the host did not clock within a block
+
+typedef char spistream_fifo_check[(SPISTREAM_HEADER_SIZE + SPISTREAM_WINDOW_PAYLOAD + 1U) <= UINT16_MAX ? 1 : -1];
+
+
+//****************************************************************************
+// spistream_block_data - returns the first byte and the size of a block
+//****************************************************************************
+const uint8_t *spistream_block_data(uint8_t block, uint16_t *size){
+	if(block < 2U){
+		*size = SPISTREAM_HEADER_SIZE + SPISTREAM_WINDOW_PAYLOAD + 1U;
+		return spistream_windows[block].header;
+	}
+	*size = sizeof(spistream_stats);
+	return spistream_stats;
+}
+
+//****************************************************************************
+// spistream_block_state - returns the state of a block
+//****************************************************************************
+volatile uint8_t *spistream_block_state(uint8_t block){
+	return (block < 2U) ? &spistream_state[block] : &spistream_stats_state;
+}
+
+//****************************************************************************
+// spistream_next_block - starts sending the next ready block, returns false if there is none (SPI interrupt)
+//****************************************************************************
+bool spistream_next_block(void){
+	// Of two full windows the older one is the one the ADC interrupt fills next
+	uint8_t order[3] = {spistream_fill, spistream_fill ^ 1U, 2U};
+	for(uint8_t i = 0; i < 3U; i++){
+		volatile uint8_t *state = spistream_block_state(order[i]);
+		if(*state == SPISTREAM_READY){
+			*state = SPISTREAM_SENDING;
+			spistream_block = order[i];
+			spistream_tx = spistream_block_data(order[i], &spistream_tx_left);
+			return true;
+		}
+	}
+	return false;
+}
+
+#if SPISTREAM_ENABLED
+//****************************************************************************
+// USIC0_2_IRQHandler - refills the transmit FIFO from the ready blocks
+//****************************************************************************
+void USIC0_2_IRQHandler(void){
+	XMC_USIC_CH_TXFIFO_ClearEvent(SPISTREAM_CHANNEL_USIC, XMC_USIC_CH_TXFIFO_EVENT_STANDARD);
+	while(!XMC_USIC_CH_TXFIFO_IsFull(SPISTREAM_CHANNEL_USIC)){
+		if(spistream_tx_left == 0){
+			if(spistream_block != SPISTREAM_NONE){
+				*spistream_block_state(spistream_block) = SPISTREAM_FREE;
+				spistream_block = SPISTREAM_NONE;
+			}
+			// Nothing to send - the host reads the passive level (0xFF) until the task pends the interrupt again
+			if(!spistream_next_block())
+				break;
+		}
+		XMC_USIC_CH_TXFIFO_PutData(SPISTREAM_CHANNEL_USIC, *spistream_tx++);
+		spistream_tx_left--;
+	}
+}
+#endif
+
+//****************************************************************************
+// spistream_finish - writes header and CRC of a block and hands it to the SPI interrupt
+//****************************************************************************
+void spistream_finish(uint8_t block, uint8_t type, uint16_t payload_length){
+	uint16_t size;
+	uint8_t *data = (uint8_t *)spistream_block_data(block, &size);
+	data[0] = SPISTREAM_SYNC;
+	data[1] = type;
+	data[2] = spistream_sequence++;
+	telemetry_put16(&data[3], payload_length);
+	data[5] = 0;
+	uint8_t crc = 0;
+	for(uint16_t i = 1; i < size - 1U; i++)
+		crc = telemetry_crc8(crc, data[i]);
+	data[size - 1U] = crc;
+	*spistream_block_state(block) = SPISTREAM_READY;
+	NVIC_SetPendingIRQ(SPISTREAM_IRQ);
+}
+
+//****************************************************************************
+// spistream_send_stats - builds the statistics block of the streamed channel
+//****************************************************************************
+void spistream_send_stats(void){
+	if(spistream_stats_state != SPISTREAM_FREE)
+		return;
+	stats_result_t result = {0};
+	sensor_get_stats(SPISTREAM_CHANNEL, false, &result);
+
+	uint8_t *p = telemetry_put32(&spistream_stats[SPISTREAM_HEADER_SIZE], result.count);
+	p = telemetry_put16(p, result.min);
+	p = telemetry_put16(p, result.max);
+	p = telemetry_put32(p, result.mean);
+	p = telemetry_put32(p, result.variance);
+	p = telemetry_put32(p, result.time_above);
+	p = telemetry_put32(p, result.time_below);
+	p = telemetry_put32(p, result.upper_crossings);
+	p = telemetry_put32(p, result.lower_crossings);
+	p = telemetry_put32(p, sensor_result_count);
+	p = telemetry_put32(p, sensor_invalid_count);
+	telemetry_put32(p, spistream_dropped);
+	spistream_finish(2U, SPISTREAM_BLOCK_STATS, SPISTREAM_STATS_PAYLOAD);
+}
+
+//****************************************************************************
+// spistream_resync - restarts the channel and the block being sent (main context)
+//****************************************************************************
+void spistream_resync(void){
+	NVIC_DisableIRQ(SPISTREAM_IRQ);
+	// Leaving the SPI mode drops the bits of a partly clocked byte
+	XMC_USIC_CH_SetMode(SPISTREAM_CHANNEL_USIC, XMC_USIC_CH_OPERATING_MODE_IDLE);
+	XMC_USIC_CH_TXFIFO_Flush(SPISTREAM_CHANNEL_USIC);
+	if(spistream_block != SPISTREAM_NONE)
+		spistream_tx = spistream_block_data(spistream_block, &spistream_tx_left);
+	XMC_SPI_CH_Start(SPISTREAM_CHANNEL_USIC);
+	spistream_resyncs++;
+	NVIC_SetPendingIRQ(SPISTREAM_IRQ);
+	NVIC_EnableIRQ(SPISTREAM_IRQ);
+}
+
+//****************************************************************************
+// spistream_init - sets up the SPI slave, its pins and the FIFO (call after power_init)
+//****************************************************************************
+void spistream_init(void){
+#if SPISTREAM_ENABLED
+	const XMC_SPI_CH_CONFIG_t spi_config = {
+		.bus_mode = XMC_SPI_CH_BUS_MODE_SLAVE,
+		.parity_mode = XMC_USIC_CH_PARITY_MODE_NONE
+	};
+	XMC_SPI_CH_Init(SPISTREAM_CHANNEL_USIC, &spi_config);
+	XMC_SPI_CH_SetBitOrderMsbFirst(SPISTREAM_CHANNEL_USIC);
+	XMC_SPI_CH_SetWordLength(SPISTREAM_CHANNEL_USIC, 8U);
+	XMC_SPI_CH_SetFrameLength(SPISTREAM_CHANNEL_USIC, 64U); // Endless frame, there is no select to end it
+	XMC_SPI_CH_SetInputSource(SPISTREAM_CHANNEL_USIC, XMC_SPI_CH_INPUT_SLAVE_SCLKIN, USIC0_C0_DX1_P0_14);
+	XMC_SPI_CH_SetInputSource(SPISTREAM_CHANNEL_USIC, XMC_SPI_CH_INPUT_SLAVE_SELIN, USIC_INPUT_ALWAYS_1); // Always selected
+	XMC_SPI_CH_SetInputSource(SPISTREAM_CHANNEL_USIC, XMC_SPI_CH_INPUT_DIN0, USIC_INPUT_ALWAYS_1); // No MOSI
+
+	XMC_USIC_CH_TXFIFO_Configure(SPISTREAM_CHANNEL_USIC, 0U, XMC_USIC_CH_FIFO_SIZE_32WORDS, SPISTREAM_FIFO_SIZE / 2U);
+	XMC_USIC_CH_TXFIFO_SetInterruptNodePointer(SPISTREAM_CHANNEL_USIC, XMC_USIC_CH_TXFIFO_INTERRUPT_NODE_POINTER_STANDARD, SPISTREAM_SR);
+	XMC_USIC_CH_TXFIFO_EnableEvent(SPISTREAM_CHANNEL_USIC, XMC_USIC_CH_TXFIFO_EVENT_CONF_STANDARD);
+	XMC_SPI_CH_Start(SPISTREAM_CHANNEL_USIC);
+
+	const XMC_GPIO_CONFIG_t sclk_config = {.mode = XMC_GPIO_MODE_INPUT_TRISTATE, .input_hysteresis = XMC_GPIO_INPUT_HYSTERESIS_STANDARD};
+	const XMC_GPIO_CONFIG_t miso_config = {.mode = (XMC_GPIO_MODE_t)P0_15_AF_U0C0_DOUT0, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	XMC_GPIO_Init(P0_14, &sclk_config);
+	XMC_GPIO_Init(P0_15, &miso_config);
+
+	NVIC_SetPriority(SPISTREAM_IRQ, SPISTREAM_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(SPISTREAM_IRQ);
+	NVIC_EnableIRQ(SPISTREAM_IRQ);
+#endif
+}
+
+//****************************************************************************
+// spistream_task - finishes full windows, builds the statistics block and restarts stalled blocks (scheduler task, SPISTREAM_TASK_PERIOD)
+//****************************************************************************
+void spistream_task(void){
+	for(uint8_t i = 0; i < 2U; i++){
+		if(spistream_state[i] == SPISTREAM_FULL)
+			spistream_finish(i, SPISTREAM_BLOCK_WINDOW, SPISTREAM_WINDOW_PAYLOAD);
+	}
+
+	if(spistream_stats_countdown <= SPISTREAM_TASK_PERIOD){
+		spistream_stats_countdown = SPISTREAM_STATS_PERIOD;
+		spistream_send_stats();
+	}
+	else
+		spistream_stats_countdown -= SPISTREAM_TASK_PERIOD;
+
+	// The host stopped clocking within a block: it may have lost the byte alignment
+	uint32_t level = XMC_USIC_CH_TXFIFO_GetLevel(SPISTREAM_CHANNEL_USIC);
+	uint32_t progress = ((uint32_t)spistream_tx_left << 8) | level;
+	if(spistream_block == SPISTREAM_NONE || progress != spistream_last_progress)
+		spistream_idle_time = 0;
+	else if(spistream_idle_time < SPISTREAM_RESYNC_TIME)
+		spistream_idle_time += SPISTREAM_TASK_PERIOD;
+	else{
+		spistream_idle_time = 0;
+		spistream_resync();
+	}
+	spistream_last_progress = progress;
+}
@@ -0,0 +1,105 @@
+/*
+ * USB-Changer spistream.h
+ *
+ * Bulk sample offload over SPI (USIC0 channel 0 as SPI slave, SCLK in on P0.14, MISO on P0.15, mode 0, MSB first).
+ * The ADC result interrupt stores the raw results of one sensor channel in two windows (spistream_push): while the
+ * host reads one window the other one fills. Full windows and a periodic statistics block are sent as blocks:
+ * [SPISTREAM_SYNC][type][sequence][payload length (2)][0][payload][CRC-8 0x07 over type to payload]. Between blocks
+ * the slave sends 0xFF (passive data level). Window payload: [index of the first sample (4)][samples (2 each)], the
+ * index counts all samples, so a gap means samples were dropped because the host did not read in time.
+ * There is no slave select pin (only the SWD pins are free): the slave is always selected. If the host stops
+ * clocking within a block for SPISTREAM_RESYNC_TIME, the channel is restarted and the block is sent again from its
+ * first byte, which realigns the bytes after a glitch on SCLK. The host reads whole blocks and pauses at least
+ * SPISTREAM_RESYNC_TIME after a bad CRC.
+ * It uses the channel and pins of the telemetry UART: it excludes TELEMETRY_ENABLED and I2CTARGET_ENABLED.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SPISTREAM_H
+#define SPISTREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "irqprio.h"
+
+#define SPISTREAM_ENABLED			 0							// Determines if the SPI slave is set up and the ADC interrupt fills the windows (needs TELEMETRY_ENABLED = 0)
+#define SPISTREAM_CHANNEL			 0							// Sensor channel that is streamed
+#define SPISTREAM_WINDOW_SAMPLES	 256						// Samples per window (2 windows, 2 bytes each)
+#define SPISTREAM_STATS_PERIOD		 100						// In ms. Period of the statistics block
+#define SPISTREAM_RESYNC_TIME		 10							// In ms. Clock pause within a block that restarts the block
+#define SPISTREAM_TASK_PERIOD		 5							// In ms. Period of spistream_task (scheduler task)
+#define SPISTREAM_IRQ_PRIORITY		 IRQPRIO_SPISTREAM		// Priority of the USIC0 SR2 interrupt (the FIFO must be refilled before the host clocks it empty)
+#define SPISTREAM_SCLK_MAX			 2000000U					// In Hz. Highest host clock the refill keeps up with at full MCLK (divide by the clockscale factor)
+
+#define SPISTREAM_SYNC				 0xA5U						// First byte of a block
+#define SPISTREAM_HEADER_SIZE		 6							// sync, type, sequence, payload length, 0 (keeps the window samples aligned)
+
+typedef enum {
+	SPISTREAM_BLOCK_WINDOW = 1,		// [index (4)][samples]
+	SPISTREAM_BLOCK_STATS			// [stats_result_t fields (4 or 2 each)][result count (4)][invalid count (4)][dropped samples (4)]
+} spistream_block_types;
+
+typedef enum {
+	SPISTREAM_FREE,			// Can be filled
+	SPISTREAM_FILLING,		// The ADC interrupt writes samples
+	SPISTREAM_FULL,			// Complete, the task adds the CRC
+	SPISTREAM_READY,		// Waits for the SPI interrupt
+	SPISTREAM_SENDING		// The SPI interrupt moves it into the FIFO
+} spistream_states;
+
+typedef struct {
+	uint8_t header[SPISTREAM_HEADER_SIZE];
+	uint8_t index[4];			// Index of the first sample (little endian)
+	uint16_t samples[SPISTREAM_WINDOW_SAMPLES];
+	uint8_t crc;
+} spistream_window_t;
+
+typedef char spistream_window_check[(offsetof(spistream_window_t, samples) == SPISTREAM_HEADER_SIZE + 4 && offsetof(spistream_window_t, crc) == SPISTREAM_HEADER_SIZE + 4 + 2 * SPISTREAM_WINDOW_SAMPLES) ? 1 : -1];
+
+extern spistream_window_t spistream_windows[2];
+extern volatile uint8_t spistream_state[2];		// spistream_states of both windows
+extern volatile uint8_t spistream_fill;			// Window the ADC interrupt fills
+extern volatile uint16_t spistream_fill_count;	// Samples in that window
+extern volatile uint32_t spistream_index;		// Number of streamed samples (dropped ones included)
+extern volatile uint32_t spistream_dropped;		// Samples dropped because both windows were in use
+extern uint32_t spistream_resyncs;				// Blocks restarted after a clock pause
+
+void spistream_init(void);
+void spistream_task(void);
+
+//****************************************************************************
+// spistream_push - stores a raw sample in the filling window (ADC result interrupt)
+//****************************************************************************
+static inline void spistream_push(uint16_t value){
+	uint8_t fill = spistream_fill;
+	uint32_t index = spistream_index;
+	spistream_index = index + 1U;
+	spistream_window_t *window = &spistream_windows[fill];
+
+	if(spistream_state[fill] != SPISTREAM_FILLING){
+		// Still read by the host - the sample is lost, the host sees the gap in the index
+		if(spistream_state[fill] != SPISTREAM_FREE){
+			spistream_dropped++;
+			return;
+		}
+		window->index[0] = (uint8_t)index;
+		window->index[1] = (uint8_t)(index >> 8);
+		window->index[2] = (uint8_t)(index >> 16);
+		window->index[3] = (uint8_t)(index >> 24);
+		spistream_state[fill] = SPISTREAM_FILLING;
+	}
+	uint16_t count = spistream_fill_count;
+	window->samples[count++] = value;
+	if(count < SPISTREAM_WINDOW_SAMPLES){
+		spistream_fill_count = count;
+		return;
+	}
+	// Complete - spistream_task finishes it, the other window fills next
+	spistream_fill_count = 0;
+	spistream_state[fill] = SPISTREAM_FULL;
+	spistream_fill = fill ^ 1U;
+}
+
+#endif /* SPISTREAM_H */
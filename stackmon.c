@@ -0,0 +1,88 @@
+/*
+ * USB-Changer stackmon.c
+ *
+ * Stack painting and the incremental high-water scan (see stackmon.h). The stack limits are symbols of linker_script.ld.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "stackmon.h"
+#include "log.h"
+#include "metrics.h"
+
+extern uint32_t __stack_start[];
+extern uint32_t __initial_sp[];
+extern uint8_t Heap_Bank1_Start[];
+extern char *_sbrk(int nbytes);		// Newlib syscalls.c (_sbrk(0) returns the current break)
+
+uint16_t stackmon_size = 0;
+uint16_t stackmon_high_water = 0;
+uint16_t stackmon_heap = 0;
+uint32_t *stackmon_mark = NULL;			// Lowest word found without the pattern (the words below it are still painted)
+uint32_t *stackmon_position = NULL;		// Next word checked by stackmon_scan
+bool stackmon_warned = false;
+bool stackmon_overflowed = false;
+METRICS_REGISTER(stack_high_water, METRICS_ID_STACK_HIGH_WATER, METRICS_TYPE_U16, METRICS_UNIT_BYTES, stackmon_high_water);
+METRICS_REGISTER(heap_used, METRICS_ID_HEAP_USED, METRICS_TYPE_U16, METRICS_UNIT_BYTES, stackmon_heap);
+
+
+//****************************************************************************
+// stackmon_paint - fills the unused stack with STACKMON_PATTERN (first call of main, before any interrupt is enabled)
+//****************************************************************************
+void stackmon_paint(void){
+#if STACKMON_ENABLED
+	// Everything below the stack pointer is free, the guard keeps a call of the loop (memset) off its own frame
+	uint32_t *limit = (uint32_t *)(__get_MSP() & ~3U) - STACKMON_PAINT_GUARD;
+	for(uint32_t *word = __stack_start; word < limit; word++)
+		*word = STACKMON_PATTERN;
+
+	stackmon_size = (uint16_t)((uint8_t *)__initial_sp - (uint8_t *)__stack_start);
+	stackmon_mark = limit;
+	stackmon_position = __stack_start;
+	stackmon_high_water = (uint16_t)((uint8_t *)__initial_sp - (uint8_t *)limit);
+#endif
+}
+
+//****************************************************************************
+// stackmon_check - records a new mark and reports a stack that came close to or beyond its end
+//****************************************************************************
+void stackmon_check(uint32_t *mark){
+	stackmon_mark = mark;
+	stackmon_high_water = (uint16_t)((uint8_t *)__initial_sp - (uint8_t *)mark);
+	if(mark == __stack_start){
+		if(!stackmon_overflowed)
+			LOG_ERROR("Stack overflow (%u bytes)", stackmon_size);
+		stackmon_overflowed = true;
+		stackmon_warned = true;
+	}
+	else if(!stackmon_warned && stackmon_high_water + STACKMON_WARN_MARGIN > stackmon_size){
+		stackmon_warned = true;
+		LOG_WARN("Stack high-water mark %u of %u bytes", stackmon_high_water, stackmon_size);
+	}
+}
+
+//****************************************************************************
+// stackmon_scan - checks the next STACKMON_SCAN_WORDS words below the mark (main loop, once per pass)
+//****************************************************************************
+void stackmon_scan(void){
+#if STACKMON_ENABLED
+	if(stackmon_mark == NULL)
+		return;
+	for(uint8_t i = 0; i < STACKMON_SCAN_WORDS; i++){
+		// Every word below the mark still holds the pattern: pass complete
+		if(stackmon_position >= stackmon_mark){
+			stackmon_position = __stack_start;
+			stackmon_heap = (uint16_t)((uint8_t *)_sbrk(0) - Heap_Bank1_Start);
+			return;
+		}
+		// Scanned from the bottom, the first used word is the lowest one
+		if(*stackmon_position != STACKMON_PATTERN){
+			stackmon_check(stackmon_position);
+			stackmon_position = __stack_start;
+			return;
+		}
+		stackmon_position++;
+	}
+#endif
+}
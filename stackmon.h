@@ -0,0 +1,38 @@
+/*
+ * USB-Changer stackmon.h
+ *
+ * Stack and heap high-water marks. stackmon_paint fills the free main stack (from __stack_start of linker_script.ld up
+ * to the stack pointer of main) with STACKMON_PATTERN before DAVE_Init, so every word that main, a task or a nested
+ * interrupt handler ever touches loses the pattern. stackmon_scan runs once per main loop pass and checks
+ * STACKMON_SCAN_WORDS words from the bottom of the stack upwards: the first word found without the pattern is the
+ * lowest one ever used, the pass restarts from the bottom and the next passes only check below it. A scan costs a few
+ * us per pass and the mark settles within stack_size / 4 / STACKMON_SCAN_WORDS passes of a new depth.
+ * The mark is the deepest use since reset in bytes below __initial_sp (stackmon_high_water, metric
+ * METRICS_ID_STACK_HIGH_WATER), together with the bytes taken from the heap by _sbrk (stackmon_heap). A warning is
+ * logged once when less than STACKMON_WARN_MARGIN bytes stayed unused, an error once the bottom word was overwritten
+ * (the stack overflowed into the interrupt veneers below it). tools/stack_report.py estimates the worst case at build
+ * time from the call graph, compare both before lowering stack_size.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef STACKMON_H
+#define STACKMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STACKMON_ENABLED			 0							// Determines if the stack is painted and scanned (0 removes the monitor)
+#define STACKMON_PATTERN			 0xA5C3A5C3U				// Fill of the unused stack words
+#define STACKMON_SCAN_WORDS			 16							// Words checked per main loop pass
+#define STACKMON_PAINT_GUARD		 16							// Words below the stack pointer of stackmon_paint left unpainted (its own calls, e.g. memset)
+#define STACKMON_WARN_MARGIN		 128						// In bytes. Unused stack below which the warning is logged
+
+extern uint16_t stackmon_size;			// In bytes. Main stack (__initial_sp - __stack_start)
+extern uint16_t stackmon_high_water;	// In bytes. Deepest stack use since reset
+extern uint16_t stackmon_heap;			// In bytes. Heap taken by _sbrk (never given back)
+
+void stackmon_paint(void);
+void stackmon_scan(void);
+
+#endif /* STACKMON_H */
@@ -0,0 +1,127 @@
+/*
+ * USB-Changer statelog.c
+ *
+ * Erase free append log (see statelog.h). All functions run in main context, flash is only programmed by
+ * statelog_flush, which the main loop calls when it is idle (like storage_flush). A block whose programming was
+ * interrupted by a reset simply fails its checks and is skipped.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "statelog.h"
+#include "trace.h"
+#include "metrics.h"
+
+typedef char statelog_entry_size_check[(sizeof(statelog_entry_t) == STATELOG_BLOCK_SIZE) ? 1 : -1];
+
+uint32_t statelog_sequence = 0;		// Sequence number of the newest entry
+uint8_t statelog_page = 0;			// Page of the next entry
+uint8_t statelog_next = 0;			// Block (in statelog_page) of the next entry, STATELOG_ENTRIES_PER_PAGE = page full
+bool statelog_has_pending = false;
+uint32_t statelog_pending_value = 0;
+uint16_t statelog_writes = 0;
+uint16_t statelog_erases = 0;
+uint16_t statelog_failures = 0;
+METRICS_REGISTER(statelog_writes, METRICS_ID_STATELOG_WRITES, METRICS_TYPE_U16, METRICS_UNIT_COUNT, statelog_writes);
+
+
+//****************************************************************************
+// statelog_entry - returns the flash address of a block
+//****************************************************************************
+const statelog_entry_t *statelog_entry(uint8_t page, uint8_t block){
+	return (const statelog_entry_t *)(STATELOG_PAGE0_BASE + (page * STATELOG_PAGE_SIZE) + (block * STATELOG_BLOCK_SIZE));
+}
+
+//****************************************************************************
+// statelog_valid - returns true if a block holds a completely written entry
+//****************************************************************************
+bool statelog_valid(const statelog_entry_t *entry){
+	return entry->sequence_check == ~entry->sequence && entry->value_check == ~entry->value;
+}
+
+//****************************************************************************
+// statelog_init - finds the newest entry. Returns false if the log holds no valid entry (value is not changed then)
+//****************************************************************************
+bool statelog_init(uint32_t *value){
+	bool found = false;
+
+	statelog_page = 0;
+	statelog_next = 0;
+	for(uint8_t page = 0; page < 2; page++){
+		for(uint8_t block = 0; block < STATELOG_ENTRIES_PER_PAGE; block++){
+			const statelog_entry_t *entry = statelog_entry(page, block);
+			if(!statelog_valid(entry))
+				continue;
+			// Signed distance keeps the order correct across the sequence wrap
+			if(!found || (int32_t)(entry->sequence - statelog_sequence) > 0){
+				found = true;
+				statelog_sequence = entry->sequence;
+				statelog_page = page;
+				statelog_next = block + 1U;
+				*value = entry->value;
+			}
+		}
+	}
+	// Without an entry the state of the pages is unknown, the first flush starts with an erase of page 0
+	if(!found)
+		statelog_next = STATELOG_ENTRIES_PER_PAGE;
+	return found;
+}
+
+//****************************************************************************
+// statelog_post - records a new value (written by the next statelog_flush, a newer post replaces a pending one)
+//****************************************************************************
+void statelog_post(uint32_t value){
+	statelog_pending_value = value;
+	statelog_has_pending = true;
+}
+
+//****************************************************************************
+// statelog_pending - returns true if a value is waiting to be written
+//****************************************************************************
+bool statelog_pending(void){
+	return statelog_has_pending;
+}
+
+//****************************************************************************
+// statelog_flush - writes the pending value (main context, call when idle). Returns true if flash was programmed
+//****************************************************************************
+bool statelog_flush(void){
+	if(!statelog_has_pending)
+		return false;
+
+	statelog_entry_t entry;
+	entry.sequence = statelog_sequence + 1U;
+	entry.value = statelog_pending_value;
+	entry.sequence_check = ~entry.sequence;
+	entry.value_check = ~entry.value;
+
+	for(uint8_t attempt = 0; attempt < STATELOG_WRITE_ATTEMPTS; attempt++){
+		// Page full - continue on the other page (the newest entry stays readable until the first entry there is written)
+		if(statelog_next >= STATELOG_ENTRIES_PER_PAGE){
+			statelog_page ^= 1U;
+			statelog_next = 0;
+			XMC_FLASH_ClearStatus();
+			XMC_FLASH_ErasePage((uint32_t *)statelog_entry(statelog_page, 0));
+			statelog_erases++;
+		}
+
+		const statelog_entry_t *target = statelog_entry(statelog_page, statelog_next);
+		XMC_FLASH_ClearStatus();
+		XMC_FLASH_WriteBlocks((uint32_t *)target, (const uint32_t *)&entry, 1U, true);
+		statelog_next++;
+
+		if(XMC_FLASH_GetStatus() == 0U && statelog_valid(target) && target->value == entry.value){
+			statelog_sequence = entry.sequence;
+			statelog_has_pending = false;
+			statelog_writes++;
+			TRACE(TRACE_STATELOG_WRITE, statelog_page, statelog_next - 1U);
+			return true;
+		}
+		// Block was not erased (e.g. interrupted write before a reset) - skip it
+		statelog_failures++;
+	}
+	TRACE(TRACE_STATELOG_WRITE, statelog_page, 0xFFFFU);
+	return true;
+}
@@ -0,0 +1,41 @@
+/*
+ * USB-Changer statelog.h
+ *
+ * Erase free append log for a small, frequently changing value (the USB state). Every change programs the next
+ * 16 byte flash block (smallest programmable unit of the XMC1) of two dedicated flash pages outside of the emulated
+ * EEPROM, a page is only erased when the other one is full. The newest valid entry (highest sequence number) is the
+ * current value. Compared to a write of an emulated EEPROM block this needs no garbage collection copy, so a value
+ * can be recorded on every change instead of after a save delay.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef STATELOG_H
+#define STATELOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STATELOG_PAGE0_BASE			 0x10008800U				// First of the two flash pages of the log (directly below the E_EEPROM_XMC1 banks, the linker script keeps the program below it)
+#define STATELOG_PAGE_SIZE			 256U						// In bytes. XMC1 flash page (erase unit)
+#define STATELOG_BLOCK_SIZE			 16U						// In bytes. XMC1 flash block (write unit) = one log entry
+#define STATELOG_ENTRIES_PER_PAGE	 (STATELOG_PAGE_SIZE / STATELOG_BLOCK_SIZE)
+#define STATELOG_WRITE_ATTEMPTS		 3							// Number of blocks tried per flush before the value is left pending for the next flush
+
+typedef struct {
+	uint32_t sequence;				// Incremented on every entry (newest entry = highest sequence)
+	uint32_t value;
+	uint32_t sequence_check;		// ~sequence
+	uint32_t value_check;			// ~value (an erased or partly written block never has valid checks)
+} statelog_entry_t;
+
+extern uint16_t statelog_writes;	// Number of written entries since reset
+extern uint16_t statelog_erases;	// Number of page erases since reset
+extern uint16_t statelog_failures;	// Number of blocks that could not be programmed
+
+bool statelog_init(uint32_t *value);
+void statelog_post(uint32_t value);
+bool statelog_pending(void);
+bool statelog_flush(void);
+
+#endif /* STATELOG_H */
@@ -0,0 +1,179 @@
+/*
+ * USB-Changer stats.c
+ *
+ * Incremental running statistics (see stats.h). Instead of a Welford update (one division per sample) the sums of
+ * the samples and of their squares are accumulated in 64 bit. With integer samples this is exact (no cancellation
+ * like with floating point) and overflows only after more than 2^40 samples. Mean and variance are derived from the
+ * sums when queried, that is where the divisions happen (main context).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "stats.h"
+
+
+//****************************************************************************
+// stats_clear_window - resets a block to empty
+//****************************************************************************
+void stats_clear_window(stats_window_t *window){
+	window->count = 0;
+	window->min = 0xFFFFU;
+	window->max = 0;
+	window->sum = 0;
+	window->sum_squares = 0;
+	window->samples_above = 0;
+	window->samples_below = 0;
+	window->upper_crossings = 0;
+	window->lower_crossings = 0;
+}
+
+//****************************************************************************
+// stats_add - adds one sample to count, extremes and sums of a block
+//****************************************************************************
+static inline void stats_add(stats_window_t *window, uint16_t value){
+	window->count++;
+	if(value < window->min)
+		window->min = value;
+	if(value > window->max)
+		window->max = value;
+	window->sum += value;
+	window->sum_squares += (uint32_t)value * value;
+}
+
+//****************************************************************************
+// stats_init - resets rolling and lifetime statistics (a running capture goes on)
+//****************************************************************************
+void stats_init(stats_t *stats){
+	stats_clear_window(&stats->window);
+	stats_clear_window(&stats->last_window);
+	stats_clear_window(&stats->lifetime);
+	stats->zone = STATS_ZONE_BETWEEN;
+	stats->sequence++;
+}
+
+//****************************************************************************
+// stats_update - adds one sample (O(1), no division - may be called from interrupt context)
+//****************************************************************************
+void stats_update(stats_t *stats, uint16_t value, int32_t upper_threshold, int32_t lower_threshold){
+	stats_window_t *window = &stats->window;
+
+	stats_add(window, value);
+	if(stats->capture_remaining != 0){
+		stats_add(&stats->capture, value);
+		stats->capture_remaining--;
+	}
+
+	// Time beyond the thresholds in samples, crossings when entering a zone
+	uint8_t zone = STATS_ZONE_BETWEEN;
+	if((int32_t)value > upper_threshold){
+		zone = STATS_ZONE_ABOVE;
+		window->samples_above++;
+	}
+	else if((int32_t)value < lower_threshold){
+		zone = STATS_ZONE_BELOW;
+		window->samples_below++;
+	}
+	if(zone != stats->zone){
+		if(zone == STATS_ZONE_ABOVE)
+			window->upper_crossings++;
+		else if(zone == STATS_ZONE_BELOW)
+			window->lower_crossings++;
+		stats->zone = zone;
+	}
+
+	// Block complete: it becomes the rolling window and is added to the lifetime statistics
+	if(window->count >= STATS_WINDOW_SAMPLES){
+		stats->last_window = *window;
+		stats_merge(&stats->lifetime, window);
+		stats_clear_window(window);
+	}
+	stats->sequence++;
+}
+
+//****************************************************************************
+// stats_merge - adds the samples of source to target
+//****************************************************************************
+void stats_merge(stats_window_t *target, const stats_window_t *source){
+	if(source->count == 0)
+		return;
+	if(source->min < target->min)
+		target->min = source->min;
+	if(source->max > target->max)
+		target->max = source->max;
+	target->count += source->count;
+	target->sum += source->sum;
+	target->sum_squares += source->sum_squares;
+	target->samples_above += source->samples_above;
+	target->samples_below += source->samples_below;
+	target->upper_crossings += source->upper_crossings;
+	target->lower_crossings += source->lower_crossings;
+}
+
+//****************************************************************************
+// stats_fixed_quotient - returns (dividend / divisor) with STATS_FRAC_BITS fractional bits without overflowing
+//****************************************************************************
+uint64_t stats_fixed_quotient(uint64_t dividend, uint32_t divisor){
+	uint64_t quotient = dividend / divisor;
+	uint64_t remainder = dividend % divisor;
+	return (quotient << STATS_FRAC_BITS) + ((remainder << STATS_FRAC_BITS) / divisor);
+}
+
+//****************************************************************************
+// stats_evaluate - computes mean, variance and times of a block (sample_rate in mHz, see sensor_get_sample_rate)
+//****************************************************************************
+void stats_evaluate(const stats_window_t *window, uint32_t sample_rate, stats_result_t *result){
+	result->count = window->count;
+	result->min = window->min;
+	result->max = window->max;
+	result->upper_crossings = window->upper_crossings;
+	result->lower_crossings = window->lower_crossings;
+	result->mean = 0;
+	result->variance = 0;
+	result->time_above = 0;
+	result->time_below = 0;
+	if(window->count == 0)
+		return;
+
+	// variance = E[x^2] - E[x]^2
+	uint64_t mean = stats_fixed_quotient(window->sum, window->count);
+	uint64_t mean_squares = stats_fixed_quotient(window->sum_squares, window->count);
+	uint64_t mean_squared = (mean * mean) >> STATS_FRAC_BITS;
+	result->mean = (uint32_t)mean;
+	result->variance = (mean_squares > mean_squared) ? (uint32_t)(mean_squares - mean_squared) : 0;
+
+	if(sample_rate != 0){
+		// samples / (rate / 1000) * 1000 = time in ms
+		result->time_above = (uint32_t)(((uint64_t)window->samples_above * 1000000U) / sample_rate);
+		result->time_below = (uint32_t)(((uint64_t)window->samples_below * 1000000U) / sample_rate);
+	}
+}
+
+//****************************************************************************
+// stats_capture_start - collects the next samples into the capture block (stats_update must not run meanwhile)
+//****************************************************************************
+void stats_capture_start(stats_t *stats, uint32_t samples){
+	stats_clear_window(&stats->capture);
+	stats->capture_remaining = samples;
+	stats->sequence++;
+}
+
+//****************************************************************************
+// stats_isqrt - returns the integer square root of value (rounded down, the deviation of a variance with half the fractional bits)
+//****************************************************************************
+uint32_t stats_isqrt(uint32_t value){
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+	while(bit > value)
+		bit >>= 2;
+	while(bit != 0){
+		if(value >= root + bit){
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
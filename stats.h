@@ -0,0 +1,65 @@
+/*
+ * USB-Changer stats.h
+ *
+ * Incremental running statistics of a sensor channel (min, max, mean, variance, time beyond the thresholds and
+ * threshold crossings). Updating costs a constant number of additions per sample and no division, so it can run in
+ * the ADC interrupt. Statistics are kept for a rolling window (the last complete block of STATS_WINDOW_SAMPLES
+ * samples) and for the lifetime since stats_init. Mean and variance are only computed when queried (stats_evaluate).
+ * A capture (stats_capture_start) additionally collects a given number of samples from now on into a block of its
+ * own, like the sampling window of a teach-in. It is independent of the rolling block and survives stats_init.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+#define STATS_WINDOW_SAMPLES		 4096						// Number of samples of the rolling window (approx. 1s at 4kHz)
+#define STATS_FRAC_BITS				 8							// Fractional bits of mean and variance in stats_result_t
+
+typedef enum {STATS_ZONE_BELOW, STATS_ZONE_BETWEEN, STATS_ZONE_ABOVE} stats_zones;
+
+typedef struct {
+	uint32_t count;					// Number of samples
+	uint16_t min;					// Smallest sample (0xFFFF if count is 0)
+	uint16_t max;					// Largest sample
+	uint64_t sum;					// Sum of all samples
+	uint64_t sum_squares;			// Sum of all squared samples
+	uint32_t samples_above;			// Number of samples above the upper threshold
+	uint32_t samples_below;			// Number of samples below the lower threshold
+	uint32_t upper_crossings;		// Number of times the upper threshold got exceeded
+	uint32_t lower_crossings;		// Number of times the value fell below the lower threshold
+} stats_window_t;
+
+typedef struct {
+	stats_window_t window;			// Running block (becomes last_window after STATS_WINDOW_SAMPLES samples)
+	stats_window_t last_window;		// Last complete block = rolling window
+	stats_window_t lifetime;		// All complete blocks (the running block is added on query)
+	stats_window_t capture;			// Samples since stats_capture_start
+	volatile uint32_t capture_remaining;	// Samples still added to capture (0 = complete or none started)
+	uint8_t zone;					// stats_zones of the last sample
+	volatile uint32_t sequence;		// Incremented after every update (lets readers detect an update while copying)
+} stats_t;
+
+typedef struct {
+	uint32_t count;					// Number of samples
+	uint16_t min;
+	uint16_t max;
+	uint32_t mean;					// Mean with STATS_FRAC_BITS fractional bits
+	uint32_t variance;				// Variance with STATS_FRAC_BITS fractional bits (standard deviation = sqrt)
+	uint32_t time_above;			// In ms. Time above the upper threshold (0 if the sample rate is unknown)
+	uint32_t time_below;			// In ms. Time below the lower threshold (0 if the sample rate is unknown)
+	uint32_t upper_crossings;
+	uint32_t lower_crossings;
+} stats_result_t;
+
+void stats_init(stats_t *stats);
+void stats_update(stats_t *stats, uint16_t value, int32_t upper_threshold, int32_t lower_threshold);
+void stats_merge(stats_window_t *target, const stats_window_t *source);
+void stats_evaluate(const stats_window_t *window, uint32_t sample_rate, stats_result_t *result);
+void stats_capture_start(stats_t *stats, uint32_t samples);
+uint32_t stats_isqrt(uint32_t value);
+
+#endif /* STATS_H */
@@ -0,0 +1,186 @@
+/*
+ * USB-Changer stimulus.c
+ *
+ * Synthetic sensor signal generator (see stimulus.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "stimulus.h"
+
+stimulus_t stimulus;
+
+
+//****************************************************************************
+// stimulus_limit - returns value limited to the sample range
+//****************************************************************************
+uint16_t stimulus_limit(int32_t value){
+	if(value < 0)
+		return 0;
+	if(value > STIMULUS_MAX)
+		return STIMULUS_MAX;
+	return (uint16_t)value;
+}
+
+//****************************************************************************
+// stimulus_random - returns the next 16 bit pseudo random number of a generator
+//****************************************************************************
+uint32_t stimulus_random(stimulus_t *generator){
+	generator->seed = generator->seed * 1103515245U + 12345U;
+	return generator->seed >> 16;
+}
+
+//****************************************************************************
+// stimulus_scenario - fills config with a predefined scenario for the thresholds of a relay channel and the sample
+//                     rate (in Hz) the generator is called with
+//****************************************************************************
+void stimulus_scenario(stimulus_config_t *config, stimulus_scenarios scenario, int32_t upper_threshold,
+		int32_t lower_threshold, uint32_t rate){
+	int32_t hysteresis = (upper_threshold > lower_threshold) ? (upper_threshold - lower_threshold) : 0;
+	uint16_t low = stimulus_limit(lower_threshold / 2);
+	uint16_t high = stimulus_limit((upper_threshold + STIMULUS_MAX) / 2);
+	uint16_t toggle = (rate >= 1000U) ? (uint16_t)(rate / 1000U) : 1U;
+
+	*config = (stimulus_config_t){.level = low, .stuck_value = STIMULUS_STUCK_LAST};
+	switch(scenario){
+		case STIMULUS_RAMP:
+		case STIMULUS_STUCK:
+			config->ramp_high = STIMULUS_MAX;
+			config->ramp_period = 20U * rate;
+			config->noise = 16;
+			if(scenario == STIMULUS_STUCK){
+				config->stuck_after = 5U * rate;
+				config->stuck_value = STIMULUS_MAX;
+			}
+			break;
+		case STIMULUS_NOISE:
+			// The low pass (1/16) leaves about 5% of the peak to peak value as standard deviation
+			config->level = stimulus_limit((upper_threshold + lower_threshold) / 2);
+			config->noise = (hysteresis * 6 > 0xFFFF) ? 0xFFFFU : (uint16_t)(hysteresis * 6);
+			config->noise_shift = 4;
+			break;
+		case STIMULUS_SPIKES:
+			config->noise = 16;
+			config->spike_rate = 65;
+			config->spike_height = stimulus_limit(upper_threshold - low + 64);
+			break;
+		case STIMULUS_CHATTER:
+			config->noise = 16;
+			config->chatter_level = stimulus_limit(upper_threshold);
+			config->chatter_amplitude = 128;
+			config->chatter_toggle = toggle;
+			config->chatter_length = rate / 20U;
+			config->chatter_period = rate;
+			break;
+		case STIMULUS_SOAK:
+		default:
+			config->ramp_low = low;
+			config->ramp_high = high;
+			config->ramp_period = 10U * rate;
+			config->noise = stimulus_limit(hysteresis / 4);
+			config->noise_shift = 2;
+			config->spike_rate = 16;
+			config->spike_height = stimulus_limit(hysteresis / 2);
+			config->chatter_level = stimulus_limit(upper_threshold);
+			config->chatter_amplitude = 128;
+			config->chatter_toggle = toggle;
+			config->chatter_length = rate / 50U;
+			config->chatter_period = 3U * rate;
+			break;
+	}
+}
+
+//****************************************************************************
+// stimulus_init - starts a generator with a configuration (copied) and a seed for the random parts
+//****************************************************************************
+void stimulus_init(stimulus_t *generator, const stimulus_config_t *config, uint32_t seed){
+	generator->running = false;
+	generator->config = *config;
+	generator->sample = 0;
+	generator->seed = seed;
+	generator->noise_state = 0;
+	generator->toggle_count = 0;
+	generator->toggle_high = true;
+	generator->stuck = false;
+	generator->spikes = 0;
+	generator->bursts = 0;
+	// The first chatter burst follows a pause
+	generator->burst_phase = config->chatter_length;
+	if(config->ramp_period >= 2U && config->ramp_high > config->ramp_low){
+		generator->ramp = (int32_t)config->ramp_low << 16;
+		generator->ramp_step = ((int32_t)(config->ramp_high - config->ramp_low) << 16) / (int32_t)(config->ramp_period / 2U);
+	}
+	else{
+		generator->ramp = (int32_t)config->level << 16;
+		generator->ramp_step = 0;
+	}
+	generator->clean = generator->last = (uint16_t)(generator->ramp >> 16);
+	generator->running = true;
+}
+
+//****************************************************************************
+// stimulus_next - returns the next sample of a generator
+//****************************************************************************
+uint16_t stimulus_next(stimulus_t *generator){
+	const stimulus_config_t *config = &generator->config;
+	generator->sample++;
+
+	// Stuck-at fault: nothing changes any more
+	if(generator->stuck || (config->stuck_after != 0 && generator->sample > config->stuck_after)){
+		if(!generator->stuck && config->stuck_value != STIMULUS_STUCK_LAST)
+			generator->last = stimulus_limit(config->stuck_value);
+		generator->stuck = true;
+		generator->clean = generator->last;
+		return generator->last;
+	}
+
+	// Ramp (triangle, turns at the ends)
+	int32_t level = generator->ramp >> 16;
+	if(generator->ramp_step != 0){
+		generator->ramp += generator->ramp_step;
+		if(generator->ramp_step > 0 && generator->ramp >= ((int32_t)config->ramp_high << 16)){
+			generator->ramp = (int32_t)config->ramp_high << 16;
+			generator->ramp_step = -generator->ramp_step;
+		}
+		else if(generator->ramp_step < 0 && generator->ramp <= ((int32_t)config->ramp_low << 16)){
+			generator->ramp = (int32_t)config->ramp_low << 16;
+			generator->ramp_step = -generator->ramp_step;
+		}
+	}
+
+	// Chatter burst (square wave around chatter_level)
+	if(config->chatter_length != 0){
+		if(generator->burst_phase < config->chatter_length){
+			if(generator->burst_phase == 0)
+				generator->bursts++;
+			int32_t half = config->chatter_amplitude >> 1;
+			level = config->chatter_level + (generator->toggle_high ? half : -half);
+			if(++generator->toggle_count >= config->chatter_toggle){
+				generator->toggle_count = 0;
+				generator->toggle_high = !generator->toggle_high;
+			}
+		}
+		if(++generator->burst_phase >= config->chatter_period)
+			generator->burst_phase = 0;
+	}
+	generator->clean = stimulus_limit(level);
+
+	// Noise (uniform, one pole low pass for the spectrum)
+	if(config->noise != 0){
+		int32_t white = (int32_t)((stimulus_random(generator) * config->noise) >> 16) - (config->noise >> 1);
+		generator->noise_state += ((white << 8) - generator->noise_state) >> config->noise_shift;
+		level += generator->noise_state >> 8;
+	}
+
+	// Spike (one sample)
+	if(config->spike_rate != 0){
+		uint32_t random = stimulus_random(generator);
+		if(random < config->spike_rate){
+			level += (random & 1U) ? config->spike_height : -(int32_t)config->spike_height;
+			generator->spikes++;
+		}
+	}
+
+	generator->last = stimulus_limit(level);
+	return generator->last;
+}
@@ -0,0 +1,85 @@
+/*
+ * USB-Changer stimulus.h
+ *
+ * Synthetic sensor signal generator for stress and soak tests. stimulus_next returns one 12 bit sample of a waveform
+ * built from the parts of stimulus_config_t, in this order:
+ *   ramp		triangle between ramp_low and ramp_high (or the constant level without a ramp period)
+ *   chatter	bursts of a square wave around chatter_level (e.g. the upper threshold), replacing the ramp level
+ *   noise		uniform noise, low pass filtered for a spectrum that falls off above rate / 2^(noise_shift+1) / pi
+ *   spikes		single samples displaced by +-spike_height at random times
+ *   stuck		from stuck_after on the output stays at stuck_value (or the last sample) for good
+ * The part without noise and spikes is kept in clean, so a driver can tell which relay switches the input intended.
+ * Integer only and without division per sample (the Cortex-M0 has no divider), deterministic for a given seed.
+ * With STIMULUS_ENABLED the ADC result interrupt replaces the conversion result of STIMULUS_CHANNEL by the generator
+ * (scenario STIMULUS_SCENARIO, started after the setup is read), so the relay state machine, statistics, capture and
+ * EEPROM writes see the stimulus at the real conversion rate. The host build feeds it much faster (replay -g).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef STIMULUS_H
+#define STIMULUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STIMULUS_ENABLED			 0							// Determines if the ADC result of STIMULUS_CHANNEL is replaced by the generator (test builds only)
+#define STIMULUS_CHANNEL			 0							// Sensor channel that is fed by the generator
+#define STIMULUS_SCENARIO			 STIMULUS_SOAK				// Scenario of the target build (stimulus_scenarios)
+#define STIMULUS_STUCK_LAST			 0xFFFFU					// stuck_value: the output freezes at the last sample
+#define STIMULUS_MAX				 4095						// Largest sample (12 bit ADC result)
+
+typedef enum {
+	STIMULUS_RAMP,			// Slow ramp over the whole range with little noise (every threshold crossed once per half period)
+	STIMULUS_NOISE,			// Low frequency noise centred between the thresholds, large enough to reach both
+	STIMULUS_SPIKES,		// Low level with single sample spikes above the upper threshold
+	STIMULUS_CHATTER,		// Low level with bursts of fast chatter across the upper threshold
+	STIMULUS_STUCK,			// Ramp that gets stuck at full scale (open sensor) after a few seconds
+	STIMULUS_SOAK,			// Ramp, noise, spikes and chatter together
+	STIMULUS_SCENARIO_COUNT
+} stimulus_scenarios;
+
+typedef struct {
+	uint16_t level;				// Sample without ramp and chatter
+	uint16_t ramp_low;			// Lower end of the ramp
+	uint16_t ramp_high;			// Upper end of the ramp
+	uint32_t ramp_period;		// In samples. Period of the triangle (0 = constant level)
+	uint16_t noise;				// Peak to peak noise (white, before the spectrum filter)
+	uint8_t noise_shift;		// Noise low pass coefficient 1/2^n (0 = white, larger = slower and smaller)
+	uint16_t spike_rate;		// Probability of a spike per sample in 1/65536 (0 = none)
+	uint16_t spike_height;		// Displacement of a spike (sign random)
+	uint16_t chatter_level;		// Centre of the chatter
+	uint16_t chatter_amplitude;	// Peak to peak chatter
+	uint16_t chatter_toggle;	// In samples. Half period of the chatter square wave
+	uint32_t chatter_length;	// In samples. Length of a burst (0 = no chatter)
+	uint32_t chatter_period;	// In samples. Time from burst to burst (start to start)
+	uint32_t stuck_after;		// In samples. Start of the stuck-at fault (0 = never)
+	uint16_t stuck_value;		// Output of the fault (STIMULUS_STUCK_LAST = last sample)
+} stimulus_config_t;
+
+typedef struct {
+	stimulus_config_t config;
+	uint32_t sample;			// Number of generated samples
+	uint32_t seed;				// State of the random numbers
+	int32_t ramp;				// Ramp level with 16 fractional bits
+	int32_t ramp_step;			// Ramp change per sample with 16 fractional bits (sign = direction)
+	int32_t noise_state;		// Filtered noise with 8 fractional bits
+	uint32_t burst_phase;		// In samples. Position in the chatter period
+	uint16_t toggle_count;		// In samples. Position in the half period of the chatter
+	bool toggle_high;			// Chatter is above chatter_level
+	bool stuck;					// The stuck-at fault has started
+	uint16_t clean;				// Last sample without noise and spikes
+	uint16_t last;				// Last sample
+	uint32_t spikes;			// Number of generated spikes
+	uint32_t bursts;			// Number of started chatter bursts
+	volatile bool running;		// Set by stimulus_init when the generator may be used (ADC result interrupt)
+} stimulus_t;
+
+extern stimulus_t stimulus;	// Generator of the target build (STIMULUS_ENABLED)
+
+void stimulus_scenario(stimulus_config_t *config, stimulus_scenarios scenario, int32_t upper_threshold,
+		int32_t lower_threshold, uint32_t rate);
+void stimulus_init(stimulus_t *generator, const stimulus_config_t *config, uint32_t seed);
+uint16_t stimulus_next(stimulus_t *generator);
+
+#endif /* STIMULUS_H */
@@ -0,0 +1,272 @@
+/*
+ * USB-Changer storage.c
+ *
+ * Deferred settings write queue (see storage.h). Posting and flushing both happen in main context, so the queue
+ * needs no locking. E_EEPROM_XMC1_Write itself still blocks while the flash is programmed, that is why the main loop
+ * only flushes when no event and no relay latch is pending. A garbage collection is never left to E_EEPROM_XMC1_Write
+ * (which would run it to completion): it is requested before a write could need it and then advanced in steps.
+ * The wear counters are only saved when a garbage collection finished (one block write per bank erase), so writes
+ * done since the last garbage collection are lost on power off - the erase counts used for the projection are not.
+ * The planned collection waits for an empty queue: a queued write may still fit, and the collection would only delay it.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "storage.h"
+#include "timing.h"
+#include "trace.h"
+#include "wallclock.h"
+#include "metrics.h"
+#include "fieldhist.h"
+
+storage_entry_t storage_queue[STORAGE_QUEUE_SIZE];
+storage_callback_t storage_callback = NULL;
+uint8_t storage_next = 0;	// Slot the next flush starts searching at (keeps the order fair)
+uint16_t storage_writes = 0;
+uint16_t storage_merges = 0;
+uint16_t storage_elided = 0;
+uint16_t storage_failures = 0;
+uint32_t storage_gc_steps = 0;
+METRICS_REGISTER(storage_writes, METRICS_ID_STORAGE_WRITES, METRICS_TYPE_U16, METRICS_UNIT_COUNT, storage_writes);
+METRICS_REGISTER(storage_failures, METRICS_ID_STORAGE_FAILURES, METRICS_TYPE_U16, METRICS_UNIT_COUNT, storage_failures);
+uint16_t storage_gc_failures = 0;
+uint16_t storage_gc_planned = 0;
+uint16_t storage_gc_forced = 0;
+METRICS_REGISTER(storage_gc_planned, METRICS_ID_STORAGE_GC_PLANNED, METRICS_TYPE_U16, METRICS_UNIT_COUNT, storage_gc_planned);
+METRICS_REGISTER(storage_gc_forced, METRICS_ID_STORAGE_GC_FORCED, METRICS_TYPE_U16, METRICS_UNIT_COUNT, storage_gc_forced);
+uint32_t storage_gc_footprint = 0;		// In flash blocks. Largest write posted since reset (the planned collection keeps room for it)
+typedef char storage_wear_size_check[(sizeof(E_EEPROM_XMC1_WEAR_t) == STORAGE_WEAR_SIZE) ? 1 : -1];
+#ifdef E_EEPROM_XMC1_FAST_MOUNT_ENABLED
+typedef char storage_index_size_check[(sizeof(E_EEPROM_XMC1_INDEX_t) == STORAGE_INDEX_SIZE) ? 1 : -1];
+#endif
+
+E_EEPROM_XMC1_WEAR_t storage_wear_boot;	// Wear counters at reset (reference of the erase rate)
+uint32_t storage_last_erase_time = 0;	// Wall clock of the last bank erase
+
+
+//****************************************************************************
+// storage_init - clears the queue and sets the completion callback (may be NULL)
+//****************************************************************************
+void storage_init(storage_callback_t callback){
+	for(uint8_t i = 0; i < STORAGE_QUEUE_SIZE; i++)
+		storage_queue[i].block_number = 0;
+	storage_callback = callback;
+	storage_gc_footprint = E_EEPROM_XMC1_GetBlockFootprint(EEPROM_SETTINGS); // The record the user changes
+
+	// Continue the saved wear counters (erases done by E_EEPROM_XMC1_Init itself are already counted in RAM)
+	E_EEPROM_XMC1_WEAR_t saved;
+	E_EEPROM_XMC1_WEAR_t total = *E_EEPROM_XMC1_GetWearCounters();
+	if(E_EEPROM_XMC1_Read(EEPROM_WEAR, 0U, (uint8_t *)&saved, STORAGE_WEAR_SIZE) == E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS){
+		for(uint8_t i = 0; i < E_EEPROM_XMC1_MAX_BLOCK_COUNT; i++)
+			total.block_writes[i] += saved.block_writes[i];
+		total.gc_runs += saved.gc_runs;
+		total.bank_erases[0] += saved.bank_erases[0];
+		total.bank_erases[1] += saved.bank_erases[1];
+		E_EEPROM_XMC1_SetWearCounters(&total);
+	}
+	storage_wear_boot = total;
+}
+
+//****************************************************************************
+// storage_unchanged - returns true if the flash already holds this content of a block
+//****************************************************************************
+bool storage_unchanged(uint8_t block_number, const uint8_t *data, uint8_t size){
+	// Compare in place, piece by piece of the flash blocks the content is split over
+	uint8_t offset = 0;
+	while(offset < size){
+		const uint8_t *current;
+		uint32_t length;
+		// Never written (or not readable right now) counts as changed
+		if(E_EEPROM_XMC1_GetDataPointer(block_number, offset, &current, &length) != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+			return false;
+		for(uint32_t i = 0; i < length && offset < size; i++, offset++){
+			if(current[i] != data[offset])
+				return false;
+		}
+	}
+	return true;
+}
+
+//****************************************************************************
+// storage_post - queues the new content of a block (replaces queued content of the same block). Returns false if the queue is full
+//****************************************************************************
+bool storage_post(uint8_t block_number, const uint8_t *data, uint8_t size){
+	if(block_number == 0 || size > STORAGE_BLOCK_SIZE_MAX)
+		return false;
+
+	// Content equal to the flash needs no write (a queued update of the block is dropped, the flash content is the latest)
+	bool unchanged = storage_unchanged(block_number, data, size);
+
+	// Merge into a queued update of the same block, else take a free slot
+	storage_entry_t *entry = NULL;
+	for(uint8_t i = 0; i < STORAGE_QUEUE_SIZE; i++){
+		if(storage_queue[i].block_number == block_number){
+			entry = &storage_queue[i];
+			storage_merges++;
+			break;
+		}
+		if(entry == NULL && storage_queue[i].block_number == 0)
+			entry = &storage_queue[i];
+	}
+	if(unchanged){
+		if(entry != NULL && entry->block_number == block_number)
+			entry->block_number = 0;
+		storage_elided++;
+		return true;
+	}
+	if(entry == NULL)
+		return false;
+	uint32_t footprint = E_EEPROM_XMC1_GetBlockFootprint(block_number);
+	if(footprint > storage_gc_footprint)
+		storage_gc_footprint = footprint;
+
+	for(uint8_t i = 0; i < size; i++)
+		entry->data[i] = data[i];
+	entry->size = size;
+	entry->retries = 0;
+	entry->block_number = block_number;
+	return true;
+}
+
+//****************************************************************************
+// storage_pending - returns true if a block is waiting to be written
+//****************************************************************************
+bool storage_pending(void){
+	for(uint8_t i = 0; i < STORAGE_QUEUE_SIZE; i++){
+		if(storage_queue[i].block_number != 0)
+			return true;
+	}
+	return false;
+}
+
+//****************************************************************************
+// storage_complete - frees a slot and reports the result of its write
+//****************************************************************************
+void storage_complete(storage_entry_t *entry, E_EEPROM_XMC1_OPERATION_STATUS_t status){
+	uint8_t block_number = entry->block_number;
+	entry->block_number = 0;
+	TRACE(TRACE_EEPROM_WRITE, block_number, status);
+	if(status == E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		storage_writes++;
+	else
+		storage_failures++;
+	if(storage_callback != NULL)
+		storage_callback(block_number, status);
+}
+
+//****************************************************************************
+// storage_flush - writes at most one queued block (main context, call when idle). Returns true if a write was attempted
+//****************************************************************************
+bool storage_flush(void){
+	// Garbage collection runs in steps: one bounded flash operation, more only while STORAGE_GC_BUDGET is not used up
+	if(E_EEPROM_XMC1_IsGarbageCollectionRunning()){
+		uint32_t start = SYSTIMER_GetTimeUs();
+		uint32_t deadline = start + STORAGE_GC_BUDGET;
+		do{
+			if(E_EEPROM_XMC1_StepGarbageCollection() != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS){
+				storage_gc_failures++;
+				break;
+			}
+			storage_gc_steps++;
+		}while(E_EEPROM_XMC1_IsGarbageCollectionRunning() && !timing_reached(SYSTIMER_GetTimeUs(), deadline));
+		FIELDHIST_ADD(EEPROM_BLOCKING, SYSTIMER_GetTimeUs() - start);
+
+		// Bank erased - save the wear counters with it
+		if(!E_EEPROM_XMC1_IsGarbageCollectionRunning() && E_EEPROM_XMC1_GetStatus() != E_EEPROM_XMC1_STATUS_FAILURE){
+			TRACE(TRACE_EEPROM_GC, 0, 1);
+			storage_last_erase_time = wallclock_get();
+			storage_post(EEPROM_WEAR, (const uint8_t *)E_EEPROM_XMC1_GetWearCounters(), STORAGE_WEAR_SIZE);
+		}
+		return true;
+	}
+
+	storage_entry_t *entry = NULL;
+	for(uint8_t i = 0; i < STORAGE_QUEUE_SIZE; i++){
+		uint8_t slot = storage_next + i;
+		if(slot >= STORAGE_QUEUE_SIZE)
+			slot -= STORAGE_QUEUE_SIZE;
+		if(storage_queue[slot].block_number != 0){
+			entry = &storage_queue[slot];
+			storage_next = (slot + 1U < STORAGE_QUEUE_SIZE) ? (slot + 1U) : 0U;
+			break;
+		}
+	}
+	if(entry == NULL)
+		return false;
+
+	// A write into a full bank would run the whole garbage collection inside E_EEPROM_XMC1_Write - start it in steps instead
+	if(E_EEPROM_XMC1_IsGarbageCollectionNeeded(entry->block_number)){
+		TRACE(TRACE_EEPROM_GC, entry->block_number, 0);
+		E_EEPROM_XMC1_RequestGarbageCollection();
+		storage_gc_forced++;
+		return true;
+	}
+
+	TRACE(TRACE_EEPROM_BEGIN, entry->block_number, 0);
+	uint32_t start = SYSTIMER_GetTimeUs();
+	E_EEPROM_XMC1_OPERATION_STATUS_t status = E_EEPROM_XMC1_Write(entry->block_number, entry->data);
+	FIELDHIST_ADD(EEPROM_BLOCKING, SYSTIMER_GetTimeUs() - start);
+	switch(status){
+		case E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS:
+			storage_complete(entry, status);
+			break;
+		case E_EEPROM_XMC1_OPERATION_STATUS_MEMORY_BANK_FULL:
+			// Make room, the block is written on a later pass
+			TRACE(TRACE_EEPROM_GC, entry->block_number, 0);
+			E_EEPROM_XMC1_RequestGarbageCollection();
+			storage_gc_forced++;
+			/* fall through */
+		case E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED:
+			// Flash or garbage collection busy - retry later
+			if(++entry->retries >= STORAGE_RETRY_LIMIT)
+				storage_complete(entry, status);
+			break;
+		default:
+			storage_complete(entry, status);
+			break;
+	}
+	return true;
+}
+
+//****************************************************************************
+// storage_plan_gc - starts the garbage collection if the bank is close to full (main context, quiet idle passes). Returns true if started
+//****************************************************************************
+bool storage_plan_gc(void){
+#if STORAGE_GC_PLAN
+	if(E_EEPROM_XMC1_IsGarbageCollectionRunning() || storage_pending())
+		return false;
+	if(E_EEPROM_XMC1_GetFreeBlocks() >= storage_gc_footprint * STORAGE_GC_RESERVE)
+		return false;
+	// Stepped by storage_flush like a collection started by a write
+	if(E_EEPROM_XMC1_RequestGarbageCollection() != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		return false;
+	TRACE(TRACE_EEPROM_GC, 0, 2);
+	storage_gc_planned++;
+	return true;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// storage_get_wear - returns the flash wear of the most worn bank and the projected remaining endurance
+//****************************************************************************
+void storage_get_wear(storage_wear_t *result){
+	const E_EEPROM_XMC1_WEAR_t *wear = E_EEPROM_XMC1_GetWearCounters();
+	uint8_t bank = (wear->bank_erases[1] > wear->bank_erases[0]) ? 1U : 0U;
+
+	result->erases = wear->bank_erases[bank];
+	result->remaining_erases = (result->erases < STORAGE_FLASH_ENDURANCE) ? (STORAGE_FLASH_ENDURANCE - result->erases) : 0U;
+	result->erases_since_boot = wear->bank_erases[bank] - storage_wear_boot.bank_erases[bank];
+	result->last_erase_time = storage_last_erase_time;
+
+	// remaining / (erases per us) converted to days
+	if(result->erases_since_boot == 0){
+		result->remaining_days = UINT32_MAX;
+	}else{
+		uint64_t uptime_us = (uint64_t)SYSTIMER_GetTickCount() * SYSTIMER_TICK_PERIOD_US;
+		uint64_t days = ((uint64_t)result->remaining_erases * uptime_us) / ((uint64_t)result->erases_since_boot * 86400000000ULL);
+		result->remaining_days = (days > UINT32_MAX) ? UINT32_MAX : (uint32_t)days;
+	}
+}
@@ -0,0 +1,71 @@
+/*
+ * USB-Changer storage.h
+ *
+ * Deferred settings write queue for the emulated EEPROM (E_EEPROM_XMC1). Callers post block updates and return
+ * immediately, the main loop flushes one block per idle pass (storage_flush). Repeated updates of a block that is
+ * still queued are merged, so only the latest data is written. Writes rejected while the flash or the garbage
+ * collection is busy are retried, a full bank starts the garbage collection, which is executed one bounded step per
+ * flush so it never blocks the main loop for the erase and copy of a whole bank. The result of every write is reported
+ * to the completion callback. Posts of a content the flash already holds are elided (storage_elided) without a write.
+ * The flash wear counters of E_EEPROM_XMC1 are kept across resets in block EEPROM_WEAR (saved after every garbage
+ * collection) and used to project the remaining flash endurance (storage_get_wear).
+ * Planned garbage collection (STORAGE_GC_PLAN): the largest block footprint posted since reset is the write the bank
+ * must keep room for. Once fewer than STORAGE_GC_RESERVE such writes fit into the active bank, the next quiet idle
+ * pass of the main loop (storage_plan_gc) requests the collection, which then runs in the same steps as one started
+ * by a write. A settings change of the user therefore finds room in the bank instead of waiting for a bank erase.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "E_EEPROM_XMC1/e_eeprom_xmc1.h"
+
+#define STORAGE_QUEUE_SIZE			 6							// Number of different blocks that can be queued at once
+#define STORAGE_BLOCK_SIZE_MAX		 36							// In bytes. Largest block that can be queued
+#define STORAGE_GC_BUDGET			 0							// In us. Further garbage collection steps are done in the same pass until this time is used up (0 = one step per pass)
+#define STORAGE_RETRY_LIMIT			 50							// Number of flush attempts of a block before it is dropped as failed
+#define STORAGE_WEAR_SIZE			 36							// In bytes. Size of block EEPROM_WEAR in the E_EEPROM_XMC1 configuration (must equal sizeof(E_EEPROM_XMC1_WEAR_t))
+#define STORAGE_INDEX_SIZE			 68							// In bytes. sizeof(E_EEPROM_XMC1_INDEX_t) at E_EEPROM_XMC1_MAX_BLOCK_COUNT blocks, reserved in .no_init by the linker script (eeprom_index_size)
+#define STORAGE_GC_PLAN				 0							// Determines if the garbage collection is started ahead of need in quiet periods (storage_plan_gc)
+#define STORAGE_GC_RESERVE			 2							// Number of writes of the largest block the active bank must still hold (else a quiet period collects)
+#define STORAGE_GC_QUIET_TIME		 5000						// In ms. Time without button presses and relay switches (setup menu closed) before a planned collection
+#define STORAGE_FLASH_ENDURANCE		 50000						// Guaranteed erase cycles per flash page (see data sheet of the device)
+
+typedef void (*storage_callback_t)(uint8_t block_number, E_EEPROM_XMC1_OPERATION_STATUS_t status);
+
+typedef struct {
+	uint8_t block_number;					// E_EEPROM_XMC1 block (0 = slot free)
+	uint8_t size;							// In bytes
+	uint8_t retries;						// Flush attempts that were rejected
+	uint8_t data[STORAGE_BLOCK_SIZE_MAX];
+} storage_entry_t;
+
+typedef struct {
+	uint32_t erases;				// Erases of the most worn bank (lifetime)
+	uint32_t remaining_erases;		// Erases left until STORAGE_FLASH_ENDURANCE is reached
+	uint32_t erases_since_boot;		// Erases of the most worn bank since reset (basis of the projection)
+	uint32_t remaining_days;		// Projected days until STORAGE_FLASH_ENDURANCE is reached at the erase rate since reset (UINT32_MAX = no erase yet)
+	uint32_t last_erase_time;		// Wall clock (Unix time) of the last bank erase since reset (0 = none or clock not set)
+} storage_wear_t;
+
+extern uint16_t storage_writes;		// Number of completed block writes
+extern uint16_t storage_merges;		// Number of posts merged into an already queued block
+extern uint16_t storage_elided;		// Number of posts skipped because the flash already held the content
+extern uint16_t storage_failures;	// Number of blocks dropped because writing failed
+extern uint32_t storage_gc_steps;	// Number of executed garbage collection steps
+extern uint16_t storage_gc_failures;	// Number of failed garbage collections
+extern uint16_t storage_gc_planned;	// Number of garbage collections started ahead of need (storage_plan_gc)
+extern uint16_t storage_gc_forced;	// Number of garbage collections started because a write found the bank full
+
+void storage_init(storage_callback_t callback);
+bool storage_post(uint8_t block_number, const uint8_t *data, uint8_t size);
+bool storage_pending(void);
+bool storage_flush(void);
+bool storage_plan_gc(void);
+void storage_get_wear(storage_wear_t *result);
+
+#endif /* STORAGE_H */
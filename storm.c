@@ -0,0 +1,167 @@
+/*
+ * USB-Changer storm.c
+ *
+ * Interrupt storm benchmark (see storm.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "storm.h"
+#include "profiler.h"
+#include "sensor.h"
+#include "buttons.h"
+#include "ledfade.h"
+#include "telemetry.h"
+#include "watchdog.h"
+#include "timing.h"
+#include "log.h"
+
+typedef char storm_timers_check[(STORM_TIMERS < SYSTIMER_CFG_POOL_SIZE && STORM_TEXT_SIZE <= TELEMETRY_PAYLOAD_MAX) ? 1 : -1];
+
+#if STORM_ENABLED && !BUTTONS_ERU_ENABLED
+	#error "STORM_ENABLED needs BUTTONS_ERU_ENABLED (the storm pends the button interrupt)"
+#endif
+
+storm_result_t storm_result;
+bool storm_done = false;
+
+#if STORM_ENABLED
+bool storm_active = false;
+storm_flash_t storm_flash;						// Queues one EEPROM write
+uint32_t storm_start_time;						// In us. Start of the storm
+uint32_t storm_flash_deadline;					// In us. Time of the next EEPROM write
+uint32_t storm_timer_ids[STORM_TIMERS];
+uint8_t storm_timer_count = 0;
+volatile uint32_t storm_timer_calls = 0;		// Written by the SysTick interrupt only
+uint32_t storm_own_drops = 0;					// Records of the storm that did not fit (the end of a fill)
+bool storm_led_symbol = false;
+uint16_t storm_governor_margin;					// sensor_governor_margin before the storm
+storm_result_t storm_before;					// Counters at the start (the result is their increase)
+
+
+//****************************************************************************
+// storm_timer - periodic storm timer (SysTick interrupt): pends the button interrupt like a bouncing contact
+//****************************************************************************
+void storm_timer(void *args){
+	(void)args;
+	storm_timer_calls++;
+	NVIC_SetPendingIRQ(ERU0_0_IRQn);
+}
+
+//****************************************************************************
+// storm_symbol - stream source of the status LED (period match interrupt): toggles every PWM period
+//****************************************************************************
+bool storm_symbol(void){
+	storm_led_symbol = !storm_led_symbol;
+	return storm_led_symbol;
+}
+
+//****************************************************************************
+// storm_counters - takes the counters the result is built from
+//****************************************************************************
+void storm_counters(storm_result_t *counters){
+	counters->results = sensor_result_count;
+	counters->sample_overruns = sensor_overruns;
+	counters->edges_lost = buttons_edges_lost;
+	counters->telemetry_dropped = telemetry_dropped;
+	counters->rx_bytes = telemetry_loopback_bytes;
+	counters->rx_overflows = telemetry_rx_overflows;
+	counters->loop_overruns = watchdog_stats[WATCHDOG_LOOP].overruns + watchdog_stats[WATCHDOG_UI].overruns;
+}
+
+//****************************************************************************
+// storm_stop - ends the storm, gives every source back and takes the results
+//****************************************************************************
+void storm_stop(uint32_t now){
+	for(uint8_t i = 0; i < storm_timer_count; i++)
+		SYSTIMER_DeleteTimer(storm_timer_ids[i]);
+	ledfade_stream_stop();
+	telemetry_set_loopback(false);
+	sensor_governor_margin = storm_governor_margin;
+	storm_active = false;
+
+	storm_result_t *result = &storm_result;
+	storm_counters(result);
+	result->duration = now - storm_start_time;
+	result->timers = storm_timer_count;
+	result->timer_calls = storm_timer_calls;
+	result->results -= storm_before.results;
+	result->sample_overruns = (uint16_t)(result->sample_overruns - storm_before.sample_overruns);
+	result->edges_lost = (uint16_t)(result->edges_lost - storm_before.edges_lost);
+	result->telemetry_dropped -= storm_before.telemetry_dropped + storm_own_drops;
+	result->rx_bytes -= storm_before.rx_bytes;
+	result->rx_overflows -= storm_before.rx_overflows;
+	result->loop_overruns -= storm_before.loop_overruns;
+	// Results of every sensor channel at the rate the trigger actually ran at (mHz)
+	result->results_expected = (uint32_t)(((uint64_t)sensor_get_sample_rate() * SENSOR_CHANNEL_COUNT * result->duration) / 1000000000U);
+	result->results_missed = (result->results < result->results_expected) ? result->results_expected - result->results : 0;
+	result->relay_latency_max = profiler_stats[PROFILER_RELAY_LATENCY].max;
+	result->adc_latency_max = profiler_isr_stats[PROFILER_ISR_ADC].latency_max;
+	result->loop_pass_max = profiler_stats[PROFILER_LOOP_PASS].max;
+	storm_done = true;
+
+	LOG_INFO("Storm missed %u of %u results", result->results_missed, result->results_expected);
+	LOG_INFO("Storm relay latency %u cycles, %u loop overruns", result->relay_latency_max, result->loop_overruns);
+}
+#endif
+
+//****************************************************************************
+// storm_start - starts the storm, flash queues one EEPROM write (boot, after every subsystem and watchdog_init)
+//****************************************************************************
+void storm_start(storm_flash_t flash){
+#if STORM_ENABLED
+	storm_flash = flash;
+	storm_counters(&storm_before);
+
+	// Full conversion rate throughout
+	storm_governor_margin = sensor_governor_margin;
+	sensor_governor_margin = UINT16_MAX;
+	// Full timer list: as many one tick timers as the pool has left (the rest stays for the application)
+	while(storm_timer_count < STORM_TIMERS){
+		uint32_t id = SYSTIMER_CreateTimer(SYSTIMER_TICK_PERIOD_US, SYSTIMER_MODE_PERIODIC, storm_timer, NULL);
+		if(id == 0U)
+			break;
+		if(SYSTIMER_StartTimer(id) != SYSTIMER_STATUS_SUCCESS){
+			SYSTIMER_DeleteTimer(id);
+			break;
+		}
+		storm_timer_ids[storm_timer_count++] = id;
+	}
+	ledfade_stream(storm_symbol, 1);
+	telemetry_set_loopback(true);
+
+	profiler_reset();
+	storm_start_time = SYSTIMER_GetTimeUs();
+	storm_flash_deadline = storm_start_time;
+	storm_active = true;
+#else
+	(void)flash;
+#endif
+}
+
+//****************************************************************************
+// storm_step - keeps the transmit ring full and queues the EEPROM writes, ends the storm after STORM_DURATION (every main loop pass)
+//****************************************************************************
+void storm_step(uint32_t now){
+#if STORM_ENABLED
+	if(!storm_active)
+		return;
+	if(timing_reached(now, storm_start_time + TIMING_MS_TO_US(STORM_DURATION))){
+		storm_stop(now);
+		return;
+	}
+	if(timing_reached(now, storm_flash_deadline)){
+		storm_flash_deadline = now + TIMING_MS_TO_US(STORM_FLASH_PERIOD);
+		storm_flash();
+		storm_result.flash_writes++;
+	}
+	// Fill the transmit ring up to the first record that does not fit (the application records compete for the rest)
+	static const uint8_t text[STORM_TEXT_SIZE] = "USB-Changer interrupt storm";
+	while(telemetry_send(TELEMETRY_RECORD_TEXT, text, STORM_TEXT_SIZE))
+		;
+	storm_own_drops++;
+#else
+	(void)now;
+#endif
+}
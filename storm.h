@@ -0,0 +1,62 @@
+/*
+ * USB-Changer storm.h
+ *
+ * Interrupt storm benchmark. With STORM_ENABLED storm_start is called once at boot (after all subsystems are up) and
+ * for STORM_DURATION loads every interrupt source at once at its highest rate, on top of the normal operation:
+ *   ERU		every storm timer callback pends the button interrupt (a bounce: the handler latches unchanged levels)
+ *   ADC		the governor margin is raised to the full range, so the conversions run at SENSOR_SAMPLE_RATE throughout
+ *   SysTick	the SYSTIMER pool is filled with periodic timers of one tick (full timer list, STORM_TIMERS at most)
+ *   UART		the telemetry receiver reads its own transmit pin (telemetry_set_loopback) and storm_step keeps the transmit
+ *				ring full, so the UART runs at the baud rate in both directions (the received frames are dropped in the ISR)
+ *   CCU4		the status LED is streamed with one symbol per PWM period, the period match interrupt runs at the PWM rate
+ *   Flash		the flash callback of storm_start queues an EEPROM write every STORM_FLASH_PERIOD, the bank fills up and
+ *				the garbage collection runs during the storm as well
+ * The profiler statistics are cleared at the start, so their maxima are the ones under load. The end of the storm puts
+ * the results into storm_result (relay latency, ADC interrupt latency, missed and lost samples, dropped telemetry,
+ * loop pass and watchdog overruns) and gives every source back. Two log entries carry the missed results and the
+ * relay latency to the host, the full result is read with a debugger ("storm_report" of tools/profiler_report.gdb,
+ * builds without telemetry skip the UART part). Every run wears the flash: only enable it for a measurement build.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef STORM_H
+#define STORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STORM_ENABLED				 0							// Determines if the storm runs after boot (0 removes it)
+#define STORM_DURATION				 10000						// In ms. Length of the storm
+#define STORM_FLASH_PERIOD			 100						// In ms. Period of the EEPROM writes during the storm
+#define STORM_TIMERS				 16							// Largest number of storm timers (the rest of the SYSTIMER pool is left)
+#define STORM_TEXT_SIZE				 32							// In bytes. Payload of the records that keep the transmit ring full
+
+typedef void (*storm_flash_t)(void);	// Queues one EEPROM write (main context)
+
+typedef struct {
+	uint32_t duration;					// In us. Actual length of the storm
+	uint32_t timers;					// Storm timers the SYSTIMER pool took
+	uint32_t timer_calls;				// Storm timer callbacks (pended button interrupts)
+	uint32_t results_expected;			// ADC results at the trigger rate (0 = not free running)
+	uint32_t results;					// ADC results received
+	uint32_t results_missed;			// Expected results that did not arrive
+	uint32_t sample_overruns;			// Samples lost because the ring buffer was full
+	uint32_t edges_lost;				// Button edges lost because the edge queue was full
+	uint32_t telemetry_dropped;			// Records of the application that did not fit into the transmit ring
+	uint32_t rx_bytes;					// Bytes received through the loopback
+	uint32_t rx_overflows;				// Received bytes lost because the receive ring was full
+	uint32_t flash_writes;				// EEPROM writes queued
+	uint32_t relay_latency_max;			// In cycles. Longest time from the end of a latch time to the switch (PROFILER_RELAY_LATENCY)
+	uint32_t adc_latency_max;			// In cycles. Longest ADC interrupt latency from the trigger (PROFILER_ISR_ADC)
+	uint32_t loop_pass_max;				// In cycles. Longest main loop pass (PROFILER_LOOP_PASS)
+	uint32_t loop_overruns;				// Missed deadlines of the main loop and the UI task (watchdog)
+} storm_result_t;
+
+extern storm_result_t storm_result;
+extern bool storm_done;					// Set after a complete storm
+
+void storm_start(storm_flash_t flash);
+void storm_step(uint32_t now);
+
+#endif /* STORM_H */
@@ -0,0 +1,75 @@
+/*
+ * USB-Changer supply.c
+ *
+ * Supply voltage guard for flash operations (see supply.h). The pre-warning is only latched with a timestamp in the SCU
+ * interrupt, the decision is taken in main context right before a flash operation is started.
+ * VDDPI is an SCU service request 1 event (event_masks of xmc1_scu.c: SR0 carries the flash, parity and clock loss
+ * faults, SR1 the supply, temperature, watchdog and RTC events), so the handler must be hooked to SCU_1. Served from
+ * SCU_0 the event is latched and never dispatched.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "supply.h"
+#include "timing.h"
+
+volatile uint16_t supply_warnings = 0;
+volatile bool supply_warning = false;		// A pre-warning occurred and SUPPLY_RECOVERY_TIME has not passed since
+volatile uint32_t supply_warning_time = 0;	// In us. Time of the last pre-warning
+
+
+//****************************************************************************
+// supply_warning_handler - VDDP pre-warning event (SCU interrupt context)
+//****************************************************************************
+void supply_warning_handler(void){
+	supply_warning_time = SYSTIMER_GetTime();
+	supply_warning = true;
+	supply_warnings++;
+}
+
+//****************************************************************************
+// SCU_1_IRQHandler - SCU service request 1 (dispatches to the registered event handlers: pre-warning and the RTC alarm of wallclock.c)
+//****************************************************************************
+void SCU_1_IRQHandler(void){
+	XMC_SCU_IRQHandler(1);
+}
+
+//****************************************************************************
+// supply_init - enables the VDEL detector and its pre-warning interrupt
+//****************************************************************************
+void supply_init(void){
+	const XMC_SCU_SUPPLYMONITOR_t monitor = {
+		.ext_supply_threshold = SUPPLY_WARNING_RANGE >> SCU_ANALOG_ANAVDEL_VDEL_SELECT_Pos,
+		.ext_supply_monitor_speed = XMC_SCU_POWER_MONITOR_DELAY_1US >> SCU_ANALOG_ANAVDEL_VDEL_TIM_ADJ_Pos,
+		.enable_prewarning_int = false,		// Enabled below once the handler is registered
+		.enable_vdrop_int = false,
+		.enable_vclip_int = false,
+		.enable_at_init = true
+	};
+
+	XMC_SCU_SupplyMonitorInit(&monitor);
+	XMC_SCU_INTERRUPT_ClearEventStatus(XMC_SCU_INTERRUPT_EVENT_VDDPI);
+	XMC_SCU_INTERRUPT_SetEventHandler(XMC_SCU_INTERRUPT_EVENT_VDDPI, supply_warning_handler);
+	XMC_SCU_INTERRUPT_EnableEvent(XMC_SCU_INTERRUPT_EVENT_VDDPI);
+	NVIC_SetPriority(SCU_1_IRQn, SUPPLY_IRQ_PRIORITY);
+	NVIC_EnableIRQ(SCU_1_IRQn);
+}
+
+//****************************************************************************
+// supply_flash_allowed - returns true if a flash operation may be started (no pre-warning within SUPPLY_RECOVERY_TIME)
+//****************************************************************************
+bool supply_flash_allowed(void){
+	if(!supply_warning)
+		return true;
+
+	// Check and clear with the interrupt masked, a new warning in between must not be lost
+	bool allowed = false;
+	NVIC_DisableIRQ(SCU_1_IRQn);
+	if(timing_reached(SYSTIMER_GetTime(), timing_deadline(supply_warning_time, SUPPLY_RECOVERY_TIME))){
+		supply_warning = false;
+		allowed = true;
+	}
+	NVIC_EnableIRQ(SCU_1_IRQn);
+	return allowed;
+}
@@ -0,0 +1,29 @@
+/*
+ * USB-Changer supply.h
+ *
+ * Supply voltage guard for flash operations. The VDEL detector of the XMC1100 raises a pre-warning interrupt when VDDP
+ * falls below SUPPLY_WARNING_RANGE. After such a warning no new flash operation (EEPROM block write, garbage
+ * collection step, state log entry) is started until the supply stayed above the threshold for SUPPLY_RECOVERY_TIME.
+ * So a power cut while the bulk capacitors discharge does not interrupt a write or garbage collection half way, which
+ * would make the next boot run the dirty state recovery of E_EEPROM_XMC1 (copy and erase of a bank).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SUPPLY_H
+#define SUPPLY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define SUPPLY_WARNING_RANGE		 XMC_SCU_POWER_MONITOR_RANGE_3_00V	// VDEL pre-warning threshold (VDDP is the 5V of USB behind diode D4)
+#define SUPPLY_RECOVERY_TIME		 500						// In ms. Time without pre-warning after which flash operations are allowed again
+#define SUPPLY_IRQ_PRIORITY			 IRQPRIO_SUPPLY				// Priority of the SCU SR1 interrupt (highest, the warning must be seen even while the main loop programs flash)
+
+extern volatile uint16_t supply_warnings;	// Number of pre-warnings since reset
+
+void supply_init(void);
+bool supply_flash_allowed(void);
+
+#endif /* SUPPLY_H */
@@ -0,0 +1,454 @@
+/*
+ * USB-Changer telemetry.c
+ *
+ * Binary telemetry stream (see telemetry.h). Both directions run through a software ring and the 16 word hardware
+ * FIFOs of the channel, one interrupt (SR0) serves both: the receive FIFO raises it for every byte, the transmit FIFO
+ * when it drained to half. Each ring has one producer and one consumer (main context and the interrupt) and each
+ * index is only written by one side, so no locking is needed. A send fills the transmit ring and pends the interrupt,
+ * which moves the ring into the FIFO.
+ * The baud rate generator runs from MCLK with a fixed fractional step (PDIV = 0), clockscale changes only multiply the
+ * step. A byte in transfer while MCLK changes is corrupted, the CRC and the next delimiter take care of it.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_uart.h"
+#include "telemetry.h"
+#include "clockscale.h"
+#include "relay.h"
+#include "sensor.h"
+#include "trace.h"
+#include "watchdog.h"
+#include "power.h"
+#include "profiler.h"
+#include "log.h"
+#include "wallclock.h"
+#include "ramcode.h"
+#include "metrics.h"
+#include "arena.h"
+#include "energy.h"
+#include "telesub.h"
+#include "hostbus.h"
+
+#define TELEMETRY_CHANNEL			 XMC_UART0_CH0
+#define TELEMETRY_IRQ				 USIC0_0_IRQn
+#define TELEMETRY_SR				 0U							// Service request of both FIFO events (SR0 = USIC0_0_IRQn)
+#define TELEMETRY_OVERSAMPLING		 16U
+#define TELEMETRY_FIFO_SIZE			 16U						// In words. Transmit FIFO at DPTR 0, receive FIFO behind it
+// Fractional divider step at the full clock (fFD = MCLK * step / 1024, baud = fFD / oversampling)
+#define TELEMETRY_STEP				 (((TELEMETRY_BAUDRATE * TELEMETRY_OVERSAMPLING * 1024ULL) + (SYSTIMER_SYSTICK_CLOCK / 2U)) / SYSTIMER_SYSTICK_CLOCK)
+
+typedef char telemetry_step_check[(TELEMETRY_STEP > 0 && (TELEMETRY_STEP << CLOCKSCALE_LOW_SHIFT) <= 1023U) ? 1 : -1];
+typedef char telemetry_buffer_check[((TELEMETRY_TX_BUFFER & (TELEMETRY_TX_BUFFER - 1)) == 0 && (TELEMETRY_RX_BUFFER & (TELEMETRY_RX_BUFFER - 1)) == 0
+		&& TELEMETRY_FRAME_MAX < TELEMETRY_TX_BUFFER && TELEMETRY_FRAME_MAX < 254) ? 1 : -1];
+typedef char telemetry_energy_check[(4 + ENERGY_CONSUMER_COUNT * 4 <= TELEMETRY_PAYLOAD_MAX) ? 1 : -1];
+
+ARENA(telemetry) uint8_t telemetry_tx[TELEMETRY_TX_BUFFER];
+volatile uint16_t telemetry_tx_head = 0;	// Written by main context
+volatile uint16_t telemetry_tx_tail = 0;	// Written by the interrupt
+ARENA(telemetry) uint8_t telemetry_rx[TELEMETRY_RX_BUFFER];
+volatile uint16_t telemetry_rx_head = 0;	// Written by the interrupt
+volatile uint16_t telemetry_rx_tail = 0;	// Written by main context
+uint32_t telemetry_dropped = 0;
+uint32_t telemetry_rx_overflows = 0;
+volatile bool telemetry_loopback = false;		// Receiver reads the transmit pin, received bytes are counted only
+volatile uint32_t telemetry_loopback_bytes = 0;
+METRICS_REGISTER(telemetry_dropped, METRICS_ID_TELEMETRY_DROPPED, METRICS_TYPE_U32, METRICS_UNIT_COUNT, telemetry_dropped);
+METRICS_REGISTER(telemetry_rx_overflows, METRICS_ID_TELEMETRY_RX_OVERFLOWS, METRICS_TYPE_U32, METRICS_UNIT_COUNT, telemetry_rx_overflows);
+uint16_t telemetry_sample_period = TELEMETRY_SAMPLE_PERIOD;
+bool telemetry_ready = false;
+uint8_t telemetry_sequence = 0;
+uint16_t telemetry_sample_countdown = 0;	// In ms. Time until the next sample record
+uint16_t telemetry_stats_countdown = 0;		// In ms. Time until the next statistics record
+uint8_t telemetry_trace_head = 0;			// trace_buffer.head at the last task run
+uint8_t telemetry_trace_pending = 0;		// Trace entries not sent yet (the newest ones in the trace)
+log_entry_t telemetry_log_entry;			// Log entry taken out of the log ring
+bool telemetry_log_pending = false;			// telemetry_log_entry waits for space in the transmit ring
+
+
+//****************************************************************************
+// telemetry_crc8 - CRC-8 (polynomial 0x07, initial value 0)
+//****************************************************************************
+uint8_t telemetry_crc8(uint8_t crc, uint8_t data){
+	crc ^= data;
+	for(uint8_t bit = 0; bit < 8; bit++)
+		crc = (crc & 0x80U) ? (uint8_t)((crc << 1) ^ 0x07U) : (uint8_t)(crc << 1);
+	return crc;
+}
+
+//****************************************************************************
+// telemetry_put16 / telemetry_put32 - stores a little endian field (the M0 faults on unaligned word stores)
+//****************************************************************************
+uint8_t *telemetry_put16(uint8_t *p, uint16_t value){
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	return p + 2;
+}
+uint8_t *telemetry_put32(uint8_t *p, uint32_t value){
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+	return p + 4;
+}
+
+//****************************************************************************
+// telemetry_rx_put - stores a received byte in the receive ring (interrupt)
+//****************************************************************************
+static inline void telemetry_rx_put(uint8_t data){
+	uint16_t next = (telemetry_rx_head + 1U) & (TELEMETRY_RX_BUFFER - 1U);
+	if(next == telemetry_rx_tail){
+		telemetry_rx_overflows++;
+		return;
+	}
+	telemetry_rx[telemetry_rx_head] = data;
+	telemetry_rx_head = next;
+}
+
+#if TELEMETRY_ENABLED
+//****************************************************************************
+// USIC0_0_IRQHandler - moves received bytes into the receive ring and the transmit ring into the transmit FIFO
+//****************************************************************************
+void USIC0_0_IRQHandler(void){
+	XMC_USIC_CH_RXFIFO_ClearEvent(TELEMETRY_CHANNEL, XMC_USIC_CH_RXFIFO_EVENT_STANDARD);
+	while(!XMC_USIC_CH_RXFIFO_IsEmpty(TELEMETRY_CHANNEL)){
+		uint8_t data = (uint8_t)XMC_USIC_CH_RXFIFO_GetData(TELEMETRY_CHANNEL);
+		// Own frames are not commands
+		if(telemetry_loopback){
+			telemetry_loopback_bytes++;
+			continue;
+		}
+#if HOSTBUS_ENABLED
+		// Frames for other units on the bus never reach the receive ring
+		uint8_t action = hostbus_filter(data);
+		if(action == HOSTBUS_DROP)
+			continue;
+		if(action == HOSTBUS_KEEP_HELD)
+			telemetry_rx_put(hostbus_rx_code);
+#endif
+		telemetry_rx_put(data);
+	}
+
+	XMC_USIC_CH_TXFIFO_ClearEvent(TELEMETRY_CHANNEL, XMC_USIC_CH_TXFIFO_EVENT_STANDARD);
+	uint16_t tail = telemetry_tx_tail;
+	while(tail != telemetry_tx_head && !XMC_USIC_CH_TXFIFO_IsFull(TELEMETRY_CHANNEL)){
+		XMC_USIC_CH_TXFIFO_PutData(TELEMETRY_CHANNEL, telemetry_tx[tail]);
+		tail = (tail + 1U) & (TELEMETRY_TX_BUFFER - 1U);
+	}
+	telemetry_tx_tail = tail;
+}
+#endif
+
+//****************************************************************************
+// telemetry_init - sets up the UART, its pins and the FIFOs (call after power_init)
+//****************************************************************************
+void telemetry_init(void){
+#if TELEMETRY_ENABLED
+	const XMC_UART_CH_CONFIG_t uart_config = {
+		.baudrate = TELEMETRY_BAUDRATE,
+		.data_bits = 8U,
+		.frame_length = 8U,
+		.stop_bits = 1U,
+		.oversampling = TELEMETRY_OVERSAMPLING,
+		.parity_mode = XMC_USIC_CH_PARITY_MODE_NONE
+	};
+	XMC_UART_CH_Init(TELEMETRY_CHANNEL, &uart_config);
+	// Exact step without the integer divider, so a clock change only has to shift it
+	TELEMETRY_CHANNEL->FDR = XMC_USIC_CH_BRG_CLOCK_DIVIDER_MODE_FRACTIONAL | ((uint32_t)TELEMETRY_STEP << USIC_CH_FDR_STEP_Pos);
+	TELEMETRY_CHANNEL->BRG &= ~USIC_CH_BRG_PDIV_Msk;
+	XMC_UART_CH_SetInputSource(TELEMETRY_CHANNEL, XMC_UART_CH_INPUT_RXD, USIC0_C0_DX0_P0_15);
+
+	XMC_USIC_CH_TXFIFO_Configure(TELEMETRY_CHANNEL, 0U, XMC_USIC_CH_FIFO_SIZE_16WORDS, TELEMETRY_FIFO_SIZE / 2U);
+	XMC_USIC_CH_RXFIFO_Configure(TELEMETRY_CHANNEL, TELEMETRY_FIFO_SIZE, XMC_USIC_CH_FIFO_SIZE_16WORDS, 0U);
+	XMC_USIC_CH_TXFIFO_SetInterruptNodePointer(TELEMETRY_CHANNEL, XMC_USIC_CH_TXFIFO_INTERRUPT_NODE_POINTER_STANDARD, TELEMETRY_SR);
+	XMC_USIC_CH_RXFIFO_SetInterruptNodePointer(TELEMETRY_CHANNEL, XMC_USIC_CH_RXFIFO_INTERRUPT_NODE_POINTER_STANDARD, TELEMETRY_SR);
+	XMC_USIC_CH_TXFIFO_EnableEvent(TELEMETRY_CHANNEL, XMC_USIC_CH_TXFIFO_EVENT_CONF_STANDARD);
+	XMC_USIC_CH_RXFIFO_EnableEvent(TELEMETRY_CHANNEL, XMC_USIC_CH_RXFIFO_EVENT_CONF_STANDARD);
+	XMC_UART_CH_Start(TELEMETRY_CHANNEL);
+
+	const XMC_GPIO_CONFIG_t rx_config = {.mode = XMC_GPIO_MODE_INPUT_PULL_UP, .input_hysteresis = XMC_GPIO_INPUT_HYSTERESIS_STANDARD};
+	const XMC_GPIO_CONFIG_t tx_config = {.mode = (XMC_GPIO_MODE_t)P0_14_AF_U0C0_DOUT0, .output_level = XMC_GPIO_OUTPUT_LEVEL_HIGH};
+	XMC_GPIO_Init(P0_15, &rx_config);
+	XMC_GPIO_Init(P0_14, &tx_config);
+
+	// The trace of the last run (up to the reset) is sent first
+	telemetry_trace_head = trace_buffer.head;
+	telemetry_trace_pending = trace_buffer.count;
+	telesub_init();
+	telemetry_ready = true;
+
+	NVIC_SetPriority(TELEMETRY_IRQ, TELEMETRY_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(TELEMETRY_IRQ);
+	NVIC_EnableIRQ(TELEMETRY_IRQ);
+#endif
+}
+
+//****************************************************************************
+// telemetry_set_clock_shift - keeps the baud rate when MCLK was divided by 2^shift (interrupts masked)
+//****************************************************************************
+void telemetry_set_clock_shift(uint8_t shift){
+	if(!telemetry_ready)
+		return;
+	TELEMETRY_CHANNEL->FDR = XMC_USIC_CH_BRG_CLOCK_DIVIDER_MODE_FRACTIONAL | (((uint32_t)TELEMETRY_STEP << shift) << USIC_CH_FDR_STEP_Pos);
+}
+
+//****************************************************************************
+// telemetry_set_loopback - connects the receiver to the own transmit pin (P0.14) or back to the RX pin (storm.h)
+//****************************************************************************
+void telemetry_set_loopback(bool enable){
+	if(!telemetry_ready)
+		return;
+	// The bytes of the pin in use until now are counted as loopback bytes or go to the receive ring, both harmless
+	telemetry_loopback = enable;
+	XMC_UART_CH_SetInputSource(TELEMETRY_CHANNEL, XMC_UART_CH_INPUT_RXD, enable ? USIC0_C0_DX0_P0_14 : USIC0_C0_DX0_P0_15);
+}
+
+//****************************************************************************
+// telemetry_encode - adds the CRC to a raw record (one byte of room behind it) and writes its COBS frame. Returns the frame length
+//****************************************************************************
+uint8_t telemetry_encode(uint8_t *frame, uint8_t *record, uint8_t raw_length){
+	uint8_t crc = 0;
+	for(uint8_t i = 0; i < raw_length; i++)
+		crc = telemetry_crc8(crc, record[i]);
+	record[raw_length++] = crc;
+
+	// COBS: every zero is replaced by the distance to the next one, the first code byte leads the frame (records are shorter than 254 bytes)
+	uint8_t code_index = 0;
+	uint8_t frame_length = 1;
+	for(uint8_t i = 0; i < raw_length; i++){
+		if(record[i] == 0){
+			frame[code_index] = (uint8_t)(frame_length - code_index);
+			code_index = frame_length++;
+		}
+		else
+			frame[frame_length++] = record[i];
+	}
+	frame[code_index] = (uint8_t)(frame_length - code_index);
+	frame[frame_length++] = 0;
+	return frame_length;
+}
+
+//****************************************************************************
+// telemetry_frame - writes the COBS frame of a record (payload up to TELEMETRY_PAYLOAD_MAX) into frame (TELEMETRY_FRAME_MAX bytes). Returns its length
+//****************************************************************************
+uint8_t telemetry_frame(uint8_t *frame, uint8_t type, uint8_t sequence, const uint8_t *payload, uint8_t length){
+	// Raw record
+	uint8_t record[TELEMETRY_PAYLOAD_MAX + 3];
+	uint8_t raw_length = 0;
+	record[raw_length++] = type;
+	record[raw_length++] = sequence;
+	for(uint8_t i = 0; i < length; i++)
+		record[raw_length++] = payload[i];
+	return telemetry_encode(frame, record, raw_length);
+}
+
+#if HOSTBUS_ENABLED
+//****************************************************************************
+// telemetry_frame_reply - telemetry_frame of an answer on the host bus, led by the reply address of this unit (see hostbus.h)
+//****************************************************************************
+uint8_t telemetry_frame_reply(uint8_t *frame, uint8_t type, uint8_t sequence, const uint8_t *payload, uint8_t length){
+	uint8_t record[TELEMETRY_PAYLOAD_MAX + 4];
+	uint8_t raw_length = 0;
+	record[raw_length++] = (uint8_t)(HOSTBUS_REPLY | hostbus_address);
+	record[raw_length++] = type;
+	record[raw_length++] = sequence;
+	for(uint8_t i = 0; i < length; i++)
+		record[raw_length++] = payload[i];
+	return telemetry_encode(frame, record, raw_length);
+}
+#endif
+
+//****************************************************************************
+// telemetry_send - queues one COBS framed record, returns false (and counts it) if it does not fit (main context, host bus: answers only)
+//****************************************************************************
+bool telemetry_send(uint8_t type, const uint8_t *payload, uint8_t length){
+	if(!TELEMETRY_ENABLED || !telemetry_ready || length > TELEMETRY_PAYLOAD_MAX)
+		return false;
+
+	uint8_t frame[TELEMETRY_FRAME_MAX];
+#if HOSTBUS_ENABLED
+	// The host is the only talker on the bus: nothing but the answers is sent
+	if(type != TELEMETRY_RECORD_RESPONSE)
+		return false;
+	uint8_t frame_length = telemetry_frame_reply(frame, type, telemetry_sequence, payload, length);
+#else
+	uint8_t frame_length = telemetry_frame(frame, type, telemetry_sequence, payload, length);
+#endif
+	uint16_t head = telemetry_tx_head;
+	uint16_t free = (telemetry_tx_tail - head - 1U) & (TELEMETRY_TX_BUFFER - 1U);
+	if(frame_length > free){
+		telemetry_dropped++;
+		return false;
+	}
+	for(uint8_t i = 0; i < frame_length; i++){
+		telemetry_tx[head] = frame[i];
+		head = (head + 1U) & (TELEMETRY_TX_BUFFER - 1U);
+	}
+	telemetry_tx_head = head;
+	telemetry_sequence++;
+	NVIC_SetPendingIRQ(TELEMETRY_IRQ);
+	return true;
+}
+
+//****************************************************************************
+// telemetry_read - takes up to size received bytes, returns their number (main context)
+//****************************************************************************
+uint8_t telemetry_read(uint8_t *data, uint8_t size){
+	uint8_t count = 0;
+	uint16_t tail = telemetry_rx_tail;
+	while(count < size && tail != telemetry_rx_head){
+		data[count++] = telemetry_rx[tail];
+		tail = (tail + 1U) & (TELEMETRY_RX_BUFFER - 1U);
+	}
+	telemetry_rx_tail = tail;
+	return count;
+}
+
+//****************************************************************************
+// telemetry_sent - returns true if every queued record left the UART (transmit ring, FIFO and shift register empty)
+//****************************************************************************
+bool telemetry_sent(void){
+	if(!TELEMETRY_ENABLED || !telemetry_ready)
+		return true;
+	return telemetry_tx_tail == telemetry_tx_head && XMC_USIC_CH_TXFIFO_IsEmpty(TELEMETRY_CHANNEL)
+			&& (TELEMETRY_CHANNEL->PSR_ASCMode & USIC_CH_PSR_ASCMode_BUSY_Msk) == 0U;
+}
+
+//****************************************************************************
+// telemetry_set_sample_period - changes the period of the sample records (rounded up to TELEMETRY_TASK_PERIOD, 0 = off)
+//****************************************************************************
+void telemetry_set_sample_period(uint16_t period){
+	telemetry_sample_period = period;
+	telemetry_sample_countdown = 0;
+}
+
+//****************************************************************************
+// telemetry_send_sample - sends the current value and relay state of every sensor channel
+//****************************************************************************
+void telemetry_send_sample(void){
+	uint8_t payload[4 + 3 * SENSOR_CHANNEL_COUNT];
+	uint8_t *p = telemetry_put32(payload, SYSTIMER_GetTime());
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++){
+		p = telemetry_put16(p, (uint16_t)relay_channels[i].value);
+		*p++ = (uint8_t)relay_channels[i].state;
+	}
+	telemetry_send(TELEMETRY_RECORD_SAMPLE, payload, (uint8_t)(p - payload));
+}
+
+//****************************************************************************
+// telemetry_send_stats - sends the link, sensor, loop, watchdog and sleep statistics with the wall clock time and latch times
+//****************************************************************************
+void telemetry_send_stats(void){
+	uint32_t overruns = 0;
+	for(uint8_t i = 0; i < WATCHDOG_COUNT; i++)
+		overruns += watchdog_stats[i].overruns;
+	uint32_t sleeps = 0;
+	for(uint8_t i = 0; i < POWER_STATE_COUNT; i++)
+		sleeps += power_stats[i].count;
+#if PROFILER_ENABLED
+	uint32_t loop_max = profiler_stats[PROFILER_LOOP_PASS].max;
+#else
+	uint32_t loop_max = 0;
+#endif
+
+	uint8_t payload[28 + SENSOR_CHANNEL_COUNT * 2];
+	uint8_t *p = telemetry_put32(payload, SYSTIMER_GetTime());
+	p = telemetry_put32(p, telemetry_dropped);
+	p = telemetry_put32(p, sensor_health.results_per_second);
+	p = telemetry_put32(p, loop_max);
+	p = telemetry_put32(p, overruns);
+	p = telemetry_put32(p, sleeps);
+	p = telemetry_put32(p, wallclock_get());
+	for(uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
+		p = telemetry_put16(p, (uint16_t)relay_latchtime(&relay_channels[i]));
+	telemetry_send(TELEMETRY_RECORD_STATS, payload, (uint8_t)(p - payload));
+}
+
+//****************************************************************************
+// telemetry_send_energy - sends the estimated energy per consumer (updated every ENERGY_UPDATE_PERIOD)
+//****************************************************************************
+void telemetry_send_energy(void){
+	uint8_t payload[4 + ENERGY_CONSUMER_COUNT * 4];
+	uint8_t *p = telemetry_put32(payload, SYSTIMER_GetTime());
+	for(uint8_t i = 0; i < ENERGY_CONSUMER_COUNT; i++)
+		p = telemetry_put32(p, energy_mj[i]);
+	telemetry_send(TELEMETRY_RECORD_ENERGY, payload, (uint8_t)(p - payload));
+}
+
+//****************************************************************************
+// telemetry_send_events - sends the trace entries recorded since the last run, oldest first
+//****************************************************************************
+void telemetry_send_events(void){
+	uint8_t head = trace_buffer.head;
+	uint16_t pending = telemetry_trace_pending + ((head - telemetry_trace_head) & (TRACE_ENTRIES - 1U));
+	telemetry_trace_head = head;
+	// Entries that were overwritten before they could be sent are lost
+	if(pending > trace_buffer.count){
+		telemetry_dropped += pending - trace_buffer.count;
+		pending = trace_buffer.count;
+	}
+
+	for(uint8_t sent = 0; pending > 0 && sent < TELEMETRY_EVENTS_PER_RUN; sent++){
+		const trace_entry_t *entry = &trace_buffer.entries[(head - pending) & (TRACE_ENTRIES - 1U)];
+		uint8_t payload[8];
+		uint8_t *p = telemetry_put32(payload, entry->time);
+		p = telemetry_put16(p, entry->value);
+		*p++ = entry->type;
+		*p++ = entry->arg;
+		if(!telemetry_send(TELEMETRY_RECORD_EVENT, payload, (uint8_t)(p - payload)))
+			break; // Retried on the next run
+		pending--;
+	}
+	telemetry_trace_pending = (uint8_t)pending;
+}
+
+//****************************************************************************
+// telemetry_send_log - sends the oldest log entries (an entry that does not fit is retried on the next run)
+//****************************************************************************
+void telemetry_send_log(void){
+	for(uint8_t sent = 0; sent < TELEMETRY_LOGS_PER_RUN; sent++){
+		if(!telemetry_log_pending && !log_read(&telemetry_log_entry))
+			return;
+		telemetry_log_pending = true;
+		uint8_t payload[3 + 4 * LOG_ARGS_MAX];
+		uint8_t *p = telemetry_put16(payload, telemetry_log_entry.id);
+		*p++ = telemetry_log_entry.level;
+		for(uint8_t i = 0; i < telemetry_log_entry.count; i++)
+			p = telemetry_put32(p, telemetry_log_entry.args[i]);
+		if(!telemetry_send(TELEMETRY_RECORD_LOG, payload, (uint8_t)(p - payload)))
+			return;
+		telemetry_log_pending = false;
+	}
+}
+
+//****************************************************************************
+// telemetry_task - streams the records that are due (scheduler task, TELEMETRY_TASK_PERIOD)
+//****************************************************************************
+void telemetry_task(void){
+	if(!telemetry_ready || HOSTBUS_ENABLED)
+		return;
+
+	telemetry_send_events();
+	telemetry_send_log();
+	telesub_run(TELEMETRY_TASK_PERIOD);
+
+	if(telemetry_sample_period != 0){
+		if(telemetry_sample_countdown <= TELEMETRY_TASK_PERIOD){
+			telemetry_sample_countdown = telemetry_sample_period;
+			telemetry_send_sample();
+		}
+		else
+			telemetry_sample_countdown -= TELEMETRY_TASK_PERIOD;
+	}
+
+	if(telemetry_stats_countdown <= TELEMETRY_TASK_PERIOD){
+		telemetry_stats_countdown = TELEMETRY_STATS_PERIOD;
+		telemetry_send_stats();
+#if ENERGY_ENABLED
+		telemetry_send_energy();
+#endif
+	}
+	else
+		telemetry_stats_countdown -= TELEMETRY_TASK_PERIOD;
+}
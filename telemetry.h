@@ -0,0 +1,70 @@
+/*
+ * USB-Changer telemetry.h
+ *
+ * Binary telemetry stream on a UART (USIC0 channel 0, TX P0.14, RX P0.15, 8N1). Records are COBS framed: every frame
+ * is the COBS encoding of [type][sequence][payload][CRC-8] followed by a 0x00 delimiter, so a receiver resynchronizes
+ * on the next delimiter after a lost or corrupted byte. Multi byte payload fields are little endian.
+ * telemetry_task streams the sensor values every telemetry_sample_period, the events of the trace (trace.h) and a
+ * statistics record (and the energy breakdown) every TELEMETRY_STATS_PERIOD. Sending never blocks: a record that does not fit into the transmit
+ * ring is dropped and counted in telemetry_dropped (trace events are retried until they leave the trace).
+ * On the multi-drop host bus (HOSTBUS_ENABLED, see hostbus.h) nothing is streamed: only the answers to the requests
+ * are sent, led by the reply address of the unit.
+ * P0.14/P0.15 are the SWD pins, the debugger loses the target once telemetry_init took them over. The stream is
+ * therefore off by default, a build for a board with a host link sets TELEMETRY_ENABLED (and is no longer debuggable).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define TELEMETRY_ENABLED			 0							// Determines if the UART is set up and records are streamed (0 = USIC0 stays clock gated, SWD stays usable)
+#define TELEMETRY_BAUDRATE			 115200U					// In baud
+#define TELEMETRY_TASK_PERIOD		 10							// In ms. Period of telemetry_task (scheduler task)
+#define TELEMETRY_SAMPLE_PERIOD		 100						// In ms. Default period of the sample records (multiple of TELEMETRY_TASK_PERIOD, 0 = off)
+#define TELEMETRY_STATS_PERIOD		 1000						// In ms. Period of the statistics records
+#define TELEMETRY_EVENTS_PER_RUN	 4							// Maximum number of trace events sent per task run (paces the trace of the last run after boot)
+#define TELEMETRY_LOGS_PER_RUN		 4							// Maximum number of log entries sent per task run
+#define TELEMETRY_TX_BUFFER			 256						// In bytes. Transmit ring (power of 2)
+#define TELEMETRY_RX_BUFFER			 128						// In bytes. Receive ring (power of 2, holds the bytes of one HOSTCMD_TASK_PERIOD at full rate)
+#define TELEMETRY_PAYLOAD_MAX		 64							// In bytes. Longest record payload (capture records use all of it)
+#define TELEMETRY_FRAME_MAX			 (TELEMETRY_PAYLOAD_MAX + 6)	// reply address (host bus), type, sequence, payload, CRC, COBS code byte, delimiter
+#define TELEMETRY_IRQ_PRIORITY		 IRQPRIO_TELEMETRY		// Priority of the USIC0 SR0 interrupt (lowest, the link is paced by its buffers)
+
+typedef enum {
+	TELEMETRY_RECORD_SAMPLE = 1,	// time (4), per sensor channel: value (2) and relay state (1)
+	TELEMETRY_RECORD_EVENT,			// trace entry: time (4), value (2), type (1), arg (1)
+	TELEMETRY_RECORD_STATS,			// time (4), dropped records (4), ADC results per second (4), longest loop pass in cycles (4), watchdog overruns (4), sleeps (4), wall clock (4, Unix time, 0 = not set), latch time in use per channel (2 each, in ms)
+	TELEMETRY_RECORD_RESPONSE,		// Answer to a host command (see hostcmd.h)
+	TELEMETRY_RECORD_CAPTURE,		// Delta encoded raw ADC samples (see capture.h)
+	TELEMETRY_RECORD_LOG,			// log entry: format id (2), level (1), arguments (4 each, see log.h)
+	TELEMETRY_RECORD_TEXT,			// printf output (see log.h)
+	TELEMETRY_RECORD_METRICS_LIST,	// [count][first]([id (2)][type][unit]) * n, like HOSTCMD_METRICS_LIST (optical readout, see optical.h)
+	TELEMETRY_RECORD_METRICS_VALUES,	// [count][first]([value (4)]) * n, like HOSTCMD_METRICS_READ (optical readout)
+	TELEMETRY_RECORD_ENERGY,		// time (4), estimated energy per energy_consumers (4 each, in mJ, see energy.h), with every statistics record
+	TELEMETRY_RECORD_DELTA			// time (4), ([metric id (2)][value (4)]) * n of the subscribed metrics that moved (see telesub.h)
+} telemetry_records;
+
+extern uint32_t telemetry_dropped;			// Records that did not fit into the transmit ring
+extern uint32_t telemetry_rx_overflows;		// Received bytes lost because the receive ring was full
+extern volatile uint32_t telemetry_loopback_bytes;	// Bytes received while the loopback was on
+extern uint16_t telemetry_sample_period;	// In ms. Period of the sample records (0 = off)
+
+void telemetry_init(void);
+void telemetry_task(void);
+uint8_t telemetry_frame(uint8_t *frame, uint8_t type, uint8_t sequence, const uint8_t *payload, uint8_t length);
+bool telemetry_send(uint8_t type, const uint8_t *payload, uint8_t length);
+uint8_t telemetry_crc8(uint8_t crc, uint8_t data);
+uint8_t *telemetry_put16(uint8_t *p, uint16_t value);
+uint8_t *telemetry_put32(uint8_t *p, uint32_t value);
+uint8_t telemetry_read(uint8_t *data, uint8_t size);
+bool telemetry_sent(void);
+void telemetry_set_sample_period(uint16_t period);
+void telemetry_set_clock_shift(uint8_t shift);
+void telemetry_set_loopback(bool enable);
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,136 @@
+/*
+ * USB-Changer telesub.c
+ *
+ * Change only telemetry subscriptions (see telesub.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "telesub.h"
+#include "metrics.h"
+#include "hostcmd.h"
+
+typedef char telesub_record_check[(4 + TELESUB_RECORD_ENTRIES * 6 <= TELEMETRY_PAYLOAD_MAX && TELESUB_MAX < TELESUB_FREE) ? 1 : -1];
+
+telesub_t telesub_subscriptions[TELESUB_MAX];
+
+
+//****************************************************************************
+// telesub_init - clears all subscriptions
+//****************************************************************************
+void telesub_init(void){
+	for(uint8_t i = 0; i < TELESUB_MAX; i++)
+		telesub_subscriptions[i].index = TELESUB_FREE;
+}
+
+//****************************************************************************
+// telesub_add - subscribes to a metric id or replaces its subscription. Returns a hostcmd_status
+//****************************************************************************
+uint8_t telesub_add(uint16_t id, uint8_t policy, uint16_t interval, uint32_t deadband){
+	uint8_t index = metrics_find(id);
+	if(index == METRICS_NONE)
+		return HOSTCMD_STATUS_BAD_ID;
+	if(policy >= TELESUB_POLICY_COUNT)
+		return HOSTCMD_STATUS_OUT_OF_RANGE;
+
+	// The subscription of the metric, else the first free slot
+	telesub_t *slot = NULL;
+	for(uint8_t i = 0; i < TELESUB_MAX; i++){
+		telesub_t *sub = &telesub_subscriptions[i];
+		if(sub->index == index){
+			slot = sub;
+			break;
+		}
+		if(sub->index == TELESUB_FREE && slot == NULL)
+			slot = sub;
+	}
+	if(slot == NULL)
+		return HOSTCMD_STATUS_NO_SPACE;
+
+	slot->index = index;
+	slot->policy = policy;
+	slot->interval = interval;
+	slot->deadband = deadband;
+	slot->holdoff = 0;
+	slot->sent = false;
+	return HOSTCMD_STATUS_OK;
+}
+
+//****************************************************************************
+// telesub_remove - ends the subscription of a metric id (TELESUB_ALL: all of them). Returns a hostcmd_status
+//****************************************************************************
+uint8_t telesub_remove(uint16_t id){
+	if(id == TELESUB_ALL){
+		telesub_init();
+		return HOSTCMD_STATUS_OK;
+	}
+	uint8_t index = metrics_find(id);
+	if(index == METRICS_NONE)
+		return HOSTCMD_STATUS_BAD_ID;
+	for(uint8_t i = 0; i < TELESUB_MAX; i++){
+		if(telesub_subscriptions[i].index == index){
+			telesub_subscriptions[i].index = TELESUB_FREE;
+			return HOSTCMD_STATUS_OK;
+		}
+	}
+	return HOSTCMD_STATUS_BAD_ID;
+}
+
+//****************************************************************************
+// telesub_moved - returns true if value has to be sent by the policy of a subscription
+//****************************************************************************
+bool telesub_moved(const telesub_t *sub, const metrics_entry_t *entry, uint32_t value){
+	if(!sub->sent)
+		return true;
+	if(sub->policy == TELESUB_CHANGE)
+		return value != sub->shadow;
+
+	// Magnitude of the change in the order of the type (the unsigned difference of the larger minus the smaller)
+	bool up = (entry->type == METRICS_TYPE_S32) ? (int32_t)value >= (int32_t)sub->shadow : value >= sub->shadow;
+	uint32_t change = up ? value - sub->shadow : sub->shadow - value;
+	return change > sub->deadband;
+}
+
+//****************************************************************************
+// telesub_run - sends the subscribed metrics that moved in one delta record (telemetry_task, elapsed in ms since the last run)
+//****************************************************************************
+void telesub_run(uint16_t elapsed){
+	uint8_t payload[4 + TELESUB_RECORD_ENTRIES * 6];
+	uint8_t *p = telemetry_put32(payload, SYSTIMER_GetTime());
+	uint32_t values[TELESUB_RECORD_ENTRIES];
+	uint8_t slots[TELESUB_RECORD_ENTRIES];
+	uint8_t entries = 0;
+
+	for(uint8_t i = 0; i < TELESUB_MAX; i++){
+		telesub_t *sub = &telesub_subscriptions[i];
+		if(sub->index == TELESUB_FREE)
+			continue;
+		if(sub->holdoff > elapsed){
+			sub->holdoff -= elapsed;
+			continue;
+		}
+		sub->holdoff = 0;
+		if(entries == TELESUB_RECORD_ENTRIES)
+			continue;
+
+		const metrics_entry_t *entry = metrics_get_entry(sub->index);
+		uint32_t value = metrics_value(entry);
+		if(!telesub_moved(sub, entry, value))
+			continue;
+		p = telemetry_put16(p, entry->id);
+		p = telemetry_put32(p, value);
+		values[entries] = value;
+		slots[entries++] = i;
+	}
+	if(entries == 0 || !telemetry_send(TELEMETRY_RECORD_DELTA, payload, (uint8_t)(p - payload)))
+		return;
+
+	// Queued: the sent values are the new shadows
+	for(uint8_t i = 0; i < entries; i++){
+		telesub_t *sub = &telesub_subscriptions[slots[i]];
+		sub->shadow = values[i];
+		sub->sent = true;
+		sub->holdoff = sub->interval;
+	}
+}
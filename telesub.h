@@ -0,0 +1,53 @@
+/*
+ * USB-Changer telesub.h
+ *
+ * Change only telemetry of single metrics. The host subscribes to registered metrics (metrics.h) with
+ * HOSTCMD_SUBSCRIBE, each with a policy and a shortest interval between two deltas (its maximum rate):
+ *	TELESUB_CHANGE		send when the value differs from the last sent one
+ *	TELESUB_DEADBAND	send when it moved more than the deadband away from the last sent one (signed for S32 metrics)
+ * telesub_run (every telemetry_task run) compares the subscribed metrics against their last sent shadow and packs
+ * the ones that moved into one TELEMETRY_RECORD_DELTA. A new subscription sends its value at the next run, a value that
+ * moves during the interval is sent when the interval ends. The shadows only advance when the record was queued, so a
+ * dropped record is repeated instead of losing a change. With telemetry_sample_period 0 (HOSTCMD_SETTING_SAMPLE_PERIOD)
+ * the link only carries the deltas, the events and the statistics.
+ * The subscriptions are not stored, the host subscribes again after a reset.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef TELESUB_H
+#define TELESUB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "telemetry.h"
+
+#define TELESUB_MAX					 8							// Subscriptions at the same time
+#define TELESUB_RECORD_ENTRIES		 ((TELEMETRY_PAYLOAD_MAX - 4) / 6)	// Deltas per record (the rest follows at the next run)
+#define TELESUB_FREE				 0xFFU						// Unused subscription slot
+#define TELESUB_ALL					 0xFFFFU					// HOSTCMD_UNSUBSCRIBE: every subscription
+
+typedef enum {
+	TELESUB_CHANGE,					// Any change
+	TELESUB_DEADBAND,				// Change beyond the deadband
+	TELESUB_POLICY_COUNT
+} telesub_policies;
+
+typedef struct {
+	uint8_t index;					// Metrics table index (TELESUB_FREE = unused)
+	uint8_t policy;					// telesub_policies
+	bool sent;						// shadow holds a sent value
+	uint16_t interval;				// In ms. Shortest time between two deltas
+	uint16_t holdoff;				// In ms. Time until the next delta may be sent
+	uint32_t deadband;				// TELESUB_DEADBAND: largest change that is not sent
+	uint32_t shadow;				// Last sent value
+} telesub_t;
+
+extern telesub_t telesub_subscriptions[TELESUB_MAX];
+
+void telesub_init(void);
+uint8_t telesub_add(uint16_t id, uint8_t policy, uint16_t interval, uint32_t deadband);
+uint8_t telesub_remove(uint16_t id);
+void telesub_run(uint16_t elapsed);
+
+#endif /* TELESUB_H */
@@ -0,0 +1,151 @@
+/*
+ * USB-Changer timebase.c
+ *
+ * Concatenated CCU4 microsecond time base (see timebase.h). Slice 3 counts up at each period match of slice 2, so its
+ * value only changes together with the wrap of slice 2 to 0: reading the upper slice before and after the lower one
+ * shows whether the lower one wrapped in between, it is read again then.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "timebase.h"
+#include "sensor.h"
+#include "coil.h"
+#include "funcprof.h"
+#include "freqsensor.h"
+#include "critical.h"
+#include "ramcode.h"
+
+#if TIMEBASE_ENABLED
+	#if SENSOR_FREE_RUNNING
+		#error "TIMEBASE_ENABLED moves hrtimer to CCU40 slice 1, the trigger of SENSOR_FREE_RUNNING"
+	#endif
+	#if COIL_ENABLED || FUNCPROF_ENABLED || FREQSENSOR_ENABLED
+		#error "TIMEBASE_ENABLED needs CCU40 slices 1 to 3 (COIL_ENABLED, FUNCPROF_ENABLED and FREQSENSOR_ENABLED use them)"
+	#endif
+	#ifdef SYSTIMER_TIME_WARP_ENABLED
+		#error "SYSTIMER_TIME_WARP_ENABLED only accelerates SysTick, the time base would not follow"
+	#endif
+#endif
+
+#define TIMEBASE_LOW				 CCU40_CC42					// 16 bit us counter
+#define TIMEBASE_HIGH				 CCU40_CC43					// Concatenated: counts the period matches of TIMEBASE_LOW
+#define TIMEBASE_SR					 XMC_CCU4_SLICE_SR_ID_3		// CCU40.SR3 = CCU40_3_IRQn
+#define TIMEBASE_IRQ				 CCU40_3_IRQn
+#define TIMEBASE_CLOCK				 1000000U					// In Hz. Timer clock (1 tick = 1us)
+
+volatile bool timebase_running = false;
+uint32_t timebase_last = 0;			// In us. Value of the last timebase_now64 (lower word)
+uint32_t timebase_upper = 0;		// Upper word of the 64 bit time
+uint8_t timebase_prescaler = 0;		// Prescaler giving TIMEBASE_CLOCK at the full CCU4 clock (0 = not initialized)
+
+
+//****************************************************************************
+// timebase_now - returns the time in us (any context, wraps after 71.6min)
+//****************************************************************************
+RAMCODE
+uint32_t timebase_now(void){
+	uint32_t upper = TIMEBASE_HIGH->TIMER;
+	uint32_t lower = TIMEBASE_LOW->TIMER;
+	uint32_t check = TIMEBASE_HIGH->TIMER;
+	// The lower slice wrapped between the reads, its value belongs to the second upper one
+	if(check != upper)
+		lower = TIMEBASE_LOW->TIMER;
+	return (check << 16) | lower;
+}
+
+//****************************************************************************
+// timebase_now64 - returns the time in us as 64 bit value (any context, must run at least once per 71.6min)
+//****************************************************************************
+RAMCODE
+uint64_t timebase_now64(void){
+	critical_state_t primask = critical_enter();
+	uint32_t now = timebase_now();
+	if(now < timebase_last)
+		timebase_upper++;
+	timebase_last = now;
+	uint64_t time = ((uint64_t)timebase_upper << 32) | now;
+	critical_exit(primask, CRITICAL_SITE_TIMEBASE);
+	return time;
+}
+
+#if TIMEBASE_ENABLED
+//****************************************************************************
+// CCU40_3_IRQHandler - period match of the upper slice: carries the 32 bit wrap into the upper word
+//****************************************************************************
+void CCU40_3_IRQHandler(void){
+	XMC_CCU4_SLICE_ClearEvent(TIMEBASE_HIGH, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	timebase_now64();
+}
+#endif
+
+//****************************************************************************
+// timebase_init - starts the pair at start us (CCU40 must be initialized, the module clock must be 2^n MHz, false = not enabled or possible)
+//****************************************************************************
+bool timebase_init(uint64_t start){
+#if TIMEBASE_ENABLED
+	// Prescaler that divides the module clock exactly to TIMEBASE_CLOCK
+	uint32_t prescaler = (uint32_t)XMC_CCU4_SLICE_PRESCALER_1;
+	while((GLOBAL_CCU4_0.module_frequency >> prescaler) > TIMEBASE_CLOCK && prescaler < (uint32_t)XMC_CCU4_SLICE_PRESCALER_32768)
+		prescaler++;
+	if((GLOBAL_CCU4_0.module_frequency >> prescaler) != TIMEBASE_CLOCK || (GLOBAL_CCU4_0.module_frequency & ((1UL << prescaler) - 1U)) != 0)
+		return false;
+
+	// Both edge aligned and free running over 16 bits, the upper one with the same prescaler counts the wraps of the lower
+	XMC_CCU4_SLICE_COMPARE_CONFIG_t timer_config = {
+		.timer_mode = (uint32_t)XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+		.monoshot = (uint32_t)XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+		.prescaler_initval = prescaler
+	};
+	XMC_CCU4_SLICE_CompareInit(TIMEBASE_LOW, &timer_config);
+	timer_config.timer_concatenation = 1U;
+	XMC_CCU4_SLICE_CompareInit(TIMEBASE_HIGH, &timer_config);
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(TIMEBASE_LOW, 0xFFFFU);
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(TIMEBASE_HIGH, 0xFFFFU);
+	XMC_CCU4_EnableShadowTransfer(CCU40, (uint32_t)XMC_CCU4_SHADOW_TRANSFER_SLICE_2 | (uint32_t)XMC_CCU4_SHADOW_TRANSFER_SLICE_3);
+	XMC_CCU4_SLICE_SetInterruptNode(TIMEBASE_HIGH, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, TIMEBASE_SR);
+	XMC_CCU4_SLICE_EnableEvent(TIMEBASE_HIGH, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	XMC_CCU4_EnableClock(CCU40, 2U);
+	XMC_CCU4_EnableClock(CCU40, 3U);
+	timebase_prescaler = (uint8_t)prescaler;
+
+	// Continue the SysTick time (the timers can only be written while stopped)
+	critical_state_t primask = critical_enter();
+	timebase_upper = (uint32_t)(start >> 32);
+	timebase_last = (uint32_t)start;
+	XMC_CCU4_SLICE_SetTimerValue(TIMEBASE_HIGH, (uint16_t)(timebase_last >> 16));
+	XMC_CCU4_SLICE_SetTimerValue(TIMEBASE_LOW, (uint16_t)timebase_last);
+	XMC_CCU4_SLICE_StartTimer(TIMEBASE_HIGH);
+	XMC_CCU4_SLICE_StartTimer(TIMEBASE_LOW);
+	timebase_running = true;
+	critical_exit(primask, CRITICAL_SITE_TIMEBASE);
+
+	NVIC_SetPriority(TIMEBASE_IRQ, TIMEBASE_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(TIMEBASE_IRQ);
+	NVIC_EnableIRQ(TIMEBASE_IRQ);
+	return true;
+#else
+	(void)start;
+	return false;
+#endif
+}
+
+//****************************************************************************
+// timebase_set_clock_shift - keeps the timer clock when the CCU4 clock was divided by 2^shift (interrupts masked, false = not possible)
+//****************************************************************************
+bool timebase_set_clock_shift(uint8_t shift){
+	if(timebase_prescaler == 0)
+		return true;
+	if(shift > timebase_prescaler)
+		return false;
+
+	// The prescalers can only be written with the timers stopped, the few cycles until the restart are lost
+	XMC_CCU4_SLICE_StopTimer(TIMEBASE_LOW);
+	XMC_CCU4_SLICE_StopTimer(TIMEBASE_HIGH);
+	XMC_CCU4_SLICE_SetPrescaler(TIMEBASE_LOW, (XMC_CCU4_SLICE_PRESCALER_t)(timebase_prescaler - shift));
+	XMC_CCU4_SLICE_SetPrescaler(TIMEBASE_HIGH, (XMC_CCU4_SLICE_PRESCALER_t)(timebase_prescaler - shift));
+	XMC_CCU4_SLICE_StartTimer(TIMEBASE_HIGH);
+	XMC_CCU4_SLICE_StartTimer(TIMEBASE_LOW);
+	return true;
+}
@@ -0,0 +1,37 @@
+/*
+ * USB-Changer timebase.h
+ *
+ * Interrupt free microsecond time base from two concatenated CCU40 slices. Slice 2 runs free with a 1MHz timer clock
+ * (the prescaler of hrtimer), slice 3 is concatenated to it and counts its period matches, so the pair is a 32 bit us
+ * counter that needs no interrupt per tick: timebase_now reads it with three register reads (upper, lower, upper) and
+ * no masking, the value does not depend on interrupt latency or on a SysTick that is late or tickless.
+ * A period match of slice 3 (once per 2^32us = 71.6min, CCU40.SR3) extends it to 64 bits: every timebase_now64 carries
+ * the 32 bit wrap into the upper word, the interrupt only makes sure that happens at least once per wrap, so a late
+ * interrupt costs nothing.
+ * With TIMEBASE_ENABLED SYSTIMER_GetTimeUs and SYSTIMER_GetTime64 read the pair once timebase_init started it. It
+ * starts at the SysTick time, and both count the same oscillator, so they stay together; clockscale_set stops the pair
+ * for a few cycles to change the prescalers (like hrtimer). The millisecond SYSTIMER timers stay on SysTick.
+ * hrtimer moves to slice 1 then, which needs SENSOR_FREE_RUNNING 0 (slice 1 is the sensor trigger otherwise) and
+ * COIL_ENABLED, FUNCPROF_ENABLED and FREQSENSOR_ENABLED 0 (they take slices 1 and 3).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+
+#define TIMEBASE_ENABLED			 0							// Determines if SYSTIMER_GetTimeUs reads CCU40 slices 2 and 3 (hrtimer moves to slice 1, needs SENSOR_FREE_RUNNING 0)
+#define TIMEBASE_IRQ_PRIORITY		 IRQPRIO_TIMEBASE			// Priority of the CCU40 SR3 interrupt (deferred tier, it only has to run once per 71min)
+
+extern volatile bool timebase_running;		// The pair runs, SYSTIMER reads it
+
+bool timebase_init(uint64_t start);
+uint32_t timebase_now(void);
+uint64_t timebase_now64(void);
+bool timebase_set_clock_shift(uint8_t shift);
+
+#endif /* TIMEBASE_H */
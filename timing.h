@@ -0,0 +1,44 @@
+/*
+ * USB-Changer timing.h
+ *
+ * Division free, wrap safe deadline arithmetic on the microsecond time base of SYSTIMER_GetTime (wraps after 71min).
+ * A deadline is computed once when a timed phase starts, every later check is one subtraction and a signed compare.
+ * Deadlines must be less than 2^31us (35min) ahead of the time they are checked against.
+ * Configured durations are given in ms next to their module options and converted once at compile time with
+ * TIMING_MS_TO_US (checked against TIMING_MS_MAX by the module), so the code compares native us values only.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMING_US_PER_MS			 1000U						// SYSTIMER_GetTime ticks (us) per ms
+#define TIMING_MS_MAX				 (0x7FFFFFFFU / TIMING_US_PER_MS)	// In ms. Longest duration a deadline or an elapsed time compare can span
+#define TIMING_MS_TO_US(ms)			 ((uint32_t)(ms) * TIMING_US_PER_MS)	// Compile time conversion of a constant duration
+
+//****************************************************************************
+// timing_deadline_us - returns the time (in us) that lies us microseconds after start (in us)
+//****************************************************************************
+static inline uint32_t timing_deadline_us(uint32_t start, uint32_t us){
+	return start + us;
+}
+
+//****************************************************************************
+// timing_deadline - returns the time (in us) that lies ms milliseconds after start (in us)
+//****************************************************************************
+static inline uint32_t timing_deadline(uint32_t start, uint32_t ms){
+	return start + (ms * TIMING_US_PER_MS); // The M0 multiplies in one cycle, only division is a library call
+}
+
+//****************************************************************************
+// timing_reached - returns true if now is at or after deadline (both in us)
+//****************************************************************************
+static inline bool timing_reached(uint32_t now, uint32_t deadline){
+	return (int32_t)(now - deadline) >= 0;
+}
+
+#endif /* TIMING_H */
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+#
+# USB-Changer flashcheck_patch.py
+#
+# Writes the build time CRCs of the background flash integrity check (flashcheck.h) into the linked .elf: the
+# CRC-16/CCITT of every FLASHCHECK_BLOCK bytes of the load image from UPDATER_APP_BASE up to flashcheck_table (section
+# .flashcheck), then FLASHCHECK_MAGIC. The load image is taken from the PT_LOAD segments at their load addresses, gaps
+# between them count as 0 like in the binary of objcopy -O binary. Run it after every link and before the .hex or .bin
+# is made from the .elf (the updater image is the .bin, so its CRC-32 covers the table too).
+#
+#  Created on: 2026 Oct 14
+#
+# Usage: python3 tools/flashcheck_patch.py Release/USB_Changer.elf
+
+import argparse
+import struct
+import sys
+
+UPDATER_APP_BASE = 0x10001800	# updater.h
+FLASHCHECK_BLOCK = 1024			# flashcheck.h
+FLASHCHECK_BLOCKS = 26
+FLASHCHECK_MAGIC = 0x1C4EC4ED
+CRC_INIT = 0xFFFF				# CRC-16/CCITT like settings_crc
+CRC_POLYNOMIAL = 0x1021
+PT_LOAD = 1
+
+
+def crc16(data):
+	crc = CRC_INIT
+	for byte in data:
+		crc ^= byte << 8
+		for _ in range(8):
+			crc = ((crc << 1) ^ CRC_POLYNOMIAL) if crc & 0x8000 else (crc << 1)
+			crc &= 0xFFFF
+	return crc
+
+
+def read_elf(elf):
+	if elf[:4] != b'\x7fELF' or elf[4] != 1 or elf[5] != 1:
+		sys.exit('not a 32 bit little endian ELF file')
+	(phoff, shoff) = struct.unpack_from('<II', elf, 28)
+	(phentsize, phnum, shentsize, shnum, shstrndx) = struct.unpack_from('<HHHHH', elf, 42)
+	segments = []
+	for i in range(phnum):
+		(p_type, p_offset, p_vaddr, p_paddr, p_filesz) = struct.unpack_from('<IIIII', elf, phoff + i * phentsize)
+		if p_type == PT_LOAD and p_filesz != 0:
+			segments.append((p_paddr, elf[p_offset:p_offset + p_filesz]))
+	sections = {}
+	strtab_offset = struct.unpack_from('<I', elf, shoff + shstrndx * shentsize + 16)[0]
+	for i in range(shnum):
+		(sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size) = struct.unpack_from('<IIIIII', elf, shoff + i * shentsize)
+		name = elf[strtab_offset + sh_name:elf.index(b'\0', strtab_offset + sh_name)].decode()
+		sections[name] = (sh_addr, sh_offset, sh_size)
+	return segments, sections
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Writes the flash integrity CRCs into a linked USB-Changer .elf')
+	parser.add_argument('elf', help='linked image (patched in place)')
+	args = parser.parse_args()
+
+	with open(args.elf, 'rb') as f:
+		elf = bytearray(f.read())
+	segments, sections = read_elf(elf)
+	if '.flashcheck' not in sections:
+		sys.exit('no .flashcheck section (linker script or flashcheck.c missing)')
+	(table, table_offset, table_size) = sections['.flashcheck']
+	if table_size < 4 + 2 * FLASHCHECK_BLOCKS or table < UPDATER_APP_BASE:
+		sys.exit('.flashcheck at 0x%08x (%u bytes) does not match flashcheck_table_t' % (table, table_size))
+
+	# Image from UPDATER_APP_BASE to the table as programmed
+	image = bytearray(table - UPDATER_APP_BASE)
+	for (address, data) in segments:
+		start = max(address, UPDATER_APP_BASE)
+		end = min(address + len(data), table)
+		if start < end:
+			image[start - UPDATER_APP_BASE:end - UPDATER_APP_BASE] = data[start - address:end - address]
+
+	crcs = [crc16(image[i:i + FLASHCHECK_BLOCK]) for i in range(0, len(image), FLASHCHECK_BLOCK)]
+	crcs += [0xFFFF] * (FLASHCHECK_BLOCKS - len(crcs))
+	struct.pack_into('<I%uH' % FLASHCHECK_BLOCKS, elf, table_offset, FLASHCHECK_MAGIC, *crcs)
+	with open(args.elf, 'wb') as f:
+		f.write(elf)
+	print('%s: %u bytes from 0x%08x in %u blocks, table at 0x%08x' % (args.elf, len(image), UPDATER_APP_BASE,
+			(len(image) + FLASHCHECK_BLOCK - 1) // FLASHCHECK_BLOCK, table))
+
+
+if __name__ == '__main__':
+	main()
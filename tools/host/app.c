@@ -0,0 +1,204 @@
+/*
+ * USB-Changer app.c
+ *
+ * Host copy of the application wiring of main.c (see app.h). The main loop is passed whenever an event is pending:
+ * relay latch evaluation, deferred timers (status LED), scheduler tasks and EEPROM flushes while idle. A flash
+ * operation blocks the main context for its simulated duration (sim_busy_until), samples and ticks go on meanwhile.
+ * The tasks of the default build without a host visible effect (telemetry, host commands, capture, health) are
+ * registered as empty tasks with their periods and phases, so the main loop wakes up as often as on target.
+ * A standard press of the USB button switches the USB port like manage_usb. The setup menu (manage_setup in main.c)
+ * is not part of it, presses of the other buttons are dropped.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "sim.h"
+#include "app.h"
+#include "relay.h"
+#include "buttons.h"
+#include "ledpattern.h"
+#include "ledfade.h"
+#include "scheduler.h"
+#include "storage.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "hostcmd.h"
+#include "capture.h"
+#include "recorder.h"
+
+#define APP_EVENT_TICK				 (1U << 0)					// Like EVENT_TICK of main.c
+#define APP_EVENT_TIMER				 (1U << 1)					// Like EVENT_TIMER
+#define APP_EVENT_BOUNDARY			 (1U << 2)					// Like EVENT_ADC_BOUNDARY
+#define APP_EVENT_FAULT				 (1U << 3)					// Like EVENT_SENSOR_FAULT
+
+// Relay LED patterns of main.c
+const uint8_t app_led_off[] = {LEDP_SET(0), LEDP_RETURN};
+const uint8_t app_led_on[] = {LEDP_SET(LEDFADE_LEVEL_MAX), LEDP_RETURN};
+const uint8_t app_led_fault[] = {LEDP_LOOP(LEDP_FOREVER), LEDP_SET(LEDFADE_LEVEL_MAX), LEDP_WAIT(50), LEDP_SET(0), LEDP_WAIT(50), LEDP_NEXT, LEDP_RETURN};
+
+filter_t app_filter;
+stats_t app_stats;
+uint32_t app_events = 0;
+int8_t app_ui_task_id = SCHEDULER_INVALID_TASK;
+uint32_t app_switches = 0;
+uint64_t app_passes = 0;
+USB_states app_usb_state = USB_1_active;
+uint32_t app_usb_switches = 0;
+
+
+//****************************************************************************
+// app_wakeup - scheduler callback (tick context): a task got due
+//****************************************************************************
+void app_wakeup(void){
+	app_events |= APP_EVENT_TICK;
+}
+
+//****************************************************************************
+// app_timer - deferred notification (tick context): a deferred timer expired
+//****************************************************************************
+void app_timer(void *args){
+	(void)args;
+	app_events |= APP_EVENT_TIMER;
+}
+
+//****************************************************************************
+// app_button - button interrupts recorded an edge: interpret it right away
+//****************************************************************************
+void app_button(void){
+	scheduler_trigger(app_ui_task_id);
+}
+
+//****************************************************************************
+// app_task_ui - UI task of main.c without the setup menu: buttons are debounced, the USB button switches the port
+//               (manage_usb) and the other presses are dropped
+//****************************************************************************
+void app_task_ui(void){
+	PROFILER_START(buttons_start);
+	buttons_update();
+	PROFILER_STOP(PROFILER_BUTTONS, buttons_start);
+	if(buttons_get_press(BUTTON_USB) == BTNPRESS_STD){
+		app_usb_state = usb_next_port(app_usb_state);
+		uint32_t latency = SYSTIMER_GetTimeUs() - buttons_state[BUTTON_USB].released_timestamp;
+		profiler_record(PROFILER_USB_LATENCY, latency * (SYSTIMER_SYSTICK_CLOCK / 1000000U));
+		switchUSB(app_usb_state);
+		buttons_clear_press(BUTTON_USB);
+		app_usb_switches++;
+	}
+	if(buttons_any_press())
+		buttons_clear_presses();
+}
+
+//****************************************************************************
+// app_task_idle - stands in for a task of the firmware without effect on the host (keeps the wakeups)
+//****************************************************************************
+void app_task_idle(void){
+}
+
+//****************************************************************************
+// app_init - resets the simulation and sets up the modules in the order of main.c
+//****************************************************************************
+void app_init(filter_types filter){
+	sim_init();
+	app_events = 0;
+	app_switches = 0;
+	app_passes = 0;
+	app_usb_state = USB_1_active;
+	app_usb_switches = 0;
+	SYSTIMER_SetDeferredNotify(app_timer, NULL);
+	ledfade_init();
+	ledpattern_init();
+	DIGITAL_IO_SetOutputLow(&IO_USB_OE);
+	usb_switch_init();
+	switchUSB(app_usb_state);
+	filter_init(&app_filter, filter);
+	stats_init(&app_stats);
+	relay_init(NULL);
+	// Power on: nothing recorded yet
+	recorder_buffer.magic = 0;
+	recorder_init((uint32_t)SENSOR_SAMPLE_RATE * 1000U);
+	ledpattern_set_base(app_led_off, 0);
+	app_ui_task_id = scheduler_add_task(app_task_ui, APP_UI_TASK_PERIOD, 1);
+	scheduler_add_task(app_task_idle, SENSOR_HEALTH_PERIOD, 3);
+	scheduler_add_task(app_task_idle, TELEMETRY_TASK_PERIOD, 5);
+	scheduler_add_task(app_task_idle, HOSTCMD_TASK_PERIOD, 6);
+	scheduler_add_task(app_task_idle, CAPTURE_TASK_PERIOD, 7);
+	storage_init(NULL);
+	scheduler_init(app_wakeup);
+	buttons_init(app_button);
+}
+
+//****************************************************************************
+// app_loop_pass - one pass of the main loop of main.c (if an event is pending and no flash operation blocks it)
+//****************************************************************************
+void app_loop_pass(void){
+	if(app_events == 0 || sim_time < sim_busy_until)
+		return;
+	uint32_t events = app_events;
+	app_events = 0;
+	app_passes++;
+	PROFILER_START(loop_pass_start);
+
+	relay_channel_t *channel = &relay_channels[0];
+	// The sample already drove the safe state, like the ADC interrupt
+	if(events & APP_EVENT_FAULT){
+		TRACE(TRACE_RELAY, 0, channel->state);
+		recorder_trigger(channel, channel->fault_time);
+		ledpattern_set_base((channel->fault != RELAY_FAULT_NONE) ? app_led_fault : (channel->state == RELAY_HIGH) ? app_led_on : app_led_off, 0);
+	}
+	PROFILER_START(relay_start);
+	if((events & APP_EVENT_BOUNDARY) || relay_latch_running(channel)){
+		if(relay_update(channel, channel->value, SYSTIMER_GetTime(), false)){
+			TRACE(TRACE_RELAY, 0, channel->state);
+			recorder_trigger(channel, SYSTIMER_GetTime());
+			app_switches++;
+			ledpattern_set_base((channel->state == RELAY_HIGH) ? app_led_on : app_led_off, 0);
+		}
+	}
+	PROFILER_STOP(PROFILER_RELAY, relay_start);
+
+	if(events & APP_EVENT_TIMER)
+		SYSTIMER_DispatchDeferred();
+	scheduler_run();
+	if(app_events == 0 && !relay_any_latch_running())
+		storage_flush();
+	relay_publish();
+
+	PROFILER_STOP(PROFILER_LOOP_PASS, loop_pass_start);
+}
+
+//****************************************************************************
+// app_sample - delivers one raw ADC result now (Adc_Measurement_Handler with ADC_BOUNDARY_EVENTS, recorder included) and
+//              passes the loop
+//****************************************************************************
+void app_sample(uint16_t raw){
+	relay_channel_t *channel = &relay_channels[0];
+	uint32_t time = SYSTIMER_GetTime();
+	if(relay_check_fault(channel, raw, time))
+		app_events |= APP_EVENT_FAULT;
+	recorder_push(raw, time, &app_filter, channel);
+	uint32_t value = filter_apply(&app_filter, raw);
+	channel->value = value;
+#if SENSOR_STATS
+	stats_update(&app_stats, (uint16_t)value, relay_thresholds(channel)->upper_threshold, relay_thresholds(channel)->lower_threshold);
+#endif
+	if(relay_check_thresholds(channel, value, time))
+		app_events |= APP_EVENT_BOUNDARY;
+	app_loop_pass();
+}
+
+//****************************************************************************
+// app_advance - lets the simulated time pass up to time (in us), with every main loop pass that gets due on the way
+//****************************************************************************
+void app_advance(uint64_t time){
+	for(;;){
+		// Next tick, or the end of a flash operation that holds back a pending event
+		uint64_t next = sim_next_timer();
+		if(app_events != 0 && sim_busy_until > sim_time && sim_busy_until < next)
+			next = sim_busy_until;
+		if(next > time)
+			break;
+		sim_advance(next);
+		app_loop_pass();
+	}
+	sim_advance(time);
+}
@@ -0,0 +1,30 @@
+/*
+ * USB-Changer app.h
+ *
+ * Host copy of the application wiring of main.c (see app.c): initialization, the ADC result path with
+ * ADC_BOUNDARY_EVENTS, the USB switchover by button press and the event driven main loop. Drivers (replay, benchmarks) deliver samples with app_sample
+ * and let time pass with app_advance, which runs every main loop pass that gets due on the way.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef APP_H
+#define APP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "filter.h"
+#include "usbswitch.h"
+
+#define APP_UI_TASK_PERIOD			 5							// In ms. UI_TASK_PERIOD of main.c
+
+extern uint32_t app_switches;		// Number of relay switches
+extern uint64_t app_passes;			// Number of main loop passes
+extern USB_states app_usb_state;	// Active USB port (main_state.usb_state of main.c)
+extern uint32_t app_usb_switches;	// Number of USB switchovers by button press
+
+void app_init(filter_types filter);
+void app_sample(uint16_t raw);
+void app_advance(uint64_t time);
+
+#endif /* APP_H */
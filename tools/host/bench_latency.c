@@ -0,0 +1,217 @@
+/*
+ * USB-Changer bench_latency.c
+ *
+ * Relay reaction latency benchmark on the host build (see app.h). The sensor input steps across both thresholds at a
+ * random time between two samples and the time until the relay output (IO_RELAY) switches is measured, minus the
+ * latch time. This includes the sample quantization, the filter delay, the 1ms of the latch time comparison and every
+ * delay of the main loop. The run is swept over latch times, filter settings and main loop loads:
+ *   idle		nothing but the default tasks
+ *   eeprom		a setup record with changing content is written every BENCH_EEPROM_PERIOD (flash writes and GC)
+ *   led		an endless status LED fade pattern is running
+ *   buttons	the UP button bounces with an edge every BENCH_BUTTON_PERIOD
+ * p50, p99, max and the jitter (standard deviation) of the latency are printed per combination in us.
+ *
+ * Usage: bench_latency [-n steps] [-r rate]
+ *   -n steps	Number of rising and falling input steps per combination (default BENCH_STEPS)
+ *   -r rate	predict_rate of the predictive latch (see relay.h, default RELAY_PREDICT_RATE). The latency is still
+ *				measured against the full latch time, so the time the prediction saves shows up as a negative latency
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include "sim.h"
+#include "app.h"
+#include "relay.h"
+#include "settings.h"
+#include "ledpattern.h"
+#include "ledfade.h"
+
+#define BENCH_STEPS					 50							// Default number of rising and falling steps per combination
+#define BENCH_STEPS_MAX				 1000						// Maximum number of steps per combination
+#define BENCH_SETTLE				 20							// In ms. Time the input is held after the relay switched (filter settles)
+#define BENCH_TIMEOUT				 1000						// In ms. Time after the latch time an edge counts as missed
+#define BENCH_NOISE					 64							// Peak to peak noise of the input
+#define BENCH_EEPROM_PERIOD			 50							// In ms. Period of the setup record writes of the eeprom load
+#define BENCH_BUTTON_PERIOD			 7							// In ms. Period of the UP button edges of the buttons load
+#define BENCH_MISSED				 INT64_MIN					// bench_step result of a missed edge
+
+typedef enum {BENCH_LOAD_IDLE, BENCH_LOAD_EEPROM, BENCH_LOAD_LED, BENCH_LOAD_BUTTONS, BENCH_LOAD_COUNT} bench_loads;
+
+const uint16_t bench_latchtimes[] = {0, 50, 500, 5000};
+const char *const bench_filter_names[] = {"none", "iir", "median3", "median5", "boxcar"};
+const char *const bench_load_names[BENCH_LOAD_COUNT] = {"idle", "eeprom", "led", "buttons"};
+
+// Status LED pattern of the led load
+const uint8_t bench_led_fade[] = {LEDP_LOOP(LEDP_FOREVER), LEDP_RAMP(LEDFADE_LEVEL_MAX, 300), LEDP_RAMP(0, 300), LEDP_NEXT, LEDP_RETURN};
+
+uint64_t bench_edge = 0;
+uint64_t bench_sample = 0;
+uint32_t bench_seed = 1;
+int32_t bench_predict_rate = RELAY_PREDICT_RATE;
+settings_record_t bench_record;
+int64_t bench_latencies[2 * BENCH_STEPS_MAX];
+
+
+//****************************************************************************
+// bench_random - returns a pseudo random number from 0 to range-1 (deterministic, so runs can be compared)
+//****************************************************************************
+uint32_t bench_random(uint32_t range){
+	bench_seed = bench_seed * 1103515245U + 12345U;
+	return (bench_seed >> 16) % range;
+}
+
+//****************************************************************************
+// bench_output - output hook: records the time of the relay edges
+//****************************************************************************
+void bench_output(const DIGITAL_IO_t *io, uint32_t level){
+	(void)level;
+	if(io == &IO_RELAY)
+		bench_edge = sim_time;
+}
+
+//****************************************************************************
+// bench_load - generates the main loop load at the time of a sample
+//****************************************************************************
+void bench_load(bench_loads load){
+	uint64_t ms = sim_time / 1000U;
+	uint64_t rate_ms = SENSOR_SAMPLE_RATE / 1000U;
+	if((bench_sample % rate_ms) != 0)
+		return;
+	if(load == BENCH_LOAD_EEPROM && (ms % BENCH_EEPROM_PERIOD) == 0){
+		bench_record.latchtime++;
+		settings_write(&bench_record);
+	}
+	else if(load == BENCH_LOAD_BUTTONS && (ms % BENCH_BUTTON_PERIOD) == 0)
+		sim_set_input(&IO_SW_UP, (ms / BENCH_BUTTON_PERIOD) & 1U);
+}
+
+//****************************************************************************
+// bench_run - feeds samples of level (plus noise) until time (in us) or until the relay output switched (if edge is set)
+//****************************************************************************
+void bench_run(bench_loads load, int32_t level, uint64_t time, bool edge){
+	for(;;){
+		uint64_t next = bench_sample * 1000000U / SENSOR_SAMPLE_RATE;
+		if(next >= time || (edge && bench_edge != 0))
+			return;
+		app_advance(next);
+		bench_load(load);
+		int32_t raw = level + (int32_t)bench_random(BENCH_NOISE) - (BENCH_NOISE / 2);
+		app_sample((uint16_t)((raw < 0) ? 0 : ((raw > 4095) ? 4095 : raw)));
+		bench_sample++;
+	}
+}
+
+//****************************************************************************
+// bench_step - steps the input from level from to level at a random time between two samples and returns the latency
+//              (in us, BENCH_MISSED = missed)
+//****************************************************************************
+int64_t bench_step(bench_loads load, int32_t from, int32_t level, uint16_t latchtime){
+	uint64_t period = 1000000U / SENSOR_SAMPLE_RATE;
+	uint64_t start = bench_sample * period + bench_random((uint32_t)period);
+	bench_run(load, from, start, false);
+	bench_edge = 0;
+	bench_run(load, level, start + ((uint64_t)latchtime + BENCH_TIMEOUT) * 1000U, true);
+	if(bench_edge == 0)
+		return BENCH_MISSED;
+	int64_t latency = (int64_t)(bench_edge - start) - (int64_t)latchtime * 1000;
+	bench_run(load, level, sim_time + BENCH_SETTLE * 1000U, false);
+	return latency;
+}
+
+//****************************************************************************
+// bench_compare - qsort comparison of two latencies
+//****************************************************************************
+int bench_compare(const void *a, const void *b){
+	int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+	return (x > y) - (x < y);
+}
+
+//****************************************************************************
+// bench_combination - measures one combination of latch time, filter and load and prints the statistics
+//****************************************************************************
+void bench_combination(uint16_t latchtime, filter_types filter, bench_loads load, uint32_t steps){
+	relay_channel_t *channel = &relay_channels[0];
+	channel->latchtime = latchtime;
+	channel->predict_rate = bench_predict_rate;
+	// The rate limiter would hold back the fast steps of the bench, the latency without it is measured
+	channel->min_high_time = 0;
+	channel->min_low_time = 0;
+	channel->switch_rate_max = 0;
+	app_init(filter);
+	sim_set_output_hook(bench_output);
+	bench_sample = 0;
+	bench_seed = 1;
+	bench_record = (settings_record_t){.upper_threshold = channel->upper_threshold,
+			.lower_threshold = channel->lower_threshold, .latchtime = latchtime};
+	if(load == BENCH_LOAD_LED)
+		ledpattern_push(bench_led_fade, 0);
+
+	// Levels halfway between the thresholds and the ends of the range
+	int32_t high = (channel->upper_threshold + 4095) / 2;
+	int32_t low = channel->lower_threshold / 2;
+	uint32_t count = 0, missed = 0;
+	for(uint32_t i = 0; i < steps; i++){
+		int64_t latency = bench_step(load, low, high, latchtime);
+		if(latency != BENCH_MISSED)
+			bench_latencies[count++] = latency;
+		else
+			missed++;
+		latency = bench_step(load, high, low, latchtime);
+		if(latency != BENCH_MISSED)
+			bench_latencies[count++] = latency;
+		else
+			missed++;
+	}
+	if(count == 0){
+		printf("%6u  %-8s %-8s %5u  all missed\n", latchtime, bench_filter_names[filter], bench_load_names[load], missed);
+		return;
+	}
+
+	qsort(bench_latencies, count, sizeof(bench_latencies[0]), bench_compare);
+	double mean = 0, variance = 0;
+	for(uint32_t i = 0; i < count; i++)
+		mean += (double)bench_latencies[i];
+	mean /= count;
+	for(uint32_t i = 0; i < count; i++)
+		variance += ((double)bench_latencies[i] - mean) * ((double)bench_latencies[i] - mean);
+	printf("%6u  %-8s %-8s %5u %8lld %8lld %8lld %8.1f %6u\n", latchtime, bench_filter_names[filter],
+			bench_load_names[load], count, (long long)bench_latencies[count / 2],
+			(long long)bench_latencies[(count * 99U) / 100U], (long long)bench_latencies[count - 1],
+			sqrt(variance / count), missed);
+}
+
+//****************************************************************************
+// main - sweeps all combinations of latch time, filter and load
+//****************************************************************************
+int main(int argc, char **argv){
+	uint32_t steps = BENCH_STEPS;
+	int option;
+	while((option = getopt(argc, argv, "n:r:")) != -1){
+		switch(option){
+			case 'n': steps = (uint32_t)atoi(optarg); break;
+			case 'r': bench_predict_rate = atoi(optarg); break;
+			default:
+				fprintf(stderr, "usage: %s [-n steps] [-r rate]\n", argv[0]);
+				return 2;
+		}
+	}
+	if(steps == 0 || steps > BENCH_STEPS_MAX){
+		fprintf(stderr, "%s: steps must be 1 to %u\n", argv[0], BENCH_STEPS_MAX);
+		return 2;
+	}
+
+	uint64_t start = sim_host_ns();
+	printf(" latch  filter   load         n  p50 us   p99 us   max us  jitter missed\n");
+	for(uint8_t l = 0; l < sizeof(bench_latchtimes) / sizeof(bench_latchtimes[0]); l++){
+		for(uint8_t f = FILTER_NONE; f <= FILTER_BOXCAR; f++){
+			for(uint8_t load = 0; load < BENCH_LOAD_COUNT; load++)
+				bench_combination(bench_latchtimes[l], (filter_types)f, (bench_loads)load, steps);
+		}
+	}
+	printf("host %.3f s\n", (sim_host_ns() - start) / 1e9);
+	return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * USB-Changer bench_usb.c
+ *
+ * USB switchover benchmark and regression gate on the host build (see app.h). The USB button is pressed for a random
+ * standard press duration and released at a random time between two sample ticks. The pin changes of the switchover
+ * that follows (switchUSB) are recorded with their time and the number of the port write they belong to, and checked:
+ *   latency	time from the release to the new port being powered (p50, p99, max in us)
+ *   writes		number of port writes from the first to the last pin change of a switchover (max)
+ *   order		old power off in an earlier write than new power on, mux and indicators in between (violations)
+ *   overlap	both ports powered at the same time (count)
+ *   missed		releases without a switchover within BENCH_TIMEOUT
+ * Every value is compared against the limit of a baseline file (lines "name limit", # starts a comment) and the run
+ * fails if any value is above its limit, so switchover timing does not regress unnoticed. The spacing of the port
+ * writes in CPU cycles is only measured on target (profiler section PROFILER_USB_WRITES).
+ *
+ * Usage: bench_usb [-n presses] [-b baseline | -w]
+ *   -n presses		Number of switchovers (default BENCH_PRESSES)
+ *   -b baseline	Compares against the baseline file, exit code 1 if a limit is exceeded
+ *   -w				Prints the measured values in baseline file format (to record a new baseline), the latencies with
+ *					BENCH_LATENCY_MARGIN added, so a baseline does not fail on the run it was recorded from
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#include "app.h"
+#include "buttons.h"
+#include "sensor.h"
+
+#define BENCH_PRESSES				 200						// Default number of switchovers
+#define BENCH_PRESSES_MAX			 2000						// Maximum number of switchovers
+#define BENCH_HOLD_MIN				 (BTN_STD_PRESS_DURATION + 10)	// In ms. Shortest press (a standard press)
+#define BENCH_HOLD_MAX				 (BTN_LONG_PRESS_DURATION - 10)	// In ms. Longest press (still a standard press)
+#define BENCH_TIMEOUT				 100						// In ms. Time after the release a switchover counts as missed
+#define BENCH_PAUSE					 200						// In ms. Time between the timeout and the next press
+#define BENCH_LATENCY_MARGIN		 20							// In %. Added to the measured latencies by -w (the release time is random, a sample tick moves p50 and p99)
+
+typedef enum {BENCH_LATENCY_P50, BENCH_LATENCY_P99, BENCH_LATENCY_MAX, BENCH_WRITES, BENCH_ORDER, BENCH_OVERLAP,
+	BENCH_MISSED, BENCH_VALUE_COUNT} bench_values;
+
+const char *const bench_value_names[BENCH_VALUE_COUNT] = {
+	"latency_p50", "latency_p99", "latency_max", "writes", "order", "overlap", "missed"
+};
+
+// Pin changes of the running switchover (in us and the number of the port write, 0 = none)
+uint64_t bench_break_time, bench_make_time;
+uint32_t bench_first_write, bench_break_write, bench_switch_write, bench_make_write;
+const DIGITAL_IO_t *bench_old_power;
+const DIGITAL_IO_t *bench_new_power;
+uint32_t bench_overlaps = 0;
+uint32_t bench_seed = 1;
+int64_t bench_latencies[BENCH_PRESSES_MAX];
+
+
+//****************************************************************************
+// bench_random - returns a pseudo random number from 0 to range-1 (deterministic, so runs can be compared)
+//****************************************************************************
+uint32_t bench_random(uint32_t range){
+	bench_seed = bench_seed * 1103515245U + 12345U;
+	return (bench_seed >> 16) % range;
+}
+
+//****************************************************************************
+// bench_output - output hook: records the pin changes of a switchover
+//****************************************************************************
+void bench_output(const DIGITAL_IO_t *io, uint32_t level){
+	uint32_t write = sim_port_writes;
+	if(io != &IO_USB_SI && io != &IO_LED_USB1 && io != &IO_LED_USB2 && io != &IO_USBPWR_1 && io != &IO_USBPWR_2)
+		return;
+	if(bench_first_write == 0)
+		bench_first_write = write;
+	if(io == bench_old_power && level == 0){
+		bench_break_write = write;
+		bench_break_time = sim_time;
+	}
+	else if(io == bench_new_power && level != 0){
+		bench_make_write = write;
+		bench_make_time = sim_time;
+	}
+	else if(io == &IO_USB_SI && bench_switch_write == 0)
+		bench_switch_write = write;
+	if(sim_get_output(&IO_USBPWR_1) && sim_get_output(&IO_USBPWR_2))
+		bench_overlaps++;
+}
+
+//****************************************************************************
+// bench_compare - qsort comparison of two latencies
+//****************************************************************************
+int bench_compare(const void *a, const void *b){
+	int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+	return (x > y) - (x < y);
+}
+
+//****************************************************************************
+// bench_measure - runs the switchovers and fills values (bench_values). Returns false if there is no switchover at all
+//****************************************************************************
+bool bench_measure(uint32_t presses, int64_t *values){
+	app_init(SENSOR_FILTER);
+	sim_set_output_hook(bench_output);
+	bench_seed = 1;
+	bench_overlaps = 0;
+	memset(values, 0, BENCH_VALUE_COUNT * sizeof(values[0]));
+
+	uint32_t count = 0;
+	uint64_t time = BENCH_PAUSE * 1000U;
+	for(uint32_t i = 0; i < presses; i++){
+		// Press at a random time, release after a standard press duration at a random time between two sample ticks
+		bool to_usb2 = (app_usb_state == USB_1_active);
+		bench_old_power = to_usb2 ? &IO_USBPWR_1 : &IO_USBPWR_2;
+		bench_new_power = to_usb2 ? &IO_USBPWR_2 : &IO_USBPWR_1;
+		time += bench_random(1000U * BUTTONS_SAMPLE_PERIOD);
+		app_advance(time);
+		sim_set_input(&IO_SW_USB, 0);
+		time += (BENCH_HOLD_MIN + bench_random(BENCH_HOLD_MAX - BENCH_HOLD_MIN)) * 1000U + bench_random(1000U);
+		app_advance(time);
+		bench_first_write = bench_break_write = bench_switch_write = bench_make_write = 0;
+		sim_set_input(&IO_SW_USB, 1);
+		uint64_t release = time;
+		time += BENCH_TIMEOUT * 1000U;
+		app_advance(time);
+		time += BENCH_PAUSE * 1000U;
+
+		if(bench_make_write == 0){
+			values[BENCH_MISSED]++;
+			continue;
+		}
+		bench_latencies[count++] = (int64_t)(bench_make_time - release);
+		if(bench_make_write - bench_first_write + 1U > values[BENCH_WRITES])
+			values[BENCH_WRITES] = bench_make_write - bench_first_write + 1U;
+		if(bench_break_write == 0 || bench_break_write >= bench_make_write || bench_break_time > bench_make_time
+				|| bench_switch_write < bench_break_write || bench_switch_write > bench_make_write)
+			values[BENCH_ORDER]++;
+	}
+	values[BENCH_OVERLAP] = bench_overlaps;
+	if(count == 0)
+		return false;
+
+	qsort(bench_latencies, count, sizeof(bench_latencies[0]), bench_compare);
+	values[BENCH_LATENCY_P50] = bench_latencies[count / 2];
+	values[BENCH_LATENCY_P99] = bench_latencies[(count * 99U) / 100U];
+	values[BENCH_LATENCY_MAX] = bench_latencies[count - 1];
+	return true;
+}
+
+//****************************************************************************
+// bench_read_baseline - reads the limits of a baseline file (values without a line keep -1 = not checked)
+//****************************************************************************
+bool bench_read_baseline(const char *path, int64_t *limits){
+	FILE *file = fopen(path, "r");
+	if(file == NULL){
+		perror(path);
+		return false;
+	}
+	for(uint8_t i = 0; i < BENCH_VALUE_COUNT; i++)
+		limits[i] = -1;
+	char line[128];
+	while(fgets(line, sizeof(line), file) != NULL){
+		char name[64];
+		long long limit;
+		if(line[0] == '#' || sscanf(line, "%63s %lld", name, &limit) != 2)
+			continue;
+		uint8_t i;
+		for(i = 0; i < BENCH_VALUE_COUNT; i++){
+			if(strcmp(name, bench_value_names[i]) == 0){
+				limits[i] = limit;
+				break;
+			}
+		}
+		if(i == BENCH_VALUE_COUNT)
+			fprintf(stderr, "%s: unknown value %s\n", path, name);
+	}
+	fclose(file);
+	return true;
+}
+
+//****************************************************************************
+// main - measures the switchovers and prints them, compared against a baseline or as a new baseline
+//****************************************************************************
+int main(int argc, char **argv){
+	uint32_t presses = BENCH_PRESSES;
+	const char *baseline = NULL;
+	bool write = false;
+	int option;
+	while((option = getopt(argc, argv, "n:b:w")) != -1){
+		switch(option){
+			case 'n': presses = (uint32_t)atoi(optarg); break;
+			case 'b': baseline = optarg; break;
+			case 'w': write = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-n presses] [-b baseline | -w]\n", argv[0]);
+				return 2;
+		}
+	}
+	if(presses == 0 || presses > BENCH_PRESSES_MAX){
+		fprintf(stderr, "%s: presses must be 1 to %u\n", argv[0], BENCH_PRESSES_MAX);
+		return 2;
+	}
+	int64_t limits[BENCH_VALUE_COUNT];
+	if(baseline != NULL && !bench_read_baseline(baseline, limits))
+		return 2;
+
+	int64_t values[BENCH_VALUE_COUNT];
+	if(!bench_measure(presses, values)){
+		fprintf(stderr, "%s: no switchover\n", argv[0]);
+		return 1;
+	}
+
+	if(write){
+		printf("# USB switchover baseline (bench_usb -n %u), latencies in us with %u%% margin, counts exact\n", presses, BENCH_LATENCY_MARGIN);
+		for(uint8_t i = 0; i < BENCH_VALUE_COUNT; i++){
+			int64_t limit = values[i];
+			if(i <= BENCH_LATENCY_MAX)
+				limit += (limit * BENCH_LATENCY_MARGIN + 99) / 100;
+			printf("%s %lld\n", bench_value_names[i], (long long)limit);
+		}
+		return 0;
+	}
+	bool failed = false;
+	printf("value          measured    limit\n");
+	for(uint8_t i = 0; i < BENCH_VALUE_COUNT; i++){
+		if(baseline == NULL || limits[i] < 0){
+			printf("%-12s %10lld\n", bench_value_names[i], (long long)values[i]);
+			continue;
+		}
+		bool pass = values[i] <= limits[i];
+		failed |= !pass;
+		printf("%-12s %10lld %8lld  %s\n", bench_value_names[i], (long long)values[i], (long long)limits[i],
+				pass ? "pass" : "FAIL");
+	}
+	if(baseline != NULL)
+		printf("%s\n", failed ? "FAIL" : "PASS");
+	return failed ? 1 : 0;
+}
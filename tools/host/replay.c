@@ -0,0 +1,183 @@
+/*
+ * USB-Changer replay.c
+ *
+ * Host replay of sensor input through the application logic (see sim.h and app.h). Raw ADC results are fed at
+ * SENSOR_SAMPLE_RATE through the path of Adc_Measurement_Handler with ADC_BOUNDARY_EVENTS (filter, statistics,
+ * threshold check) and the main loop of app.c is passed whenever an event is pending, like main.c does.
+ *
+ * Besides the relay switches the most switches within one second (chatter) and the EEPROM block writes (write storms)
+ * are printed. With a stimulus scenario the crossings of its clean signal (without noise and spikes) are counted with
+ * the hysteresis of the thresholds too: fewer switches than crossings are missed transitions, more are chatter.
+ *
+ * Usage: replay [-u upper] [-l lower] [-t latchtime] [-a area] [-k leak] [-f filter] [-w dump] [-s seconds] [-g scenario | file]
+ *   file		Raw ADC results (0-4095) one per line, e.g. a capture or SPI stream dump ("-" = stdin)
+ *   -s seconds	Synthetic input instead: a noisy signal that crosses both thresholds about once per second
+ *   -g scenario	Stimulus scenario instead (ramp, noise, spikes, chatter, stuck or soak, see stimulus.h), for -s seconds
+ *				(default REPLAY_STIMULUS_SECONDS)
+ *   -a area		latch_area in ADC values * ms: area latch instead of the latch time (see relay.h, default RELAY_LATCH_AREA)
+ *   -k leak		area_leak in ADC values (default RELAY_AREA_LEAK)
+ *   -f filter	filter_types, see filter.h (default SENSOR_FILTER)
+ *   -w dump		Writes recorder_buffer (the windows around the last relay switches, see recorder.h) to the file dump,
+ *				in the format of a target dump for tracereplay
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#include "app.h"
+#include "relay.h"
+#include "storage.h"
+#include "stimulus.h"
+#include "recorder.h"
+
+#define REPLAY_SYNTHETIC_PERIOD		 2000						// In ms. Period of the synthetic signal (high and low half)
+#define REPLAY_SYNTHETIC_NOISE		 256						// Peak to peak noise of the synthetic signal
+#define REPLAY_STIMULUS_SECONDS		 60							// Default duration of a stimulus scenario
+
+const char *const replay_scenario_names[STIMULUS_SCENARIO_COUNT] = {"ramp", "noise", "spikes", "chatter", "stuck", "soak"};
+
+uint32_t replay_seed = 1;
+
+
+//****************************************************************************
+// replay_synthetic - returns the next sample of the synthetic signal (square wave between the thresholds plus noise)
+//****************************************************************************
+uint16_t replay_synthetic(uint64_t sample, uint32_t rate){
+	const relay_channel_t *channel = &relay_channels[0];
+	uint64_t half = (uint64_t)rate * REPLAY_SYNTHETIC_PERIOD / 2000U;
+	int32_t level = ((sample / half) & 1U) ? (channel->lower_threshold / 2) : ((channel->upper_threshold + 4095) / 2);
+	replay_seed = replay_seed * 1103515245U + 12345U;
+	level += (int32_t)((replay_seed >> 16) % REPLAY_SYNTHETIC_NOISE) - (REPLAY_SYNTHETIC_NOISE / 2);
+	if(level < 0)
+		level = 0;
+	if(level > 4095)
+		level = 4095;
+	return (uint16_t)level;
+}
+
+//****************************************************************************
+// main - sets up the modules like main.c, replays the input and prints the results
+//****************************************************************************
+int main(int argc, char **argv){
+	relay_channel_t *channel = &relay_channels[0];
+	filter_types filter = SENSOR_FILTER;
+	uint64_t synthetic = 0;
+	int scenario = -1;
+	const char *dump = NULL;
+	int option;
+	while((option = getopt(argc, argv, "u:l:t:a:k:f:s:g:w:")) != -1){
+		switch(option){
+			case 'u': channel->upper_threshold = atoi(optarg); break;
+			case 'l': channel->lower_threshold = atoi(optarg); break;
+			case 't': channel->latchtime = atoi(optarg); break;
+			case 'a': channel->latch_area = (uint32_t)strtoul(optarg, NULL, 10); break;
+			case 'k': channel->area_leak = (uint16_t)atoi(optarg); break;
+			case 'f': filter = (filter_types)atoi(optarg); break;
+			case 's': synthetic = strtoull(optarg, NULL, 10); break;
+			case 'w': dump = optarg; break;
+			case 'g':
+				for(scenario = STIMULUS_SCENARIO_COUNT - 1; scenario >= 0; scenario--){
+					if(strcmp(optarg, replay_scenario_names[scenario]) == 0)
+						break;
+				}
+				if(scenario < 0){
+					fprintf(stderr, "%s: unknown scenario %s\n", argv[0], optarg);
+					return 2;
+				}
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-u upper] [-l lower] [-t latchtime] [-a area] [-k leak] [-f filter] [-w dump] [-s seconds] [-g scenario | file]\n", argv[0]);
+				return 2;
+		}
+	}
+	if(scenario >= 0 && synthetic == 0)
+		synthetic = REPLAY_STIMULUS_SECONDS;
+	FILE *input = NULL;
+	if(synthetic == 0){
+		if(optind >= argc){
+			fprintf(stderr, "%s: no input (file or -s seconds)\n", argv[0]);
+			return 2;
+		}
+		input = (argv[optind][0] == '-' && argv[optind][1] == '\0') ? stdin : fopen(argv[optind], "r");
+		if(input == NULL){
+			perror(argv[optind]);
+			return 1;
+		}
+	}
+
+	app_init(filter);
+
+	// Samples at the sample rate, the SysTick work in between
+	const uint32_t rate = SENSOR_SAMPLE_RATE;
+	stimulus_t generator;
+	if(scenario >= 0){
+		stimulus_config_t config;
+		stimulus_scenario(&config, (stimulus_scenarios)scenario, channel->upper_threshold, channel->lower_threshold, rate);
+		stimulus_init(&generator, &config, 1);
+	}
+	bool clean_high = false;
+	uint32_t crossings = 0, second_switches = 0, max_switches = 0;
+	uint64_t samples = 0;
+	uint64_t start = sim_host_ns();
+	for(;;){
+		uint16_t raw;
+		if(synthetic != 0){
+			if(samples >= synthetic * rate)
+				break;
+			if(scenario >= 0){
+				raw = stimulus_next(&generator);
+				// Hysteresis on the clean signal: the switches the input intended
+				if(clean_high ? (generator.clean < channel->lower_threshold) : (generator.clean > channel->upper_threshold)){
+					clean_high = !clean_high;
+					crossings++;
+				}
+			}
+			else
+				raw = replay_synthetic(samples, rate);
+		}
+		else{
+			unsigned int value;
+			if(fscanf(input, "%u", &value) != 1)
+				break;
+			raw = (uint16_t)((value > 4095U) ? 4095U : value);
+		}
+		app_advance(samples * 1000000U / rate);
+		app_sample(raw);
+		samples++;
+		if(samples % rate == 0){
+			if(app_switches - second_switches > max_switches)
+				max_switches = app_switches - second_switches;
+			second_switches = app_switches;
+		}
+	}
+	uint64_t elapsed = sim_host_ns() - start;
+	if(input != NULL && input != stdin)
+		fclose(input);
+
+	double simulated = (double)sim_time / 1e6;
+	printf("samples %llu, simulated %.3f s, host %.3f s (%.0fx real time, %.1f ns per sample)\n",
+			(unsigned long long)samples, simulated, elapsed / 1e9, (elapsed != 0) ? simulated * 1e9 / elapsed : 0.0,
+			(samples != 0) ? (double)elapsed / samples : 0.0);
+	printf("relay switches %u, main loop passes %llu, state %s\n", app_switches, (unsigned long long)app_passes,
+			(channel->state == RELAY_HIGH) ? "high" : "low");
+	printf("most relay switches in one second %u, EEPROM block writes %u\n", max_switches, storage_writes);
+	if(scenario >= 0)
+		printf("stimulus %s: clean crossings %u, spikes %u, chatter bursts %u%s\n", replay_scenario_names[scenario],
+				crossings, generator.spikes, generator.bursts, generator.stuck ? ", stuck" : "");
+	sim_report();
+
+	if(dump != NULL){
+		FILE *output = fopen(dump, "wb");
+		if(output == NULL || fwrite(&recorder_buffer, sizeof(recorder_buffer), 1, output) != 1){
+			perror(dump);
+			return 1;
+		}
+		fclose(output);
+		printf("recorder windows written to %s (last sequence %u)\n", dump, recorder_buffer.sequence);
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * USB-Changer host shim DAVE.h
+ *
+ * The DAVE APPs used by the application logic, implemented by the simulation (tools/host/sim.c) instead of the
+ * generated drivers. SYSTIMER runs on the simulated clock with the tick period and timer count of the DAVE
+ * configuration, its timers expire on tick boundaries like on target. PWM_CCU4 and ADC_MEASUREMENT are kept at the
+ * APP level: the duty cycle is only stored and a started conversion is delivered to the sample source of the simulation.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef DAVE_H
+#define DAVE_H
+
+#include "xmc_common.h"
+#include "DIGITAL_IO/digital_io.h"
+#include "E_EEPROM_XMC1/e_eeprom_xmc1.h"
+
+/// SYSTIMER (configuration of Dave/Generated/SYSTIMER/systimer_conf.h)
+#define SYSTIMER_TICK_PERIOD_US		 (1000U)
+#define SYSTIMER_CFG_MAX_TMR		 (8U)
+#define SYSTIMER_SYSTICK_CLOCK		 (32000000U)
+#define SYSTIMER_DEFERRED_ENABLED
+
+typedef enum {SYSTIMER_STATUS_SUCCESS = 0U, SYSTIMER_STATUS_FAILURE} SYSTIMER_STATUS_t;
+typedef enum {SYSTIMER_MODE_ONE_SHOT = 0U, SYSTIMER_MODE_PERIODIC} SYSTIMER_MODE_t;
+typedef void (*SYSTIMER_CALLBACK_t)(void *args);
+
+uint32_t SYSTIMER_CreateTimer(uint32_t period, SYSTIMER_MODE_t mode, SYSTIMER_CALLBACK_t callback, void *args);
+SYSTIMER_STATUS_t SYSTIMER_StartTimer(uint32_t id);
+SYSTIMER_STATUS_t SYSTIMER_StopTimer(uint32_t id);
+SYSTIMER_STATUS_t SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec);
+SYSTIMER_STATUS_t SYSTIMER_SetDeferred(uint32_t id, bool deferred);
+void SYSTIMER_SetDeferredNotify(SYSTIMER_CALLBACK_t notify, void *args);
+uint32_t SYSTIMER_DispatchDeferred(void);
+uint32_t SYSTIMER_GetTime(void);
+uint32_t SYSTIMER_GetTimeUs(void);
+uint32_t SYSTIMER_GetTickCount(void);
+uint32_t SYSTIMER_GetCycles(void);
+
+#define SYSTIMER_StartTimerFromISR(id)				SYSTIMER_StartTimer(id)
+#define SYSTIMER_StopTimerFromISR(id)				SYSTIMER_StopTimer(id)
+#define SYSTIMER_RestartTimerFromISR(id, microsec)	SYSTIMER_RestartTimer((id), (microsec))
+
+/// PWM_CCU4
+#define PWM_CCU4_SYM_DUTY_MIN		 (0U)
+#define PWM_CCU4_SYM_DUTY_MAX		 (10000U)
+
+typedef struct {
+	uint32_t duty;					// In 0.01%. Last duty cycle set
+} PWM_CCU4_t;
+
+extern PWM_CCU4_t PWM_CCU4_LED_STATUS;
+
+static inline void PWM_CCU4_SetDutyCycle(PWM_CCU4_t *const handle, uint32_t duty){ handle->duty = duty; }
+
+/// ADC_MEASUREMENT
+typedef struct {
+	uint32_t conversions;			// Number of started conversions
+} ADC_MEASUREMENT_t;
+
+extern ADC_MEASUREMENT_t ADC_SENSOR;
+
+void ADC_MEASUREMENT_StartConversion(ADC_MEASUREMENT_t *const handle);
+
+#endif /* DAVE_H */
@@ -0,0 +1,60 @@
+/*
+ * USB-Changer host shim DIGITAL_IO/digital_io.h
+ *
+ * DIGITAL_IO on simulated ports. Each port has the register layout of the XMC1100 up to Pn_IN and is 0x100 bytes long,
+ * so pins.h takes snapshots exactly like on target. Outputs are written through Pn_OMR semantics and reported to the
+ * output hook of the simulation (sim_set_output_hook), inputs are driven by sim_set_input. Direct Pn_OMR writes of the
+ * firmware are only seen where a module routes them through a macro (USB_SWITCH_PORT_WRITE).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef DIGITAL_IO_H
+#define DIGITAL_IO_H
+
+#include "xmc_common.h"
+
+typedef struct {
+	__IO uint32_t OUT;				// 0x00 Pn_OUT
+	__O uint32_t OMR;				// 0x04 Pn_OMR (not used by the shim, see sim_write_omr)
+	uint32_t RESERVED0[7];
+	__IO uint32_t IN;				// 0x24 Pn_IN (written by the simulation)
+	uint32_t RESERVED1[54];
+} XMC_GPIO_PORT_t;					// 0x100 bytes like the port register blocks of the device
+
+extern XMC_GPIO_PORT_t sim_ports[3];
+
+#define XMC_GPIO_PORT0				 (&sim_ports[0])
+#define XMC_GPIO_PORT1				 (&sim_ports[1])
+#define XMC_GPIO_PORT2				 (&sim_ports[2])
+#define PORT0_BASE					 ((uint32_t)(uintptr_t)XMC_GPIO_PORT0)
+
+typedef struct {
+	XMC_GPIO_PORT_t *const gpio_port;
+	const uint8_t gpio_pin;
+} DIGITAL_IO_t;
+
+extern const DIGITAL_IO_t IO_USB_SI;
+extern const DIGITAL_IO_t IO_USB_OE;
+extern const DIGITAL_IO_t IO_LED_R_STATUS;
+extern const DIGITAL_IO_t IO_SW_USB;
+extern const DIGITAL_IO_t IO_SW_UP;
+extern const DIGITAL_IO_t IO_SW_DOWN;
+extern const DIGITAL_IO_t IO_USBPWR_2;
+extern const DIGITAL_IO_t IO_USBPWR_1;
+extern const DIGITAL_IO_t IO_RELAY;
+extern const DIGITAL_IO_t IO_LED_USB2;
+extern const DIGITAL_IO_t IO_LED_USB1;
+
+void sim_write_output(const DIGITAL_IO_t *io, uint32_t level);
+void sim_write_omr(XMC_GPIO_PORT_t *port, uint32_t omr);
+
+// Pn_OMR writes of usbswitch.c go to the simulation, so every pin change is reported to the output hook
+#define USB_SWITCH_PORT_WRITE(port, omr)	sim_write_omr((port), (omr))
+
+static inline void DIGITAL_IO_SetOutputHigh(const DIGITAL_IO_t *const handler){ sim_write_output(handler, 1U); }
+static inline void DIGITAL_IO_SetOutputLow(const DIGITAL_IO_t *const handler){ sim_write_output(handler, 0U); }
+static inline void DIGITAL_IO_ToggleOutput(const DIGITAL_IO_t *const handler){ sim_write_output(handler, ((handler->gpio_port->OUT >> handler->gpio_pin) & 1U) ^ 1U); }
+static inline uint32_t DIGITAL_IO_GetInput(const DIGITAL_IO_t *const handler){ return (handler->gpio_port->IN >> handler->gpio_pin) & 1U; }
+
+#endif /* DIGITAL_IO_H */
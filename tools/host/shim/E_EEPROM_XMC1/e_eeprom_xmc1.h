@@ -0,0 +1,73 @@
+/*
+ * USB-Changer host shim E_EEPROM_XMC1/e_eeprom_xmc1.h
+ *
+ * E_EEPROM_XMC1 in RAM (see tools/host/sim.c). Blocks and sizes are those of the DAVE configuration. Every write appends
+ * the block (data plus one header flash block) to the active bank, a bank without room for a write needs a garbage
+ * collection: E_EEPROM_XMC1_StepGarbageCollection copies the latest blocks with its first step and erases one page of
+ * the old bank with each of the following ones, like the stepped collection of the target.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef E_EEPROM_XMC1_H
+#define E_EEPROM_XMC1_H
+
+#include "xmc_common.h"
+
+#define E_EEPROM_XMC1_FLASH_BLOCK_SIZE  (16U)
+#define E_EEPROM_XMC1_FLASH_PAGE_SIZE   (256U)
+#define E_EEPROM_XMC1_FLASH_BANK_SIZE   (768U)
+#define E_EEPROM_XMC1_BANK_PAGES        (3U)
+#define E_EEPROM_XMC1_MAX_BLOCK_COUNT   (6U)
+#define E_EEPROM_XMC1_HISTORY_DEPTH     (2U)
+
+#define EEPROM_SETTINGS                 (1U)
+#define EEPROM_CALIBRATION              (2U)
+#define EEPROM_WEAR                     (3U)
+#define EEPROM_RELAY_LIFE               (4U)
+#define EEPROM_PROFILES                 (5U)
+#define EEPROM_RELAY_POSITION           (6U)
+
+typedef enum {
+	E_EEPROM_XMC1_STATUS_SUCCESS = 0U,
+	E_EEPROM_XMC1_STATUS_FAILURE = 1U,
+	E_EEPROM_XMC1_STATUS_UNINITIALIZED = 2U,
+	E_EEPROM_XMC1_STATUS_IDLE = 3U,
+	E_EEPROM_XMC1_STATUS_BUSY = 4U
+} E_EEPROM_XMC1_STATUS_t;
+
+typedef enum {
+	E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS = 0U,
+	E_EEPROM_XMC1_OPERATION_STATUS_FAILURE = 1U,
+	E_EEPROM_XMC1_OPERATION_STATUS_INCONSISTENT_BLOCK = 2U,
+	E_EEPROM_XMC1_OPERATION_STATUS_INVALID_BLOCK = 3U,
+	E_EEPROM_XMC1_OPERATION_STATUS_CRC_FAILED = 4U,
+	E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED = 5U,
+	E_EEPROM_XMC1_OPERATION_STATUS_MEMORY_BANK_FULL = 6U,
+	E_EEPROM_XMC1_OPERATION_STATUS_NO_CRC_WRITTEN = 7U
+} E_EEPROM_XMC1_OPERATION_STATUS_t;
+
+typedef struct {
+	uint32_t block_writes[E_EEPROM_XMC1_MAX_BLOCK_COUNT];
+	uint32_t gc_runs;
+	uint32_t bank_erases[2];
+} E_EEPROM_XMC1_WEAR_t;
+
+E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(void *const handle_ptr);
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Write(uint8_t block_number, uint8_t *data_buffer_ptr);
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Read(uint8_t block_number, uint32_t block_offset, uint8_t *data_buffer_ptr, uint32_t length);
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StartGarbageCollection(void);
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_RequestGarbageCollection(void);
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StepGarbageCollection(void);
+bool E_EEPROM_XMC1_IsGarbageCollectionRunning(void);
+bool E_EEPROM_XMC1_IsGarbageCollectionNeeded(uint8_t block_number);
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetDataPointer(uint8_t block_number, uint32_t offset, const uint8_t **const data_pptr, uint32_t *const length_ptr);
+const E_EEPROM_XMC1_WEAR_t *E_EEPROM_XMC1_GetWearCounters(void);
+void E_EEPROM_XMC1_SetWearCounters(const E_EEPROM_XMC1_WEAR_t *const counters);
+uint32_t E_EEPROM_XMC1_GetFreeBlocks(void);
+uint32_t E_EEPROM_XMC1_GetBlockFootprint(uint8_t block_number);
+uint32_t E_EEPROM_XMC1_GetHistoryCount(uint8_t block_number);
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetHistoryPointer(uint8_t block_number, uint32_t age, uint32_t offset, const uint8_t **const data_pptr, uint32_t *const length_ptr);
+E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_GetStatus(void);
+
+#endif /* E_EEPROM_XMC1_H */
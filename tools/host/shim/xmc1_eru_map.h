@@ -0,0 +1,15 @@
+/*
+ * USB-Changer host shim xmc1_eru_map.h
+ *
+ * ERU input selections used by buttons.c (values are not evaluated, see xmc_eru.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef XMC1_ERU_MAP_H
+#define XMC1_ERU_MAP_H
+
+#define ERU0_ETL3_INPUTA_P2_7		 0U
+#define ERU0_ETL3_INPUTB_P2_9		 1U
+
+#endif /* XMC1_ERU_MAP_H */
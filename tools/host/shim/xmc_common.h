@@ -0,0 +1,42 @@
+/*
+ * USB-Changer host shim xmc_common.h
+ *
+ * Core intrinsics of the host build (see tools/host/sim.h). Interrupts are simulated by direct calls from the simulation,
+ * so masking them is only book-kept in PRIMASK and nothing is placed in SRAM.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef XMC_COMMON_H
+#define XMC_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define __RAM_FUNC
+#define __I							volatile const
+#define __O							volatile
+#define __IO						volatile
+
+typedef enum {
+	ERU0_0_IRQn,
+	CCU40_0_IRQn,
+	CCU40_1_IRQn,
+	USIC0_0_IRQn
+} IRQn_Type;
+
+extern uint32_t sim_primask;
+
+static inline void __disable_irq(void){ sim_primask = 1U; }
+static inline void __enable_irq(void){ sim_primask = 0U; }
+static inline uint32_t __get_PRIMASK(void){ return sim_primask; }
+static inline void __set_PRIMASK(uint32_t primask){ sim_primask = primask; }
+static inline void __NOP(void){}
+static inline void __WFI(void){}
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority){ (void)irq; (void)priority; }
+static inline void NVIC_EnableIRQ(IRQn_Type irq){ (void)irq; }
+static inline void NVIC_DisableIRQ(IRQn_Type irq){ (void)irq; }
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq){ (void)irq; }
+
+#endif /* XMC_COMMON_H */
@@ -0,0 +1,47 @@
+/*
+ * USB-Changer host shim xmc_eru.h
+ *
+ * ERU configuration types for buttons.c. The simulation raises ERU0_0_IRQHandler on every level change of an ERU button
+ * pin (the re-armed ETL of buttons.c fires on any change), so the configuration itself is not evaluated.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef XMC_ERU_H
+#define XMC_ERU_H
+
+#include "xmc_common.h"
+
+#define XMC_ERU0					 ((void *)0)
+
+typedef enum {
+	XMC_ERU_ETL_SOURCE_A_AND_B,
+	XMC_ERU_ETL_SOURCE_A_AND_NOT_B,
+	XMC_ERU_ETL_SOURCE_NOT_A_AND_B,
+	XMC_ERU_ETL_SOURCE_NOT_A_AND_NOT_B
+} XMC_ERU_ETL_SOURCE_t;
+
+typedef enum {XMC_ERU_ETL_EDGE_DETECTION_FALLING} XMC_ERU_ETL_EDGE_DETECTION_t;
+typedef enum {XMC_ERU_ETL_STATUS_FLAG_MODE_HWCTRL} XMC_ERU_ETL_STATUS_FLAG_MODE_t;
+typedef enum {XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL0} XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL_t;
+typedef enum {XMC_ERU_OGU_SERVICE_REQUEST_ON_TRIGGER} XMC_ERU_OGU_SERVICE_REQUEST_t;
+
+typedef struct {
+	uint32_t input_a;
+	uint32_t input_b;
+	uint32_t enable_output_trigger;
+	XMC_ERU_ETL_STATUS_FLAG_MODE_t status_flag_mode;
+	XMC_ERU_ETL_EDGE_DETECTION_t edge_detection;
+	XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL_t output_trigger_channel;
+	XMC_ERU_ETL_SOURCE_t source;
+} XMC_ERU_ETL_CONFIG_t;
+
+typedef struct {
+	XMC_ERU_OGU_SERVICE_REQUEST_t service_request;
+} XMC_ERU_OGU_CONFIG_t;
+
+static inline void XMC_ERU_ETL_Init(void *eru, uint8_t channel, const XMC_ERU_ETL_CONFIG_t *config){ (void)eru; (void)channel; (void)config; }
+static inline void XMC_ERU_OGU_Init(void *eru, uint8_t channel, const XMC_ERU_OGU_CONFIG_t *config){ (void)eru; (void)channel; (void)config; }
+static inline void XMC_ERU_ETL_SetSource(void *eru, uint8_t channel, XMC_ERU_ETL_SOURCE_t source){ (void)eru; (void)channel; (void)source; }
+
+#endif /* XMC_ERU_H */
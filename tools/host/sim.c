@@ -0,0 +1,713 @@
+/*
+ * USB-Changer sim.c
+ *
+ * Simulation core of the host build (see sim.h). SYSTIMER keeps its timers in a plain table and counts whole ticks
+ * like the SysTick driver: a timer started for n us expires at the n-th tick boundary from now (rounded up, at least
+ * one). ledfade is reduced to its level and ramp end time, which is all ledpattern.c looks at.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "buttons.h"
+#include "ledfade.h"
+#include "trace.h"
+#include "calib.h"
+#include "settings.h"
+#include "storage.h"
+#include "wallclock.h"
+#include "relaylife.h"
+#include "coil.h"
+
+#define SIM_DEFERRED_QUEUE_SIZE		 64							// Like SYSTIMER_DEFERRED_QUEUE_SIZE
+#define SIM_NONE					 UINT64_MAX					// No timer running
+#define SIM_EEPROM_BANK_BLOCKS		 (E_EEPROM_XMC1_FLASH_BANK_SIZE / E_EEPROM_XMC1_FLASH_BLOCK_SIZE)
+#define SIM_FLASH_PROGRAM_US		 102						// In us. Programming time of one flash block (approx. data sheet value)
+#define SIM_FLASH_ERASE_US			 6800						// In us. Erase time of one flash page (approx. data sheet value)
+
+typedef struct {
+	SYSTIMER_CALLBACK_t callback;
+	void *args;
+	uint32_t period;				// In ticks
+	SYSTIMER_MODE_t mode;
+	bool deferred;					// Callback is queued for SYSTIMER_DispatchDeferred instead of run in tick context
+	uint64_t deadline;				// In us. Tick boundary the timer expires at (SIM_NONE = stopped)
+} sim_timer_t;
+
+typedef struct {
+	uint8_t size;					// In bytes (DAVE configuration)
+	bool valid;						// Block was written
+	uint8_t data[STORAGE_BLOCK_SIZE_MAX];
+	uint8_t history_count;			// Previous contents kept (cleared by the garbage collection)
+	uint8_t history[E_EEPROM_XMC1_HISTORY_DEPTH][STORAGE_BLOCK_SIZE_MAX];	// Previous contents, newest first
+} sim_eeprom_block_t;
+
+// Simulated hardware
+uint64_t sim_time = 0;
+uint64_t sim_busy_until = 0;
+uint32_t sim_primask = 0;
+XMC_GPIO_PORT_t sim_ports[3];
+sim_output_hook_t sim_output_hook = NULL;
+sim_adc_source_t sim_adc_source = NULL;
+PWM_CCU4_t PWM_CCU4_LED_STATUS;
+ADC_MEASUREMENT_t ADC_SENSOR;
+
+// Pins of Dave/Generated/DIGITAL_IO/digital_io_conf.c
+const DIGITAL_IO_t IO_USB_SI = {XMC_GPIO_PORT2, 0U};
+const DIGITAL_IO_t IO_USB_OE = {XMC_GPIO_PORT0, 9U};
+const DIGITAL_IO_t IO_LED_R_STATUS = {XMC_GPIO_PORT0, 6U};
+const DIGITAL_IO_t IO_SW_USB = {XMC_GPIO_PORT0, 8U};
+const DIGITAL_IO_t IO_SW_UP = {XMC_GPIO_PORT2, 7U};
+const DIGITAL_IO_t IO_SW_DOWN = {XMC_GPIO_PORT2, 9U};
+const DIGITAL_IO_t IO_USBPWR_2 = {XMC_GPIO_PORT0, 5U};
+const DIGITAL_IO_t IO_USBPWR_1 = {XMC_GPIO_PORT2, 10U};
+const DIGITAL_IO_t IO_RELAY = {XMC_GPIO_PORT0, 7U};
+const DIGITAL_IO_t IO_LED_USB2 = {XMC_GPIO_PORT0, 0U};
+const DIGITAL_IO_t IO_LED_USB1 = {XMC_GPIO_PORT2, 11U};
+const DIGITAL_IO_t *const sim_outputs[] = {
+	&IO_USB_SI, &IO_USB_OE, &IO_LED_R_STATUS, &IO_USBPWR_2, &IO_USBPWR_1, &IO_RELAY, &IO_LED_USB2, &IO_LED_USB1
+};
+
+// SYSTIMER
+sim_timer_t sim_timers[SYSTIMER_CFG_MAX_TMR];
+uint32_t sim_timer_count = 0;
+sim_timer_t *sim_deferred_queue[SIM_DEFERRED_QUEUE_SIZE];
+uint8_t sim_deferred_head = 0;
+uint8_t sim_deferred_tail = 0;
+SYSTIMER_CALLBACK_t sim_deferred_notify = NULL;
+void *sim_deferred_notify_args = NULL;
+
+// ledfade
+uint8_t sim_led_level = 0;			// Level at the start of the ramp (or the set level)
+uint8_t sim_led_target = 0;
+uint64_t sim_led_ramp_start = 0;	// In us
+uint64_t sim_led_ramp_end = 0;		// In us (0 = no ramp)
+
+// E_EEPROM_XMC1 (index is the block number - 1)
+sim_eeprom_block_t sim_eeprom[E_EEPROM_XMC1_MAX_BLOCK_COUNT] = {
+	{.size = SETTINGS_RECORD_SIZE}, {.size = CALIB_STORAGE_SIZE}, {.size = STORAGE_WEAR_SIZE}, {.size = RELAYLIFE_STORAGE_SIZE}
+};
+E_EEPROM_XMC1_WEAR_t sim_eeprom_wear;
+uint32_t sim_eeprom_used = 0;		// Flash blocks used in the active bank
+uint8_t sim_eeprom_bank = 0;		// Active bank
+uint8_t sim_eeprom_gc_step = 0;		// Next garbage collection step (0 = not running, 1 = copy, 2... = erase page of the old bank)
+
+// Trace and profiler
+trace_buffer_t trace_buffer;
+uint32_t sim_trace_counts[SIM_TRACE_TYPES];
+uint32_t sim_port_writes = 0;
+sim_stat_t sim_profiler[PROFILER_SECTION_COUNT];
+
+const char *const sim_profiler_names[PROFILER_SECTION_COUNT] = {
+	"loop period", "loop pass", "status led", "buttons", "relay", "setup", "relay latency", "usb latency", "usb writes"
+};
+
+
+//****************************************************************************
+// sim_host_ns - returns the host monotonic time in ns
+//****************************************************************************
+uint64_t sim_host_ns(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+//****************************************************************************
+// sim_init - resets the simulated hardware (buttons released, outputs low, EEPROM empty)
+//****************************************************************************
+void sim_init(void){
+	sim_time = 0;
+	sim_busy_until = 0;
+	memset(sim_ports, 0, sizeof(sim_ports));
+	sim_port_writes = 0;
+	// Buttons are active low with pull up
+	sim_ports[0].IN = 1U << IO_SW_USB.gpio_pin;
+	sim_ports[2].IN = (1U << IO_SW_UP.gpio_pin) | (1U << IO_SW_DOWN.gpio_pin);
+	sim_timer_count = 0;
+	sim_deferred_head = sim_deferred_tail = 0;
+	sim_led_level = sim_led_target = 0;
+	sim_led_ramp_end = 0;
+	for(uint8_t i = 0; i < E_EEPROM_XMC1_MAX_BLOCK_COUNT; i++){
+		sim_eeprom[i].valid = false;
+		sim_eeprom[i].history_count = 0;
+	}
+	memset(&sim_eeprom_wear, 0, sizeof(sim_eeprom_wear));
+	sim_eeprom_used = 0;
+	sim_eeprom_gc_step = 0;
+	memset(&trace_buffer, 0, sizeof(trace_buffer));
+	trace_buffer.magic = TRACE_MAGIC;
+	memset(sim_trace_counts, 0, sizeof(sim_trace_counts));
+	memset(sim_profiler, 0, sizeof(sim_profiler));
+}
+
+//****************************************************************************
+// sim_next_timer - returns the time (in us) the next SYSTIMER timer expires (UINT64_MAX = none running)
+//****************************************************************************
+uint64_t sim_next_timer(void){
+	uint64_t next = SIM_NONE;
+	for(uint32_t i = 0; i < sim_timer_count; i++){
+		if(sim_timers[i].deadline < next)
+			next = sim_timers[i].deadline;
+	}
+	return next;
+}
+
+//****************************************************************************
+// sim_advance - lets the simulated time pass up to time (in us), expiring all timers that get due on the way
+//****************************************************************************
+void sim_advance(uint64_t time){
+	uint64_t next;
+	while((next = sim_next_timer()) <= time){
+		sim_time = next;
+		// One tick: every timer due at it, in table order (callbacks may restart or stop timers)
+		for(uint32_t i = 0; i < sim_timer_count; i++){
+			sim_timer_t *timer = &sim_timers[i];
+			if(timer->deadline != next)
+				continue;
+			timer->deadline = (timer->mode == SYSTIMER_MODE_PERIODIC) ? next + (uint64_t)timer->period * SYSTIMER_TICK_PERIOD_US : SIM_NONE;
+			if(!timer->deferred)
+				timer->callback(timer->args);
+			else if((uint8_t)(sim_deferred_head - sim_deferred_tail) < SIM_DEFERRED_QUEUE_SIZE){
+				sim_deferred_queue[sim_deferred_head++ & (SIM_DEFERRED_QUEUE_SIZE - 1U)] = timer;
+				if(sim_deferred_notify != NULL)
+					sim_deferred_notify(sim_deferred_notify_args);
+			}
+		}
+	}
+	if(time > sim_time)
+		sim_time = time;
+}
+
+//****************************************************************************
+// sim_write_output - drives an output pin (DIGITAL_IO_SetOutputHigh/Low), reports changes to the output hook
+//****************************************************************************
+void sim_write_output(const DIGITAL_IO_t *io, uint32_t level){
+	uint32_t mask = 1U << io->gpio_pin;
+	uint32_t old = io->gpio_port->OUT;
+	io->gpio_port->OUT = level ? (old | mask) : (old & ~mask);
+	io->gpio_port->IN = level ? (io->gpio_port->IN | mask) : (io->gpio_port->IN & ~mask);
+	if(((old & mask) != 0) != (level != 0) && sim_output_hook != NULL)
+		sim_output_hook(io, level);
+}
+
+//****************************************************************************
+// sim_write_omr - Pn_OMR write: sets the pins of the lower and resets the pins of the upper half word (both = toggle)
+//****************************************************************************
+void sim_write_omr(XMC_GPIO_PORT_t *port, uint32_t omr){
+	sim_port_writes++;
+	for(uint8_t i = 0; i < sizeof(sim_outputs) / sizeof(sim_outputs[0]); i++){
+		const DIGITAL_IO_t *io = sim_outputs[i];
+		if(io->gpio_port != port)
+			continue;
+		uint32_t set = (omr >> io->gpio_pin) & 1U;
+		uint32_t reset = (omr >> (io->gpio_pin + 16U)) & 1U;
+		if(set && reset)
+			sim_write_output(io, sim_get_output(io) ^ 1U);
+		else if(set || reset)
+			sim_write_output(io, set);
+	}
+}
+
+//****************************************************************************
+// sim_get_output - returns the level an output pin is driven to
+//****************************************************************************
+uint32_t sim_get_output(const DIGITAL_IO_t *io){
+	return (io->gpio_port->OUT >> io->gpio_pin) & 1U;
+}
+
+//****************************************************************************
+// sim_set_output_hook - registers the function called whenever an output pin changes (NULL = none)
+//****************************************************************************
+void sim_set_output_hook(sim_output_hook_t hook){
+	sim_output_hook = hook;
+}
+
+//****************************************************************************
+// sim_set_input - drives an input pin, a change of an ERU button pin runs the ERU interrupt of buttons.c
+//****************************************************************************
+void sim_set_input(const DIGITAL_IO_t *io, uint32_t level){
+	uint32_t mask = 1U << io->gpio_pin;
+	uint32_t old = io->gpio_port->IN;
+	io->gpio_port->IN = level ? (old | mask) : (old & ~mask);
+#if BUTTONS_ERU_ENABLED
+	if(io->gpio_port->IN != old && (io == &IO_SW_UP || io == &IO_SW_DOWN))
+		ERU0_0_IRQHandler();
+#endif
+}
+
+//****************************************************************************
+// sim_set_adc_source - registers the function that delivers the result of a started conversion (NULL = none)
+//****************************************************************************
+void sim_set_adc_source(sim_adc_source_t source){
+	sim_adc_source = source;
+}
+
+//****************************************************************************
+// sim_get_led_level - returns the current level of the status LED (ramps interpolated)
+//****************************************************************************
+uint8_t sim_get_led_level(void){
+	if(sim_led_ramp_end == 0 || sim_time >= sim_led_ramp_end)
+		return sim_led_target;
+	int32_t span = (int32_t)sim_led_target - (int32_t)sim_led_level;
+	return (uint8_t)(sim_led_level + span * (int64_t)(sim_time - sim_led_ramp_start) / (int64_t)(sim_led_ramp_end - sim_led_ramp_start));
+}
+
+//****************************************************************************
+// sim_report - prints the profiler sections and trace events recorded so far
+//****************************************************************************
+void sim_report(void){
+	printf("%-12s %10s %10s %10s\n", "section", "count", "mean ns", "max ns");
+	for(uint8_t i = 0; i < PROFILER_SECTION_COUNT; i++){
+		const sim_stat_t *stat = &sim_profiler[i];
+		if(stat->count == 0)
+			continue;
+		printf("%-12s %10u %10llu %10u\n", sim_profiler_names[i], stat->count, (unsigned long long)(stat->total / stat->count), stat->max);
+	}
+	printf("trace events:");
+	for(uint8_t i = 0; i < SIM_TRACE_TYPES; i++){
+		if(sim_trace_counts[i] != 0)
+			printf(" %u:%u", i, sim_trace_counts[i]);
+	}
+	printf("\n");
+}
+
+
+/// SYSTIMER
+
+//****************************************************************************
+// SYSTIMER_CreateTimer - creates a stopped timer, returns its id (0 = no timer left)
+//****************************************************************************
+uint32_t SYSTIMER_CreateTimer(uint32_t period, SYSTIMER_MODE_t mode, SYSTIMER_CALLBACK_t callback, void *args){
+	if(callback == NULL || period < SYSTIMER_TICK_PERIOD_US || sim_timer_count >= SYSTIMER_CFG_MAX_TMR)
+		return 0;
+	sim_timer_t *timer = &sim_timers[sim_timer_count];
+	timer->callback = callback;
+	timer->args = args;
+	timer->period = period / SYSTIMER_TICK_PERIOD_US;
+	timer->mode = mode;
+	timer->deferred = false;
+	timer->deadline = SIM_NONE;
+	return ++sim_timer_count;
+}
+
+//****************************************************************************
+// SYSTIMER_StartTimer - starts a timer with its period
+//****************************************************************************
+SYSTIMER_STATUS_t SYSTIMER_StartTimer(uint32_t id){
+	if(id == 0 || id > sim_timer_count)
+		return SYSTIMER_STATUS_FAILURE;
+	sim_timer_t *timer = &sim_timers[id - 1U];
+	timer->deadline = (sim_time / SYSTIMER_TICK_PERIOD_US + timer->period) * SYSTIMER_TICK_PERIOD_US;
+	return SYSTIMER_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// SYSTIMER_StopTimer - stops a timer
+//****************************************************************************
+SYSTIMER_STATUS_t SYSTIMER_StopTimer(uint32_t id){
+	if(id == 0 || id > sim_timer_count)
+		return SYSTIMER_STATUS_FAILURE;
+	sim_timers[id - 1U].deadline = SIM_NONE;
+	return SYSTIMER_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// SYSTIMER_RestartTimer - restarts a timer with a new period (in us, rounded up to whole ticks)
+//****************************************************************************
+SYSTIMER_STATUS_t SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec){
+	if(id == 0 || id > sim_timer_count || microsec == 0)
+		return SYSTIMER_STATUS_FAILURE;
+	sim_timers[id - 1U].period = (microsec + SYSTIMER_TICK_PERIOD_US - 1U) / SYSTIMER_TICK_PERIOD_US;
+	return SYSTIMER_StartTimer(id);
+}
+
+//****************************************************************************
+// SYSTIMER_SetDeferred - determines if the callback of a timer runs in SYSTIMER_DispatchDeferred
+//****************************************************************************
+SYSTIMER_STATUS_t SYSTIMER_SetDeferred(uint32_t id, bool deferred){
+	if(id == 0 || id > sim_timer_count)
+		return SYSTIMER_STATUS_FAILURE;
+	sim_timers[id - 1U].deferred = deferred;
+	return SYSTIMER_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// SYSTIMER_SetDeferredNotify - registers the function called (tick context) when a deferred callback got queued
+//****************************************************************************
+void SYSTIMER_SetDeferredNotify(SYSTIMER_CALLBACK_t notify, void *args){
+	sim_deferred_notify = notify;
+	sim_deferred_notify_args = args;
+}
+
+//****************************************************************************
+// SYSTIMER_DispatchDeferred - runs all queued deferred callbacks (main context), returns their number
+//****************************************************************************
+uint32_t SYSTIMER_DispatchDeferred(void){
+	uint32_t count = 0;
+	while(sim_deferred_tail != sim_deferred_head){
+		sim_timer_t *timer = sim_deferred_queue[sim_deferred_tail++ & (SIM_DEFERRED_QUEUE_SIZE - 1U)];
+		timer->callback(timer->args);
+		count++;
+	}
+	return count;
+}
+
+//****************************************************************************
+// SYSTIMER_GetTime - returns the simulated time in us at the last tick (wraps after 71min like on target)
+//****************************************************************************
+uint32_t SYSTIMER_GetTime(void){
+	return (uint32_t)(sim_time / SYSTIMER_TICK_PERIOD_US) * SYSTIMER_TICK_PERIOD_US;
+}
+
+//****************************************************************************
+// SYSTIMER_GetTimeUs - returns the simulated time in us
+//****************************************************************************
+uint32_t SYSTIMER_GetTimeUs(void){
+	return (uint32_t)sim_time;
+}
+
+//****************************************************************************
+// SYSTIMER_GetTickCount - returns the number of ticks since reset
+//****************************************************************************
+uint32_t SYSTIMER_GetTickCount(void){
+	return (uint32_t)(sim_time / SYSTIMER_TICK_PERIOD_US);
+}
+
+//****************************************************************************
+// SYSTIMER_GetCycles - returns the simulated time in SysTick clock cycles (lower 32 bit)
+//****************************************************************************
+uint32_t SYSTIMER_GetCycles(void){
+	return (uint32_t)(sim_time * (SYSTIMER_SYSTICK_CLOCK / 1000000U));
+}
+
+
+/// ADC_MEASUREMENT
+
+//****************************************************************************
+// ADC_MEASUREMENT_StartConversion - delivers a result through the sample source of the simulation right away
+//****************************************************************************
+void ADC_MEASUREMENT_StartConversion(ADC_MEASUREMENT_t *const handle){
+	handle->conversions++;
+	if(sim_adc_source != NULL)
+		sim_adc_source();
+}
+
+
+/// ledfade
+
+//****************************************************************************
+// ledfade_init - nothing to set up
+//****************************************************************************
+bool ledfade_init(void){
+	return true;
+}
+
+//****************************************************************************
+// ledfade_set - sets the LED to a level at once
+//****************************************************************************
+void ledfade_set(uint8_t level){
+	sim_led_level = sim_led_target = level;
+	sim_led_ramp_end = 0;
+}
+
+//****************************************************************************
+// ledfade_ramp - fades from the current level to level within time ms
+//****************************************************************************
+bool ledfade_ramp(uint8_t level, uint16_t time){
+	sim_led_level = sim_get_led_level();
+	sim_led_target = level;
+	sim_led_ramp_start = sim_time;
+	sim_led_ramp_end = sim_time + (uint64_t)(time ? time : 1U) * 1000U;
+	return true;
+}
+
+//****************************************************************************
+// ledfade_stop - holds the current level
+//****************************************************************************
+void ledfade_stop(void){
+	sim_led_level = sim_led_target = sim_get_led_level();
+	sim_led_ramp_end = 0;
+}
+
+//****************************************************************************
+// ledfade_running - returns true while a ramp is running
+//****************************************************************************
+bool ledfade_running(void){
+	return sim_led_ramp_end != 0 && sim_time < sim_led_ramp_end;
+}
+
+//****************************************************************************
+// ledfade_sequence - no slice to run it, the fallback instructions of the pattern run instead
+//****************************************************************************
+bool ledfade_sequence(const uint8_t *steps, uint8_t count){
+	(void)steps;
+	(void)count;
+	return false;
+}
+
+//****************************************************************************
+// ledfade_set_clock_shift - nothing to adapt (no PWM clock)
+//****************************************************************************
+void ledfade_set_clock_shift(uint8_t shift){
+	(void)shift;
+}
+
+
+/// Relay coil economiser (coil.c needs the CCU4, the pin is on while pull-in or hold PWM run)
+
+//****************************************************************************
+// coil_set - drives the relay pin
+//****************************************************************************
+void coil_set(bool on){
+	sim_write_output(&IO_RELAY, on ? 1U : 0U);
+}
+
+
+/// E_EEPROM_XMC1
+
+//****************************************************************************
+// sim_eeprom_need - returns the flash blocks one write of a block takes (data plus header)
+//****************************************************************************
+uint32_t sim_eeprom_need(uint8_t block_number){
+	return 1U + (sim_eeprom[block_number - 1U].size + E_EEPROM_XMC1_FLASH_BLOCK_SIZE - 1U) / E_EEPROM_XMC1_FLASH_BLOCK_SIZE;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_Init - the RAM banks start empty (sim_init)
+//****************************************************************************
+E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_Init(void *const handle_ptr){
+	(void)handle_ptr;
+	return E_EEPROM_XMC1_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_Write - appends a block to the active bank
+//****************************************************************************
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Write(uint8_t block_number, uint8_t *data_buffer_ptr){
+	if(block_number == 0 || block_number > E_EEPROM_XMC1_MAX_BLOCK_COUNT)
+		return E_EEPROM_XMC1_OPERATION_STATUS_FAILURE;
+	if(sim_eeprom_gc_step != 0)
+		return E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED;
+	if(E_EEPROM_XMC1_IsGarbageCollectionNeeded(block_number))
+		return E_EEPROM_XMC1_OPERATION_STATUS_MEMORY_BANK_FULL;
+	sim_eeprom_block_t *block = &sim_eeprom[block_number - 1U];
+	if(block->valid){
+		memmove(block->history[1], block->history[0], (E_EEPROM_XMC1_HISTORY_DEPTH - 1U) * sizeof(block->history[0]));
+		memcpy(block->history[0], block->data, block->size);
+		if(block->history_count < E_EEPROM_XMC1_HISTORY_DEPTH)
+			block->history_count++;
+	}
+	memcpy(block->data, data_buffer_ptr, block->size);
+	block->valid = true;
+	sim_eeprom_used += sim_eeprom_need(block_number);
+	sim_busy_until = sim_time + sim_eeprom_need(block_number) * SIM_FLASH_PROGRAM_US;
+	sim_eeprom_wear.block_writes[block_number - 1U]++;
+	return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_GetDataPointer - returns the latest content of a block in one piece
+//****************************************************************************
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetDataPointer(uint8_t block_number, uint32_t offset, const uint8_t **const data_pptr, uint32_t *const length_ptr){
+	if(block_number == 0 || block_number > E_EEPROM_XMC1_MAX_BLOCK_COUNT)
+		return E_EEPROM_XMC1_OPERATION_STATUS_FAILURE;
+	const sim_eeprom_block_t *block = &sim_eeprom[block_number - 1U];
+	if(!block->valid || offset >= block->size)
+		return E_EEPROM_XMC1_OPERATION_STATUS_INVALID_BLOCK;
+	*data_pptr = &block->data[offset];
+	*length_ptr = block->size - offset;
+	return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_Read - copies the latest content of a block
+//****************************************************************************
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_Read(uint8_t block_number, uint32_t block_offset, uint8_t *data_buffer_ptr, uint32_t length){
+	const uint8_t *data;
+	uint32_t available;
+	E_EEPROM_XMC1_OPERATION_STATUS_t status = E_EEPROM_XMC1_GetDataPointer(block_number, block_offset, &data, &available);
+	if(status != E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS)
+		return status;
+	if(length > available)
+		return E_EEPROM_XMC1_OPERATION_STATUS_FAILURE;
+	memcpy(data_buffer_ptr, data, length);
+	return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_RequestGarbageCollection - starts a stepped garbage collection
+//****************************************************************************
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_RequestGarbageCollection(void){
+	if(sim_eeprom_gc_step == 0){
+		sim_eeprom_gc_step = 1;
+		sim_eeprom_wear.gc_runs++;
+	}
+	return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_StepGarbageCollection - executes one garbage collection step (copy or erase of one page)
+//****************************************************************************
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StepGarbageCollection(void){
+	if(sim_eeprom_gc_step == 0)
+		return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+	if(sim_eeprom_gc_step == 1){
+		// Latest copy of every block into the other bank (the previous ones are lost)
+		sim_eeprom_used = 0;
+		for(uint8_t i = 1; i <= E_EEPROM_XMC1_MAX_BLOCK_COUNT; i++){
+			sim_eeprom[i - 1U].history_count = 0;
+			if(sim_eeprom[i - 1U].valid)
+				sim_eeprom_used += sim_eeprom_need(i);
+		}
+		sim_eeprom_bank ^= 1U;
+		sim_busy_until = sim_time + sim_eeprom_used * SIM_FLASH_PROGRAM_US;
+	}
+	else
+		sim_busy_until = sim_time + SIM_FLASH_ERASE_US;
+	if(sim_eeprom_gc_step == 1U + E_EEPROM_XMC1_BANK_PAGES){
+		// Last page of the old bank erased
+		sim_eeprom_wear.bank_erases[sim_eeprom_bank ^ 1U]++;
+		sim_eeprom_gc_step = 0;
+		return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+	}
+	sim_eeprom_gc_step++;
+	return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_StartGarbageCollection - executes a whole garbage collection
+//****************************************************************************
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_StartGarbageCollection(void){
+	E_EEPROM_XMC1_RequestGarbageCollection();
+	while(sim_eeprom_gc_step != 0)
+		E_EEPROM_XMC1_StepGarbageCollection();
+	return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_IsGarbageCollectionRunning - returns true until the last step of a garbage collection is done
+//****************************************************************************
+bool E_EEPROM_XMC1_IsGarbageCollectionRunning(void){
+	return sim_eeprom_gc_step != 0;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_IsGarbageCollectionNeeded - returns true if the active bank has no room for a write of the block
+//****************************************************************************
+bool E_EEPROM_XMC1_IsGarbageCollectionNeeded(uint8_t block_number){
+	if(block_number == 0 || block_number > E_EEPROM_XMC1_MAX_BLOCK_COUNT)
+		return false;
+	return sim_eeprom_used + sim_eeprom_need(block_number) > SIM_EEPROM_BANK_BLOCKS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_GetWearCounters - returns the wear counters
+//****************************************************************************
+const E_EEPROM_XMC1_WEAR_t *E_EEPROM_XMC1_GetWearCounters(void){
+	return &sim_eeprom_wear;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_SetWearCounters - overwrites the wear counters
+//****************************************************************************
+void E_EEPROM_XMC1_SetWearCounters(const E_EEPROM_XMC1_WEAR_t *const counters){
+	sim_eeprom_wear = *counters;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_GetFreeBlocks - returns the flash blocks left in the active bank
+//****************************************************************************
+uint32_t E_EEPROM_XMC1_GetFreeBlocks(void){
+	return (sim_eeprom_used < SIM_EEPROM_BANK_BLOCKS) ? SIM_EEPROM_BANK_BLOCKS - sim_eeprom_used : 0U;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_GetBlockFootprint - returns the flash blocks one write of a block takes
+//****************************************************************************
+uint32_t E_EEPROM_XMC1_GetBlockFootprint(uint8_t block_number){
+	if(block_number == 0 || block_number > E_EEPROM_XMC1_MAX_BLOCK_COUNT)
+		return 0U;
+	return sim_eeprom_need(block_number);
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_GetHistoryCount - returns the previous contents kept of a block
+//****************************************************************************
+uint32_t E_EEPROM_XMC1_GetHistoryCount(uint8_t block_number){
+	if(block_number == 0 || block_number > E_EEPROM_XMC1_MAX_BLOCK_COUNT)
+		return 0U;
+	return sim_eeprom[block_number - 1U].history_count;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_GetHistoryPointer - returns a previous content of a block in one piece (age 0 = the one before the latest)
+//****************************************************************************
+E_EEPROM_XMC1_OPERATION_STATUS_t E_EEPROM_XMC1_GetHistoryPointer(uint8_t block_number, uint32_t age, uint32_t offset, const uint8_t **const data_pptr, uint32_t *const length_ptr){
+	if(block_number == 0 || block_number > E_EEPROM_XMC1_MAX_BLOCK_COUNT)
+		return E_EEPROM_XMC1_OPERATION_STATUS_FAILURE;
+	const sim_eeprom_block_t *block = &sim_eeprom[block_number - 1U];
+	if(sim_eeprom_gc_step != 0 || age >= E_EEPROM_XMC1_HISTORY_DEPTH || offset >= block->size)
+		return E_EEPROM_XMC1_OPERATION_STATUS_NOT_ALLOWED;
+	if(age >= block->history_count)
+		return E_EEPROM_XMC1_OPERATION_STATUS_INVALID_BLOCK;
+	*data_pptr = &block->history[age][offset];
+	*length_ptr = block->size - offset;
+	return E_EEPROM_XMC1_OPERATION_STATUS_SUCCESS;
+}
+
+//****************************************************************************
+// E_EEPROM_XMC1_GetStatus - returns busy while a garbage collection is running
+//****************************************************************************
+E_EEPROM_XMC1_STATUS_t E_EEPROM_XMC1_GetStatus(void){
+	return (sim_eeprom_gc_step != 0) ? E_EEPROM_XMC1_STATUS_BUSY : E_EEPROM_XMC1_STATUS_IDLE;
+}
+
+
+/// Trace, profiler and wall clock
+
+//****************************************************************************
+// trace_record - appends an event to the trace ring buffer and counts it
+//****************************************************************************
+void trace_record(trace_types type, uint8_t arg, uint16_t value){
+	trace_entry_t *entry = &trace_buffer.entries[trace_buffer.head];
+	entry->time = SYSTIMER_GetTime();
+	entry->value = value;
+	entry->type = (uint8_t)type;
+	entry->arg = arg;
+	trace_buffer.head = (uint8_t)((trace_buffer.head + 1U) & (TRACE_ENTRIES - 1U));
+	if(trace_buffer.count < TRACE_ENTRIES)
+		trace_buffer.count++;
+	if((uint32_t)type < SIM_TRACE_TYPES)
+		sim_trace_counts[type]++;
+}
+
+//****************************************************************************
+// profiler_timestamp - returns the host time in ns (profiler sections are measured in ns)
+//****************************************************************************
+uint32_t profiler_timestamp(void){
+	return (uint32_t)sim_host_ns();
+}
+
+//****************************************************************************
+// profiler_record - adds the duration of a profiler section
+//****************************************************************************
+void profiler_record(profiler_sections section, uint32_t cycles){
+	sim_stat_t *stat = &sim_profiler[section];
+	// The latencies are not measured on the host clock but given in simulated cycles
+	if(section == PROFILER_RELAY_LATENCY || section == PROFILER_USB_LATENCY)
+		cycles = cycles * 1000U / (SYSTIMER_SYSTICK_CLOCK / 1000000U);
+	stat->count++;
+	stat->total += cycles;
+	if(cycles > stat->max)
+		stat->max = cycles;
+}
+
+//****************************************************************************
+// wallclock_get - returns the wall clock (never set in the simulation)
+//****************************************************************************
+uint32_t wallclock_get(void){
+	return 0; // Not set
+}
@@ -0,0 +1,53 @@
+/*
+ * USB-Changer sim.h
+ *
+ * Simulation core of the host build. Provides a simulated microsecond clock and the DAVE APPs (see shim/DAVE.h),
+ * ledfade, trace, profiler and wall clock on top of it, so the application modules compile unchanged and run as they do
+ * on target, only without real time. Time only passes in sim_advance, which runs the SysTick work (SYSTIMER timers and
+ * their callbacks) that got due in order, deferred callbacks are queued for SYSTIMER_DispatchDeferred. Interrupt
+ * handlers are called directly: sim_set_input raises the ERU interrupt of buttons.c for the UP and DOWN pins.
+ * The profiler sections of the firmware (PROFILER_START/STOP) are measured in host nanoseconds, so the same sections
+ * that are profiled on target are benchmarked here.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "DAVE.h"
+#include "profiler.h"
+
+#define SIM_TRACE_TYPES				 32							// Trace event types counted (trace_types must fit)
+
+typedef void (*sim_output_hook_t)(const DIGITAL_IO_t *io, uint32_t level);
+typedef void (*sim_adc_source_t)(void);
+
+typedef struct {
+	uint32_t count;					// Number of measurements
+	uint64_t total;					// In ns. Sum of all durations
+	uint32_t max;					// In ns. Longest duration
+} sim_stat_t;
+
+extern uint64_t sim_time;										// In us. Simulated time since reset
+extern uint64_t sim_busy_until;									// In us. End of the flash operation that blocks the main context
+extern sim_stat_t sim_profiler[PROFILER_SECTION_COUNT];			// Host time of the firmware profiler sections
+extern uint32_t sim_trace_counts[SIM_TRACE_TYPES];				// Recorded trace events per trace_types
+extern uint32_t sim_port_writes;								// Number of Pn_OMR writes (sim_write_omr)
+
+void sim_init(void);
+void sim_advance(uint64_t time);
+uint64_t sim_next_timer(void);
+void sim_set_input(const DIGITAL_IO_t *io, uint32_t level);
+uint32_t sim_get_output(const DIGITAL_IO_t *io);
+void sim_set_output_hook(sim_output_hook_t hook);
+void sim_set_adc_source(sim_adc_source_t source);
+uint8_t sim_get_led_level(void);
+uint64_t sim_host_ns(void);
+void sim_report(void);
+
+void ERU0_0_IRQHandler(void);
+
+#endif /* SIM_H */
@@ -0,0 +1,312 @@
+/*
+ * USB-Changer test_container.c
+ *
+ * Host test of the fixed capacity containers (see container.h), built against the unchanged container.c. Every
+ * operation is compared with a plain reference model on deterministic pseudo random sequences:
+ *   debruijn	pool_alloc returns the lowest free slot for every single bit and for random bitmaps
+ *   pool		all slots once, then POOL_NONE, pool_init of 1 to 32 slots
+ *   freelist	all entries once, then FREELIST_END, last freed entry first, empty list
+ *   heap		push, pop and remove keep the min-heap order (sift up and down), also for deadlines across the 2^32 wrap,
+ *				full and empty heap
+ *   ring		FIFO order, full and empty ring, free running indices across the 16 bit wrap
+ * Every failed check prints its line, the last line is "PASS" or the number of failed checks.
+ *
+ * Usage: test_container [-n rounds]
+ *   -n rounds	Random sequences per test (default TEST_ROUNDS)
+ * The exit code is 1 if any check fails.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "container.h"
+
+#define TEST_ROUNDS					 200						// Default -n
+#define TEST_HEAP_SIZE				 16							// Entries of the tested heap
+#define TEST_LINKS					 254						// Entries of the tested free list (the most it takes)
+#define TEST_RING_SIZE				 8							// Capacity of the tested ring
+
+#define TEST_CHECK(condition)		 test_check((condition), __LINE__, #condition)
+
+uint32_t test_seed = 1;
+uint32_t test_failed = 0;
+uint32_t test_checks = 0;
+
+
+//****************************************************************************
+// test_random - returns a pseudo random 32 bit number (deterministic, so runs can be compared)
+//****************************************************************************
+uint32_t test_random(void){
+	test_seed = test_seed * 1664525U + 1013904223U;
+	return test_seed;
+}
+
+//****************************************************************************
+// test_check - counts a check and prints it if it failed
+//****************************************************************************
+void test_check(bool condition, int line, const char *text){
+	test_checks++;
+	if(condition)
+		return;
+	// Only the first failures, a broken container fails thousands of checks
+	if(test_failed++ < 20)
+		printf("test_container.c:%d: failed: %s\n", line, text);
+}
+
+//****************************************************************************
+// test_lowest_bit - returns the number of the lowest set bit by a plain scan (reference of the de Bruijn lookup)
+//****************************************************************************
+uint8_t test_lowest_bit(uint32_t value){
+	for(uint8_t bit = 0; bit < 32; bit++){
+		if(value & (1U << bit))
+			return bit;
+	}
+	return POOL_NONE;
+}
+
+//****************************************************************************
+// test_debruijn - checks the bit scan of pool_alloc for every single bit and random bitmaps
+//****************************************************************************
+void test_debruijn(uint32_t rounds){
+	pool_t pool;
+	for(uint8_t bit = 0; bit < 32; bit++){
+		pool.free = 1U << bit;
+		TEST_CHECK(pool_alloc(&pool) == bit);
+		TEST_CHECK(pool.free == 0);
+	}
+	for(uint32_t round = 0; round < rounds; round++){
+		uint32_t free = test_random() & test_random(); // Sparse maps as well
+		pool.free = free;
+		TEST_CHECK(pool_alloc(&pool) == test_lowest_bit(free));
+		TEST_CHECK(pool.free == (free & (free - 1U)));
+	}
+}
+
+//****************************************************************************
+// test_pool - checks alloc and free of whole pools against a bitmap model
+//****************************************************************************
+void test_pool(uint32_t rounds){
+	pool_t pool;
+	for(uint8_t slots = 1; slots <= 32; slots++){
+		pool_init(&pool, slots);
+		for(uint8_t slot = 0; slot < slots; slot++)
+			TEST_CHECK(pool_alloc(&pool) == slot);
+		TEST_CHECK(pool_alloc(&pool) == POOL_NONE);
+		pool_free(&pool, (uint8_t)(slots - 1U));
+		TEST_CHECK(pool_alloc(&pool) == slots - 1U);
+	}
+
+	pool_init(&pool, 32);
+	uint32_t taken = 0;
+	for(uint32_t round = 0; round < rounds * 32U; round++){
+		if((test_random() & 0x100U) && taken != 0){
+			// The first taken slot from a random one on
+			uint8_t slot = test_lowest_bit(taken & (0xFFFFFFFFU << (test_random() & 31U)));
+			if(slot == POOL_NONE)
+				slot = test_lowest_bit(taken);
+			pool_free(&pool, slot);
+			taken &= ~(1U << slot);
+		}
+		else{
+			uint8_t slot = pool_alloc(&pool);
+			TEST_CHECK(slot == test_lowest_bit(~taken));
+			if(slot != POOL_NONE)
+				taken |= 1U << slot;
+		}
+		TEST_CHECK(pool.free == ~taken);
+	}
+}
+
+//****************************************************************************
+// test_freelist - checks alloc and free against a stack model (the last freed entry is taken first)
+//****************************************************************************
+void test_freelist(uint32_t rounds){
+	uint8_t links[TEST_LINKS];
+	freelist_t list;
+
+	freelist_init(&list, links, 0);
+	TEST_CHECK(freelist_alloc(&list) == FREELIST_END);
+
+	freelist_init(&list, links, TEST_LINKS);
+	for(uint16_t entry = 0; entry < TEST_LINKS; entry++)
+		TEST_CHECK(freelist_alloc(&list) == entry);
+	TEST_CHECK(freelist_alloc(&list) == FREELIST_END);
+
+	// Model: the free entries as a stack, the top is the next alloc
+	uint8_t stack[TEST_LINKS];
+	uint16_t depth = 0;
+	bool taken[TEST_LINKS];
+	memset(taken, true, sizeof(taken));
+	for(uint32_t round = 0; round < rounds * 64U; round++){
+		uint8_t entry = (uint8_t)(test_random() % TEST_LINKS);
+		if((test_random() & 0x100U) && taken[entry]){
+			freelist_free(&list, entry);
+			taken[entry] = false;
+			stack[depth++] = entry;
+		}
+		else{
+			uint8_t allocated = freelist_alloc(&list);
+			if(depth == 0)
+				TEST_CHECK(allocated == FREELIST_END);
+			else{
+				TEST_CHECK(allocated == stack[--depth]);
+				if(allocated < TEST_LINKS)
+					taken[allocated] = true;
+			}
+		}
+	}
+}
+
+//****************************************************************************
+// test_heap_ordered - returns true if every entry of the heap is not before its parent (min-heap property)
+//****************************************************************************
+bool test_heap_ordered(const heap_t *heap){
+	for(uint8_t i = 1; i < heap->count; i++){
+		if((int32_t)(heap->entries[i].key - heap->entries[(i - 1U) / 2U].key) < 0)
+			return false;
+	}
+	return true;
+}
+
+//****************************************************************************
+// test_heap - checks push, pop and remove against a sorted model, deadlines around a random base (also across the wrap)
+//****************************************************************************
+void test_heap(uint32_t rounds){
+	heap_entry_t entries[TEST_HEAP_SIZE];
+	heap_t heap = HEAP_INIT(entries);
+	heap_entry_t entry;
+
+	TEST_CHECK(!heap_pop(&heap, &entry));
+	TEST_CHECK(!heap_peek(&heap, &entry));
+	TEST_CHECK(!heap_remove(&heap, 0));
+
+	for(uint32_t round = 0; round < rounds; round++){
+		// Every other round close below the wrap, so the keys straddle 0
+		uint32_t base = (round & 1U) ? 0xFFFFFFFFU - (test_random() & 0xFFFFU) : test_random();
+		int32_t offsets[TEST_HEAP_SIZE];	// Model: offset of the key from base per id (INT32_MAX = not queued)
+		for(uint8_t id = 0; id < TEST_HEAP_SIZE; id++){
+			offsets[id] = (int32_t)(test_random() & 0x3FFFFFFFU) - 0x20000000;
+			TEST_CHECK(heap_push(&heap, base + (uint32_t)offsets[id], id));
+			TEST_CHECK(test_heap_ordered(&heap));
+		}
+		TEST_CHECK(!heap_push(&heap, base, TEST_HEAP_SIZE));
+
+		// A few removals from the middle (the moved last entry sifts up or down)
+		for(uint8_t n = 0; n < 4; n++){
+			uint8_t id = (uint8_t)(test_random() % TEST_HEAP_SIZE);
+			TEST_CHECK(heap_remove(&heap, id) == (offsets[id] != INT32_MAX));
+			offsets[id] = INT32_MAX;
+			TEST_CHECK(test_heap_ordered(&heap));
+		}
+
+		int32_t last = INT32_MIN;
+		while(heap_peek(&heap, &entry)){
+			heap_entry_t popped;
+			TEST_CHECK(heap_pop(&heap, &popped));
+			TEST_CHECK(popped.key == entry.key && popped.id == entry.id);
+			TEST_CHECK(popped.id < TEST_HEAP_SIZE && offsets[popped.id] != INT32_MAX);
+			if(popped.id >= TEST_HEAP_SIZE)
+				break;
+			int32_t offset = (int32_t)(popped.key - base);
+			TEST_CHECK(offset == offsets[popped.id]);
+			TEST_CHECK(offset >= last);
+			// The popped one is the earliest of the model
+			for(uint8_t id = 0; id < TEST_HEAP_SIZE; id++)
+				TEST_CHECK(offsets[id] == INT32_MAX || offsets[id] >= offset);
+			last = offset;
+			offsets[popped.id] = INT32_MAX;
+			TEST_CHECK(test_heap_ordered(&heap));
+		}
+		for(uint8_t id = 0; id < TEST_HEAP_SIZE; id++)
+			TEST_CHECK(offsets[id] == INT32_MAX);
+		TEST_CHECK(heap.count == 0);
+	}
+}
+
+//****************************************************************************
+// test_ring_from - checks a ring whose free running indices start at start against a FIFO model
+//****************************************************************************
+void test_ring_from(uint16_t start, uint32_t operations){
+	RING(uint32_t, TEST_RING_SIZE) ring;
+	ring.index.head = ring.index.tail = start;
+	uint32_t put = 0;		// Next value put (values are consecutive, so the model is two counters)
+	uint32_t got = 0;		// Next value expected
+	uint32_t value;
+
+	TEST_CHECK(RING_COUNT(&ring) == 0);
+	TEST_CHECK(RING_FREE(&ring) == TEST_RING_SIZE);
+	TEST_CHECK(!RING_GET(&ring, value));
+
+	// Full: every slot is used, one put more is refused
+	for(uint8_t n = 0; n < TEST_RING_SIZE; n++)
+		TEST_CHECK(RING_PUT(&ring, put++));
+	TEST_CHECK(RING_COUNT(&ring) == TEST_RING_SIZE);
+	TEST_CHECK(RING_FREE(&ring) == 0);
+	TEST_CHECK(!RING_PUT(&ring, put));
+	TEST_CHECK(RING_TAIL(&ring) == got);
+
+	for(uint32_t n = 0; n < operations; n++){
+		if(test_random() & 0x100U){
+			bool full = (put - got) == TEST_RING_SIZE;
+			TEST_CHECK(RING_PUT(&ring, put) == !full);
+			if(!full)
+				put++;
+		}
+		else{
+			bool empty = put == got;
+			value = 0xFFFFFFFFU;
+			TEST_CHECK(RING_GET(&ring, value) == !empty);
+			if(!empty)
+				TEST_CHECK(value == got++);
+		}
+		TEST_CHECK(RING_COUNT(&ring) == put - got);
+		TEST_CHECK(RING_FREE(&ring) == TEST_RING_SIZE - (put - got));
+	}
+
+	// Empty again
+	while(RING_GET(&ring, value))
+		TEST_CHECK(value == got++);
+	TEST_CHECK(got == put);
+	TEST_CHECK(RING_COUNT(&ring) == 0);
+	TEST_CHECK(ring.index.head == (uint16_t)(start + put));
+}
+
+//****************************************************************************
+// test_ring - checks rings from index 0 and right below the 16 bit wrap of the indices
+//****************************************************************************
+void test_ring(uint32_t rounds){
+	test_ring_from(0, rounds * 64U);
+	for(uint32_t round = 0; round < rounds; round++)
+		test_ring_from((uint16_t)(0xFFFFU - (test_random() % (2U * TEST_RING_SIZE))), 64U);
+	// Many times around the whole index range
+	test_ring_from(0x8000U, 3U * 65536U);
+}
+
+int main(int argc, char **argv){
+	uint32_t rounds = TEST_ROUNDS;
+	int option;
+	while((option = getopt(argc, argv, "n:")) != -1){
+		switch(option){
+			case 'n': rounds = (uint32_t)atoi(optarg); break;
+			default:
+				fprintf(stderr, "usage: %s [-n rounds]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	test_debruijn(rounds);
+	test_pool(rounds);
+	test_freelist(rounds);
+	test_heap(rounds);
+	test_ring(rounds);
+
+	if(test_failed != 0){
+		printf("FAIL (%u of %u checks)\n", test_failed, test_checks);
+		return 1;
+	}
+	printf("%u checks\nPASS\n", test_checks);
+	return 0;
+}
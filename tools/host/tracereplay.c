@@ -0,0 +1,171 @@
+/*
+ * USB-Changer tracereplay.c
+ *
+ * Offline replay of the field trace recorder (see recorder.h). Reads a dump of recorder_buffer (written on target by
+ * "recorder_dump" of tools/profiler_report.gdb or on the host by replay -w) and replays every frozen window, oldest
+ * first: the filter and relay channel are set to the snapshot of the oldest complete block, then its samples are fed
+ * with the reconstructed timestamps through the unchanged filter_apply, relay_check_thresholds and relay_update, like
+ * the ADC result interrupt with ADC_BOUNDARY_EVENTS and the main loop do. The first switch of the replay is compared
+ * with the recorded one: the same new state detected at the same time or up to the tolerance before it (the main loop
+ * of the target may evaluate an expired latch time a little later than the next sample) is a match.
+ * With other thresholds, latch time or filter the windows show how a setup change would have switched (tuning).
+ *
+ * Usage: tracereplay [-u upper] [-l lower] [-t latchtime] [-r rate] [-f filter] [-d tolerance] [-p] dump
+ *   dump		Binary copy of recorder_buffer (sizeof(recorder_buffer_t) bytes, RECORDER_MAGIC)
+ *   -u -l -t	Thresholds and latch time instead of the ones recorded at the switch
+ *   -r rate	predict_rate of the predictive latch (see relay.h) instead of the recorded one (0 = off)
+ *   -f filter	filter_types, see filter.h, instead of the recorded one
+ *   -d tolerance	In ms. Largest delay of the recorded switch after the replayed one (default TRACEREPLAY_TOLERANCE)
+ *   -p			Prints the samples of every window (time, raw, filtered, relay state)
+ * The exit code is 1 if a window does not match (only without -u, -l, -t, -r and -f).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "sim.h"
+#include "relay.h"
+#include "recorder.h"
+
+#define TRACEREPLAY_TOLERANCE		 5							// In ms. Default -d
+
+const char *const tracereplay_state_names[] = {"high", "low"};
+
+recorder_buffer_t tracereplay_buffer;
+
+
+//****************************************************************************
+// tracereplay_window - replays a frozen window with the given setup, returns true if its switch is reproduced
+//****************************************************************************
+bool tracereplay_window(const recorder_window_t *window, const relay_channel_t *setup, int filter, bool tuned,
+		uint32_t tolerance, bool print){
+	// The oldest block that is complete in the ring (its snapshot is not overwritten yet)
+	uint32_t start = 0;
+	if(window->count > RECORDER_SAMPLES)
+		start = (window->count - RECORDER_SAMPLES + RECORDER_BLOCK_SAMPLES - 1U) & ~(RECORDER_BLOCK_SAMPLES - 1U);
+	const recorder_snapshot_t *snapshot = &window->snapshots[(start / RECORDER_BLOCK_SAMPLES) & (RECORDER_BLOCKS - 1U)];
+
+	relay_channel_t *channel = &relay_channels[0];
+	channel->upper_threshold = (setup->upper_threshold >= 0) ? setup->upper_threshold : window->upper_threshold;
+	channel->lower_threshold = (setup->lower_threshold >= 0) ? setup->lower_threshold : window->lower_threshold;
+	channel->latchtime = (setup->latchtime >= 0) ? setup->latchtime : window->latchtime;
+	channel->predict_rate = (setup->predict_rate >= 0) ? setup->predict_rate : window->predict_rate;
+	// The dwell and rate history of the limiter is not recorded
+	channel->min_high_time = 0;
+	channel->min_low_time = 0;
+	channel->switch_rate_max = 0;
+	relay_publish();
+	filter_t state;
+	filter_init(&state, (filter_types)((filter >= 0) ? filter : window->filter));
+	recorder_restore(snapshot, &state, channel);
+
+	printf("window %u: samples %u-%u, rate %u.%03u Hz, thresholds %d/%d, latch time %d ms, predict rate %d, filter %d%s%s%s%s%s%s\n",
+			window->sequence, start, window->count - 1U, window->sample_rate / 1000U, window->sample_rate % 1000U,
+			channel->upper_threshold, channel->lower_threshold, channel->latchtime, channel->predict_rate, state.type,
+			(window->flags & RECORDER_FLAG_CALIBRATED) ? ", calibrated (replayed without)" : "",
+			(window->flags & RECORDER_FLAG_DECIMATED) ? ", decimated" : "",
+			(window->flags & RECORDER_FLAG_GAP) ? ", tick gap" : "",
+			(window->flags & RECORDER_FLAG_TRUNCATED) ? ", truncated by a reset" : "",
+			(window->flags & RECORDER_FLAG_PREDICTED) ? ", predictive latch (slope restarts at the block)" : "",
+			(window->flags & RECORDER_FLAG_LIMITED) ? ", held back by the rate limiter (replayed without)" : "");
+
+	uint32_t time = snapshot->time;
+	uint32_t switches = 0, switch_time = 0;
+	relay_states switch_state = channel->state;
+	for(uint32_t i = start; i < window->count; i++){
+		uint16_t sample = window->samples[i & (RECORDER_SAMPLES - 1U)];
+		if(i != start)
+			time += (uint32_t)sample_tag(sample) * SYSTIMER_TICK_PERIOD_US;
+		uint16_t raw = sample_value(sample);
+		uint32_t value = filter_apply(&state, raw);
+		channel->value = value;
+		relay_check_thresholds(channel, value, time);
+		if(relay_update(channel, value, time, false)){
+			if(switches++ == 0){
+				switch_time = time;
+				switch_state = channel->state;
+			}
+		}
+		if(print)
+			printf("  %6u %10u.%03u %4u %4u %s\n", i, time / 1000U, time % 1000U, raw, value, tracereplay_state_names[channel->state]);
+	}
+
+	int32_t delay = (int32_t)(window->switch_time - switch_time) / 1000;
+	// A held back switch is recorded later than the replay without the limiter by an unknown time
+	bool held = (window->flags & RECORDER_FLAG_LIMITED) != 0;
+	bool match = switches != 0 && switch_state == (relay_states)window->new_state && delay >= 0 && (held || (uint32_t)delay <= tolerance);
+	printf("  recorded switch to %s at %u ms\n", tracereplay_state_names[window->new_state & 1U], window->switch_time / 1000U);
+	if(switches != 0)
+		printf("  replayed switch to %s at %u ms (%d ms earlier), %u switches%s\n", tracereplay_state_names[switch_state],
+				switch_time / 1000U, delay, switches, tuned ? "" : (match ? ", match" : ", MISMATCH"));
+	else
+		printf("  no replayed switch%s\n", tuned ? "" : ", MISMATCH");
+	return match;
+}
+
+//****************************************************************************
+// main - reads the dump and replays its frozen windows in the order they were recorded
+//****************************************************************************
+int main(int argc, char **argv){
+	relay_channel_t setup = {.upper_threshold = -1, .lower_threshold = -1, .latchtime = -1, .predict_rate = -1};
+	int filter = -1;
+	uint32_t tolerance = TRACEREPLAY_TOLERANCE;
+	bool print = false;
+	int option;
+	while((option = getopt(argc, argv, "u:l:t:r:f:d:p")) != -1){
+		switch(option){
+			case 'u': setup.upper_threshold = atoi(optarg); break;
+			case 'l': setup.lower_threshold = atoi(optarg); break;
+			case 't': setup.latchtime = atoi(optarg); break;
+			case 'r': setup.predict_rate = atoi(optarg); break;
+			case 'f': filter = atoi(optarg); break;
+			case 'd': tolerance = (uint32_t)atoi(optarg); break;
+			case 'p': print = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-u upper] [-l lower] [-t latchtime] [-r rate] [-f filter] [-d tolerance] [-p] dump\n", argv[0]);
+				return 2;
+		}
+	}
+	if(optind >= argc){
+		fprintf(stderr, "%s: no dump\n", argv[0]);
+		return 2;
+	}
+	FILE *input = fopen(argv[optind], "rb");
+	if(input == NULL){
+		perror(argv[optind]);
+		return 1;
+	}
+	size_t size = fread(&tracereplay_buffer, 1, sizeof(tracereplay_buffer), input);
+	fclose(input);
+	if(size != sizeof(tracereplay_buffer) || tracereplay_buffer.magic != RECORDER_MAGIC){
+		fprintf(stderr, "%s: %s is no recorder dump (%u of %u bytes, magic 0x%08X)\n", argv[0], argv[optind],
+				(unsigned int)size, (unsigned int)sizeof(tracereplay_buffer), tracereplay_buffer.magic);
+		return 1;
+	}
+
+	sim_init();
+	bool tuned = setup.upper_threshold >= 0 || setup.lower_threshold >= 0 || setup.latchtime >= 0 || setup.predict_rate >= 0 || filter >= 0;
+	uint32_t windows = 0, matches = 0, last = 0;
+	for(;;){
+		// Next frozen window by sequence
+		const recorder_window_t *next = NULL;
+		for(uint8_t i = 0; i < RECORDER_WINDOWS; i++){
+			const recorder_window_t *window = &tracereplay_buffer.windows[i];
+			if(window->state == RECORDER_STATE_FROZEN && window->sequence > last && (next == NULL || window->sequence < next->sequence))
+				next = window;
+		}
+		if(next == NULL)
+			break;
+		last = next->sequence;
+		windows++;
+		if(tracereplay_window(next, &setup, filter, tuned, tolerance, print))
+			matches++;
+	}
+	printf("%u frozen windows", windows);
+	if(!tuned)
+		printf(", %u match", matches);
+	printf("\n");
+	return (!tuned && matches != windows) ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+#
+# USB-Changer size_report.py
+#
+# Prints the flash and SRAM use of every module from the map file the linker writes next to the .elf
+# (Debug/USB_Changer.map or Release/USB_Changer.map). A module is a source file of the application or of XMCLib, a
+# DAVE APP (all object files of one Dave/Generated/<APP> folder) or a library. Code counts as text, constants as
+# rodata, .ram_code counts as flash (load image) and as SRAM (copied at startup), like .data.
+# With a budget file every module is compared against its flash and SRAM budget (and .ram_code against ram_code_budget),
+# modules above it are flagged and the exit code is 1, so a feature that grows the image beyond its budget is noticed at build time. Modules without a
+# budget line are only reported.
+#
+#  Created on: 2026 Oct 14
+#
+# Usage: python3 tools/size_report.py Release/USB_Changer.map [--budget tools/size_budget.txt]
+#        python3 tools/size_report.py Release/USB_Changer.map --write-budget tools/size_budget.txt [--headroom 10]
+
+import argparse
+import math
+import os
+import re
+import sys
+
+FLASH_SIZE = 0x10008000 - 0x10001800	# Application window (UPDATER_APP_BASE - UPDATER_APP_END, the .updater section in front is not counted)
+RAM_CODE_BUDGET = 2048					# ram_code_budget of linker_script.ld
+SRAM_SIZE = 0x4000
+BUDGET_ROUNDING = 16					# Budgets written by --write-budget are rounded up to this (one flash block)
+
+# Output section of linker_script.ld -> column of the report (.noinit and .arena buffers are uninitialized SRAM like .bss)
+SECTIONS = {
+	'.text': 'text', '.eh_frame_hdr': 'text', '.eh_frame': 'text', '.ARM.extab': 'text', '.ARM.exidx': 'text',
+	'.VENEER_Code': 'text', '.data': 'data', '.ram_code': 'ram_code', '.bss': 'bss', '.noinit': 'bss', '.arena': 'bss',
+	'.no_init': 'no_init', '.flashcheck': 'text'
+}
+COLUMNS = ('text', 'rodata', 'data', 'ram_code', 'bss', 'no_init')
+
+# Input section line: " .text.main  0x10001234  0x4c ./main.o" (the name may stand alone on the line before)
+INPUT = re.compile(r'^\s+(\S+\s+)?0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+INPUT_NAME = re.compile(r'^\s(\.\S+)$')
+OUTPUT = re.compile(r'^(\.\S+|\S+)\s*(?:0x[0-9a-fA-F]+)?')
+DAVE_APP = re.compile(r'Dave[/\\]Generated[/\\]([^/\\]+)[/\\]')
+
+
+def module_name(path):
+	# "lib/libc_nano.a(lib_a-memcpy.o)" is reported as libc_nano.a, "./Dave/Generated/SYSTIMER/systimer.o" as SYSTIMER
+	path = path.strip()
+	if '(' in path:
+		path = path.split('(')[0]
+	match = DAVE_APP.search(path)
+	if match:
+		return match.group(1)
+	return os.path.basename(path)
+
+
+def flash_of(sizes):
+	return sizes['text'] + sizes['rodata'] + sizes['data'] + sizes['ram_code']
+
+
+def sram_of(sizes):
+	return sizes['data'] + sizes['ram_code'] + sizes['bss'] + sizes['no_init']
+
+
+def parse(map_path):
+	modules = {}
+	section = None
+	started = False
+	pending = None
+	with open(map_path) as f:
+		for line in f:
+			line = line.rstrip('\n')
+			if not started:
+				started = line.startswith('Linker script and memory map')
+				continue
+			if line and not line[0].isspace():
+				match = OUTPUT.match(line)
+				section = SECTIONS.get(match.group(1)) if match else None
+				continue
+			if section is None or '*fill*' in line:
+				continue
+			match = INPUT_NAME.match(line)
+			if match:
+				pending = match.group(1)
+				continue
+			match = INPUT.match(line)
+			name = (match.group(1) or pending or '').strip() if match else ''
+			pending = None
+			if not match or int(match.group(2), 16) == 0:
+				continue
+			size = int(match.group(3), 16)
+			if size == 0:
+				continue
+			column = 'rodata' if section == 'text' and name.startswith(('.rodata', '.metrics', '.evbus', '.flashcheck')) else section
+			sizes = modules.setdefault(module_name(match.group(4)), dict.fromkeys(COLUMNS, 0))
+			sizes[column] += size
+	return modules
+
+
+def read_budget(path):
+	# Lines "module flash sram" (bytes, "-" = no limit), "total" limits the whole image, # starts a comment
+	budget = {}
+	with open(path) as f:
+		for number, line in enumerate(f, 1):
+			fields = line.split('#')[0].split()
+			if not fields:
+				continue
+			if len(fields) != 3:
+				sys.exit('%s:%d: expected "module flash sram"' % (path, number))
+			budget[fields[0]] = tuple(None if value == '-' else int(value, 0) for value in fields[1:])
+	return budget
+
+
+def write_budget(path, modules, headroom):
+	def limit(size):
+		size = math.ceil(size * (100 + headroom) / 100)
+		return -(-size // BUDGET_ROUNDING) * BUDGET_ROUNDING
+
+	with open(path, 'w') as f:
+		f.write('# USB-Changer module footprint budgets (tools/size_report.py --budget)\n')
+		f.write('# module flash sram - in bytes, "-" = no limit. Written with %d%% headroom, edit to accept growth.\n'
+				% headroom)
+		for name, sizes in sorted(modules.items()):
+			f.write('%-28s %6d %6d\n' % (name, limit(flash_of(sizes)), limit(sram_of(sizes))))
+		f.write('%-28s %6d %6d\n' % ('total', FLASH_SIZE, SRAM_SIZE))
+
+
+def check(value, limit):
+	# Budget column text and whether the value exceeds it
+	if limit is None:
+		return '-', False
+	return str(limit), value > limit
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Flash and SRAM use per module from a linker map file')
+	parser.add_argument('map', help='map file (e.g. Release/USB_Changer.map)')
+	parser.add_argument('--budget', help='compares against the budgets of this file (exit code 1 if one is exceeded)')
+	parser.add_argument('--write-budget', metavar='FILE', help='writes the current use plus headroom as budget file')
+	parser.add_argument('--headroom', type=int, default=10, help='headroom of --write-budget in percent (default 10)')
+	args = parser.parse_args()
+
+	modules = parse(args.map)
+	if args.write_budget:
+		write_budget(args.write_budget, modules, args.headroom)
+	budget = read_budget(args.budget) if args.budget else {}
+
+	over = []
+	total = dict.fromkeys(COLUMNS, 0)
+	header = ('module',) + COLUMNS + ('flash', 'sram')
+	print(('%-28s' + ' %8s' * (len(header) - 1)) % header + ('  flash budget    sram budget' if budget else ''))
+	rows = sorted(modules.items(), key=lambda item: -flash_of(item[1]))
+	for name, sizes in rows + [('total', None)]:
+		if sizes is None:
+			sizes = total
+		else:
+			for column in COLUMNS:
+				total[column] += sizes[column]
+		flash, sram = flash_of(sizes), sram_of(sizes)
+		line = ('%-28s' + ' %8d' * (len(header) - 1)) % ((name,) + tuple(sizes[c] for c in COLUMNS) + (flash, sram))
+		if name in budget:
+			flash_limit, flash_over = check(flash, budget[name][0])
+			sram_limit, sram_over = check(sram, budget[name][1])
+			line += ' %13s %14s' % (flash_limit, sram_limit)
+			if flash_over or sram_over:
+				line += '  OVER'
+				over.append(name)
+		print(line)
+
+	flash, sram = flash_of(total), sram_of(total)
+	print('flash %d of %d bytes (%d%%), SRAM %d of %d bytes (%d%%) without stack and heap, .ram_code %d of %d bytes' % (
+		flash, FLASH_SIZE, flash * 100 // FLASH_SIZE, sram, SRAM_SIZE, sram * 100 // SRAM_SIZE, total['ram_code'],
+		RAM_CODE_BUDGET))
+	if budget:
+		if total['ram_code'] > RAM_CODE_BUDGET:
+			over.append('.ram_code')
+		missing = [name for name in modules if name not in budget]
+		if missing:
+			print('no budget: %s' % ', '.join(sorted(missing)))
+		print('over budget: %s' % ', '.join(over) if over else 'all modules within budget')
+	return 1 if over else 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
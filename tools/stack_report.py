@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+#
+# USB-Changer stack_report.py
+#
+# Estimates the worst case stack use from the call graph GCC writes with -fstack-usage -fcallgraph-info=su (one .ci
+# file per object, GCC 10 or newer). Every root (main and the interrupt handlers of VECTORS) gets its deepest call chain:
+# the sum of the static frames along the chain, printed with the frame of every function. Interrupts nest by priority
+# (irqprio.h): handlers of one tier never nest, so the worst case of the image is the chain of main plus the deepest
+# handler of every tier, each with the exception frame the core stacks on entry.
+# Calls through function pointers (scheduler tasks, callbacks) are not in the graph. They are resolved conservatively to
+# every function nobody calls directly (roots excluded). With the map file, functions removed by --gc-sections are left
+# out of that set. Library functions without a .ci file, dynamic frames and recursion are listed and counted as 0 (or
+# once), so the estimate is a lower bound where they appear.
+#
+#  Created on: 2026 Oct 14
+#
+# Usage: python3 tools/stack_report.py Debug [--map Debug/USB_Changer.map] [--stack 1024] [--chains]
+
+import argparse
+import os
+import re
+import sys
+
+STACK_SIZE = 1024				# stack_size of linker_script.ld
+EXCEPTION_FRAME = 36			# In bytes. Registers stacked on exception entry (8 words) plus the 8 byte alignment padding
+INDIRECT = '__indirect_call'
+
+# Interrupt handlers per priority tier of irqprio.h (symbol names, Adc_Measurement_Handler is IRQ_Hdlr_15)
+VECTORS = {
+	'critical': ('IRQ_Hdlr_15', 'Adc_Measurement_Handler', 'ERU0_1_IRQHandler', 'SCU_1_IRQHandler', 'CCU40_2_IRQHandler'),
+	'time': ('SysTick_Handler', 'CCU40_1_IRQHandler', 'ERU0_0_IRQHandler', 'ERU0_2_IRQHandler'),
+	'comm': ('USIC0_2_IRQHandler', 'USIC0_3_IRQHandler', 'CCU40_0_IRQHandler'),
+	'deferred': ('USIC0_0_IRQHandler', 'USIC0_1_IRQHandler')
+}
+
+NODE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"( shape : ellipse)?')
+EDGE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+FRAME = re.compile(r'\\n(\d+) bytes \(([a-z,]+)\)')
+DISCARDED = re.compile(r'^\s*\.text\.(\S+)\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+\s+(\S+)$')
+
+
+def read_graph(directory):
+	# Returns frames {name: (bytes, qualifier)}, calls {name: set of names} and the source stem of every static function
+	frames, calls, stems = {}, {}, {}
+	for root, _, files in os.walk(directory):
+		for file in files:
+			if not file.endswith('.ci'):
+				continue
+			with open(os.path.join(root, file)) as f:
+				for line in f:
+					match = NODE.match(line)
+					if match and not match.group(3):
+						frame = FRAME.search(match.group(2))
+						if frame:
+							frames[match.group(1)] = (int(frame.group(1)), frame.group(2))
+							if ':' in match.group(1):
+								stems[match.group(1)] = os.path.splitext(os.path.basename(match.group(1).rsplit(':', 1)[0]))[0]
+						continue
+					match = EDGE.match(line)
+					if match:
+						calls.setdefault(match.group(1), set()).add(match.group(2))
+	return frames, calls, stems
+
+
+def read_discarded(map_path):
+	# Returns the (function, object stem) pairs of the sections --gc-sections removed
+	discarded = set()
+	with open(map_path) as f:
+		inside = False
+		for line in f:
+			if line.startswith('Discarded input sections'):
+				inside = True
+				continue
+			if inside and line.startswith('Memory Configuration'):
+				break
+			match = DISCARDED.match(line) if inside else None
+			if match:
+				discarded.add((match.group(1), os.path.splitext(os.path.basename(match.group(2).split('(')[0]))[0]))
+	return discarded
+
+
+def short(name):
+	# "main.c:helper" (static function) is printed as helper
+	return name.split(':')[-1]
+
+
+class Graph:
+	def __init__(self, frames, calls, stems, discarded):
+		def kept(name):
+			if name in stems:
+				return (short(name), stems[name]) not in discarded
+			return all(function != name for function, _ in discarded)
+
+		self.frames = {name: frame for name, frame in frames.items() if kept(name)}
+		self.calls = calls
+		called = set()
+		for source, targets in calls.items():
+			called |= targets
+		roots = {name for tier in VECTORS.values() for name in tier} | {'main'}
+		self.indirect = sorted(name for name in self.frames if name not in called and short(name) not in roots)
+		self.unknown, self.dynamic, self.recursive = set(), set(), set()
+		self.depth = {}
+
+	def targets(self, name):
+		for target in sorted(self.calls.get(name, ())):
+			if target == INDIRECT:
+				yield from self.indirect
+			else:
+				yield target
+
+	def worst(self, name, path=()):
+		# Returns (bytes, chain) of the deepest chain below name
+		if name in self.depth:
+			return self.depth[name]
+		if name not in self.frames:
+			self.unknown.add(name)
+			return 0, [(name, 0)]
+		size, qualifier = self.frames[name]
+		if qualifier != 'static':
+			self.dynamic.add('%s (%s)' % (short(name), qualifier))
+		best = (0, [])
+		for target in self.targets(name):
+			if target == name or target in path:
+				self.recursive.add(short(name))
+				continue
+			best = max(best, self.worst(target, path + (name,)), key=lambda result: result[0])
+		result = (size + best[0], [(name, size)] + best[1])
+		self.depth[name] = result
+		return result
+
+	def find(self, name):
+		# Roots are global symbols, a static handler would be "file.c:name"
+		if name in self.frames:
+			return name
+		for candidate in self.frames:
+			if short(candidate) == name:
+				return candidate
+		return None
+
+
+def chain_text(chain):
+	return ' > '.join('%s %d' % (short(name), size) for name, size in chain)
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Worst case stack use from the GCC call graph (-fcallgraph-info=su)')
+	parser.add_argument('directory', help='build directory with the .ci files (e.g. Debug)')
+	parser.add_argument('--map', help='map file, leaves functions removed by --gc-sections out of the indirect calls')
+	parser.add_argument('--stack', type=int, default=STACK_SIZE, help='stack size to compare with (default %d)' % STACK_SIZE)
+	parser.add_argument('--chains', action='store_true', help='prints the deepest chain of every root')
+	args = parser.parse_args()
+
+	frames, calls, stems = read_graph(args.directory)
+	if not frames:
+		sys.exit('no .ci files in %s (compile with -fstack-usage -fcallgraph-info=su)' % args.directory)
+	graph = Graph(frames, calls, stems, read_discarded(args.map) if args.map else set())
+
+	main_name = graph.find('main')
+	if main_name is None:
+		sys.exit('main not found in the call graph')
+	total, chain = graph.worst(main_name)
+	print('%-10s %-28s %6d' % ('thread', 'main', total))
+	if args.chains:
+		print('    ' + chain_text(chain))
+
+	for tier, vectors in VECTORS.items():
+		deepest = None
+		for vector in vectors:
+			name = graph.find(vector)
+			if name is None:
+				continue
+			size, chain = graph.worst(name)
+			print('%-10s %-28s %6d' % (tier, short(name), size + EXCEPTION_FRAME))
+			if args.chains:
+				print('    ' + chain_text(chain))
+			if deepest is None or size > deepest:
+				deepest = size
+		if deepest is not None:
+			total += deepest + EXCEPTION_FRAME
+
+	print('indirect calls resolved to %d functions' % len(graph.indirect))
+	if graph.unknown:
+		print('no frame (counted as 0): %s' % ', '.join(sorted(short(name) for name in graph.unknown)))
+	if graph.dynamic:
+		print('dynamic frames: %s' % ', '.join(sorted(graph.dynamic)))
+	if graph.recursive:
+		print('recursion (counted once): %s' % ', '.join(sorted(graph.recursive)))
+	print('worst case %d of %d bytes stack (%d%%), main and the deepest handler of every tier nested' % (
+		total, args.stack, total * 100 // args.stack))
+	return 1 if total > args.stack else 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,99 @@
+/*
+ * USB-Changer trace.c
+ *
+ * Crash persistent event trace (see trace.h). The buffer is only cleared if its magic or head is invalid (power on),
+ * after a warm reset trace_init appends a TRACE_BOOT entry with the reset reasons instead. It must run before
+ * watchdog_init, which clears the reset reasons.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "trace.h"
+#include "critical.h"
+
+typedef char trace_buffer_size_check[(sizeof(trace_buffer_t) == TRACE_BUFFER_SIZE) ? 1 : -1];
+typedef char trace_entries_check[((TRACE_ENTRIES & (TRACE_ENTRIES - 1)) == 0 && TRACE_ENTRIES <= 128) ? 1 : -1];
+
+trace_buffer_t trace_buffer __attribute__((section(".no_init")));
+
+
+//****************************************************************************
+// trace_init - keeps the trace of the last run (clears it after power on) and records the reset
+//****************************************************************************
+void trace_init(void){
+	if(!TRACE_ENABLED && !TRACE_FAULT_ENABLED)
+		return;
+	if(trace_buffer.magic != TRACE_MAGIC || trace_buffer.head >= TRACE_ENTRIES || trace_buffer.count > TRACE_ENTRIES){
+		trace_buffer.magic = TRACE_MAGIC;
+		trace_buffer.head = 0;
+		trace_buffer.count = 0;
+		trace_buffer.faults = 0;
+	}
+	trace_record(TRACE_BOOT, 0, (uint16_t)XMC_SCU_RESET_GetDeviceResetReason());
+}
+
+//****************************************************************************
+// trace_record - appends an event to the ring buffer (main and interrupt context, see TRACE)
+//****************************************************************************
+void trace_record(trace_types type, uint8_t arg, uint16_t value){
+	uint32_t time = SYSTIMER_GetTime();
+	critical_state_t primask = critical_enter();
+	trace_entry_t *entry = &trace_buffer.entries[trace_buffer.head];
+	entry->time = time;
+	entry->value = value;
+	entry->type = (uint8_t)type;
+	entry->arg = arg;
+	trace_buffer.head = (uint8_t)((trace_buffer.head + 1U) & (TRACE_ENTRIES - 1U));
+	if(trace_buffer.count < TRACE_ENTRIES)
+		trace_buffer.count++;
+	critical_exit(primask, CRITICAL_SITE_TRACE);
+}
+
+#if TRACE_FAULT_ENABLED
+#if HARDFAULT_ENABLED
+#error "TRACE_FAULT_ENABLED needs the HardFault handler of CPU_CTRL_XMC1 disabled (HARDFAULT_ENABLED = 0)"
+#endif
+//****************************************************************************
+// trace_fault - records the register frame stacked by a HardFault and resets the device (warm reset keeps the trace)
+// frame: first stacked word (r0, r1, r2, r3, r12, lr, pc, psr), handed over in r0 by HardFault_Handler
+//****************************************************************************
+void trace_fault(const uint32_t *frame) __attribute__((noreturn, used));
+void trace_fault(const uint32_t *frame){
+	trace_fault_t *fault = &trace_buffer.fault;
+	fault->r0 = frame[0];
+	fault->r1 = frame[1];
+	fault->r2 = frame[2];
+	fault->r3 = frame[3];
+	fault->r12 = frame[4];
+	fault->lr = frame[5];
+	fault->pc = frame[6];
+	fault->psr = frame[7];
+	trace_buffer.faults++;
+	trace_record(TRACE_FAULT, 0, (uint16_t)fault->pc);
+	NVIC_SystemReset();
+	for(;;);
+}
+
+//****************************************************************************
+// HardFault_Handler - passes the stacked register frame (MSP or PSP, see EXC_RETURN in LR) to trace_fault as its
+// frame argument in r0 (AAPCS), the far jump goes through r1 (a Thumb b only reaches +-2 KB)
+//****************************************************************************
+__attribute__((naked))
+void HardFault_Handler(void){
+	__asm volatile (
+		" movs r0, #4	\n"		// EXC_RETURN bit 2: frame on the process stack
+		" mov r1, lr	\n"
+		" tst r0, r1	\n"
+		" beq 1f		\n"
+		" mrs r0, psp	\n"		// frame = PSP
+		" b 2f			\n"
+		"1:				\n"
+		" mrs r0, msp	\n"		// frame = MSP
+		"2:				\n"
+		" ldr r1, =trace_fault	\n"
+		" bx r1			\n"		// trace_fault(frame), never returns
+		" .ltorg		\n"
+	);
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ * USB-Changer trace.h
+ *
+ * Crash persistent event trace. A ring buffer of the last TRACE_ENTRIES events (threshold crossings, latch expiries,
+ * relay and USB switches, setup menu and status LED transitions, begin and end of EEPROM writes, state log writes,
+ * watchdog overruns, resets and faults) lives in no-init RAM: it survives warm resets (watchdog,
+ * fault, reset pin) and is continued after the reboot, so the entries before the TRACE_BOOT entry show what led to the
+ * reset. A HardFault stores the stacked register frame in trace_buffer.fault and resets the device. Recording costs a
+ * few stores with interrupts masked, trace_record can be called from main and interrupt context. The us timestamps of
+ * consecutive entries give the latency chain of a switch (e.g. threshold exceeded - latch expired - relay - USB).
+ * telemetry_task sends new entries as TELEMETRY_RECORD_EVENT records.
+ * Read trace_buffer with a debugger (tools/profiler_report.gdb), the oldest entry is at index head once count is full.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRACE_ENABLED				 0							// Determines if events are recorded (0 removes all TRACE calls)
+#define TRACE_FAULT_ENABLED			 0							// Determines if the HardFault handler records the fault frame and resets (CPU_CTRL_XMC1 HARDFAULT_ENABLED must be 0)
+#define TRACE_THRESHOLDS_ENABLED	 0							// Determines if threshold crossings are recorded (ADC interrupt, a noisy signal floods the ring and pushes out the relay and fault events)
+#define TRACE_ENTRIES				 64							// Number of events kept (power of 2)
+#define TRACE_MAGIC					 0x7ACEB0F1U				// Marks a buffer written by this firmware
+#define TRACE_BUFFER_SIZE			 552						// sizeof(trace_buffer_t), reserved in .no_init by the linker script
+
+typedef enum {
+	TRACE_BOOT,				// value: reset reasons (SCU RSTSTAT)
+	TRACE_RELAY,			// arg: sensor channel, value: new relay state
+	TRACE_USB,				// arg: new USB state
+	TRACE_EEPROM_WRITE,		// arg: EEPROM block, value: E_EEPROM_XMC1 operation status
+	TRACE_EEPROM_GC,		// Garbage collection requested by a write (value 0), planned in a quiet period (value 2) or its bank erased (value 1)
+	TRACE_STATELOG_WRITE,	// arg: page, value: entry index (0xFFFF = all attempts failed)
+	TRACE_WATCHDOG,			// arg: subsystem that missed its deadline
+	TRACE_FAULT,			// value: lower half of the stacked PC (full frame in trace_buffer.fault)
+	TRACE_THRESHOLD,		// arg: sensor channel, value: TRACE_THRESHOLD_* flags
+	TRACE_LATCH,			// arg: sensor channel, value: in us. Time the expiry was detected after the latch time (saturated)
+	TRACE_SETUP,			// arg: new setup menu state
+	TRACE_LED,				// arg: pattern stack depth, value: lower half of the pattern address (see the map file)
+	TRACE_EEPROM_BEGIN,		// arg: EEPROM block (the write blocks until its TRACE_EEPROM_WRITE entry)
+	TRACE_WALLCLOCK,		// Wall clock at boot or when set: value bits 0-15, arg bits 16-23 of the Unix time (see wallclock.h)
+	TRACE_FAILOVER,			// arg: new USB state, value: sense channel that lost its device (see failover.h)
+	TRACE_RELAY_LIMIT,		// arg: sensor channel, value: relay state whose due switch the rate limiter holds back
+	TRACE_ADC_READ,			// arg: sensor channel, value: result of a conversion requested by the host (see sensor_request_conversion)
+	TRACE_BULKFLASH_WRITE,	// arg: data page, value: committed length (0xFFFF = page dropped, see bulkflash.h)
+	TRACE_SENSOR_FAULT,		// arg: sensor channel, value: relay_faults of a detected fault (RELAY_FAULT_NONE = fault ended, see relay.h)
+	TRACE_RELAY_TIME,		// arg: 1 = operate, 0 = release, value: in us. Drive edge to contact feedback (0xFFFF = missed, see relaytime.h)
+	TRACE_PROFILE,			// arg: new threshold profile, value: previous profile (see settings.h)
+	TRACE_FLASH_CORRUPT,	// arg: flash block, value: lower half of its address (see flashcheck.h)
+	TRACE_ROLLBACK			// arg: applied settings record (0 = the stored one), value: previous one (see rollback_settings)
+} trace_types;
+
+#define TRACE_THRESHOLD_UPPER		 0x01U						// TRACE_THRESHOLD value: upper threshold (else lower)
+#define TRACE_THRESHOLD_EXCEEDED	 0x02U						// TRACE_THRESHOLD value: exceeded, latch time started (else back inside)
+
+typedef struct {
+	uint32_t time;			// In us. SYSTIMER_GetTime when recorded
+	uint16_t value;
+	uint8_t type;			// trace_types
+	uint8_t arg;
+} trace_entry_t;
+
+typedef struct {
+	uint32_t r0, r1, r2, r3, r12, lr, pc, psr;	// Register frame stacked by the last HardFault
+} trace_fault_t;
+
+typedef struct {
+	uint32_t magic;							// TRACE_MAGIC (anything else: no trace, e.g. after power on)
+	uint8_t head;							// Index the next entry is written to
+	uint8_t count;							// Number of valid entries (up to TRACE_ENTRIES)
+	uint16_t faults;						// Number of HardFaults since power on
+	trace_fault_t fault;
+	trace_entry_t entries[TRACE_ENTRIES];
+} trace_buffer_t;
+
+extern trace_buffer_t trace_buffer;
+
+void trace_init(void);
+void trace_record(trace_types type, uint8_t arg, uint16_t value);
+
+#if TRACE_ENABLED
+	#define TRACE(type, arg, value)		trace_record((type), (uint8_t)(arg), (uint16_t)(value))
+#else
+	#define TRACE(type, arg, value)
+#endif
+
+#endif /* TRACE_H */
@@ -0,0 +1,324 @@
+/*
+ * USB-Changer updater.c
+ *
+ * Resident firmware updater (see updater.h). Everything marked UPDATER_CODE is linked into the section .updater in
+ * front of the application and must not call anything outside of it: no XMCLib or CMSIS functions (the Debug build
+ * does not inline them), no library calls (divisions, memcpy, switch tables in .rodata). It uses no .data or .bss,
+ * the buffers are on the stack at UPDATER_STACK_TOP. The flash is erased and programmed with the routines of the
+ * boot ROM and the NVM registers, the UART is polled (receive FIFO of 16 bytes, the CPU may stall on an instruction
+ * fetch while a block is programmed). Only updater_restart belongs to the application.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_uart.h"
+#include "updater.h"
+#include "bulkflash.h"
+
+// Resident code: own section, never inlined into the application, loops are not turned into memset calls
+#define UPDATER_CODE				 __attribute__((section(".updater"), noinline, optimize("no-tree-loop-distribute-patterns")))
+#define UPDATER_OVERSAMPLING		 16U
+// Fractional divider step (fFD = MCLK * step / 1024, baud = fFD / oversampling)
+#define UPDATER_STEP				 (((UPDATER_BAUDRATE * UPDATER_OVERSAMPLING * 1024ULL) + (UPDATER_MCLK / 2U)) / UPDATER_MCLK)
+#define UPDATER_RX_FIFO_SIZE		 4U							// RBCTR.SIZE of a 16 entry receive FIFO (at DPTR 0, the transmit buffer is used without FIFO)
+#define UPDATER_PASSWD_DISABLE		 192U						// SCU_GENERAL PASSWD: bit protection off
+#define UPDATER_PASSWD_ENABLE		 195U						// SCU_GENERAL PASSWD: bit protection on
+#define UPDATER_ACTION_WRITE_VERIFY	 0x61U						// NVMPROG.ACTION: continuous write with verify (a block is programmed after its 4th word)
+#define UPDATER_CRC_POLY			 0xEDB88320U				// CRC-32 (IEEE, reflected)
+#define UPDATER_PAGE_WORDS			 (UPDATER_PAGE_SIZE / 4U)
+#define UPDATER_BLOCK_WORDS			 (UPDATER_BLOCK_SIZE / 4U)
+#define UPDATER_BLOCKS_PER_PAGE		 (UPDATER_PAGE_SIZE / UPDATER_BLOCK_SIZE)
+#define UPDATER_REQUEST				 (*(volatile uint32_t *)UPDATER_REQUEST_ADDRESS)
+
+typedef char updater_layout_check[(UPDATER_APP_BASE % UPDATER_PAGE_SIZE == 0 && UPDATER_APP_END == BULKFLASH_BASE
+		&& UPDATER_STEP > 0 && UPDATER_STEP <= 1023U && ((UPDATER_CLKVAL1 >> 8) & 0xFFU) != 0U && (UPDATER_CLKVAL1 & 0xFFU) == 0U) ? 1 : -1];
+
+typedef void (*updater_vector_t)(void);
+
+typedef struct {
+	const uint32_t *data;			// Page buffer being programmed (NULL = none)
+	uint32_t *address;				// Flash address of the page
+	uint8_t block;					// Next block to program (UPDATER_BLOCKS_PER_PAGE = all written, verify pending)
+} updater_job_t;
+
+uint32_t updater_request __attribute__((section(".updater_request")));	// UPDATER_REQUEST_MAGIC = update requested (at UPDATER_REQUEST_ADDRESS)
+
+
+//****************************************************************************
+// updater_vectors_valid - returns true if a vector table belongs to an image linked for UPDATER_APP_BASE
+//****************************************************************************
+UPDATER_CODE bool updater_vectors_valid(const uint32_t *vectors){
+	// Erased or partly programmed flash fails: stack pointer in SRAM, reset handler in the application area (Thumb)
+	return vectors[0] > 0x20000000U && vectors[0] <= 0x20004000U && (vectors[0] & 3U) == 0U
+			&& vectors[1] > UPDATER_APP_BASE && vectors[1] < UPDATER_APP_END && (vectors[1] & 1U) != 0U;
+}
+
+//****************************************************************************
+// updater_start_app - continues with the reset handler of the application (its stack pointer, peripherals untouched)
+//****************************************************************************
+UPDATER_CODE void updater_start_app(void){
+	const uint32_t *vectors = (const uint32_t *)UPDATER_APP_BASE;
+	__asm volatile ("msr msp, %0\n\tbx %1" : : "r" (vectors[0]), "r" (vectors[1]));
+	for(;;);
+}
+
+//****************************************************************************
+// updater_system_reset - resets the device (registers only, __NVIC_SystemReset is not resident)
+//****************************************************************************
+UPDATER_CODE void updater_system_reset(void){
+	SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) | SCB_AIRCR_SYSRESETREQ_Msk;
+	__DSB();
+	for(;;);
+}
+
+//****************************************************************************
+// updater_init - sets up USIC0 channel 0 as UART with a receive FIFO and the SysTick as millisecond tick
+//****************************************************************************
+UPDATER_CODE void updater_init(void){
+	SCU_GENERAL->PASSWD = UPDATER_PASSWD_DISABLE;
+	while(SCU_GENERAL->PASSWD & SCU_GENERAL_PASSWD_PROTS_Msk);
+	SCU_CLK->CGATCLR0 = SCU_CLK_CGATCLR0_USIC0_Msk;
+	SCU_GENERAL->PASSWD = UPDATER_PASSWD_ENABLE;
+
+	USIC0_CH0->KSCFG = USIC_CH_KSCFG_MODEN_Msk | USIC_CH_KSCFG_BPMODEN_Msk;
+	while((USIC0_CH0->KSCFG & USIC_CH_KSCFG_MODEN_Msk) == 0U);
+	USIC0_CH0->CCR = 0U;
+	USIC0_CH0->FDR = (2UL << USIC_CH_FDR_DM_Pos) | (uint32_t)UPDATER_STEP;
+	USIC0_CH0->BRG = (UPDATER_OVERSAMPLING - 1U) << USIC_CH_BRG_DCTQ_Pos;
+	USIC0_CH0->SCTR = (7UL << USIC_CH_SCTR_WLE_Pos) | (7UL << USIC_CH_SCTR_FLE_Pos) | (1UL << USIC_CH_SCTR_TRM_Pos) | USIC_CH_SCTR_PDL_Msk;
+	USIC0_CH0->TCSR = (1UL << USIC_CH_TCSR_TDEN_Pos) | USIC_CH_TCSR_TDSSM_Msk;
+	USIC0_CH0->PCR_ASCMode = (((UPDATER_OVERSAMPLING >> 1) + 1U) << USIC_CH_PCR_ASCMode_SP_Pos) | USIC_CH_PCR_ASCMode_SMD_Msk
+			| USIC_CH_PCR_ASCMode_RSTEN_Msk | USIC_CH_PCR_ASCMode_TSTEN_Msk;
+	USIC0_CH0->DX0CR = (uint32_t)USIC0_C0_DX0_P0_15 << USIC_CH_DX0CR_DSEL_Pos;
+	USIC0_CH0->RBCTR = (0UL << USIC_CH_RBCTR_DPTR_Pos) | (UPDATER_RX_FIFO_SIZE << USIC_CH_RBCTR_SIZE_Pos);
+	USIC0_CH0->CCR = 2UL << USIC_CH_CCR_MODE_Pos;		// ASC (UART)
+
+	// TX P0.14 idles high, RX P0.15 is an input after reset
+	XMC_GPIO_PORT0->OMR = 1UL << 14;
+	XMC_GPIO_PORT0->IOCR[3] = (XMC_GPIO_PORT0->IOCR[3] & ~(0xFFUL << 16)) | ((uint32_t)XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT6 << 16);
+
+	SysTick->LOAD = (UPDATER_MCLK / 1000U) - 1U;
+	SysTick->VAL = 0U;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+//****************************************************************************
+// updater_tick - returns true once per millisecond (COUNTFLAG clears on read)
+//****************************************************************************
+UPDATER_CODE bool updater_tick(void){
+	return (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) != 0U;
+}
+
+//****************************************************************************
+// updater_put - sends a reply byte
+//****************************************************************************
+UPDATER_CODE void updater_put(uint8_t data){
+	while(USIC0_CH0->TCSR & USIC_CH_TCSR_TDV_Msk);
+	USIC0_CH0->TBUF[0] = data;
+}
+
+//****************************************************************************
+// updater_drain - waits until the last reply byte left the UART
+//****************************************************************************
+UPDATER_CODE void updater_drain(void){
+	while(USIC0_CH0->TCSR & USIC_CH_TCSR_TDV_Msk);
+	while(USIC0_CH0->PSR_ASCMode & USIC_CH_PSR_ASCMode_BUSY_Msk);
+}
+
+//****************************************************************************
+// updater_received - returns true if a received byte is waiting in the FIFO
+//****************************************************************************
+UPDATER_CODE bool updater_received(void){
+	return (USIC0_CH0->TRBSR & USIC_CH_TRBSR_REMPTY_Msk) == 0U;
+}
+
+//****************************************************************************
+// updater_crc32 - adds a byte to a CRC-32 (start with 0xFFFFFFFF, invert the result)
+//****************************************************************************
+UPDATER_CODE uint32_t updater_crc32(uint32_t crc, uint8_t data){
+	crc ^= data;
+	for(uint8_t bit = 0; bit < 8U; bit++)
+		crc = (crc & 1U) ? ((crc >> 1) ^ UPDATER_CRC_POLY) : (crc >> 1);
+	return crc;
+}
+
+//****************************************************************************
+// updater_step - programs the next block of the job or verifies its page once all blocks are written. Returns false if the page is wrong
+//****************************************************************************
+UPDATER_CODE bool updater_step(updater_job_t *job){
+	if(job->data == NULL || (NVM->NVMSTATUS & NVM_NVMSTATUS_BUSY_Msk))
+		return true;
+	if(job->block < UPDATER_BLOCKS_PER_PAGE){
+		if(job->block == 0U)
+			NVM->NVMPROG = (uint16_t)(NVM_NVMPROG_RSTVERR_Msk | NVM_NVMPROG_RSTECC_Msk | UPDATER_ACTION_WRITE_VERIFY);
+		uint32_t *target = job->address + (job->block * UPDATER_BLOCK_WORDS);
+		const uint32_t *source = job->data + (job->block * UPDATER_BLOCK_WORDS);
+		for(uint8_t word = 0; word < UPDATER_BLOCK_WORDS; word++)
+			target[word] = source[word];
+		job->block++;
+		return true;
+	}
+	// All blocks programmed and the flash is idle again
+	NVM->NVMPROG = (uint16_t)(NVM->NVMPROG & ~NVM_NVMPROG_ACTION_Msk);
+	bool valid = (NVM->NVMSTATUS & NVM_NVMSTATUS_VERR_Msk) == 0U;
+	for(uint8_t word = 0; word < UPDATER_PAGE_WORDS; word++){
+		if(job->address[word] != job->data[word])
+			valid = false;
+	}
+	job->data = NULL;
+	return valid;
+}
+
+//****************************************************************************
+// updater_header - waits for a header. Returns false if it timed out (only while a valid application can be started)
+//****************************************************************************
+UPDATER_CODE bool updater_header(uint32_t *size, uint32_t *crc){
+	bool timeout = updater_vectors_valid((const uint32_t *)UPDATER_APP_BASE);
+	uint32_t magic = 0, elapsed = 0;
+	uint16_t second = 1;
+	uint8_t fields = 0;				// Bytes received after the magic (size, then CRC)
+
+	for(;;){
+		if(updater_tick()){
+			if(--second == 0U){
+				second = 1000U;
+				updater_put(UPDATER_REPLY_WAITING);
+			}
+			if(timeout && ++elapsed >= UPDATER_HEADER_TIMEOUT)
+				return false;
+		}
+		if(!updater_received())
+			continue;
+		uint32_t data = USIC0_CH0->OUTR & 0xFFU;
+		// Little endian fields shifted in from the top, the magic is searched in a sliding window
+		if(magic != UPDATER_MAGIC){
+			magic = (magic >> 8) | (data << 24);
+			continue;
+		}
+		if(fields < 4U)
+			*size = (*size >> 8) | (data << 24);
+		else
+			*crc = (*crc >> 8) | (data << 24);
+		if(++fields == 8U)
+			return true;
+	}
+}
+
+//****************************************************************************
+// updater_receive - erases the pages of the image, receives and programs it and switches to it. Returns false on an error
+//****************************************************************************
+UPDATER_CODE bool updater_receive(uint32_t size, uint32_t crc){
+	uint32_t buffers[2][UPDATER_PAGE_WORDS];
+	uint32_t first[UPDATER_PAGE_WORDS];			// Vector table page, programmed after the CRC check
+	updater_job_t job;
+
+	if(size < 8U || size > UPDATER_APP_END - UPDATER_APP_BASE)
+		return false;
+	// The first page goes first: from here on the old application is no longer started
+	uint32_t pages = (size + UPDATER_PAGE_SIZE - 1U) / UPDATER_PAGE_SIZE;
+	for(uint32_t page = 0; page < pages; page++){
+		if(XMC1000_NvmErasePage((uint32_t *)(UPDATER_APP_BASE + page * UPDATER_PAGE_SIZE)) != NVM_PASS)
+			return false;
+	}
+	updater_put(UPDATER_REPLY_READY);
+
+	uint8_t *fill = (uint8_t *)first;			// Page buffer being received
+	uint32_t received = 0, page = 0, idle = 0;
+	uint16_t position = 0;
+	uint32_t image_crc = 0xFFFFFFFFU;
+	job.data = NULL;
+	while(received < size){
+		// Programming runs in the gaps between the bytes (a page is programmed faster than the next one arrives)
+		if(!updater_step(&job))
+			return false;
+		if(updater_tick() && ++idle >= UPDATER_BYTE_TIMEOUT)
+			return false;
+		if(!updater_received())
+			continue;
+		idle = 0;
+		uint8_t data = (uint8_t)USIC0_CH0->OUTR;
+		image_crc = updater_crc32(image_crc, data);
+		fill[position++] = data;
+		received++;
+		if(position < UPDATER_PAGE_SIZE && received < size)
+			continue;
+
+		// Page complete - the unused rest of the last page stays 0xFF
+		for(; position < UPDATER_PAGE_SIZE; position++)
+			fill[position] = 0xFFU;
+		position = 0;
+		if(page != 0U){
+			// Only waits on a link faster than the flash
+			while(job.data != NULL){
+				if(!updater_step(&job))
+					return false;
+			}
+			job.data = (const uint32_t *)(void *)fill;
+			job.address = (uint32_t *)(UPDATER_APP_BASE + page * UPDATER_PAGE_SIZE);
+			job.block = 0;
+		}
+		fill = (fill == (uint8_t *)buffers[0]) ? (uint8_t *)buffers[1] : (uint8_t *)buffers[0];
+		page++;
+	}
+	while(job.data != NULL){
+		if(!updater_step(&job))
+			return false;
+	}
+
+	// All other pages are verified - the vector table page makes the image valid
+	if(~image_crc != crc || !updater_vectors_valid(first))
+		return false;
+	job.data = first;
+	job.address = (uint32_t *)UPDATER_APP_BASE;
+	job.block = 0;
+	while(job.data != NULL){
+		if(!updater_step(&job))
+			return false;
+	}
+	return true;
+}
+
+//****************************************************************************
+// updater_reset - entry of the boot ROM: starts the application or the updater
+//****************************************************************************
+UPDATER_CODE void updater_reset(void){
+	bool requested = (UPDATER_REQUEST == UPDATER_REQUEST_MAGIC);
+	UPDATER_REQUEST = 0U;
+	if(!requested && updater_vectors_valid((const uint32_t *)UPDATER_APP_BASE))
+		updater_start_app();
+
+	updater_init();
+	for(;;){
+		uint32_t size = 0, crc = 0;
+		// A requested update that never starts returns to the unchanged application
+		if(!updater_header(&size, &crc))
+			updater_system_reset();
+		if(updater_receive(size, crc)){
+			updater_put(UPDATER_REPLY_DONE);
+			updater_drain();
+			updater_system_reset();
+		}
+		updater_put(UPDATER_REPLY_ERROR);
+	}
+}
+
+// Flash header read by the boot ROM at 0x10001000: initial stack pointer, reset vector and the clock words CLK_VAL1 and
+// CLK_VAL2 at 0x10001010 (the application has its own vectors at UPDATER_APP_BASE, the SSW never reads them)
+const updater_vector_t updater_vectors[6] __attribute__((section(".updater_vectors"), used)) = {
+	(updater_vector_t)UPDATER_STACK_TOP,
+	updater_reset,
+	(updater_vector_t)0,
+	(updater_vector_t)0,
+	(updater_vector_t)UPDATER_CLKVAL1,
+	(updater_vector_t)UPDATER_CLKVAL2
+};
+
+//****************************************************************************
+// updater_restart - resets into the updater (application, call after the host got its response)
+//****************************************************************************
+void updater_restart(void){
+	__disable_irq();
+	updater_request = UPDATER_REQUEST_MAGIC;
+	NVIC_SystemReset();
+}
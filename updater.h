@@ -0,0 +1,64 @@
+/*
+ * USB-Changer updater.h
+ *
+ * Resident firmware updater over the telemetry UART (USIC0 channel 0, TX P0.14, RX P0.15, 8N1). The updater is the
+ * first UPDATER_SIZE bytes of the flash (section .updater, the boot ROM starts it from 0x10001000), the application
+ * with its own vector table follows at UPDATER_APP_BASE. The updater is self-contained: no DAVE or XMCLib functions,
+ * no startup code, only registers and the flash routines of the boot ROM, so it keeps working while the application
+ * pages are erased and an update never changes it (an update of the updater itself needs a debugger).
+ * After a reset the updater starts the application unless the application requested an update (updater_restart, host
+ * command HOSTCMD_UPDATE) or the application pages hold no valid image (erased or interrupted update).
+ *
+ * Protocol (multi byte fields little endian, no per-page handshake):
+ *	updater			-> UPDATER_REPLY_WAITING once per second while waiting for a header
+ *	host			-> [UPDATER_MAGIC (4)][size (4)][CRC-32 of the image (4)]
+ *	updater			-> UPDATER_REPLY_READY after the pages for size bytes were erased (UPDATER_REPLY_ERROR for a bad size)
+ *	host			-> the image: the bytes of the binary from UPDATER_APP_BASE on, streamed without pauses
+ *	updater			-> UPDATER_REPLY_DONE before the reset into the new application or UPDATER_REPLY_ERROR (waits for a new header)
+ * The image is received into two page buffers: while one fills, the other is programmed block by block between the
+ * received bytes, so the throughput is the link speed (programming a page takes less than receiving one). The first
+ * page holds the vector table of the application, it is erased before all other pages and programmed last, after the
+ * CRC-32 (IEEE, as zlib.crc32) over the received image and the programmed flash matched. The switch to the new image
+ * is this single page: a power loss before it leaves no valid image and the updater waits for the next attempt.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef UPDATER_H
+#define UPDATER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UPDATER_SIZE				 0x800U						// In bytes. Flash of the updater (updater_size in the linker script must match)
+#define UPDATER_APP_BASE			 (0x10001000U + UPDATER_SIZE)	// Vector table of the application
+#define UPDATER_APP_END				 0x10008000U				// First address above the application area (bulk flash region, see bulkflash.h)
+#define UPDATER_PAGE_SIZE			 256U						// In bytes. XMC1 flash page (erase unit)
+#define UPDATER_BLOCK_SIZE			 16U						// In bytes. XMC1 flash block (write unit)
+// Clock words of the flash header the boot ROM (SSW) reads at 0x10001010 and 0x10001014 (updater_vectors). The
+// application's copies in its vector table (CLKVAL1_SSW, CLKVAL2_SSW in Startup/startup_XMC1100.S) are never read.
+#ifdef SSW_CLOCK_8MHZ
+#define UPDATER_CLKVAL1				 0x00010400U				// IDIV 4: MCLK = 8MHz, PCLK = 2 x MCLK (vendor default)
+#else
+#define UPDATER_CLKVAL1				 0x00010100U				// IDIV 1: MCLK = 32MHz, PCLK = 2 x MCLK (same dividers as CLOCK_XMC1)
+#endif
+#define UPDATER_CLKVAL2				 0x80000000U				// Clock gating left to the application
+#define UPDATER_MCLK				 (32000000U / ((UPDATER_CLKVAL1 >> 8) & 0xFFU))	// In Hz. MCLK set by the SSW from UPDATER_CLKVAL1 (FDIV 0, the updater runs before SystemInit)
+#define UPDATER_BAUDRATE			 115200U					// In baud (up to UPDATER_MCLK / 16)
+#define UPDATER_STACK_TOP			 0x20003000U				// Initial stack pointer of the updater (below the .no_init records)
+#define UPDATER_REQUEST_ADDRESS		 0x20003FFCU				// Last SRAM word, kept through the reset into the updater (reserved by the linker script)
+#define UPDATER_REQUEST_MAGIC		 0x55504452U				// updater_request value of a requested update
+#define UPDATER_MAGIC				 0x31445055U				// "UPD1", start of the header
+#define UPDATER_HEADER_TIMEOUT		 10000						// In ms. Wait for a header after a requested update before the valid application is started again
+#define UPDATER_BYTE_TIMEOUT		 1000						// In ms. Longest pause within the image before the update fails
+
+typedef enum {
+	UPDATER_REPLY_WAITING = 'W',
+	UPDATER_REPLY_READY = 'R',
+	UPDATER_REPLY_DONE = 'K',
+	UPDATER_REPLY_ERROR = 'E'
+} updater_replies;
+
+void updater_restart(void);
+
+#endif /* UPDATER_H */
@@ -0,0 +1,138 @@
+/*
+ * USB-Changer usbswitch.c
+ *
+ * USB port switchover (see usbswitch.h).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "usbswitch.h"
+#include "profiler.h"
+#include "trace.h"
+#include "metrics.h"
+
+// Port descriptors of the board (index = USB_states). A variant with more ports adds a row per port and the select lines of its muxes
+const usb_port_t usb_ports[USB_PORT_COUNT] = {
+	{.power = &IO_USBPWR_1, .led = &IO_LED_USB1, .select = 0U, .next = USB_2_active, .sense = USB_SENSE_NONE},		// USB_1_active
+	{.power = &IO_USBPWR_2, .led = &IO_LED_USB2, .select = 1U, .next = USB_1_active, .sense = USB_SENSE_NONE}		// USB_2_active
+};
+const DIGITAL_IO_t *const usb_select_lines[USB_SELECT_LINES] = {&IO_USB_SI};
+const DIGITAL_IO_t *const usb_enable_line = &IO_USB_OE;
+usb_switch_t usb_switch[USB_PORT_COUNT + 1];	// Port writes of a switch to every port and to USB_inactive (built by usb_switch_init)
+USB_states usb_last_port = USB_1_active;	// Port that was active last (resumed from USB_inactive)
+uint8_t usb_switch_overflows = 0;			// Switchover targets whose port writes exceed USB_SWITCH_WRITES (not switched to)
+METRICS_REGISTER(usb_switch_overflows, METRICS_ID_USB_SWITCH_OVERFLOWS, METRICS_TYPE_U8, METRICS_UNIT_COUNT, usb_switch_overflows);
+
+
+//****************************************************************************
+// usb_switch_add - adds a pin level to the port writes of a USB switchover (merged into an earlier write where the phase allows it). Returns false if all USB_SWITCH_WRITES are taken
+//****************************************************************************
+bool usb_switch_add(usb_switch_t *sw, const DIGITAL_IO_t *io, bool high, usb_pin_phases phase){
+	uint32_t omr = high ? ((uint32_t)1U << io->gpio_pin) : ((uint32_t)0x10000U << io->gpio_pin);
+	int8_t index = -1;
+
+	if(phase == USB_PIN_BREAK){ // Old power off is written before everything else
+		for(uint8_t i = 0; i < sw->break_count; i++)
+			if(sw->write[i].port == io->gpio_port)
+				index = i;
+	}
+	else if(phase == USB_PIN_SWITCH){ // Mux and indicators may change together with the old power
+		for(uint8_t i = 0; i < sw->count; i++)
+			if(sw->write[i].port == io->gpio_port)
+				index = i;
+	}
+	else{ // New power on only together with or after the last mux/indicator write, never with the old power
+		if(sw->count > sw->break_count && sw->write[sw->count - 1].port == io->gpio_port)
+			index = sw->count - 1;
+	}
+
+	if(index < 0){
+		if(sw->count >= USB_SWITCH_WRITES)
+			return false;
+		index = sw->count++;
+		sw->write[index].port = io->gpio_port;
+		sw->write[index].omr = 0;
+		if(phase == USB_PIN_BREAK)
+			sw->break_count = sw->count;
+	}
+	sw->write[index].omr |= omr;
+	return true;
+}
+
+//****************************************************************************
+// usb_switch_check - drops the port writes of a switchover that lost a pin level (usb_switch_add returned false)
+//****************************************************************************
+void usb_switch_check(usb_switch_t *sw, bool complete){
+	if(complete)
+		return;
+	sw->count = sw->break_count = 0;
+	usb_switch_overflows++;
+}
+
+//****************************************************************************
+// usb_switch_init - precomputes the port writes of the USB switchovers to every port and to USB_inactive from the port descriptors
+//****************************************************************************
+void usb_switch_init(void){
+	bool complete;
+
+	usb_switch_overflows = 0;
+	for(uint8_t target = 0; target < USB_PORT_COUNT; target++){
+		usb_switch_t *sw = &usb_switch[target];
+		const usb_port_t *port = &usb_ports[target];
+		sw->count = sw->break_count = 0;
+		complete = true;
+		for(uint8_t i = 0; i < USB_PORT_COUNT; i++){
+			if(i != target)
+				complete &= usb_switch_add(sw, usb_ports[i].power, false, USB_PIN_BREAK);
+		}
+		for(uint8_t line = 0; line < USB_SELECT_LINES; line++)
+			complete &= usb_switch_add(sw, usb_select_lines[line], (port->select & (1U << line)) != 0, USB_PIN_SWITCH);
+		complete &= usb_switch_add(sw, usb_enable_line, !USB_ENABLE_ACTIVE_LOW, USB_PIN_SWITCH);
+		complete &= usb_switch_add(sw, port->led, !USB_LED_ACTIVE_LOW, USB_PIN_SWITCH);
+		for(uint8_t i = 0; i < USB_PORT_COUNT; i++){
+			if(i != target)
+				complete &= usb_switch_add(sw, usb_ports[i].led, USB_LED_ACTIVE_LOW, USB_PIN_SWITCH);
+		}
+		complete &= usb_switch_add(sw, port->power, true, USB_PIN_MAKE);
+		usb_switch_check(sw, complete);
+	}
+
+	// Standby: every port powered off before the mux is disabled and the indicators are turned off, select lines are kept
+	usb_switch_t *sw = &usb_switch[USB_inactive];
+	sw->count = sw->break_count = 0;
+	complete = true;
+	for(uint8_t i = 0; i < USB_PORT_COUNT; i++)
+		complete &= usb_switch_add(sw, usb_ports[i].power, false, USB_PIN_BREAK);
+	complete &= usb_switch_add(sw, usb_enable_line, USB_ENABLE_ACTIVE_LOW, USB_PIN_SWITCH);
+	for(uint8_t i = 0; i < USB_PORT_COUNT; i++)
+		complete &= usb_switch_add(sw, usb_ports[i].led, USB_LED_ACTIVE_LOW, USB_PIN_SWITCH);
+	usb_switch_check(sw, complete);
+}
+
+//****************************************************************************
+// switchUSB - switches mux, power and indicators to a USB port or to USB_inactive (one Pn_OMR write per port and phase, old power off first)
+//****************************************************************************
+void switchUSB(USB_states state)
+{
+	// A switchover without port writes overflowed USB_SWITCH_WRITES (usb_switch_check)
+	if(state <= USB_inactive && usb_switch[state].count != 0){
+		const usb_switch_t *sw = &usb_switch[state];
+		PROFILER_START(writes_start);
+		for(uint8_t i = 0; i < sw->count; i++)
+			USB_SWITCH_PORT_WRITE(sw->write[i].port, sw->write[i].omr);
+		PROFILER_STOP(PROFILER_USB_WRITES, writes_start);
+		TRACE(TRACE_USB, state, 0);
+		if(state != USB_inactive)
+			usb_last_port = state;
+	}
+}
+
+//****************************************************************************
+// usb_next_port - returns the port the USB button switches to from a port (the last active one from USB_inactive)
+//****************************************************************************
+USB_states usb_next_port(USB_states state){
+	if(state >= USB_PORT_COUNT)
+		return usb_last_port;
+	return (USB_states)usb_ports[state].next;
+}
@@ -0,0 +1,74 @@
+/*
+ * USB-Changer usbswitch.h
+ *
+ * USB port switchover for USB_PORT_COUNT ports. Every port is described by a row of usb_ports: its power switch, its
+ * indicator LED, the code the mux select lines (usb_select_lines, bit n drives line n) carry while it is active, so
+ * one multi-channel mux or cascaded 2:1 muxes can be driven, the port the USB button switches to next (O(1)) and the
+ * sensor channel that senses its VBUS or load current (automatic failover, see failover.h).
+ * The pin levels of the switchover to every port (all other ports powered off, mux and indicators, new power on) are
+ * precomputed from the table into a few Pn_OMR writes each (usb_switch_init), so switchUSB only copies them to the
+ * ports in a fixed order and the old port is always powered off before the new one is powered on.
+ * USB_inactive is the standby of the switch: all ports are powered off, the mux is disabled by its output enable and
+ * all indicators are off (precomputed like a port, so a switch back only enables the mux together with the indicators).
+ * usb_last_port keeps the port that was active last, usb_next_port resumes it from standby.
+ * With PROFILER_ENABLED the duration of the port writes is recorded in PROFILER_USB_WRITES.
+ * A port table that needs more than USB_SWITCH_WRITES writes for a switchover cannot be switched to that target: its
+ * writes are dropped (a partial list could power the new port before the old one is off), switchUSB leaves the pins
+ * as they are and usb_switch_overflows counts the targets (metric METRICS_ID_USB_SWITCH_OVERFLOWS).
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef USBSWITCH_H
+#define USBSWITCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "DIGITAL_IO/digital_io.h"
+
+#define USB_PORT_COUNT				 2							// Number of switched USB ports (rows of usb_ports)
+#define USB_SELECT_LINES			 1							// Number of mux select lines (usb_select_lines)
+#define USB_LED_ACTIVE_LOW			 1							// Determines if the port indicators are lit by a low level
+#define USB_ENABLE_ACTIVE_LOW		 1							// Determines if the mux output enable (usb_enable_line) enables it by a low level
+#define USB_SENSE_NONE				 0xFFU						// sense of a port without a VBUS/current sense channel
+#define USB_SWITCH_WRITES			 4							// Maximum number of port register writes of one USB switchover (one per GPIO port for power off, mux and indicators, 3 GPIO ports, plus the power on)
+
+#ifndef USB_SWITCH_PORT_WRITE
+	#define USB_SWITCH_PORT_WRITE(port, omr)	((port)->OMR = (omr))	// Port write of a switchover (the host build records every write)
+#endif
+
+typedef enum {USB_1_active, USB_2_active, USB_inactive = USB_PORT_COUNT} USB_states; // Index of the active port (USB_1_active, USB_2_active, ... up to USB_PORT_COUNT - 1) or none
+typedef enum {USB_PIN_BREAK, USB_PIN_SWITCH, USB_PIN_MAKE} usb_pin_phases; // Old power off, mux and indicators, new power on (none for USB_inactive)
+
+typedef struct {
+	XMC_GPIO_PORT_t *port;
+	uint32_t omr;				// Pn_OMR value (set bits in the lower, reset bits in the upper half word)
+} port_write_t;
+
+typedef struct {
+	const DIGITAL_IO_t *power;	// Power switch of the port (high = powered)
+	const DIGITAL_IO_t *led;	// Indicator of the port (lit while it is active, see USB_LED_ACTIVE_LOW, dimmed by softpwm.h)
+	uint8_t select;				// Level of the mux select lines while the port is active (bit n = usb_select_lines[n])
+	uint8_t next;				// Port the USB button switches to from this one (USB_states)
+	uint8_t sense;				// Sensor channel of the VBUS/current sense of the port (USB_SENSE_NONE = none, see failover.h)
+} usb_port_t;
+
+typedef struct {
+	uint8_t count;				// Number of port writes
+	uint8_t break_count;		// Number of leading port writes that hold USB_PIN_BREAK pins
+	port_write_t write[USB_SWITCH_WRITES];
+} usb_switch_t;
+
+extern const usb_port_t usb_ports[USB_PORT_COUNT];
+extern const DIGITAL_IO_t *const usb_select_lines[USB_SELECT_LINES];
+extern const DIGITAL_IO_t *const usb_enable_line;
+extern usb_switch_t usb_switch[USB_PORT_COUNT + 1];
+extern USB_states usb_last_port;
+extern uint8_t usb_switch_overflows;
+
+bool usb_switch_add(usb_switch_t *sw, const DIGITAL_IO_t *io, bool high, usb_pin_phases phase);
+void usb_switch_init(void);
+void switchUSB(USB_states state);
+USB_states usb_next_port(USB_states state);
+
+#endif /* USBSWITCH_H */
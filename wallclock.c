@@ -0,0 +1,170 @@
+/*
+ * USB-Changer wallclock.c
+ *
+ * Wall clock on the RTC (see wallclock.h). The RTC counts in calendar fields (0 based days and months), Unix seconds are
+ * converted with the days from civil algorithm (no newlib time functions, no table). Register writes pass the serial
+ * interface of the RTC, the XMC_RTC functions wait for it.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_rtc.h"
+#include "wallclock.h"
+#include "trace.h"
+
+#define WALLCLOCK_SECONDS_PER_DAY	 86400U
+
+wallclock_callback_t wallclock_alarm_callback = NULL;
+uint32_t wallclock_alarm = 0;		// Unix time of the alarm (0 = none)
+
+
+//****************************************************************************
+// wallclock_days_from_civil - returns the days since 1970-01-01 of a date (month 1 to 12, day 1 to 31)
+//****************************************************************************
+uint32_t wallclock_days_from_civil(uint32_t year, uint32_t month, uint32_t day){
+	// Years start in March, so the leap day is the last day of a year
+	year -= (month <= 2U) ? 1U : 0U;
+	uint32_t era = year / 400U;
+	uint32_t year_of_era = year - era * 400U;
+	uint32_t day_of_year = (153U * ((month > 2U) ? (month - 3U) : (month + 9U)) + 2U) / 5U + day - 1U;
+	uint32_t day_of_era = year_of_era * 365U + year_of_era / 4U - year_of_era / 100U + day_of_year;
+	return era * 146097U + day_of_era - 719468U;
+}
+
+//****************************************************************************
+// wallclock_civil_from_days - converts days since 1970-01-01 into a date (month 1 to 12, day 1 to 31)
+//****************************************************************************
+void wallclock_civil_from_days(uint32_t days, uint32_t *year, uint32_t *month, uint32_t *day){
+	days += 719468U;
+	uint32_t era = days / 146097U;
+	uint32_t day_of_era = days - era * 146097U;
+	uint32_t year_of_era = (day_of_era - day_of_era / 1460U + day_of_era / 36524U - day_of_era / 146096U) / 365U;
+	uint32_t day_of_year = day_of_era - (365U * year_of_era + year_of_era / 4U - year_of_era / 100U);
+	uint32_t mp = (5U * day_of_year + 2U) / 153U;
+	*day = day_of_year - (153U * mp + 2U) / 5U + 1U;
+	*month = (mp < 10U) ? (mp + 3U) : (mp - 9U);
+	*year = year_of_era + era * 400U + ((*month <= 2U) ? 1U : 0U);
+}
+
+//****************************************************************************
+// wallclock_to_rtc - converts Unix seconds into the RTC fields
+//****************************************************************************
+void wallclock_to_rtc(uint32_t time, XMC_RTC_TIME_t *rtc){
+	uint32_t days = time / WALLCLOCK_SECONDS_PER_DAY;
+	uint32_t seconds = time - days * WALLCLOCK_SECONDS_PER_DAY;
+	uint32_t year, month, day;
+	wallclock_civil_from_days(days, &year, &month, &day);
+	rtc->raw0 = 0;
+	rtc->raw1 = 0;
+	rtc->seconds = seconds % 60U;
+	rtc->minutes = (seconds / 60U) % 60U;
+	rtc->hours = seconds / 3600U;
+	rtc->days = day - 1U;
+	rtc->daysofweek = (days + 4U) % 7U; // 1970-01-01 was a Thursday (0 = Sunday)
+	rtc->month = month - 1U;
+	rtc->year = year;
+}
+
+//****************************************************************************
+// wallclock_alarm_handler - RTC alarm event (SCU interrupt context)
+//****************************************************************************
+void wallclock_alarm_handler(void){
+	XMC_RTC_ClearEvent(XMC_RTC_EVENT_ALARM);
+	XMC_RTC_DisableEvent(XMC_RTC_EVENT_ALARM);
+	wallclock_alarm = 0;
+	if(wallclock_alarm_callback != NULL)
+		wallclock_alarm_callback();
+}
+
+//****************************************************************************
+// wallclock_init - starts the RTC (keeps it running after a warm reset) and registers the alarm callback (call after power_init and supply_init)
+//****************************************************************************
+void wallclock_init(wallclock_callback_t alarm_callback){
+	wallclock_alarm_callback = alarm_callback;
+#if WALLCLOCK_ENABLED
+	// Year 0 until set
+	const XMC_RTC_CONFIG_t rtc_config = {.prescaler = WALLCLOCK_PRESCALER};
+	XMC_RTC_Init(&rtc_config);
+	XMC_RTC_DisableEvent(XMC_RTC_EVENT_ALARM);
+	XMC_RTC_ClearEvent(XMC_RTC_EVENT_ALARM);
+	XMC_RTC_Start();
+
+	// The alarm is an SR1 event like the supply pre-warning (supply.c serves the interrupt)
+	XMC_SCU_INTERRUPT_SetEventHandler(XMC_SCU_INTERRUPT_EVENT_RTC_ALARM, wallclock_alarm_handler);
+	XMC_SCU_INTERRUPT_EnableEvent(XMC_SCU_INTERRUPT_EVENT_RTC_ALARM);
+
+	uint32_t time = wallclock_get();
+	if(time != 0)
+		TRACE(TRACE_WALLCLOCK, time >> 16, time);
+#endif
+}
+
+//****************************************************************************
+// wallclock_get - returns the Unix time (0 = clock not set)
+//****************************************************************************
+uint32_t wallclock_get(void){
+#if WALLCLOCK_ENABLED
+	// TIM0 and TIM1 are read one after the other - read again if the seconds moved on in between
+	XMC_RTC_TIME_t rtc;
+	uint32_t raw0;
+	do{
+		XMC_RTC_GetTime(&rtc);
+		raw0 = RTC->TIM0;
+	}while(raw0 != rtc.raw0);
+	if(rtc.year < WALLCLOCK_YEAR_MIN)
+		return 0;
+	uint32_t days = wallclock_days_from_civil(rtc.year, rtc.month + 1U, rtc.days + 1U);
+	return days * WALLCLOCK_SECONDS_PER_DAY + rtc.hours * 3600U + rtc.minutes * 60U + rtc.seconds;
+#else
+	return 0;
+#endif
+}
+
+//****************************************************************************
+// wallclock_set - sets the Unix time (main context)
+//****************************************************************************
+void wallclock_set(uint32_t time){
+#if WALLCLOCK_ENABLED
+	XMC_RTC_TIME_t rtc;
+	wallclock_to_rtc(time, &rtc);
+	XMC_RTC_Stop();
+	XMC_RTC_SetTime(&rtc);
+	XMC_RTC_Start();
+	TRACE(TRACE_WALLCLOCK, time >> 16, time);
+#else
+	(void)time;
+#endif
+}
+
+//****************************************************************************
+// wallclock_set_alarm - runs the alarm callback at a Unix time (0 = cancel). Returns false if the time is not in the future
+//****************************************************************************
+bool wallclock_set_alarm(uint32_t time){
+	XMC_RTC_DisableEvent(XMC_RTC_EVENT_ALARM);
+	XMC_RTC_ClearEvent(XMC_RTC_EVENT_ALARM);
+	wallclock_alarm = 0;
+	if(time == 0)
+		return true;
+	uint32_t now = wallclock_get();
+	if(now == 0 || time <= now)
+		return false;
+
+	// The alarm compares all fields except the day of the week
+	XMC_RTC_TIME_t rtc;
+	wallclock_to_rtc(time, &rtc);
+	XMC_RTC_ALARM_t alarm;
+	alarm.raw0 = rtc.raw0;
+	alarm.raw1 = rtc.raw1 & ~(uint32_t)RTC_TIM1_DAWE_Msk;
+	XMC_RTC_SetAlarm(&alarm);
+	wallclock_alarm = time;
+	XMC_RTC_EnableEvent(XMC_RTC_EVENT_ALARM);
+	return true;
+}
+
+//****************************************************************************
+// wallclock_get_alarm - returns the Unix time of the pending alarm (0 = none)
+//****************************************************************************
+uint32_t wallclock_get_alarm(void){
+	return wallclock_alarm;
+}
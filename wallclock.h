@@ -0,0 +1,32 @@
+/*
+ * USB-Changer wallclock.h
+ *
+ * Wall clock time on the RTC (1 Hz from the 32.768 kHz standby clock). The RTC keeps running through warm resets, so
+ * SYSTIMER times restart at 0 after a reset but the wall clock does not. Times are Unix seconds (UTC), 0 = not set:
+ * the clock is invalid after power on until the host sets it (HOSTCMD_SETTING_WALLCLOCK).
+ * Every set and every boot with a valid clock records a TRACE_WALLCLOCK entry, which maps the us times of the trace
+ * entries around it to wall clock time. One alarm can be set, it is an SCU event: it wakes the CPU from any sleep state
+ * and runs the callback given to wallclock_init in interrupt context.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef WALLCLOCK_H
+#define WALLCLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WALLCLOCK_ENABLED			 0							// Determines if the RTC runs (0 = RTC clock gated, wallclock_get returns 0)
+#define WALLCLOCK_PRESCALER			 0x7FFFU					// RTC prescaler (32768 Hz standby clock / (prescaler + 1) = 1 Hz)
+#define WALLCLOCK_YEAR_MIN			 2024U						// An RTC date before this year is an unset clock (the RTC starts at year 0 after power on)
+
+typedef void (*wallclock_callback_t)(void);
+
+void wallclock_init(wallclock_callback_t alarm_callback);
+uint32_t wallclock_get(void);
+void wallclock_set(uint32_t time);
+bool wallclock_set_alarm(uint32_t time);
+uint32_t wallclock_get_alarm(void);
+
+#endif /* WALLCLOCK_H */
@@ -0,0 +1,148 @@
+/*
+ * USB-Changer watchdog.c
+ *
+ * Supervised main loop on the XMC WDT (see watchdog.h). Check-ins and the service come from main context only (main
+ * loop and scheduler tasks), so no locking is needed. A missed deadline is counted once when it is detected, either
+ * by watchdog_service or by a late check-in, the check-in then records how late it came.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "xmc_wdt.h"
+#include "watchdog.h"
+#include "timing.h"
+#include "trace.h"
+
+typedef char watchdog_record_size_check[(sizeof(watchdog_record_t) == WATCHDOG_RECORD_SIZE) ? 1 : -1];
+// The held pass still has to reach watchdog_service before the WDT expires
+typedef char watchdog_hold_check[(WATCHDOG_FLASH_HOLD + WATCHDOG_LOOP_DEADLINE < WATCHDOG_TIMEOUT) ? 1 : -1];
+
+const uint16_t watchdog_deadline_ms[WATCHDOG_COUNT] = {WATCHDOG_LOOP_DEADLINE, WATCHDOG_UI_DEADLINE, WATCHDOG_SENSOR_DEADLINE};
+
+watchdog_stat_t watchdog_stats[WATCHDOG_COUNT];
+watchdog_record_t watchdog_record __attribute__((section(".no_init")));
+uint8_t watchdog_reset_culprit = WATCHDOG_NONE;
+uint32_t watchdog_deadline[WATCHDOG_COUNT];		// In us. Time the next check-in is due
+bool watchdog_overdue[WATCHDOG_COUNT];			// The current deadline was missed and counted
+
+
+//****************************************************************************
+// watchdog_check - counts a missed deadline once, returns true if the subsystem is overdue
+//****************************************************************************
+bool watchdog_check(uint8_t id, uint32_t now){
+	if(!timing_reached(now, watchdog_deadline[id]))
+		return false;
+
+	if(!watchdog_overdue[id]){
+		watchdog_overdue[id] = true;
+		watchdog_stats[id].overruns++;
+		watchdog_stats[id].last_overrun = now;
+		watchdog_record.overruns[id]++;
+		if(watchdog_record.culprit == WATCHDOG_NONE)
+			watchdog_record.culprit = id;
+		TRACE(TRACE_WATCHDOG, id, 0);
+	}
+	return true;
+}
+
+//****************************************************************************
+// watchdog_init - takes the record of the last reset over, arms all deadlines and starts the WDT (main loop start)
+//****************************************************************************
+void watchdog_init(void){
+	// RSTSTAT accumulates the reasons until cleared
+	bool wdt_reset = (XMC_SCU_RESET_GetDeviceResetReason() & XMC_SCU_RESET_REASON_WATCHDOG) != 0;
+	XMC_SCU_RESET_ClearDeviceResetReason();
+
+	if(watchdog_record.magic != WATCHDOG_RECORD_MAGIC){
+		watchdog_record.magic = WATCHDOG_RECORD_MAGIC;
+		watchdog_record.resets = 0;
+		for(uint8_t i = 0; i < WATCHDOG_COUNT; i++)
+			watchdog_record.overruns[i] = 0;
+		watchdog_record.culprit = WATCHDOG_NONE;
+		wdt_reset = false;
+	}
+	if(wdt_reset){
+		watchdog_record.resets++;
+		watchdog_reset_culprit = watchdog_record.culprit;
+	}
+	watchdog_record.culprit = WATCHDOG_NONE;
+	watchdog_record.reserved = 0;
+
+	// A subsystem that never checks in is caught as well
+	uint32_t now = SYSTIMER_GetTime();
+	for(uint8_t i = 0; i < WATCHDOG_COUNT; i++){
+		watchdog_deadline[i] = timing_deadline(now, watchdog_deadline_ms[i]);
+		watchdog_overdue[i] = false;
+	}
+
+#if WATCHDOG_ENABLED
+	// Timeout mode (reset at the upper bound), no window, paused while the debugger halts the core
+	XMC_WDT_CONFIG_t config = {
+		.window_upper_bound = (WATCHDOG_TIMEOUT * WATCHDOG_CLOCK) / 1000U,
+		.window_lower_bound = 0U
+	};
+	config.prewarn_mode = 0U;
+	config.run_in_debug_mode = 0U;
+	config.service_pulse_width = 0U;
+	XMC_WDT_Init(&config);
+	XMC_WDT_Start();
+#endif
+}
+
+//****************************************************************************
+// watchdog_checkin - a subsystem reports progress, its next check-in is due within its deadline (main context)
+//****************************************************************************
+void watchdog_checkin(watchdog_subsystems id){
+	uint32_t now = SYSTIMER_GetTime();
+	if(watchdog_check(id, now)){
+		uint32_t late = now - watchdog_deadline[id];
+		if(late > watchdog_stats[id].late_max)
+			watchdog_stats[id].late_max = late;
+		watchdog_overdue[id] = false;
+	}
+	watchdog_deadline[id] = timing_deadline(now, watchdog_deadline_ms[id]);
+}
+
+//****************************************************************************
+// watchdog_on_time - returns true if no subsystem missed its deadline at now (counts the missed ones)
+//****************************************************************************
+bool watchdog_on_time(uint32_t now){
+	bool on_time = true;
+	for(uint8_t i = 0; i < WATCHDOG_COUNT; i++){
+		if(watchdog_check(i, now))
+			on_time = false;
+	}
+	return on_time;
+}
+
+//****************************************************************************
+// watchdog_service - services the WDT if all subsystems are on time (once per main loop pass)
+//****************************************************************************
+void watchdog_service(void){
+	bool on_time = watchdog_on_time(SYSTIMER_GetTime());
+#if WATCHDOG_ENABLED
+	if(on_time)
+		XMC_WDT_Service();
+#else
+	(void)on_time;
+#endif
+}
+
+//****************************************************************************
+// watchdog_hold - gives a blocking operation of up to time ms (main context, right before it): services the WDT and
+//                 moves every deadline that is due earlier out to its end, if all subsystems are on time
+//****************************************************************************
+void watchdog_hold(uint16_t time){
+	uint32_t now = SYSTIMER_GetTime();
+	if(!watchdog_on_time(now))
+		return;
+	uint32_t end = timing_deadline(now, time);
+	for(uint8_t i = 0; i < WATCHDOG_COUNT; i++){
+		if(timing_reached(end, watchdog_deadline[i]))
+			watchdog_deadline[i] = end;
+	}
+#if WATCHDOG_ENABLED
+	XMC_WDT_Service();
+#endif
+}
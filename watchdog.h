@@ -0,0 +1,64 @@
+/*
+ * USB-Changer watchdog.h
+ *
+ * Supervised main loop on the XMC WDT. Every supervised subsystem checks in with watchdog_checkin and must check in
+ * again within its deadline. watchdog_service runs once per main loop pass and services the WDT only while all
+ * subsystems are on time, so a wedged loop or a subsystem that stopped checking in resets the device after
+ * WATCHDOG_TIMEOUT. Overruns are counted per subsystem; the counters in watchdog_record live in no-init RAM and
+ * survive the reset, watchdog_reset_culprit shows which subsystem was overdue first before the last WDT reset.
+ * A blocking flash step (EEPROM write or bank erase, state log, factory block, bulk flash page) can keep the main loop
+ * longer than its deadline: watchdog_hold services the WDT right before it and moves all deadlines out by the longest
+ * step, but only while every subsystem is on time, so a wedged loop still resets the device.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WATCHDOG_ENABLED			 1							// Determines if the WDT is started (0 = deadlines are only supervised and counted)
+#define WATCHDOG_TIMEOUT			 250						// In ms. Time without service until the WDT resets the device
+#define WATCHDOG_CLOCK				 32768U						// In Hz. WDT clock (fWDT = standby clock, independent of clockscale)
+#define WATCHDOG_LOOP_DEADLINE		 50							// In ms. Longest main loop pass distance (the UI task wakes the loop every UI_TASK_PERIOD, a flash write blocks it)
+#define WATCHDOG_UI_DEADLINE		 50							// In ms. Longest distance of two UI task runs
+#define WATCHDOG_SENSOR_DEADLINE	 1000						// In ms. Longest time without ADC results (sensor_check_health restarts the scan after SENSOR_WATCHDOG_TIMEOUT)
+#define WATCHDOG_FLASH_HOLD			 150						// In ms. Longest blocking flash step (garbage collection step with the erase of an EEPROM bank), added by watchdog_hold
+#define WATCHDOG_RECORD_MAGIC		 0xD06D06D0U				// Marks a record written by this firmware
+#define WATCHDOG_RECORD_SIZE		 20							// sizeof(watchdog_record_t), reserved in .no_init by the linker script
+
+typedef enum {
+	WATCHDOG_LOOP,			// Main loop pass
+	WATCHDOG_UI,			// UI task (buttons and setup menu)
+	WATCHDOG_SENSOR,		// ADC results arrive (checked by sensor_check_health)
+	WATCHDOG_COUNT
+} watchdog_subsystems;
+
+#define WATCHDOG_NONE				 0xFFU						// No subsystem
+
+typedef struct {
+	uint32_t overruns;		// Number of missed deadlines
+	uint32_t last_overrun;	// In us. Time the last missed deadline was detected (SYSTIMER_GetTime)
+	uint32_t late_max;		// In us. Longest time a check-in came after its deadline
+} watchdog_stat_t;
+
+typedef struct {
+	uint32_t magic;							// WATCHDOG_RECORD_MAGIC (anything else: no record, e.g. after power on)
+	uint16_t resets;						// Number of WDT resets
+	uint8_t culprit;						// Subsystem that missed its deadline first since the last reset (WATCHDOG_NONE = none)
+	uint8_t reserved;
+	uint32_t overruns[WATCHDOG_COUNT];		// Missed deadlines per subsystem over all resets
+} watchdog_record_t;
+
+extern watchdog_stat_t watchdog_stats[WATCHDOG_COUNT];
+extern watchdog_record_t watchdog_record;
+extern uint8_t watchdog_reset_culprit;		// Subsystem that was overdue first before the last WDT reset (WATCHDOG_NONE = no WDT reset)
+
+void watchdog_init(void);
+void watchdog_checkin(watchdog_subsystems id);
+void watchdog_service(void);
+void watchdog_hold(uint16_t time);
+
+#endif /* WATCHDOG_H */
@@ -0,0 +1,194 @@
+/*
+ * USB-Changer zerocross.c
+ *
+ * Zero cross synchronised relay switching (see zerocross.h). The scheduled change is shared by zerocross_schedule (any
+ * context), the detector interrupt and the hrtimer callback and changed with all interrupts masked. zerocross_cancel
+ * may come from an interrupt that preempts the main context, so it only drops the target: the timer still expires
+ * and finds nothing to drive.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#include "DAVE.h"
+#include "zerocross.h"
+#include "relaytime.h"
+#include "hrtimer.h"
+#include "timing.h"
+#include "acmp.h"
+#include "critical.h"
+#include "ramcode.h"
+
+#if ZEROCROSS_ENABLED
+	#if ACMP_ENABLED
+		#error "ZEROCROSS_ENABLED and ACMP_ENABLED both need ERU0 ETL0"
+	#endif
+	#include "xmc_eru.h"
+	#if !defined(ERU0_ETL0_INPUTB_P2_2)
+		#error "ZEROCROSS_ENABLED needs P2.2 on ERU0 ETL0 (VQFN24 and TSSOP38 packages)"
+	#endif
+
+	#define ZEROCROSS_ERU_ETL		 0U							// ETL of the detector input (ETL1 contact feedback, ETL3 buttons)
+	#define ZEROCROSS_ERU_OGU		 3U							// OGU raising ERU0_3_IRQn (OGU0 buttons, OGU1 comparators, OGU2 contact feedback)
+#endif
+#define ZEROCROSS_TIMEOUT_US		 TIMING_MS_TO_US(ZEROCROSS_TIMEOUT)
+#define ZEROCROSS_NONE				 0xFFU						// zerocross_target: no change scheduled
+
+typedef char zerocross_config_check[(ZEROCROSS_INTERVAL_MIN < ZEROCROSS_INTERVAL_MAX && ZEROCROSS_TIMEOUT_US > ZEROCROSS_INTERVAL_MAX
+		&& ZEROCROSS_TIMEOUT_US <= HRTIMER_MAX_US && ZEROCROSS_LOCK_EDGES >= 2) ? 1 : -1];
+
+volatile uint32_t zerocross_interval = 0;
+volatile uint16_t zerocross_locked = 0;
+uint32_t zerocross_switches = 0;
+uint32_t zerocross_unsynced = 0;
+volatile uint32_t zerocross_edge = 0;			// In us (SYSTIMER_GetTimeUs). Last detector edge
+volatile uint8_t zerocross_target = ZEROCROSS_NONE;	// relay_states of the scheduled change
+volatile bool zerocross_armed = false;			// The timer runs for a predicted zero cross (else for the timeout)
+const relay_channel_t *volatile zerocross_channel = NULL;	// Channel of the scheduled change
+uint32_t zerocross_timer = 0;					// hrtimer of the drive (0 = not created)
+
+
+//****************************************************************************
+// zerocross_in_lock - returns true if zero crosses can be predicted at now (interrupts masked)
+//****************************************************************************
+RAMCODE
+bool zerocross_in_lock(uint32_t now){
+	// One missed edge keeps the lock, the interrupt starts it again at the next edge
+	return zerocross_locked >= ZEROCROSS_LOCK_EDGES && now - zerocross_edge <= 2U * ZEROCROSS_INTERVAL_MAX;
+}
+
+//****************************************************************************
+// zerocross_callback - drive time (hrtimer interrupt): drives the scheduled change
+//****************************************************************************
+RAMCODE
+void zerocross_callback(void *args){
+	(void)args;
+	critical_state_t primask = critical_enter();
+	uint8_t target = zerocross_target;
+	const relay_channel_t *channel = zerocross_channel;
+	bool armed = zerocross_armed;
+	zerocross_target = ZEROCROSS_NONE;
+	zerocross_armed = false;
+	critical_exit(primask, CRITICAL_SITE_ZEROCROSS);
+	if(target == ZEROCROSS_NONE || channel == NULL)
+		return;
+	if(armed)
+		zerocross_switches++;
+	else
+		zerocross_unsynced++;
+	relay_output(channel, target == RELAY_HIGH);
+}
+
+#if ZEROCROSS_ENABLED
+//****************************************************************************
+// ERU0_3_IRQHandler - ERU interrupt (IRQ_Hdlr_6): detector edge, arms a scheduled change for the next usable zero cross
+//****************************************************************************
+RAMCODE
+void ERU0_3_IRQHandler(void){
+	uint32_t now = SYSTIMER_GetTimeUs();
+	uint32_t interval = now - zerocross_edge;
+	// Noise between two zero crosses is no edge
+	if(zerocross_locked != 0 && interval < ZEROCROSS_INTERVAL_MIN)
+		return;
+	zerocross_edge = now;
+	if(interval > ZEROCROSS_INTERVAL_MAX || interval < ZEROCROSS_INTERVAL_MIN){
+		// First edge or a gap: the lock starts again
+		zerocross_locked = 1;
+		return;
+	}
+	if(zerocross_interval == 0)
+		zerocross_interval = interval << ZEROCROSS_AVERAGE_SHIFT;
+	else
+		zerocross_interval += interval - (zerocross_interval >> ZEROCROSS_AVERAGE_SHIFT);
+	if(zerocross_locked < UINT16_MAX)
+		zerocross_locked++;
+
+	critical_state_t primask = critical_enter();
+	uint8_t target = zerocross_target;
+	if(target != ZEROCROSS_NONE && !zerocross_armed && zerocross_locked >= ZEROCROSS_LOCK_EDGES){
+		// Zero crosses lie at now - ZEROCROSS_EDGE_DELAY + n * spacing, the first one far enough ahead for the lead
+		uint32_t spacing = zerocross_interval >> ZEROCROSS_AVERAGE_SHIFT;
+		uint32_t ahead = relaytime_lead(target == RELAY_HIGH) + ZEROCROSS_EDGE_DELAY + ZEROCROSS_MARGIN;
+		uint32_t cross = spacing;
+		while(cross < ahead)
+			cross += spacing;
+		uint32_t wait = cross - ahead + ZEROCROSS_MARGIN;
+		if(wait <= HRTIMER_MAX_US && hrtimer_request(zerocross_timer, wait))
+			zerocross_armed = true;
+	}
+	critical_exit(primask, CRITICAL_SITE_ZEROCROSS);
+}
+#endif
+
+//****************************************************************************
+// zerocross_init - starts the detector edge detection and creates the drive timer (call after hrtimer_init and relaytime_init)
+//****************************************************************************
+bool zerocross_init(void){
+#if ZEROCROSS_ENABLED
+	zerocross_timer = hrtimer_create(zerocross_callback, NULL);
+	if(zerocross_timer == 0)
+		return false;
+	XMC_GPIO_SetMode(ZEROCROSS_PORT, ZEROCROSS_PIN, XMC_GPIO_MODE_INPUT_TRISTATE);
+
+	// P2.2 -> ETL0 (input B) -> OGU3 -> ERU0_3_IRQn, rising edge at each zero cross
+	XMC_ERU_ETL_CONFIG_t etl_config = {
+		.input_b = ERU0_ETL0_INPUTB_P2_2,
+		.enable_output_trigger = 1U,
+		.status_flag_mode = XMC_ERU_ETL_STATUS_FLAG_MODE_HWCTRL,
+		.edge_detection = XMC_ERU_ETL_EDGE_DETECTION_RISING,
+		.output_trigger_channel = XMC_ERU_ETL_OUTPUT_TRIGGER_CHANNEL3,
+		.source = XMC_ERU_ETL_SOURCE_B
+	};
+	XMC_ERU_OGU_CONFIG_t ogu_config = {
+		.service_request = XMC_ERU_OGU_SERVICE_REQUEST_ON_TRIGGER
+	};
+	XMC_ERU_ETL_Init(XMC_ERU0, ZEROCROSS_ERU_ETL, &etl_config);
+	XMC_ERU_OGU_Init(XMC_ERU0, ZEROCROSS_ERU_OGU, &ogu_config);
+	NVIC_SetPriority(ERU0_3_IRQn, ZEROCROSS_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(ERU0_3_IRQn);
+	NVIC_EnableIRQ(ERU0_3_IRQn);
+	return true;
+#else
+	return false;
+#endif
+}
+
+//****************************************************************************
+// zerocross_schedule - schedules a change of the output of channel for a zero cross (any context). Returns false if it must be driven at once
+//****************************************************************************
+RAMCODE
+bool zerocross_schedule(const relay_channel_t *channel, bool on){
+	if(zerocross_timer == 0)
+		return false;
+	uint32_t now = SYSTIMER_GetTimeUs();
+	critical_state_t primask = critical_enter();
+	if(!zerocross_in_lock(now)){
+		// No mains: a scheduled change is replaced by this one, driven at once
+		zerocross_target = ZEROCROSS_NONE;
+		critical_exit(primask, CRITICAL_SITE_ZEROCROSS);
+		zerocross_unsynced++;
+		return false;
+	}
+	uint8_t target = on ? RELAY_HIGH : RELAY_LOW;
+	bool start = zerocross_target == ZEROCROSS_NONE || zerocross_armed;
+	zerocross_channel = channel;
+	zerocross_target = target;
+	// Armed for the lead of the other direction: the next edge arms it again
+	zerocross_armed = false;
+	// The timeout runs until the next edge arms the zero cross (a running timer is restarted by the request)
+	bool scheduled = !start || hrtimer_request(zerocross_timer, ZEROCROSS_TIMEOUT_US);
+	if(!scheduled)
+		zerocross_target = ZEROCROSS_NONE;
+	critical_exit(primask, CRITICAL_SITE_ZEROCROSS);
+	return scheduled;
+}
+
+//****************************************************************************
+// zerocross_cancel - drops a scheduled change (any context, the caller drives the output itself)
+//****************************************************************************
+RAMCODE
+void zerocross_cancel(void){
+	critical_state_t primask = critical_enter();
+	zerocross_target = ZEROCROSS_NONE;
+	zerocross_armed = false;
+	critical_exit(primask, CRITICAL_SITE_ZEROCROSS);
+}
@@ -0,0 +1,51 @@
+/*
+ * USB-Changer zerocross.h
+ *
+ * Zero cross synchronised switching of IO_RELAY for AC loads. A relay that opens or closes at an arbitrary phase of the
+ * mains voltage draws an arc that wears the contacts, one that changes at a zero cross does not. A zero cross detector
+ * (optocoupler pulse at every zero cross of the load voltage) on ZEROCROSS_PIN gives one edge per zero cross (ERU0 ETL0
+ * input B -> OGU3 -> ERU0_3_IRQn). The interrupt timestamps the edges and smooths their spacing, it locks onto the
+ * mains after ZEROCROSS_LOCK_EDGES edges with a spacing between ZEROCROSS_INTERVAL_MIN and ZEROCROSS_INTERVAL_MAX.
+ * relay_drive schedules a change of IO_RELAY instead of driving the pin (zerocross_schedule, any context): the next
+ * detector edge arms an hrtimer for the first zero cross at least the relay operate or release time (relaytime_lead)
+ * ahead, minus that time, and the timer callback drives the pin, so the contacts move on the zero cross. The switch
+ * comes at most one zero cross spacing plus the lead later than without. Without lock (no mains, a detector fault) the
+ * pin is driven at once, a missing edge after the schedule drives it after ZEROCROSS_TIMEOUT. The fault safe state is
+ * always driven at once and drops a scheduled change. A newer change replaces a scheduled one that is not due yet.
+ * A detector with one edge per mains period only uses every second zero cross (set the interval limits to the period).
+ * P2.2 is not bonded on the TSSOP16 of this board: the detector needs a VQFN24 or TSSOP38 board variant. The lead is
+ * only right with RELAYTIME_ENABLED or a factory calibrated operate and release time.
+ *
+ *  Created on: 2026 Oct 14
+ */
+
+#ifndef ZEROCROSS_H
+#define ZEROCROSS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "irqprio.h"
+#include "relay.h"
+
+#define ZEROCROSS_ENABLED			 0							// Determines if IO_RELAY changes are scheduled to mains zero crosses (needs a detector on ZEROCROSS_PIN)
+#define ZEROCROSS_PORT				 XMC_GPIO_PORT2				// Detector input P2.2 (ERU0 ETL0 input B1, not bonded on the TSSOP16)
+#define ZEROCROSS_PIN				 2U
+#define ZEROCROSS_INTERVAL_MIN		 7500U						// In us. Shortest plausible edge spacing (half period of 66Hz), a closer edge is ignored as noise
+#define ZEROCROSS_INTERVAL_MAX		 10500U						// In us. Longest plausible edge spacing (half period of 47.6Hz), a later edge restarts the lock
+#define ZEROCROSS_LOCK_EDGES		 4							// Edges with a plausible spacing before zero crosses are predicted
+#define ZEROCROSS_EDGE_DELAY		 200U						// In us. Time the detector edge lags the zero cross (optocoupler threshold and propagation)
+#define ZEROCROSS_MARGIN			 100U						// In us. Shortest time from an edge to the drive (an hrtimer start from the interrupt)
+#define ZEROCROSS_TIMEOUT			 40							// In ms. A change not armed by an edge within this time is driven without synchronisation
+#define ZEROCROSS_AVERAGE_SHIFT		 3							// Smoothing of the edge spacing per edge: average += (interval - average) >> shift
+#define ZEROCROSS_IRQ_PRIORITY		 IRQPRIO_ZEROCROSS			// Priority of the ERU0 SR3 interrupt (time tier, its latency shifts the switch instant)
+
+extern volatile uint32_t zerocross_interval;	// In us << ZEROCROSS_AVERAGE_SHIFT. Smoothed edge spacing (0 = none measured)
+extern volatile uint16_t zerocross_locked;		// Edges with a plausible spacing in a row (locked from ZEROCROSS_LOCK_EDGES)
+extern uint32_t zerocross_switches;				// Changes driven at a predicted zero cross
+extern uint32_t zerocross_unsynced;				// Changes driven without synchronisation (no lock, timeout)
+
+bool zerocross_init(void);
+bool zerocross_schedule(const relay_channel_t *channel, bool on);
+void zerocross_cancel(void);
+
+#endif /* ZEROCROSS_H */